@@ -40,6 +40,7 @@
 #include <signal.h>
 #include <stdbool.h>
 #include <net/if.h>
+#include <arpa/inet.h>
 
 #include <rte_eal.h>
 #include <rte_common.h>
@@ -53,8 +54,11 @@
 #include <rte_kvargs.h>
 #include <rte_mempool.h>
 #include <rte_ring.h>
+#include <rte_malloc.h>
 #include <rte_pdump.h>
 
+#include "pcapng.h"
+
 #define CMD_LINE_OPT_PDUMP "pdump"
 #define PDUMP_PORT_ARG "port"
 #define PDUMP_PCI_ARG "device_id"
@@ -65,6 +69,14 @@
 #define PDUMP_RING_SIZE_ARG "ring-size"
 #define PDUMP_MSIZE_ARG "mbuf-size"
 #define PDUMP_NUM_MBUFS_ARG "total-num-mbufs"
+#define PDUMP_SNAPLEN_ARG "snaplen"
+#define PDUMP_SAMPLE_ARG "sample"
+#define PDUMP_PROTO_ARG "proto"
+#define PDUMP_SRC_IP_ARG "src-ip"
+#define PDUMP_DST_IP_ARG "dst-ip"
+#define PDUMP_SRC_PORT_ARG "src-port"
+#define PDUMP_DST_PORT_ARG "dst-port"
+#define PDUMP_FORMAT_ARG "format"
 #define CMD_LINE_OPT_SER_SOCK_PATH "server-socket-path"
 #define CMD_LINE_OPT_CLI_SOCK_PATH "client-socket-path"
 
@@ -121,6 +133,14 @@ const char *valid_pdump_arguments[] = {
 	PDUMP_RING_SIZE_ARG,
 	PDUMP_MSIZE_ARG,
 	PDUMP_NUM_MBUFS_ARG,
+	PDUMP_SNAPLEN_ARG,
+	PDUMP_SAMPLE_ARG,
+	PDUMP_PROTO_ARG,
+	PDUMP_SRC_IP_ARG,
+	PDUMP_DST_IP_ARG,
+	PDUMP_SRC_PORT_ARG,
+	PDUMP_DST_PORT_ARG,
+	PDUMP_FORMAT_ARG,
 	NULL
 };
 
@@ -143,6 +163,7 @@ struct pdump_tuples {
 
 	/* params for library API call */
 	uint32_t dir;
+	struct rte_pdump_filter filter;
 	struct rte_mempool *mp;
 	struct rte_ring *rx_ring;
 	struct rte_ring *tx_ring;
@@ -155,6 +176,13 @@ struct pdump_tuples {
 	enum pcap_stream tx_vdev_stream_type;
 	bool single_pdump_dev;
 
+	/* native pcapng output instead of pcap vdevs */
+	bool pcapng;
+	struct pcapng_writer *rx_pcapng;
+	struct pcapng_writer *tx_pcapng;
+	struct rte_pdump_stats *rx_stats;
+	struct rte_pdump_stats *tx_stats;
+
 	/* stats */
 	struct pdump_stats stats;
 } __rte_cache_aligned;
@@ -183,7 +211,15 @@ pdump_usage(const char *prgname)
 			" tx-dev=<iface or pcap file>,"
 			"[ring-size=<ring size>default:16384],"
 			"[mbuf-size=<mbuf data size>default:2176],"
-			"[total-num-mbufs=<number of mbufs>default:65535]'\n"
+			"[total-num-mbufs=<number of mbufs>default:65535],"
+			"[snaplen=<bytes copied per packet>default:0(all)],"
+			"[sample=<capture 1 in N packets>default:1],"
+			"[proto=<tcp|udp|sctp|icmp|protocol number>],"
+			"[src-ip=<ip address>[/<prefix len>]],"
+			"[dst-ip=<ip address>[/<prefix len>]],"
+			"[src-port=<port>],"
+			"[dst-port=<port>],"
+			"[format=<pcap|pcapng>default:pcap]'\n"
 			"[--server-socket-path=<server socket dir>"
 				"default:/var/run/.dpdk/ (or) ~/.dpdk/]\n"
 			"[--client-socket-path=<client socket dir>"
@@ -270,6 +306,113 @@ parse_uint_value(const char *key, const char *value, void *extra_args)
 	return 0;
 }
 
+static int
+parse_proto(const char *key __rte_unused, const char *value, void *extra_args)
+{
+	struct rte_pdump_filter *f = extra_args;
+	unsigned long n;
+	char *end;
+
+	if (!strcmp(value, "tcp"))
+		n = IPPROTO_TCP;
+	else if (!strcmp(value, "udp"))
+		n = IPPROTO_UDP;
+	else if (!strcmp(value, "sctp"))
+		n = IPPROTO_SCTP;
+	else if (!strcmp(value, "icmp"))
+		n = IPPROTO_ICMP;
+	else {
+		errno = 0;
+		n = strtoul(value, &end, 10);
+		if (errno != 0 || end[0] != 0 || n > UINT8_MAX) {
+			printf("invalid value:\"%s\" for key:\"%s\"\n",
+				value, PDUMP_PROTO_ARG);
+			return -EINVAL;
+		}
+	}
+
+	f->proto = (uint8_t) n;
+	f->match |= RTE_PDUMP_MATCH_PROTO;
+	return 0;
+}
+
+static int
+parse_ip_prefix(const char *key, const char *value, void *extra_args)
+{
+	struct rte_pdump_filter *f = extra_args;
+	char addr[INET6_ADDRSTRLEN];
+	uint8_t buf[sizeof(struct in6_addr)];
+	unsigned long depth;
+	uint8_t version;
+	const char *sep;
+	char *end;
+	size_t len;
+
+	sep = strchr(value, '/');
+	len = (sep != NULL) ? (size_t)(sep - value) : strlen(value);
+	if (len >= sizeof(addr))
+		goto invalid;
+	memcpy(addr, value, len);
+	addr[len] = 0;
+
+	if (inet_pton(AF_INET, addr, buf) == 1)
+		version = 4;
+	else if (inet_pton(AF_INET6, addr, buf) == 1)
+		version = 6;
+	else
+		goto invalid;
+
+	depth = (version == 4) ? 32 : 128;
+	if (sep != NULL) {
+		unsigned long max = depth;
+
+		errno = 0;
+		depth = strtoul(sep + 1, &end, 10);
+		if (errno != 0 || end == sep + 1 || end[0] != 0 ||
+				depth > max)
+			goto invalid;
+	}
+
+	/* source and destination prefixes must be of the same family */
+	if ((f->match & (RTE_PDUMP_MATCH_SRC_ADDR | RTE_PDUMP_MATCH_DST_ADDR))
+			&& f->ip_version != version)
+		goto invalid;
+	f->ip_version = version;
+
+	if (!strcmp(key, PDUMP_SRC_IP_ARG)) {
+		memcpy(f->src_addr.ipv6, buf, version == 4 ? 4 : 16);
+		f->src_depth = (uint8_t) depth;
+		f->match |= RTE_PDUMP_MATCH_SRC_ADDR;
+	} else {
+		memcpy(f->dst_addr.ipv6, buf, version == 4 ? 4 : 16);
+		f->dst_depth = (uint8_t) depth;
+		f->match |= RTE_PDUMP_MATCH_DST_ADDR;
+	}
+
+	return 0;
+
+invalid:
+	printf("invalid value:\"%s\" for key:\"%s\", "
+		"value must be <ip address>[/<prefix len>]\n", value, key);
+	return -EINVAL;
+}
+
+static int
+parse_format(const char *key, const char *value, void *extra_args)
+{
+	struct pdump_tuples *pt = extra_args;
+
+	if (!strcmp(value, "pcapng"))
+		pt->pcapng = true;
+	else if (strcmp(value, "pcap")) {
+		printf("invalid value:\"%s\" for key:\"%s\", "
+			"value must be pcap or pcapng\n", value, key);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 static int
 parse_pdump(const char *optarg)
 {
@@ -397,6 +540,90 @@ parse_pdump(const char *optarg)
 	} else
 		pt->total_num_mbufs = MBUFS_PER_POOL;
 
+	/* snaplen parsing and validation */
+	cnt1 = rte_kvargs_count(kvlist, PDUMP_SNAPLEN_ARG);
+	if (cnt1 == 1) {
+		v.min = 0;
+		v.max = UINT32_MAX;
+		ret = rte_kvargs_process(kvlist, PDUMP_SNAPLEN_ARG,
+						&parse_uint_value, &v);
+		if (ret < 0)
+			goto free_kvlist;
+		pt->filter.snaplen = (uint32_t) v.val;
+	}
+
+	/* sample rate parsing and validation */
+	cnt1 = rte_kvargs_count(kvlist, PDUMP_SAMPLE_ARG);
+	if (cnt1 == 1) {
+		v.min = 1;
+		v.max = UINT32_MAX;
+		ret = rte_kvargs_process(kvlist, PDUMP_SAMPLE_ARG,
+						&parse_uint_value, &v);
+		if (ret < 0)
+			goto free_kvlist;
+		pt->filter.sample_rate = (uint32_t) v.val;
+	}
+
+	/* filter parsing and validation */
+	if (rte_kvargs_count(kvlist, PDUMP_PROTO_ARG) > 1 ||
+			rte_kvargs_count(kvlist, PDUMP_SRC_IP_ARG) > 1 ||
+			rte_kvargs_count(kvlist, PDUMP_DST_IP_ARG) > 1 ||
+			rte_kvargs_count(kvlist, PDUMP_SRC_PORT_ARG) > 1 ||
+			rte_kvargs_count(kvlist, PDUMP_DST_PORT_ARG) > 1) {
+		printf("--pdump=\"%s\": filter keys can be given only "
+			"once\n", optarg);
+		ret = -1;
+		goto free_kvlist;
+	}
+	ret = rte_kvargs_process(kvlist, PDUMP_PROTO_ARG, &parse_proto,
+					&pt->filter);
+	if (ret < 0)
+		goto free_kvlist;
+	ret = rte_kvargs_process(kvlist, PDUMP_SRC_IP_ARG, &parse_ip_prefix,
+					&pt->filter);
+	if (ret < 0)
+		goto free_kvlist;
+	ret = rte_kvargs_process(kvlist, PDUMP_DST_IP_ARG, &parse_ip_prefix,
+					&pt->filter);
+	if (ret < 0)
+		goto free_kvlist;
+	if (rte_kvargs_count(kvlist, PDUMP_SRC_PORT_ARG) == 1) {
+		v.min = 0;
+		v.max = UINT16_MAX;
+		ret = rte_kvargs_process(kvlist, PDUMP_SRC_PORT_ARG,
+						&parse_uint_value, &v);
+		if (ret < 0)
+			goto free_kvlist;
+		pt->filter.src_port = (uint16_t) v.val;
+		pt->filter.match |= RTE_PDUMP_MATCH_SRC_PORT;
+	}
+	if (rte_kvargs_count(kvlist, PDUMP_DST_PORT_ARG) == 1) {
+		v.min = 0;
+		v.max = UINT16_MAX;
+		ret = rte_kvargs_process(kvlist, PDUMP_DST_PORT_ARG,
+						&parse_uint_value, &v);
+		if (ret < 0)
+			goto free_kvlist;
+		pt->filter.dst_port = (uint16_t) v.val;
+		pt->filter.match |= RTE_PDUMP_MATCH_DST_PORT;
+	}
+
+	/* output format parsing and validation */
+	cnt1 = rte_kvargs_count(kvlist, PDUMP_FORMAT_ARG);
+	if (cnt1 == 1) {
+		ret = rte_kvargs_process(kvlist, PDUMP_FORMAT_ARG,
+						&parse_format, pt);
+		if (ret < 0)
+			goto free_kvlist;
+		if (pt->pcapng && (pt->rx_vdev_stream_type == IFACE ||
+				pt->tx_vdev_stream_type == IFACE)) {
+			printf("--pdump=\"%s\": pcapng format needs "
+				"rx-dev and tx-dev to be files\n", optarg);
+			ret = -1;
+			goto free_kvlist;
+		}
+	}
+
 	num_tuples++;
 
 free_kvlist:
@@ -516,6 +743,29 @@ pdump_rxtx(struct rte_ring *ring, uint8_t vdev_id, struct pdump_stats *stats)
 	}
 }
 
+static inline void
+pdump_rxtx_pcapng(struct rte_ring *ring, struct pcapng_writer *w,
+		uint32_t dir, struct pdump_stats *stats)
+{
+	/* append input packets of port to the pcapng file */
+	struct rte_mbuf *rxtx_bufs[BURST_SIZE];
+	uint16_t i;
+
+	const uint16_t nb_in_deq = rte_ring_dequeue_burst(ring,
+			(void *)rxtx_bufs, BURST_SIZE);
+	stats->dequeue_pkts += nb_in_deq;
+
+	if (nb_in_deq) {
+		if (pcapng_writer_write(w, dir, rxtx_bufs, nb_in_deq) == 0)
+			stats->tx_pkts += nb_in_deq;
+		else
+			stats->freed_pkts += nb_in_deq;
+
+		for (i = 0; i < nb_in_deq; i++)
+			rte_pktmbuf_free(rxtx_bufs[i]);
+	}
+}
+
 static void
 free_ring_data(struct rte_ring *ring, uint8_t vdev_id,
 		struct pdump_stats *stats)
@@ -524,6 +774,31 @@ free_ring_data(struct rte_ring *ring, uint8_t vdev_id,
 		pdump_rxtx(ring, vdev_id, stats);
 }
 
+static void
+free_ring_data_pcapng(struct rte_ring *ring, struct pcapng_writer *w,
+		uint32_t dir, struct pdump_stats *stats)
+{
+	while (rte_ring_count(ring))
+		pdump_rxtx_pcapng(ring, w, dir, stats);
+}
+
+static void
+close_pcapng(struct pdump_tuples *pt)
+{
+	if (pt->rx_pcapng && pcapng_writer_close(pt->rx_pcapng) < 0)
+		printf("failed to write %s\n", pt->rx_dev);
+	if (pt->tx_pcapng && pt->tx_pcapng != pt->rx_pcapng &&
+			pcapng_writer_close(pt->tx_pcapng) < 0)
+		printf("failed to write %s\n", pt->tx_dev);
+	pt->rx_pcapng = NULL;
+	pt->tx_pcapng = NULL;
+
+	rte_free(pt->rx_stats);
+	rte_free(pt->tx_stats);
+	pt->rx_stats = NULL;
+	pt->tx_stats = NULL;
+}
+
 static void
 cleanup_rings(void)
 {
@@ -561,6 +836,18 @@ cleanup_pdump_resources(void)
 		* transmit rest of the enqueued packets of the rings on to
 		* the vdev, in order to release mbufs to the mepool.
 		**/
+		if (pt->pcapng) {
+			if (pt->rx_pcapng)
+				free_ring_data_pcapng(pt->rx_ring,
+					pt->rx_pcapng, RTE_PDUMP_FLAG_RX,
+					&pt->stats);
+			if (pt->tx_pcapng)
+				free_ring_data_pcapng(pt->tx_ring,
+					pt->tx_pcapng, RTE_PDUMP_FLAG_TX,
+					&pt->stats);
+			close_pcapng(pt);
+			continue;
+		}
 		if (pt->dir & RTE_PDUMP_FLAG_RX)
 			free_ring_data(pt->rx_ring, pt->rx_vdev_id, &pt->stats);
 		if (pt->dir & RTE_PDUMP_FLAG_TX)
@@ -620,6 +907,85 @@ configure_vdev(uint8_t port_id)
 	return 0;
 }
 
+static struct pcapng_writer *
+open_pcapng(struct pdump_tuples *pt, const char *file, uint32_t dir,
+		struct rte_pdump_stats **stats)
+{
+	struct pcapng_writer *w;
+	char dev_name[SIZE];
+
+	if (pt->dump_by_type == DEVICE_ID)
+		snprintf(dev_name, SIZE, "%s", pt->device_id);
+	else
+		snprintf(dev_name, SIZE, "port%u", pt->port);
+
+	w = pcapng_writer_open(file, dev_name, pt->filter.snaplen);
+	if (w == NULL)
+		return NULL;
+
+	/* counters are updated by the primary, so keep them in hugepages */
+	*stats = rte_zmalloc("pdump_stats", sizeof(struct rte_pdump_stats) *
+			RTE_MAX_QUEUES_PER_PORT, 0);
+	if (*stats == NULL) {
+		pcapng_writer_close(w);
+		return NULL;
+	}
+	pcapng_writer_set_stats(w, dir, *stats, pt->queue);
+
+	return w;
+}
+
+static void
+create_pcapng(struct pdump_tuples *pt, int i)
+{
+	char ring_name[SIZE];
+
+	if (pt->dir & RTE_PDUMP_FLAG_RX) {
+		snprintf(ring_name, SIZE, RX_RING, i);
+		pt->rx_ring = rte_ring_create(ring_name, pt->ring_size,
+				rte_socket_id(), 0);
+		if (pt->rx_ring == NULL)
+			goto fail;
+		pt->rx_pcapng = open_pcapng(pt, pt->rx_dev, RTE_PDUMP_FLAG_RX,
+				&pt->rx_stats);
+		if (pt->rx_pcapng == NULL)
+			goto fail;
+	}
+
+	if (pt->dir & RTE_PDUMP_FLAG_TX) {
+		snprintf(ring_name, SIZE, TX_RING, i);
+		pt->tx_ring = rte_ring_create(ring_name, pt->ring_size,
+				rte_socket_id(), 0);
+		if (pt->tx_ring == NULL)
+			goto fail;
+		if (pt->single_pdump_dev) {
+			/* both directions go to the same file */
+			pt->tx_pcapng = pt->rx_pcapng;
+			pt->tx_stats = rte_zmalloc("pdump_stats",
+					sizeof(struct rte_pdump_stats) *
+					RTE_MAX_QUEUES_PER_PORT, 0);
+			if (pt->tx_stats == NULL)
+				goto fail;
+			pcapng_writer_set_stats(pt->tx_pcapng,
+					RTE_PDUMP_FLAG_TX, pt->tx_stats,
+					pt->queue);
+		} else {
+			pt->tx_pcapng = open_pcapng(pt, pt->tx_dev,
+					RTE_PDUMP_FLAG_TX, &pt->tx_stats);
+			if (pt->tx_pcapng == NULL)
+				goto fail;
+		}
+	}
+
+	return;
+
+fail:
+	close_pcapng(pt);
+	cleanup_rings();
+	rte_exit(EXIT_FAILURE, "pcapng output creation failed:%s:%d\n",
+		__func__, __LINE__);
+}
+
 static void
 create_mp_ring_vdev(void)
 {
@@ -651,6 +1017,11 @@ create_mp_ring_vdev(void)
 		}
 		pt->mp = mbuf_pool;
 
+		if (pt->pcapng) {
+			create_pcapng(pt, i);
+			continue;
+		}
+
 		if (pt->dir == RTE_PDUMP_FLAG_RXTX) {
 			/* if captured packets has to send to the same vdev */
 			/* create rx_ring */
@@ -793,6 +1164,9 @@ enable_pdump(void)
 
 	for (i = 0; i < num_tuples; i++) {
 		pt = &pdump_t[i];
+		/* counters of the direction enabled next */
+		pt->filter.stats = (pt->dir & RTE_PDUMP_FLAG_RX) ?
+			pt->rx_stats : pt->tx_stats;
 		if (pt->dir == RTE_PDUMP_FLAG_RXTX) {
 			if (pt->dump_by_type == DEVICE_ID) {
 				ret = rte_pdump_enable_by_deviceid(
@@ -800,20 +1174,22 @@ enable_pdump(void)
 						pt->queue,
 						RTE_PDUMP_FLAG_RX,
 						pt->rx_ring,
-						pt->mp, NULL);
+						pt->mp, &pt->filter);
+				pt->filter.stats = pt->tx_stats;
 				ret1 = rte_pdump_enable_by_deviceid(
 						pt->device_id,
 						pt->queue,
 						RTE_PDUMP_FLAG_TX,
 						pt->tx_ring,
-						pt->mp, NULL);
+						pt->mp, &pt->filter);
 			} else if (pt->dump_by_type == PORT_ID) {
 				ret = rte_pdump_enable(pt->port, pt->queue,
 						RTE_PDUMP_FLAG_RX,
-						pt->rx_ring, pt->mp, NULL);
+						pt->rx_ring, pt->mp, &pt->filter);
+				pt->filter.stats = pt->tx_stats;
 				ret1 = rte_pdump_enable(pt->port, pt->queue,
 						RTE_PDUMP_FLAG_TX,
-						pt->tx_ring, pt->mp, NULL);
+						pt->tx_ring, pt->mp, &pt->filter);
 			}
 		} else if (pt->dir == RTE_PDUMP_FLAG_RX) {
 			if (pt->dump_by_type == DEVICE_ID)
@@ -821,22 +1197,22 @@ enable_pdump(void)
 						pt->device_id,
 						pt->queue,
 						pt->dir, pt->rx_ring,
-						pt->mp, NULL);
+						pt->mp, &pt->filter);
 			else if (pt->dump_by_type == PORT_ID)
 				ret = rte_pdump_enable(pt->port, pt->queue,
 						pt->dir,
-						pt->rx_ring, pt->mp, NULL);
+						pt->rx_ring, pt->mp, &pt->filter);
 		} else if (pt->dir == RTE_PDUMP_FLAG_TX) {
 			if (pt->dump_by_type == DEVICE_ID)
 				ret = rte_pdump_enable_by_deviceid(
 						pt->device_id,
 						pt->queue,
 						pt->dir,
-						pt->tx_ring, pt->mp, NULL);
+						pt->tx_ring, pt->mp, &pt->filter);
 			else if (pt->dump_by_type == PORT_ID)
 				ret = rte_pdump_enable(pt->port, pt->queue,
 						pt->dir,
-						pt->tx_ring, pt->mp, NULL);
+						pt->tx_ring, pt->mp, &pt->filter);
 		}
 		if (ret < 0 || ret1 < 0) {
 			cleanup_pdump_resources();
@@ -854,6 +1230,17 @@ dump_packets(void)
 	while (!quit_signal) {
 		for (i = 0; i < num_tuples; i++) {
 			pt = &pdump_t[i];
+			if (pt->pcapng) {
+				if (pt->dir & RTE_PDUMP_FLAG_RX)
+					pdump_rxtx_pcapng(pt->rx_ring,
+						pt->rx_pcapng,
+						RTE_PDUMP_FLAG_RX, &pt->stats);
+				if (pt->dir & RTE_PDUMP_FLAG_TX)
+					pdump_rxtx_pcapng(pt->tx_ring,
+						pt->tx_pcapng,
+						RTE_PDUMP_FLAG_TX, &pt->stats);
+				continue;
+			}
 			if (pt->dir & RTE_PDUMP_FLAG_RX)
 				pdump_rxtx(pt->rx_ring, pt->rx_vdev_id,
 					&pt->stats);
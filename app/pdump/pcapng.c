@@ -0,0 +1,468 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_mbuf.h>
+#include <rte_pdump.h>
+
+#include "pcapng.h"
+
+#define PCAPNG_BLOCK_SHB 0x0A0D0D0A
+#define PCAPNG_BLOCK_IDB 0x00000001
+#define PCAPNG_BLOCK_ISB 0x00000005
+#define PCAPNG_BLOCK_EPB 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+#define PCAPNG_LINKTYPE_ETHERNET 1
+
+#define PCAPNG_OPT_END 0
+#define PCAPNG_OPT_SHB_USERAPPL 4
+#define PCAPNG_OPT_IF_NAME 2
+#define PCAPNG_OPT_IF_TSRESOL 9
+#define PCAPNG_OPT_EPB_FLAGS 2
+#define PCAPNG_OPT_ISB_IFRECV 4
+#define PCAPNG_OPT_ISB_FILTERACCEPT 6
+#define PCAPNG_OPT_ISB_OSDROP 7
+#define PCAPNG_OPT_ISB_USRDELIV 8
+
+#define PCAPNG_EPB_INBOUND 1
+#define PCAPNG_EPB_OUTBOUND 2
+
+/* timestamps are written in nanoseconds */
+#define PCAPNG_TSRESOL 9
+
+#define PCAPNG_IO_ALIGN 4096
+#define PCAPNG_BUF_SIZE (1 << 20)
+/* largest block appended at once: EPB of a 64KB packet and its options */
+#define PCAPNG_MAX_CAPLEN 65535
+#define PCAPNG_MAX_BLOCK (PCAPNG_MAX_CAPLEN + 256)
+
+#define PCAPNG_DIR_RX 0
+#define PCAPNG_DIR_TX 1
+#define PCAPNG_NB_DIR 2
+
+struct pcapng_block_hdr {
+	uint32_t type;
+	uint32_t len;
+};
+
+struct pcapng_opt_hdr {
+	uint16_t code;
+	uint16_t len;
+};
+
+struct pcapng_interface {
+	int32_t id;          /* interface id in the file, -1 if none yet */
+	uint64_t delivered;  /* packets written for this interface */
+};
+
+struct pcapng_writer {
+	int fd;
+	uint8_t *buf;
+	uint32_t used;
+	uint32_t snaplen;
+	int32_t nb_if;
+	uint64_t tsc_hz;
+	uint64_t tsc_base;
+	uint64_t ns_base;
+	char dev_name[64];
+	const struct rte_pdump_stats *stats[PCAPNG_NB_DIR];
+	uint16_t stats_queue[PCAPNG_NB_DIR];
+	struct pcapng_interface ifs[PCAPNG_NB_DIR][RTE_MAX_QUEUES_PER_PORT];
+};
+
+static inline uint32_t
+pcapng_dir(uint32_t dir)
+{
+	return (dir == RTE_PDUMP_FLAG_TX) ? PCAPNG_DIR_TX : PCAPNG_DIR_RX;
+}
+
+/* writes out the buffered data, all of it if final is set */
+static int
+pcapng_flush(struct pcapng_writer *w, int final)
+{
+	uint32_t len, off;
+	ssize_t n;
+
+	len = final ? w->used : (w->used & ~(PCAPNG_IO_ALIGN - 1));
+	if (final && (len & (PCAPNG_IO_ALIGN - 1)) != 0) {
+		/* the unaligned tail cannot go through O_DIRECT */
+		int flags = fcntl(w->fd, F_GETFL);
+
+		if (flags >= 0 && (flags & O_DIRECT))
+			fcntl(w->fd, F_SETFL, flags & ~O_DIRECT);
+	}
+
+	for (off = 0; off < len; off += n) {
+		n = write(w->fd, w->buf + off, len - off);
+		if (n < 0) {
+			if (errno == EINTR) {
+				n = 0;
+				continue;
+			}
+			return -errno;
+		}
+	}
+
+	w->used -= len;
+	if (w->used != 0)
+		memmove(w->buf, w->buf + len, w->used);
+	return 0;
+}
+
+/* returns room for a block of at most len bytes in the buffer */
+static inline uint8_t *
+pcapng_reserve(struct pcapng_writer *w, uint32_t len)
+{
+	if (w->used + len > PCAPNG_BUF_SIZE && pcapng_flush(w, 0) < 0)
+		return NULL;
+	return w->buf + w->used;
+}
+
+static inline uint8_t *
+pcapng_put_opt(uint8_t *p, uint16_t code, const void *val, uint16_t len)
+{
+	struct pcapng_opt_hdr *opt = (struct pcapng_opt_hdr *)p;
+	uint16_t pad = RTE_ALIGN(len, 4) - len;
+
+	opt->code = code;
+	opt->len = len;
+	p += sizeof(*opt);
+	if (len != 0) {
+		memcpy(p, val, len);
+		memset(p + len, 0, pad);
+	}
+	return p + len + pad;
+}
+
+/* fills in the block header and trailer, p points past the last option */
+static inline void
+pcapng_end_block(struct pcapng_writer *w, uint8_t *blk, uint8_t *p,
+		uint32_t type)
+{
+	struct pcapng_block_hdr *hdr = (struct pcapng_block_hdr *)blk;
+	uint32_t len = p - blk + sizeof(uint32_t);
+
+	hdr->type = type;
+	hdr->len = len;
+	memcpy(p, &len, sizeof(len));
+	w->used += len;
+}
+
+static inline uint64_t
+pcapng_tsc_to_ns(const struct pcapng_writer *w, uint64_t tsc)
+{
+	uint64_t delta;
+
+	/* packets stamped before the writer was opened */
+	if (tsc < w->tsc_base) {
+		delta = w->tsc_base - tsc;
+		return w->ns_base - (delta / w->tsc_hz) * NS_PER_S -
+			(delta % w->tsc_hz) * NS_PER_S / w->tsc_hz;
+	}
+	delta = tsc - w->tsc_base;
+	return w->ns_base + (delta / w->tsc_hz) * NS_PER_S +
+		(delta % w->tsc_hz) * NS_PER_S / w->tsc_hz;
+}
+
+static int
+pcapng_write_shb(struct pcapng_writer *w)
+{
+	static const char appl[] = "dpdk-pdump";
+	uint8_t *blk, *p;
+	uint32_t magic = PCAPNG_BYTE_ORDER_MAGIC;
+	uint16_t version[2] = { 1, 0 };
+	int64_t section_len = -1;
+
+	blk = pcapng_reserve(w, 64);
+	if (blk == NULL)
+		return -EIO;
+	p = blk + sizeof(struct pcapng_block_hdr);
+	memcpy(p, &magic, sizeof(magic));
+	p += sizeof(magic);
+	memcpy(p, version, sizeof(version));
+	p += sizeof(version);
+	memcpy(p, &section_len, sizeof(section_len));
+	p += sizeof(section_len);
+	p = pcapng_put_opt(p, PCAPNG_OPT_SHB_USERAPPL, appl, strlen(appl));
+	p = pcapng_put_opt(p, PCAPNG_OPT_END, NULL, 0);
+	pcapng_end_block(w, blk, p, PCAPNG_BLOCK_SHB);
+
+	return 0;
+}
+
+/* returns the interface of a queue and direction, creating it if needed */
+static struct pcapng_interface *
+pcapng_get_interface(struct pcapng_writer *w, uint32_t d, uint16_t queue)
+{
+	struct pcapng_interface *iface = &w->ifs[d][queue];
+	uint8_t tsresol = PCAPNG_TSRESOL;
+	uint16_t linktype[2] = { PCAPNG_LINKTYPE_ETHERNET, 0 };
+	char name[128];
+	uint8_t *blk, *p;
+	int len;
+
+	if (iface->id >= 0)
+		return iface;
+
+	len = snprintf(name, sizeof(name), "%s-q%u-%s", w->dev_name, queue,
+			d == PCAPNG_DIR_RX ? "rx" : "tx");
+	if (len >= (int)sizeof(name))
+		len = sizeof(name) - 1;
+
+	blk = pcapng_reserve(w, 64 + sizeof(name));
+	if (blk == NULL)
+		return NULL;
+	p = blk + sizeof(struct pcapng_block_hdr);
+	memcpy(p, linktype, sizeof(linktype));
+	p += sizeof(linktype);
+	memcpy(p, &w->snaplen, sizeof(w->snaplen));
+	p += sizeof(w->snaplen);
+	p = pcapng_put_opt(p, PCAPNG_OPT_IF_NAME, name, len);
+	p = pcapng_put_opt(p, PCAPNG_OPT_IF_TSRESOL, &tsresol,
+			sizeof(tsresol));
+	p = pcapng_put_opt(p, PCAPNG_OPT_END, NULL, 0);
+	pcapng_end_block(w, blk, p, PCAPNG_BLOCK_IDB);
+
+	iface->id = w->nb_if++;
+	return iface;
+}
+
+static int
+pcapng_write_isb(struct pcapng_writer *w, uint32_t d, uint16_t queue,
+		const struct rte_pdump_stats *st, uint64_t now)
+{
+	struct pcapng_interface *iface;
+	uint64_t recv, accept, drop;
+	uint32_t ts[2];
+	uint8_t *blk, *p;
+
+	iface = pcapng_get_interface(w, d, queue);
+	if (iface == NULL)
+		return -EIO;
+
+	drop = st->nombuf + st->ringfull;
+	accept = st->accepted + drop;
+	recv = accept + st->filtered;
+	ts[0] = (uint32_t)(now >> 32);
+	ts[1] = (uint32_t)now;
+
+	blk = pcapng_reserve(w, 128);
+	if (blk == NULL)
+		return -EIO;
+	p = blk + sizeof(struct pcapng_block_hdr);
+	memcpy(p, &iface->id, sizeof(iface->id));
+	p += sizeof(iface->id);
+	memcpy(p, ts, sizeof(ts));
+	p += sizeof(ts);
+	p = pcapng_put_opt(p, PCAPNG_OPT_ISB_IFRECV, &recv, sizeof(recv));
+	p = pcapng_put_opt(p, PCAPNG_OPT_ISB_FILTERACCEPT, &accept,
+			sizeof(accept));
+	p = pcapng_put_opt(p, PCAPNG_OPT_ISB_OSDROP, &drop, sizeof(drop));
+	p = pcapng_put_opt(p, PCAPNG_OPT_ISB_USRDELIV, &iface->delivered,
+			sizeof(iface->delivered));
+	p = pcapng_put_opt(p, PCAPNG_OPT_END, NULL, 0);
+	pcapng_end_block(w, blk, p, PCAPNG_BLOCK_ISB);
+
+	return 0;
+}
+
+struct pcapng_writer *
+pcapng_writer_open(const char *path, const char *dev_name, uint32_t snaplen)
+{
+	struct pcapng_writer *w;
+	struct timespec ts;
+	uint32_t d, q;
+	void *buf;
+
+	w = calloc(1, sizeof(*w));
+	if (w == NULL)
+		return NULL;
+	if (posix_memalign(&buf, PCAPNG_IO_ALIGN, PCAPNG_BUF_SIZE) != 0) {
+		free(w);
+		return NULL;
+	}
+	w->buf = buf;
+
+	w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+	/* O_DIRECT is not supported by all file systems, e.g. tmpfs */
+	if (w->fd < 0 && errno == EINVAL)
+		w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (w->fd < 0) {
+		printf("cannot open %s: %s\n", path, strerror(errno));
+		free(w->buf);
+		free(w);
+		return NULL;
+	}
+
+	snprintf(w->dev_name, sizeof(w->dev_name), "%s", dev_name);
+	w->snaplen = (snaplen != 0 && snaplen < PCAPNG_MAX_CAPLEN) ?
+		snaplen : PCAPNG_MAX_CAPLEN;
+	for (d = 0; d < PCAPNG_NB_DIR; d++)
+		for (q = 0; q < RTE_MAX_QUEUES_PER_PORT; q++)
+			w->ifs[d][q].id = -1;
+
+	/* reference point to convert the capture TSC to wall clock time */
+	w->tsc_hz = rte_get_tsc_hz();
+	clock_gettime(CLOCK_REALTIME, &ts);
+	w->tsc_base = rte_rdtsc();
+	w->ns_base = ts.tv_sec * NS_PER_S + ts.tv_nsec;
+
+	if (pcapng_write_shb(w) < 0) {
+		close(w->fd);
+		free(w->buf);
+		free(w);
+		return NULL;
+	}
+
+	return w;
+}
+
+void
+pcapng_writer_set_stats(struct pcapng_writer *w, uint32_t dir,
+		const struct rte_pdump_stats *stats, uint16_t queue)
+{
+	uint32_t d = pcapng_dir(dir);
+
+	w->stats[d] = stats;
+	w->stats_queue[d] = queue;
+}
+
+int
+pcapng_writer_write(struct pcapng_writer *w, uint32_t dir,
+		struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	struct pcapng_interface *iface;
+	const struct rte_mbuf *seg;
+	uint32_t d, i, caplen, origlen, pad, len, flags;
+	uint32_t hdr[5];
+	uint64_t ns;
+	uint8_t *blk, *p;
+
+	d = pcapng_dir(dir);
+	flags = (d == PCAPNG_DIR_RX) ? PCAPNG_EPB_INBOUND :
+		PCAPNG_EPB_OUTBOUND;
+
+	for (i = 0; i < nb_pkts; i++) {
+		iface = pcapng_get_interface(w, d,
+				RTE_PDUMP_MBUF_QUEUE(pkts[i]) %
+				RTE_MAX_QUEUES_PER_PORT);
+		if (iface == NULL)
+			return -EIO;
+
+		caplen = RTE_MIN(rte_pktmbuf_pkt_len(pkts[i]), w->snaplen);
+		origlen = RTE_MAX(RTE_PDUMP_MBUF_ORIG_LEN(pkts[i]), caplen);
+		pad = RTE_ALIGN(caplen, 4) - caplen;
+		ns = pcapng_tsc_to_ns(w, RTE_PDUMP_MBUF_TSC(pkts[i]));
+
+		blk = pcapng_reserve(w, PCAPNG_MAX_BLOCK);
+		if (blk == NULL)
+			return -EIO;
+		hdr[0] = iface->id;
+		hdr[1] = (uint32_t)(ns >> 32);
+		hdr[2] = (uint32_t)ns;
+		hdr[3] = caplen;
+		hdr[4] = origlen;
+		p = blk + sizeof(struct pcapng_block_hdr);
+		memcpy(p, hdr, sizeof(hdr));
+		p += sizeof(hdr);
+
+		for (seg = pkts[i], len = caplen; seg != NULL && len != 0;
+				seg = seg->next) {
+			uint32_t n = RTE_MIN(len, (uint32_t)seg->data_len);
+
+			memcpy(p, rte_pktmbuf_mtod(seg, void *), n);
+			p += n;
+			len -= n;
+		}
+		memset(p, 0, pad + len);
+		p += pad + len;
+
+		p = pcapng_put_opt(p, PCAPNG_OPT_EPB_FLAGS, &flags,
+				sizeof(flags));
+		p = pcapng_put_opt(p, PCAPNG_OPT_END, NULL, 0);
+		pcapng_end_block(w, blk, p, PCAPNG_BLOCK_EPB);
+		iface->delivered++;
+	}
+
+	return 0;
+}
+
+int
+pcapng_writer_close(struct pcapng_writer *w)
+{
+	static const struct rte_pdump_stats zero;
+	const struct rte_pdump_stats *st;
+	struct timespec ts;
+	uint64_t now;
+	uint32_t d, q;
+	int ret = 0;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	now = ts.tv_sec * NS_PER_S + ts.tv_nsec;
+
+	for (d = 0; d < PCAPNG_NB_DIR && ret == 0; d++) {
+		if (w->stats[d] == NULL)
+			continue;
+		if (w->stats_queue[d] != RTE_PDUMP_ALL_QUEUES) {
+			ret = pcapng_write_isb(w, d, w->stats_queue[d],
+					w->stats[d], now);
+			continue;
+		}
+		for (q = 0; q < RTE_MAX_QUEUES_PER_PORT && ret == 0; q++) {
+			st = &w->stats[d][q];
+			/* skip the queues which never saw a packet */
+			if (w->ifs[d][q].id < 0 &&
+					memcmp(st, &zero, sizeof(zero)) == 0)
+				continue;
+			ret = pcapng_write_isb(w, d, q, st, now);
+		}
+	}
+
+	if (ret == 0)
+		ret = pcapng_flush(w, 1);
+	if (close(w->fd) < 0 && ret == 0)
+		ret = -errno;
+	free(w->buf);
+	free(w);
+
+	return ret;
+}
@@ -0,0 +1,80 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _PDUMP_PCAPNG_H_
+#define _PDUMP_PCAPNG_H_
+
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+#include <rte_pdump.h>
+
+/*
+ * pcapng file writer of the dpdk-pdump tool.
+ *
+ * Every (queue, direction) pair of a capture gets its own interface
+ * description block, created when its first packet or counter is seen.
+ * Packet timestamps are taken from the TSC stamped by the pdump RX/TX
+ * callbacks, and interface statistics blocks with the capture counters
+ * are written when the file is closed.
+ *
+ * Blocks are assembled in a large aligned buffer which is written out
+ * in multiples of the page size, with O_DIRECT where the file system
+ * supports it.
+ */
+struct pcapng_writer;
+
+/* Creates the file and writes its section header block. */
+struct pcapng_writer *
+pcapng_writer_open(const char *path, const char *dev_name, uint32_t snaplen);
+
+/*
+ * Registers the per queue capture counters of one direction, as passed
+ * to rte_pdump_enable() in struct rte_pdump_filter.
+ */
+void
+pcapng_writer_set_stats(struct pcapng_writer *w, uint32_t dir,
+		const struct rte_pdump_stats *stats, uint16_t queue);
+
+/*
+ * Appends the captured packets of the given direction as enhanced packet
+ * blocks. The mbufs are not freed. Returns 0 or a negative errno.
+ */
+int
+pcapng_writer_write(struct pcapng_writer *w, uint32_t dir,
+		struct rte_mbuf **pkts, uint16_t nb_pkts);
+
+/* Writes the statistics blocks, flushes and closes the file. */
+int
+pcapng_writer_close(struct pcapng_writer *w);
+
+#endif /* _PDUMP_PCAPNG_H_ */
@@ -57,6 +57,10 @@
 #include <rte_atomic.h>
 #include <rte_branch_prediction.h>
 #include <rte_string_fns.h>
+#include <rte_cycles.h>
+#include <rte_jobstats_lcore.h>
+#include <rte_latencystats.h>
+#include <rte_metrics.h>
 
 /* Maximum long option length for option parsing. */
 #define MAX_LONG_OPT_SZ 64
@@ -74,6 +78,12 @@ static uint32_t reset_stats;
 static uint32_t reset_xstats;
 /**< Enable memory info. */
 static uint32_t mem_info;
+/**< Enable lcore busyness stats. */
+static uint32_t lcore_stats;
+/**< Enable latency stats. */
+static uint32_t latency_stats;
+/**< Enable metrics. */
+static uint32_t enable_metrics;
 
 /**< display usage */
 static void
@@ -86,7 +96,13 @@ proc_info_usage(const char *prgname)
 		"  --xstats: to display extended port statistics, disabled by "
 			"default\n"
 		"  --stats-reset: to reset port statistics\n"
-		"  --xstats-reset: to reset port extended statistics\n",
+		"  --xstats-reset: to reset port extended statistics\n"
+		"  --lcore-stats: to display lcore busy and idle time of the "
+			"primary process\n"
+		"  --latency-stats: to display the latency statistics of the "
+			"TX queues of the ports\n"
+		"  --metrics: to display the global metrics and the metrics of "
+			"the ports\n",
 		prgname);
 }
 
@@ -128,6 +144,9 @@ proc_info_parse_args(int argc, char **argv)
 		{"stats-reset", 0, NULL, 0},
 		{"xstats", 0, NULL, 0},
 		{"xstats-reset", 0, NULL, 0},
+		{"lcore-stats", 0, NULL, 0},
+		{"latency-stats", 0, NULL, 0},
+		{"metrics", 0, NULL, 0},
 		{NULL, 0, 0, 0}
 	};
 
@@ -167,6 +186,18 @@ proc_info_parse_args(int argc, char **argv)
 			else if (!strncmp(long_option[option_index].name, "xstats-reset",
 					MAX_LONG_OPT_SZ))
 				reset_xstats = 1;
+			/* Print lcore stats */
+			else if (!strncmp(long_option[option_index].name,
+					"lcore-stats", MAX_LONG_OPT_SZ))
+				lcore_stats = 1;
+			/* Print latency stats */
+			else if (!strncmp(long_option[option_index].name,
+					"latency-stats", MAX_LONG_OPT_SZ))
+				latency_stats = 1;
+			/* Print metrics */
+			else if (!strncmp(long_option[option_index].name,
+					"metrics", MAX_LONG_OPT_SZ))
+				enable_metrics = 1;
 			break;
 
 		default:
@@ -193,6 +224,152 @@ meminfo_display(void)
 	printf("---------- END_TAIL_QUEUES ------------\n");
 }
 
+static void
+lcore_stats_display(void)
+{
+	struct rte_jobstats_lcore st;
+	uint64_t hz = rte_get_tsc_hz();
+	unsigned lcore_id, i;
+	int ret;
+
+	static const char *lcore_stats_border = "########################";
+
+	ret = rte_jobstats_lcore_init();
+	if (ret < 0) {
+		printf("lcore stats not enabled by the primary process\n");
+		return;
+	}
+
+	printf("\n  %s lcore statistics %s\n", lcore_stats_border,
+		   lcore_stats_border);
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (rte_jobstats_lcore_read(lcore_id, &st) < 0 ||
+				st.polls == 0)
+			continue;
+
+		printf("  lcore %-3u busy: %3u%%  busy-time: %-10"PRIu64"ms"
+		       "  idle-time: %-10"PRIu64"ms\n", lcore_id,
+		       rte_jobstats_lcore_busy_percent(NULL, &st),
+		       st.busy_cycles * 1000 / hz,
+		       st.idle_cycles * 1000 / hz);
+		printf("  polls: %-12"PRIu64"  work: %-12"PRIu64
+		       "  empty polls: %-12"PRIu64"\n", st.polls, st.work,
+		       st.hist[0]);
+		printf("  work per poll:");
+		for (i = 1; i < RTE_JOBSTATS_LCORE_HIST_SIZE; i++) {
+			if (i == RTE_JOBSTATS_LCORE_HIST_SIZE - 1)
+				printf(" >=%u:", 1u << (i - 1));
+			else
+				printf(" %u-%u:", 1u << (i - 1),
+				       (1u << i) - 1);
+			printf("%"PRIu64, st.hist[i]);
+		}
+		printf("\n\n");
+	}
+	printf("  %s##################%s\n", lcore_stats_border,
+		   lcore_stats_border);
+}
+
+static void
+latency_stats_print(const char *name, const struct rte_latencystats *st)
+{
+	unsigned i;
+
+	printf("  %s samples: %-12"PRIu64"  min: %-8"PRIu64"ns"
+	       "  avg: %-8"PRIu64"ns  max: %-8"PRIu64"ns"
+	       "  jitter: %-8"PRIu64"ns\n", name, st->samples, st->min,
+	       st->avg, st->max, st->jitter);
+	printf("  latency:");
+	for (i = 0; i < RTE_LATENCYSTATS_HIST_SIZE; i++) {
+		if (st->hist[i] == 0)
+			continue;
+		if (i == RTE_LATENCYSTATS_HIST_SIZE - 1)
+			printf(" >=%"PRIu64"ns:", UINT64_C(1) << i);
+		else
+			printf(" <%"PRIu64"ns:", UINT64_C(2) << i);
+		printf("%"PRIu64, st->hist[i]);
+	}
+	printf("\n\n");
+}
+
+static void
+latency_stats_display(uint8_t port_id)
+{
+	struct rte_latencystats st;
+	char name[16];
+	uint16_t qid;
+
+	static const char *latency_stats_border = "########################";
+
+	if (rte_latencystats_init(0) < 0) {
+		printf("latency stats not enabled by the primary process\n");
+		return;
+	}
+
+	printf("\n  %s Latency statistics for port %-2d %s\n",
+		   latency_stats_border, port_id, latency_stats_border);
+	rte_latencystats_get(port_id, RTE_LATENCYSTATS_ALL_QUEUES, &st);
+	latency_stats_print("all queues", &st);
+	for (qid = 0; qid < RTE_LATENCYSTATS_MAX_QUEUES; qid++) {
+		if (rte_latencystats_get(port_id, qid, &st) < 0 ||
+				st.samples == 0)
+			continue;
+		snprintf(name, sizeof(name), "queue %-3u", qid);
+		latency_stats_print(name, &st);
+	}
+	printf("  %s##############################%s\n",
+		   latency_stats_border, latency_stats_border);
+}
+
+static void
+metrics_display(int port_id)
+{
+	struct rte_metric_name *names;
+	struct rte_metric_value *values;
+	int len, ret, i;
+
+	static const char *metrics_border = "########################";
+
+	len = rte_metrics_get_names(NULL, 0);
+	if (len < 0) {
+		printf("metrics not enabled by the primary process\n");
+		return;
+	}
+	if (len == 0)
+		return;
+
+	names = malloc(sizeof(*names) * len);
+	values = malloc(sizeof(*values) * len);
+	if (names == NULL || values == NULL) {
+		printf("Cannot allocate memory for metrics\n");
+		free(names);
+		free(values);
+		return;
+	}
+
+	ret = rte_metrics_get_values(port_id, values, len);
+	if (ret != len || rte_metrics_get_names(names, len) != len) {
+		printf("Cannot get metrics\n");
+		free(names);
+		free(values);
+		return;
+	}
+
+	if (port_id == RTE_METRICS_GLOBAL)
+		printf("\n  %s Global metrics %s\n", metrics_border,
+			   metrics_border);
+	else
+		printf("\n  %s Metrics for port %-2d %s\n", metrics_border,
+			   port_id, metrics_border);
+	for (i = 0; i < ret; i++)
+		printf("%s: %"PRIu64"\n", names[values[i].key].name,
+		       values[i].value);
+	printf("  %s################%s\n", metrics_border, metrics_border);
+
+	free(names);
+	free(values);
+}
+
 static void
 nic_stats_display(uint8_t port_id)
 {
@@ -339,6 +516,17 @@ main(int argc, char **argv)
 		return 0;
 	}
 
+	if (lcore_stats) {
+		lcore_stats_display();
+		return 0;
+	}
+
+	if (enable_metrics) {
+		if (rte_metrics_init(SOCKET_ID_ANY) < 0)
+			enable_metrics = 0;
+		metrics_display(RTE_METRICS_GLOBAL);
+	}
+
 	nb_ports = rte_eth_dev_count();
 	if (nb_ports == 0)
 		rte_exit(EXIT_FAILURE, "No Ethernet ports - bye\n");
@@ -357,6 +545,10 @@ main(int argc, char **argv)
 				nic_stats_clear(i);
 			else if (reset_xstats)
 				nic_xstats_clear(i);
+			else if (latency_stats)
+				latency_stats_display(i);
+			else if (enable_metrics)
+				metrics_display(i);
 		}
 	}
 
@@ -222,6 +222,12 @@ parallel_test_group_list = [
 		 "Func" :	default_autotest,
 		 "Report" :	None,
 		},
+		{
+		 "Name" :	"Malloc dynamic memory autotest",
+		 "Command" : 	"malloc_dyn_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
 		{
 		 "Name" :	"Multi-process autotest",
 		 "Command" : 	"multiprocess_autotest",
@@ -345,6 +351,60 @@ parallel_test_group_list = [
 		 "Func" :default_autotest,
 		 "Report" :None,
 		 },
+		{
+		 "Name" :	"IP fragmentation autotest",
+		 "Command" :	"ipfrag_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"GRO autotest",
+		 "Command" :	"gro_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"GSO autotest",
+		 "Command" :	"gso_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"Packet type parser autotest",
+		 "Command" :	"net_ptype_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"Latency stats autotest",
+		 "Command" :	"latencystats_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"Metrics autotest",
+		 "Command" :	"metrics_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"Jobstats autotest",
+		 "Command" :	"jobstats_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"Generic flow API autotest",
+		 "Command" :	"flow_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"Eventdev sw autotest",
+		 "Command" :	"eventdev_sw_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
 	]
 },
 ]
@@ -378,6 +438,19 @@ non_parallel_test_group_list = [
 		},
 	]
 },
+{
+	"Prefix":	"malloc_perf",
+	"Memory" :	per_sockets(256),
+	"Tests" :
+	[
+		{
+		 "Name" :	"Malloc performance autotest",
+		 "Command" : 	"malloc_perf_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+	]
+},
 {
 	"Prefix":	"memcpy_perf",
 	"Memory" :	per_sockets(512),
@@ -456,6 +529,19 @@ non_parallel_test_group_list = [
 		},
 	]
 },
+{
+	"Prefix":	"mbuf_perf",
+	"Memory" :	per_sockets(512),
+	"Tests" :
+	[
+		{
+		 "Name" :	"Mbuf performance autotest",
+		 "Command" : 	"mbuf_perf_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+	]
+},
 
 #
 # Please always make sure that ring_perf is the last test!
@@ -40,13 +40,16 @@ import sys, pexpect, time, os, re
 def default_autotest(child, test_name):
 	child.sendline(test_name)
 	result = child.expect(["Test OK", "Test Failed",
-		"Command not found", pexpect.TIMEOUT], timeout = 900)
+		"Command not found", pexpect.TIMEOUT, "Test Skipped"],
+		timeout = 900)
 	if result == 1:
 		return -1, "Fail"
 	elif result == 2:
 		return -1, "Fail [Not found]"
 	elif result == 3:
 		return -1, "Fail [Timeout]"
+	elif result == 4:
+		return 0, "Skipped [Not Run]"
 	return 0, "Success"
 
 # autotest used to run dump commands
@@ -39,6 +39,7 @@
 
 #define TEST_SUCCESS  (0)
 #define TEST_FAILED  (-1)
+#define TEST_SKIPPED  (77)
 
 /* Before including test.h file you can define
  * TEST_TRACE_FAILURE(_file, _line, _func) macro to better trace/debug test
@@ -0,0 +1,465 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_dev.h>
+#include <rte_errno.h>
+#include <rte_eventdev.h>
+
+#include "test.h"
+
+/*
+ * Software event device
+ * =====================
+ *
+ * Drive the software scheduler of an "event_sw" virtual device from a single
+ * lcore, calling rte_event_schedule() between the enqueues and dequeues:
+ *
+ * - check the configuration and link API;
+ * - atomic queues keep a flow on one port while its events are in flight;
+ * - ordered queues restore the order of the events forwarded by the ports;
+ * - parallel queues spread the events over the linked ports;
+ * - queue priorities and the new event threshold of the ports.
+ */
+
+#define EVDEV_SW_NAME "event_sw0"
+#define NB_EVENTS_LIMIT 64
+
+static int evdev = -1;
+
+static int
+testsuite_setup(void)
+{
+	evdev = rte_event_dev_get_dev_id(EVDEV_SW_NAME);
+	if (evdev < 0) {
+		if (rte_eal_vdev_init(EVDEV_SW_NAME, NULL) < 0) {
+			printf("cannot create %s\n", EVDEV_SW_NAME);
+			return TEST_FAILED;
+		}
+		evdev = rte_event_dev_get_dev_id(EVDEV_SW_NAME);
+	}
+	return evdev < 0 ? TEST_FAILED : TEST_SUCCESS;
+}
+
+static void
+ut_teardown(void)
+{
+	rte_event_dev_stop(evdev);
+}
+
+/* Configure the device, then set up its queues with the given flags and
+ * its ports with the default configuration.
+ */
+static int
+init(const uint32_t queue_cfg[], uint8_t nb_queues, uint8_t nb_ports)
+{
+	struct rte_event_dev_config conf = {
+		.nb_events_limit = NB_EVENTS_LIMIT,
+		.nb_event_queues = nb_queues,
+		.nb_event_ports = nb_ports,
+		.nb_event_queue_flows = 1024,
+		.nb_event_port_dequeue_depth = 16,
+		.nb_event_port_enqueue_depth = 16,
+	};
+	struct rte_event_queue_conf qconf;
+	uint8_t i;
+
+	TEST_ASSERT_SUCCESS(rte_event_dev_configure(evdev, &conf),
+		"cannot configure the device");
+
+	for (i = 0; i < nb_queues; i++) {
+		TEST_ASSERT_SUCCESS(rte_event_queue_default_conf_get(evdev,
+				i, &qconf), "cannot get queue %u conf", i);
+		qconf.event_queue_cfg = queue_cfg[i];
+		TEST_ASSERT_SUCCESS(rte_event_queue_setup(evdev, i, &qconf),
+			"cannot set up queue %u", i);
+	}
+	for (i = 0; i < nb_ports; i++)
+		TEST_ASSERT_SUCCESS(rte_event_port_setup(evdev, i, NULL),
+			"cannot set up port %u", i);
+
+	return TEST_SUCCESS;
+}
+
+static int
+link_port(uint8_t port, uint8_t queue)
+{
+	TEST_ASSERT_EQUAL(rte_event_port_link(evdev, port, &queue, NULL, 1),
+		1, "cannot link port %u to queue %u", port, queue);
+	return TEST_SUCCESS;
+}
+
+static int
+enqueue_new(uint8_t port, uint8_t queue, uint32_t flow_id, uint64_t u64)
+{
+	struct rte_event ev = {
+		.flow_id = flow_id,
+		.event_type = RTE_EVENT_TYPE_CPU,
+		.op = RTE_EVENT_OP_NEW,
+		.sched_type = RTE_SCHED_TYPE_ATOMIC,
+		.queue_id = queue,
+		.u64 = u64,
+	};
+
+	TEST_ASSERT_EQUAL(rte_event_enqueue_burst(evdev, port, &ev, 1), 1,
+		"cannot enqueue event %" PRIu64, u64);
+	return TEST_SUCCESS;
+}
+
+static int
+test_sw_api(void)
+{
+	const uint32_t cfg[] = {
+		RTE_EVENT_QUEUE_CFG_ALL_TYPES,
+		RTE_EVENT_QUEUE_CFG_PARALLEL_ONLY |
+			RTE_EVENT_QUEUE_CFG_SINGLE_LINK,
+	};
+	struct rte_event_dev_info info;
+	struct rte_event_dev_config conf;
+	uint8_t queues[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	uint8_t prios[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	uint8_t q1 = 1;
+
+	TEST_ASSERT_SUCCESS(rte_event_dev_info_get(evdev, &info),
+		"cannot get device info");
+	TEST_ASSERT(info.max_event_ports >= 4 && info.max_event_queues >= 2,
+		"too few ports or queues");
+	TEST_ASSERT(!(info.event_dev_cap &
+			RTE_EVENT_DEV_CAP_DISTRIBUTED_SCHED),
+		"the software device needs rte_event_schedule()");
+
+	memset(&conf, 0, sizeof(conf));
+	conf.nb_events_limit = info.max_num_events + 1;
+	conf.nb_event_queues = 1;
+	conf.nb_event_ports = 1;
+	conf.nb_event_queue_flows = 1;
+	conf.nb_event_port_dequeue_depth = 1;
+	conf.nb_event_port_enqueue_depth = 1;
+	TEST_ASSERT_EQUAL(rte_event_dev_configure(evdev, &conf), -EINVAL,
+		"accepted too many events");
+
+	TEST_ASSERT_SUCCESS(init(cfg, 2, 2), "cannot initialize");
+	TEST_ASSERT_EQUAL(rte_event_queue_count(evdev), 2, "bad queues");
+	TEST_ASSERT_EQUAL(rte_event_port_count(evdev), 2, "bad ports");
+
+	TEST_ASSERT_EQUAL(rte_event_port_link(evdev, 0, NULL, NULL, 0), 2,
+		"cannot link all queues");
+	TEST_ASSERT_EQUAL(rte_event_port_links_get(evdev, 0, queues, prios),
+		2, "bad links");
+	TEST_ASSERT(queues[0] == 0 && queues[1] == 1 &&
+		prios[0] == RTE_EVENT_DEV_PRIORITY_NORMAL, "bad links");
+
+	/* a single link queue serves one port */
+	TEST_ASSERT_EQUAL(rte_event_port_link(evdev, 1, &q1, NULL, 1), 0,
+		"linked a single link queue twice");
+	TEST_ASSERT_EQUAL(rte_errno, EDQUOT, "bad error");
+	TEST_ASSERT_EQUAL(rte_event_port_unlink(evdev, 0, &q1, 1), 1,
+		"cannot unlink");
+	TEST_ASSERT_EQUAL(rte_event_port_links_get(evdev, 0, queues, prios),
+		1, "bad links after unlink");
+	TEST_ASSERT_SUCCESS(link_port(1, 1), "cannot link");
+
+	TEST_ASSERT_SUCCESS(rte_event_dev_start(evdev), "cannot start");
+	TEST_ASSERT_EQUAL(rte_event_dev_configure(evdev, &conf), -EBUSY,
+		"configured while started");
+	TEST_ASSERT_EQUAL(rte_event_port_setup(evdev, 0, NULL), -EBUSY,
+		"set up a port while started");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_sw_atomic(void)
+{
+	const uint32_t cfg[] = { RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY };
+	struct rte_event ev[16];
+	uint64_t next[2] = { 0, 0 };
+	int flow_port[2] = { -1, -1 };
+	uint16_t n, i;
+	uint8_t p;
+
+	/* ports 0 and 1 serve the queue, port 2 produces */
+	TEST_ASSERT_SUCCESS(init(cfg, 1, 3), "cannot initialize");
+	TEST_ASSERT_SUCCESS(link_port(0, 0), "cannot link");
+	TEST_ASSERT_SUCCESS(link_port(1, 0), "cannot link");
+	TEST_ASSERT_SUCCESS(rte_event_dev_start(evdev), "cannot start");
+
+	for (i = 0; i < 8; i++)
+		TEST_ASSERT_SUCCESS(enqueue_new(2, 0, i % 2, i / 2),
+			"cannot enqueue");
+	rte_event_schedule(evdev);
+
+	/* each flow is on a single port, in order */
+	for (p = 0; p < 2; p++) {
+		n = rte_event_dequeue_burst(evdev, p, ev, RTE_DIM(ev), 0);
+		for (i = 0; i < n; i++) {
+			uint32_t f = ev[i].flow_id;
+
+			TEST_ASSERT_EQUAL(ev[i].sched_type,
+				RTE_SCHED_TYPE_ATOMIC, "bad sched type");
+			TEST_ASSERT(flow_port[f] == -1 || flow_port[f] == p,
+				"flow %u on two ports", f);
+			flow_port[f] = p;
+			TEST_ASSERT_EQUAL(ev[i].u64, next[f]++,
+				"flow %u out of order", f);
+		}
+	}
+	TEST_ASSERT(next[0] == 4 && next[1] == 4, "events lost");
+	TEST_ASSERT(flow_port[0] != flow_port[1], "flows not balanced");
+
+	/* while its events are in flight, a flow stays on its port */
+	TEST_ASSERT_SUCCESS(enqueue_new(2, 0, 0, 4), "cannot enqueue");
+	rte_event_schedule(evdev);
+	rte_event_schedule(evdev);
+	p = flow_port[0];
+	n = rte_event_dequeue_burst(evdev, !p, ev, RTE_DIM(ev), 0);
+	TEST_ASSERT_EQUAL(n, 0, "flow 0 moved while in flight");
+	n = rte_event_dequeue_burst(evdev, p, ev, RTE_DIM(ev), 0);
+	TEST_ASSERT_EQUAL(n, 1, "flow 0 not scheduled to its port");
+	TEST_ASSERT_EQUAL(ev[0].u64, 4, "bad event");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_sw_ordered(void)
+{
+	const uint32_t cfg[] = {
+		RTE_EVENT_QUEUE_CFG_ORDERED_ONLY,
+		RTE_EVENT_QUEUE_CFG_PARALLEL_ONLY,
+	};
+	struct rte_event ev[2][16], out[16];
+	uint16_t n[2], nb_out, i;
+	uint8_t p;
+
+	/* ports 0 and 1 serve the ordered queue, port 2 the next stage,
+	 * port 3 produces
+	 */
+	TEST_ASSERT_SUCCESS(init(cfg, 2, 4), "cannot initialize");
+	TEST_ASSERT_SUCCESS(link_port(0, 0), "cannot link");
+	TEST_ASSERT_SUCCESS(link_port(1, 0), "cannot link");
+	TEST_ASSERT_SUCCESS(link_port(2, 1), "cannot link");
+	TEST_ASSERT_SUCCESS(rte_event_dev_start(evdev), "cannot start");
+
+	for (i = 0; i < 8; i++)
+		TEST_ASSERT_SUCCESS(enqueue_new(3, 0, 0, i),
+			"cannot enqueue");
+	rte_event_schedule(evdev);
+
+	for (p = 0; p < 2; p++) {
+		n[p] = rte_event_dequeue_burst(evdev, p, ev[p],
+			RTE_DIM(ev[p]), 0);
+		TEST_ASSERT(n[p] > 0, "ordered events not spread");
+		for (i = 0; i < n[p]; i++) {
+			ev[p][i].op = RTE_EVENT_OP_FORWARD;
+			ev[p][i].queue_id = 1;
+		}
+	}
+	TEST_ASSERT_EQUAL(n[0] + n[1], 8, "events lost");
+
+	/* the second port completes first */
+	TEST_ASSERT_EQUAL(rte_event_enqueue_burst(evdev, 1, ev[1], n[1]),
+		n[1], "cannot forward");
+	rte_event_schedule(evdev);
+	rte_event_schedule(evdev);
+	TEST_ASSERT_EQUAL(rte_event_dequeue_burst(evdev, 2, out,
+			RTE_DIM(out), 0), 0, "events overtook the first");
+
+	TEST_ASSERT_EQUAL(rte_event_enqueue_burst(evdev, 0, ev[0], n[0]),
+		n[0], "cannot forward");
+	rte_event_schedule(evdev);
+	rte_event_schedule(evdev);
+	nb_out = rte_event_dequeue_burst(evdev, 2, out, RTE_DIM(out), 0);
+	TEST_ASSERT_EQUAL(nb_out, 8, "events lost");
+	for (i = 0; i < nb_out; i++)
+		TEST_ASSERT_EQUAL(out[i].u64, i, "event %u out of order", i);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_sw_parallel(void)
+{
+	const uint32_t cfg[] = { RTE_EVENT_QUEUE_CFG_PARALLEL_ONLY };
+	struct rte_event ev[16];
+	uint16_t n0, n1, i;
+
+	TEST_ASSERT_SUCCESS(init(cfg, 1, 3), "cannot initialize");
+	TEST_ASSERT_SUCCESS(link_port(0, 0), "cannot link");
+	TEST_ASSERT_SUCCESS(link_port(1, 0), "cannot link");
+	TEST_ASSERT_SUCCESS(rte_event_dev_start(evdev), "cannot start");
+
+	/* a single flow is spread over the ports */
+	for (i = 0; i < 8; i++)
+		TEST_ASSERT_SUCCESS(enqueue_new(2, 0, 0, i),
+			"cannot enqueue");
+	rte_event_schedule(evdev);
+
+	n0 = rte_event_dequeue_burst(evdev, 0, ev, RTE_DIM(ev), 0);
+	n1 = rte_event_dequeue_burst(evdev, 1, ev, RTE_DIM(ev), 0);
+	TEST_ASSERT(n0 == 4 && n1 == 4, "unbalanced: %u and %u", n0, n1);
+	TEST_ASSERT_EQUAL(ev[0].sched_type, RTE_SCHED_TYPE_PARALLEL,
+		"bad sched type");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_sw_priority(void)
+{
+	const uint32_t cfg[] = {
+		RTE_EVENT_QUEUE_CFG_PARALLEL_ONLY,
+		RTE_EVENT_QUEUE_CFG_PARALLEL_ONLY,
+	};
+	struct rte_event_queue_conf qconf;
+	struct rte_event_port_conf pconf;
+	struct rte_event ev[16];
+	uint16_t n, i;
+
+	TEST_ASSERT_SUCCESS(init(cfg, 2, 2), "cannot initialize");
+
+	/* queue 1 preempts queue 0 on a port taking 4 events */
+	TEST_ASSERT_SUCCESS(rte_event_queue_default_conf_get(evdev, 1,
+			&qconf), "cannot get queue conf");
+	qconf.event_queue_cfg = RTE_EVENT_QUEUE_CFG_PARALLEL_ONLY;
+	qconf.priority = RTE_EVENT_DEV_PRIORITY_HIGHEST;
+	TEST_ASSERT_SUCCESS(rte_event_queue_setup(evdev, 1, &qconf),
+		"cannot set up queue");
+	TEST_ASSERT_SUCCESS(rte_event_port_default_conf_get(evdev, 0,
+			&pconf), "cannot get port conf");
+	pconf.dequeue_depth = 4;
+	TEST_ASSERT_SUCCESS(rte_event_port_setup(evdev, 0, &pconf),
+		"cannot set up port");
+	TEST_ASSERT_EQUAL(rte_event_port_link(evdev, 0, NULL, NULL, 0), 2,
+		"cannot link");
+	TEST_ASSERT_SUCCESS(rte_event_dev_start(evdev), "cannot start");
+
+	for (i = 0; i < 4; i++)
+		TEST_ASSERT_SUCCESS(enqueue_new(1, 0, 0, i),
+			"cannot enqueue");
+	for (i = 0; i < 4; i++)
+		TEST_ASSERT_SUCCESS(enqueue_new(1, 1, 0, 100 + i),
+			"cannot enqueue");
+	rte_event_schedule(evdev);
+
+	n = rte_event_dequeue_burst(evdev, 0, ev, RTE_DIM(ev), 0);
+	TEST_ASSERT_EQUAL(n, 4, "bad dequeue depth");
+	for (i = 0; i < n; i++)
+		TEST_ASSERT_EQUAL(ev[i].queue_id, 1,
+			"low priority event scheduled first");
+
+	/* the releases of the next dequeue make room for queue 0 */
+	TEST_ASSERT_EQUAL(rte_event_dequeue_burst(evdev, 0, ev,
+			RTE_DIM(ev), 0), 0, "unexpected events");
+	rte_event_schedule(evdev);
+	n = rte_event_dequeue_burst(evdev, 0, ev, RTE_DIM(ev), 0);
+	TEST_ASSERT_EQUAL(n, 4, "low priority events not scheduled");
+	TEST_ASSERT_EQUAL(ev[0].queue_id, 0, "bad queue");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_sw_new_event_threshold(void)
+{
+	const uint32_t cfg[] = { RTE_EVENT_QUEUE_CFG_ALL_TYPES };
+	struct rte_event_port_conf pconf = {
+		.new_event_threshold = 8,
+		.dequeue_depth = 16,
+		.enqueue_depth = 16,
+	};
+	struct rte_event ev[16];
+	uint16_t i, n;
+
+	TEST_ASSERT_SUCCESS(init(cfg, 1, 2), "cannot initialize");
+	TEST_ASSERT_SUCCESS(rte_event_port_setup(evdev, 1, &pconf),
+		"cannot set up port");
+	TEST_ASSERT_SUCCESS(link_port(0, 0), "cannot link");
+	TEST_ASSERT_SUCCESS(rte_event_dev_start(evdev), "cannot start");
+
+	memset(ev, 0, sizeof(ev));
+	for (i = 0; i < 10; i++) {
+		ev[i].op = RTE_EVENT_OP_NEW;
+		ev[i].sched_type = RTE_SCHED_TYPE_PARALLEL;
+		ev[i].u64 = i;
+	}
+	rte_errno = 0;
+	TEST_ASSERT_EQUAL(rte_event_enqueue_burst(evdev, 1, ev, 10), 8,
+		"threshold not applied");
+	TEST_ASSERT_EQUAL(rte_errno, ENOSPC, "bad error");
+
+	rte_event_schedule(evdev);
+	n = rte_event_dequeue_burst(evdev, 0, ev, RTE_DIM(ev), 0);
+	TEST_ASSERT_EQUAL(n, 8, "events lost");
+
+	/* release half of the events explicitly, the rest implicitly */
+	for (i = 0; i < 4; i++)
+		ev[i].op = RTE_EVENT_OP_RELEASE;
+	TEST_ASSERT_EQUAL(rte_event_enqueue_burst(evdev, 0, ev, 4), 4,
+		"cannot release");
+	TEST_ASSERT_EQUAL(rte_event_dequeue_burst(evdev, 0, ev,
+			RTE_DIM(ev), 0), 0, "unexpected events");
+	rte_event_schedule(evdev);
+
+	TEST_ASSERT_SUCCESS(enqueue_new(1, 0, 0, 0),
+		"released events still in flight");
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite eventdev_sw_testsuite = {
+	.suite_name = "software event device unit test suite",
+	.setup = testsuite_setup,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE_ST(NULL, ut_teardown, test_sw_api),
+		TEST_CASE_ST(NULL, ut_teardown, test_sw_atomic),
+		TEST_CASE_ST(NULL, ut_teardown, test_sw_ordered),
+		TEST_CASE_ST(NULL, ut_teardown, test_sw_parallel),
+		TEST_CASE_ST(NULL, ut_teardown, test_sw_priority),
+		TEST_CASE_ST(NULL, ut_teardown, test_sw_new_event_threshold),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_eventdev_sw(void)
+{
+	return unit_test_suite_runner(&eventdev_sw_testsuite);
+}
+
+REGISTER_TEST_COMMAND(eventdev_sw_autotest, test_eventdev_sw);
@@ -0,0 +1,399 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <rte_errno.h>
+#include <rte_ethdev.h>
+#include <rte_flow.h>
+#include <rte_flow_driver.h>
+
+#include "test.h"
+
+/*
+ * Generic flow API
+ * ================
+ *
+ * Allocate fake ports with and without rte_flow support and check that
+ * the ethdev layer forwards validate, create, destroy and flush to the
+ * driver, propagates its errors, and fails with ENOSYS on ports whose
+ * driver has no filter_ctrl callback or no generic filter support.
+ */
+
+#define FLOW_TEST_MAX_RULES 4
+
+struct rte_flow {
+	int used;
+};
+
+static struct rte_flow flow_test_rules[FLOW_TEST_MAX_RULES];
+
+static struct rte_eth_dev *flow_dev;
+static struct rte_eth_dev *no_ctrl_dev;
+static struct rte_eth_dev *no_generic_dev;
+
+static const struct rte_flow_attr flow_attr = { .ingress = 1 };
+
+static const struct rte_flow_item flow_pattern[] = {
+	{ .type = RTE_FLOW_ITEM_TYPE_ETH },
+	{ .type = RTE_FLOW_ITEM_TYPE_END },
+};
+
+static const struct rte_flow_item flow_bad_pattern[] = {
+	{ .type = RTE_FLOW_ITEM_TYPE_ETH },
+	{ .type = RTE_FLOW_ITEM_TYPE_VXLAN },
+	{ .type = RTE_FLOW_ITEM_TYPE_END },
+};
+
+static const struct rte_flow_action_queue flow_queue = { .index = 0 };
+
+static const struct rte_flow_action flow_actions[] = {
+	{ .type = RTE_FLOW_ACTION_TYPE_QUEUE, .conf = &flow_queue },
+	{ .type = RTE_FLOW_ACTION_TYPE_END },
+};
+
+/* Accept ETH patterns only, with a QUEUE action. */
+static int
+flow_test_validate(struct rte_eth_dev *dev __rte_unused,
+		   const struct rte_flow_attr *attr,
+		   const struct rte_flow_item pattern[],
+		   const struct rte_flow_action actions[],
+		   struct rte_flow_error *error)
+{
+	if (!attr->ingress || attr->egress)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ATTR, attr,
+				"only ingress is supported");
+	if (pattern[0].type != RTE_FLOW_ITEM_TYPE_ETH)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, &pattern[0],
+				"ETH item expected");
+	if (pattern[1].type != RTE_FLOW_ITEM_TYPE_END)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, &pattern[1],
+				"unsupported item");
+	if (actions[0].type != RTE_FLOW_ACTION_TYPE_QUEUE ||
+	    actions[1].type != RTE_FLOW_ACTION_TYPE_END)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ACTION, actions,
+				"only QUEUE is supported");
+	return 0;
+}
+
+static struct rte_flow *
+flow_test_create(struct rte_eth_dev *dev,
+		 const struct rte_flow_attr *attr,
+		 const struct rte_flow_item pattern[],
+		 const struct rte_flow_action actions[],
+		 struct rte_flow_error *error)
+{
+	unsigned int i;
+
+	if (flow_test_validate(dev, attr, pattern, actions, error))
+		return NULL;
+	for (i = 0; i < FLOW_TEST_MAX_RULES; i++) {
+		if (!flow_test_rules[i].used) {
+			flow_test_rules[i].used = 1;
+			return &flow_test_rules[i];
+		}
+	}
+	rte_flow_error_set(error, ENOMEM, RTE_FLOW_ERROR_TYPE_HANDLE, NULL,
+			   "no more rules");
+	return NULL;
+}
+
+static int
+flow_test_destroy(struct rte_eth_dev *dev __rte_unused,
+		  struct rte_flow *flow,
+		  struct rte_flow_error *error)
+{
+	if (flow < flow_test_rules ||
+	    flow >= flow_test_rules + FLOW_TEST_MAX_RULES || !flow->used)
+		return rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_HANDLE, flow,
+				"unknown rule");
+	flow->used = 0;
+	return 0;
+}
+
+static int
+flow_test_flush(struct rte_eth_dev *dev __rte_unused,
+		struct rte_flow_error *error __rte_unused)
+{
+	memset(flow_test_rules, 0, sizeof(flow_test_rules));
+	return 0;
+}
+
+static const struct rte_flow_ops flow_test_ops = {
+	.validate = flow_test_validate,
+	.create = flow_test_create,
+	.destroy = flow_test_destroy,
+	.flush = flow_test_flush,
+};
+
+static int
+flow_test_filter_ctrl(struct rte_eth_dev *dev __rte_unused,
+		      enum rte_filter_type filter_type,
+		      enum rte_filter_op filter_op,
+		      void *arg)
+{
+	if (filter_type != RTE_ETH_FILTER_GENERIC ||
+	    filter_op != RTE_ETH_FILTER_GET)
+		return -EINVAL;
+	*(const void **)arg = &flow_test_ops;
+	return 0;
+}
+
+static int
+flow_test_filter_ctrl_no_generic(struct rte_eth_dev *dev __rte_unused,
+				 enum rte_filter_type filter_type __rte_unused,
+				 enum rte_filter_op filter_op __rte_unused,
+				 void *arg __rte_unused)
+{
+	return -ENOTSUP;
+}
+
+static const struct eth_dev_ops flow_test_dev_ops = {
+	.filter_ctrl = flow_test_filter_ctrl,
+};
+
+static const struct eth_dev_ops flow_test_no_ctrl_dev_ops = {
+	.filter_ctrl = NULL,
+};
+
+static const struct eth_dev_ops flow_test_no_generic_dev_ops = {
+	.filter_ctrl = flow_test_filter_ctrl_no_generic,
+};
+
+static struct rte_eth_dev *
+flow_test_port_create(const char *name, const struct eth_dev_ops *ops)
+{
+	struct rte_eth_dev *dev;
+
+	dev = rte_eth_dev_allocate(name, RTE_ETH_DEV_VIRTUAL);
+	if (dev == NULL)
+		return NULL;
+	dev->dev_ops = (struct eth_dev_ops *)(uintptr_t)ops;
+	return dev;
+}
+
+static void
+test_flow_teardown(void)
+{
+	rte_eth_dev_release_port(flow_dev);
+	rte_eth_dev_release_port(no_ctrl_dev);
+	rte_eth_dev_release_port(no_generic_dev);
+	flow_dev = NULL;
+	no_ctrl_dev = NULL;
+	no_generic_dev = NULL;
+}
+
+static int
+test_flow_setup(void)
+{
+	memset(flow_test_rules, 0, sizeof(flow_test_rules));
+	flow_dev = flow_test_port_create("flow_test", &flow_test_dev_ops);
+	no_ctrl_dev = flow_test_port_create("flow_test_no_ctrl",
+					    &flow_test_no_ctrl_dev_ops);
+	no_generic_dev = flow_test_port_create("flow_test_no_generic",
+					       &flow_test_no_generic_dev_ops);
+	if (flow_dev == NULL || no_ctrl_dev == NULL ||
+	    no_generic_dev == NULL) {
+		printf("%s: Error allocating test ports\n", __func__);
+		test_flow_teardown();
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_flow_validate(void)
+{
+	uint8_t port = flow_dev->data->port_id;
+	struct rte_flow_error error;
+	int ret;
+
+	ret = rte_flow_validate(port, &flow_attr, flow_pattern, flow_actions,
+				&error);
+	TEST_ASSERT_SUCCESS(ret, "valid rule rejected");
+
+	memset(&error, 0, sizeof(error));
+	ret = rte_flow_validate(port, &flow_attr, flow_bad_pattern,
+				flow_actions, &error);
+	TEST_ASSERT_EQUAL(ret, -ENOTSUP, "unsupported item accepted");
+	TEST_ASSERT_EQUAL(rte_errno, ENOTSUP, "rte_errno not set");
+	TEST_ASSERT_EQUAL(error.type, RTE_FLOW_ERROR_TYPE_ITEM,
+			  "wrong error type");
+	TEST_ASSERT(error.cause == &flow_bad_pattern[1],
+		    "error does not point at the unsupported item");
+	TEST_ASSERT_EQUAL(flow_test_rules[0].used, 0,
+			  "validation created a rule");
+	return TEST_SUCCESS;
+}
+
+static int
+test_flow_create_destroy(void)
+{
+	uint8_t port = flow_dev->data->port_id;
+	struct rte_flow *flows[FLOW_TEST_MAX_RULES];
+	struct rte_flow *flow;
+	struct rte_flow_error error;
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < FLOW_TEST_MAX_RULES; i++) {
+		flows[i] = rte_flow_create(port, &flow_attr, flow_pattern,
+					   flow_actions, &error);
+		TEST_ASSERT_NOT_NULL(flows[i], "cannot create rule %u", i);
+	}
+
+	flow = rte_flow_create(port, &flow_attr, flow_pattern, flow_actions,
+			       &error);
+	TEST_ASSERT_NULL(flow, "rule created past the driver limit");
+	TEST_ASSERT_EQUAL(rte_errno, ENOMEM, "driver error not propagated");
+
+	flow = rte_flow_create(port, &flow_attr, flow_bad_pattern,
+			       flow_actions, &error);
+	TEST_ASSERT_NULL(flow, "unsupported rule created");
+	TEST_ASSERT_EQUAL(rte_errno, ENOTSUP, "wrong rte_errno");
+
+	for (i = 0; i < FLOW_TEST_MAX_RULES; i++) {
+		ret = rte_flow_destroy(port, flows[i], &error);
+		TEST_ASSERT_SUCCESS(ret, "cannot destroy rule %u", i);
+	}
+
+	ret = rte_flow_destroy(port, flows[0], &error);
+	TEST_ASSERT_EQUAL(ret, -EINVAL, "destroyed a rule twice");
+	TEST_ASSERT_EQUAL(error.type, RTE_FLOW_ERROR_TYPE_HANDLE,
+			  "wrong error type");
+	return TEST_SUCCESS;
+}
+
+static int
+test_flow_flush(void)
+{
+	uint8_t port = flow_dev->data->port_id;
+	struct rte_flow_error error;
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < FLOW_TEST_MAX_RULES; i++)
+		TEST_ASSERT_NOT_NULL(rte_flow_create(port, &flow_attr,
+					flow_pattern, flow_actions, &error),
+				"cannot create rule %u", i);
+
+	ret = rte_flow_flush(port, &error);
+	TEST_ASSERT_SUCCESS(ret, "cannot flush rules");
+	for (i = 0; i < FLOW_TEST_MAX_RULES; i++)
+		TEST_ASSERT_EQUAL(flow_test_rules[i].used, 0,
+				  "rule %u not flushed", i);
+
+	/* the freed slots can be used again */
+	TEST_ASSERT_NOT_NULL(rte_flow_create(port, &flow_attr, flow_pattern,
+					     flow_actions, &error),
+			     "cannot create rule after flush");
+	return rte_flow_flush(port, &error);
+}
+
+/* Check that every entry point fails with code on a port without support. */
+static int
+test_flow_unsupported_port(uint8_t port, int code)
+{
+	struct rte_flow_error error;
+	struct rte_flow *flow;
+	int ret;
+
+	memset(&error, 0, sizeof(error));
+	ret = rte_flow_validate(port, &flow_attr, flow_pattern, flow_actions,
+				&error);
+	TEST_ASSERT_EQUAL(ret, -code, "validate: unexpected return %d", ret);
+	TEST_ASSERT_EQUAL(rte_errno, code, "validate: wrong rte_errno");
+	TEST_ASSERT_EQUAL(error.type, RTE_FLOW_ERROR_TYPE_UNSPECIFIED,
+			  "validate: wrong error type");
+
+	flow = rte_flow_create(port, &flow_attr, flow_pattern, flow_actions,
+			       &error);
+	TEST_ASSERT_NULL(flow, "create: rule created");
+	TEST_ASSERT_EQUAL(rte_errno, code, "create: wrong rte_errno");
+
+	ret = rte_flow_destroy(port, &flow_test_rules[0], &error);
+	TEST_ASSERT_EQUAL(ret, -code, "destroy: unexpected return %d", ret);
+
+	ret = rte_flow_flush(port, &error);
+	TEST_ASSERT_EQUAL(ret, -code, "flush: unexpected return %d", ret);
+	return TEST_SUCCESS;
+}
+
+static int
+test_flow_no_filter_ctrl(void)
+{
+	return test_flow_unsupported_port(no_ctrl_dev->data->port_id, ENOSYS);
+}
+
+static int
+test_flow_no_generic_filter(void)
+{
+	return test_flow_unsupported_port(no_generic_dev->data->port_id,
+					  ENOSYS);
+}
+
+static int
+test_flow_invalid_port(void)
+{
+	return test_flow_unsupported_port(RTE_MAX_ETHPORTS - 1, ENODEV);
+}
+
+static struct unit_test_suite flow_test_suite  = {
+	.setup = test_flow_setup,
+	.teardown = test_flow_teardown,
+	.suite_name = "Generic Flow API Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_flow_validate),
+		TEST_CASE(test_flow_create_destroy),
+		TEST_CASE(test_flow_flush),
+		TEST_CASE(test_flow_no_filter_ctrl),
+		TEST_CASE(test_flow_no_generic_filter),
+		TEST_CASE(test_flow_invalid_port),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_flow(void)
+{
+	return unit_test_suite_runner(&flow_test_suite);
+}
+
+REGISTER_TEST_COMMAND(flow_autotest, test_flow);
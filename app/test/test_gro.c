@@ -0,0 +1,453 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_mbuf.h>
+#include <rte_gro.h>
+
+#include "test.h"
+
+/*
+ * GRO
+ * ===
+ *
+ * Build bursts of TCP/IPv4 and VXLAN encapsulated TCP/IPv4 segments with
+ * odd payload lengths, out of order neighbors and packets that must not
+ * be merged, then check the number of packets after GRO, the layout of
+ * the merged packets, their length fields, their checksums (computed on
+ * a linearized copy) and their payload.
+ */
+
+#define NB_MBUF 256
+#define TCP_HDR_LEN (sizeof(struct tcp_hdr) + 12)
+#define TCP_ACK 0x10
+#define TCP_SYN 0x02
+#define RECV_ACK 0x12345678
+#define VXLAN_PORT 4789
+
+static struct rte_mempool *pkt_pool;
+static uint8_t flat[UINT16_MAX + 256];
+
+/* size of the headers before the inner TCP header */
+static uint16_t
+gro_test_hdr_len(int vxlan)
+{
+	uint16_t len = sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr);
+
+	if (vxlan)
+		len += sizeof(struct ipv4_hdr) + ETHER_VXLAN_HLEN +
+			sizeof(struct ether_hdr);
+	return len;
+}
+
+static void
+gro_test_ipv4_hdr(struct ipv4_hdr *ip, uint8_t proto, uint16_t len,
+		uint16_t id)
+{
+	memset(ip, 0, sizeof(*ip));
+	ip->version_ihl = 0x45;
+	ip->total_length = rte_cpu_to_be_16(len);
+	ip->packet_id = rte_cpu_to_be_16(id);
+	ip->time_to_live = 64;
+	ip->next_proto_id = proto;
+	ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 2));
+	ip->hdr_checksum = rte_ipv4_cksum(ip);
+}
+
+/*
+ * Build a TCP segment of the flow identified by port, carrying the stream
+ * bytes from seq. Payload byte i is (seq + i) & 0xff.
+ */
+static struct rte_mbuf *
+gro_test_build_pkt(int vxlan, uint16_t port, uint32_t seq, uint16_t id,
+		uint16_t payload_len, uint8_t flags)
+{
+	struct rte_mbuf *m;
+	struct ether_hdr *eth;
+	struct ipv4_hdr *ip;
+	struct udp_hdr *udp;
+	struct vxlan_hdr *vxh;
+	struct tcp_hdr *tcp;
+	uint8_t *p;
+	uint16_t len, i;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+	len = gro_test_hdr_len(vxlan) + TCP_HDR_LEN + payload_len;
+	p = (uint8_t *)rte_pktmbuf_append(m, len);
+	if (p == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+
+	eth = (struct ether_hdr *)p;
+	memset(eth, 0, sizeof(*eth));
+	eth->s_addr.addr_bytes[5] = 1;
+	eth->d_addr.addr_bytes[5] = 2;
+	eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+	p += sizeof(*eth);
+	len -= sizeof(*eth);
+
+	if (vxlan) {
+		gro_test_ipv4_hdr((struct ipv4_hdr *)p, IPPROTO_UDP, len, id);
+		p += sizeof(struct ipv4_hdr);
+		len -= sizeof(struct ipv4_hdr);
+		udp = (struct udp_hdr *)p;
+		udp->src_port = rte_cpu_to_be_16(1024 + port);
+		udp->dst_port = rte_cpu_to_be_16(VXLAN_PORT);
+		udp->dgram_len = rte_cpu_to_be_16(len);
+		udp->dgram_cksum = 0;
+		vxh = (struct vxlan_hdr *)(udp + 1);
+		vxh->vx_flags = rte_cpu_to_be_32(0x08000000);
+		vxh->vx_vni = rte_cpu_to_be_32(100 << 8);
+		eth = (struct ether_hdr *)(vxh + 1);
+		memset(eth, 0, sizeof(*eth));
+		eth->s_addr.addr_bytes[5] = 3;
+		eth->d_addr.addr_bytes[5] = 4;
+		eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+		p = (uint8_t *)(eth + 1);
+		len -= ETHER_VXLAN_HLEN + sizeof(*eth);
+	}
+
+	ip = (struct ipv4_hdr *)p;
+	gro_test_ipv4_hdr(ip, IPPROTO_TCP, len, id);
+	tcp = (struct tcp_hdr *)(ip + 1);
+	memset(tcp, 0, TCP_HDR_LEN);
+	tcp->src_port = rte_cpu_to_be_16(port);
+	tcp->dst_port = rte_cpu_to_be_16(80);
+	tcp->sent_seq = rte_cpu_to_be_32(seq);
+	tcp->recv_ack = rte_cpu_to_be_32(RECV_ACK);
+	tcp->data_off = (TCP_HDR_LEN / 4) << 4;
+	tcp->tcp_flags = flags;
+	tcp->rx_win = rte_cpu_to_be_16(8192);
+	/* NOP, NOP, timestamps */
+	p = (uint8_t *)(tcp + 1);
+	p[0] = 1;
+	p[1] = 1;
+	p[2] = 8;
+	p[3] = 10;
+	p[7] = 0x42;
+	p += 12;
+	for (i = 0; i < payload_len; i++)
+		p[i] = (seq + i) & 0xff;
+	tcp->cksum = rte_ipv4_udptcp_cksum(ip, tcp);
+
+	return m;
+}
+
+/*
+ * Check a packet after GRO: it carries payload_len stream bytes from seq
+ * in nb_segs segments, and its length fields and checksums are valid.
+ */
+static int
+gro_test_check_pkt(struct rte_mbuf *m, int vxlan, uint32_t seq,
+		uint32_t payload_len, uint8_t nb_segs)
+{
+	const struct rte_mbuf *seg;
+	struct ipv4_hdr *ip;
+	struct udp_hdr *udp;
+	struct tcp_hdr *tcp;
+	uint32_t off = 0, i;
+	uint16_t hdr_len = gro_test_hdr_len(vxlan);
+
+	TEST_ASSERT_EQUAL(m->nb_segs, nb_segs, "bad number of segments");
+	TEST_ASSERT_EQUAL(m->pkt_len, hdr_len + TCP_HDR_LEN + payload_len,
+		"bad packet length");
+
+	for (seg = m; seg != NULL; seg = seg->next) {
+		memcpy(&flat[off], rte_pktmbuf_mtod(seg, void *),
+			seg->data_len);
+		off += seg->data_len;
+	}
+	TEST_ASSERT_EQUAL(off, m->pkt_len, "bad segment lengths");
+
+	ip = (struct ipv4_hdr *)&flat[sizeof(struct ether_hdr)];
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->total_length),
+		m->pkt_len - sizeof(struct ether_hdr), "bad IP length");
+	TEST_ASSERT_EQUAL(rte_ipv4_cksum(ip), 0xffff, "bad IP checksum");
+	if (vxlan) {
+		udp = (struct udp_hdr *)(ip + 1);
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(udp->dgram_len),
+			rte_be_to_cpu_16(ip->total_length) -
+			sizeof(struct ipv4_hdr), "bad UDP length");
+		ip = (struct ipv4_hdr *)((char *)(udp + 1) +
+			sizeof(struct vxlan_hdr) + sizeof(struct ether_hdr));
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->total_length),
+			TCP_HDR_LEN + sizeof(struct ipv4_hdr) + payload_len,
+			"bad inner IP length");
+		TEST_ASSERT_EQUAL(rte_ipv4_cksum(ip), 0xffff,
+			"bad inner IP checksum");
+	}
+
+	tcp = (struct tcp_hdr *)(ip + 1);
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_32(tcp->sent_seq), seq,
+		"bad sequence number");
+	TEST_ASSERT_EQUAL(rte_ipv4_udptcp_cksum(ip, tcp), 0xffff,
+		"bad TCP checksum");
+
+	for (i = 0; i < payload_len; i++)
+		TEST_ASSERT_EQUAL(flat[hdr_len + TCP_HDR_LEN + i],
+			((seq + i) & 0xff), "bad payload byte %u", i);
+
+	return 0;
+}
+
+static void
+gro_test_free(struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++)
+		rte_pktmbuf_free(pkts[i]);
+}
+
+/* merge neighbors, in and out of order, within a burst */
+static int
+test_gro_tcp4_burst(void)
+{
+	struct rte_gro_param param = {
+		.gro_types = RTE_GRO_TCP_IPV4,
+		.max_flow_num = 4,
+		.max_item_per_flow = 8,
+	};
+	struct rte_mbuf *pkts[6];
+	uint16_t nb_pkts;
+
+	pkts[0] = gro_test_build_pkt(0, 1, 1000, 1, 101, TCP_ACK);
+	pkts[1] = gro_test_build_pkt(0, 1, 1101, 2, 200, TCP_ACK);
+	/* flow 2 in reverse order */
+	pkts[2] = gro_test_build_pkt(0, 2, 5050, 11, 77, TCP_ACK);
+	pkts[3] = gro_test_build_pkt(0, 2, 5000, 10, 50, TCP_ACK);
+	/* not merged: SYN */
+	pkts[4] = gro_test_build_pkt(0, 3, 0, 20, 1, TCP_SYN);
+	pkts[5] = gro_test_build_pkt(0, 1, 1301, 3, 333, TCP_ACK);
+	TEST_ASSERT_NOT_NULL(pkts[5], "cannot build packets");
+
+	nb_pkts = rte_gro_reassemble_burst(pkts, RTE_DIM(pkts), &param);
+	TEST_ASSERT_EQUAL(nb_pkts, 3, "bad number of packets after GRO");
+
+	/* merged packets first, in flow order, then the others */
+	TEST_ASSERT_SUCCESS(gro_test_check_pkt(pkts[0], 0, 1000, 634, 3),
+		"bad merged packet of flow 1");
+	TEST_ASSERT_SUCCESS(gro_test_check_pkt(pkts[1], 0, 5000, 127, 2),
+		"bad merged packet of flow 2");
+	TEST_ASSERT_SUCCESS(gro_test_check_pkt(pkts[2], 0, 0, 1, 1),
+		"bad unmerged packet");
+	gro_test_free(pkts, nb_pkts);
+
+	/* packets flagged with a bad checksum are not merged */
+	pkts[0] = gro_test_build_pkt(0, 1, 1000, 1, 100, TCP_ACK);
+	pkts[1] = gro_test_build_pkt(0, 1, 1100, 2, 100, TCP_ACK);
+	TEST_ASSERT_NOT_NULL(pkts[1], "cannot build packets");
+	pkts[1]->ol_flags |= PKT_RX_L4_CKSUM_BAD;
+	nb_pkts = rte_gro_reassemble_burst(pkts, 2, &param);
+	TEST_ASSERT_EQUAL(nb_pkts, 2, "packet with bad checksum merged");
+	gro_test_free(pkts, nb_pkts);
+
+	/* IP IDs must be consecutive when DF is not set */
+	pkts[0] = gro_test_build_pkt(0, 1, 1000, 1, 100, TCP_ACK);
+	pkts[1] = gro_test_build_pkt(0, 1, 1100, 5, 100, TCP_ACK);
+	TEST_ASSERT_NOT_NULL(pkts[1], "cannot build packets");
+	nb_pkts = rte_gro_reassemble_burst(pkts, 2, &param);
+	TEST_ASSERT_EQUAL(nb_pkts, 2, "packets with IP ID gap merged");
+	gro_test_free(pkts, nb_pkts);
+
+	return TEST_SUCCESS;
+}
+
+/* merge VXLAN encapsulated segments next to plain TCP/IPv4 ones */
+static int
+test_gro_vxlan_burst(void)
+{
+	struct rte_gro_param param = {
+		.gro_types = RTE_GRO_TCP_IPV4 | RTE_GRO_IPV4_VXLAN_TCP_IPV4,
+		.max_flow_num = 4,
+		.max_item_per_flow = 8,
+	};
+	struct rte_mbuf *pkts[5];
+	uint16_t nb_pkts;
+
+	pkts[0] = gro_test_build_pkt(1, 1, 7, 1, 1001, TCP_ACK);
+	pkts[1] = gro_test_build_pkt(0, 1, 1000, 1, 100, TCP_ACK);
+	pkts[2] = gro_test_build_pkt(1, 1, 1008, 2, 999, TCP_ACK);
+	pkts[3] = gro_test_build_pkt(0, 1, 1100, 2, 100, TCP_ACK);
+	pkts[4] = gro_test_build_pkt(1, 1, 2007, 3, 3, TCP_ACK);
+	TEST_ASSERT_NOT_NULL(pkts[4], "cannot build packets");
+
+	nb_pkts = rte_gro_reassemble_burst(pkts, RTE_DIM(pkts), &param);
+	TEST_ASSERT_EQUAL(nb_pkts, 2, "bad number of packets after GRO");
+	TEST_ASSERT_SUCCESS(gro_test_check_pkt(pkts[0], 1, 7, 2003, 3),
+		"bad merged VXLAN packet");
+	TEST_ASSERT_SUCCESS(gro_test_check_pkt(pkts[1], 0, 1000, 200, 2),
+		"bad merged TCP/IPv4 packet");
+	gro_test_free(pkts, nb_pkts);
+
+	return TEST_SUCCESS;
+}
+
+/* hold packets in a context across bursts, and use the RX callback */
+static int
+test_gro_ctx(void)
+{
+	struct rte_gro_param param = {
+		.gro_types = RTE_GRO_TCP_IPV4 | RTE_GRO_IPV4_VXLAN_TCP_IPV4,
+		.max_flow_num = 4,
+		.max_item_per_flow = 8,
+	};
+	struct rte_mbuf *pkts[4];
+	uint16_t nb_pkts;
+	void *ctx;
+
+	param.socket_id = rte_socket_id();
+	param.timeout_cycles = 0;
+	TEST_ASSERT_NULL(rte_gro_ctx_create(&(struct rte_gro_param){
+		.gro_types = 1ULL << 63, .max_flow_num = 1,
+		.max_item_per_flow = 1 }),
+		"context created without supported GRO type");
+
+	ctx = rte_gro_ctx_create(&param);
+	TEST_ASSERT_NOT_NULL(ctx, "cannot create GRO context");
+
+	pkts[0] = gro_test_build_pkt(0, 1, 1000, 1, 100, TCP_ACK);
+	pkts[1] = gro_test_build_pkt(0, 1, 1100, 2, 101, TCP_ACK);
+	TEST_ASSERT_NOT_NULL(pkts[1], "cannot build packets");
+	nb_pkts = rte_gro_reassemble(pkts, 2, ctx);
+	TEST_ASSERT_EQUAL(nb_pkts, 0, "packets not held");
+	TEST_ASSERT_EQUAL(rte_gro_get_pkt_count(ctx), 1, "bad held count");
+
+	pkts[0] = gro_test_build_pkt(0, 1, 1201, 3, 99, TCP_ACK);
+	pkts[1] = gro_test_build_pkt(0, 3, 0, 20, 1, TCP_SYN);
+	TEST_ASSERT_NOT_NULL(pkts[1], "cannot build packets");
+	nb_pkts = rte_gro_reassemble(pkts, 2, ctx);
+	TEST_ASSERT_EQUAL(nb_pkts, 1, "bad number of unprocessed packets");
+	TEST_ASSERT_EQUAL(rte_gro_get_pkt_count(ctx), 1, "bad held count");
+	gro_test_free(pkts, nb_pkts);
+
+	/* nothing held for 10 s yet */
+	nb_pkts = rte_gro_timeout_flush(ctx, rte_get_tsc_hz() * 10,
+		RTE_GRO_TCP_IPV4, pkts, RTE_DIM(pkts));
+	TEST_ASSERT_EQUAL(nb_pkts, 0, "packets flushed before timeout");
+	nb_pkts = rte_gro_timeout_flush(ctx, 0, RTE_GRO_TCP_IPV4, pkts,
+		RTE_DIM(pkts));
+	TEST_ASSERT_EQUAL(nb_pkts, 1, "held packets not flushed");
+	TEST_ASSERT_SUCCESS(gro_test_check_pkt(pkts[0], 0, 1000, 300, 3),
+		"bad flushed packet");
+	TEST_ASSERT_EQUAL(rte_gro_get_pkt_count(ctx), 0, "bad held count");
+	gro_test_free(pkts, nb_pkts);
+
+	/* RX callback in burst mode */
+	pkts[0] = gro_test_build_pkt(1, 1, 7, 1, 100, TCP_ACK);
+	pkts[1] = gro_test_build_pkt(1, 1, 107, 2, 100, TCP_ACK);
+	TEST_ASSERT_NOT_NULL(pkts[1], "cannot build packets");
+	nb_pkts = rte_gro_rx_callback(0, 0, pkts, 2, RTE_DIM(pkts), ctx);
+	TEST_ASSERT_EQUAL(nb_pkts, 1, "bad number of packets after GRO");
+	TEST_ASSERT_SUCCESS(gro_test_check_pkt(pkts[0], 1, 7, 200, 2),
+		"bad merged packet");
+	gro_test_free(pkts, nb_pkts);
+	rte_gro_ctx_destroy(ctx);
+
+	/* RX callback holding packets for one cycle */
+	param.timeout_cycles = 1;
+	ctx = rte_gro_ctx_create(&param);
+	TEST_ASSERT_NOT_NULL(ctx, "cannot create GRO context");
+	pkts[0] = gro_test_build_pkt(0, 1, 1000, 1, 100, TCP_ACK);
+	pkts[1] = gro_test_build_pkt(0, 3, 0, 20, 1, TCP_SYN);
+	pkts[2] = gro_test_build_pkt(0, 1, 1100, 2, 100, TCP_ACK);
+	TEST_ASSERT_NOT_NULL(pkts[2], "cannot build packets");
+	nb_pkts = rte_gro_rx_callback(0, 0, pkts, 3, RTE_DIM(pkts), ctx);
+	TEST_ASSERT_EQUAL(nb_pkts, 2, "bad number of packets after GRO");
+	TEST_ASSERT_SUCCESS(gro_test_check_pkt(pkts[0], 0, 1000, 200, 2),
+		"held packet not returned first");
+	TEST_ASSERT_SUCCESS(gro_test_check_pkt(pkts[1], 0, 0, 1, 1),
+		"bad unmerged packet");
+	gro_test_free(pkts, nb_pkts);
+
+	/* packets still held are freed with the context */
+	pkts[0] = gro_test_build_pkt(0, 1, 1000, 1, 100, TCP_ACK);
+	TEST_ASSERT_NOT_NULL(pkts[0], "cannot build packets");
+	TEST_ASSERT_EQUAL(rte_gro_reassemble(pkts, 1, ctx), 0,
+		"packet not held");
+	rte_gro_ctx_destroy(ctx);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_setup(void)
+{
+	if (pkt_pool == NULL) {
+		pkt_pool = rte_pktmbuf_pool_create("GRO_MBUF_POOL", NB_MBUF,
+			32, 0, RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+		if (pkt_pool == NULL) {
+			printf("%s: Error creating mempool\n", __func__);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int
+test_gro_check_leaks(void)
+{
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(pkt_pool), NB_MBUF,
+		"mbuf leak");
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite gro_test_suite  = {
+	.setup = test_gro_setup,
+	.suite_name = "GRO Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_gro_tcp4_burst),
+		TEST_CASE(test_gro_vxlan_burst),
+		TEST_CASE(test_gro_ctx),
+		TEST_CASE(test_gro_check_leaks),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_gro(void)
+{
+	return unit_test_suite_runner(&gro_test_suite);
+}
+
+REGISTER_TEST_COMMAND(gro_autotest, test_gro);
@@ -0,0 +1,652 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include <rte_ether.h>
+#include <rte_ethdev.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_mbuf.h>
+#include <rte_gso.h>
+#ifdef RTE_LIBRTE_PMD_RING
+#include <rte_eth_ring.h>
+#endif
+
+#include "test.h"
+
+/*
+ * GSO
+ * ===
+ *
+ * Build large TCP/IPv4, TCP/IPv6, VXLAN encapsulated TCP/IPv4 and
+ * UDP/IPv4 packets whose payload is spread over several mbufs of odd
+ * lengths, segment them, then check the number and layout of the
+ * segments, their length fields, IPv4 ids and fragment offsets, TCP
+ * sequence numbers and flags, their checksums (computed on a linearized
+ * copy) and their payload.
+ */
+
+#define NB_MBUF 256
+#define TCP_HDR_LEN sizeof(struct tcp_hdr)
+#define TCP_FIN 0x01
+#define TCP_PSH 0x08
+#define TCP_ACK 0x10
+#define TCP_CWR 0x80
+#define VXLAN_PORT 4789
+#define CHUNK_LEN 777U
+#define SEQ 1000
+#define IP_ID 100
+
+enum gso_test_type {
+	GSO_TEST_TCP4,
+	GSO_TEST_TCP6,
+	GSO_TEST_VXLAN,
+	GSO_TEST_UDP4,
+};
+
+static struct rte_mempool *direct_pool;
+static struct rte_mempool *indirect_pool;
+static uint8_t flat[UINT16_MAX + 256];
+static uint8_t frag[UINT16_MAX + 256];
+
+/* size of the headers before the (inner) L3 header */
+static uint16_t
+gso_test_l3_off(enum gso_test_type type)
+{
+	uint16_t len = sizeof(struct ether_hdr);
+
+	if (type == GSO_TEST_VXLAN)
+		len += sizeof(struct ipv4_hdr) + ETHER_VXLAN_HLEN +
+			sizeof(struct ether_hdr);
+	return len;
+}
+
+/* size of all the headers */
+static uint16_t
+gso_test_hdr_len(enum gso_test_type type)
+{
+	uint16_t len = gso_test_l3_off(type);
+
+	if (type == GSO_TEST_TCP6)
+		return len + sizeof(struct ipv6_hdr) + TCP_HDR_LEN;
+	if (type == GSO_TEST_UDP4)
+		return len + sizeof(struct ipv4_hdr) + sizeof(struct udp_hdr);
+	return len + sizeof(struct ipv4_hdr) + TCP_HDR_LEN;
+}
+
+static void
+gso_test_ipv4_hdr(struct ipv4_hdr *ip, uint8_t proto, uint16_t len)
+{
+	memset(ip, 0, sizeof(*ip));
+	ip->version_ihl = 0x45;
+	ip->total_length = rte_cpu_to_be_16(len);
+	ip->packet_id = rte_cpu_to_be_16(IP_ID);
+	ip->fragment_offset = rte_cpu_to_be_16(IPV4_HDR_DF_FLAG);
+	ip->time_to_live = 64;
+	ip->next_proto_id = proto;
+	ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 2));
+}
+
+/*
+ * Build a packet of the given type, carrying payload_len bytes; payload
+ * byte i is (SEQ + i) & 0xff. The headers are in the first mbuf, the
+ * payload is spread over mbufs of CHUNK_LEN bytes. The checksums are
+ * left as an application requesting TSO would set them.
+ */
+static struct rte_mbuf *
+gso_test_build_pkt(enum gso_test_type type, uint32_t payload_len)
+{
+	struct rte_mbuf *m, *seg;
+	struct ether_hdr *eth;
+	struct ipv4_hdr *ip;
+	struct ipv6_hdr *ip6;
+	struct udp_hdr *udp;
+	struct vxlan_hdr *vxh;
+	struct tcp_hdr *tcp;
+	uint16_t hdr_len = gso_test_hdr_len(type);
+	uint16_t len, chunk;
+	uint32_t i;
+	uint8_t *p;
+
+	m = rte_pktmbuf_alloc(direct_pool);
+	if (m == NULL)
+		return NULL;
+	p = (uint8_t *)rte_pktmbuf_append(m, hdr_len);
+	len = hdr_len + payload_len - sizeof(struct ether_hdr);
+
+	eth = (struct ether_hdr *)p;
+	memset(eth, 0, sizeof(*eth));
+	eth->s_addr.addr_bytes[5] = 1;
+	eth->d_addr.addr_bytes[5] = 2;
+	eth->ether_type = rte_cpu_to_be_16(type == GSO_TEST_TCP6 ?
+		ETHER_TYPE_IPv6 : ETHER_TYPE_IPv4);
+	p += sizeof(*eth);
+	m->l2_len = sizeof(*eth);
+
+	if (type == GSO_TEST_VXLAN) {
+		ip = (struct ipv4_hdr *)p;
+		gso_test_ipv4_hdr(ip, IPPROTO_UDP, len);
+		len -= sizeof(struct ipv4_hdr);
+		udp = (struct udp_hdr *)(ip + 1);
+		udp->src_port = rte_cpu_to_be_16(1024);
+		udp->dst_port = rte_cpu_to_be_16(VXLAN_PORT);
+		udp->dgram_len = rte_cpu_to_be_16(len);
+		/* any non-zero value, to be recomputed */
+		udp->dgram_cksum = 1;
+		vxh = (struct vxlan_hdr *)(udp + 1);
+		vxh->vx_flags = rte_cpu_to_be_32(0x08000000);
+		vxh->vx_vni = rte_cpu_to_be_32(100 << 8);
+		eth = (struct ether_hdr *)(vxh + 1);
+		memset(eth, 0, sizeof(*eth));
+		eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+		p = (uint8_t *)(eth + 1);
+		len -= ETHER_VXLAN_HLEN + sizeof(*eth);
+		m->outer_l2_len = sizeof(*eth);
+		m->outer_l3_len = sizeof(struct ipv4_hdr);
+		m->l2_len = ETHER_VXLAN_HLEN + sizeof(*eth);
+		m->ol_flags |= PKT_TX_OUTER_IPV4;
+	}
+
+	if (type == GSO_TEST_TCP6) {
+		ip6 = (struct ipv6_hdr *)p;
+		memset(ip6, 0, sizeof(*ip6));
+		ip6->vtc_flow = rte_cpu_to_be_32(6 << 28);
+		ip6->payload_len = rte_cpu_to_be_16(len - sizeof(*ip6));
+		ip6->proto = IPPROTO_TCP;
+		ip6->hop_limits = 64;
+		ip6->src_addr[15] = 1;
+		ip6->dst_addr[15] = 2;
+		tcp = (struct tcp_hdr *)(ip6 + 1);
+		m->l3_len = sizeof(*ip6);
+		m->ol_flags |= PKT_TX_IPV6 | PKT_TX_TCP_SEG;
+	} else {
+		ip = (struct ipv4_hdr *)p;
+		gso_test_ipv4_hdr(ip, type == GSO_TEST_UDP4 ? IPPROTO_UDP :
+			IPPROTO_TCP, len);
+		tcp = (struct tcp_hdr *)(ip + 1);
+		m->l3_len = sizeof(*ip);
+		m->ol_flags |= PKT_TX_IPV4 | (type == GSO_TEST_UDP4 ?
+			PKT_TX_UDP_SEG : PKT_TX_TCP_SEG);
+	}
+
+	if (type == GSO_TEST_UDP4) {
+		ip->fragment_offset = 0;
+		udp = (struct udp_hdr *)tcp;
+		udp->src_port = rte_cpu_to_be_16(1024);
+		udp->dst_port = rte_cpu_to_be_16(53);
+		udp->dgram_len = rte_cpu_to_be_16(len - sizeof(*ip));
+		udp->dgram_cksum = 0;
+	} else {
+		memset(tcp, 0, TCP_HDR_LEN);
+		tcp->src_port = rte_cpu_to_be_16(1);
+		tcp->dst_port = rte_cpu_to_be_16(80);
+		tcp->sent_seq = rte_cpu_to_be_32(SEQ);
+		tcp->data_off = (TCP_HDR_LEN / 4) << 4;
+		tcp->tcp_flags = TCP_ACK | TCP_PSH | TCP_FIN | TCP_CWR;
+		tcp->rx_win = rte_cpu_to_be_16(8192);
+		m->l4_len = TCP_HDR_LEN;
+	}
+
+	for (i = 0, seg = m; i < payload_len; i += chunk) {
+		chunk = RTE_MIN(CHUNK_LEN, payload_len - i);
+		seg->next = rte_pktmbuf_alloc(direct_pool);
+		if (seg->next == NULL) {
+			rte_pktmbuf_free(m);
+			return NULL;
+		}
+		seg = seg->next;
+		p = (uint8_t *)rte_pktmbuf_append(seg, chunk);
+		m->pkt_len += chunk;
+		m->nb_segs++;
+		for (len = 0; len < chunk; len++)
+			p[len] = (SEQ + i + len) & 0xff;
+	}
+
+	return m;
+}
+
+/* Copy a packet to buf */
+static uint32_t
+gso_test_linearize(const struct rte_mbuf *m, uint8_t *buf)
+{
+	uint32_t off = 0;
+
+	for (; m != NULL; m = m->next) {
+		memcpy(&buf[off], rte_pktmbuf_mtod(m, void *), m->data_len);
+		off += m->data_len;
+	}
+	return off;
+}
+
+/*
+ * Check the seg_idx-th of nb_segs TCP segments, carrying payload_len
+ * bytes from stream offset off; hw_cksum tells whether the hardware was
+ * asked for the IP and TCP checksums.
+ */
+static int
+gso_test_check_tcp(struct rte_mbuf *m, enum gso_test_type type,
+		uint16_t seg_idx, uint16_t nb_segs, uint32_t off,
+		uint16_t payload_len, int hw_cksum)
+{
+	struct ipv4_hdr *ip = NULL;
+	struct ipv6_hdr *ip6 = NULL;
+	struct udp_hdr *udp;
+	struct tcp_hdr *tcp;
+	uint16_t hdr_len = gso_test_hdr_len(type);
+	uint8_t flags;
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL(m->pkt_len, hdr_len + payload_len,
+		"bad packet length");
+	TEST_ASSERT_EQUAL(gso_test_linearize(m, flat), m->pkt_len,
+		"bad segment lengths");
+	TEST_ASSERT((m->ol_flags & PKT_TX_TCP_SEG) == 0,
+		"segmentation flag left");
+
+	if (type == GSO_TEST_VXLAN) {
+		ip = (struct ipv4_hdr *)&flat[sizeof(struct ether_hdr)];
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->total_length),
+			(m->pkt_len - sizeof(struct ether_hdr)),
+			"bad outer IP length");
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->packet_id),
+			(IP_ID + seg_idx), "bad outer IP id");
+		TEST_ASSERT_EQUAL(rte_ipv4_cksum(ip), 0xffff,
+			"bad outer IP checksum");
+		udp = (struct udp_hdr *)(ip + 1);
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(udp->dgram_len),
+			(rte_be_to_cpu_16(ip->total_length) -
+			sizeof(struct ipv4_hdr)), "bad UDP length");
+		TEST_ASSERT_EQUAL(rte_ipv4_udptcp_cksum(ip, udp), 0xffff,
+			"bad UDP checksum");
+	}
+
+	if (type == GSO_TEST_TCP6) {
+		ip6 = (struct ipv6_hdr *)&flat[gso_test_l3_off(type)];
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip6->payload_len),
+			(TCP_HDR_LEN + payload_len), "bad IPv6 length");
+		tcp = (struct tcp_hdr *)(ip6 + 1);
+	} else {
+		ip = (struct ipv4_hdr *)&flat[gso_test_l3_off(type)];
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->total_length),
+			(sizeof(*ip) + TCP_HDR_LEN + payload_len),
+			"bad IP length");
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->packet_id),
+			(IP_ID + seg_idx), "bad IP id");
+		if (hw_cksum)
+			TEST_ASSERT_EQUAL(ip->hdr_checksum, 0,
+				"IP checksum not left to the hardware");
+		else
+			TEST_ASSERT_EQUAL(rte_ipv4_cksum(ip), 0xffff,
+				"bad IP checksum");
+		tcp = (struct tcp_hdr *)(ip + 1);
+	}
+
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_32(tcp->sent_seq), (SEQ + off),
+		"bad sequence number");
+	flags = TCP_ACK;
+	if (seg_idx == 0)
+		flags |= TCP_CWR;
+	if (seg_idx == nb_segs - 1)
+		flags |= TCP_PSH | TCP_FIN;
+	TEST_ASSERT_EQUAL(tcp->tcp_flags, flags, "bad TCP flags");
+
+	if (hw_cksum)
+		TEST_ASSERT_EQUAL(tcp->cksum, rte_ipv4_phdr_cksum(ip, 0),
+			"bad TCP pseudo-header checksum");
+	else if (ip6 != NULL)
+		TEST_ASSERT_EQUAL(rte_ipv6_udptcp_cksum(ip6, tcp), 0xffff,
+			"bad TCP checksum");
+	else
+		TEST_ASSERT_EQUAL(rte_ipv4_udptcp_cksum(ip, tcp), 0xffff,
+			"bad TCP checksum");
+
+	for (i = 0; i < payload_len; i++)
+		TEST_ASSERT_EQUAL(flat[hdr_len + i], ((SEQ + off + i) & 0xff),
+			"bad payload byte %u", i);
+
+	return 0;
+}
+
+static void
+gso_test_free(struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++)
+		rte_pktmbuf_free(pkts[i]);
+}
+
+/* Segment a packet of the given type and check the segments */
+static int
+gso_test_segment_tcp(enum gso_test_type type, const struct rte_gso_ctx *ctx,
+		uint32_t payload_len, uint16_t mss, int hw_cksum)
+{
+	struct rte_mbuf *pkts[16];
+	struct rte_mbuf *m;
+	uint16_t nb_segs, i;
+	int ret;
+
+	m = gso_test_build_pkt(type, payload_len);
+	TEST_ASSERT_NOT_NULL(m, "cannot build packet");
+	if (hw_cksum)
+		m->ol_flags |= PKT_TX_IP_CKSUM | PKT_TX_TCP_CKSUM;
+
+	nb_segs = (payload_len + mss - 1) / mss;
+	ret = rte_gso_segment(m, ctx, pkts, RTE_DIM(pkts));
+	TEST_ASSERT_EQUAL(ret, nb_segs, "bad number of segments: %d", ret);
+	for (i = 0; i < nb_segs; i++) {
+		ret = gso_test_check_tcp(pkts[i], type, i, nb_segs, i * mss,
+			RTE_MIN(mss, payload_len - i * mss), hw_cksum);
+		if (ret < 0) {
+			printf("bad segment %u\n", i);
+			break;
+		}
+	}
+	gso_test_free(pkts, nb_segs);
+	return ret;
+}
+
+/* split TCP/IPv4 packets with software and hardware checksums */
+static int
+test_gso_tcp4(void)
+{
+	struct rte_gso_ctx ctx = {
+		.direct_pool = direct_pool,
+		.indirect_pool = indirect_pool,
+		.gso_types = DEV_TX_OFFLOAD_TCP_TSO,
+		.gso_size = 1514,
+	};
+	struct rte_mbuf *pkts[4];
+	struct rte_mbuf *m;
+
+	TEST_ASSERT_SUCCESS(gso_test_segment_tcp(GSO_TEST_TCP4, &ctx, 5001,
+		1514 - gso_test_hdr_len(GSO_TEST_TCP4), 0),
+		"bad TCP/IPv4 segments");
+	TEST_ASSERT_SUCCESS(gso_test_segment_tcp(GSO_TEST_TCP4, &ctx, 4000,
+		1460, 1), "bad TCP/IPv4 segments with hardware checksums");
+
+	/* the MSS given in tso_segsz prevails, odd sizes included */
+	m = gso_test_build_pkt(GSO_TEST_TCP4, 2000);
+	TEST_ASSERT_NOT_NULL(m, "cannot build packet");
+	m->tso_segsz = 999;
+	TEST_ASSERT_EQUAL(rte_gso_segment(m, &ctx, pkts, RTE_DIM(pkts)), 3,
+		"bad number of segments");
+	TEST_ASSERT_SUCCESS(gso_test_check_tcp(pkts[1], GSO_TEST_TCP4, 1, 3,
+		999, 999, 0), "bad segment");
+	TEST_ASSERT_SUCCESS(gso_test_check_tcp(pkts[2], GSO_TEST_TCP4, 2, 3,
+		1998, 2, 0), "bad last segment");
+	gso_test_free(pkts, 3);
+
+	/* a small packet is fixed up in place */
+	m = gso_test_build_pkt(GSO_TEST_TCP4, 100);
+	TEST_ASSERT_NOT_NULL(m, "cannot build packet");
+	TEST_ASSERT_EQUAL(rte_gso_segment(m, &ctx, pkts, RTE_DIM(pkts)), 1,
+		"small packet segmented");
+	TEST_ASSERT(pkts[0] == m, "small packet not returned as is");
+	TEST_ASSERT_SUCCESS(gso_test_check_tcp(m, GSO_TEST_TCP4, 0, 1, 0,
+		100, 0), "bad small packet");
+
+	/* out of room: the packet is left to the caller */
+	m->ol_flags |= PKT_TX_TCP_SEG;
+	m->tso_segsz = 10;
+	TEST_ASSERT_EQUAL(rte_gso_segment(m, &ctx, pkts, RTE_DIM(pkts)),
+		-ENOSPC, "segments do not fit");
+
+	/* TSO not requested */
+	ctx.gso_types = DEV_TX_OFFLOAD_UDP_TSO;
+	TEST_ASSERT_EQUAL(rte_gso_segment(m, &ctx, pkts, RTE_DIM(pkts)), 1,
+		"packet segmented without TSO type");
+	TEST_ASSERT(pkts[0] == m && (m->ol_flags & PKT_TX_TCP_SEG),
+		"packet modified without TSO type");
+	rte_pktmbuf_free(m);
+
+	return TEST_SUCCESS;
+}
+
+/* split TCP/IPv6 and VXLAN encapsulated TCP/IPv4 packets */
+static int
+test_gso_tcp6_vxlan(void)
+{
+	struct rte_gso_ctx ctx = {
+		.direct_pool = direct_pool,
+		.indirect_pool = indirect_pool,
+		.gso_types = DEV_TX_OFFLOAD_TCP_TSO |
+			DEV_TX_OFFLOAD_VXLAN_TNL_TSO,
+		.gso_size = 1514,
+	};
+
+	TEST_ASSERT_SUCCESS(gso_test_segment_tcp(GSO_TEST_TCP6, &ctx, 6543,
+		1514 - gso_test_hdr_len(GSO_TEST_TCP6), 0),
+		"bad TCP/IPv6 segments");
+	TEST_ASSERT_SUCCESS(gso_test_segment_tcp(GSO_TEST_VXLAN, &ctx, 4321,
+		1514 - gso_test_hdr_len(GSO_TEST_VXLAN), 0),
+		"bad VXLAN segments");
+
+	return TEST_SUCCESS;
+}
+
+/* fragment UDP/IPv4 datagrams */
+static int
+test_gso_udp4(void)
+{
+	struct rte_gso_ctx ctx = {
+		.direct_pool = direct_pool,
+		.indirect_pool = indirect_pool,
+		.gso_types = DEV_TX_OFFLOAD_UDP_TSO,
+		.gso_size = 1514,
+	};
+	struct rte_mbuf *pkts[8];
+	struct rte_mbuf *m;
+	struct ipv4_hdr *ip;
+	struct udp_hdr *udp;
+	uint32_t len, off = 0;
+	uint16_t frag_size, i;
+	uint64_t ol_flags;
+	int nb_frags;
+
+	m = gso_test_build_pkt(GSO_TEST_UDP4, 4000);
+	TEST_ASSERT_NOT_NULL(m, "cannot build packet");
+	m->ol_flags |= PKT_TX_UDP_CKSUM;
+
+	/* out of room: the datagram is left as it was */
+	ol_flags = m->ol_flags;
+	TEST_ASSERT_EQUAL(rte_gso_segment(m, &ctx, pkts, 2), -ENOSPC,
+		"fragments do not fit");
+	ip = rte_pktmbuf_mtod_offset(m, struct ipv4_hdr *,
+		sizeof(struct ether_hdr));
+	udp = (struct udp_hdr *)(ip + 1);
+	TEST_ASSERT(m->ol_flags == ol_flags && udp->dgram_cksum == 0 &&
+		ip->fragment_offset == 0 &&
+		rte_mbuf_refcnt_read(m) == 1,
+		"datagram modified when out of room");
+
+	nb_frags = rte_gso_segment(m, &ctx, pkts, RTE_DIM(pkts));
+	/* 1480 bytes of IP payload per fragment */
+	frag_size = 1480;
+	TEST_ASSERT_EQUAL(nb_frags, 3, "bad number of fragments");
+
+	/* reassemble the datagram in flat[] to check its checksum */
+	for (i = 0; i < nb_frags; i++) {
+		len = gso_test_linearize(pkts[i], frag);
+		TEST_ASSERT_EQUAL(len, pkts[i]->pkt_len,
+			"bad segment lengths");
+		TEST_ASSERT(!(pkts[i]->ol_flags &
+			(PKT_TX_UDP_SEG | PKT_TX_L4_MASK)),
+			"offload flags left on fragment");
+		ip = (struct ipv4_hdr *)&frag[sizeof(struct ether_hdr)];
+		TEST_ASSERT_EQUAL(rte_ipv4_cksum(ip), 0xffff,
+			"bad IP checksum");
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->total_length),
+			(len - sizeof(struct ether_hdr)), "bad IP length");
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->packet_id), IP_ID,
+			"bad IP id");
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->fragment_offset),
+			((i * frag_size / 8) |
+			(i == nb_frags - 1 ? 0 : IPV4_HDR_MF_FLAG)),
+			"bad fragment offset");
+		if (i == 0)
+			memcpy(flat, frag, sizeof(struct ether_hdr) +
+				sizeof(*ip));
+		len -= sizeof(struct ether_hdr) + sizeof(*ip);
+		memcpy(&flat[sizeof(struct ether_hdr) + sizeof(*ip) + off],
+			ip + 1, len);
+		off += len;
+	}
+	TEST_ASSERT_EQUAL(off, (4000 + sizeof(struct udp_hdr)),
+		"bad reassembled length");
+	ip = (struct ipv4_hdr *)&flat[sizeof(struct ether_hdr)];
+	ip->total_length = rte_cpu_to_be_16(off + sizeof(*ip));
+	TEST_ASSERT_EQUAL(rte_ipv4_udptcp_cksum(ip, ip + 1), 0xffff,
+		"bad UDP checksum");
+	for (i = 0; i < 4000; i++)
+		TEST_ASSERT_EQUAL(flat[gso_test_hdr_len(GSO_TEST_UDP4) + i],
+			((SEQ + i) & 0xff), "bad payload byte %u", i);
+	gso_test_free(pkts, nb_frags);
+
+	return TEST_SUCCESS;
+}
+
+#ifdef RTE_LIBRTE_PMD_RING
+/* segment and transmit through the TX helper, on a ring port */
+static int
+test_gso_tx_burst(void)
+{
+	struct rte_gso_ctx ctx = {
+		.direct_pool = direct_pool,
+		.indirect_pool = indirect_pool,
+		.gso_types = DEV_TX_OFFLOAD_TCP_TSO,
+		.gso_size = 1514,
+	};
+	struct rte_mbuf *pkts[3];
+	struct rte_mbuf *segs[8];
+	struct rte_ring *ring;
+	unsigned int nb_segs;
+	int port;
+
+	/* room for 7 segments */
+	ring = rte_ring_lookup("GSO_TX_RING");
+	if (ring == NULL)
+		ring = rte_ring_create("GSO_TX_RING", 8, SOCKET_ID_ANY,
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	TEST_ASSERT_NOT_NULL(ring, "cannot create ring");
+	port = rte_eth_from_rings("net_gso_test", &ring, 1, &ring, 1,
+		SOCKET_ID_ANY);
+	TEST_ASSERT(port >= 0, "cannot create ring port");
+
+	/* 4 + 1 + 4 segments: the last packet is partly sent */
+	pkts[0] = gso_test_build_pkt(GSO_TEST_TCP4, 5000);
+	pkts[1] = gso_test_build_pkt(GSO_TEST_TCP4, 100);
+	pkts[2] = gso_test_build_pkt(GSO_TEST_TCP4, 5000);
+	TEST_ASSERT_NOT_NULL(pkts[2], "cannot build packets");
+	TEST_ASSERT_EQUAL(rte_gso_tx_burst(port, 0, pkts, 3, &ctx), 3,
+		"partly sent packet not consumed");
+
+	/* full ring: nothing is consumed */
+	pkts[0] = gso_test_build_pkt(GSO_TEST_TCP4, 100);
+	pkts[1] = gso_test_build_pkt(GSO_TEST_TCP4, 5000);
+	TEST_ASSERT_NOT_NULL(pkts[1], "cannot build packets");
+	TEST_ASSERT_EQUAL(rte_gso_tx_burst(port, 0, pkts, 2, &ctx), 0,
+		"packets sent to a full ring");
+	TEST_ASSERT_SUCCESS(gso_test_check_tcp(pkts[0], GSO_TEST_TCP4, 0, 1,
+		0, 100, 0), "bad small packet left");
+	TEST_ASSERT_EQUAL(pkts[1]->pkt_len,
+		(gso_test_hdr_len(GSO_TEST_TCP4) + 5000U),
+		"large packet not left intact");
+	gso_test_free(pkts, 2);
+
+	nb_segs = rte_ring_dequeue_burst(ring, (void **)segs, RTE_DIM(segs));
+	TEST_ASSERT_EQUAL(nb_segs, 7, "bad number of segments sent");
+	TEST_ASSERT_SUCCESS(gso_test_check_tcp(segs[3], GSO_TEST_TCP4, 3, 4,
+		4380, 620, 0), "bad last segment");
+	TEST_ASSERT_SUCCESS(gso_test_check_tcp(segs[4], GSO_TEST_TCP4, 0, 1,
+		0, 100, 0), "bad small packet");
+	TEST_ASSERT_SUCCESS(gso_test_check_tcp(segs[6], GSO_TEST_TCP4, 1, 4,
+		1460, 1460, 0), "bad segment");
+	gso_test_free(segs, nb_segs);
+
+	return TEST_SUCCESS;
+}
+#endif
+
+static int
+test_gso_setup(void)
+{
+	if (direct_pool == NULL) {
+		direct_pool = rte_pktmbuf_pool_create("GSO_DIRECT_POOL",
+			NB_MBUF, 32, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+			SOCKET_ID_ANY);
+		indirect_pool = rte_pktmbuf_pool_create("GSO_INDIRECT_POOL",
+			NB_MBUF, 32, 0, 0, SOCKET_ID_ANY);
+		if (direct_pool == NULL || indirect_pool == NULL) {
+			printf("%s: Error creating mempool\n", __func__);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int
+test_gso_check_leaks(void)
+{
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(direct_pool), NB_MBUF,
+		"direct mbuf leak");
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(indirect_pool), NB_MBUF,
+		"indirect mbuf leak");
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite gso_test_suite  = {
+	.setup = test_gso_setup,
+	.suite_name = "GSO Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_gso_tcp4),
+		TEST_CASE(test_gso_tcp6_vxlan),
+		TEST_CASE(test_gso_udp4),
+#ifdef RTE_LIBRTE_PMD_RING
+		TEST_CASE(test_gso_tx_burst),
+#endif
+		TEST_CASE(test_gso_check_leaks),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_gso(void)
+{
+	return unit_test_suite_runner(&gso_test_suite);
+}
+
+REGISTER_TEST_COMMAND(gso_autotest, test_gso);
@@ -0,0 +1,678 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_ip.h>
+#include <rte_ip_frag.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+#include "test.h"
+
+#define NB_MBUF			8192
+#define NB_PKTS			256
+#define FRAG_PAYLOAD		1480
+#define NB_FRAGS		7
+#define BUCKET_NUM		(NB_PKTS * 2)
+#define BUCKET_ENTRIES		16
+
+static struct rte_mempool *pkt_pool;
+static struct rte_ip_frag_tbl *shared_tbl;
+static struct rte_mbuf *frags[NB_PKTS * NB_FRAGS];
+static rte_atomic32_t reassembled;
+static rte_atomic32_t bad_len;
+static unsigned int nb_workers;
+
+/*
+ * Build one IPv4 fragment of a NB_FRAGS fragments datagram.
+ * The mbuf data starts at the IPv4 header (no L2 header).
+ */
+static struct rte_mbuf *
+build_fragment(uint16_t pkt_id, uint32_t frag_idx, uint32_t nb_frags)
+{
+	struct rte_mbuf *m;
+	struct ipv4_hdr *ip;
+	uint16_t ofs;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+
+	ip = (struct ipv4_hdr *)rte_pktmbuf_append(m,
+		sizeof(*ip) + FRAG_PAYLOAD);
+	if (ip == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+
+	memset(ip, 0, sizeof(*ip));
+	ip->version_ihl = 0x45;
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->total_length = rte_cpu_to_be_16(sizeof(*ip) + FRAG_PAYLOAD);
+	ip->packet_id = rte_cpu_to_be_16(pkt_id);
+	ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 2));
+
+	ofs = (uint16_t)(frag_idx * FRAG_PAYLOAD / IPV4_HDR_OFFSET_UNITS);
+	if (frag_idx != nb_frags - 1)
+		ofs |= IPV4_HDR_MF_FLAG;
+	ip->fragment_offset = rte_cpu_to_be_16(ofs);
+
+	m->l2_len = 0;
+	m->l3_len = sizeof(*ip);
+	return m;
+}
+
+static struct rte_mbuf *
+reassemble(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
+	struct rte_mbuf *m)
+{
+	struct ipv4_hdr *ip;
+
+	ip = rte_pktmbuf_mtod(m, struct ipv4_hdr *);
+	return rte_ipv4_frag_reassemble_packet(tbl, dr, m, rte_rdtsc(), ip);
+}
+
+static int
+test_ipfrag_create(void)
+{
+	struct rte_ip_frag_tbl_params params = {
+		.bucket_num = BUCKET_NUM,
+		.bucket_entries = BUCKET_ENTRIES,
+		.max_entries = BUCKET_NUM,
+		.max_frags = IP_MAX_FRAG_NUM + 1,
+		.max_cycles = rte_get_tsc_hz(),
+		.flags = 0,
+		.socket_id = SOCKET_ID_ANY,
+	};
+	struct rte_ip_frag_tbl *tbl;
+
+	tbl = rte_ip_frag_table_create_ext(NULL);
+	TEST_ASSERT_NULL(tbl, "table created with NULL parameters");
+
+	tbl = rte_ip_frag_table_create_ext(&params);
+	TEST_ASSERT_NULL(tbl, "table created with too many fragments");
+
+	params.max_frags = 1;
+	tbl = rte_ip_frag_table_create_ext(&params);
+	TEST_ASSERT_NULL(tbl, "table created with too few fragments");
+
+	params.max_frags = 0;
+	params.flags = ~0U;
+	tbl = rte_ip_frag_table_create_ext(&params);
+	TEST_ASSERT_NULL(tbl, "table created with invalid flags");
+
+	params.flags = RTE_IP_FRAG_TBL_F_SHARED;
+	tbl = rte_ip_frag_table_create_ext(&params);
+	TEST_ASSERT_NOT_NULL(tbl, "cannot create shared table");
+	TEST_ASSERT_EQUAL(tbl->max_frags, (uint32_t)IP_MAX_FRAG_NUM,
+		"unexpected default number of fragments");
+	rte_ip_frag_table_destroy(tbl);
+
+	return TEST_SUCCESS;
+}
+
+/* a table sized for fewer fragments must drop the datagram */
+static int
+test_ipfrag_max_frags(void)
+{
+	struct rte_ip_frag_tbl_params params = {
+		.bucket_num = BUCKET_NUM,
+		.bucket_entries = BUCKET_ENTRIES,
+		.max_entries = BUCKET_NUM,
+		.max_frags = 0,
+		.max_cycles = rte_get_tsc_hz(),
+		.flags = 0,
+		.socket_id = SOCKET_ID_ANY,
+	};
+	struct rte_ip_frag_death_row dr;
+	struct rte_ip_frag_tbl *tbl;
+	struct rte_mbuf *m, *out;
+	uint32_t max_frags, i;
+	unsigned int avail;
+
+	avail = rte_mempool_avail_count(pkt_pool);
+
+	for (max_frags = NB_FRAGS - 1; max_frags <= NB_FRAGS; max_frags++) {
+		params.max_frags = max_frags;
+		tbl = rte_ip_frag_table_create_ext(&params);
+		TEST_ASSERT_NOT_NULL(tbl, "cannot create table");
+
+		memset(&dr, 0, sizeof(dr));
+		out = NULL;
+		for (i = 0; i != NB_FRAGS; i++) {
+			m = build_fragment(1, i, NB_FRAGS);
+			TEST_ASSERT_NOT_NULL(m, "cannot build fragment");
+			out = reassemble(tbl, &dr, m);
+			if (out != NULL)
+				break;
+		}
+		rte_ip_frag_free_death_row(&dr, 0);
+
+		if (max_frags < NB_FRAGS) {
+			TEST_ASSERT_NULL(out,
+				"datagram reassembled from too many fragments");
+		} else {
+			TEST_ASSERT_NOT_NULL(out, "datagram not reassembled");
+			TEST_ASSERT_EQUAL(out->pkt_len, sizeof(struct ipv4_hdr) +
+				NB_FRAGS * FRAG_PAYLOAD,
+				"bad reassembled length %u", out->pkt_len);
+			TEST_ASSERT_EQUAL(out->nb_segs, NB_FRAGS,
+				"bad number of segments %u", out->nb_segs);
+			rte_pktmbuf_free(out);
+		}
+
+		rte_ip_frag_table_statistics_dump(stdout, tbl);
+
+		/* flush the fragments still waiting in the table */
+		rte_ip_frag_table_del_expired_entries(tbl, &dr,
+			rte_rdtsc() + tbl->max_cycles + 1);
+		rte_ip_frag_free_death_row(&dr, 0);
+		TEST_ASSERT_EQUAL(tbl->use_entries, 0,
+			"%u entries left in the table", tbl->use_entries);
+		rte_ip_frag_table_destroy(tbl);
+	}
+
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(pkt_pool), avail,
+		"mbuf leak");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Each worker handles every nb_workers-th fragment, so the fragments of
+ * one datagram are spread over all workers, as RSS would do it.
+ */
+static int
+ipfrag_shared_worker(void *arg)
+{
+	struct rte_ip_frag_death_row dr;
+	struct rte_mbuf *out;
+	unsigned int id, i;
+
+	id = (unsigned int)(uintptr_t)arg;
+	memset(&dr, 0, sizeof(dr));
+
+	for (i = id; i < RTE_DIM(frags); i += nb_workers) {
+		out = reassemble(shared_tbl, &dr, frags[i]);
+		if (out != NULL) {
+			if (out->pkt_len != sizeof(struct ipv4_hdr) +
+					NB_FRAGS * FRAG_PAYLOAD)
+				rte_atomic32_inc(&bad_len);
+			rte_atomic32_inc(&reassembled);
+			rte_pktmbuf_free(out);
+		}
+		if (dr.cnt >= IP_FRAG_DEATH_ROW_LEN)
+			rte_ip_frag_free_death_row(&dr, 0);
+	}
+	rte_ip_frag_free_death_row(&dr, 0);
+
+	return 0;
+}
+
+static int
+test_ipfrag_shared(void)
+{
+	struct rte_ip_frag_tbl_params params = {
+		.bucket_num = BUCKET_NUM,
+		.bucket_entries = BUCKET_ENTRIES,
+		.max_entries = BUCKET_NUM,
+		.max_frags = NB_FRAGS,
+		.max_cycles = rte_get_tsc_hz() * 60,
+		.flags = RTE_IP_FRAG_TBL_F_SHARED,
+		.socket_id = SOCKET_ID_ANY,
+	};
+	unsigned int lcore_id, id;
+	uint32_t i, j;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough cores for %s, expecting at least 2\n",
+			__func__);
+		return TEST_SUCCESS;
+	}
+
+	shared_tbl = rte_ip_frag_table_create_ext(&params);
+	TEST_ASSERT_NOT_NULL(shared_tbl, "cannot create shared table");
+
+	/* fragments of all datagrams interleaved, last one first. */
+	for (i = 0; i != NB_FRAGS; i++) {
+		for (j = 0; j != NB_PKTS; j++) {
+			frags[i * NB_PKTS + j] = build_fragment(j,
+				NB_FRAGS - 1 - i, NB_FRAGS);
+			TEST_ASSERT_NOT_NULL(frags[i * NB_PKTS + j],
+				"cannot build fragment");
+		}
+	}
+
+	rte_atomic32_init(&reassembled);
+	rte_atomic32_init(&bad_len);
+	nb_workers = rte_lcore_count() - 1;
+
+	id = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		rte_eal_remote_launch(ipfrag_shared_worker,
+			(void *)(uintptr_t)id, lcore_id);
+		id++;
+	}
+	rte_eal_mp_wait_lcore();
+
+	rte_ip_frag_table_statistics_dump(stdout, shared_tbl);
+
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&reassembled), NB_PKTS,
+		"only %d of %d datagrams reassembled",
+		rte_atomic32_read(&reassembled), NB_PKTS);
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&bad_len), 0,
+		"%d datagrams with bad length", rte_atomic32_read(&bad_len));
+	TEST_ASSERT_EQUAL(shared_tbl->use_entries, 0,
+		"%u entries still in use", shared_tbl->use_entries);
+
+	rte_ip_frag_table_destroy(shared_tbl);
+	shared_tbl = NULL;
+
+	return TEST_SUCCESS;
+}
+
+#define BURST_MTU		1500
+#define BURST_SEG_LEN		1500
+#define BURST_NB_SEGS		3
+
+/*
+ * Packet of nb_segs segments with room for a hdr_len bytes L3 header,
+ * payload byte i holds (i & 0xff).
+ */
+static struct rte_mbuf *
+build_big_payload(uint32_t hdr_len, uint32_t nb_segs)
+{
+	struct rte_mbuf *m, *seg, *prev;
+	uint32_t i, j, pos, len;
+	uint8_t *p;
+
+	m = NULL;
+	prev = NULL;
+	pos = 0;
+	for (i = 0; i != nb_segs; i++) {
+		seg = rte_pktmbuf_alloc(pkt_pool);
+		if (seg == NULL) {
+			rte_pktmbuf_free(m);
+			return NULL;
+		}
+		len = BURST_SEG_LEN;
+		p = (uint8_t *)rte_pktmbuf_append(seg, len);
+		if (i == 0) {
+			m = seg;
+			p += hdr_len;
+			len -= hdr_len;
+		} else {
+			prev->next = seg;
+			m->nb_segs++;
+			m->pkt_len += seg->data_len;
+		}
+		for (j = 0; j != len; j++, pos++)
+			p[j] = (uint8_t)pos;
+		prev = seg;
+	}
+
+	m->l2_len = 0;
+	m->l3_len = hdr_len;
+	return m;
+}
+
+/* multi-segment IPv4 packet */
+static struct rte_mbuf *
+build_big_packet(uint16_t pkt_id, uint16_t flags)
+{
+	struct rte_mbuf *m;
+	struct ipv4_hdr *ip;
+
+	m = build_big_payload(sizeof(*ip), BURST_NB_SEGS);
+	if (m == NULL)
+		return NULL;
+
+	ip = rte_pktmbuf_mtod(m, struct ipv4_hdr *);
+	memset(ip, 0, sizeof(*ip));
+	ip->version_ihl = 0x45;
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->total_length = rte_cpu_to_be_16(m->pkt_len);
+	ip->packet_id = rte_cpu_to_be_16(pkt_id);
+	ip->fragment_offset = rte_cpu_to_be_16(flags);
+	ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 2));
+	return m;
+}
+
+/*
+ * IPv6 packet. Fragments get a null identification, so each packet
+ * goes to its own destination host to keep the reassembly keys apart.
+ */
+static struct rte_mbuf *
+build_big_packet6(uint8_t host, uint32_t nb_segs)
+{
+	struct rte_mbuf *m;
+	struct ipv6_hdr *ip;
+
+	m = build_big_payload(sizeof(*ip), nb_segs);
+	if (m == NULL)
+		return NULL;
+
+	ip = rte_pktmbuf_mtod(m, struct ipv6_hdr *);
+	memset(ip, 0, sizeof(*ip));
+	ip->vtc_flow = rte_cpu_to_be_32(6 << 28);
+	ip->payload_len = rte_cpu_to_be_16(m->pkt_len - sizeof(*ip));
+	ip->proto = IPPROTO_UDP;
+	ip->hop_limits = 64;
+	ip->src_addr[15] = 1;
+	ip->dst_addr[15] = host;
+	return m;
+}
+
+/* check payload pattern of a reassembled packet */
+static int
+check_big_packet(struct rte_mbuf *m, uint32_t hdr_len)
+{
+	uint32_t pos, i, ofs;
+	const uint8_t *p;
+
+	pos = 0;
+	ofs = hdr_len;
+	for (; m != NULL; m = m->next) {
+		p = rte_pktmbuf_mtod(m, const uint8_t *);
+		for (i = ofs; i != m->data_len; i++, pos++)
+			if (p[i] != (uint8_t)pos)
+				return -1;
+		ofs = 0;
+	}
+	return (pos == BURST_NB_SEGS * BURST_SEG_LEN - hdr_len) ? 0 : -1;
+}
+
+static int
+ipfrag_burst_run(uint32_t flags)
+{
+	struct rte_mbuf *in[4], *out[16], *m;
+	struct rte_ip_frag_death_row dr;
+	struct rte_ip_frag_tbl *tbl;
+	struct ipv4_hdr *ip;
+	uint16_t nb_in, nb_out, i, nb_small;
+	unsigned int avail;
+
+	tbl = rte_ip_frag_table_create(BUCKET_NUM, BUCKET_ENTRIES, BUCKET_NUM,
+		rte_get_tsc_hz(), SOCKET_ID_ANY);
+	TEST_ASSERT_NOT_NULL(tbl, "cannot create table");
+
+	avail = rte_mempool_avail_count(pkt_pool);
+
+	in[0] = build_big_packet(1, 0);
+	in[1] = build_fragment(2, 0, 1);
+	in[2] = build_big_packet(3, 0);
+	in[3] = build_big_packet(4, IPV4_HDR_DF_FLAG);
+	for (i = 0; i != RTE_DIM(in); i++)
+		TEST_ASSERT_NOT_NULL(in[i], "cannot build packet");
+	ip = rte_pktmbuf_mtod(in[1], struct ipv4_hdr *);
+	ip->fragment_offset = 0;
+
+	nb_out = RTE_DIM(out);
+	nb_in = rte_ipv4_fragment_burst(in, RTE_DIM(in), out, &nb_out,
+		BURST_MTU, pkt_pool, pkt_pool, flags);
+	TEST_ASSERT_EQUAL(nb_in, 3, "%u packets consumed", nb_in);
+	TEST_ASSERT_EQUAL(rte_errno, ENOTSUP, "DF packet not reported");
+	TEST_ASSERT_EQUAL(nb_out, 9, "%u packets out", nb_out);
+	rte_pktmbuf_free(in[3]);
+
+	memset(&dr, 0, sizeof(dr));
+	nb_small = 0;
+	for (i = 0; i != nb_out; i++) {
+		ip = rte_pktmbuf_mtod(out[i], struct ipv4_hdr *);
+		TEST_ASSERT(out[i]->pkt_len <= BURST_MTU,
+			"fragment too large: %u", out[i]->pkt_len);
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->total_length),
+			out[i]->pkt_len, "bad total length");
+
+		if (!rte_ipv4_frag_pkt_is_fragmented(ip)) {
+			nb_small++;
+			rte_pktmbuf_free(out[i]);
+			continue;
+		}
+
+		if (flags & RTE_IP_FRAG_F_SW_CKSUM) {
+			TEST_ASSERT_EQUAL(rte_raw_cksum(ip, sizeof(*ip)), 0xffff,
+				"bad fragment checksum");
+			TEST_ASSERT((out[i]->ol_flags & PKT_TX_IP_CKSUM) == 0,
+				"checksum offload requested");
+		} else {
+			TEST_ASSERT(out[i]->ol_flags & PKT_TX_IP_CKSUM,
+				"checksum offload not requested");
+		}
+		if (flags & RTE_IP_FRAG_F_SHARED_HDR)
+			TEST_ASSERT(rte_pktmbuf_headroom(out[i]) >=
+				RTE_IP_FRAG_SHARED_HDR_ROOM,
+				"not enough headroom");
+
+		m = reassemble(tbl, &dr, out[i]);
+		if (m != NULL) {
+			TEST_ASSERT_SUCCESS(check_big_packet(m,
+				sizeof(struct ipv4_hdr)),
+				"bad reassembled payload");
+			rte_pktmbuf_free(m);
+		}
+	}
+	rte_ip_frag_free_death_row(&dr, 0);
+	TEST_ASSERT_EQUAL(nb_small, 1, "small packet not passed through");
+	TEST_ASSERT_EQUAL(tbl->use_entries, 0, "packets not reassembled");
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(pkt_pool), avail, "mbuf leak");
+
+	rte_ip_frag_table_destroy(tbl);
+	return TEST_SUCCESS;
+}
+
+static int
+test_ipfrag_burst(void)
+{
+	TEST_ASSERT_SUCCESS(ipfrag_burst_run(0), "burst fragmentation failed");
+	TEST_ASSERT_SUCCESS(ipfrag_burst_run(RTE_IP_FRAG_F_SW_CKSUM),
+		"burst fragmentation with software checksum failed");
+	TEST_ASSERT_SUCCESS(ipfrag_burst_run(RTE_IP_FRAG_F_SHARED_HDR |
+		RTE_IP_FRAG_F_SW_CKSUM),
+		"burst fragmentation with shared header failed");
+	return TEST_SUCCESS;
+}
+
+static int
+ipfrag_burst6_run(uint32_t flags)
+{
+	struct rte_mbuf *in[3], *out[16], *m;
+	struct rte_ip_frag_death_row dr;
+	struct ipv6_extension_fragment *fh;
+	struct rte_ip_frag_tbl *tbl;
+	struct ipv6_hdr *ip;
+	uint16_t nb_in, nb_out, i, nb_small, nb_reassembled;
+	unsigned int avail;
+
+	tbl = rte_ip_frag_table_create(BUCKET_NUM, BUCKET_ENTRIES, BUCKET_NUM,
+		rte_get_tsc_hz(), SOCKET_ID_ANY);
+	TEST_ASSERT_NOT_NULL(tbl, "cannot create table");
+
+	avail = rte_mempool_avail_count(pkt_pool);
+
+	in[0] = build_big_packet6(1, BURST_NB_SEGS);
+	in[1] = build_big_packet6(2, BURST_NB_SEGS);
+	in[2] = build_big_packet6(3, 1);
+	for (i = 0; i != RTE_DIM(in); i++)
+		TEST_ASSERT_NOT_NULL(in[i], "cannot build packet");
+
+	nb_out = RTE_DIM(out);
+	nb_in = rte_ipv6_fragment_burst(in, RTE_DIM(in), out, &nb_out,
+		BURST_MTU, pkt_pool, pkt_pool, flags);
+	TEST_ASSERT_EQUAL(nb_in, RTE_DIM(in), "%u packets consumed", nb_in);
+	TEST_ASSERT_EQUAL(nb_out, 9, "%u packets out", nb_out);
+
+	memset(&dr, 0, sizeof(dr));
+	nb_small = 0;
+	nb_reassembled = 0;
+	for (i = 0; i != nb_out; i++) {
+		TEST_ASSERT(out[i]->pkt_len <= BURST_MTU,
+			"fragment too large: %u", out[i]->pkt_len);
+
+		ip = rte_pktmbuf_mtod(out[i], struct ipv6_hdr *);
+		fh = rte_ipv6_frag_get_ipv6_fragment_header(ip);
+		if (fh == NULL) {
+			nb_small++;
+			rte_pktmbuf_free(out[i]);
+			continue;
+		}
+
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->payload_len),
+			out[i]->pkt_len - sizeof(*ip), "bad payload length");
+		TEST_ASSERT_EQUAL(fh->next_header, IPPROTO_UDP,
+			"bad next header %u", fh->next_header);
+		if (flags & RTE_IP_FRAG_F_SHARED_HDR)
+			TEST_ASSERT(rte_pktmbuf_headroom(out[i]) >=
+				RTE_IP_FRAG_SHARED_HDR_ROOM,
+				"not enough headroom");
+
+		m = rte_ipv6_frag_reassemble_packet(tbl, &dr, out[i],
+			rte_rdtsc(), ip, fh);
+		if (m != NULL) {
+			nb_reassembled++;
+			ip = rte_pktmbuf_mtod(m, struct ipv6_hdr *);
+			TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->payload_len),
+				m->pkt_len - sizeof(*ip),
+				"bad reassembled payload length");
+			TEST_ASSERT_SUCCESS(check_big_packet(m, sizeof(*ip)),
+				"bad reassembled payload");
+			rte_pktmbuf_free(m);
+		}
+	}
+	rte_ip_frag_free_death_row(&dr, 0);
+	TEST_ASSERT_EQUAL(nb_small, 1, "small packet not passed through");
+	TEST_ASSERT_EQUAL(nb_reassembled, 2, "packets not reassembled");
+	TEST_ASSERT_EQUAL(tbl->use_entries, 0, "entries left in the table");
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(pkt_pool), avail, "mbuf leak");
+
+	rte_ip_frag_table_destroy(tbl);
+	return TEST_SUCCESS;
+}
+
+static int
+test_ipfrag_burst6(void)
+{
+	TEST_ASSERT_SUCCESS(ipfrag_burst6_run(0),
+		"IPv6 burst fragmentation failed");
+	TEST_ASSERT_SUCCESS(ipfrag_burst6_run(RTE_IP_FRAG_F_SHARED_HDR),
+		"IPv6 burst fragmentation with shared header failed");
+	return TEST_SUCCESS;
+}
+
+#define BURST_NB_BIG		128
+
+/* more packets than one call can take mbufs for at once */
+static int
+test_ipfrag_burst_nospc(void)
+{
+	struct rte_mbuf *in[BURST_NB_BIG], *out[BURST_NB_BIG * 4];
+	uint16_t nb_in, nb_out, done, i;
+	unsigned int avail, nb_calls;
+
+	avail = rte_mempool_avail_count(pkt_pool);
+
+	for (i = 0; i != RTE_DIM(in); i++) {
+		in[i] = build_big_packet(i, 0);
+		TEST_ASSERT_NOT_NULL(in[i], "cannot build packet");
+	}
+
+	done = 0;
+	nb_calls = 0;
+	while (done != RTE_DIM(in)) {
+		rte_errno = 0;
+		nb_out = RTE_DIM(out);
+		nb_in = rte_ipv4_fragment_burst(in + done, RTE_DIM(in) - done,
+			out, &nb_out, BURST_MTU, pkt_pool, pkt_pool, 0);
+		TEST_ASSERT(nb_in != 0, "no packet consumed, rte_errno %d",
+			rte_errno);
+		if (done + nb_in != RTE_DIM(in))
+			TEST_ASSERT_EQUAL(rte_errno, ENOSPC,
+				"burst stopped with rte_errno %d", rte_errno);
+		TEST_ASSERT_EQUAL(nb_out, nb_in * 4, "%u packets out", nb_out);
+		for (i = 0; i != nb_out; i++)
+			rte_pktmbuf_free(out[i]);
+		done += nb_in;
+		nb_calls++;
+	}
+	TEST_ASSERT(nb_calls > 1, "whole burst fragmented at once");
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(pkt_pool), avail, "mbuf leak");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_ipfrag_setup(void)
+{
+	if (pkt_pool == NULL) {
+		pkt_pool = rte_pktmbuf_pool_create("IPFRAG_MBUF_POOL",
+			NB_MBUF, 32, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+			SOCKET_ID_ANY);
+		if (pkt_pool == NULL) {
+			printf("%s: Error creating mempool\n", __func__);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static struct unit_test_suite ipfrag_test_suite  = {
+	.setup = test_ipfrag_setup,
+	.suite_name = "IP Fragmentation Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_ipfrag_create),
+		TEST_CASE(test_ipfrag_max_frags),
+		TEST_CASE(test_ipfrag_shared),
+		TEST_CASE(test_ipfrag_burst),
+		TEST_CASE(test_ipfrag_burst6),
+		TEST_CASE(test_ipfrag_burst_nospc),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_ipfrag(void)
+{
+	return unit_test_suite_runner(&ipfrag_test_suite);
+}
+
+REGISTER_TEST_COMMAND(ipfrag_autotest, test_ipfrag);
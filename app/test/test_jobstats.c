@@ -0,0 +1,186 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_memzone.h>
+#include <rte_jobstats_lcore.h>
+
+#include "test.h"
+
+/*
+ * Lcore cycle accounting
+ * ======================
+ *
+ * Check the arguments of the API, then account a sequence of polls on the
+ * calling lcore with delays between them, and check the busy and idle
+ * cycles, the poll and work counters and the histogram of the snapshots
+ * taken before and after. Finally check the busy percentage on fixed
+ * snapshots.
+ */
+
+#define DELAY_US 1000
+
+static int
+test_jobstats_lcore_args(void)
+{
+	struct rte_jobstats_lcore st;
+
+	/* the accounting cannot be disabled once enabled by a previous run */
+	if (rte_memzone_lookup(RTE_JOBSTATS_LCORE_MZ_NAME) == NULL)
+		TEST_ASSERT_EQUAL(rte_jobstats_lcore_read(rte_lcore_id(), &st),
+			-ENOENT, "read before init");
+
+	TEST_ASSERT_SUCCESS(rte_jobstats_lcore_init(),
+		"cannot enable accounting");
+	TEST_ASSERT_SUCCESS(rte_jobstats_lcore_init(),
+		"cannot enable accounting twice");
+
+	TEST_ASSERT_EQUAL(rte_jobstats_lcore_read(RTE_MAX_LCORE, &st),
+		-EINVAL, "invalid lcore accepted");
+	TEST_ASSERT_EQUAL(rte_jobstats_lcore_read(rte_lcore_id(), NULL),
+		-EINVAL, "NULL snapshot accepted");
+	return TEST_SUCCESS;
+}
+
+static int
+test_jobstats_lcore_poll(void)
+{
+	struct rte_jobstats_lcore before, after;
+	uint64_t delay = rte_get_tsc_hz() / 1000000 * DELAY_US;
+	unsigned lcore_id = rte_lcore_id();
+	unsigned percent;
+
+	TEST_ASSERT_SUCCESS(rte_jobstats_lcore_init(),
+		"cannot enable accounting");
+
+	/* start from the idle state */
+	rte_jobstats_lcore_poll(0);
+	TEST_ASSERT_SUCCESS(rte_jobstats_lcore_read(lcore_id, &before),
+		"cannot read counters");
+	TEST_ASSERT_EQUAL(before.busy, 0, "lcore busy after an empty poll");
+
+	rte_jobstats_lcore_poll(5);
+	rte_delay_us(DELAY_US);
+	rte_jobstats_lcore_poll(0);
+	rte_delay_us(DELAY_US);
+	rte_jobstats_lcore_poll(1000);
+	rte_jobstats_lcore_poll(1);
+
+	TEST_ASSERT_SUCCESS(rte_jobstats_lcore_read(lcore_id, &after),
+		"cannot read counters");
+	TEST_ASSERT_EQUAL((after.seq & 1), 0, "update in progress");
+	TEST_ASSERT_EQUAL(after.busy, 1, "lcore idle after a busy poll");
+	TEST_ASSERT_EQUAL(after.polls - before.polls, 4, "bad number of polls");
+	TEST_ASSERT_EQUAL(after.work - before.work, 1006, "bad work");
+	TEST_ASSERT_EQUAL(after.hist[0] - before.hist[0], 1,
+		"bad empty polls");
+	TEST_ASSERT_EQUAL(after.hist[1] - before.hist[1], 1,
+		"bad polls of 1 item");
+	TEST_ASSERT_EQUAL(after.hist[3] - before.hist[3], 1,
+		"bad polls of 4 to 7 items");
+	/* 1000 items are counted in the last bucket */
+	TEST_ASSERT_EQUAL(after.hist[RTE_JOBSTATS_LCORE_HIST_SIZE - 1] -
+		before.hist[RTE_JOBSTATS_LCORE_HIST_SIZE - 1], 1,
+		"bad polls of the last bucket");
+
+	TEST_ASSERT(after.busy_cycles - before.busy_cycles >= delay,
+		"busy period not accounted");
+	TEST_ASSERT(after.idle_cycles - before.idle_cycles >= delay,
+		"idle period not accounted");
+	percent = rte_jobstats_lcore_busy_percent(&before, &after);
+	TEST_ASSERT(percent > 0 && percent < 100,
+		"bad busy percentage %u", percent);
+
+	/* work which is not a poll only makes an idle lcore busy */
+	rte_jobstats_lcore_poll(0);
+	rte_jobstats_lcore_work(0);
+	TEST_ASSERT_SUCCESS(rte_jobstats_lcore_read(lcore_id, &before),
+		"cannot read counters");
+	TEST_ASSERT_EQUAL(before.busy, 0, "lcore busy without work");
+	rte_jobstats_lcore_work(3);
+	TEST_ASSERT_SUCCESS(rte_jobstats_lcore_read(lcore_id, &after),
+		"cannot read counters");
+	TEST_ASSERT_EQUAL(after.busy, 1, "lcore idle after some work");
+	TEST_ASSERT_EQUAL(after.polls, before.polls, "work counted as a poll");
+	TEST_ASSERT_EQUAL(after.work, before.work, "work counted as polled");
+
+	/* back to idle for the other tests running on this lcore */
+	rte_jobstats_lcore_poll(0);
+	return TEST_SUCCESS;
+}
+
+static int
+test_jobstats_lcore_busy_percent(void)
+{
+	struct rte_jobstats_lcore prev, cur;
+
+	memset(&prev, 0, sizeof(prev));
+	memset(&cur, 0, sizeof(cur));
+	TEST_ASSERT_EQUAL(rte_jobstats_lcore_busy_percent(NULL, &cur), 0,
+		"busy without any cycle");
+
+	prev.busy_cycles = 10;
+	prev.idle_cycles = 10;
+	cur.busy_cycles = 40;
+	cur.idle_cycles = 20;
+	TEST_ASSERT_EQUAL(rte_jobstats_lcore_busy_percent(&prev, &cur), 75,
+		"bad percentage between snapshots");
+	TEST_ASSERT_EQUAL(rte_jobstats_lcore_busy_percent(NULL, &cur), 66,
+		"bad percentage since the start");
+	TEST_ASSERT_EQUAL(rte_jobstats_lcore_busy_percent(&cur, &cur), 0,
+		"busy between identical snapshots");
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite jobstats_test_suite  = {
+	.suite_name = "Jobstats Lcore Accounting Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_jobstats_lcore_args),
+		TEST_CASE(test_jobstats_lcore_poll),
+		TEST_CASE(test_jobstats_lcore_busy_percent),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_jobstats(void)
+{
+	return unit_test_suite_runner(&jobstats_test_suite);
+}
+
+REGISTER_TEST_COMMAND(jobstats_autotest, test_jobstats);
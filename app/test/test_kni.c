@@ -32,6 +32,7 @@
  */
 
 #include <stdio.h>
+#include <inttypes.h>
 #include <stdint.h>
 #include <unistd.h>
 #include <string.h>
@@ -370,6 +371,8 @@ test_kni_processing(uint8_t port_id, struct rte_mempool *mp)
 	struct rte_kni_conf conf;
 	struct rte_eth_dev_info info;
 	struct rte_kni_ops ops;
+	struct rte_kni_fifo_stats fifo_stats;
+	unsigned avail;
 
 	if (!mp)
 		return -1;
@@ -392,6 +395,8 @@ test_kni_processing(uint8_t port_id, struct rte_mempool *mp)
 	ops = kni_ops;
 	ops.port_id = port_id;
 
+	avail = rte_mempool_avail_count(mp);
+
 	/* basic test of kni processing */
 	kni = rte_kni_alloc(mp, &conf, &ops);
 	if (!kni) {
@@ -433,19 +438,64 @@ test_kni_processing(uint8_t port_id, struct rte_mempool *mp)
 		goto fail_kni;
 	}
 
+	if (rte_kni_fifo_stats_get(kni, &fifo_stats) < 0) {
+		printf("fail to get kni fifo stats\n");
+		ret = -1;
+		goto fail_kni;
+	}
+	printf("kni fifo stats: rx_q_full %"PRIu64" alloc_q_empty %"PRIu64
+		" alloc_q_full %"PRIu64" free_q_full %"PRIu64
+		" alloc_fail %"PRIu64" recycled %"PRIu64"\n",
+		fifo_stats.rx_q_full, fifo_stats.alloc_q_empty,
+		fifo_stats.alloc_q_full, fifo_stats.free_q_full,
+		fifo_stats.alloc_fail, fifo_stats.recycled);
+
+	/* The kernel gave back the ingress mbufs, they refill alloc_q */
+	if (fifo_stats.recycled == 0) {
+		printf("no mbuf recycled from free_q to alloc_q\n");
+		ret = -1;
+		goto fail_kni;
+	}
+
+	rte_kni_fifo_stats_reset(kni);
+	if (rte_kni_fifo_stats_get(kni, &fifo_stats) < 0 ||
+	    fifo_stats.rx_q_full != 0 || fifo_stats.recycled != 0) {
+		printf("kni fifo stats not reset\n");
+		ret = -1;
+		goto fail_kni;
+	}
+
 	if (rte_kni_release(kni) < 0) {
 		printf("fail to release kni\n");
 		return -1;
 	}
 	test_kni_ctx = NULL;
 
+	/* Each mbuf went back to the mempool exactly once */
+	if (rte_mempool_avail_count(mp) != avail) {
+		printf("%u mbufs in the mempool after release, %u before\n",
+			rte_mempool_avail_count(mp), avail);
+		return -1;
+	}
+
 	/* test of releasing a released kni device */
 	if (rte_kni_release(kni) == 0) {
 		printf("should not release a released kni device\n");
 		return -1;
 	}
 
-	/* test of reusing memzone */
+	/* test of allocating with a too large burst size */
+	conf.alloc_burst = RTE_KNI_BURST_MAX + 1;
+	kni = rte_kni_alloc(mp, &conf, &ops);
+	if (kni) {
+		printf("unexpectedly creates kni with a too large burst\n");
+		rte_kni_release(kni);
+		return -1;
+	}
+
+	/* test of reusing memzone, with larger bursts */
+	conf.alloc_burst = RTE_KNI_BURST_MAX;
+	conf.free_burst = RTE_KNI_BURST_MAX;
 	kni = rte_kni_alloc(mp, &conf, &ops);
 	if (!kni) {
 		printf("fail to create kni\n");
@@ -580,6 +630,13 @@ test_kni(void)
 		goto fail;
 	}
 
+	/* test of getting fifo stats of NULL kni context */
+	if (rte_kni_fifo_stats_get(NULL, NULL) == 0) {
+		ret = -1;
+		printf("unexpectedly get fifo stats of NULL kni context\n");
+		goto fail;
+	}
+
 	/* test of releasing NULL kni context */
 	ret = rte_kni_release(NULL);
 	if (ret == 0) {
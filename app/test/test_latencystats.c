@@ -0,0 +1,281 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+#include <rte_latencystats.h>
+#ifdef RTE_LIBRTE_PMD_RING
+#include <rte_eth_ring.h>
+#endif
+
+#include "test.h"
+
+/*
+ * Latency statistics
+ * ==================
+ *
+ * Loop a ring port on itself, receive a burst, wait, transmit it, and check
+ * the timestamps set by the RX callback and the statistics computed by the
+ * TX callback, then check the sampling interval.
+ */
+
+#define NB_MBUF 512
+#define BURST 8
+#define DELAY_US 100
+
+static struct rte_mempool *pkt_pool;
+
+#ifdef RTE_LIBRTE_PMD_RING
+static int latency_port = -1;
+static struct rte_ring *latency_ring;
+
+static int
+latency_test_rx(struct rte_mbuf **pkts, unsigned nb_pkts)
+{
+	unsigned i;
+
+	if (rte_pktmbuf_alloc_bulk(pkt_pool, pkts, nb_pkts) != 0)
+		return -1;
+	for (i = 0; i < nb_pkts; i++)
+		rte_pktmbuf_append(pkts[i], 64);
+	if (rte_ring_enqueue_bulk(latency_ring, (void **)pkts, nb_pkts) != 0)
+		return -1;
+
+	return rte_eth_rx_burst(latency_port, 0, pkts, nb_pkts);
+}
+
+static void
+latency_test_flush(void)
+{
+	struct rte_mbuf *pkts[BURST];
+	unsigned n, i;
+
+	while ((n = rte_ring_dequeue_burst(latency_ring, (void **)pkts,
+			BURST)) != 0)
+		for (i = 0; i < n; i++)
+			rte_pktmbuf_free(pkts[i]);
+}
+
+static int
+test_latencystats_measure(void)
+{
+	/* leave room in the ring for half a burst */
+	struct rte_mbuf *fill[2 * BURST - 1 - BURST / 2];
+	struct rte_mbuf *pkts[BURST];
+	struct rte_latencystats st, all;
+	uint16_t sent;
+	uint64_t nb;
+	unsigned i;
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_init(0), "cannot enable stats");
+	TEST_ASSERT_EQUAL(rte_latencystats_init(0), -EEXIST,
+		"stats enabled twice");
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_get(latency_port, 0, &st),
+		"cannot read stats");
+	TEST_ASSERT_EQUAL(st.samples, 0, "samples before any traffic");
+
+	TEST_ASSERT_EQUAL(latency_test_rx(pkts, BURST), BURST,
+		"cannot receive packets");
+	for (i = 0; i < BURST; i++)
+		TEST_ASSERT(pkts[i]->ol_flags & PKT_RX_TIMESTAMP,
+			"packet %u not timestamped", i);
+	rte_delay_us(DELAY_US);
+	TEST_ASSERT_EQUAL(rte_eth_tx_burst(latency_port, 0, pkts, BURST),
+		BURST, "cannot send packets");
+	latency_test_flush();
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_get(latency_port, 0, &st),
+		"cannot read stats");
+	TEST_ASSERT_EQUAL(st.samples, BURST, "bad number of samples");
+	TEST_ASSERT(st.min >= DELAY_US * 1000, "latency below the delay");
+	TEST_ASSERT(st.min <= st.avg && st.avg <= st.max,
+		"inconsistent min/avg/max");
+	/* the whole burst has the same timestamp and is measured at once */
+	TEST_ASSERT_EQUAL(st.min, st.max, "latencies of a burst differ");
+	TEST_ASSERT_EQUAL(st.jitter, 0, "jitter within a burst");
+	for (i = 0, nb = 0; i < RTE_LATENCYSTATS_HIST_SIZE; i++)
+		nb += st.hist[i];
+	TEST_ASSERT_EQUAL(nb, BURST, "bad histogram");
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_get(latency_port,
+		RTE_LATENCYSTATS_ALL_QUEUES, &all), "cannot read port stats");
+	TEST_ASSERT_SUCCESS(memcmp(&st, &all, sizeof(st)),
+		"port stats differ from the only queue");
+
+	/* packets not accepted by the port are not measured again */
+	TEST_ASSERT_EQUAL(latency_test_rx(pkts, BURST), BURST,
+		"cannot receive packets");
+	TEST_ASSERT_SUCCESS(rte_pktmbuf_alloc_bulk(pkt_pool, fill,
+		RTE_DIM(fill)), "cannot allocate mbufs");
+	TEST_ASSERT_EQUAL(rte_ring_enqueue_burst(latency_ring, (void **)fill,
+		RTE_DIM(fill)), RTE_DIM(fill), "cannot fill the ring");
+	sent = rte_eth_tx_burst(latency_port, 0, pkts, BURST);
+	TEST_ASSERT_EQUAL(sent, BURST / 2, "ring not full");
+	latency_test_flush();
+	TEST_ASSERT_EQUAL(rte_eth_tx_burst(latency_port, 0, pkts + sent,
+		BURST - sent), BURST - sent, "cannot send packets");
+	latency_test_flush();
+	TEST_ASSERT_SUCCESS(rte_latencystats_get(latency_port, 0, &st),
+		"cannot read stats");
+	TEST_ASSERT_EQUAL(st.samples, 2 * BURST, "packets measured twice");
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_uninit(), "cannot disable");
+	TEST_ASSERT_EQUAL(rte_latencystats_uninit(), -ENOENT,
+		"stats disabled twice");
+
+	/* no more measures once disabled */
+	TEST_ASSERT_EQUAL(latency_test_rx(pkts, BURST), BURST,
+		"cannot receive packets");
+	TEST_ASSERT_EQUAL(rte_eth_tx_burst(latency_port, 0, pkts, BURST),
+		BURST, "cannot send packets");
+	latency_test_flush();
+	TEST_ASSERT_SUCCESS(rte_latencystats_get(latency_port, 0, &st),
+		"cannot read stats");
+	TEST_ASSERT_EQUAL(st.samples, 2 * BURST,
+		"packets measured once disabled");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_latencystats_sampling(void)
+{
+	struct rte_mbuf *pkts[BURST];
+	unsigned i;
+
+	/* one burst per second */
+	TEST_ASSERT_SUCCESS(rte_latencystats_init(NS_PER_S),
+		"cannot enable stats");
+
+	TEST_ASSERT_EQUAL(latency_test_rx(pkts, BURST), BURST,
+		"cannot receive packets");
+	TEST_ASSERT(pkts[0]->ol_flags & PKT_RX_TIMESTAMP,
+		"first burst not timestamped");
+	for (i = 0; i < BURST; i++)
+		rte_pktmbuf_free(pkts[i]);
+
+	TEST_ASSERT_EQUAL(latency_test_rx(pkts, BURST), BURST,
+		"cannot receive packets");
+	for (i = 0; i < BURST; i++)
+		TEST_ASSERT((pkts[i]->ol_flags & PKT_RX_TIMESTAMP) == 0,
+			"packet %u of the second burst timestamped", i);
+	TEST_ASSERT_EQUAL(rte_eth_tx_burst(latency_port, 0, pkts, BURST),
+		BURST, "cannot send packets");
+	latency_test_flush();
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_uninit(), "cannot disable");
+
+	return TEST_SUCCESS;
+}
+#endif
+
+static int
+test_latencystats_args(void)
+{
+	struct rte_latencystats st;
+
+	TEST_ASSERT_EQUAL(rte_latencystats_get(0, 0, NULL), -EINVAL,
+		"NULL stats accepted");
+	TEST_ASSERT_EQUAL(rte_latencystats_get(RTE_MAX_ETHPORTS, 0, &st),
+		-EINVAL, "invalid port accepted");
+	TEST_ASSERT_EQUAL(rte_latencystats_get(0,
+		RTE_LATENCYSTATS_MAX_QUEUES, &st), -EINVAL,
+		"invalid queue accepted");
+	return TEST_SUCCESS;
+}
+
+static int
+test_latencystats_setup(void)
+{
+	if (pkt_pool == NULL) {
+		pkt_pool = rte_pktmbuf_pool_create("LATENCY_POOL", NB_MBUF, 32,
+			0, RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+		if (pkt_pool == NULL) {
+			printf("%s: Error creating mempool\n", __func__);
+			return -1;
+		}
+	}
+#ifdef RTE_LIBRTE_PMD_RING
+	if (latency_port < 0) {
+		latency_ring = rte_ring_create("LATENCY_RING", 2 * BURST,
+			SOCKET_ID_ANY, RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (latency_ring == NULL) {
+			printf("%s: Error creating ring\n", __func__);
+			return -1;
+		}
+		latency_port = rte_eth_from_rings("net_latency_test",
+			&latency_ring, 1, &latency_ring, 1, SOCKET_ID_ANY);
+		if (latency_port < 0) {
+			printf("%s: Error creating ring port\n", __func__);
+			return -1;
+		}
+	}
+#endif
+	return 0;
+}
+
+static int
+test_latencystats_check_leaks(void)
+{
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(pkt_pool), NB_MBUF,
+		"mbuf leak");
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite latencystats_test_suite  = {
+	.setup = test_latencystats_setup,
+	.suite_name = "Latency Statistics Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_latencystats_args),
+#ifdef RTE_LIBRTE_PMD_RING
+		TEST_CASE(test_latencystats_measure),
+		TEST_CASE(test_latencystats_sampling),
+#endif
+		TEST_CASE(test_latencystats_check_leaks),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_latencystats(void)
+{
+	return unit_test_suite_runner(&latencystats_test_suite);
+}
+
+REGISTER_TEST_COMMAND(latencystats_autotest, test_latencystats);
@@ -849,6 +849,88 @@ test_alloc_socket(void)
 	return 0;
 }
 
+static unsigned mem_events[RTE_MEM_EVENT_FREE + 1];
+
+static void
+count_mem_event(enum rte_mem_event event,
+		const struct rte_memseg *ms __rte_unused, void *arg)
+{
+	unsigned *events = arg;
+
+	events[event]++;
+}
+
+#define MEM_EVENTS_SIZE 0x10000
+#define MEM_EVENTS_MAX_FILL 1024
+
+/*
+ * Fill the heap, then allocate a block that fits in one page: this only
+ * succeeds when the heap grows at runtime, which must be notified to the
+ * callbacks. Larger blocks would need physically contiguous pages.
+ */
+static int
+test_mem_events(void)
+{
+	struct rte_malloc_socket_stats stats;
+	static void *fill[MEM_EVENTS_MAX_FILL];
+	int socket = rte_socket_id();
+	unsigned i, nb_fill = 0;
+	void *p;
+
+	if (rte_mem_event_callback_register(NULL, NULL) != -EINVAL ||
+			rte_mem_event_callback_unregister(count_mem_event,
+				mem_events) != -ENOENT)
+		return -1;
+	if (rte_mem_event_callback_register(count_mem_event,
+				mem_events) != 0)
+		return -1;
+	if (rte_mem_event_callback_register(count_mem_event,
+				mem_events) != -EEXIST)
+		goto err;
+
+	/* halve the free elements until none can hold the block */
+	while (nb_fill < MEM_EVENTS_MAX_FILL) {
+		if (rte_malloc_get_socket_stats(socket, &stats) < 0)
+			goto err;
+		if (stats.greatest_free_size < MEM_EVENTS_SIZE)
+			break;
+		fill[nb_fill] = rte_malloc_socket(NULL,
+				stats.greatest_free_size / 2, 0, socket);
+		if (fill[nb_fill] == NULL)
+			goto err;
+		nb_fill++;
+	}
+	if (nb_fill == MEM_EVENTS_MAX_FILL)
+		goto err;
+
+	p = rte_malloc_socket(NULL, MEM_EVENTS_SIZE, 0, socket);
+	if (p == NULL) {
+		printf("%s: heap did not grow\n", __func__);
+		goto err;
+	}
+	if (mem_events[RTE_MEM_EVENT_ALLOC] == 0 ||
+			rte_malloc_validate(p, NULL) < 0)
+		goto err;
+	memset(p, 0xa5, MEM_EVENTS_SIZE);
+	rte_free(p);
+	printf("%s: heap grew and shrank after %u allocations\n",
+		__func__, nb_fill);
+
+	/* memory added for nothing or unused again must be released */
+	if (mem_events[RTE_MEM_EVENT_FREE] != mem_events[RTE_MEM_EVENT_ALLOC])
+		goto err;
+
+	for (i = 0; i < nb_fill; i++)
+		rte_free(fill[i]);
+	return rte_mem_event_callback_unregister(count_mem_event, mem_events);
+
+err:
+	for (i = 0; i < nb_fill; i++)
+		rte_free(fill[i]);
+	rte_mem_event_callback_unregister(count_mem_event, mem_events);
+	return -1;
+}
+
 static int
 test_malloc(void)
 {
@@ -959,4 +1041,23 @@ test_malloc(void)
 	return 0;
 }
 
+/* needs the --dyn-mem EAL option, for more than the initial free memory */
+static int
+test_malloc_dyn(void)
+{
+	if (!rte_eal_has_dyn_mem()) {
+		printf("Dynamic memory disabled, run with --dyn-mem\n");
+		return TEST_SKIPPED;
+	}
+
+	if (test_mem_events() < 0) {
+		printf("test_mem_events() failed\n");
+		return -1;
+	}
+	printf("test_mem_events() passed\n");
+
+	return 0;
+}
+
 REGISTER_TEST_COMMAND(malloc_autotest, test_malloc);
+REGISTER_TEST_COMMAND(malloc_dyn_autotest, test_malloc_dyn);
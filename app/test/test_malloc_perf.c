@@ -0,0 +1,230 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_eal.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+#include <rte_malloc.h>
+
+#include "test.h"
+
+/*
+ * Malloc performance
+ * ==================
+ *
+ *    Each core allocates *n_keep* blocks of *size* bytes with rte_malloc(),
+ *    then frees them. This sequence is done during TIME_S seconds, and the
+ *    number of blocks allocated and freed per second is reported.
+ *
+ *    This test is done on the following configurations:
+ *
+ *    - Cores configuration: one core, two cores, max. cores
+ *
+ *    - Alignment: a cache line, served by the lcore caches when
+ *      CONFIG_RTE_MALLOC_LCORE_CACHE_SIZE is not 0, and two cache lines,
+ *      always served by the heap
+ *
+ *    - Size (*size*): 64, 512 and 4096 bytes
+ *
+ *    - Number of kept blocks (*n_keep*): 1 and 32
+ */
+
+#define N 8192
+#define TIME_S 1
+#define MAX_KEEP 32
+
+static rte_atomic32_t synchro;
+
+static size_t size;
+static unsigned align;
+static unsigned n_keep;
+
+/* number of allocations and frees */
+struct malloc_test_stats {
+	uint64_t count;
+} __rte_cache_aligned;
+
+static struct malloc_test_stats stats[RTE_MAX_LCORE];
+
+static int
+per_lcore_malloc_test(__attribute__((unused)) void *arg)
+{
+	void *obj_table[MAX_KEEP];
+	unsigned lcore_id = rte_lcore_id();
+	uint64_t start_cycles, end_cycles;
+	uint64_t time_diff = 0, hz = rte_get_timer_hz();
+	unsigned i, idx;
+	int ret = 0;
+
+	stats[lcore_id].count = 0;
+
+	/* wait synchro for slaves */
+	if (lcore_id != rte_get_master_lcore())
+		while (rte_atomic32_read(&synchro) == 0)
+			;
+
+	start_cycles = rte_get_timer_cycles();
+
+	while (time_diff / hz < TIME_S) {
+		for (i = 0; likely(i < N / n_keep); i++) {
+			for (idx = 0; idx < n_keep; idx++) {
+				obj_table[idx] = rte_malloc(NULL, size, align);
+				if (unlikely(obj_table[idx] == NULL)) {
+					printf("allocation failed\n");
+					ret = -1;
+					break;
+				}
+			}
+			while (idx > 0)
+				rte_free(obj_table[--idx]);
+			if (ret < 0)
+				goto out;
+		}
+		end_cycles = rte_get_timer_cycles();
+		time_diff = end_cycles - start_cycles;
+		stats[lcore_id].count += N;
+	}
+
+out:
+	rte_malloc_lcore_cache_flush();
+	return ret;
+}
+
+/* launch all the per-lcore test, and display the result */
+static int
+launch_cores(unsigned cores)
+{
+	unsigned lcore_id;
+	uint64_t rate;
+	int ret;
+	unsigned cores_save = cores;
+
+	rte_atomic32_set(&synchro, 0);
+
+	/* reset stats */
+	memset(stats, 0, sizeof(stats));
+
+	printf("malloc_perf cores=%u align=%u size=%zu n_keep=%u ",
+	       cores, align, size, n_keep);
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (cores == 1)
+			break;
+		cores--;
+		rte_eal_remote_launch(per_lcore_malloc_test, NULL, lcore_id);
+	}
+
+	/* start synchro and launch test on master */
+	rte_atomic32_set(&synchro, 1);
+
+	ret = per_lcore_malloc_test(NULL);
+
+	cores = cores_save;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (cores == 1)
+			break;
+		cores--;
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+	}
+
+	if (ret < 0) {
+		printf("per-lcore test returned -1\n");
+		return -1;
+	}
+
+	rate = 0;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		rate += (stats[lcore_id].count / TIME_S);
+
+	printf("rate_persec=%" PRIu64 "\n", rate);
+
+	return 0;
+}
+
+/* for a given number of cores and alignment, launch all test cases */
+static int
+do_one_malloc_test(unsigned cores)
+{
+	size_t size_tab[] = { 64, 512, 4096, 0 };
+	unsigned keep_tab[] = { 1, MAX_KEEP, 0 };
+	size_t *size_ptr;
+	unsigned *keep_ptr;
+
+	for (size_ptr = size_tab; *size_ptr; size_ptr++) {
+		for (keep_ptr = keep_tab; *keep_ptr; keep_ptr++) {
+			size = *size_ptr;
+			n_keep = *keep_ptr;
+			if (launch_cores(cores) < 0)
+				return -1;
+		}
+	}
+	return 0;
+}
+
+static int
+test_malloc_perf(void)
+{
+	unsigned align_tab[] = { RTE_CACHE_LINE_SIZE, 2 * RTE_CACHE_LINE_SIZE, 0 };
+	unsigned *align_ptr;
+
+	rte_atomic32_init(&synchro);
+
+	for (align_ptr = align_tab; *align_ptr; align_ptr++) {
+		align = *align_ptr;
+
+		/* performance test with 1, 2 and max cores */
+		if (do_one_malloc_test(1) < 0)
+			return -1;
+
+		if (rte_lcore_count() > 2 && do_one_malloc_test(2) < 0)
+			return -1;
+
+		if (do_one_malloc_test(rte_lcore_count()) < 0)
+			return -1;
+	}
+
+	rte_malloc_dump_stats(stdout, NULL);
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(malloc_perf_autotest, test_malloc_perf);
@@ -56,6 +56,8 @@
 #include <rte_ring.h>
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
 #include <rte_random.h>
 #include <rte_cycles.h>
 
@@ -930,6 +932,327 @@ test_failing_mbuf_sanity_check(void)
 	return 0;
 }
 
+#define GOTO_FAIL(str, ...) do {					\
+		printf("mbuf test FAILED (l.%d): <" str ">\n",		\
+		       __LINE__,  ##__VA_ARGS__);			\
+		goto fail;						\
+} while(0)
+
+static void
+ext_buf_free_cb(void *addr, void *opaque)
+{
+	unsigned *freed = opaque;
+
+	rte_free(addr);
+	(*freed)++;
+}
+
+/*
+ * Test external buffers:
+ *  - attach an external buffer to an mbuf and put data in it
+ *  - clone the mbuf, the clone shares the external buffer
+ *  - chain the clone after a direct mbuf
+ *  - free the mbufs, the buffer is freed with the last one
+ */
+static int
+test_pktmbuf_ext_buf(void)
+{
+	struct rte_mbuf *m = NULL, *clone = NULL, *head = NULL;
+	struct rte_mbuf_ext_shared_info *shinfo;
+	unaligned_uint32_t *data;
+	unsigned freed = 0;
+	uint16_t buf_len = MBUF_TEST_DATA_LEN;
+	void *buf;
+
+	buf = rte_malloc("test_ext_buf", buf_len, RTE_CACHE_LINE_SIZE);
+	if (buf == NULL)
+		GOTO_FAIL("cannot allocate external buffer");
+	shinfo = rte_pktmbuf_ext_shinfo_init_helper(buf, &buf_len,
+		ext_buf_free_cb, &freed);
+	if (shinfo == NULL || buf_len >= MBUF_TEST_DATA_LEN ||
+			rte_mbuf_ext_refcnt_read(shinfo) != 1) {
+		rte_free(buf);
+		GOTO_FAIL("cannot initialize external buffer shared data");
+	}
+
+	m = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (m == NULL) {
+		rte_free(buf);
+		GOTO_FAIL("cannot allocate mbuf");
+	}
+	rte_pktmbuf_attach_extbuf(m, buf, rte_malloc_virt2phy(buf), buf_len,
+		shinfo);
+	if (!RTE_MBUF_HAS_EXTBUF(m) || RTE_MBUF_DIRECT(m) ||
+			m->buf_addr != buf || m->data_len != 0)
+		GOTO_FAIL("external buffer not attached");
+	data = (unaligned_uint32_t *)rte_pktmbuf_append(m, sizeof(*data));
+	if (data == NULL)
+		GOTO_FAIL("cannot append data to external buffer");
+	*data = MAGIC_DATA;
+
+	clone = rte_pktmbuf_clone(m, pktmbuf_pool);
+	if (clone == NULL)
+		GOTO_FAIL("cannot clone mbuf with external buffer");
+	if (!RTE_MBUF_HAS_EXTBUF(clone) || RTE_MBUF_INDIRECT(clone) ||
+			clone->shinfo != shinfo ||
+			rte_mbuf_ext_refcnt_read(shinfo) != 2 ||
+			rte_mbuf_refcnt_read(m) != 1)
+		GOTO_FAIL("clone does not share the external buffer");
+	if (*rte_pktmbuf_mtod(clone, unaligned_uint32_t *) != MAGIC_DATA)
+		GOTO_FAIL("invalid data in clone");
+
+	head = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (head == NULL)
+		GOTO_FAIL("cannot allocate mbuf");
+	if (rte_pktmbuf_append(head, MBUF_TEST_HDR1_LEN) == NULL ||
+			rte_pktmbuf_chain(head, clone) != 0)
+		GOTO_FAIL("cannot chain external buffer");
+	clone = NULL;
+	if (head->nb_segs != 2 ||
+			head->pkt_len != MBUF_TEST_HDR1_LEN + sizeof(*data))
+		GOTO_FAIL("invalid chain with external buffer");
+
+	rte_pktmbuf_free(m);
+	m = NULL;
+	if (freed != 0 || rte_mbuf_ext_refcnt_read(shinfo) != 1)
+		GOTO_FAIL("external buffer freed while still attached");
+
+	rte_pktmbuf_free(head);
+	head = NULL;
+	if (freed != 1)
+		GOTO_FAIL("external buffer not freed with its last mbuf");
+
+	return 0;
+
+fail:
+	rte_pktmbuf_free(head);
+	rte_pktmbuf_free(clone);
+	rte_pktmbuf_free(m);
+	return -1;
+}
+
+static int
+test_mbuf_dyn(void)
+{
+	const struct rte_mbuf_dynfield dynfield = {
+		.name = "test-dynfield",
+		.size = sizeof(uint8_t),
+		.align = __alignof__(uint8_t),
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynfield dynfield2 = {
+		.name = "test-dynfield2",
+		.size = sizeof(uint16_t),
+		.align = __alignof__(uint16_t),
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynfield dynfield3 = {
+		.name = "test-dynfield3",
+		.size = sizeof(uint64_t),
+		.align = sizeof(uint64_t),
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynfield dynfield_fail_big = {
+		.name = "test-dynfield-fail-big",
+		.size = 256,
+		.align = 1,
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynfield dynfield_fail_align = {
+		.name = "test-dynfield-fail-align",
+		.size = 1,
+		.align = 3,
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynflag dynflag = {
+		.name = "test-dynflag",
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynflag dynflag2 = {
+		.name = "test-dynflag2",
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynflag dynflag3 = {
+		.name = "test-dynflag3",
+		.flags = 0,
+	};
+	struct rte_mbuf_dynfield params;
+	struct rte_mbuf_dynfield dynfield_bad_size;
+	struct rte_mbuf_dynflag dynflag_busy;
+	const size_t area = offsetof(struct rte_mbuf, dynfield1);
+	const size_t area_end = area + sizeof(((struct rte_mbuf *)0)->dynfield1);
+	size_t req;
+	int offset, offset2, offset3, flag, flag2, flag3, last_flag;
+	struct rte_mbuf *m = NULL;
+
+	printf("Test mbuf dynamic fields and flags\n");
+	rte_mbuf_dyn_dump(stdout);
+
+	/* the hot fields of single segment mbufs are in the first line */
+	if (offsetof(struct rte_mbuf, pool) + sizeof(struct rte_mempool *) >
+			RTE_CACHE_LINE_MIN_SIZE)
+		GOTO_FAIL("pool is not in the first cache line");
+
+	offset = rte_mbuf_dynfield_register(&dynfield);
+	if (offset < 0 || (size_t)offset < area || (size_t)offset >= area_end)
+		GOTO_FAIL("failed to register dynamic field, offset=%d: %s",
+			offset, strerror(rte_errno));
+	if (rte_mbuf_dynfield_register(&dynfield) != offset)
+		GOTO_FAIL("failed to register dynamic field a second time");
+
+	offset2 = rte_mbuf_dynfield_register(&dynfield2);
+	if (offset2 < 0 || offset2 == offset || (offset2 & 1) != 0)
+		GOTO_FAIL("failed to register dynamic field 2, offset2=%d",
+			offset2);
+
+	/* the last aligned 8 bytes of the dynamic area */
+	req = RTE_ALIGN_FLOOR(area_end - sizeof(uint64_t), sizeof(uint64_t));
+	offset3 = rte_mbuf_dynfield_register_offset(&dynfield3, req);
+	if (offset3 != (int)req)
+		GOTO_FAIL("failed to register dynamic field 3, offset3=%d: %s",
+			offset3, strerror(rte_errno));
+	if (rte_mbuf_dynfield_register_offset(&dynfield3, req - 8) != -1 ||
+			rte_errno != EEXIST)
+		GOTO_FAIL("dynamic field 3 registered at another offset");
+
+	dynfield_bad_size = dynfield3;
+	dynfield_bad_size.size = sizeof(uint32_t);
+	dynfield_bad_size.align = sizeof(uint32_t);
+	if (rte_mbuf_dynfield_register(&dynfield_bad_size) != -1 ||
+			rte_errno != EEXIST)
+		GOTO_FAIL("dynamic field registered with another size");
+	snprintf(dynfield_bad_size.name, sizeof(dynfield_bad_size.name),
+		"test-dynfield-fail-busy");
+	if (rte_mbuf_dynfield_register_offset(&dynfield_bad_size, req) != -1 ||
+			rte_errno != EBUSY)
+		GOTO_FAIL("dynamic field registered over another one");
+	if (rte_mbuf_dynfield_register_offset(&dynfield_bad_size,
+			offsetof(struct rte_mbuf, pool)) != -1 ||
+			rte_errno != EBUSY)
+		GOTO_FAIL("dynamic field registered over a static field");
+
+	if (rte_mbuf_dynfield_lookup(dynfield3.name, &params) != offset3 ||
+			params.size != dynfield3.size ||
+			params.align != dynfield3.align)
+		GOTO_FAIL("failed to look up dynamic field 3");
+	if (rte_mbuf_dynfield_lookup("test-dynfield-missing", NULL) != -1 ||
+			rte_errno != ENOENT)
+		GOTO_FAIL("unregistered dynamic field found");
+
+	if (rte_mbuf_dynfield_register(&dynfield_fail_big) != -1 ||
+			rte_errno != EINVAL)
+		GOTO_FAIL("dynamic field larger than the mbuf registered");
+	if (rte_mbuf_dynfield_register(&dynfield_fail_align) != -1 ||
+			rte_errno != EINVAL)
+		GOTO_FAIL("dynamic field with invalid align registered");
+
+	flag = rte_mbuf_dynflag_register(&dynflag);
+	if (flag < 0 || (1ULL << flag) < PKT_FIRST_FREE ||
+			(1ULL << flag) > PKT_LAST_FREE)
+		GOTO_FAIL("failed to register dynamic flag, flag=%d: %s",
+			flag, strerror(rte_errno));
+	if (rte_mbuf_dynflag_register(&dynflag) != flag)
+		GOTO_FAIL("failed to register dynamic flag a second time");
+	flag2 = rte_mbuf_dynflag_register(&dynflag2);
+	if (flag2 < 0 || flag2 == flag)
+		GOTO_FAIL("failed to register dynamic flag 2, flag2=%d",
+			flag2);
+
+	last_flag = __builtin_ctzll(PKT_LAST_FREE);
+	flag3 = rte_mbuf_dynflag_register_bitnum(&dynflag3, last_flag);
+	if (flag3 != last_flag)
+		GOTO_FAIL("failed to register dynamic flag 3, flag3=%d: %s",
+			flag3, strerror(rte_errno));
+	snprintf(dynflag_busy.name, sizeof(dynflag_busy.name),
+		"test-dynflag-fail-busy");
+	dynflag_busy.flags = 0;
+	if (rte_mbuf_dynflag_register_bitnum(&dynflag_busy, last_flag) != -1 ||
+			rte_errno != EBUSY)
+		GOTO_FAIL("dynamic flag registered over another one");
+	if (rte_mbuf_dynflag_register_bitnum(&dynflag_busy,
+			__builtin_ctzll(PKT_RX_VLAN_STRIPPED)) != -1 ||
+			rte_errno != EINVAL)
+		GOTO_FAIL("dynamic flag registered over a static flag");
+	if (rte_mbuf_dynflag_lookup(dynflag2.name, NULL) != flag2)
+		GOTO_FAIL("failed to look up dynamic flag 2");
+	if (rte_mbuf_dynflag_lookup("test-dynflag-missing", NULL) != -1 ||
+			rte_errno != ENOENT)
+		GOTO_FAIL("unregistered dynamic flag found");
+
+	rte_mbuf_dyn_dump(stdout);
+
+	/* the fields do not overlap each other nor the static fields */
+	m = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (m == NULL)
+		GOTO_FAIL("cannot allocate mbuf");
+	m->timestamp = 0;
+	m->seqn = 0;
+	*RTE_MBUF_DYNFIELD(m, offset, uint8_t *) = 1;
+	*RTE_MBUF_DYNFIELD(m, offset2, uint16_t *) = 1000;
+	*RTE_MBUF_DYNFIELD(m, offset3, uint64_t *) = UINT64_MAX;
+	m->ol_flags |= (1ULL << flag) | (1ULL << flag3);
+	if (*RTE_MBUF_DYNFIELD(m, offset, uint8_t *) != 1 ||
+			*RTE_MBUF_DYNFIELD(m, offset2, uint16_t *) != 1000 ||
+			*RTE_MBUF_DYNFIELD(m, offset3, uint64_t *) != UINT64_MAX)
+		GOTO_FAIL("invalid value in dynamic field");
+	if (m->pool != pktmbuf_pool || m->next != NULL ||
+			m->timestamp != 0 || m->seqn != 0 ||
+			(m->ol_flags & (1ULL << flag2)) != 0)
+		GOTO_FAIL("dynamic field or flag overwrote the mbuf");
+	rte_pktmbuf_free(m);
+
+	return 0;
+
+fail:
+	rte_pktmbuf_free(m);
+	return -1;
+}
+
+/*
+ * Free a chain the way drivers do, with __rte_pktmbuf_prefree_seg() then
+ * a put into the pool: the next field of the pooled mbufs stays NULL.
+ */
+static int
+test_pktmbuf_prefree_seg(void)
+{
+	struct rte_mbuf *m, *segs[2];
+	unsigned i;
+
+	m = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (m == NULL)
+		GOTO_FAIL("cannot allocate mbuf");
+	segs[0] = m;
+	segs[1] = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (segs[1] == NULL || rte_pktmbuf_chain(m, segs[1]) != 0) {
+		rte_pktmbuf_free(segs[1]);
+		GOTO_FAIL("cannot chain mbuf");
+	}
+	m = NULL;
+
+	for (i = 0; i < RTE_DIM(segs); i++)
+		if (__rte_pktmbuf_prefree_seg(segs[i]) != segs[i] ||
+				segs[i]->next != NULL || segs[i]->nb_segs != 1)
+			GOTO_FAIL("segment %u not unchained", i);
+	rte_mempool_put_bulk(pktmbuf_pool, (void **)segs, RTE_DIM(segs));
+
+	/* the lcore cache gives the same mbufs back */
+	for (i = 0; i < RTE_DIM(segs); i++) {
+		m = rte_mbuf_raw_alloc(pktmbuf_pool);
+		if (m == NULL)
+			GOTO_FAIL("cannot allocate mbuf");
+		if (m->next != NULL)
+			GOTO_FAIL("pooled mbuf with a next segment");
+		rte_pktmbuf_free(m);
+	}
+
+	return 0;
+
+fail:
+	rte_pktmbuf_free(m);
+	return -1;
+}
+
+#undef GOTO_FAIL
 
 static int
 test_mbuf(void)
@@ -1023,6 +1346,21 @@ test_mbuf(void)
 		printf("test_failing_mbuf_sanity_check() failed\n");
 		return -1;
 	}
+
+	if (test_pktmbuf_ext_buf() < 0) {
+		printf("test_pktmbuf_ext_buf() failed\n");
+		return -1;
+	}
+
+	if (test_mbuf_dyn() < 0) {
+		printf("test_mbuf_dyn() failed\n");
+		return -1;
+	}
+
+	if (test_pktmbuf_prefree_seg() < 0) {
+		printf("test_pktmbuf_prefree_seg() failed\n");
+		return -1;
+	}
 	return 0;
 }
 
@@ -0,0 +1,225 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_mempool.h>
+#include <rte_mbuf.h>
+
+#include "test.h"
+
+/*
+ * Mbuf
+ * ====
+ *
+ * Measures the cost of the mbuf part of forwarding single segment packets:
+ * a burst is allocated, filled as a receive function does, classified,
+ * read as a transmit function does and freed as a transmit function frees
+ * the sent mbufs. The packet data is never touched, so the cost comes
+ * from the mbuf structures only.
+ *
+ * The pool is large and has no cache, so that mbufs come back to the
+ * forwarding loop after all the others, cold as after being held by a
+ * NIC ring. The loop runs once touching only the first cache line of the
+ * mbufs, and once writing the next field of the second cache line on
+ * free, as the previous layout did when reading the pool pointer there.
+ */
+
+#define PERF_NB_MBUF       32767
+#define PERF_DATA_ROOM     (RTE_PKTMBUF_HEADROOM + 64)
+#define PERF_BURST         32
+#define PERF_ITERATIONS    (1 << 15)
+#define PERF_PKT_LEN       60
+
+static struct rte_mempool *perf_pool;
+
+#define MBUF_FIELD(f) \
+	{ #f, offsetof(struct rte_mbuf, f), sizeof(((struct rte_mbuf *)0)->f) }
+
+/* fields of the mbuf used to forward a single segment packet */
+static const struct {
+	const char *name;
+	size_t offset;
+	size_t size;
+} fwd_fields[] = {
+	MBUF_FIELD(buf_physaddr),
+	MBUF_FIELD(data_off),
+	MBUF_FIELD(refcnt),
+	MBUF_FIELD(nb_segs),
+	MBUF_FIELD(port),
+	MBUF_FIELD(ol_flags),
+	MBUF_FIELD(packet_type),
+	MBUF_FIELD(pkt_len),
+	MBUF_FIELD(data_len),
+	MBUF_FIELD(hash),
+	MBUF_FIELD(pool),
+};
+
+/* number of cache lines of the mbuf spanned by the forwarding fields */
+static unsigned
+fwd_cache_lines(void)
+{
+	uint64_t lines = 0;
+	unsigned i, first, last;
+
+	for (i = 0; i < RTE_DIM(fwd_fields); i++) {
+		first = fwd_fields[i].offset / RTE_CACHE_LINE_MIN_SIZE;
+		last = (fwd_fields[i].offset + fwd_fields[i].size - 1) /
+			RTE_CACHE_LINE_MIN_SIZE;
+		for (; first <= last; first++)
+			lines |= 1ULL << first;
+		printf("  %-14s offset %3zu, line %zu\n", fwd_fields[i].name,
+			fwd_fields[i].offset,
+			fwd_fields[i].offset / RTE_CACHE_LINE_MIN_SIZE);
+	}
+	return __builtin_popcountll(lines);
+}
+
+static inline uint64_t
+fwd_burst(struct rte_mbuf **pkts, unsigned n, int touch_line1)
+{
+	struct rte_mbuf *free_pkts[PERF_BURST];
+	struct rte_mempool *mp = NULL;
+	struct rte_mbuf *m;
+	uint64_t desc = 0;
+	unsigned i, nb_free = 0;
+
+	/* receive: rearm and descriptor fields */
+	for (i = 0; i < n; i++) {
+		m = pkts[i];
+		m->data_off = RTE_PKTMBUF_HEADROOM;
+		rte_mbuf_refcnt_set(m, 1);
+		m->nb_segs = 1;
+		m->port = 0;
+		m->ol_flags = PKT_RX_RSS_HASH;
+		m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			RTE_PTYPE_L4_UDP;
+		m->pkt_len = PERF_PKT_LEN;
+		m->data_len = PERF_PKT_LEN;
+		m->hash.rss = i;
+	}
+
+	/* classify: choose the output port */
+	for (i = 0; i < n; i++) {
+		m = pkts[i];
+		if ((m->packet_type & RTE_PTYPE_L3_MASK) == RTE_PTYPE_L3_IPV4)
+			m->port = m->hash.rss & 1;
+	}
+
+	/* transmit: build the descriptors */
+	for (i = 0; i < n; i++) {
+		m = pkts[i];
+		desc += m->buf_physaddr + m->data_off + m->data_len +
+			(m->ol_flags & PKT_TX_OFFLOAD_MASK);
+	}
+
+	/* free the sent mbufs back to their pool */
+	for (i = 0; i < n; i++) {
+		m = __rte_pktmbuf_prefree_seg(pkts[i]);
+		if (m == NULL)
+			continue;
+		if (touch_line1)
+			m->next = NULL;
+		if (mp != NULL && m->pool != mp) {
+			rte_mempool_put_bulk(mp, (void **)free_pkts, nb_free);
+			nb_free = 0;
+		}
+		mp = m->pool;
+		free_pkts[nb_free++] = m;
+	}
+	if (nb_free != 0)
+		rte_mempool_put_bulk(mp, (void **)free_pkts, nb_free);
+
+	return desc;
+}
+
+static int
+test_fwd_loop(const char *name, int touch_line1)
+{
+	struct rte_mbuf *pkts[PERF_BURST];
+	uint64_t start, end, desc = 0;
+	unsigned i;
+
+	start = rte_rdtsc();
+	for (i = 0; i < PERF_ITERATIONS; i++) {
+		if (rte_mempool_get_bulk(perf_pool, (void **)pkts,
+				PERF_BURST) != 0) {
+			printf("cannot allocate mbufs\n");
+			return -1;
+		}
+		desc += fwd_burst(pkts, PERF_BURST, touch_line1);
+	}
+	end = rte_rdtsc();
+
+	printf("%s: %.2f cycles per packet (desc sum %"PRIu64")\n", name,
+		(double)(end - start) / (PERF_ITERATIONS * PERF_BURST), desc);
+	return 0;
+}
+
+static int
+test_mbuf_perf(void)
+{
+	unsigned nb_lines;
+
+	if (perf_pool == NULL)
+		perf_pool = rte_pktmbuf_pool_create("test_mbuf_perf_pool",
+			PERF_NB_MBUF, 0, 0, PERF_DATA_ROOM, rte_socket_id());
+	if (perf_pool == NULL) {
+		printf("cannot allocate mbuf pool\n");
+		return -1;
+	}
+
+	printf("Fields of a forwarded single segment mbuf:\n");
+	nb_lines = fwd_cache_lines();
+	printf("Cache lines of the mbuf touched per packet: %u\n", nb_lines);
+	if (nb_lines != 1) {
+		printf("forwarding fields are not in the first cache line\n");
+		return -1;
+	}
+
+	/* first run to warm up the pool and the TLB */
+	if (test_fwd_loop("warm up", 0) < 0)
+		return -1;
+	if (test_fwd_loop("first cache line only", 0) < 0)
+		return -1;
+	if (test_fwd_loop("second cache line on free", 1) < 0)
+		return -1;
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(mbuf_perf_autotest, test_mbuf_perf);
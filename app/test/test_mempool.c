@@ -69,11 +69,19 @@
  *    - Get two objects, put two objects
  *    - Get all objects, test that their content is not modified and
  *      put them back in the pool.
+ *
+ * Adaptive cache test: done on one core, check that the per-lcore cache
+ * shrinks with put-only traffic and grows with large balanced bursts.
+ *
+ * Handler test: done on all cores, dequeue and enqueue bursts of objects
+ *    from the stack handlers concurrently, check that no object is given
+ *    twice and that all objects are back in the pool at the end.
  */
 
 #define MEMPOOL_ELT_SIZE 2048
 #define MAX_KEEP 16
 #define MEMPOOL_SIZE ((rte_lcore_count()*(MAX_KEEP+RTE_MEMPOOL_CACHE_MAX_SIZE))-1)
+#define MT_ITERATIONS 100000
 
 #define LOG_ERR() printf("test failed at %s():%d\n", __func__, __LINE__)
 #define RET_ERR() do {							\
@@ -237,6 +245,64 @@ static int test_mempool_creation_with_exceeded_cache_size(void)
 	return 0;
 }
 
+/*
+ * Check that an adaptive cache shrinks when its lcore only puts objects
+ * and grows when its lcore gets and puts bursts larger than the cache.
+ */
+static int
+test_mempool_cache_adaptive(void)
+{
+	struct rte_mempool *mp;
+	struct rte_mempool_cache *cache;
+	void *objs[MAX_KEEP * 4];
+	unsigned i, j;
+	int ret = 0;
+
+	mp = rte_mempool_create("test_cache_adaptive", MEMPOOL_SIZE,
+		MEMPOOL_ELT_SIZE, 32, 0,
+		NULL, NULL,
+		my_obj_init, NULL,
+		SOCKET_ID_ANY, MEMPOOL_F_CACHE_ADAPTIVE);
+	if (mp == NULL)
+		RET_ERR();
+
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	if (cache == NULL || cache->min_size != 4 || cache->max_size != 128)
+		GOTO_ERR(ret, out);
+
+	/* put only: objects are taken from the pool behind the cache */
+	for (i = 0; i < 512; i++) {
+		if (rte_mempool_generic_get(mp, objs, MAX_KEEP, NULL, 0) < 0)
+			GOTO_ERR(ret, out);
+		for (j = 0; j < MAX_KEEP; j++)
+			rte_mempool_generic_put(mp, &objs[j], 1, cache, 0);
+	}
+	if (cache->size != cache->min_size)
+		GOTO_ERR(ret, out);
+
+	/* balanced bursts larger than the cache */
+	for (i = 0; i < 512; i++) {
+		if (rte_mempool_generic_get(mp, objs, RTE_DIM(objs),
+				cache, 0) < 0)
+			GOTO_ERR(ret, out);
+		for (j = 0; j < RTE_DIM(objs); j++)
+			rte_mempool_generic_put(mp, &objs[j], 1, cache, 0);
+	}
+	if (cache->size != cache->max_size)
+		GOTO_ERR(ret, out);
+
+	rte_mempool_dump(stdout, mp);
+	rte_mempool_audit(mp);
+
+	rte_mempool_cache_flush(cache, mp);
+	if (rte_mempool_avail_count(mp) != MEMPOOL_SIZE)
+		GOTO_ERR(ret, out);
+
+out:
+	rte_mempool_free(mp);
+	return ret;
+}
+
 static struct rte_mempool *mp_spsc;
 static rte_spinlock_t scsp_spinlock;
 static void *scsp_obj_table[MAX_KEEP];
@@ -501,12 +567,83 @@ test_mempool_xmem_misc(void)
 	return 0;
 }
 
+static struct rte_mempool *mp_mt;
+
+/* the word after the object number flags the objects owned by an lcore */
+static int
+test_mempool_handler_loop(__attribute__((unused)) void *arg)
+{
+	void *objs[MAX_KEEP];
+	rte_atomic32_t *owned;
+	unsigned i, j, n;
+
+	while (rte_atomic32_read(&synchro) == 0)
+		rte_pause();
+
+	for (i = 0; i < MT_ITERATIONS; i++) {
+		n = 1 + i % MAX_KEEP;
+		/* each lcore keeps less than MAX_KEEP, the pool is never
+		 * empty */
+		if (rte_mempool_ops_dequeue_bulk(mp_mt, objs, n) != 0)
+			RET_ERR();
+		for (j = 0; j < n; j++) {
+			owned = (rte_atomic32_t *)((uint32_t *)objs[j] + 1);
+			if (rte_atomic32_test_and_set(owned) == 0) {
+				printf("obj %u dequeued twice\n",
+					*(uint32_t *)objs[j]);
+				RET_ERR();
+			}
+		}
+		for (j = 0; j < n; j++) {
+			owned = (rte_atomic32_t *)((uint32_t *)objs[j] + 1);
+			rte_atomic32_clear(owned);
+		}
+		if (rte_mempool_ops_enqueue_bulk(mp_mt, objs, n) != 0)
+			RET_ERR();
+	}
+
+	return 0;
+}
+
+/*
+ * Dequeue and enqueue bursts from the handler of a mempool without cache
+ * on all lcores at once.
+ */
+static int
+test_mempool_handler_mt(struct rte_mempool *mp)
+{
+	unsigned lcore_id;
+	int ret = 0;
+
+	mp_mt = mp;
+	rte_atomic32_set(&synchro, 0);
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		rte_eal_remote_launch(test_mempool_handler_loop, NULL,
+			lcore_id);
+	rte_atomic32_set(&synchro, 1);
+
+	if (test_mempool_handler_loop(NULL) < 0)
+		ret = -1;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+	rte_atomic32_set(&synchro, 0);
+
+	if (rte_mempool_ops_get_count(mp) != mp->size) {
+		LOG_ERR();
+		ret = -1;
+	}
+
+	return ret;
+}
+
 static int
 test_mempool(void)
 {
 	struct rte_mempool *mp_cache = NULL;
 	struct rte_mempool *mp_nocache = NULL;
 	struct rte_mempool *mp_stack = NULL;
+	struct rte_mempool *mp_lf_stack = NULL;
 
 	rte_atomic32_init(&synchro);
 
@@ -556,6 +693,29 @@ test_mempool(void)
 	}
 	rte_mempool_obj_iter(mp_stack, my_obj_init, NULL);
 
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_ARM64)
+	/* create a mempool with the lock-free stack handler (without cache) */
+	mp_lf_stack = rte_mempool_create_empty("test_lf_stack",
+		MEMPOOL_SIZE,
+		MEMPOOL_ELT_SIZE,
+		0, 0,
+		SOCKET_ID_ANY, 0);
+
+	if (mp_lf_stack == NULL) {
+		printf("cannot allocate mp_lf_stack mempool\n");
+		goto err;
+	}
+	if (rte_mempool_set_ops_byname(mp_lf_stack, "lf_stack", NULL) < 0) {
+		printf("cannot set lf_stack handler\n");
+		goto err;
+	}
+	if (rte_mempool_populate_default(mp_lf_stack) < 0) {
+		printf("cannot populate mp_lf_stack mempool\n");
+		goto err;
+	}
+	rte_mempool_obj_iter(mp_lf_stack, my_obj_init, NULL);
+#endif
+
 	/* retrieve the mempool from its name */
 	if (rte_mempool_lookup("test_nocache") != mp_nocache) {
 		printf("Cannot lookup mempool from its name\n");
@@ -590,6 +750,9 @@ test_mempool(void)
 	if (test_mempool_same_name_twice_creation() < 0)
 		goto err;
 
+	if (test_mempool_cache_adaptive() < 0)
+		goto err;
+
 	if (test_mempool_xmem_misc() < 0)
 		goto err;
 
@@ -597,6 +760,18 @@ test_mempool(void)
 	if (test_mempool_basic(mp_stack, 1) < 0)
 		goto err;
 
+	if (test_mempool_handler_mt(mp_stack) < 0)
+		goto err;
+
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_ARM64)
+	/* test the lock-free stack handler */
+	if (test_mempool_basic(mp_lf_stack, 0) < 0)
+		goto err;
+
+	if (test_mempool_handler_mt(mp_lf_stack) < 0)
+		goto err;
+#endif
+
 	rte_mempool_list_dump(stdout);
 
 	return 0;
@@ -605,6 +780,7 @@ err:
 	rte_mempool_free(mp_nocache);
 	rte_mempool_free(mp_cache);
 	rte_mempool_free(mp_stack);
+	rte_mempool_free(mp_lf_stack);
 	return -1;
 }
 
@@ -81,6 +81,9 @@
  *      - One core with user-owned cache
  *      - Two cores with user-owned cache
  *      - Max. cores with user-owned cache
+ *      - One core, two cores and max. cores without cache, with the
+ *        "stack" and "lf_stack" handlers, to compare them with the
+ *        default ring handler
  *
  *    - Bulk size (*n_get_bulk*, *n_put_bulk*)
  *
@@ -112,6 +115,7 @@
 
 static struct rte_mempool *mp;
 static struct rte_mempool *mp_cache, *mp_nocache;
+static struct rte_mempool *mp_stack, *mp_lf_stack;
 static int use_external_cache;
 static unsigned external_cache_size = RTE_MEMPOOL_CACHE_MAX_SIZE;
 
@@ -310,6 +314,43 @@ do_one_mempool_test(unsigned cores)
 	return 0;
 }
 
+/* create a mempool without cache using the given handler */
+static struct rte_mempool *
+create_handler_mempool(const char *name, const char *ops_name)
+{
+	struct rte_mempool *mp_ops;
+
+	mp_ops = rte_mempool_create_empty(name, MEMPOOL_SIZE,
+					  MEMPOOL_ELT_SIZE, 0, 0,
+					  SOCKET_ID_ANY, 0);
+	if (mp_ops == NULL)
+		return NULL;
+	if (rte_mempool_set_ops_byname(mp_ops, ops_name, NULL) < 0 ||
+	    rte_mempool_populate_default(mp_ops) < 0) {
+		rte_mempool_free(mp_ops);
+		return NULL;
+	}
+	rte_mempool_obj_iter(mp_ops, my_obj_init, NULL);
+
+	return mp_ops;
+}
+
+/* performance test with 1, 2 and max cores on the current mempool */
+static int
+do_all_cores_mempool_test(void)
+{
+	if (do_one_mempool_test(1) < 0)
+		return -1;
+
+	if (do_one_mempool_test(2) < 0)
+		return -1;
+
+	if (do_one_mempool_test(rte_lcore_count()) < 0)
+		return -1;
+
+	return 0;
+}
+
 static int
 test_mempool_perf(void)
 {
@@ -375,6 +416,31 @@ test_mempool_perf(void)
 
 	if (do_one_mempool_test(rte_lcore_count()) < 0)
 		return -1;
+	use_external_cache = 0;
+
+	/* create mempools (without cache) using stack handlers */
+	if (mp_stack == NULL)
+		mp_stack = create_handler_mempool("perf_test_stack", "stack");
+	if (mp_stack == NULL)
+		return -1;
+
+	printf("start performance test (stack handler, without cache)\n");
+	mp = mp_stack;
+	if (do_all_cores_mempool_test() < 0)
+		return -1;
+
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_ARM64)
+	if (mp_lf_stack == NULL)
+		mp_lf_stack = create_handler_mempool("perf_test_lf_stack",
+						     "lf_stack");
+	if (mp_lf_stack == NULL)
+		return -1;
+
+	printf("start performance test (lf_stack handler, without cache)\n");
+	mp = mp_lf_stack;
+	if (do_all_cores_mempool_test() < 0)
+		return -1;
+#endif
 
 	rte_mempool_list_dump(stdout);
 
@@ -0,0 +1,250 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <rte_memory.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_metrics.h>
+#include <rte_bitrate.h>
+#ifdef RTE_LIBRTE_PMD_RING
+#include <rte_eth_ring.h>
+#endif
+
+#include "test.h"
+
+/*
+ * Metrics
+ * =======
+ *
+ * Register single metrics and sets of metrics, check the rejected names,
+ * update global and per port values and read them back, then register the
+ * bitrate metrics and compute the bitrates of an idle ring port.
+ */
+
+/* the registry keeps the names of previous runs */
+static unsigned test_run;
+
+static int
+test_metrics_reg(void)
+{
+	char name[RTE_METRICS_MAX_NAME_LEN + 1];
+	char set_names[3][RTE_METRICS_MAX_NAME_LEN];
+	const char *names[3];
+	struct rte_metric_name *all;
+	int key, first, cnt, i;
+
+	snprintf(name, sizeof(name), "test_%u_single", test_run);
+	key = rte_metrics_reg_name(name);
+	TEST_ASSERT(key >= 0, "cannot register a metric");
+	TEST_ASSERT_EQUAL(rte_metrics_reg_name(name), -EEXIST,
+		"metric registered twice");
+
+	for (i = 0; i < 3; i++) {
+		snprintf(set_names[i], sizeof(set_names[i]), "test_%u_set%d",
+			test_run, i);
+		names[i] = set_names[i];
+	}
+	first = rte_metrics_reg_names(names, 3);
+	TEST_ASSERT_EQUAL(first, key + 1, "keys not consecutive");
+
+	/* a set with a duplicate is not registered at all */
+	cnt = rte_metrics_get_names(NULL, 0);
+	snprintf(set_names[0], sizeof(set_names[0]), "test_%u_new", test_run);
+	snprintf(set_names[2], sizeof(set_names[2]), "test_%u_new", test_run);
+	TEST_ASSERT_EQUAL(rte_metrics_reg_names(names, 3), -EEXIST,
+		"duplicate names registered");
+	TEST_ASSERT_EQUAL(rte_metrics_get_names(NULL, 0), cnt,
+		"partial set registered");
+
+	memset(name, 'x', RTE_METRICS_MAX_NAME_LEN);
+	name[RTE_METRICS_MAX_NAME_LEN] = '\0';
+	TEST_ASSERT_EQUAL(rte_metrics_reg_name(name), -EINVAL,
+		"too long name registered");
+	TEST_ASSERT_EQUAL(rte_metrics_reg_name(""), -EINVAL,
+		"empty name registered");
+
+	all = malloc(sizeof(*all) * cnt);
+	TEST_ASSERT_NOT_NULL(all, "cannot allocate names");
+	TEST_ASSERT_EQUAL(rte_metrics_get_names(all, cnt - 1), cnt,
+		"bad count with a small table");
+	TEST_ASSERT_EQUAL(rte_metrics_get_names(all, cnt), cnt,
+		"bad count");
+	snprintf(name, sizeof(name), "test_%u_set2", test_run);
+	TEST_ASSERT_SUCCESS(strcmp(all[first + 2].name, name),
+		"bad name for key %d", first + 2);
+	free(all);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_metrics_update(void)
+{
+	char name[RTE_METRICS_MAX_NAME_LEN];
+	uint64_t vals[2] = { 123, 456 };
+	struct rte_metric_value *values;
+	int key, cnt;
+
+	snprintf(name, sizeof(name), "test_%u_update", test_run);
+	key = rte_metrics_reg_name(name);
+	TEST_ASSERT(key >= 0, "cannot register a metric");
+	snprintf(name, sizeof(name), "test_%u_update2", test_run);
+	TEST_ASSERT_EQUAL(rte_metrics_reg_name(name), key + 1,
+		"keys not consecutive");
+
+	TEST_ASSERT_SUCCESS(rte_metrics_update_value(RTE_METRICS_GLOBAL, key,
+		42), "cannot update a global metric");
+	TEST_ASSERT_SUCCESS(rte_metrics_update_values(1, key, vals, 2),
+		"cannot update port metrics");
+	TEST_ASSERT_EQUAL(rte_metrics_update_values(1, key, vals, 3), -EINVAL,
+		"unregistered key updated");
+	TEST_ASSERT_EQUAL(rte_metrics_update_value(RTE_MAX_ETHPORTS, key, 1),
+		-EINVAL, "invalid port updated");
+	TEST_ASSERT_EQUAL(rte_metrics_update_value(-2, key, 1),
+		-EINVAL, "invalid port updated");
+
+	cnt = rte_metrics_get_values(RTE_METRICS_GLOBAL, NULL, 0);
+	TEST_ASSERT_EQUAL(cnt, key + 2, "bad number of values");
+	values = malloc(sizeof(*values) * cnt);
+	TEST_ASSERT_NOT_NULL(values, "cannot allocate values");
+
+	TEST_ASSERT_EQUAL(rte_metrics_get_values(RTE_METRICS_GLOBAL, values,
+		cnt), cnt, "cannot read global values");
+	TEST_ASSERT_EQUAL(values[key].key, key, "bad key");
+	TEST_ASSERT_EQUAL(values[key].value, 42, "bad global value");
+	TEST_ASSERT_EQUAL(values[key + 1].value, 0, "bad global value");
+
+	TEST_ASSERT_EQUAL(rte_metrics_get_values(1, values, cnt), cnt,
+		"cannot read port values");
+	TEST_ASSERT_EQUAL(values[key].value, 123, "bad port value");
+	TEST_ASSERT_EQUAL(values[key + 1].value, 456, "bad port value");
+
+	TEST_ASSERT_EQUAL(rte_metrics_get_values(0, values, cnt), cnt,
+		"cannot read port values");
+	TEST_ASSERT_EQUAL(values[key].value, 0, "value leaked to port 0");
+	free(values);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_bitrate(void)
+{
+	static struct rte_stats_bitrates *bitrate_data;
+	struct rte_metric_name *names;
+	struct rte_metric_value *values;
+	int cnt, i, found = 0;
+#ifdef RTE_LIBRTE_PMD_RING
+	static struct rte_ring *ring;
+	static int port = -1;
+#endif
+
+	if (bitrate_data == NULL) {
+		bitrate_data = rte_stats_bitrate_create();
+		TEST_ASSERT_NOT_NULL(bitrate_data, "cannot create bitrate");
+		TEST_ASSERT_EQUAL(rte_stats_bitrate_calc(bitrate_data, 0),
+			-EINVAL, "bitrate computed before registration");
+		TEST_ASSERT_SUCCESS(rte_stats_bitrate_reg(bitrate_data),
+			"cannot register bitrate metrics");
+	}
+
+	cnt = rte_metrics_get_names(NULL, 0);
+	names = malloc(sizeof(*names) * cnt);
+	TEST_ASSERT_NOT_NULL(names, "cannot allocate names");
+	TEST_ASSERT_EQUAL(rte_metrics_get_names(names, cnt), cnt,
+		"cannot read names");
+	for (i = 0; i < cnt; i++)
+		if (strcmp(names[i].name, "peak_bits_out") == 0)
+			found = 1;
+	free(names);
+	TEST_ASSERT(found, "bitrate metrics not registered");
+
+#ifdef RTE_LIBRTE_PMD_RING
+	if (port < 0) {
+		ring = rte_ring_create("METRICS_RING", 16, SOCKET_ID_ANY,
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+		TEST_ASSERT_NOT_NULL(ring, "cannot create ring");
+		port = rte_eth_from_rings("net_metrics_test", &ring, 1, &ring,
+			1, SOCKET_ID_ANY);
+		TEST_ASSERT(port >= 0, "cannot create ring port");
+	}
+
+	TEST_ASSERT_SUCCESS(rte_stats_bitrate_calc(bitrate_data, port),
+		"cannot compute bitrate");
+	rte_delay_ms(10);
+	TEST_ASSERT_SUCCESS(rte_stats_bitrate_calc(bitrate_data, port),
+		"cannot compute bitrate");
+
+	values = malloc(sizeof(*values) * cnt);
+	TEST_ASSERT_NOT_NULL(values, "cannot allocate values");
+	TEST_ASSERT_EQUAL(rte_metrics_get_values(port, values, cnt), cnt,
+		"cannot read values");
+	for (i = 0; i < cnt; i++)
+		TEST_ASSERT_EQUAL(values[i].value, 0,
+			"non null metric %d on an idle port", i);
+	free(values);
+#else
+	RTE_SET_USED(values);
+#endif
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_metrics_setup(void)
+{
+	test_run++;
+	return rte_metrics_init(SOCKET_ID_ANY);
+}
+
+static struct unit_test_suite metrics_test_suite  = {
+	.setup = test_metrics_setup,
+	.suite_name = "Metrics Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_metrics_reg),
+		TEST_CASE(test_metrics_update),
+		TEST_CASE(test_bitrate),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_metrics(void)
+{
+	return unit_test_suite_runner(&metrics_test_suite);
+}
+
+REGISTER_TEST_COMMAND(metrics_autotest, test_metrics);
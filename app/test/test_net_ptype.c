@@ -0,0 +1,516 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <string.h>
+#include <stdio.h>
+#include <netinet/in.h>
+
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_sctp.h>
+#include <rte_mbuf.h>
+#include <rte_net.h>
+
+#include "test.h"
+
+/*
+ * Packet type parser
+ * ==================
+ *
+ * Build packets of various types, with VLAN tags, IP options and
+ * extensions, fragments and tunnels, parse them as a burst through the
+ * RX callback, then check their packet type and header lengths, and that
+ * rte_net_get_ptype() agrees with the fast path.
+ */
+
+#define NB_MBUF 64
+#define PAYLOAD_LEN 64
+
+static struct rte_mempool *pool;
+
+struct ptype_test_pkt {
+	uint8_t buf[256];
+	uint16_t len;
+};
+
+struct ptype_test_case {
+	const char *name;
+	void (*build)(struct ptype_test_pkt *p);
+	uint32_t ptype;
+	uint8_t outer_l2_len;
+	uint16_t outer_l3_len;
+	uint8_t l2_len;
+	uint16_t l3_len;
+	uint8_t l4_len;
+};
+
+static void *
+add_hdr(struct ptype_test_pkt *p, uint16_t len)
+{
+	void *hdr = p->buf + p->len;
+
+	memset(hdr, 0, len);
+	p->len += len;
+	return hdr;
+}
+
+static void
+add_eth(struct ptype_test_pkt *p, uint16_t type)
+{
+	struct ether_hdr *eth = add_hdr(p, sizeof(*eth));
+
+	eth->d_addr.addr_bytes[5] = 2;
+	eth->s_addr.addr_bytes[5] = 1;
+	eth->ether_type = rte_cpu_to_be_16(type);
+}
+
+static void
+add_vlan(struct ptype_test_pkt *p, uint16_t type)
+{
+	struct vlan_hdr *vh = add_hdr(p, sizeof(*vh));
+
+	vh->vlan_tci = rte_cpu_to_be_16(100);
+	vh->eth_proto = rte_cpu_to_be_16(type);
+}
+
+static void
+add_ipv4(struct ptype_test_pkt *p, uint8_t proto, uint8_t ihl,
+	 uint16_t frag)
+{
+	struct ipv4_hdr *ip = add_hdr(p, ihl * IPV4_IHL_MULTIPLIER);
+
+	ip->version_ihl = 0x40 | ihl;
+	ip->fragment_offset = rte_cpu_to_be_16(IPV4_HDR_DF_FLAG | frag);
+	ip->time_to_live = 64;
+	ip->next_proto_id = proto;
+	ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 2));
+}
+
+static void
+add_ipv6(struct ptype_test_pkt *p, uint8_t proto)
+{
+	struct ipv6_hdr *ip6 = add_hdr(p, sizeof(*ip6));
+
+	ip6->vtc_flow = rte_cpu_to_be_32(6 << 28);
+	ip6->proto = proto;
+	ip6->hop_limits = 64;
+	ip6->src_addr[15] = 1;
+	ip6->dst_addr[15] = 2;
+}
+
+/* IPv6 extension header of len bytes */
+static void
+add_ipv6_ext(struct ptype_test_pkt *p, uint8_t proto, uint16_t len)
+{
+	uint8_t *ext = add_hdr(p, len);
+
+	ext[0] = proto;
+	ext[1] = len / 8 - 1;
+}
+
+static void
+add_l4(struct ptype_test_pkt *p, uint8_t proto, uint16_t dst_port)
+{
+	struct tcp_hdr *tcp;
+	struct udp_hdr *udp;
+
+	switch (proto) {
+	case IPPROTO_TCP:
+		tcp = add_hdr(p, sizeof(*tcp));
+		tcp->src_port = rte_cpu_to_be_16(1024);
+		tcp->dst_port = rte_cpu_to_be_16(dst_port);
+		tcp->data_off = sizeof(*tcp) << 2;
+		break;
+	case IPPROTO_UDP:
+		udp = add_hdr(p, sizeof(*udp));
+		udp->src_port = rte_cpu_to_be_16(1024);
+		udp->dst_port = rte_cpu_to_be_16(dst_port);
+		break;
+	case IPPROTO_SCTP:
+		add_hdr(p, sizeof(struct sctp_hdr));
+		break;
+	default:
+		add_hdr(p, 8);
+		break;
+	}
+}
+
+static void
+add_vxlan(struct ptype_test_pkt *p)
+{
+	struct vxlan_hdr *vxh = add_hdr(p, sizeof(*vxh));
+
+	vxh->vx_flags = rte_cpu_to_be_32(0x08000000);
+	vxh->vx_vni = rte_cpu_to_be_32(100 << 8);
+}
+
+static void
+add_gre(struct ptype_test_pkt *p, uint16_t flags, uint16_t proto)
+{
+	uint16_t *gre = add_hdr(p, 4);
+
+	gre[0] = rte_cpu_to_be_16(flags);
+	gre[1] = rte_cpu_to_be_16(proto);
+	if (flags & 0x2000)
+		add_hdr(p, 4); /* key */
+}
+
+static void
+build_tcp4(struct ptype_test_pkt *p)
+{
+	add_eth(p, ETHER_TYPE_IPv4);
+	add_ipv4(p, IPPROTO_TCP, 5, 0);
+	add_l4(p, IPPROTO_TCP, 80);
+}
+
+static void
+build_udp4(struct ptype_test_pkt *p)
+{
+	add_eth(p, ETHER_TYPE_IPv4);
+	add_ipv4(p, IPPROTO_UDP, 5, 0);
+	add_l4(p, IPPROTO_UDP, 53);
+}
+
+static void
+build_vlan_tcp4_opts(struct ptype_test_pkt *p)
+{
+	add_eth(p, ETHER_TYPE_VLAN);
+	add_vlan(p, ETHER_TYPE_IPv4);
+	add_ipv4(p, IPPROTO_TCP, 6, 0);
+	add_l4(p, IPPROTO_TCP, 80);
+}
+
+static void
+build_qinq_udp6_ext(struct ptype_test_pkt *p)
+{
+	add_eth(p, ETHER_TYPE_QINQ);
+	add_vlan(p, ETHER_TYPE_VLAN);
+	add_vlan(p, ETHER_TYPE_IPv6);
+	add_ipv6(p, IPPROTO_HOPOPTS);
+	add_ipv6_ext(p, IPPROTO_DSTOPTS, 8);
+	add_ipv6_ext(p, IPPROTO_UDP, 16);
+	add_l4(p, IPPROTO_UDP, 53);
+}
+
+static void
+build_sctp6(struct ptype_test_pkt *p)
+{
+	add_eth(p, ETHER_TYPE_IPv6);
+	add_ipv6(p, IPPROTO_SCTP);
+	add_l4(p, IPPROTO_SCTP, 0);
+}
+
+static void
+build_frag4(struct ptype_test_pkt *p)
+{
+	add_eth(p, ETHER_TYPE_IPv4);
+	add_ipv4(p, IPPROTO_UDP, 5, IPV4_HDR_MF_FLAG);
+	add_l4(p, IPPROTO_UDP, 53);
+}
+
+static void
+build_frag6(struct ptype_test_pkt *p)
+{
+	add_eth(p, ETHER_TYPE_IPv6);
+	add_ipv6(p, IPPROTO_FRAGMENT);
+	add_ipv6_ext(p, IPPROTO_TCP, 8);
+	add_l4(p, IPPROTO_TCP, 80);
+}
+
+static void
+build_icmp4(struct ptype_test_pkt *p)
+{
+	add_eth(p, ETHER_TYPE_IPv4);
+	add_ipv4(p, IPPROTO_ICMP, 5, 0);
+	add_l4(p, IPPROTO_ICMP, 0);
+}
+
+static void
+build_arp(struct ptype_test_pkt *p)
+{
+	add_eth(p, ETHER_TYPE_ARP);
+	add_hdr(p, 28);
+}
+
+static void
+build_vxlan(struct ptype_test_pkt *p)
+{
+	add_eth(p, ETHER_TYPE_IPv4);
+	add_ipv4(p, IPPROTO_UDP, 5, 0);
+	add_l4(p, IPPROTO_UDP, RTE_NET_VXLAN_PORT);
+	add_vxlan(p);
+	add_eth(p, ETHER_TYPE_IPv4);
+	add_ipv4(p, IPPROTO_TCP, 5, 0);
+	add_l4(p, IPPROTO_TCP, 80);
+}
+
+static void
+build_nvgre(struct ptype_test_pkt *p)
+{
+	add_eth(p, ETHER_TYPE_IPv6);
+	add_ipv6(p, IPPROTO_GRE);
+	add_gre(p, 0x2000, ETHER_TYPE_TEB);
+	add_eth(p, ETHER_TYPE_VLAN);
+	add_vlan(p, ETHER_TYPE_IPv4);
+	add_ipv4(p, IPPROTO_UDP, 5, 0);
+	add_l4(p, IPPROTO_UDP, 53);
+}
+
+static void
+build_gre_ip(struct ptype_test_pkt *p)
+{
+	add_eth(p, ETHER_TYPE_IPv4);
+	add_ipv4(p, IPPROTO_GRE, 5, 0);
+	add_gre(p, 0, ETHER_TYPE_IPv4);
+	add_ipv4(p, IPPROTO_SCTP, 5, 0);
+	add_l4(p, IPPROTO_SCTP, 0);
+}
+
+static void
+build_ipip6(struct ptype_test_pkt *p)
+{
+	add_eth(p, ETHER_TYPE_IPv4);
+	add_ipv4(p, IPPROTO_IPV6, 5, 0);
+	add_ipv6(p, IPPROTO_ICMPV6);
+	add_l4(p, IPPROTO_ICMPV6, 0);
+}
+
+static const struct ptype_test_case ptype_test_cases[] = {
+	{ "TCP/IPv4", build_tcp4,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_TCP,
+	  0, 0, 14, 20, 20 },
+	{ "UDP/IPv4", build_udp4,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_UDP,
+	  0, 0, 14, 20, 8 },
+	{ "TCP/IPv4 with options/VLAN", build_vlan_tcp4_opts,
+	  RTE_PTYPE_L2_ETHER_VLAN | RTE_PTYPE_L3_IPV4_EXT |
+	  RTE_PTYPE_L4_TCP,
+	  0, 0, 18, 24, 20 },
+	{ "UDP/IPv6 with extensions/QinQ", build_qinq_udp6_ext,
+	  RTE_PTYPE_L2_ETHER_QINQ | RTE_PTYPE_L3_IPV6_EXT |
+	  RTE_PTYPE_L4_UDP,
+	  0, 0, 22, 64, 8 },
+	{ "SCTP/IPv6", build_sctp6,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 | RTE_PTYPE_L4_SCTP,
+	  0, 0, 14, 40, 12 },
+	{ "IPv4 fragment", build_frag4,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_FRAG,
+	  0, 0, 14, 20, 0 },
+	{ "IPv6 fragment", build_frag6,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6_EXT | RTE_PTYPE_L4_FRAG,
+	  0, 0, 14, 48, 0 },
+	{ "ICMP/IPv4", build_icmp4,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_ICMP,
+	  0, 0, 14, 20, 0 },
+	{ "ARP", build_arp,
+	  RTE_PTYPE_L2_ETHER_ARP,
+	  0, 0, 14, 0, 0 },
+	{ "TCP/IPv4/VXLAN", build_vxlan,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_TUNNEL_VXLAN |
+	  RTE_PTYPE_INNER_L2_ETHER | RTE_PTYPE_INNER_L3_IPV4 |
+	  RTE_PTYPE_INNER_L4_TCP,
+	  14, 20, 8 + 8 + 14, 20, 20 },
+	{ "UDP/IPv4/VLAN/NVGRE/IPv6", build_nvgre,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 | RTE_PTYPE_TUNNEL_NVGRE |
+	  RTE_PTYPE_INNER_L2_ETHER_VLAN | RTE_PTYPE_INNER_L3_IPV4 |
+	  RTE_PTYPE_INNER_L4_UDP,
+	  14, 40, 8 + 18, 20, 8 },
+	{ "SCTP/IPv4/GRE", build_gre_ip,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_TUNNEL_GRE |
+	  RTE_PTYPE_INNER_L3_IPV4 | RTE_PTYPE_INNER_L4_SCTP,
+	  14, 20, 4, 20, 12 },
+	{ "ICMPv6/IPv6/IPv4", build_ipip6,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_TUNNEL_IP |
+	  RTE_PTYPE_INNER_L3_IPV6 | RTE_PTYPE_INNER_L4_ICMP,
+	  14, 20, 0, 40, 0 },
+};
+
+#define NB_CASES RTE_DIM(ptype_test_cases)
+
+static struct rte_mbuf *
+ptype_test_build_mbuf(void (*build)(struct ptype_test_pkt *p),
+		      uint16_t trunc)
+{
+	struct ptype_test_pkt pkt;
+	struct rte_mbuf *m;
+	uint8_t *data;
+
+	pkt.len = 0;
+	build(&pkt);
+	add_hdr(&pkt, PAYLOAD_LEN);
+	if (trunc != 0 && trunc < pkt.len)
+		pkt.len = trunc;
+
+	m = rte_pktmbuf_alloc(pool);
+	if (m == NULL)
+		return NULL;
+	data = (uint8_t *)rte_pktmbuf_append(m, pkt.len);
+	memcpy(data, pkt.buf, pkt.len);
+	/* stale values, as left by a previous use of the mbuf */
+	m->packet_type = UINT32_MAX;
+	m->tx_offload = UINT64_MAX;
+	return m;
+}
+
+static int
+test_net_ptype_burst(void)
+{
+	struct rte_mbuf *pkts[NB_CASES];
+	const struct ptype_test_case *tc;
+	struct rte_net_hdr_lens lens;
+	unsigned int i;
+	int ret = TEST_FAILED;
+
+	memset(pkts, 0, sizeof(pkts));
+	for (i = 0; i < NB_CASES; i++) {
+		pkts[i] = ptype_test_build_mbuf(ptype_test_cases[i].build, 0);
+		if (pkts[i] == NULL) {
+			printf("cannot allocate mbuf\n");
+			goto out;
+		}
+	}
+
+	if (rte_net_ptype_rx_callback(0, 0, pkts, NB_CASES, NB_CASES,
+				      NULL) != NB_CASES) {
+		printf("packets dropped by the callback\n");
+		goto out;
+	}
+
+	for (i = 0; i < NB_CASES; i++) {
+		tc = &ptype_test_cases[i];
+		if (pkts[i]->packet_type != tc->ptype ||
+		    pkts[i]->outer_l2_len != tc->outer_l2_len ||
+		    pkts[i]->outer_l3_len != tc->outer_l3_len ||
+		    pkts[i]->l2_len != tc->l2_len ||
+		    pkts[i]->l3_len != tc->l3_len ||
+		    pkts[i]->l4_len != tc->l4_len) {
+			printf("%s: got ptype 0x%08x, lengths %u %u %u %u %u\n",
+			       tc->name, pkts[i]->packet_type,
+			       pkts[i]->outer_l2_len, pkts[i]->outer_l3_len,
+			       pkts[i]->l2_len, pkts[i]->l3_len,
+			       pkts[i]->l4_len);
+			goto out;
+		}
+		if (rte_net_get_ptype(pkts[i], &lens) != tc->ptype ||
+		    rte_net_get_ptype(pkts[i], NULL) != tc->ptype) {
+			printf("%s: rte_net_get_ptype() disagrees\n",
+			       tc->name);
+			goto out;
+		}
+	}
+	ret = TEST_SUCCESS;
+
+out:
+	for (i = 0; i < NB_CASES; i++)
+		rte_pktmbuf_free(pkts[i]);
+	return ret;
+}
+
+/* Headers cut in the first segment are not reported. */
+static int
+test_net_ptype_truncated(void)
+{
+	struct rte_net_hdr_lens lens;
+	struct rte_mbuf *m;
+	uint32_t ptype;
+
+	/* IPv4 header cut */
+	m = ptype_test_build_mbuf(build_tcp4, sizeof(struct ether_hdr) + 10);
+	TEST_ASSERT_NOT_NULL(m, "cannot allocate mbuf");
+	rte_net_parse_ptype_burst(&m, 1);
+	ptype = m->packet_type;
+	rte_net_get_ptype(m, &lens);
+	rte_pktmbuf_free(m);
+	TEST_ASSERT_EQUAL(ptype, RTE_PTYPE_L2_ETHER,
+		"wrong ptype 0x%08x for a cut IPv4 header", ptype);
+	TEST_ASSERT_EQUAL(lens.l3_len, 0, "cut IPv4 header reported");
+
+	/* TCP header cut: the type is known, not the length */
+	m = ptype_test_build_mbuf(build_tcp4, sizeof(struct ether_hdr) +
+				  sizeof(struct ipv4_hdr) + 10);
+	TEST_ASSERT_NOT_NULL(m, "cannot allocate mbuf");
+	rte_net_parse_ptype_burst(&m, 1);
+	ptype = m->packet_type;
+	rte_net_get_ptype(m, &lens);
+	rte_pktmbuf_free(m);
+	TEST_ASSERT_EQUAL(ptype, (RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+		RTE_PTYPE_L4_TCP), "wrong ptype 0x%08x for a cut TCP header",
+		ptype);
+	TEST_ASSERT_EQUAL(lens.l4_len, 0, "cut TCP header reported");
+
+	/* runt frame */
+	m = ptype_test_build_mbuf(build_tcp4, 10);
+	TEST_ASSERT_NOT_NULL(m, "cannot allocate mbuf");
+	rte_net_parse_ptype_burst(&m, 1);
+	ptype = m->packet_type;
+	rte_pktmbuf_free(m);
+	TEST_ASSERT_EQUAL(ptype, RTE_PTYPE_UNKNOWN,
+		"wrong ptype 0x%08x for a runt frame", ptype);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_net_ptype_setup(void)
+{
+	if (pool == NULL) {
+		pool = rte_pktmbuf_pool_create("PTYPE_POOL", NB_MBUF, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+		if (pool == NULL) {
+			printf("%s: Error creating mempool\n", __func__);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static struct unit_test_suite net_ptype_test_suite  = {
+	.setup = test_net_ptype_setup,
+	.suite_name = "Packet Type Parser Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_net_ptype_burst),
+		TEST_CASE(test_net_ptype_truncated),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_net_ptype(void)
+{
+	return unit_test_suite_runner(&net_ptype_test_suite);
+}
+
+REGISTER_TEST_COMMAND(net_ptype_autotest, test_net_ptype);
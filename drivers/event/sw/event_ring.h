@@ -0,0 +1,151 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _SW_EVENT_RING_H_
+#define _SW_EVENT_RING_H_
+
+/**
+ * @file
+ * Single producer, single consumer ring of events
+ *
+ * rte_ring only stores pointers, while the ports of the software event
+ * device exchange 16 byte events with the scheduler. This ring copies the
+ * events themselves, one lcore enqueuing and another dequeuing.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_malloc.h>
+#include <rte_atomic.h>
+#include <rte_eventdev.h>
+
+struct sw_event_ring {
+	uint32_t size;  /**< Number of slots, a power of 2. */
+	uint32_t mask;  /**< size - 1. */
+
+	/** Written by the producer only. */
+	volatile uint32_t write_idx __rte_cache_aligned;
+	/** Written by the consumer only. */
+	volatile uint32_t read_idx __rte_cache_aligned;
+
+	struct rte_event ring[0] __rte_cache_aligned;
+};
+
+static inline struct sw_event_ring *
+sw_event_ring_create(const char *name, unsigned int size, int socket_id)
+{
+	struct sw_event_ring *r;
+
+	size = rte_align32pow2(size);
+	r = rte_zmalloc_socket(name, sizeof(*r) + size * sizeof(r->ring[0]),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (r == NULL)
+		return NULL;
+
+	r->size = size;
+	r->mask = size - 1;
+	return r;
+}
+
+static inline void
+sw_event_ring_free(struct sw_event_ring *r)
+{
+	rte_free(r);
+}
+
+static inline void
+sw_event_ring_reset(struct sw_event_ring *r)
+{
+	r->write_idx = 0;
+	r->read_idx = 0;
+}
+
+static inline uint32_t
+sw_event_ring_count(const struct sw_event_ring *r)
+{
+	return r->write_idx - r->read_idx;
+}
+
+static inline uint32_t
+sw_event_ring_free_count(const struct sw_event_ring *r)
+{
+	return r->size - sw_event_ring_count(r);
+}
+
+/* Enqueue up to n events, return the number enqueued. */
+static inline uint16_t
+sw_event_ring_enqueue_burst(struct sw_event_ring *r,
+		const struct rte_event *ev, uint16_t n)
+{
+	const uint32_t write = r->write_idx;
+	const uint32_t space = r->size - (write - r->read_idx);
+	uint16_t i;
+
+	if (n > space)
+		n = space;
+
+	for (i = 0; i < n; i++)
+		r->ring[(write + i) & r->mask] = ev[i];
+
+	/* publish the events after they are written */
+	rte_smp_wmb();
+	r->write_idx = write + n;
+	return n;
+}
+
+/* Dequeue up to n events, return the number dequeued. */
+static inline uint16_t
+sw_event_ring_dequeue_burst(struct sw_event_ring *r,
+		struct rte_event *ev, uint16_t n)
+{
+	const uint32_t read = r->read_idx;
+	const uint32_t avail = r->write_idx - read;
+	uint16_t i;
+
+	if (n > avail)
+		n = avail;
+
+	/* read the events after their publication */
+	rte_smp_rmb();
+	for (i = 0; i < n; i++)
+		ev[i] = r->ring[(read + i) & r->mask];
+
+	/* free the slots once the events are read */
+	rte_smp_rmb();
+	r->read_idx = read + n;
+	return n;
+}
+
+#endif /* _SW_EVENT_RING_H_ */
@@ -0,0 +1,585 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_dev.h>
+#include <rte_kvargs.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+
+#include "sw_evdev.h"
+
+#define SW_SOCKET_ID_ARG "socket_id"
+#define SW_QID_DEFAULT_ORDER_SEQS 1024
+#define SW_PORT_DEFAULT_THRESHOLD 1024
+
+static const char *sw_valid_args[] = {
+	SW_SOCKET_ID_ARG,
+	NULL
+};
+
+static uint64_t
+sw_ns_to_ticks(uint64_t ns)
+{
+	return ns * rte_get_timer_hz() / 1E9;
+}
+
+static void
+sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info)
+{
+	RTE_SET_USED(dev);
+
+	info->driver_name = SW_PMD_NAME_STR;
+	info->min_dequeue_timeout_ns = 1;
+	info->max_dequeue_timeout_ns = UINT32_MAX;
+	info->dequeue_timeout_ns = 0;
+	info->max_event_queues = RTE_EVENT_MAX_QUEUES_PER_DEV;
+	info->max_event_queue_flows = SW_QID_NUM_FIDS;
+	info->max_event_queue_priority_levels = RTE_EVENT_DEV_PRIORITY_LOWEST;
+	info->max_event_priority_levels = 1;
+	info->max_event_ports = SW_PORTS_MAX;
+	info->max_event_port_dequeue_depth = SW_DEQ_DEPTH_MAX;
+	info->max_event_port_enqueue_depth = SW_ENQ_DEPTH_MAX;
+	info->max_num_events = SW_INFLIGHT_EVENTS_TOTAL;
+	info->event_dev_cap = RTE_EVENT_DEV_CAP_QUEUE_QOS;
+}
+
+static int
+sw_dev_configure(const struct rte_eventdev *dev)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	const struct rte_event_dev_config *conf = &dev->data->dev_conf;
+
+	sw->nb_qids = conf->nb_event_queues;
+	sw->nb_ports = conf->nb_event_ports;
+	sw->nb_events_limit = conf->nb_events_limit;
+	sw->per_deq_timeout = !!(conf->event_dev_cfg &
+			RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT);
+	sw->deq_timeout_ticks = sw_ns_to_ticks(conf->dequeue_timeout_ns);
+
+	return 0;
+}
+
+static void
+sw_queue_def_conf(struct rte_eventdev *dev, uint8_t queue_id,
+		struct rte_event_queue_conf *conf)
+{
+	uint32_t flows = dev->data->dev_conf.nb_event_queue_flows;
+
+	RTE_SET_USED(queue_id);
+
+	conf->nb_atomic_flows = flows;
+	conf->nb_atomic_order_sequences =
+		RTE_MIN(flows, (uint32_t)SW_QID_DEFAULT_ORDER_SEQS);
+	conf->event_queue_cfg = RTE_EVENT_QUEUE_CFG_ALL_TYPES;
+	conf->priority = RTE_EVENT_DEV_PRIORITY_NORMAL;
+}
+
+static void
+sw_queue_release(struct rte_eventdev *dev, uint8_t queue_id)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	struct sw_qid *q = &sw->qids[queue_id];
+
+	rte_free(q->iq);
+	rte_free(q->fids);
+	rte_free(q->rob);
+	memset(q, 0, sizeof(*q));
+}
+
+static int
+sw_queue_setup(struct rte_eventdev *dev, uint8_t queue_id,
+		const struct rte_event_queue_conf *conf)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	struct sw_qid *q = &sw->qids[queue_id];
+	uint32_t iq_size, rob_size, i;
+
+	if (q->initialized)
+		sw_queue_release(dev, queue_id);
+
+	switch (conf->event_queue_cfg & RTE_EVENT_QUEUE_CFG_TYPE_MASK) {
+	case RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY:
+		q->type = RTE_SCHED_TYPE_ATOMIC;
+		break;
+	case RTE_EVENT_QUEUE_CFG_ORDERED_ONLY:
+		q->type = RTE_SCHED_TYPE_ORDERED;
+		break;
+	case RTE_EVENT_QUEUE_CFG_PARALLEL_ONLY:
+		q->type = RTE_SCHED_TYPE_PARALLEL;
+		break;
+	default:
+		q->type = SW_SCHED_TYPE_ALL;
+		break;
+	}
+	q->id = queue_id;
+	q->priority = conf->priority;
+	q->single_link = !!(conf->event_queue_cfg &
+			RTE_EVENT_QUEUE_CFG_SINGLE_LINK);
+
+	/* each IQ can hold all the events in flight */
+	iq_size = rte_align32pow2(sw->nb_events_limit);
+	q->iq = rte_malloc_socket("sw_evdev iq", iq_size * sizeof(q->iq[0]),
+			RTE_CACHE_LINE_SIZE, sw->socket_id);
+	if (q->iq == NULL)
+		goto nomem;
+	q->iq_mask = iq_size - 1;
+
+	if (q->type == SW_SCHED_TYPE_ALL ||
+			q->type == RTE_SCHED_TYPE_ATOMIC) {
+		q->fids = rte_malloc_socket("sw_evdev fids",
+				SW_QID_NUM_FIDS * sizeof(q->fids[0]),
+				RTE_CACHE_LINE_SIZE, sw->socket_id);
+		if (q->fids == NULL)
+			goto nomem;
+		for (i = 0; i < SW_QID_NUM_FIDS; i++)
+			q->fids[i].port = -1;
+	}
+
+	if (q->type == SW_SCHED_TYPE_ALL ||
+			q->type == RTE_SCHED_TYPE_ORDERED) {
+		rob_size = rte_align32pow2(RTE_MAX(1U,
+					conf->nb_atomic_order_sequences));
+		q->rob = rte_zmalloc_socket("sw_evdev rob",
+				rob_size * sizeof(q->rob[0]),
+				RTE_CACHE_LINE_SIZE, sw->socket_id);
+		if (q->rob == NULL)
+			goto nomem;
+		q->rob_mask = rob_size - 1;
+	}
+
+	q->initialized = 1;
+	return 0;
+
+nomem:
+	SW_LOG_ERR("cannot allocate queue %u", queue_id);
+	sw_queue_release(dev, queue_id);
+	return -ENOMEM;
+}
+
+static void
+sw_port_def_conf(struct rte_eventdev *dev, uint8_t port_id,
+		struct rte_event_port_conf *conf)
+{
+	const struct rte_event_dev_config *dev_conf = &dev->data->dev_conf;
+
+	RTE_SET_USED(port_id);
+
+	conf->new_event_threshold = RTE_MIN(dev_conf->nb_events_limit,
+			SW_PORT_DEFAULT_THRESHOLD);
+	conf->dequeue_depth = RTE_MIN(dev_conf->nb_event_port_dequeue_depth,
+			(uint32_t)SW_DEQ_DEPTH_DEFAULT);
+	conf->enqueue_depth = RTE_MIN(dev_conf->nb_event_port_enqueue_depth,
+			(uint32_t)SW_ENQ_DEPTH_DEFAULT);
+}
+
+static void
+sw_port_unlink_all(struct sw_evdev *sw, uint8_t port_id)
+{
+	uint32_t i, j;
+
+	for (i = 0; i < RTE_EVENT_MAX_QUEUES_PER_DEV; i++) {
+		struct sw_qid *q = &sw->qids[i];
+
+		for (j = 0; j < q->cq_num_mapped_cqs; j++) {
+			if (q->cq_map[j] != port_id)
+				continue;
+			memmove(&q->cq_map[j], &q->cq_map[j + 1],
+					q->cq_num_mapped_cqs - j - 1);
+			q->cq_num_mapped_cqs--;
+			q->cq_next_tx = 0;
+			break;
+		}
+	}
+}
+
+static void
+sw_port_release(void *port)
+{
+	struct sw_port *p = port;
+
+	if (p == NULL)
+		return;
+
+	sw_port_unlink_all(p->sw, p->id);
+	p->sw->ports[p->id] = NULL;
+	sw_event_ring_free(p->rx_worker_ring);
+	sw_event_ring_free(p->cq_worker_ring);
+	rte_free(p);
+}
+
+static int
+sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
+		const struct rte_event_port_conf *conf)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	struct sw_port *p;
+
+	p = rte_zmalloc_socket("sw_evdev port", sizeof(*p),
+			RTE_CACHE_LINE_SIZE, sw->socket_id);
+	if (p == NULL)
+		goto nomem;
+
+	p->sw = sw;
+	p->id = port_id;
+	p->new_event_threshold = conf->new_event_threshold;
+	p->dequeue_depth = conf->dequeue_depth;
+	p->enqueue_depth = conf->enqueue_depth;
+
+	/* the RX ring also takes the implicit releases of a dequeue */
+	p->rx_worker_ring = sw_event_ring_create("sw_evdev rx ring",
+			conf->enqueue_depth + conf->dequeue_depth,
+			sw->socket_id);
+	p->cq_worker_ring = sw_event_ring_create("sw_evdev cq ring",
+			conf->dequeue_depth, sw->socket_id);
+	if (p->rx_worker_ring == NULL || p->cq_worker_ring == NULL)
+		goto nomem;
+
+	sw->ports[port_id] = p;
+	dev->data->ports[port_id] = p;
+	return 0;
+
+nomem:
+	SW_LOG_ERR("cannot allocate port %u", port_id);
+	if (p != NULL) {
+		sw_event_ring_free(p->rx_worker_ring);
+		sw_event_ring_free(p->cq_worker_ring);
+		rte_free(p);
+	}
+	return -ENOMEM;
+}
+
+static int
+sw_port_link(struct rte_eventdev *dev, void *port, const uint8_t queues[],
+		const uint8_t priorities[], uint16_t nb_links)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	struct sw_port *p = port;
+	uint16_t i;
+	uint32_t j;
+
+	/* link priorities are not supported, only queue priorities */
+	RTE_SET_USED(priorities);
+
+	for (i = 0; i < nb_links; i++) {
+		struct sw_qid *q = &sw->qids[queues[i]];
+
+		if (!q->initialized) {
+			rte_errno = EINVAL;
+			break;
+		}
+
+		for (j = 0; j < q->cq_num_mapped_cqs; j++)
+			if (q->cq_map[j] == p->id)
+				break;
+		if (j < q->cq_num_mapped_cqs)
+			continue;
+
+		if (q->single_link && q->cq_num_mapped_cqs != 0) {
+			rte_errno = EDQUOT;
+			break;
+		}
+
+		q->cq_map[q->cq_num_mapped_cqs++] = p->id;
+	}
+
+	return i;
+}
+
+static int
+sw_port_unlink(struct rte_eventdev *dev, void *port, uint8_t queues[],
+		uint16_t nb_unlinks)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	struct sw_port *p = port;
+	uint16_t i;
+	uint32_t j;
+
+	for (i = 0; i < nb_unlinks; i++) {
+		struct sw_qid *q = &sw->qids[queues[i]];
+
+		for (j = 0; j < q->cq_num_mapped_cqs; j++) {
+			if (q->cq_map[j] != p->id)
+				continue;
+			memmove(&q->cq_map[j], &q->cq_map[j + 1],
+					q->cq_num_mapped_cqs - j - 1);
+			q->cq_num_mapped_cqs--;
+			q->cq_next_tx = 0;
+			break;
+		}
+	}
+
+	return nb_unlinks;
+}
+
+static int
+sw_dev_start(struct rte_eventdev *dev)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	uint32_t i, j;
+
+	for (i = 0; i < sw->nb_qids; i++)
+		if (!sw->qids[i].initialized) {
+			SW_LOG_ERR("queue %u not set up", i);
+			return -EINVAL;
+		}
+
+	/* drop the events of a previous run */
+	rte_atomic32_set(&sw->inflights, 0);
+	for (i = 0; i < sw->nb_ports; i++) {
+		struct sw_port *p = sw->ports[i];
+
+		sw_event_ring_reset(p->rx_worker_ring);
+		sw_event_ring_reset(p->cq_worker_ring);
+		p->outstanding_releases = 0;
+		p->hist_head = 0;
+		p->hist_tail = 0;
+		p->cq_buf_count = 0;
+	}
+	for (i = 0; i < sw->nb_qids; i++) {
+		struct sw_qid *q = &sw->qids[i];
+
+		q->iq_head = 0;
+		q->iq_tail = 0;
+		q->cq_next_tx = 0;
+		if (q->fids != NULL)
+			for (j = 0; j < SW_QID_NUM_FIDS; j++) {
+				q->fids[j].port = -1;
+				q->fids[j].pcount = 0;
+			}
+		if (q->rob != NULL)
+			memset(q->rob, 0,
+				(q->rob_mask + 1) * sizeof(q->rob[0]));
+		q->rob_head = 0;
+		q->rob_tail = 0;
+	}
+
+	/* the scheduler serves the queues by decreasing priority */
+	for (i = 0; i < sw->nb_qids; i++) {
+		struct sw_qid *q = &sw->qids[i];
+
+		for (j = i; j > 0 && sw->qids_prio[j - 1]->priority >
+				q->priority; j--)
+			sw->qids_prio[j] = sw->qids_prio[j - 1];
+		sw->qids_prio[j] = q;
+	}
+
+	rte_smp_wmb();
+	sw->started = 1;
+	return 0;
+}
+
+static void
+sw_dev_stop(struct rte_eventdev *dev)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+
+	sw->started = 0;
+	rte_smp_wmb();
+}
+
+static int
+sw_dev_close(struct rte_eventdev *dev)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+
+	/* the library released the queues and ports */
+	sw->nb_qids = 0;
+	sw->nb_ports = 0;
+	return 0;
+}
+
+static int
+sw_timeout_ticks(struct rte_eventdev *dev, uint64_t ns,
+		uint64_t *timeout_ticks)
+{
+	RTE_SET_USED(dev);
+
+	*timeout_ticks = sw_ns_to_ticks(ns);
+	return 0;
+}
+
+static void
+sw_dump(struct rte_eventdev *dev, FILE *f)
+{
+	static const char * const type_str[] = {
+		"ordered", "atomic", "parallel", "all types"
+	};
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	uint32_t i, j;
+
+	fprintf(f, "EventDev %s: started %d, inflights %d\n",
+			dev->data->name, sw->started,
+			rte_atomic32_read(&sw->inflights));
+	fprintf(f, "  sched calls %" PRIu64 ", no work %" PRIu64
+			", invalid events %" PRIu64 "\n",
+			sw->sched_calls, sw->sched_no_work, sw->stats_invalid);
+
+	for (i = 0; i < sw->nb_ports; i++) {
+		const struct sw_port *p = sw->ports[i];
+
+		if (p == NULL)
+			continue;
+		fprintf(f, "  Port %u: rx %" PRIu64 " tx %" PRIu64
+				" sched %" PRIu64 " new refused %" PRIu64
+				" inflights %u/%u\n",
+				i, p->stats_rx, p->stats_tx, p->stats_sched,
+				p->stats_new_refused, sw_port_inflights(p),
+				p->dequeue_depth);
+	}
+
+	for (i = 0; i < sw->nb_qids; i++) {
+		const struct sw_qid *q = &sw->qids[i];
+
+		if (!q->initialized)
+			continue;
+		fprintf(f, "  Queue %u (%s%s, prio %u): rx %" PRIu64
+				" tx %" PRIu64 " waiting %u, ports",
+				i, type_str[q->type],
+				q->single_link ? ", single link" : "",
+				q->priority, q->stats_rx, q->stats_tx,
+				q->iq_tail - q->iq_head);
+		for (j = 0; j < q->cq_num_mapped_cqs; j++)
+			fprintf(f, " %u", q->cq_map[j]);
+		fprintf(f, "\n");
+	}
+}
+
+static const struct rte_eventdev_ops evdev_sw_ops = {
+	.dev_infos_get = sw_info_get,
+	.dev_configure = sw_dev_configure,
+	.dev_start = sw_dev_start,
+	.dev_stop = sw_dev_stop,
+	.dev_close = sw_dev_close,
+
+	.queue_def_conf = sw_queue_def_conf,
+	.queue_setup = sw_queue_setup,
+	.queue_release = sw_queue_release,
+
+	.port_def_conf = sw_port_def_conf,
+	.port_setup = sw_port_setup,
+	.port_release = sw_port_release,
+
+	.port_link = sw_port_link,
+	.port_unlink = sw_port_unlink,
+	.timeout_ticks = sw_timeout_ticks,
+	.dump = sw_dump,
+};
+
+static int
+sw_get_socket_id_arg(const char *key __rte_unused, const char *value,
+		void *extra_args)
+{
+	int *socket_id = extra_args;
+	char *end;
+	long v;
+
+	if (value == NULL || extra_args == NULL)
+		return -EINVAL;
+
+	v = strtol(value, &end, 10);
+	if (*end != '\0' || v < 0 || v >= RTE_MAX_NUMA_NODES)
+		return -EINVAL;
+
+	*socket_id = v;
+	return 0;
+}
+
+static int
+sw_probe(const char *name, const char *params)
+{
+	struct rte_eventdev *dev;
+	struct sw_evdev *sw;
+	struct rte_kvargs *kvlist;
+	int socket_id = rte_socket_id();
+	int ret;
+
+	if (params != NULL && params[0] != '\0') {
+		kvlist = rte_kvargs_parse(params, sw_valid_args);
+		if (kvlist == NULL) {
+			SW_LOG_ERR("invalid parameters %s", params);
+			return -EINVAL;
+		}
+
+		ret = rte_kvargs_process(kvlist, SW_SOCKET_ID_ARG,
+				sw_get_socket_id_arg, &socket_id);
+		rte_kvargs_free(kvlist);
+		if (ret < 0) {
+			SW_LOG_ERR("invalid %s in %s", SW_SOCKET_ID_ARG,
+					params);
+			return -EINVAL;
+		}
+	}
+
+	SW_LOG_INFO("creating %s on socket %d", name, socket_id);
+
+	dev = rte_event_pmd_vdev_init(name, sizeof(struct sw_evdev),
+			socket_id);
+	if (dev == NULL) {
+		SW_LOG_ERR("cannot create event device %s", name);
+		return -EFAULT;
+	}
+
+	dev->dev_ops = &evdev_sw_ops;
+	dev->enqueue_burst = sw_event_enqueue_burst;
+	dev->dequeue_burst = sw_event_dequeue_burst;
+	dev->schedule = sw_event_schedule;
+	dev->data->event_dev_cap = RTE_EVENT_DEV_CAP_QUEUE_QOS;
+
+	sw = sw_pmd_priv(dev);
+	sw->socket_id = socket_id;
+	return 0;
+}
+
+static int
+sw_remove(const char *name)
+{
+	if (name == NULL)
+		return -EINVAL;
+
+	SW_LOG_INFO("closing %s", name);
+	return rte_event_pmd_vdev_uninit(name);
+}
+
+static struct rte_driver evdev_sw_pmd_drv = {
+	.type = PMD_VDEV,
+	.init = sw_probe,
+	.uninit = sw_remove
+};
+
+PMD_REGISTER_DRIVER(evdev_sw_pmd_drv, SW_PMD_NAME);
+DRIVER_REGISTER_PARAM_STRING(SW_PMD_NAME, "socket_id=<int>");
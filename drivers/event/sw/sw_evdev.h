@@ -0,0 +1,188 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _SW_EVDEV_H_
+#define _SW_EVDEV_H_
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_atomic.h>
+#include <rte_log.h>
+#include <rte_eventdev.h>
+#include <rte_eventdev_pmd.h>
+
+#include "event_ring.h"
+
+#define SW_PMD_NAME event_sw
+#define SW_PMD_NAME_STR RTE_STR(SW_PMD_NAME)
+
+#define SW_PORTS_MAX 64
+#define SW_QID_NUM_FIDS 16384          /* atomic flows per queue */
+#define SW_INFLIGHT_EVENTS_TOTAL 4096  /* events in flight per device */
+#define SW_DEQ_DEPTH_MAX 128           /* events scheduled to a port */
+#define SW_ENQ_DEPTH_MAX 4096
+#define SW_DEQ_DEPTH_DEFAULT 16
+#define SW_ENQ_DEPTH_DEFAULT 16
+#define SW_SCHED_PORT_BURST 32  /* events pulled from a port per pass */
+#define SW_SCHED_QID_BURST 64   /* events scheduled from a queue per pass */
+
+/* Type of a queue which accepts all schedule types */
+#define SW_SCHED_TYPE_ALL 3
+
+#define SW_LOG_ERR(fmt, args...)					\
+	RTE_LOG(ERR, EVENTDEV, "[%s] %s() line %u: " fmt "\n",		\
+			SW_PMD_NAME_STR, __func__, __LINE__, ## args)
+
+#define SW_LOG_INFO(fmt, args...)					\
+	RTE_LOG(INFO, EVENTDEV, "[%s] " fmt "\n",			\
+			SW_PMD_NAME_STR, ## args)
+
+/* Schedule of an event to a port, released by its FORWARD or RELEASE. */
+struct sw_hist_entry {
+	uint8_t qid;
+	uint8_t type;     /* RTE_SCHED_TYPE_ of the scheduled event */
+	uint16_t rsvd;
+	uint32_t fid_seq; /* atomic flow, or order sequence */
+};
+
+/* Port of an atomic flow and its events scheduled but not completed */
+struct sw_fid {
+	int16_t port;     /* -1 when the flow is not pinned */
+	uint16_t pcount;
+};
+
+/* Reorder buffer slot of an ordered event */
+struct sw_rob_entry {
+	struct rte_event ev;  /* forwarded event */
+	uint8_t ready;        /* forwarded or released */
+	uint8_t forward;      /* ev is to be enqueued to its next queue */
+};
+
+struct sw_qid {
+	uint8_t id;
+	uint8_t priority;
+	uint8_t type;             /* RTE_SCHED_TYPE_, or SW_SCHED_TYPE_ALL */
+	uint8_t single_link;
+	uint8_t initialized;
+
+	/* waiting events, a circular buffer which can push back at its head */
+	struct rte_event *iq;
+	uint32_t iq_mask;
+	uint32_t iq_head;
+	uint32_t iq_tail;
+
+	/* atomic flows */
+	struct sw_fid *fids;
+
+	/* reorder buffer of the ordered events */
+	struct sw_rob_entry *rob;
+	uint32_t rob_mask;
+	uint32_t rob_head;        /* oldest sequence not yet drained */
+	uint32_t rob_tail;        /* next sequence to allocate */
+
+	/* linked ports */
+	uint8_t cq_map[SW_PORTS_MAX];
+	uint32_t cq_num_mapped_cqs;
+	uint32_t cq_next_tx;
+
+	uint64_t stats_rx;
+	uint64_t stats_tx;
+};
+
+struct sw_evdev;
+
+struct sw_port {
+	/* used by the worker lcore */
+	struct sw_evdev *sw;
+	uint8_t id;
+	int32_t new_event_threshold;
+	uint16_t dequeue_depth;
+	uint16_t enqueue_depth;
+	uint16_t outstanding_releases;
+	struct sw_event_ring *rx_worker_ring; /* worker to scheduler */
+	struct sw_event_ring *cq_worker_ring; /* scheduler to worker */
+	uint64_t stats_rx;
+	uint64_t stats_tx;
+	uint64_t stats_new_refused;
+
+	/* used by the scheduler lcore */
+	uint32_t hist_head __rte_cache_aligned;
+	uint32_t hist_tail;
+	uint16_t cq_buf_count;
+	uint64_t stats_sched;
+	struct sw_hist_entry hist_list[SW_DEQ_DEPTH_MAX];
+	struct rte_event cq_buf[SW_DEQ_DEPTH_MAX];
+} __rte_cache_aligned;
+
+struct sw_evdev {
+	int socket_id;
+	uint8_t started;
+	uint8_t per_deq_timeout;
+	uint64_t deq_timeout_ticks;
+	int32_t nb_events_limit;
+
+	uint8_t nb_qids;
+	uint8_t nb_ports;
+	struct sw_qid qids[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	struct sw_port *ports[SW_PORTS_MAX];
+	/* queues by decreasing priority, for the scheduler */
+	struct sw_qid *qids_prio[RTE_EVENT_MAX_QUEUES_PER_DEV];
+
+	/* events in flight, shared by the ports */
+	rte_atomic32_t inflights __rte_cache_aligned;
+
+	uint64_t sched_calls __rte_cache_aligned;
+	uint64_t sched_no_work;
+	uint64_t stats_invalid;
+};
+
+static inline struct sw_evdev *
+sw_pmd_priv(const struct rte_eventdev *dev)
+{
+	return dev->data->dev_private;
+}
+
+/* Number of events scheduled to a port and not yet completed */
+static inline uint32_t
+sw_port_inflights(const struct sw_port *p)
+{
+	return p->hist_head - p->hist_tail;
+}
+
+uint16_t sw_event_enqueue_burst(void *port, const struct rte_event ev[],
+		uint16_t num);
+uint16_t sw_event_dequeue_burst(void *port, struct rte_event ev[],
+		uint16_t num, uint64_t timeout_ticks);
+void sw_event_schedule(struct rte_eventdev *dev);
+
+#endif /* _SW_EVDEV_H_ */
@@ -0,0 +1,353 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+
+#include "sw_evdev.h"
+
+#define SW_HIST_MASK (SW_DEQ_DEPTH_MAX - 1)
+
+static inline uint32_t
+iq_count(const struct sw_qid *q)
+{
+	return q->iq_tail - q->iq_head;
+}
+
+static inline void
+iq_push(struct sw_qid *q, const struct rte_event *ev)
+{
+	q->iq[q->iq_tail++ & q->iq_mask] = *ev;
+}
+
+static inline void
+iq_push_front(struct sw_qid *q, const struct rte_event *ev)
+{
+	q->iq[--q->iq_head & q->iq_mask] = *ev;
+}
+
+static inline void
+iq_pop(struct sw_qid *q, struct rte_event *ev)
+{
+	*ev = q->iq[q->iq_head++ & q->iq_mask];
+}
+
+static inline int
+sw_port_has_space(const struct sw_port *p)
+{
+	return sw_port_inflights(p) < p->dequeue_depth;
+}
+
+/* Enqueue an event to the queue it targets. The IQ of a queue holds as many
+ * events as the device has in flight, so it cannot overflow.
+ */
+static inline void
+sw_qid_enqueue(struct sw_evdev *sw, const struct rte_event *ev)
+{
+	struct sw_qid *q;
+
+	if (unlikely(ev->queue_id >= sw->nb_qids)) {
+		sw->stats_invalid++;
+		rte_atomic32_dec(&sw->inflights);
+		return;
+	}
+
+	q = &sw->qids[ev->queue_id];
+	iq_push(q, ev);
+	q->stats_rx++;
+}
+
+static inline void
+sw_schedule_to_port(struct sw_port *p, struct sw_qid *q,
+		struct rte_event *ev, uint8_t type, uint32_t fid_seq)
+{
+	struct sw_hist_entry *h = &p->hist_list[p->hist_head++ & SW_HIST_MASK];
+
+	h->qid = q->id;
+	h->type = type;
+	h->fid_seq = fid_seq;
+
+	ev->sched_type = type;
+	p->cq_buf[p->cq_buf_count++] = *ev;
+	p->stats_sched++;
+	q->stats_tx++;
+}
+
+/* Next linked port with room, round robin. */
+static inline struct sw_port *
+sw_qid_next_port(struct sw_evdev *sw, struct sw_qid *q)
+{
+	uint32_t i;
+
+	for (i = 0; i < q->cq_num_mapped_cqs; i++) {
+		struct sw_port *p;
+
+		if (q->cq_next_tx >= q->cq_num_mapped_cqs)
+			q->cq_next_tx = 0;
+		p = sw->ports[q->cq_map[q->cq_next_tx++]];
+		if (sw_port_has_space(p))
+			return p;
+	}
+	return NULL;
+}
+
+static inline int
+sw_schedule_atomic(struct sw_evdev *sw, struct sw_qid *q,
+		struct rte_event *ev)
+{
+	const uint32_t fid_id = ev->flow_id & (SW_QID_NUM_FIDS - 1);
+	struct sw_fid *fid = &q->fids[fid_id];
+	struct sw_port *p;
+
+	if (fid->port < 0) {
+		/* pin the flow to the least loaded linked port */
+		struct sw_port *best = NULL;
+		uint32_t i;
+
+		for (i = 0; i < q->cq_num_mapped_cqs; i++) {
+			p = sw->ports[q->cq_map[i]];
+			if (sw_port_has_space(p) && (best == NULL ||
+					sw_port_inflights(p) <
+					sw_port_inflights(best)))
+				best = p;
+		}
+		if (best == NULL)
+			return 0;
+		p = best;
+		fid->port = p->id;
+	} else {
+		/* the flow stays on its port until its events complete */
+		p = sw->ports[fid->port];
+		if (!sw_port_has_space(p))
+			return 0;
+	}
+
+	fid->pcount++;
+	sw_schedule_to_port(p, q, ev, RTE_SCHED_TYPE_ATOMIC, fid_id);
+	return 1;
+}
+
+static inline int
+sw_schedule_ordered(struct sw_evdev *sw, struct sw_qid *q,
+		struct rte_event *ev)
+{
+	struct sw_port *p;
+
+	if (q->rob_tail - q->rob_head > q->rob_mask)
+		return 0;
+
+	p = sw_qid_next_port(sw, q);
+	if (p == NULL)
+		return 0;
+
+	sw_schedule_to_port(p, q, ev, RTE_SCHED_TYPE_ORDERED, q->rob_tail++);
+	return 1;
+}
+
+static inline int
+sw_schedule_parallel(struct sw_evdev *sw, struct sw_qid *q,
+		struct rte_event *ev)
+{
+	struct sw_port *p = sw_qid_next_port(sw, q);
+
+	if (p == NULL)
+		return 0;
+
+	sw_schedule_to_port(p, q, ev, RTE_SCHED_TYPE_PARALLEL, 0);
+	return 1;
+}
+
+/* Schedule a burst of the waiting events of a queue. The events which do
+ * not fit go back to the head of the IQ: an atomic event waits for the port
+ * of its flow, and once an ordered event waits, the next ones of the burst
+ * wait too so that their sequences follow the order of the queue.
+ */
+static inline uint32_t
+sw_schedule_qid(struct sw_evdev *sw, struct sw_qid *q)
+{
+	struct rte_event blocked[SW_SCHED_QID_BURST];
+	uint32_t i, n, nb_blocked = 0;
+	int ordered_blocked = 0;
+
+	n = RTE_MIN(iq_count(q), (uint32_t)SW_SCHED_QID_BURST);
+	if (n == 0 || q->cq_num_mapped_cqs == 0)
+		return 0;
+
+	for (i = 0; i < n; i++) {
+		struct rte_event ev;
+		uint8_t type;
+		int done;
+
+		iq_pop(q, &ev);
+		type = q->type == SW_SCHED_TYPE_ALL ? ev.sched_type : q->type;
+
+		switch (type) {
+		case RTE_SCHED_TYPE_ATOMIC:
+			done = sw_schedule_atomic(sw, q, &ev);
+			break;
+		case RTE_SCHED_TYPE_ORDERED:
+			done = !ordered_blocked &&
+				sw_schedule_ordered(sw, q, &ev);
+			ordered_blocked = !done;
+			break;
+		default:
+			done = sw_schedule_parallel(sw, q, &ev);
+			break;
+		}
+
+		if (!done)
+			blocked[nb_blocked++] = ev;
+	}
+
+	while (nb_blocked != 0)
+		iq_push_front(q, &blocked[--nb_blocked]);
+
+	return n - nb_blocked;
+}
+
+/* Forward or release the oldest event scheduled to a port. */
+static inline void
+sw_port_complete(struct sw_evdev *sw, struct sw_port *p,
+		const struct rte_event *ev)
+{
+	struct sw_hist_entry *h;
+	struct sw_qid *q;
+
+	if (unlikely(p->hist_head == p->hist_tail)) {
+		/* nothing was scheduled to the port, drop the event */
+		sw->stats_invalid++;
+		return;
+	}
+
+	h = &p->hist_list[p->hist_tail++ & SW_HIST_MASK];
+	q = &sw->qids[h->qid];
+
+	switch (h->type) {
+	case RTE_SCHED_TYPE_ATOMIC: {
+		struct sw_fid *fid = &q->fids[h->fid_seq];
+
+		if (--fid->pcount == 0)
+			fid->port = -1;
+		break;
+	}
+	case RTE_SCHED_TYPE_ORDERED: {
+		struct sw_rob_entry *e = &q->rob[h->fid_seq & q->rob_mask];
+
+		/* the reorder buffer releases the event in order */
+		e->ready = 1;
+		if (ev->op == RTE_EVENT_OP_FORWARD) {
+			e->ev = *ev;
+			e->forward = 1;
+		} else {
+			e->forward = 0;
+			rte_atomic32_dec(&sw->inflights);
+		}
+		return;
+	}
+	default:
+		break;
+	}
+
+	if (ev->op == RTE_EVENT_OP_FORWARD)
+		sw_qid_enqueue(sw, ev);
+	else
+		rte_atomic32_dec(&sw->inflights);
+}
+
+static inline uint32_t
+sw_schedule_pull_port(struct sw_evdev *sw, struct sw_port *p)
+{
+	struct rte_event ev[SW_SCHED_PORT_BURST];
+	uint16_t i, n;
+
+	n = sw_event_ring_dequeue_burst(p->rx_worker_ring, ev,
+			SW_SCHED_PORT_BURST);
+	for (i = 0; i < n; i++) {
+		if (ev[i].op == RTE_EVENT_OP_NEW)
+			sw_qid_enqueue(sw, &ev[i]);
+		else
+			sw_port_complete(sw, p, &ev[i]);
+	}
+	return n;
+}
+
+static inline void
+sw_rob_drain(struct sw_evdev *sw, struct sw_qid *q)
+{
+	while (q->rob_head != q->rob_tail) {
+		struct sw_rob_entry *e = &q->rob[q->rob_head & q->rob_mask];
+
+		if (!e->ready)
+			break;
+		if (e->forward)
+			sw_qid_enqueue(sw, &e->ev);
+		e->ready = 0;
+		e->forward = 0;
+		q->rob_head++;
+	}
+}
+
+void
+sw_event_schedule(struct rte_eventdev *dev)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	uint32_t i, work = 0;
+
+	if (unlikely(!sw->started))
+		return;
+
+	sw->sched_calls++;
+
+	for (i = 0; i < sw->nb_ports; i++)
+		work += sw_schedule_pull_port(sw, sw->ports[i]);
+
+	for (i = 0; i < sw->nb_qids; i++)
+		if (sw->qids[i].rob != NULL)
+			sw_rob_drain(sw, &sw->qids[i]);
+
+	for (i = 0; i < sw->nb_qids; i++)
+		work += sw_schedule_qid(sw, sw->qids_prio[i]);
+
+	for (i = 0; i < sw->nb_ports; i++) {
+		struct sw_port *p = sw->ports[i];
+
+		/* the CQ ring holds the dequeue depth of the port */
+		if (p->cq_buf_count != 0) {
+			sw_event_ring_enqueue_burst(p->cq_worker_ring,
+					p->cq_buf, p->cq_buf_count);
+			p->cq_buf_count = 0;
+		}
+	}
+
+	if (work == 0)
+		sw->sched_no_work++;
+}
@@ -0,0 +1,152 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+
+#include "sw_evdev.h"
+
+/* Reserve device inflight credits for up to n new events. */
+static inline int32_t
+sw_inflights_reserve(struct sw_port *p, int32_t n)
+{
+	struct sw_evdev *sw = p->sw;
+	int32_t cur, avail;
+
+	do {
+		cur = rte_atomic32_read(&sw->inflights);
+		avail = p->new_event_threshold - cur;
+		if (avail <= 0)
+			return 0;
+		if (n > avail)
+			n = avail;
+	} while (rte_atomic32_cmpset((volatile uint32_t *)&sw->inflights.cnt,
+				cur, cur + n) == 0);
+
+	return n;
+}
+
+uint16_t
+sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
+{
+	struct sw_port *p = port;
+	uint16_t i, n, enq, nb_completions = 0;
+	int32_t nb_new = 0, credits = 0;
+
+	n = RTE_MIN(num, p->enqueue_depth);
+	for (i = 0; i < n; i++)
+		nb_new += ev[i].op == RTE_EVENT_OP_NEW;
+
+	if (nb_new != 0) {
+		credits = sw_inflights_reserve(p, nb_new);
+		if (credits < nb_new) {
+			int32_t seen = 0;
+
+			/* truncate the burst at the first refused event */
+			for (i = 0; i < n; i++)
+				if (ev[i].op == RTE_EVENT_OP_NEW &&
+						seen++ == credits)
+					break;
+			n = i;
+			p->stats_new_refused++;
+		}
+	}
+
+	enq = sw_event_ring_enqueue_burst(p->rx_worker_ring, ev, n);
+
+	nb_new = 0;
+	for (i = 0; i < enq; i++) {
+		if (ev[i].op == RTE_EVENT_OP_NEW)
+			nb_new++;
+		else
+			nb_completions++;
+	}
+	/* give back the credits of the new events left out by the ring */
+	if (credits > nb_new)
+		rte_atomic32_sub(&p->sw->inflights, credits - nb_new);
+
+	p->outstanding_releases -= RTE_MIN(nb_completions,
+			p->outstanding_releases);
+	p->stats_rx += enq;
+
+	if (enq < num)
+		rte_errno = ENOSPC;
+	return enq;
+}
+
+uint16_t
+sw_event_dequeue_burst(void *port, struct rte_event ev[], uint16_t num,
+		uint64_t timeout_ticks)
+{
+	struct sw_port *p = port;
+	struct sw_evdev *sw = p->sw;
+	uint16_t n;
+
+	/* release the events of the previous burst not completed */
+	if (p->outstanding_releases != 0) {
+		struct rte_event rel[SW_DEQ_DEPTH_MAX];
+		uint16_t i, nb_rel = p->outstanding_releases;
+
+		for (i = 0; i < nb_rel; i++) {
+			rel[i].event = 0;
+			rel[i].op = RTE_EVENT_OP_RELEASE;
+			rel[i].u64 = 0;
+		}
+		nb_rel = sw_event_ring_enqueue_burst(p->rx_worker_ring, rel,
+				nb_rel);
+		p->outstanding_releases -= nb_rel;
+		if (p->outstanding_releases != 0)
+			return 0;
+	}
+
+	if (num > p->dequeue_depth)
+		num = p->dequeue_depth;
+	if (!sw->per_deq_timeout)
+		timeout_ticks = sw->deq_timeout_ticks;
+
+	n = sw_event_ring_dequeue_burst(p->cq_worker_ring, ev, num);
+	if (n == 0 && timeout_ticks != 0) {
+		const uint64_t start = rte_get_timer_cycles();
+
+		do {
+			rte_pause();
+			n = sw_event_ring_dequeue_burst(p->cq_worker_ring,
+					ev, num);
+		} while (n == 0 &&
+				rte_get_timer_cycles() - start < timeout_ticks);
+	}
+
+	p->outstanding_releases = n;
+	p->stats_tx += n;
+	return n;
+}
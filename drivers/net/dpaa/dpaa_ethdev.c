@@ -515,6 +515,7 @@ static int dpaa_eth_dev_start(struct rte_eth_dev *dev)
 
 	/* Change tx callback to the real one */
 	dev->tx_pkt_burst = dpaa_eth_queue_tx;
+	dev->tx_pkt_prepare = dpaa_eth_tx_prepare;
 
 	fman_if_enable_rx(dpaa_intf->fif);
 	return 0;
@@ -561,6 +562,8 @@ static void dpaa_eth_dev_info(struct rte_eth_dev *dev,
 		(DEV_TX_OFFLOAD_IPV4_CKSUM  |
 		DEV_TX_OFFLOAD_UDP_CKSUM   |
 		DEV_TX_OFFLOAD_TCP_CKSUM);
+	dev_info->tx_desc_lim.nb_seg_max = DPA_SGT_MAX_ENTRIES;
+	dev_info->tx_desc_lim.nb_mtu_seg_max = DPA_SGT_MAX_ENTRIES;
 }
 
 static int dpaa_eth_link_update(struct rte_eth_dev *dev,
@@ -58,6 +58,7 @@
 #include <rte_atomic.h>
 #include <rte_malloc.h>
 #include <rte_ring.h>
+#include <rte_errno.h>
 
 #include "dpaa_ethdev.h"
 #include "dpaa_rxtx.h"
@@ -391,18 +392,48 @@ out:
 	return (void *)buf;
 }
 
+/* External buffers are not BMAN buffers, they must not be freed by HW */
+static inline int dpaa_mbuf_has_extbuf(struct rte_mbuf *mbuf)
+{
+	struct rte_mbuf *seg = mbuf;
+	uint8_t i;
+
+	for (i = 0; i < mbuf->nb_segs; i++, seg = seg->next)
+		if (RTE_MBUF_HAS_EXTBUF(seg))
+			return 1;
+	return 0;
+}
+
+/* Frames copied for TX are gathered in a single buffer of the port pool */
+static inline int dpaa_tx_copy_fits(struct rte_mbuf *mbuf,
+				    struct dpaa_if *dpaa_intf)
+{
+	return mbuf->data_off + mbuf->pkt_len <=
+		rte_pktmbuf_data_room_size(dpaa_intf->bp_info->mp);
+}
+
 static struct rte_mbuf *dpaa_get_dmable_mbuf(struct rte_mbuf *mbuf,
 					     struct dpaa_if *dpaa_intf)
 {
-	struct rte_mbuf *dpaa_mbuf;
+	struct rte_mbuf *dpaa_mbuf, *seg;
+	uint8_t *dst;
+
+	if (!dpaa_tx_copy_fits(mbuf, dpaa_intf)) {
+		PMD_TX_LOG(DEBUG, "frame too large for a dpaa buffer");
+		return NULL;
+	}
 
 	/* allocate pktbuffer on bpid for dpaa port */
 	dpaa_mbuf = dpaa_get_pktbuf(dpaa_intf->bp_info);
 	if (!dpaa_mbuf)
 		return NULL;
 
-	memcpy((uint8_t *)(dpaa_mbuf->buf_addr) + mbuf->data_off, (void *)
-		((uint8_t *)(mbuf->buf_addr) + mbuf->data_off), mbuf->pkt_len);
+	/* gather all the segments, e.g. from external buffers */
+	dst = (uint8_t *)(dpaa_mbuf->buf_addr) + mbuf->data_off;
+	for (seg = mbuf; seg != NULL; seg = seg->next) {
+		memcpy(dst, rte_pktmbuf_mtod(seg, void *), seg->data_len);
+		dst += seg->data_len;
+	}
 
 	/* Copy only the required fields */
 	dpaa_mbuf->data_off = mbuf->data_off;
@@ -506,7 +537,8 @@ uint16_t dpaa_eth_queue_tx(void *q,
 
 			mbuf = bufs[i];
 			mp = mbuf->pool;
-			if (mp && (mp->flags & MEMPOOL_F_HW_PKT_POOL)) {
+			if (mp && (mp->flags & MEMPOOL_F_HW_PKT_POOL) &&
+			    !dpaa_mbuf_has_extbuf(mbuf)) {
 				PMD_TX_LOG(DEBUG, "BMAN offloaded buffer, "
 					"mbuf: %p", mbuf);
 				bp_info = DPAA_MEMPOOL_TO_POOL_INFO(mp);
@@ -538,7 +570,8 @@ uint16_t dpaa_eth_queue_tx(void *q,
 					"Allocating an offloaded buffer");
 				mbuf = dpaa_get_dmable_mbuf(mbuf, dpaa_intf);
 				if (!mbuf) {
-					PMD_DRV_LOG(DEBUG, "no dpaa buffers.");
+					PMD_DRV_LOG(DEBUG, "cannot copy into a "
+						    "dpaa buffer.");
 					/* Set frames_to_send & nb_bufs so that
 					 * packets are transmitted till
 					 * previous frame */
@@ -569,6 +602,71 @@ send_pkts:
 	return i;
 }
 
+uint16_t dpaa_eth_tx_prepare(void *q,
+			     struct rte_mbuf **bufs,
+		uint16_t nb_bufs)
+{
+	struct dpaa_if *dpaa_intf = ((struct qman_fq *)q)->dpaa_intf;
+	struct rte_mbuf *mbuf;
+	struct rte_mempool *mp;
+	uint64_t l4;
+	uint16_t i;
+
+	for (i = 0; i < nb_bufs; i++) {
+		mbuf = bufs[i];
+		mp = mbuf->pool;
+
+		/* Buffers from other pools and external buffers are gathered
+		 * into a single buffer of the port pool, other chains are
+		 * sent with a scatter gather table.
+		 */
+		if (!(mp && (mp->flags & MEMPOOL_F_HW_PKT_POOL)) ||
+		    dpaa_mbuf_has_extbuf(mbuf)) {
+			if (!dpaa_tx_copy_fits(mbuf, dpaa_intf)) {
+				rte_errno = EINVAL;
+				return i;
+			}
+		} else if (mbuf->nb_segs > DPA_SGT_MAX_ENTRIES) {
+			rte_errno = EINVAL;
+			return i;
+		}
+
+		if (!(mbuf->ol_flags & DPAA_TX_CKSUM_OFFLOAD_MASK))
+			continue;
+
+		l4 = mbuf->ol_flags & PKT_TX_L4_MASK;
+		if ((mbuf->ol_flags & (PKT_TX_OFFLOAD_MASK ^
+				       (PKT_TX_IP_CKSUM | PKT_TX_L4_MASK))) ||
+		    l4 == PKT_TX_SCTP_CKSUM) {
+			rte_errno = ENOTSUP;
+			return i;
+		}
+
+		/* The parse results are written in the buffer headroom */
+		if (mbuf->data_off < DEFAULT_TX_ICEOF +
+				sizeof(struct dpaa_eth_parse_results_t)) {
+			rte_errno = EINVAL;
+			return i;
+		}
+
+		/* dpaa_checksum_offload() relies on the packet type */
+		if (!(mbuf->packet_type & RTE_PTYPE_L3_MASK)) {
+			if (mbuf->ol_flags & PKT_TX_IPV4)
+				mbuf->packet_type |= RTE_PTYPE_L3_IPV4;
+			else if (mbuf->ol_flags & PKT_TX_IPV6)
+				mbuf->packet_type |= RTE_PTYPE_L3_IPV6;
+		}
+		if (!(mbuf->packet_type & RTE_PTYPE_L4_MASK)) {
+			if (l4 == PKT_TX_TCP_CKSUM)
+				mbuf->packet_type |= RTE_PTYPE_L4_TCP;
+			else if (l4 == PKT_TX_UDP_CKSUM)
+				mbuf->packet_type |= RTE_PTYPE_L4_UDP;
+		}
+	}
+
+	return i;
+}
+
 uint16_t dpaa_eth_tx_drop_all(void *q  __rte_unused,
 			      struct rte_mbuf **bufs __rte_unused,
 		uint16_t nb_bufs __rte_unused)
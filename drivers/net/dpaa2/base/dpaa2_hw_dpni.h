@@ -385,12 +385,18 @@ static inline int __attribute__((hot))
 eth_copy_mbuf_to_fd(struct rte_mbuf *mbuf,
 		    struct qbman_fd *fd, uint16_t bpid)
 {
+	struct rte_mempool *mp = bpid_info[bpid].bp_list->buf_pool.mp;
 	struct rte_mbuf *m;
 	void *mb = NULL;
 
-	if (hw_mbuf_alloc_bulk(bpid_info[bpid].bp_list->buf_pool.mp, &mb, 1)) {
+	/* the frame is copied in a single buffer of the pool */
+	if (unlikely(mbuf->data_off + mbuf->pkt_len >
+		     rte_pktmbuf_data_room_size(mp))) {
+		PMD_TX_LOG(WARNING, "Frame too large for a DPAA2 buffer");
+		return -1;
+	}
+	if (hw_mbuf_alloc_bulk(mp, &mb, 1)) {
 		PMD_TX_LOG(WARNING, "Unable to allocated DPAA2 buffer");
-		rte_pktmbuf_free(mbuf);
 		return -1;
 	}
 	m = (struct rte_mbuf *)mb;
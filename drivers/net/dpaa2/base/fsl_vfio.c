@@ -209,6 +209,34 @@ int vfio_dmamap_mem_region(uint64_t vaddr,
 	return 0;
 }
 
+/* follow the memory segments added or removed at runtime */
+static void dpaa2_mem_event(enum rte_mem_event event,
+			    const struct rte_memseg *ms,
+			    void *arg __rte_unused)
+{
+	struct fsl_vfio_group *group = &vfio_groups[0];
+	struct vfio_iommu_type1_dma_unmap dma_unmap = {
+		.argsz = sizeof(dma_unmap),
+	};
+	uint64_t iova;
+
+#ifdef RTE_LIBRTE_DPAA2_USE_PHYS_IOVA
+	iova = ms->phys_addr;
+#else
+	iova = ms->addr_64;
+#endif
+
+	if (event == RTE_MEM_EVENT_ALLOC) {
+		vfio_dmamap_mem_region(ms->addr_64, iova, ms->len);
+		return;
+	}
+
+	dma_unmap.iova = iova;
+	dma_unmap.size = ms->len;
+	if (ioctl(group->container->fd, VFIO_IOMMU_UNMAP_DMA, &dma_unmap))
+		FSL_VFIO_LOG(ERR, "VFIO_IOMMU_UNMAP_DMA API Error %d", errno);
+}
+
 static int setup_dmamap(void)
 {
 	int ret;
@@ -231,6 +259,10 @@ static int setup_dmamap(void)
 		if (memseg[i].addr == NULL && memseg[i].len == 0)
 			break;
 
+		/* segment released at runtime */
+		if (memseg[i].len == 0)
+			continue;
+
 		dma_map.size = memseg[i].len;
 		dma_map.vaddr = memseg[i].addr_64;
 #ifdef RTE_LIBRTE_DPAA2_USE_PHYS_IOVA
@@ -267,6 +299,8 @@ static int setup_dmamap(void)
 	 */
 	vfio_map_irq_region(group);
 
+	rte_mem_event_callback_register(dpaa2_mem_event, NULL);
+
 	return 0;
 }
 
@@ -1519,6 +1519,7 @@ dpaa2_dev_init(struct rte_eth_dev *eth_dev)
 	eth_dev->dev_ops = &dpaa2_ethdev_ops;
 	eth_dev->rx_pkt_burst = dpaa2_dev_prefetch_rx;
 	eth_dev->tx_pkt_burst = dpaa2_dev_tx;
+	eth_dev->tx_pkt_prepare = dpaa2_dev_tx_prepare;
 
 	/*If no prefetch is configured. */
 	if (getenv("DPAA2_RX_NO_PREFETCH")) {
@@ -40,6 +40,7 @@
 #include <rte_string_fns.h>
 #include <rte_dev.h>
 #include <rte_ethdev.h>
+#include <rte_errno.h>
 
 /* DPAA2 Global constants */
 #include <dpaa2_logs.h>
@@ -55,6 +56,19 @@
 
 struct swp_active_dqs global_active_dqs_list[NUM_MAX_SWP];
 
+/* external buffers do not belong to a bpool, the HW must not free them */
+static inline int
+dpaa2_mbuf_has_extbuf(struct rte_mbuf *mbuf)
+{
+	struct rte_mbuf *seg = mbuf;
+	uint8_t i;
+
+	for (i = 0; i < mbuf->nb_segs; i++, seg = seg->next)
+		if (RTE_MBUF_HAS_EXTBUF(seg))
+			return 1;
+	return 0;
+}
+
 uint16_t
 dpaa2_dev_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
@@ -495,8 +509,10 @@ dpaa2_dev_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 			DPAA2_RESET_FD_CTRL((&fd_arr[loop]));
 			DPAA2_SET_FD_FLC((&fd_arr[loop]), NULL);
 			mp = (*bufs)->pool;
-			/* Not a hw_pkt pool allocated frame */
-			if (mp && !(mp->flags & MEMPOOL_F_HW_PKT_POOL)) {
+			/* Not a hw_pkt pool allocated frame, or an external
+			 * buffer which must not be released to a bpool */
+			if ((mp && !(mp->flags & MEMPOOL_F_HW_PKT_POOL)) ||
+			    dpaa2_mbuf_has_extbuf(*bufs)) {
 				PMD_TX_LOG(ERR, "non hw offload bufffer ");
 				/* alloc should be from the default buffer pool
 				attached to this interface */
@@ -516,8 +532,11 @@ dpaa2_dev_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 				}
 				if (eth_copy_mbuf_to_fd(*bufs,
 							&fd_arr[loop], bpid)) {
-					bufs++;
-					continue;
+					/* left to the caller, send the
+					 * frames before it */
+					frames_to_send = loop;
+					nb_pkts = loop;
+					break;
 				}
 			} else {
 				bpid = mempool_to_bpid(mp);
@@ -544,6 +563,45 @@ skip_tx:
 	return num_tx;
 }
 
+#define DPAA2_TX_OFFLOAD_NOTSUP_MASK (PKT_TX_OFFLOAD_MASK ^ \
+		(PKT_TX_IP_CKSUM | PKT_TX_L4_MASK | PKT_TX_OUTER_IP_CKSUM))
+
+/*
+ * Callback to check the frames before sending them through WRIOP.
+ * The checksums are computed by the hardware for every frame, so
+ * there is no header to fix up here.
+ */
+uint16_t
+dpaa2_dev_tx_prepare(void *queue, struct rte_mbuf **bufs,
+		     uint16_t nb_pkts)
+{
+	struct dpaa2_queue *dpaa2_q = (struct dpaa2_queue *)queue;
+	struct dpaa2_dev_priv *priv = dpaa2_q->dev->data->dev_private;
+	struct rte_mempool *mp;
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (bufs[i]->ol_flags & DPAA2_TX_OFFLOAD_NOTSUP_MASK) {
+			rte_errno = ENOTSUP;
+			return i;
+		}
+
+		/* non hw_pkt pool frames and external buffers are copied
+		 * into a single buffer */
+		mp = bufs[i]->pool;
+		if (((mp && !(mp->flags & MEMPOOL_F_HW_PKT_POOL)) ||
+		     dpaa2_mbuf_has_extbuf(bufs[i])) &&
+		    (bufs[i]->nb_segs > 1 || priv->bp_list == NULL ||
+		     bufs[i]->data_off + bufs[i]->pkt_len >
+		     rte_pktmbuf_data_room_size(priv->bp_list->buf_pool.mp))) {
+			rte_errno = EINVAL;
+			return i;
+		}
+	}
+
+	return i;
+}
+
 /**
  * Dummy DPDK callback for TX.
  *
@@ -132,6 +132,10 @@
 #define	IGB_RXD_ALIGN	(E1000_ALIGN / sizeof(union e1000_adv_rx_desc))
 #define	IGB_TXD_ALIGN	(E1000_ALIGN / sizeof(union e1000_adv_tx_desc))
 
+/* igb has no limit on the number of data descriptors of a packet */
+#define	IGB_TX_MAX_SEG		UINT8_MAX
+#define	IGB_TX_MAX_MTU_SEG	UINT8_MAX
+
 #define	EM_RXD_ALIGN	(E1000_ALIGN / sizeof(struct e1000_rx_desc))
 #define	EM_TXD_ALIGN	(E1000_ALIGN / sizeof(struct e1000_data_desc))
 
@@ -315,6 +319,9 @@ void eth_igb_tx_init(struct rte_eth_dev *dev);
 uint16_t eth_igb_xmit_pkts(void *txq, struct rte_mbuf **tx_pkts,
 		uint16_t nb_pkts);
 
+uint16_t eth_igb_prep_pkts(void *txq, struct rte_mbuf **tx_pkts,
+		uint16_t nb_pkts);
+
 uint16_t eth_igb_recv_pkts(void *rxq, struct rte_mbuf **rx_pkts,
 		uint16_t nb_pkts);
 
@@ -37,6 +37,7 @@
 #include <rte_eth_ctrl.h>
 #include <rte_time.h>
 #include <rte_kvargs.h>
+#include <rte_flow_driver.h>
 
 #define I40E_VLAN_TAG_SIZE        4
 
@@ -407,6 +408,9 @@ struct i40e_mirror_rule {
 
 TAILQ_HEAD(i40e_mirror_rule_list, i40e_mirror_rule);
 
+/* generic flow rules, defined in i40e_flow.c */
+TAILQ_HEAD(i40e_flow_list, rte_flow);
+
 /*
  * Structure to store private data specific for PF instance.
  */
@@ -459,6 +463,7 @@ struct i40e_pf {
 	struct i40e_fc_conf fc_conf; /* Flow control conf */
 	struct i40e_mirror_rule_list mirror_list;
 	uint16_t nb_mirror_rule;   /* The number of mirror rules */
+	struct i40e_flow_list flow_list; /* generic flow rules */
 	bool floating_veb; /* The flag to use the floating VEB */
 	/* The floating enable flag for the specific VF */
 	bool floating_veb_list[I40E_MAX_VF];
@@ -589,9 +594,19 @@ int i40e_fdir_configure(struct rte_eth_dev *dev);
 void i40e_fdir_teardown(struct i40e_pf *pf);
 enum i40e_filter_pctype i40e_flowtype_to_pctype(uint16_t flow_type);
 uint16_t i40e_pctype_to_flowtype(enum i40e_filter_pctype pctype);
+uint64_t i40e_get_default_input_set(uint16_t pctype);
 int i40e_fdir_ctrl_func(struct rte_eth_dev *dev,
 			  enum rte_filter_op filter_op,
 			  void *arg);
+int i40e_add_del_fdir_filter(struct rte_eth_dev *dev,
+			     const struct rte_eth_fdir_filter *filter,
+			     bool add);
+int i40e_ethertype_filter_set(struct i40e_pf *pf,
+			      struct rte_eth_ethertype_filter *filter,
+			      bool add);
+void i40e_flow_list_free(struct i40e_pf *pf);
+
+extern const struct rte_flow_ops i40e_flow_ops;
 int i40e_select_filter_input_set(struct i40e_hw *hw,
 				 struct rte_eth_input_set_conf *conf,
 				 enum rte_filter_type filter);
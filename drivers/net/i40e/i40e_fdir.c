@@ -1007,7 +1007,7 @@ i40e_check_fdir_programming_status(struct i40e_rx_queue *rxq)
  * @filter: fdir filter entry
  * @add: 0 - delete, 1 - add
  */
-static int
+int
 i40e_add_del_fdir_filter(struct rte_eth_dev *dev,
 			    const struct rte_eth_fdir_filter *filter,
 			    bool add)
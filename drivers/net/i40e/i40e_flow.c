@@ -0,0 +1,648 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/queue.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_ether.h>
+#include <rte_ethdev.h>
+#include <rte_malloc.h>
+#include <rte_flow.h>
+#include <rte_flow_driver.h>
+
+#include "i40e_logs.h"
+#include "base/i40e_type.h"
+#include "base/i40e_prototype.h"
+#include "i40e_ethdev.h"
+
+/*
+ * Generic flow rules are translated into the ethertype filters and the
+ * perfect flow director filters of the device. A rule must match one of
+ * them exactly, anything else is rejected so that the application can
+ * handle the flow in software.
+ */
+
+struct rte_flow {
+	TAILQ_ENTRY(rte_flow) next;
+	enum rte_filter_type filter_type;
+	union {
+		struct rte_eth_ethertype_filter ethertype;
+		struct rte_eth_fdir_filter fdir;
+	} filter;
+};
+
+/* Actions of a rule, before translation into a filter */
+struct i40e_flow_actions {
+	enum rte_flow_action_type fate; /* QUEUE, DROP or END if none */
+	uint16_t queue;
+	uint32_t mark;
+	uint8_t has_mark;
+	uint8_t has_flag;
+};
+
+static inline int
+i40e_flow_is_zero(const void *buf, size_t len)
+{
+	const uint8_t *p = buf;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		if (p[i])
+			return 0;
+	return 1;
+}
+
+static inline int
+i40e_flow_is_full(const void *buf, size_t len)
+{
+	const uint8_t *p = buf;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		if (p[i] != UINT8_MAX)
+			return 0;
+	return 1;
+}
+
+/* Skip VOID items */
+static const struct rte_flow_item *
+i40e_flow_next_item(const struct rte_flow_item *item)
+{
+	while (item->type == RTE_FLOW_ITEM_TYPE_VOID)
+		item++;
+	return item;
+}
+
+/*
+ * Check the common properties of an item and return its mask, the
+ * default one when not given. spec and mask are NULL when the item
+ * matches any header.
+ */
+static int
+i40e_flow_item_check(const struct rte_flow_item *item,
+		     const void *default_mask, const void **mask,
+		     struct rte_flow_error *error)
+{
+	if (item->last != NULL)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"ranges are not supported");
+	if (item->spec == NULL) {
+		if (item->mask != NULL)
+			return rte_flow_error_set(error, EINVAL,
+					RTE_FLOW_ERROR_TYPE_ITEM, item,
+					"mask without spec");
+		*mask = NULL;
+		return 0;
+	}
+	*mask = item->mask != NULL ? item->mask : default_mask;
+	return 0;
+}
+
+static int
+i40e_flow_parse_attr(const struct rte_flow_attr *attr,
+		     struct rte_flow_error *error)
+{
+	if (attr == NULL)
+		return rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_ATTR, NULL,
+				"NULL attribute");
+	if (attr->group)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ATTR_GROUP, attr,
+				"groups are not supported");
+	if (attr->priority)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ATTR_PRIORITY, attr,
+				"priorities are not supported");
+	if (attr->egress)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ATTR_EGRESS, attr,
+				"egress is not supported");
+	if (!attr->ingress)
+		return rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_ATTR_INGRESS, attr,
+				"only ingress is supported");
+	return 0;
+}
+
+/* At most one QUEUE or DROP action, MARK and FLAG. */
+static int
+i40e_flow_parse_actions(struct rte_eth_dev *dev,
+			const struct rte_flow_action actions[],
+			struct i40e_flow_actions *acts,
+			struct rte_flow_error *error)
+{
+	const struct rte_flow_action *action;
+	const struct rte_flow_action_queue *queue;
+	const struct rte_flow_action_mark *mark;
+
+	if (actions == NULL)
+		return rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_ACTION_NUM, NULL,
+				"NULL action list");
+
+	memset(acts, 0, sizeof(*acts));
+	acts->fate = RTE_FLOW_ACTION_TYPE_END;
+	for (action = actions; action->type != RTE_FLOW_ACTION_TYPE_END;
+	     action++) {
+		switch (action->type) {
+		case RTE_FLOW_ACTION_TYPE_VOID:
+			break;
+		case RTE_FLOW_ACTION_TYPE_QUEUE:
+		case RTE_FLOW_ACTION_TYPE_DROP:
+			if (acts->fate != RTE_FLOW_ACTION_TYPE_END)
+				return rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ACTION, action,
+					"only one queue or drop action"
+					" is supported");
+			if (action->type == RTE_FLOW_ACTION_TYPE_QUEUE) {
+				queue = action->conf;
+				if (queue == NULL ||
+				    queue->index >= dev->data->nb_rx_queues)
+					return rte_flow_error_set(error,
+						EINVAL,
+						RTE_FLOW_ERROR_TYPE_ACTION,
+						action, "invalid queue index");
+				acts->queue = queue->index;
+			}
+			acts->fate = action->type;
+			break;
+		case RTE_FLOW_ACTION_TYPE_MARK:
+			mark = action->conf;
+			if (mark == NULL || acts->has_mark)
+				return rte_flow_error_set(error, EINVAL,
+					RTE_FLOW_ERROR_TYPE_ACTION, action,
+					"invalid mark action");
+			acts->mark = mark->id;
+			acts->has_mark = 1;
+			break;
+		case RTE_FLOW_ACTION_TYPE_FLAG:
+			acts->has_flag = 1;
+			break;
+		default:
+			return rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ACTION, action,
+					"action not supported");
+		}
+	}
+	return 0;
+}
+
+/*
+ * ETH with a fully masked EtherType and optionally a fully masked
+ * destination MAC address, to an ethertype filter.
+ */
+static int
+i40e_flow_parse_ethertype(const struct rte_flow_item *item,
+			  const struct i40e_flow_actions *acts,
+			  struct rte_eth_ethertype_filter *filter,
+			  struct rte_flow_error *error)
+{
+	const struct rte_flow_item_eth *spec = item->spec;
+	const struct rte_flow_item_eth *mask;
+	int ret;
+
+	ret = i40e_flow_item_check(item, &rte_flow_item_eth_mask,
+				   (const void **)&mask, error);
+	if (ret)
+		return ret;
+	if (mask == NULL || mask->type != UINT16_MAX ||
+	    !i40e_flow_is_zero(&mask->src, sizeof(mask->src)) ||
+	    (!i40e_flow_is_zero(&mask->dst, sizeof(mask->dst)) &&
+	     !i40e_flow_is_full(&mask->dst, sizeof(mask->dst))))
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"only the EtherType and the full destination"
+				" MAC address can be matched");
+
+	filter->ether_type = rte_be_to_cpu_16(spec->type);
+	if (filter->ether_type == ETHER_TYPE_IPv4 ||
+	    filter->ether_type == ETHER_TYPE_IPv6)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"IPv4 and IPv6 EtherTypes are not supported");
+	if (!i40e_flow_is_zero(&mask->dst, sizeof(mask->dst))) {
+		ether_addr_copy(&spec->dst, &filter->mac_addr);
+		filter->flags |= RTE_ETHTYPE_FLAGS_MAC;
+	}
+
+	item = i40e_flow_next_item(item + 1);
+	if (item->type != RTE_FLOW_ITEM_TYPE_END)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"only ETH can be matched with an EtherType");
+
+	if (acts->has_mark || acts->has_flag)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ACTION, NULL,
+				"ethertype rules cannot mark packets");
+	switch (acts->fate) {
+	case RTE_FLOW_ACTION_TYPE_QUEUE:
+		filter->queue = acts->queue;
+		break;
+	case RTE_FLOW_ACTION_TYPE_DROP:
+		filter->flags |= RTE_ETHTYPE_FLAGS_DROP;
+		break;
+	default:
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ACTION_NUM, NULL,
+				"a queue or drop action is required");
+	}
+	return 0;
+}
+
+/*
+ * [IPv4 | IPv6] / [TCP | UDP | SCTP] to a perfect flow director filter.
+ * The rule has to match the fields of the default input set, i.e. the
+ * full addresses and ports, plus the verification tag for SCTP.
+ */
+static int
+i40e_flow_parse_fdir(struct rte_eth_dev *dev,
+		     const struct rte_flow_item *item,
+		     const struct i40e_flow_actions *acts,
+		     struct rte_eth_fdir_filter *filter,
+		     struct rte_flow_error *error)
+{
+	struct i40e_pf *pf = I40E_DEV_PRIVATE_TO_PF(dev->data->dev_private);
+	union rte_eth_fdir_flow *flow = &filter->input.flow;
+	const struct rte_flow_item_ipv4 *ipv4_spec = NULL;
+	const struct rte_flow_item_ipv6 *ipv6_spec = NULL;
+	const struct udp_hdr *ports;
+	const void *mask;
+	struct ipv4_hdr ipv4_hdr;
+	struct ipv6_hdr ipv6_hdr;
+	struct tcp_hdr tcp_hdr;
+	struct udp_hdr udp_hdr;
+	struct sctp_hdr sctp_hdr;
+	uint32_t tag = 0;
+	enum i40e_filter_pctype pctype;
+	int ret;
+
+	if (dev->data->dev_conf.fdir_conf.mode != RTE_FDIR_MODE_PERFECT)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"flow director is not in perfect mode");
+
+	switch (item->type) {
+	case RTE_FLOW_ITEM_TYPE_IPV4:
+		ret = i40e_flow_item_check(item, &rte_flow_item_ipv4_mask,
+					   &mask, error);
+		if (ret)
+			return ret;
+		ipv4_spec = item->spec;
+		if (mask == NULL)
+			break;
+		ipv4_hdr = ((const struct rte_flow_item_ipv4 *)mask)->hdr;
+		if (ipv4_hdr.src_addr != UINT32_MAX ||
+		    ipv4_hdr.dst_addr != UINT32_MAX)
+			mask = NULL;
+		ipv4_hdr.src_addr = 0;
+		ipv4_hdr.dst_addr = 0;
+		if (!i40e_flow_is_zero(&ipv4_hdr, sizeof(ipv4_hdr)))
+			mask = NULL;
+		break;
+	case RTE_FLOW_ITEM_TYPE_IPV6:
+		ret = i40e_flow_item_check(item, &rte_flow_item_ipv6_mask,
+					   &mask, error);
+		if (ret)
+			return ret;
+		ipv6_spec = item->spec;
+		if (mask == NULL)
+			break;
+		ipv6_hdr = ((const struct rte_flow_item_ipv6 *)mask)->hdr;
+		if (!i40e_flow_is_full(ipv6_hdr.src_addr,
+				       sizeof(ipv6_hdr.src_addr)) ||
+		    !i40e_flow_is_full(ipv6_hdr.dst_addr,
+				       sizeof(ipv6_hdr.dst_addr)))
+			mask = NULL;
+		memset(ipv6_hdr.src_addr, 0, sizeof(ipv6_hdr.src_addr));
+		memset(ipv6_hdr.dst_addr, 0, sizeof(ipv6_hdr.dst_addr));
+		if (!i40e_flow_is_zero(&ipv6_hdr, sizeof(ipv6_hdr)))
+			mask = NULL;
+		break;
+	default:
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"only IPv4 and IPv6 can be matched");
+	}
+	if (mask == NULL)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"only the full source and destination"
+				" addresses can be matched");
+
+	/* the ports are at the same place in the TCP, UDP and SCTP headers */
+	item = i40e_flow_next_item(item + 1);
+	switch (item->type) {
+	case RTE_FLOW_ITEM_TYPE_TCP:
+		ret = i40e_flow_item_check(item, &rte_flow_item_tcp_mask,
+					   &mask, error);
+		if (ret || mask == NULL)
+			break;
+		tcp_hdr = ((const struct rte_flow_item_tcp *)mask)->hdr;
+		tcp_hdr.src_port = 0;
+		tcp_hdr.dst_port = 0;
+		if (!i40e_flow_is_zero(&tcp_hdr, sizeof(tcp_hdr)))
+			mask = NULL;
+		filter->input.flow_type = ipv4_spec != NULL ?
+			RTE_ETH_FLOW_NONFRAG_IPV4_TCP :
+			RTE_ETH_FLOW_NONFRAG_IPV6_TCP;
+		break;
+	case RTE_FLOW_ITEM_TYPE_UDP:
+		ret = i40e_flow_item_check(item, &rte_flow_item_udp_mask,
+					   &mask, error);
+		if (ret || mask == NULL)
+			break;
+		udp_hdr = ((const struct rte_flow_item_udp *)mask)->hdr;
+		udp_hdr.src_port = 0;
+		udp_hdr.dst_port = 0;
+		if (!i40e_flow_is_zero(&udp_hdr, sizeof(udp_hdr)))
+			mask = NULL;
+		filter->input.flow_type = ipv4_spec != NULL ?
+			RTE_ETH_FLOW_NONFRAG_IPV4_UDP :
+			RTE_ETH_FLOW_NONFRAG_IPV6_UDP;
+		break;
+	case RTE_FLOW_ITEM_TYPE_SCTP:
+		ret = i40e_flow_item_check(item, &rte_flow_item_sctp_mask,
+					   &mask, error);
+		if (ret || mask == NULL)
+			break;
+		sctp_hdr = ((const struct rte_flow_item_sctp *)mask)->hdr;
+		if (sctp_hdr.tag != UINT32_MAX)
+			mask = NULL;
+		sctp_hdr.src_port = 0;
+		sctp_hdr.dst_port = 0;
+		sctp_hdr.tag = 0;
+		if (!i40e_flow_is_zero(&sctp_hdr, sizeof(sctp_hdr)))
+			mask = NULL;
+		tag = ((const struct rte_flow_item_sctp *)item->spec)->hdr.tag;
+		filter->input.flow_type = ipv4_spec != NULL ?
+			RTE_ETH_FLOW_NONFRAG_IPV4_SCTP :
+			RTE_ETH_FLOW_NONFRAG_IPV6_SCTP;
+		break;
+	default:
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"only TCP, UDP and SCTP can follow IP");
+	}
+	if (ret)
+		return ret;
+	if (mask == NULL ||
+	    ((const struct udp_hdr *)mask)->src_port != UINT16_MAX ||
+	    ((const struct udp_hdr *)mask)->dst_port != UINT16_MAX)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"only the full ports (and SCTP tag)"
+				" can be matched");
+	ports = item->spec;
+
+	if (ipv4_spec != NULL) {
+		flow->ip4_flow.src_ip = ipv4_spec->hdr.src_addr;
+		flow->ip4_flow.dst_ip = ipv4_spec->hdr.dst_addr;
+		flow->udp4_flow.src_port = ports->src_port;
+		flow->udp4_flow.dst_port = ports->dst_port;
+		flow->sctp4_flow.verify_tag = tag;
+	} else {
+		memcpy(flow->ipv6_flow.src_ip, ipv6_spec->hdr.src_addr,
+		       sizeof(flow->ipv6_flow.src_ip));
+		memcpy(flow->ipv6_flow.dst_ip, ipv6_spec->hdr.dst_addr,
+		       sizeof(flow->ipv6_flow.dst_ip));
+		flow->udp6_flow.src_port = ports->src_port;
+		flow->udp6_flow.dst_port = ports->dst_port;
+		flow->sctp6_flow.verify_tag = tag;
+	}
+
+	item = i40e_flow_next_item(item + 1);
+	if (item->type != RTE_FLOW_ITEM_TYPE_END)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"nothing can be matched after L4");
+
+	pctype = i40e_flowtype_to_pctype(filter->input.flow_type);
+	if (pf->fdir.input_set[pctype] != i40e_get_default_input_set(pctype))
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, NULL,
+				"flow director input set was changed");
+
+	switch (acts->fate) {
+	case RTE_FLOW_ACTION_TYPE_QUEUE:
+		filter->action.behavior = RTE_ETH_FDIR_ACCEPT;
+		filter->action.rx_queue = acts->queue;
+		break;
+	case RTE_FLOW_ACTION_TYPE_DROP:
+		filter->action.behavior = RTE_ETH_FDIR_REJECT;
+		break;
+	default:
+		/* no fate, packets go through RSS as usual */
+		filter->action.behavior = RTE_ETH_FDIR_PASSTHRU;
+		break;
+	}
+	if (acts->has_mark) {
+		filter->soft_id = acts->mark;
+		filter->action.report_status = RTE_ETH_FDIR_REPORT_ID;
+	} else {
+		filter->action.report_status = RTE_ETH_FDIR_NO_REPORT_STATUS;
+	}
+	return 0;
+}
+
+/* Translate a rule into a filter, without touching the device. */
+static int
+i40e_flow_parse(struct rte_eth_dev *dev,
+		const struct rte_flow_attr *attr,
+		const struct rte_flow_item pattern[],
+		const struct rte_flow_action actions[],
+		struct rte_flow *flow,
+		struct rte_flow_error *error)
+{
+	struct i40e_flow_actions acts;
+	const struct rte_flow_item *item;
+	int ret;
+
+	ret = i40e_flow_parse_attr(attr, error);
+	if (ret)
+		return ret;
+	if (pattern == NULL)
+		return rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_ITEM_NUM, NULL,
+				"NULL pattern");
+	ret = i40e_flow_parse_actions(dev, actions, &acts, error);
+	if (ret)
+		return ret;
+
+	memset(flow, 0, sizeof(*flow));
+	item = i40e_flow_next_item(pattern);
+	if (item->type == RTE_FLOW_ITEM_TYPE_ETH && item->spec != NULL) {
+		flow->filter_type = RTE_ETH_FILTER_ETHERTYPE;
+		return i40e_flow_parse_ethertype(item, &acts,
+				&flow->filter.ethertype, error);
+	}
+	/* an empty ETH item matches any Ethernet frame */
+	if (item->type == RTE_FLOW_ITEM_TYPE_ETH) {
+		if (item->last != NULL || item->mask != NULL)
+			return rte_flow_error_set(error, EINVAL,
+					RTE_FLOW_ERROR_TYPE_ITEM, item,
+					"mask without spec");
+		item = i40e_flow_next_item(item + 1);
+	}
+	flow->filter_type = RTE_ETH_FILTER_FDIR;
+	return i40e_flow_parse_fdir(dev, item, &acts, &flow->filter.fdir,
+				    error);
+}
+
+/* Program or remove the filter of a rule. */
+static int
+i40e_flow_apply(struct rte_eth_dev *dev, struct rte_flow *flow, bool add)
+{
+	struct i40e_pf *pf = I40E_DEV_PRIVATE_TO_PF(dev->data->dev_private);
+
+	switch (flow->filter_type) {
+	case RTE_ETH_FILTER_ETHERTYPE:
+		return i40e_ethertype_filter_set(pf, &flow->filter.ethertype,
+						 add);
+	case RTE_ETH_FILTER_FDIR:
+		return i40e_add_del_fdir_filter(dev, &flow->filter.fdir, add);
+	default:
+		return -EINVAL;
+	}
+}
+
+static int
+i40e_flow_validate(struct rte_eth_dev *dev,
+		   const struct rte_flow_attr *attr,
+		   const struct rte_flow_item pattern[],
+		   const struct rte_flow_action actions[],
+		   struct rte_flow_error *error)
+{
+	struct rte_flow flow;
+
+	return i40e_flow_parse(dev, attr, pattern, actions, &flow, error);
+}
+
+static struct rte_flow *
+i40e_flow_create(struct rte_eth_dev *dev,
+		 const struct rte_flow_attr *attr,
+		 const struct rte_flow_item pattern[],
+		 const struct rte_flow_action actions[],
+		 struct rte_flow_error *error)
+{
+	struct i40e_pf *pf = I40E_DEV_PRIVATE_TO_PF(dev->data->dev_private);
+	struct rte_flow *flow;
+	int ret;
+
+	flow = rte_zmalloc("i40e_flow", sizeof(*flow), 0);
+	if (flow == NULL) {
+		rte_flow_error_set(error, ENOMEM,
+				   RTE_FLOW_ERROR_TYPE_HANDLE, NULL,
+				   "cannot allocate flow rule");
+		return NULL;
+	}
+	ret = i40e_flow_parse(dev, attr, pattern, actions, flow, error);
+	if (ret)
+		goto error;
+	ret = i40e_flow_apply(dev, flow, true);
+	if (ret) {
+		rte_flow_error_set(error, -ret,
+				   RTE_FLOW_ERROR_TYPE_HANDLE, NULL,
+				   "cannot program the filter");
+		goto error;
+	}
+	TAILQ_INSERT_TAIL(&pf->flow_list, flow, next);
+	return flow;
+
+error:
+	rte_free(flow);
+	return NULL;
+}
+
+static int
+i40e_flow_destroy(struct rte_eth_dev *dev,
+		  struct rte_flow *flow,
+		  struct rte_flow_error *error)
+{
+	struct i40e_pf *pf = I40E_DEV_PRIVATE_TO_PF(dev->data->dev_private);
+	int ret;
+
+	ret = i40e_flow_apply(dev, flow, false);
+	if (ret)
+		return rte_flow_error_set(error, -ret,
+				RTE_FLOW_ERROR_TYPE_HANDLE, flow,
+				"cannot remove the filter");
+	TAILQ_REMOVE(&pf->flow_list, flow, next);
+	rte_free(flow);
+	return 0;
+}
+
+static int
+i40e_flow_flush(struct rte_eth_dev *dev,
+		struct rte_flow_error *error)
+{
+	struct i40e_pf *pf = I40E_DEV_PRIVATE_TO_PF(dev->data->dev_private);
+	struct rte_flow *flow;
+	int ret;
+
+	while ((flow = TAILQ_LAST(&pf->flow_list, i40e_flow_list)) != NULL) {
+		ret = i40e_flow_destroy(dev, flow, error);
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+/*
+ * Release the rules of a port being closed. The filters themselves go
+ * away with the VSIs and the flow director queue.
+ */
+void
+i40e_flow_list_free(struct i40e_pf *pf)
+{
+	struct rte_flow *flow;
+
+	while ((flow = TAILQ_FIRST(&pf->flow_list)) != NULL) {
+		TAILQ_REMOVE(&pf->flow_list, flow, next);
+		rte_free(flow);
+	}
+}
+
+const struct rte_flow_ops i40e_flow_ops = {
+	.validate = i40e_flow_validate,
+	.create = i40e_flow_create,
+	.destroy = i40e_flow_destroy,
+	.flush = i40e_flow_flush,
+	.query = NULL,
+};
@@ -54,6 +54,15 @@
 #define RTE_I40E_TX_MAX_FREE_BUF_SZ    64
 #define RTE_I40E_DESCS_PER_LOOP    4
 
+/* Max data descriptors of a TSO packet, and of a non-TSO packet or segment */
+#define I40E_TX_MAX_SEG     UINT8_MAX
+#define I40E_TX_MAX_MTU_SEG 8
+/* MSS outside of this range hang the queue */
+#define I40E_MIN_TSO_MSS    256
+#define I40E_MAX_TSO_MSS    9674
+#define I40E_TSO_FRAME_SIZE_MAX 262144
+#define I40E_TX_MIN_PKT_LEN 17
+
 #define I40E_RXBUF_SZ_1024 1024
 #define I40E_RXBUF_SZ_2048 2048
 
@@ -223,6 +232,9 @@ uint16_t i40e_recv_scattered_pkts(void *rx_queue,
 uint16_t i40e_xmit_pkts(void *tx_queue,
 			struct rte_mbuf **tx_pkts,
 			uint16_t nb_pkts);
+uint16_t i40e_prep_pkts(void *tx_queue,
+			struct rte_mbuf **tx_pkts,
+			uint16_t nb_pkts);
 int i40e_tx_queue_init(struct i40e_tx_queue *txq);
 int i40e_rx_queue_init(struct i40e_rx_queue *rxq);
 void i40e_free_tx_resources(struct i40e_tx_queue *txq);
@@ -0,0 +1,675 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/queue.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_ether.h>
+#include <rte_ethdev.h>
+#include <rte_malloc.h>
+#include <rte_flow.h>
+#include <rte_flow_driver.h>
+
+#include "ixgbe_logs.h"
+#include "base/ixgbe_api.h"
+#include "ixgbe_ethdev.h"
+
+#define IXGBE_FLOW_TCP_SYN 0x02 /* SYN bit of the TCP flags */
+
+/*
+ * Generic flow rules are translated into the legacy filters of the
+ * device: ethertype, SYN and 5-tuple filters. A rule must match one of
+ * them exactly, anything else is rejected so that the application can
+ * handle the flow in software.
+ */
+
+struct rte_flow {
+	TAILQ_ENTRY(rte_flow) next;
+	enum rte_filter_type filter_type;
+	union {
+		struct rte_eth_ethertype_filter ethertype;
+		struct rte_eth_syn_filter syn;
+		struct rte_eth_ntuple_filter ntuple;
+	} filter;
+};
+
+static inline int
+ixgbe_flow_is_zero(const void *buf, size_t len)
+{
+	const uint8_t *p = buf;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		if (p[i])
+			return 0;
+	return 1;
+}
+
+/* Skip VOID items */
+static const struct rte_flow_item *
+ixgbe_flow_next_item(const struct rte_flow_item *item)
+{
+	while (item->type == RTE_FLOW_ITEM_TYPE_VOID)
+		item++;
+	return item;
+}
+
+/*
+ * Check the common properties of an item and return its mask, the
+ * default one when not given. spec and mask are NULL when the item
+ * matches any header.
+ */
+static int
+ixgbe_flow_item_check(const struct rte_flow_item *item,
+		      const void *default_mask, const void **mask,
+		      struct rte_flow_error *error)
+{
+	if (item->last != NULL)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"ranges are not supported");
+	if (item->spec == NULL) {
+		if (item->mask != NULL)
+			return rte_flow_error_set(error, EINVAL,
+					RTE_FLOW_ERROR_TYPE_ITEM, item,
+					"mask without spec");
+		*mask = NULL;
+		return 0;
+	}
+	*mask = item->mask != NULL ? item->mask : default_mask;
+	return 0;
+}
+
+static int
+ixgbe_flow_parse_attr(const struct rte_flow_attr *attr,
+		      struct rte_flow_error *error)
+{
+	if (attr == NULL)
+		return rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_ATTR, NULL,
+				"NULL attribute");
+	if (attr->group)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ATTR_GROUP, attr,
+				"groups are not supported");
+	if (attr->egress)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ATTR_EGRESS, attr,
+				"egress is not supported");
+	if (!attr->ingress)
+		return rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_ATTR_INGRESS, attr,
+				"only ingress is supported");
+	return 0;
+}
+
+/* The only supported action is QUEUE. */
+static int
+ixgbe_flow_parse_actions(struct rte_eth_dev *dev,
+			 const struct rte_flow_action actions[],
+			 uint16_t *queue, struct rte_flow_error *error)
+{
+	const struct rte_flow_action *action;
+	const struct rte_flow_action_queue *conf;
+	int fate = 0;
+
+	if (actions == NULL)
+		return rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_ACTION_NUM, NULL,
+				"NULL action list");
+
+	for (action = actions; action->type != RTE_FLOW_ACTION_TYPE_END;
+	     action++) {
+		switch (action->type) {
+		case RTE_FLOW_ACTION_TYPE_VOID:
+			break;
+		case RTE_FLOW_ACTION_TYPE_QUEUE:
+			conf = action->conf;
+			if (fate)
+				return rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ACTION, action,
+					"only one queue action is supported");
+			if (conf == NULL ||
+			    conf->index >= dev->data->nb_rx_queues)
+				return rte_flow_error_set(error, EINVAL,
+					RTE_FLOW_ERROR_TYPE_ACTION, action,
+					"invalid queue index");
+			*queue = conf->index;
+			fate = 1;
+			break;
+		default:
+			return rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ACTION, action,
+					"action not supported");
+		}
+	}
+	if (!fate)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ACTION_NUM, actions,
+				"a queue action is required");
+	return 0;
+}
+
+/*
+ * ETH with a fully masked EtherType and no MAC address, to an
+ * ethertype filter.
+ */
+static int
+ixgbe_flow_parse_ethertype(const struct rte_flow_item *item,
+			   struct rte_eth_ethertype_filter *filter,
+			   struct rte_flow_error *error)
+{
+	const struct rte_flow_item_eth *spec = item->spec;
+	const struct rte_flow_item_eth *mask;
+	int ret;
+
+	ret = ixgbe_flow_item_check(item, &rte_flow_item_eth_mask,
+				    (const void **)&mask, error);
+	if (ret)
+		return ret;
+	if (mask == NULL || mask->type != UINT16_MAX ||
+	    !ixgbe_flow_is_zero(&mask->src, sizeof(mask->src)) ||
+	    !ixgbe_flow_is_zero(&mask->dst, sizeof(mask->dst)))
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"only the EtherType can be matched");
+
+	filter->ether_type = rte_be_to_cpu_16(spec->type);
+	if (filter->ether_type == ETHER_TYPE_IPv4 ||
+	    filter->ether_type == ETHER_TYPE_IPv6)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"IPv4 and IPv6 EtherTypes are not supported");
+
+	item = ixgbe_flow_next_item(item + 1);
+	if (item->type != RTE_FLOW_ITEM_TYPE_END)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"only ETH can be matched with an EtherType");
+	return 0;
+}
+
+/* IPv4 / [TCP | UDP | SCTP] to a 5-tuple filter. */
+static int
+ixgbe_flow_parse_ntuple(const struct rte_flow_item *item,
+			struct rte_eth_ntuple_filter *filter,
+			struct rte_flow_error *error)
+{
+	const struct rte_flow_item_ipv4 *ipv4_spec, *ipv4_mask;
+	const void *mask;
+	const uint16_t *ports_spec = NULL;
+	const uint16_t *ports_mask = NULL;
+	uint8_t proto = 0;
+	uint8_t l4_proto = 0;
+	size_t ports_off = 0;
+	size_t size = 0;
+	int ret;
+
+	if (item->type != RTE_FLOW_ITEM_TYPE_IPV4)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"only IPv4 5-tuples are supported");
+	ret = ixgbe_flow_item_check(item, &rte_flow_item_ipv4_mask,
+				    &mask, error);
+	if (ret)
+		return ret;
+	ipv4_spec = item->spec;
+	ipv4_mask = mask;
+
+	filter->flags = RTE_5TUPLE_FLAGS;
+	if (ipv4_mask != NULL) {
+		struct ipv4_hdr hdr = ipv4_mask->hdr;
+
+		/* partial masks and other fields cannot be matched */
+		hdr.src_addr = 0;
+		hdr.dst_addr = 0;
+		hdr.next_proto_id = 0;
+		if (!ixgbe_flow_is_zero(&hdr, sizeof(hdr)) ||
+		    (ipv4_mask->hdr.src_addr != 0 &&
+		     ipv4_mask->hdr.src_addr != UINT32_MAX) ||
+		    (ipv4_mask->hdr.dst_addr != 0 &&
+		     ipv4_mask->hdr.dst_addr != UINT32_MAX) ||
+		    (ipv4_mask->hdr.next_proto_id != 0 &&
+		     ipv4_mask->hdr.next_proto_id != UINT8_MAX))
+			return rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ITEM, item,
+					"only full addresses and protocol"
+					" can be matched");
+		filter->src_ip = ipv4_spec->hdr.src_addr;
+		filter->src_ip_mask = ipv4_mask->hdr.src_addr;
+		filter->dst_ip = ipv4_spec->hdr.dst_addr;
+		filter->dst_ip_mask = ipv4_mask->hdr.dst_addr;
+		if (ipv4_mask->hdr.next_proto_id)
+			proto = ipv4_spec->hdr.next_proto_id;
+	}
+
+	item = ixgbe_flow_next_item(item + 1);
+	switch (item->type) {
+	case RTE_FLOW_ITEM_TYPE_TCP:
+		ret = ixgbe_flow_item_check(item, &rte_flow_item_tcp_mask,
+					    &mask, error);
+		ports_off = offsetof(struct tcp_hdr, src_port);
+		size = sizeof(struct tcp_hdr);
+		l4_proto = IPPROTO_TCP;
+		break;
+	case RTE_FLOW_ITEM_TYPE_UDP:
+		ret = ixgbe_flow_item_check(item, &rte_flow_item_udp_mask,
+					    &mask, error);
+		ports_off = offsetof(struct udp_hdr, src_port);
+		size = sizeof(struct udp_hdr);
+		l4_proto = IPPROTO_UDP;
+		break;
+	case RTE_FLOW_ITEM_TYPE_SCTP:
+		ret = ixgbe_flow_item_check(item, &rte_flow_item_sctp_mask,
+					    &mask, error);
+		ports_off = offsetof(struct sctp_hdr, src_port);
+		size = sizeof(struct sctp_hdr);
+		l4_proto = IPPROTO_SCTP;
+		break;
+	case RTE_FLOW_ITEM_TYPE_END:
+		mask = NULL;
+		break;
+	default:
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"only TCP, UDP and SCTP can follow IPv4");
+	}
+	if (ret)
+		return ret;
+	if (l4_proto != 0) {
+		if (proto != 0 && proto != l4_proto)
+			return rte_flow_error_set(error, EINVAL,
+					RTE_FLOW_ERROR_TYPE_ITEM, item,
+					"L4 item does not match the IPv4"
+					" protocol");
+		proto = l4_proto;
+	}
+
+	if (proto != 0 && proto != IPPROTO_TCP && proto != IPPROTO_UDP &&
+	    proto != IPPROTO_SCTP)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"only TCP, UDP and SCTP can be matched");
+	filter->proto = proto;
+	filter->proto_mask = proto ? UINT8_MAX : 0;
+
+	if (mask != NULL) {
+		uint8_t hdr[sizeof(struct tcp_hdr)];
+
+		ports_spec = (const uint16_t *)
+			((const uint8_t *)item->spec + ports_off);
+		ports_mask = (const uint16_t *)
+			((const uint8_t *)mask + ports_off);
+		/* only the ports can be matched, fully */
+		memcpy(hdr, mask, size);
+		memset(hdr + ports_off, 0, 2 * sizeof(uint16_t));
+		if (!ixgbe_flow_is_zero(hdr, size) ||
+		    (ports_mask[0] != 0 && ports_mask[0] != UINT16_MAX) ||
+		    (ports_mask[1] != 0 && ports_mask[1] != UINT16_MAX))
+			return rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ITEM, item,
+					"only full ports can be matched");
+		filter->src_port = ports_spec[0];
+		filter->src_port_mask = ports_mask[0];
+		filter->dst_port = ports_spec[1];
+		filter->dst_port_mask = ports_mask[1];
+	}
+
+	if (item->type != RTE_FLOW_ITEM_TYPE_END)
+		item = ixgbe_flow_next_item(item + 1);
+	if (item->type != RTE_FLOW_ITEM_TYPE_END)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"nothing can be matched after L4");
+	return 0;
+}
+
+/* [IPv4 | IPv6] / TCP with only the SYN flag to the SYN filter. */
+static int
+ixgbe_flow_parse_syn(const struct rte_flow_item *item,
+		     struct rte_flow_error *error)
+{
+	const struct rte_flow_item_tcp *spec, *mask;
+	struct tcp_hdr hdr;
+	int ret;
+
+	if (item->type == RTE_FLOW_ITEM_TYPE_IPV4 ||
+	    item->type == RTE_FLOW_ITEM_TYPE_IPV6) {
+		if (item->spec != NULL || item->last != NULL ||
+		    item->mask != NULL)
+			return rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ITEM, item,
+					"IP fields cannot be matched with"
+					" TCP flags");
+		item = ixgbe_flow_next_item(item + 1);
+	}
+	ret = ixgbe_flow_item_check(item, &rte_flow_item_tcp_mask,
+				    (const void **)&mask, error);
+	if (ret)
+		return ret;
+	spec = item->spec;
+	hdr = mask->hdr;
+	hdr.tcp_flags = 0;
+	if (!ixgbe_flow_is_zero(&hdr, sizeof(hdr)) ||
+	    mask->hdr.tcp_flags != IXGBE_FLOW_TCP_SYN ||
+	    spec->hdr.tcp_flags != IXGBE_FLOW_TCP_SYN)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"only the SYN flag can be matched");
+
+	item = ixgbe_flow_next_item(item + 1);
+	if (item->type != RTE_FLOW_ITEM_TYPE_END)
+		return rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"nothing can be matched after TCP");
+	return 0;
+}
+
+/* A TCP item matching flags, possibly after an empty IP item. */
+static int
+ixgbe_flow_is_syn(const struct rte_flow_item *item)
+{
+	const struct rte_flow_item_tcp *mask;
+
+	if (item->type == RTE_FLOW_ITEM_TYPE_IPV4 ||
+	    item->type == RTE_FLOW_ITEM_TYPE_IPV6) {
+		if (item->spec != NULL)
+			return 0;
+		item = ixgbe_flow_next_item(item + 1);
+	}
+	if (item->type != RTE_FLOW_ITEM_TYPE_TCP || item->spec == NULL)
+		return 0;
+	mask = item->mask != NULL ? item->mask : &rte_flow_item_tcp_mask;
+	return mask->hdr.tcp_flags != 0;
+}
+
+/* Translate a rule into a legacy filter, without touching the device. */
+static int
+ixgbe_flow_parse(struct rte_eth_dev *dev,
+		 const struct rte_flow_attr *attr,
+		 const struct rte_flow_item pattern[],
+		 const struct rte_flow_action actions[],
+		 struct rte_flow *flow,
+		 struct rte_flow_error *error)
+{
+	struct ixgbe_hw *hw = IXGBE_DEV_PRIVATE_TO_HW(dev->data->dev_private);
+	const struct rte_flow_item *item;
+	uint16_t queue = 0;
+	int ret;
+
+	ret = ixgbe_flow_parse_attr(attr, error);
+	if (ret)
+		return ret;
+	if (pattern == NULL)
+		return rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_ITEM_NUM, NULL,
+				"NULL pattern");
+	ret = ixgbe_flow_parse_actions(dev, actions, &queue, error);
+	if (ret)
+		return ret;
+
+	memset(flow, 0, sizeof(*flow));
+	item = ixgbe_flow_next_item(pattern);
+	if (item->type == RTE_FLOW_ITEM_TYPE_ETH && item->spec != NULL) {
+		flow->filter_type = RTE_ETH_FILTER_ETHERTYPE;
+		ret = ixgbe_flow_parse_ethertype(item,
+				&flow->filter.ethertype, error);
+		flow->filter.ethertype.queue = queue;
+	} else {
+		/* an empty ETH item matches any Ethernet frame */
+		if (item->type == RTE_FLOW_ITEM_TYPE_ETH) {
+			if (item->last != NULL || item->mask != NULL)
+				return rte_flow_error_set(error, EINVAL,
+						RTE_FLOW_ERROR_TYPE_ITEM, item,
+						"mask without spec");
+			item = ixgbe_flow_next_item(item + 1);
+		}
+		if (ixgbe_flow_is_syn(item)) {
+			flow->filter_type = RTE_ETH_FILTER_SYN;
+			ret = ixgbe_flow_parse_syn(item, error);
+			flow->filter.syn.queue = queue;
+			flow->filter.syn.hig_pri = attr->priority == 0;
+		} else {
+			flow->filter_type = RTE_ETH_FILTER_NTUPLE;
+			ret = ixgbe_flow_parse_ntuple(item,
+					&flow->filter.ntuple, error);
+			flow->filter.ntuple.queue = queue;
+		}
+	}
+	if (ret)
+		return ret;
+
+	switch (flow->filter_type) {
+	case RTE_ETH_FILTER_NTUPLE:
+		if (hw->mac.type != ixgbe_mac_82599EB &&
+		    hw->mac.type != ixgbe_mac_X540)
+			return rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ITEM, NULL,
+					"5-tuple filters are not supported"
+					" by this device");
+		/* 5-tuple priorities go from 1 (lowest) to 7 (highest) */
+		if (attr->priority >
+		    IXGBE_5TUPLE_MAX_PRI - IXGBE_5TUPLE_MIN_PRI)
+			return rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ATTR_PRIORITY,
+					attr, "priority out of range");
+		flow->filter.ntuple.priority =
+			IXGBE_5TUPLE_MAX_PRI - attr->priority;
+		break;
+	default:
+		if (hw->mac.type != ixgbe_mac_82599EB &&
+		    hw->mac.type != ixgbe_mac_X540 &&
+		    hw->mac.type != ixgbe_mac_X550 &&
+		    hw->mac.type != ixgbe_mac_X550EM_x &&
+		    hw->mac.type != ixgbe_mac_X550EM_a)
+			return rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ITEM, NULL,
+					"filters are not supported"
+					" by this device");
+		if (flow->filter_type == RTE_ETH_FILTER_ETHERTYPE &&
+		    attr->priority)
+			return rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ATTR_PRIORITY,
+					attr, "priority out of range");
+		break;
+	}
+	return 0;
+}
+
+/*
+ * 5-tuple filters are all removed from the device when the port is
+ * stopped, so 5-tuple rules are only programmed while the port is started
+ * and ixgbe_flow_restore() reprograms them on the next start.
+ */
+static inline int
+ixgbe_flow_programmed(struct rte_eth_dev *dev, struct rte_flow *flow)
+{
+	return flow->filter_type != RTE_ETH_FILTER_NTUPLE ||
+		dev->data->dev_started;
+}
+
+/* Program or remove the legacy filter of a rule. */
+static int
+ixgbe_flow_apply(struct rte_eth_dev *dev, struct rte_flow *flow, bool add)
+{
+	if (!ixgbe_flow_programmed(dev, flow))
+		return 0;
+
+	switch (flow->filter_type) {
+	case RTE_ETH_FILTER_ETHERTYPE:
+		return ixgbe_add_del_ethertype_filter(dev,
+				&flow->filter.ethertype, add);
+	case RTE_ETH_FILTER_SYN:
+		return ixgbe_syn_filter_set(dev, &flow->filter.syn, add);
+	case RTE_ETH_FILTER_NTUPLE:
+		return ixgbe_add_del_ntuple_filter(dev,
+				&flow->filter.ntuple, add);
+	default:
+		return -EINVAL;
+	}
+}
+
+static int
+ixgbe_flow_validate(struct rte_eth_dev *dev,
+		    const struct rte_flow_attr *attr,
+		    const struct rte_flow_item pattern[],
+		    const struct rte_flow_action actions[],
+		    struct rte_flow_error *error)
+{
+	struct rte_flow flow;
+
+	return ixgbe_flow_parse(dev, attr, pattern, actions, &flow, error);
+}
+
+static struct rte_flow *
+ixgbe_flow_create(struct rte_eth_dev *dev,
+		  const struct rte_flow_attr *attr,
+		  const struct rte_flow_item pattern[],
+		  const struct rte_flow_action actions[],
+		  struct rte_flow_error *error)
+{
+	struct ixgbe_filter_info *filter_info =
+		IXGBE_DEV_PRIVATE_TO_FILTER_INFO(dev->data->dev_private);
+	struct rte_flow *flow;
+	int ret;
+
+	flow = rte_zmalloc("ixgbe_flow", sizeof(*flow), 0);
+	if (flow == NULL) {
+		rte_flow_error_set(error, ENOMEM,
+				   RTE_FLOW_ERROR_TYPE_HANDLE, NULL,
+				   "cannot allocate flow rule");
+		return NULL;
+	}
+	ret = ixgbe_flow_parse(dev, attr, pattern, actions, flow, error);
+	if (ret)
+		goto error;
+	ret = ixgbe_flow_apply(dev, flow, TRUE);
+	if (ret) {
+		rte_flow_error_set(error, -ret,
+				   RTE_FLOW_ERROR_TYPE_HANDLE, NULL,
+				   "cannot program the filter");
+		goto error;
+	}
+	TAILQ_INSERT_TAIL(&filter_info->flow_list, flow, next);
+	return flow;
+
+error:
+	rte_free(flow);
+	return NULL;
+}
+
+static int
+ixgbe_flow_destroy(struct rte_eth_dev *dev,
+		   struct rte_flow *flow,
+		   struct rte_flow_error *error)
+{
+	struct ixgbe_filter_info *filter_info =
+		IXGBE_DEV_PRIVATE_TO_FILTER_INFO(dev->data->dev_private);
+	int ret;
+
+	ret = ixgbe_flow_apply(dev, flow, FALSE);
+	if (ret)
+		return rte_flow_error_set(error, -ret,
+				RTE_FLOW_ERROR_TYPE_HANDLE, flow,
+				"cannot remove the filter");
+	TAILQ_REMOVE(&filter_info->flow_list, flow, next);
+	rte_free(flow);
+	return 0;
+}
+
+static int
+ixgbe_flow_flush(struct rte_eth_dev *dev,
+		 struct rte_flow_error *error)
+{
+	struct ixgbe_filter_info *filter_info =
+		IXGBE_DEV_PRIVATE_TO_FILTER_INFO(dev->data->dev_private);
+	struct rte_flow *flow;
+	int ret;
+
+	while ((flow = TAILQ_LAST(&filter_info->flow_list,
+				  ixgbe_flow_list)) != NULL) {
+		ret = ixgbe_flow_destroy(dev, flow, error);
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+/* Reprogram the 5-tuple rules of a port being started. */
+int
+ixgbe_flow_restore(struct rte_eth_dev *dev)
+{
+	struct ixgbe_filter_info *filter_info =
+		IXGBE_DEV_PRIVATE_TO_FILTER_INFO(dev->data->dev_private);
+	struct rte_flow *flow;
+	int ret;
+
+	TAILQ_FOREACH(flow, &filter_info->flow_list, next) {
+		if (flow->filter_type != RTE_ETH_FILTER_NTUPLE)
+			continue;
+		ret = ixgbe_add_del_ntuple_filter(dev, &flow->filter.ntuple,
+						  TRUE);
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+/*
+ * Remove all the rules of a port being closed, ignoring errors since the
+ * device is reset anyway.
+ */
+void
+ixgbe_flow_list_free(struct rte_eth_dev *dev)
+{
+	struct ixgbe_filter_info *filter_info =
+		IXGBE_DEV_PRIVATE_TO_FILTER_INFO(dev->data->dev_private);
+	struct rte_flow *flow;
+
+	while ((flow = TAILQ_FIRST(&filter_info->flow_list)) != NULL) {
+		ixgbe_flow_apply(dev, flow, FALSE);
+		TAILQ_REMOVE(&filter_info->flow_list, flow, next);
+		rte_free(flow);
+	}
+}
+
+const struct rte_flow_ops ixgbe_flow_ops = {
+	.validate = ixgbe_flow_validate,
+	.create = ixgbe_flow_create,
+	.destroy = ixgbe_flow_destroy,
+	.flush = ixgbe_flow_flush,
+	.query = NULL,
+};
@@ -57,6 +57,8 @@
 #define	IXGBE_MAX_RING_DESC	4096
 
 #define RTE_PMD_IXGBE_TX_MAX_BURST 32
+/* Max data descriptors of a packet, TSO or not, including WTHRESH */
+#define IXGBE_TX_MAX_SEG 40
 #define RTE_PMD_IXGBE_RX_MAX_BURST 32
 #define RTE_IXGBE_TX_MAX_FREE_BUF_SZ 64
 
@@ -577,59 +577,6 @@ em_check_ptype(int portid)
 	return 0;
 }
 
-static inline void
-em_parse_ptype(struct rte_mbuf *m)
-{
-	struct ether_hdr *eth_hdr;
-	uint32_t packet_type = RTE_PTYPE_UNKNOWN;
-	uint16_t ether_type;
-	void *l3;
-	int hdr_len;
-	struct ipv4_hdr *ipv4_hdr;
-	struct ipv6_hdr *ipv6_hdr;
-
-	eth_hdr = rte_pktmbuf_mtod(m, struct ether_hdr *);
-	ether_type = eth_hdr->ether_type;
-	l3 = (uint8_t *)eth_hdr + sizeof(struct ether_hdr);
-	if (ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv4)) {
-		ipv4_hdr = (struct ipv4_hdr *)l3;
-		hdr_len = (ipv4_hdr->version_ihl & IPV4_HDR_IHL_MASK) *
-			  IPV4_IHL_MULTIPLIER;
-		if (hdr_len == sizeof(struct ipv4_hdr)) {
-			packet_type |= RTE_PTYPE_L3_IPV4;
-			if (ipv4_hdr->next_proto_id == IPPROTO_TCP)
-				packet_type |= RTE_PTYPE_L4_TCP;
-			else if (ipv4_hdr->next_proto_id == IPPROTO_UDP)
-				packet_type |= RTE_PTYPE_L4_UDP;
-		} else
-			packet_type |= RTE_PTYPE_L3_IPV4_EXT;
-	} else if (ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv4)) {
-		ipv6_hdr = (struct ipv6_hdr *)l3;
-		if (ipv6_hdr->proto == IPPROTO_TCP)
-			packet_type |= RTE_PTYPE_L3_IPV6 | RTE_PTYPE_L4_TCP;
-		else if (ipv6_hdr->proto == IPPROTO_UDP)
-			packet_type |= RTE_PTYPE_L3_IPV6 | RTE_PTYPE_L4_UDP;
-		else
-			packet_type |= RTE_PTYPE_L3_IPV6_EXT_UNKNOWN;
-	}
-
-	m->packet_type = packet_type;
-}
-
-uint16_t
-em_cb_parse_ptype(uint8_t port __rte_unused, uint16_t queue __rte_unused,
-		  struct rte_mbuf *pkts[], uint16_t nb_pkts,
-		  uint16_t max_pkts __rte_unused,
-		  void *user_param __rte_unused)
-{
-	unsigned i;
-
-	for (i = 0; i < nb_pkts; ++i)
-		em_parse_ptype(pkts[i]);
-
-	return nb_pkts;
-}
-
 /* main processing loop */
 int
 em_main_loop(__attribute__((unused)) void *dummy)
@@ -311,37 +311,6 @@ lpm_check_ptype(int portid)
 
 }
 
-static inline void
-lpm_parse_ptype(struct rte_mbuf *m)
-{
-	struct ether_hdr *eth_hdr;
-	uint32_t packet_type = RTE_PTYPE_UNKNOWN;
-	uint16_t ether_type;
-
-	eth_hdr = rte_pktmbuf_mtod(m, struct ether_hdr *);
-	ether_type = eth_hdr->ether_type;
-	if (ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv4))
-		packet_type |= RTE_PTYPE_L3_IPV4_EXT_UNKNOWN;
-	else if (ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv6))
-		packet_type |= RTE_PTYPE_L3_IPV6_EXT_UNKNOWN;
-
-	m->packet_type = packet_type;
-}
-
-uint16_t
-lpm_cb_parse_ptype(uint8_t port __rte_unused, uint16_t queue __rte_unused,
-		   struct rte_mbuf *pkts[], uint16_t nb_pkts,
-		   uint16_t max_pkts __rte_unused,
-		   void *user_param __rte_unused)
-{
-	unsigned i;
-
-	for (i = 0; i < nb_pkts; ++i)
-		lpm_parse_ptype(pkts[i]);
-
-	return nb_pkts;
-}
-
 /* Return ipv4/ipv6 lpm fwd lookup struct. */
 void *
 lpm_get_ipv4_l3fwd_lookup_struct(const int socketid)
@@ -72,6 +72,7 @@
 #include <rte_ip.h>
 #include <rte_tcp.h>
 #include <rte_udp.h>
+#include <rte_net.h>
 #include <rte_string_fns.h>
 #include <rte_cpuflags.h>
 
@@ -175,7 +176,6 @@ static struct rte_mempool * pktmbuf_pool[NB_SOCKETS];
 struct l3fwd_lkp_mode {
 	void  (*setup)(int);
 	int   (*check_ptype)(int);
-	rte_rx_callback_fn cb_parse_ptype;
 	int   (*main_loop)(void *);
 	void* (*get_ipv4_lookup_struct)(int);
 	void* (*get_ipv6_lookup_struct)(int);
@@ -186,7 +186,6 @@ static struct l3fwd_lkp_mode l3fwd_lkp;
 static struct l3fwd_lkp_mode l3fwd_em_lkp = {
 	.setup                  = setup_hash,
 	.check_ptype		= em_check_ptype,
-	.cb_parse_ptype		= em_cb_parse_ptype,
 	.main_loop              = em_main_loop,
 	.get_ipv4_lookup_struct = em_get_ipv4_l3fwd_lookup_struct,
 	.get_ipv6_lookup_struct = em_get_ipv6_l3fwd_lookup_struct,
@@ -195,7 +194,6 @@ static struct l3fwd_lkp_mode l3fwd_em_lkp = {
 static struct l3fwd_lkp_mode l3fwd_lpm_lkp = {
 	.setup                  = setup_lpm,
 	.check_ptype		= lpm_check_ptype,
-	.cb_parse_ptype		= lpm_cb_parse_ptype,
 	.main_loop              = lpm_main_loop,
 	.get_ipv4_lookup_struct = lpm_get_ipv4_l3fwd_lookup_struct,
 	.get_ipv6_lookup_struct = lpm_get_ipv6_l3fwd_lookup_struct,
@@ -820,7 +818,7 @@ prepare_ptype_parser(uint8_t portid, uint16_t queueid)
 	if (parse_ptype) {
 		printf("Port %d: softly parse packet type info\n", portid);
 		if (rte_eth_add_rx_callback(portid, queueid,
-					    l3fwd_lkp.cb_parse_ptype,
+					    rte_net_ptype_rx_callback,
 					    NULL))
 			return 1;
 
@@ -0,0 +1,183 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_malloc.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_metrics.h>
+
+#include "rte_bitrate.h"
+
+/* metric names, in the order of the values published */
+static const char * const bitrate_names[] = {
+	"mean_bits_in", "mean_bits_out",
+	"ewma_bits_in", "ewma_bits_out",
+	"peak_bits_in", "peak_bits_out",
+};
+
+enum {
+	BITRATE_MEAN_IN,
+	BITRATE_MEAN_OUT,
+	BITRATE_EWMA_IN,
+	BITRATE_EWMA_OUT,
+	BITRATE_PEAK_IN,
+	BITRATE_PEAK_OUT,
+	BITRATE_NB_STATS
+};
+
+/* bitrate state of a port */
+struct rte_stats_bitrate {
+	uint64_t first_tsc;
+	uint64_t first_ibytes;
+	uint64_t first_obytes;
+	uint64_t last_tsc;
+	uint64_t last_ibytes;
+	uint64_t last_obytes;
+	uint64_t rates[BITRATE_NB_STATS];
+};
+
+struct rte_stats_bitrates {
+	struct rte_stats_bitrate port_stats[RTE_MAX_ETHPORTS];
+	int id_stats_set; /* key of the first metric, -1 until registered */
+};
+
+struct rte_stats_bitrates *
+rte_stats_bitrate_create(void)
+{
+	struct rte_stats_bitrates *bitrate_data;
+
+	bitrate_data = rte_zmalloc(NULL, sizeof(*bitrate_data), 0);
+	if (bitrate_data != NULL)
+		bitrate_data->id_stats_set = -1;
+
+	return bitrate_data;
+}
+
+void
+rte_stats_bitrate_free(struct rte_stats_bitrates *bitrate_data)
+{
+	rte_free(bitrate_data);
+}
+
+int
+rte_stats_bitrate_reg(struct rte_stats_bitrates *bitrate_data)
+{
+	int ret;
+
+	RTE_BUILD_BUG_ON(RTE_DIM(bitrate_names) != BITRATE_NB_STATS);
+
+	if (bitrate_data == NULL)
+		return -EINVAL;
+
+	ret = rte_metrics_reg_names(bitrate_names, RTE_DIM(bitrate_names));
+	if (ret < 0)
+		return ret;
+	bitrate_data->id_stats_set = ret;
+
+	return 0;
+}
+
+/* bits per second for a byte count over a number of cycles */
+static inline uint64_t
+bitrate_get(uint64_t bytes, uint64_t cycles, uint64_t hz)
+{
+	return (uint64_t)((double)bytes * 8 * hz / cycles);
+}
+
+static inline void
+bitrate_update(uint64_t *rates, int dir, uint64_t rate, uint64_t mean)
+{
+	int64_t delta;
+
+	rates[BITRATE_MEAN_IN + dir] = mean;
+	if (rate > rates[BITRATE_PEAK_IN + dir])
+		rates[BITRATE_PEAK_IN + dir] = rate;
+
+	/* the +-50 rounds the division to the nearest integer */
+	delta = (int64_t)(rate - rates[BITRATE_EWMA_IN + dir]);
+	if (delta > 0)
+		delta = (delta * RTE_STATS_BITRATE_EWMA_PERCENT + 50) / 100;
+	else
+		delta = (delta * RTE_STATS_BITRATE_EWMA_PERCENT - 50) / 100;
+	rates[BITRATE_EWMA_IN + dir] += delta;
+}
+
+int
+rte_stats_bitrate_calc(struct rte_stats_bitrates *bitrate_data,
+		uint8_t port_id)
+{
+	struct rte_stats_bitrate *p;
+	struct rte_eth_stats eth_stats;
+	uint64_t now, hz, cycles, elapsed;
+	int ret;
+
+	if (bitrate_data == NULL || bitrate_data->id_stats_set < 0 ||
+			port_id >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+
+	ret = rte_eth_stats_get(port_id, &eth_stats);
+	if (ret < 0)
+		return ret;
+	now = rte_rdtsc();
+	hz = rte_get_tsc_hz();
+
+	p = &bitrate_data->port_stats[port_id];
+	/* first call, or the counters were reset: restart the mean */
+	if (p->first_tsc == 0 || eth_stats.ibytes < p->last_ibytes ||
+			eth_stats.obytes < p->last_obytes) {
+		p->first_tsc = now;
+		p->first_ibytes = eth_stats.ibytes;
+		p->first_obytes = eth_stats.obytes;
+	} else if (now > p->last_tsc) {
+		cycles = now - p->last_tsc;
+		elapsed = now - p->first_tsc;
+		bitrate_update(p->rates, 0,
+			bitrate_get(eth_stats.ibytes - p->last_ibytes,
+				cycles, hz),
+			bitrate_get(eth_stats.ibytes - p->first_ibytes,
+				elapsed, hz));
+		bitrate_update(p->rates, 1,
+			bitrate_get(eth_stats.obytes - p->last_obytes,
+				cycles, hz),
+			bitrate_get(eth_stats.obytes - p->first_obytes,
+				elapsed, hz));
+	}
+	p->last_tsc = now;
+	p->last_ibytes = eth_stats.ibytes;
+	p->last_obytes = eth_stats.obytes;
+
+	return rte_metrics_update_values(port_id, bitrate_data->id_stats_set,
+			p->rates, BITRATE_NB_STATS);
+}
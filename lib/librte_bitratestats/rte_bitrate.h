@@ -0,0 +1,120 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_BITRATE_H_
+#define _RTE_BITRATE_H_
+
+/**
+ * @file
+ * RTE bitrate statistics
+ *
+ * Computes the bitrates of the ports from their byte counters and publishes
+ * them in the metrics registry, so that monitoring tools do not need to
+ * poll the counters twice. For each port and direction, the following
+ * metrics are published, in bits per second:
+ *
+ * - mean_bits_in / mean_bits_out: mean since the first calculation;
+ * - ewma_bits_in / ewma_bits_out: exponentially weighted moving average of
+ *   the bitrates of the calculation intervals, with a weight of
+ *   RTE_STATS_BITRATE_EWMA_PERCENT percent for the latest interval;
+ * - peak_bits_in / peak_bits_out: highest bitrate of an interval.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Weight of the latest interval in the moving average, in percent. */
+#define RTE_STATS_BITRATE_EWMA_PERCENT 20
+
+/** Bitrate calculation state of all ports. */
+struct rte_stats_bitrates;
+
+/**
+ * Allocates a bitrate calculation state.
+ *
+ * @return
+ *  The state, or NULL if it cannot be allocated.
+ */
+struct rte_stats_bitrates *
+rte_stats_bitrate_create(void);
+
+/**
+ * Frees a bitrate calculation state. The metrics stay registered.
+ *
+ * @param bitrate_data
+ *  State returned by rte_stats_bitrate_create().
+ */
+void
+rte_stats_bitrate_free(struct rte_stats_bitrates *bitrate_data);
+
+/**
+ * Registers the bitrate metrics. rte_metrics_init() must have been called.
+ *
+ * @param bitrate_data
+ *  State returned by rte_stats_bitrate_create().
+ *
+ * @return
+ *  0 on success, or the error returned by rte_metrics_reg_names().
+ */
+int
+rte_stats_bitrate_reg(struct rte_stats_bitrates *bitrate_data);
+
+/**
+ * Updates the bitrates of a port from its statistics and publishes them.
+ *
+ * It is meant to be called periodically, typically once per second, by a
+ * single thread for a given state. The first call for a port only records
+ * its counters, and publishes null bitrates. The intervals are measured
+ * with the TSC, so the calls need not be exactly periodic.
+ *
+ * @param bitrate_data
+ *  State returned by rte_stats_bitrate_create(), registered with
+ *  rte_stats_bitrate_reg().
+ * @param port_id
+ *  Port to update.
+ *
+ * @return
+ *  0 on success, -EINVAL on invalid arguments, or the error returned by
+ *  rte_eth_stats_get() or rte_metrics_update_values().
+ */
+int
+rte_stats_bitrate_calc(struct rte_stats_bitrates *bitrate_data,
+		uint8_t port_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_BITRATE_H_ */
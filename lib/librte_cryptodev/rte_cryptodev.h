@@ -48,6 +48,9 @@ extern "C" {
 #include "rte_kvargs.h"
 #include "rte_crypto.h"
 #include "rte_dev.h"
+#ifdef RTE_JOBSTATS_LCORE_BUSY
+#include <rte_jobstats_lcore.h>
+#endif
 
 #define CRYPTODEV_NAME_NULL_PMD		cryptodev_null_pmd
 /**< Null crypto PMD device name */
@@ -714,6 +717,10 @@ rte_cryptodev_dequeue_burst(uint8_t dev_id, uint16_t qp_id,
 	nb_ops = (*dev->dequeue_burst)
 			(dev->data->queue_pairs[qp_id], ops, nb_ops);
 
+#ifdef RTE_JOBSTATS_LCORE_BUSY
+	rte_jobstats_lcore_poll(nb_ops);
+#endif
+
 	return nb_ops;
 }
 
@@ -473,6 +473,12 @@ int rte_eal_has_hugepages(void)
 	return !internal_config.no_hugetlbfs;
 }
 
+/* return non-zero if the heaps can grow at runtime. */
+int rte_eal_has_dyn_mem(void)
+{
+	return rte_eal_dynmem_page_size() != 0;
+}
+
 /* Abstraction for port I/0 privilege */
 int
 rte_eal_iopl_init(void)
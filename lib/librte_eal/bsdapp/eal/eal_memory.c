@@ -36,6 +36,7 @@
 #include <sys/sysctl.h>
 #include <inttypes.h>
 #include <fcntl.h>
+#include <errno.h>
 
 #include <rte_eal.h>
 #include <rte_eal_memconfig.h>
@@ -192,3 +193,35 @@ error:
 		close(fd_hugepage);
 	return -1;
 }
+
+/* contigmem buffers are reserved at boot, the heaps cannot grow */
+int
+rte_eal_dynmem_init(void)
+{
+	return 0;
+}
+
+uint64_t
+rte_eal_dynmem_page_size(void)
+{
+	return 0;
+}
+
+int
+rte_eal_dynmem_contains(const void *addr __rte_unused)
+{
+	return 0;
+}
+
+int
+rte_eal_dynmem_grow(int socket_id __rte_unused, size_t len __rte_unused,
+		struct rte_memseg **segs __rte_unused,
+		unsigned max_segs __rte_unused)
+{
+	return -ENOTSUP;
+}
+
+void
+rte_eal_dynmem_release(struct rte_memseg *ms __rte_unused)
+{
+}
@@ -36,6 +36,7 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <inttypes.h>
+#include <errno.h>
 #include <sys/queue.h>
 
 #include <rte_memory.h>
@@ -43,6 +44,7 @@
 #include <rte_eal.h>
 #include <rte_eal_memconfig.h>
 #include <rte_log.h>
+#include <rte_spinlock.h>
 
 #include "eal_private.h"
 #include "eal_internal_cfg.h"
@@ -94,6 +96,10 @@ rte_dump_physmem_layout(FILE *f)
 		if (mcfg->memseg[i].addr == NULL)
 			break;
 
+		/* segment released at runtime */
+		if (mcfg->memseg[i].len == 0)
+			continue;
+
 		fprintf(f, "Segment %u: phys:0x%"PRIx64", len:%zu, "
 		       "virt:%p, socket_id:%"PRId32", "
 		       "hugepage_sz:%"PRIu64", nchannel:%"PRIx32", "
@@ -120,6 +126,78 @@ unsigned rte_memory_get_nrank(void)
 	return rte_eal_get_configuration()->mem_config->nrank;
 }
 
+/* memory event callback, see rte_mem_event_callback_register() */
+struct mem_event_callback {
+	TAILQ_ENTRY(mem_event_callback) next;
+	rte_mem_event_callback_t cb;
+	void *arg;
+};
+
+TAILQ_HEAD(mem_event_callback_list, mem_event_callback);
+
+static struct mem_event_callback_list mem_event_callbacks =
+	TAILQ_HEAD_INITIALIZER(mem_event_callbacks);
+static rte_spinlock_t mem_event_lock = RTE_SPINLOCK_INITIALIZER;
+
+int
+rte_mem_event_callback_register(rte_mem_event_callback_t cb, void *arg)
+{
+	struct mem_event_callback *entry;
+
+	if (cb == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&mem_event_lock);
+	TAILQ_FOREACH(entry, &mem_event_callbacks, next) {
+		if (entry->cb == cb && entry->arg == arg) {
+			rte_spinlock_unlock(&mem_event_lock);
+			return -EEXIST;
+		}
+	}
+
+	entry = malloc(sizeof(*entry));
+	if (entry == NULL) {
+		rte_spinlock_unlock(&mem_event_lock);
+		return -ENOMEM;
+	}
+	entry->cb = cb;
+	entry->arg = arg;
+	TAILQ_INSERT_TAIL(&mem_event_callbacks, entry, next);
+	rte_spinlock_unlock(&mem_event_lock);
+
+	return 0;
+}
+
+int
+rte_mem_event_callback_unregister(rte_mem_event_callback_t cb, void *arg)
+{
+	struct mem_event_callback *entry;
+
+	rte_spinlock_lock(&mem_event_lock);
+	TAILQ_FOREACH(entry, &mem_event_callbacks, next) {
+		if (entry->cb == cb && entry->arg == arg) {
+			TAILQ_REMOVE(&mem_event_callbacks, entry, next);
+			rte_spinlock_unlock(&mem_event_lock);
+			free(entry);
+			return 0;
+		}
+	}
+	rte_spinlock_unlock(&mem_event_lock);
+
+	return -ENOENT;
+}
+
+void
+rte_eal_mem_event_notify(enum rte_mem_event event, const struct rte_memseg *ms)
+{
+	struct mem_event_callback *entry;
+
+	rte_spinlock_lock(&mem_event_lock);
+	TAILQ_FOREACH(entry, &mem_event_callbacks, next)
+		entry->cb(event, ms, entry->arg);
+	rte_spinlock_unlock(&mem_event_lock);
+}
+
 static int
 rte_eal_memdevice_init(void)
 {
@@ -139,11 +217,22 @@ rte_eal_memdevice_init(void)
 int
 rte_eal_memory_init(void)
 {
+	int retval;
+
 	RTE_LOG(DEBUG, EAL, "Setting up physically contiguous memory...\n");
 
-	const int retval = rte_eal_process_type() == RTE_PROC_PRIMARY ?
-			rte_eal_hugepage_init() :
-			rte_eal_hugepage_attach();
+	if (rte_eal_process_type() == RTE_PROC_PRIMARY) {
+		retval = rte_eal_hugepage_init();
+		/* the runtime growth area is reserved after the hugepages */
+		if (retval == 0)
+			retval = rte_eal_dynmem_init();
+	} else {
+		/* a secondary process needs the growth area before attaching
+		 * to the memory segments, they are not mapped the same way */
+		retval = rte_eal_dynmem_init();
+		if (retval == 0)
+			retval = rte_eal_hugepage_attach();
+	}
 	if (retval < 0)
 		return -1;
 
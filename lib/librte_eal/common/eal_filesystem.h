@@ -84,8 +84,26 @@ eal_hugepage_info_path(void)
 	return buffer;
 }
 
+/** Path of the runtime memory growth config file. */
+#define DYNMEM_CONFIG_FMT "%s/.%s_dynmem_config"
+
+static inline const char *
+eal_dynmem_config_path(void)
+{
+	static char buffer[PATH_MAX]; /* static so auto-zeroed */
+	const char *directory = default_config_dir;
+	const char *home_dir = getenv("HOME");
+
+	if (getuid() != 0 && home_dir != NULL)
+		directory = home_dir;
+	snprintf(buffer, sizeof(buffer) - 1, DYNMEM_CONFIG_FMT, directory,
+			internal_config.hugefile_prefix);
+	return buffer;
+}
+
 /** String format for hugepage map files. */
 #define HUGEFILE_FMT "%s/%smap_%d"
+#define DYN_HUGEFILE_FMT "%s/%smap_dyn"
 #define TEMP_HUGEFILE_FMT "%s/%smap_temp_%d"
 
 static inline const char *
@@ -97,6 +115,15 @@ eal_get_hugefile_path(char *buffer, size_t buflen, const char *hugedir, int f_id
 	return buffer;
 }
 
+static inline const char *
+eal_get_dyn_hugefile_path(char *buffer, size_t buflen, const char *hugedir)
+{
+	snprintf(buffer, buflen, DYN_HUGEFILE_FMT, hugedir,
+			internal_config.hugefile_prefix);
+	buffer[buflen - 1] = '\0';
+	return buffer;
+}
+
 #ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
 static inline const char *
 eal_get_hugefile_temp_path(char *buffer, size_t buflen, const char *hugedir, int f_id)
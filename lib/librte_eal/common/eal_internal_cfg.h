@@ -72,6 +72,9 @@ struct internal_config {
 										* instead of native TSC */
 	volatile unsigned no_shconf;      /**< true if there is no shared config */
 	volatile unsigned create_uio_dev; /**< true to create /dev/uioX devices */
+	volatile unsigned fast_huge_init; /**< true to fault hugepages in parallel */
+	volatile unsigned iova_va;        /**< true to use virtual addresses as IOVA */
+	volatile size_t dyn_mem;          /**< memory the heaps may grow by at runtime */
 	volatile enum rte_proc_type_t process_type; /**< multi-process proc type */
 	/** true to try allocating memory on specific sockets */
 	volatile unsigned force_sockets;
@@ -35,6 +35,7 @@
 #define _EAL_PRIVATE_H_
 
 #include <stdio.h>
+#include <rte_memory.h>
 #include <rte_pci.h>
 
 /**
@@ -325,6 +326,70 @@ int rte_eal_hugepage_init(void);
  */
 int rte_eal_hugepage_attach(void);
 
+/**
+ * Reserve the virtual area used to grow the malloc heaps at runtime in
+ * the primary process, or map it in a secondary process.
+ *
+ * This function is private to the EAL.
+ *
+ * @return
+ *   0 on success (also when the heaps cannot grow), negative on error.
+ */
+int rte_eal_dynmem_init(void);
+
+/**
+ * Get the page size used to grow the malloc heaps at runtime.
+ *
+ * This function is private to the EAL.
+ *
+ * @return
+ *   The page size, or 0 if the heaps cannot grow.
+ */
+uint64_t rte_eal_dynmem_page_size(void);
+
+/**
+ * Check if an address belongs to memory added at runtime.
+ *
+ * This function is private to the EAL.
+ */
+int rte_eal_dynmem_contains(const void *addr);
+
+/**
+ * Map new hugepages on a socket and describe them as memory segments,
+ * one per physically contiguous block.
+ *
+ * This function is private to the EAL.
+ *
+ * @param socket_id
+ *   The socket the memory must be allocated on.
+ * @param len
+ *   The minimum amount of memory, rounded up to the page size.
+ * @param segs
+ *   Array filled with the new memory segments.
+ * @param max_segs
+ *   Size of the segs array.
+ * @return
+ *   The number of segments added, negative on error.
+ */
+int rte_eal_dynmem_grow(int socket_id, size_t len, struct rte_memseg **segs,
+		unsigned max_segs);
+
+/**
+ * Release the hugepages of a memory segment added at runtime back to
+ * the kernel. The segment must not be used by any heap anymore.
+ *
+ * This function is private to the EAL.
+ */
+void rte_eal_dynmem_release(struct rte_memseg *ms);
+
+/**
+ * Call the memory event callbacks registered in this process.
+ *
+ * This function is private to the EAL.
+ */
+void rte_eal_mem_event_notify(enum rte_mem_event event,
+		const struct rte_memseg *ms);
+
 /**
  * Initialize any soc init related functions if any before thread creation
   */
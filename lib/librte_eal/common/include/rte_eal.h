@@ -228,6 +228,15 @@ rte_set_application_usage_hook(rte_usage_hook_t usage_func);
  */
 int rte_eal_has_hugepages(void);
 
+/**
+ * Check if the malloc heaps can grow and shrink at runtime, which is
+ * enabled by the --dyn-mem option.
+ *
+ * @return
+ *   Nonzero if the heaps can grow at runtime.
+ */
+int rte_eal_has_dyn_mem(void);
+
 /**
  * A wrap API for syscall gettid.
  *
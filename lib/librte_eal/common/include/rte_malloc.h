@@ -276,6 +276,22 @@ rte_free(void *ptr);
 int
 rte_malloc_validate(const void *ptr, size_t *size);
 
+/**
+ * Give the memory cached by the calling lcore back to the heaps.
+ *
+ * When CONFIG_RTE_MALLOC_LCORE_CACHE_SIZE is not 0 (it is 0 by default), each
+ * lcore keeps some of the small blocks it frees, up to 4 KB, to serve its
+ * next allocations from its socket without taking the heap lock. This memory
+ * is reported as free by rte_malloc_get_socket_stats(), but is not available
+ * to other lcores, nor merged with adjacent free blocks, until it is flushed.
+ * Blocks with an alignment larger than a cache line are never cached.
+ *
+ * This function must be called from an EAL thread, it does nothing in
+ * other threads.
+ */
+void
+rte_malloc_lcore_cache_flush(void);
+
 /**
  * Get heap statistics for the specified heap.
  *
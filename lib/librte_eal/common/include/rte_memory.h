@@ -139,7 +139,8 @@ int rte_mem_lock_page(const void *virt);
  * @param virt
  *   The virtual address.
  * @return
- *   The physical address or RTE_BAD_PHYS_ADDR on error.
+ *   The physical address or RTE_BAD_PHYS_ADDR on error, including when
+ *   the page is not faulted in yet.
  */
 phys_addr_t rte_mem_virt2phy(const void *virt);
 
@@ -194,6 +195,60 @@ unsigned rte_memory_get_nchannel(void);
  */
 unsigned rte_memory_get_nrank(void);
 
+/**
+ * Memory segment events, see rte_mem_event_callback_register().
+ */
+enum rte_mem_event {
+	RTE_MEM_EVENT_ALLOC = 0, /**< Segment added at runtime. */
+	RTE_MEM_EVENT_FREE,      /**< Segment about to be released. */
+};
+
+/**
+ * Function called when a memory segment is added to, or removed from,
+ * the malloc heaps at runtime (see the --dyn-mem EAL option).
+ *
+ * It is called in the process which grows or shrinks the heap, with
+ * the segment fully described. It must not allocate or free memory
+ * from the DPDK heaps.
+ *
+ * @param event
+ *   The memory event.
+ * @param ms
+ *   The memory segment added or removed.
+ * @param arg
+ *   The user argument given at registration.
+ */
+typedef void (*rte_mem_event_callback_t)(enum rte_mem_event event,
+		const struct rte_memseg *ms, void *arg);
+
+/**
+ * Register a callback for memory segments added or removed at runtime.
+ *
+ * Devices doing DMA through an IOMMU use it to map the new segments.
+ * Callbacks are per process.
+ *
+ * @param cb
+ *   The function to call.
+ * @param arg
+ *   The argument given to the function.
+ * @return
+ *   0 on success, -EINVAL if cb is NULL, -EEXIST if the same callback
+ *   and argument are already registered, -ENOMEM on allocation failure.
+ */
+int rte_mem_event_callback_register(rte_mem_event_callback_t cb, void *arg);
+
+/**
+ * Unregister a memory event callback.
+ *
+ * @param cb
+ *   The function given at registration.
+ * @param arg
+ *   The argument given at registration.
+ * @return
+ *   0 on success, -ENOENT if the callback is not registered.
+ */
+int rte_mem_event_callback_unregister(rte_mem_event_callback_t cb, void *arg);
+
 #ifdef RTE_LIBRTE_XEN_DOM0
 
 /**< Internal use only - should DOM0 memory mapping be used */
@@ -45,6 +45,7 @@
 #include <rte_common.h>
 #include <rte_spinlock.h>
 
+#include "eal_private.h"
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 
@@ -264,17 +265,13 @@ join_elem(struct malloc_elem *elem1, struct malloc_elem *elem2)
 }
 
 /*
- * free a malloc_elem block by adding it to the free list. If the
- * blocks either immediately before or immediately after newly freed block
- * are also free, the blocks are merged together.
+ * free a malloc_elem block with the heap lock held, see malloc_elem_free().
+ * Returns 1 if its memory segment became unused and was detached from the
+ * heap, it must then be released once the lock is released.
  */
-int
-malloc_elem_free(struct malloc_elem *elem)
+static int
+elem_free(struct malloc_elem *elem)
 {
-	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY)
-		return -1;
-
-	rte_spinlock_lock(&(elem->heap->lock));
 	size_t sz = elem->size - sizeof(*elem);
 	uint8_t *ptr = (uint8_t *)&elem[1];
 	struct malloc_elem *next = RTE_PTR_ADD(elem, elem->size);
@@ -300,13 +297,65 @@ malloc_elem_free(struct malloc_elem *elem)
 	/* decrease heap's count of allocated elements */
 	elem->heap->alloc_count--;
 
+	/* memory added at runtime goes back to the kernel once unused,
+	 * it comes back zeroed when the heap grows again */
+	if (malloc_heap_detach_memseg(elem->heap, elem->ms))
+		return 1;
+
 	memset(ptr, 0, sz);
 
-	rte_spinlock_unlock(&(elem->heap->lock));
+	return 0;
+}
+
+/*
+ * free a malloc_elem block by adding it to the free list. If the
+ * blocks either immediately before or immediately after newly freed block
+ * are also free, the blocks are merged together.
+ */
+int
+malloc_elem_free(struct malloc_elem *elem)
+{
+	struct malloc_heap *heap;
+	const struct rte_memseg *ms;
+	int detached;
+
+	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY)
+		return -1;
+
+	heap = elem->heap;
+	ms = elem->ms;
+
+	rte_spinlock_lock(&heap->lock);
+	detached = elem_free(elem);
+	rte_spinlock_unlock(&heap->lock);
+
+	if (detached)
+		rte_eal_dynmem_release((struct rte_memseg *)(uintptr_t)ms);
 
 	return 0;
 }
 
+void
+malloc_elem_free_bulk(struct malloc_heap *heap, void * const *objs,
+		unsigned n)
+{
+	const struct rte_memseg *ms;
+	struct malloc_elem *elem;
+	unsigned i;
+
+	rte_spinlock_lock(&heap->lock);
+	for (i = 0; i < n; i++) {
+		elem = malloc_elem_from_data(objs[i]);
+		ms = elem->ms;
+		if (elem_free(elem)) {
+			rte_spinlock_unlock(&heap->lock);
+			rte_eal_dynmem_release((struct rte_memseg *)(uintptr_t)ms);
+			rte_spinlock_lock(&heap->lock);
+		}
+	}
+	rte_spinlock_unlock(&heap->lock);
+}
+
 /*
  * attempt to resize a malloc_elem by expanding into any free space
  * immediately after it in memory.
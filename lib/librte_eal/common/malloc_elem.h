@@ -42,7 +42,8 @@ struct malloc_heap;
 enum elem_state {
 	ELEM_FREE = 0,
 	ELEM_BUSY,
-	ELEM_PAD  /* element is a padding-only header */
+	ELEM_PAD,  /* element is a padding-only header */
+	ELEM_CACHED /* element is free in an lcore cache, busy for the heap */
 };
 
 struct malloc_elem {
@@ -170,6 +171,14 @@ malloc_elem_alloc(struct malloc_elem *elem, size_t size,
 int
 malloc_elem_free(struct malloc_elem *elem);
 
+/*
+ * free the elements of the given data pointers, all from the same heap,
+ * taking the heap lock once. The elements are not checked.
+ */
+void
+malloc_elem_free_bulk(struct malloc_heap *heap, void * const *objs,
+		unsigned n);
+
 /*
  * attempt to resize a malloc_elem by expanding into any free space
  * immediately after it in memory.
@@ -50,9 +50,13 @@
 #include <rte_memcpy.h>
 #include <rte_atomic.h>
 
+#include "eal_private.h"
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 
+/* most memory segments a single heap growth may add */
+#define MALLOC_HEAP_GROW_MAX_SEGS 8
+
 static unsigned
 check_hugepage_sz(unsigned flags, uint64_t hugepage_sz)
 {
@@ -113,6 +117,69 @@ malloc_heap_add_memseg(struct malloc_heap *heap, struct rte_memseg *ms)
 	heap->total_size += elem_size;
 }
 
+/*
+ * Remove a memory segment added at runtime from the heap if none of its
+ * memory is allocated. Called with the heap lock held, the caller then
+ * releases the segment with rte_eal_dynmem_release() once unlocked.
+ * Returns 1 if the segment was removed.
+ */
+int
+malloc_heap_detach_memseg(struct malloc_heap *heap,
+		const struct rte_memseg *ms)
+{
+	struct malloc_elem *start_elem = ms->addr;
+	struct malloc_elem *next;
+
+	if (!rte_eal_dynmem_contains(ms->addr) ||
+			start_elem->state != ELEM_FREE)
+		return 0;
+
+	/* the only element left must be followed by the end marker */
+	next = RTE_PTR_ADD(start_elem, start_elem->size);
+	if (next->size != 0)
+		return 0;
+
+	LIST_REMOVE(start_elem, free_list);
+	heap->total_size -= start_elem->size;
+
+	return 1;
+}
+
+/*
+ * Grow the heap with new memory segments, large enough for an element
+ * of the requested size and alignment.
+ * Returns the number of segments added, stored in segs.
+ */
+static int
+malloc_heap_grow(struct malloc_heap *heap, size_t size, unsigned flags,
+		size_t align, struct rte_memseg **segs)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	uint64_t hugepage_sz = rte_eal_dynmem_page_size();
+	int i, nb_segs;
+
+	if (hugepage_sz == 0)
+		return 0;
+
+	/* new memory only comes in one page size */
+	if (!check_hugepage_sz(flags, hugepage_sz) &&
+			!(flags & RTE_MEMZONE_SIZE_HINT_ONLY))
+		return 0;
+
+	nb_segs = rte_eal_dynmem_grow(heap - mcfg->malloc_heaps,
+			size + align + 2 * MALLOC_ELEM_OVERHEAD +
+			RTE_CACHE_LINE_SIZE, segs, MALLOC_HEAP_GROW_MAX_SEGS);
+	if (nb_segs <= 0)
+		return 0;
+
+	rte_spinlock_lock(&heap->lock);
+	for (i = 0; i < nb_segs; i++)
+		malloc_heap_add_memseg(heap, segs[i]);
+	rte_spinlock_unlock(&heap->lock);
+
+	return nb_segs;
+}
+
 /*
  * Iterates through the freelist for a heap to find a free element
  * which can store data of the required size and with the requested alignment.
@@ -156,7 +223,9 @@ malloc_heap_alloc(struct malloc_heap *heap,
 		const char *type __attribute__((unused)), size_t size, unsigned flags,
 		size_t align, size_t bound)
 {
+	struct rte_memseg *segs[MALLOC_HEAP_GROW_MAX_SEGS];
 	struct malloc_elem *elem;
+	int i, nb_segs = 0, nb_detached = 0;
 
 	size = RTE_CACHE_LINE_ROUNDUP(size);
 	align = RTE_CACHE_LINE_ROUNDUP(align);
@@ -164,16 +233,63 @@ malloc_heap_alloc(struct malloc_heap *heap,
 	rte_spinlock_lock(&heap->lock);
 
 	elem = find_suitable_element(heap, size, flags, align, bound);
+	if (elem == NULL && size != 0) {
+		/* map more hugepages, without holding the lock meanwhile */
+		rte_spinlock_unlock(&heap->lock);
+		nb_segs = malloc_heap_grow(heap, size, flags, align, segs);
+		rte_spinlock_lock(&heap->lock);
+		if (nb_segs > 0)
+			elem = find_suitable_element(heap, size, flags, align,
+					bound);
+	}
 	if (elem != NULL) {
 		elem = malloc_elem_alloc(elem, size, align, bound);
 		/* increase heap's count of allocated elements */
 		heap->alloc_count++;
+	} else {
+		/* the new memory did not help, e.g. not physically
+		 * contiguous: give it back */
+		for (i = 0; i < nb_segs; i++)
+			if (malloc_heap_detach_memseg(heap, segs[i]))
+				segs[nb_detached++] = segs[i];
 	}
 	rte_spinlock_unlock(&heap->lock);
 
+	for (i = 0; i < nb_detached; i++)
+		rte_eal_dynmem_release(segs[i]);
+
 	return elem == NULL ? NULL : (void *)(&elem[1]);
 }
 
+/*
+ * Allocate up to n elements of the same size, taking the heap lock once.
+ * Used to refill the lcore caches, the heap does not grow.
+ * Returns the number of elements allocated, their data is stored in objs.
+ */
+unsigned
+malloc_heap_alloc_bulk(struct malloc_heap *heap, size_t size, void **objs,
+		unsigned n)
+{
+	struct malloc_elem *elem;
+	unsigned i;
+
+	size = RTE_CACHE_LINE_ROUNDUP(size);
+
+	rte_spinlock_lock(&heap->lock);
+	for (i = 0; i < n; i++) {
+		elem = find_suitable_element(heap, size, 0,
+				RTE_CACHE_LINE_SIZE, 0);
+		if (elem == NULL)
+			break;
+		elem = malloc_elem_alloc(elem, size, RTE_CACHE_LINE_SIZE, 0);
+		heap->alloc_count++;
+		objs[i] = &elem[1];
+	}
+	rte_spinlock_unlock(&heap->lock);
+
+	return i;
+}
+
 /*
  * Function to retrieve data for heap on given socket
  */
@@ -53,15 +53,178 @@
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 
+#if RTE_MALLOC_LCORE_CACHE_SIZE > 0
+
+/* size classes of the lcore caches: powers of 2 from 64 B to 4 KB */
+#define MALLOC_CACHE_MIN_SIZE_LOG2 6
+#define MALLOC_CACHE_MAX_SIZE_LOG2 12
+#define MALLOC_CACHE_NUM_CLASSES \
+	(MALLOC_CACHE_MAX_SIZE_LOG2 - MALLOC_CACHE_MIN_SIZE_LOG2 + 1)
+/* elements moved between a cache and its heap at once */
+#define MALLOC_CACHE_BULK \
+	RTE_MAX(RTE_MALLOC_LCORE_CACHE_SIZE / 2, 1)
+
+/*
+ * Free elements of the heap of the lcore socket, kept by the lcore to
+ * serve small allocations without taking the heap lock. For the heap,
+ * they are allocated: they are refilled from it and flushed to it in
+ * bulk. They are zeroed, as free heap memory.
+ */
+struct malloc_lcore_cache {
+	unsigned count;  /**< Number of cached elements. */
+	size_t size;     /**< Heap memory of the cached elements. */
+	unsigned len[MALLOC_CACHE_NUM_CLASSES];
+	void *objs[MALLOC_CACHE_NUM_CLASSES][RTE_MALLOC_LCORE_CACHE_SIZE];
+} __rte_cache_aligned;
+
+static struct malloc_lcore_cache malloc_lcore_cache[RTE_MAX_LCORE];
+
+/* size class of an allocation, or -1 if it is too large to be cached */
+static inline int
+malloc_cache_class(size_t size)
+{
+	if (size > (1UL << MALLOC_CACHE_MAX_SIZE_LOG2))
+		return -1;
+	if (size <= (1UL << MALLOC_CACHE_MIN_SIZE_LOG2))
+		return 0;
+	return sizeof(size) * 8 - __builtin_clzl(size - 1) -
+		MALLOC_CACHE_MIN_SIZE_LOG2;
+}
+
+/* account for elements leaving the cache */
+static void
+malloc_cache_uncount(struct malloc_lcore_cache *cache, void * const *objs,
+		unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++)
+		cache->size -= malloc_elem_from_data(objs[i])->size;
+	cache->count -= n;
+}
+
+static void *
+malloc_cache_get(struct malloc_heap *heap, size_t size)
+{
+	struct malloc_lcore_cache *cache;
+	struct malloc_elem *elem;
+	unsigned i, n;
+	void *obj;
+	int cls;
+
+	cls = malloc_cache_class(size);
+	if (cls < 0)
+		return NULL;
+
+	cache = &malloc_lcore_cache[rte_lcore_id()];
+	if (cache->len[cls] == 0) {
+		n = malloc_heap_alloc_bulk(heap,
+				1UL << (cls + MALLOC_CACHE_MIN_SIZE_LOG2),
+				cache->objs[cls], MALLOC_CACHE_BULK);
+		for (i = 0; i < n; i++) {
+			elem = malloc_elem_from_data(cache->objs[cls][i]);
+			elem->state = ELEM_CACHED;
+			cache->size += elem->size;
+		}
+		cache->count += n;
+		cache->len[cls] = n;
+		if (n == 0)
+			return NULL;
+	}
+
+	obj = cache->objs[cls][--cache->len[cls]];
+	elem = malloc_elem_from_data(obj);
+	elem->state = ELEM_BUSY;
+	cache->count--;
+	cache->size -= elem->size;
+
+	return obj;
+}
+
+/*
+ * Keep a freed element in the cache of the calling lcore, if it has the
+ * exact size of a class and comes from the heap of the lcore socket.
+ * Returns 0 if it was cached.
+ */
+static int
+malloc_cache_put(struct malloc_elem *elem)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	unsigned lcore_id = rte_lcore_id();
+	struct malloc_lcore_cache *cache;
+	size_t size;
+	int cls;
+
+	if (lcore_id >= RTE_MAX_LCORE || !malloc_elem_cookies_ok(elem) ||
+			elem->state != ELEM_BUSY || elem->pad != 0 ||
+			elem->heap != &mcfg->malloc_heaps[rte_socket_id()])
+		return -1;
+
+	size = elem->size - MALLOC_ELEM_OVERHEAD;
+	cls = malloc_cache_class(size);
+	if (cls < 0 || size != 1UL << (cls + MALLOC_CACHE_MIN_SIZE_LOG2))
+		return -1;
+
+	cache = &malloc_lcore_cache[lcore_id];
+	if (cache->len[cls] == RTE_MALLOC_LCORE_CACHE_SIZE) {
+		/* give the most recently cached ones back to the heap */
+		cache->len[cls] -= MALLOC_CACHE_BULK;
+		malloc_cache_uncount(cache,
+				&cache->objs[cls][cache->len[cls]],
+				MALLOC_CACHE_BULK);
+		malloc_elem_free_bulk(elem->heap,
+				&cache->objs[cls][cache->len[cls]],
+				MALLOC_CACHE_BULK);
+	}
+
+	memset(&elem[1], 0, size);
+	elem->state = ELEM_CACHED;
+	cache->objs[cls][cache->len[cls]++] = &elem[1];
+	cache->count++;
+	cache->size += elem->size;
+
+	return 0;
+}
+
+#endif /* RTE_MALLOC_LCORE_CACHE_SIZE > 0 */
 
 /* Free the memory space back to heap */
 void rte_free(void *addr)
 {
 	if (addr == NULL) return;
+#if RTE_MALLOC_LCORE_CACHE_SIZE > 0
+	if (malloc_cache_put(malloc_elem_from_data(addr)) == 0)
+		return;
+#endif
 	if (malloc_elem_free(malloc_elem_from_data(addr)) < 0)
 		rte_panic("Fatal error: Invalid memory\n");
 }
 
+/*
+ * Give the elements cached by the calling lcore back to their heap.
+ */
+void
+rte_malloc_lcore_cache_flush(void)
+{
+#if RTE_MALLOC_LCORE_CACHE_SIZE > 0
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	unsigned lcore_id = rte_lcore_id();
+	struct malloc_lcore_cache *cache;
+	int cls;
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return;
+
+	cache = &malloc_lcore_cache[lcore_id];
+	for (cls = 0; cls < MALLOC_CACHE_NUM_CLASSES; cls++) {
+		malloc_cache_uncount(cache, cache->objs[cls], cache->len[cls]);
+		malloc_elem_free_bulk(&mcfg->malloc_heaps[rte_socket_id()],
+				cache->objs[cls], cache->len[cls]);
+		cache->len[cls] = 0;
+	}
+#endif
+}
+
 /*
  * Allocate memory on specified heap.
  */
@@ -88,6 +251,16 @@ rte_malloc_socket(const char *type, size_t size, unsigned align, int socket_arg)
 	if (socket >= RTE_MAX_NUMA_NODES)
 		return NULL;
 
+#if RTE_MALLOC_LCORE_CACHE_SIZE > 0
+	/* small allocations on the lcore socket come from its cache */
+	if (align <= RTE_CACHE_LINE_SIZE && rte_lcore_id() < RTE_MAX_LCORE &&
+			socket == (int)rte_socket_id()) {
+		ret = malloc_cache_get(&mcfg->malloc_heaps[socket], size);
+		if (ret != NULL)
+			return ret;
+	}
+#endif
+
 	ret = malloc_heap_alloc(&mcfg->malloc_heaps[socket], type,
 				size, 0, align == 0 ? 1 : align, 0);
 	if (ret != NULL || socket_arg != SOCKET_ID_ANY)
@@ -207,7 +380,30 @@ rte_malloc_get_socket_stats(int socket,
 	if (socket >= RTE_MAX_NUMA_NODES || socket < 0)
 		return -1;
 
-	return malloc_heap_get_stats(&mcfg->malloc_heaps[socket], socket_stats);
+	if (malloc_heap_get_stats(&mcfg->malloc_heaps[socket],
+			socket_stats) < 0)
+		return -1;
+
+#if RTE_MALLOC_LCORE_CACHE_SIZE > 0
+	{
+		unsigned lcore_id;
+
+		/* the elements cached by the lcores of this process are
+		 * free for the user, not allocated */
+		RTE_LCORE_FOREACH(lcore_id) {
+			const struct malloc_lcore_cache *cache =
+				&malloc_lcore_cache[lcore_id];
+
+			if (rte_lcore_to_socket_id(lcore_id) != (unsigned)socket)
+				continue;
+			socket_stats->heap_freesz_bytes += cache->size;
+			socket_stats->heap_allocsz_bytes -= cache->size;
+			socket_stats->alloc_count -= cache->count;
+		}
+	}
+#endif
+
+	return 0;
 }
 
 /*
@@ -344,6 +344,9 @@ eal_usage(const char *prgname)
 	       "  --"OPT_CREATE_UIO_DEV"    Create /dev/uioX (usually done by hotplug)\n"
 	       "  --"OPT_VFIO_INTR"         Interrupt mode for VFIO (legacy|msi|msix)\n"
 	       "  --"OPT_XEN_DOM0"          Support running on Xen dom0 without hugetlbfs\n"
+	       "  --"OPT_FAST_HUGE_INIT"    Fault and zero hugepages in parallel threads\n"
+	       "  --"OPT_IOVA_VA"           Use virtual addresses as IO addresses (VFIO only)\n"
+	       "  --"OPT_DYN_MEM"           Memory in MB the heaps may grow by at runtime\n"
 	       "\n");
 	/* Allow the application to print its usage message too if hook is set */
 	if ( rte_application_usage_hook ) {
@@ -444,6 +447,28 @@ eal_parse_base_virtaddr(const char *arg)
 	return 0;
 }
 
+static int
+eal_parse_dyn_mem(const char *arg)
+{
+	char *end;
+	uint64_t size;
+
+	errno = 0;
+	size = strtoull(arg, &end, 0);
+
+	/* check for errors */
+	if ((errno != 0) || (arg[0] == '\0') || end == NULL || (*end != '\0'))
+		return -1;
+
+	/* the size is given in megabytes */
+	if (size == 0 || size > SIZE_MAX / 0x100000)
+		return -1;
+
+	internal_config.dyn_mem = size * 0x100000;
+
+	return 0;
+}
+
 static int
 eal_parse_vfio_intr(const char *mode)
 {
@@ -601,6 +626,32 @@ eal_parse_args(int argc, char **argv)
 			internal_config.create_uio_dev = 1;
 			break;
 
+		case OPT_DYN_MEM_NUM:
+			if (eal_parse_dyn_mem(optarg) < 0) {
+				RTE_LOG(ERR, EAL, "invalid parameter for --"
+						OPT_DYN_MEM "\n");
+				eal_usage(prgname);
+				ret = -1;
+				goto out;
+			}
+			break;
+
+		case OPT_FAST_HUGE_INIT_NUM:
+		case OPT_IOVA_VA_NUM:
+#ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
+			RTE_LOG(ERR, EAL, "Option %s is not supported with "
+				"RTE_EAL_SINGLE_FILE_SEGMENTS=y\n",
+				eal_long_options[option_index].name);
+			ret = -1;
+			goto out;
+#else
+			if (opt == OPT_FAST_HUGE_INIT_NUM)
+				internal_config.fast_huge_init = 1;
+			else
+				internal_config.iova_va = 1;
+#endif
+			break;
+
 		default:
 			if (opt < OPT_LONG_MIN_NUM && isprint(opt)) {
 				RTE_LOG(ERR, EAL, "Option %c is not supported "
@@ -641,6 +692,26 @@ eal_parse_args(int argc, char **argv)
 		goto out;
 	}
 
+	/* --iova-va relies on an IOMMU, dom0 memory is not IOMMU mapped */
+	if (internal_config.iova_va && internal_config.xen_dom0_support) {
+		RTE_LOG(ERR, EAL, "Options --"OPT_IOVA_VA" cannot be specified "
+			"together with --"OPT_XEN_DOM0"\n");
+		eal_usage(prgname);
+		ret = -1;
+		goto out;
+	}
+
+	/* heaps can only grow with hugepages */
+	if (internal_config.dyn_mem &&
+			(internal_config.no_hugetlbfs ||
+			 internal_config.xen_dom0_support)) {
+		RTE_LOG(ERR, EAL, "Option --"OPT_DYN_MEM" cannot be specified "
+			"together with --"OPT_NO_HUGE" or --"OPT_XEN_DOM0"\n");
+		eal_usage(prgname);
+		ret = -1;
+		goto out;
+	}
+
 	if (optind >= 0)
 		argv[optind-1] = prgname;
 	ret = optind-1;
@@ -797,6 +868,11 @@ rte_eal_init(int argc, char **argv)
 		rte_panic("Cannot init VFIO\n");
 #endif
 
+	/* IO addresses are virtual addresses, only an IOMMU can handle that */
+	if (internal_config.iova_va && rte_eal_check_module("vfio") != 1)
+		RTE_LOG(WARNING, EAL, "--"OPT_IOVA_VA" is used but VFIO is "
+			"not loaded, DMA to hugepages will not work\n");
+
 #ifdef RTE_LIBRTE_IVSHMEM
 	if (rte_eal_ivshmem_init() < 0)
 		rte_panic("Cannot init IVSHMEM\n");
@@ -913,6 +989,11 @@ int rte_eal_has_hugepages(void)
 	return ! internal_config.no_hugetlbfs;
 }
 
+int rte_eal_has_dyn_mem(void)
+{
+	return rte_eal_dynmem_page_size() != 0;
+}
+
 int
 rte_eal_check_module(const char *module_name)
 {
@@ -0,0 +1,534 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Runtime growth of the malloc heaps.
+ *
+ * A virtual area of --dyn-mem bytes is reserved by the primary process
+ * and backed by a single hugetlbfs file, mapped with MAP_NORESERVE in
+ * every process at the same address. Growing a heap allocates hugepages
+ * in the file with fallocate(), on the heap socket, and describes them
+ * as new memory segments. Releasing punches a hole in the file, which
+ * gives the hugepages back to the kernel and unmaps them from all the
+ * processes at once. The state is kept in a small shared file, so that
+ * secondary processes can grow and shrink the heaps as well.
+ */
+
+#define _FILE_OFFSET_BITS 64
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/falloc.h>
+
+#include <rte_log.h>
+#include <rte_memory.h>
+#include <rte_eal.h>
+#include <rte_eal_memconfig.h>
+#include <rte_common.h>
+#include <rte_atomic.h>
+#include <rte_spinlock.h>
+
+#include "eal_private.h"
+#include "eal_internal_cfg.h"
+#include "eal_filesystem.h"
+#include "eal_hugepages.h"
+
+#define DYNMEM_MAGIC 0x64796e6d /* "dynm" */
+
+/* NUMA memory policy, not all libc export numaif.h */
+#ifndef MPOL_DEFAULT
+#define MPOL_DEFAULT 0
+#endif
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+#ifndef MPOL_F_NODE
+#define MPOL_F_NODE (1 << 0)
+#endif
+#ifndef MPOL_F_ADDR
+#define MPOL_F_ADDR (1 << 1)
+#endif
+#define DYNMEM_MAX_NODES 1024
+
+/* shared between the primary and secondary processes */
+struct dynmem_config {
+	volatile uint32_t magic;   /**< DYNMEM_MAGIC once initialized */
+	rte_spinlock_t lock;       /**< serializes grow and release */
+	uint64_t base_addr;        /**< start of the virtual area */
+	uint64_t len;              /**< length of the virtual area */
+	uint64_t hugepage_sz;      /**< page size of the backing file */
+	char filepath[MAX_HUGEPAGE_PATH]; /**< backing hugetlbfs file */
+	uint32_t nb_pages;         /**< number of pages in the area */
+	uint8_t page_used[];       /**< pages currently allocated */
+};
+
+static struct dynmem_config *dynmem_cfg;
+static int dynmem_fd = -1;
+/* local copy of the area bounds, checked on every rte_free() */
+static uintptr_t dynmem_start;
+static uintptr_t dynmem_end;
+
+static size_t
+dynmem_config_size(uint32_t nb_pages)
+{
+	return sizeof(struct dynmem_config) + nb_pages;
+}
+
+uint64_t
+rte_eal_dynmem_page_size(void)
+{
+	return dynmem_cfg == NULL ? 0 : dynmem_cfg->hugepage_sz;
+}
+
+int
+rte_eal_dynmem_contains(const void *addr)
+{
+	return (uintptr_t)addr >= dynmem_start && (uintptr_t)addr < dynmem_end;
+}
+
+/* bind the memory allocations of the calling thread to a socket */
+static int
+dynmem_bind_socket(int socket_id, int *old_mode, unsigned long *old_mask)
+{
+	unsigned long mask[DYNMEM_MAX_NODES / (8 * sizeof(unsigned long))];
+
+	if (socket_id < 0 || socket_id >= DYNMEM_MAX_NODES)
+		return -1;
+	if (syscall(SYS_get_mempolicy, old_mode, old_mask,
+			DYNMEM_MAX_NODES, NULL, 0) < 0)
+		return -1;
+
+	memset(mask, 0, sizeof(mask));
+	mask[socket_id / (8 * sizeof(unsigned long))] =
+		1UL << (socket_id % (8 * sizeof(unsigned long)));
+	if (syscall(SYS_set_mempolicy, MPOL_BIND, mask, DYNMEM_MAX_NODES) < 0)
+		return -1;
+
+	return 0;
+}
+
+static void
+dynmem_unbind_socket(int old_mode, const unsigned long *old_mask)
+{
+	if (syscall(SYS_set_mempolicy, old_mode, old_mask,
+			DYNMEM_MAX_NODES) < 0)
+		syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+}
+
+/* socket of a mapped page, or -1 if unknown */
+static int
+dynmem_page_socket(void *addr)
+{
+	int node;
+
+	if (syscall(SYS_get_mempolicy, &node, NULL, 0, addr,
+			MPOL_F_NODE | MPOL_F_ADDR) < 0)
+		return -1;
+	return node;
+}
+
+/* find a free memseg slot: never used, or released at runtime */
+static struct rte_memseg *
+dynmem_get_memseg(struct rte_mem_config *mcfg)
+{
+	unsigned i;
+
+	for (i = 0; i < RTE_MAX_MEMSEG; i++) {
+		struct rte_memseg *ms = &mcfg->memseg[i];
+
+		if (ms->addr == NULL ||
+				(ms->len == 0 && rte_eal_dynmem_contains(ms->addr)))
+			return ms;
+	}
+	return NULL;
+}
+
+/* give pages back to the kernel, called with the lock held */
+static void
+dynmem_punch(uint32_t first, uint32_t nb)
+{
+	uint64_t hugepage_sz = dynmem_cfg->hugepage_sz;
+
+	if (fallocate(dynmem_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+			first * hugepage_sz, nb * hugepage_sz) < 0)
+		RTE_LOG(ERR, EAL, "%s(): cannot release hugepages: %s\n",
+			__func__, strerror(errno));
+	memset(&dynmem_cfg->page_used[first], 0, nb);
+}
+
+int
+rte_eal_dynmem_grow(int socket_id, size_t len, struct rte_memseg **segs,
+		unsigned max_segs)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	unsigned long old_mask[DYNMEM_MAX_NODES / (8 * sizeof(unsigned long))];
+	uint64_t hugepage_sz;
+	uint32_t first, nb, i, run;
+	phys_addr_t physaddr;
+	unsigned nb_segs = 0;
+	int old_mode, bound, ret;
+	char *addr;
+
+	if (dynmem_cfg == NULL || max_segs == 0)
+		return -ENOTSUP;
+
+	hugepage_sz = dynmem_cfg->hugepage_sz;
+	nb = RTE_ALIGN_CEIL(len, hugepage_sz) / hugepage_sz;
+
+	rte_spinlock_lock(&dynmem_cfg->lock);
+
+	/* find nb free pages in a row */
+	for (first = 0, run = 0; first + run < dynmem_cfg->nb_pages; ) {
+		if (dynmem_cfg->page_used[first + run]) {
+			first += run + 1;
+			run = 0;
+		} else if (++run == nb)
+			break;
+	}
+	if (run < nb) {
+		rte_spinlock_unlock(&dynmem_cfg->lock);
+		RTE_LOG(DEBUG, EAL, "No room to grow memory by %u pages\n", nb);
+		return -ENOSPC;
+	}
+
+	/* allocate the hugepages on the right socket */
+	bound = dynmem_bind_socket(socket_id, &old_mode, old_mask) == 0;
+	ret = fallocate(dynmem_fd, 0, first * hugepage_sz, nb * hugepage_sz);
+	if (bound)
+		dynmem_unbind_socket(old_mode, old_mask);
+	if (ret < 0) {
+		ret = -errno;
+		rte_spinlock_unlock(&dynmem_cfg->lock);
+		RTE_LOG(DEBUG, EAL, "Cannot allocate %u hugepages on socket %d: "
+			"%s\n", nb, socket_id, strerror(-ret));
+		return ret;
+	}
+	memset(&dynmem_cfg->page_used[first], 1, nb);
+
+	/* fault the pages in this process, then describe each physically
+	 * contiguous block with a memory segment */
+	addr = (char *)(uintptr_t)dynmem_cfg->base_addr + first * hugepage_sz;
+	for (i = 0; i < nb; i++) {
+		char *page = addr + i * hugepage_sz;
+		struct rte_memseg *ms = nb_segs ? segs[nb_segs - 1] : NULL;
+		int page_socket;
+
+		*(volatile char *)page;
+		page_socket = dynmem_page_socket(page);
+		if (page_socket >= 0 && page_socket != socket_id) {
+			RTE_LOG(DEBUG, EAL, "Hugepage allocated on socket %d "
+				"instead of %d\n", page_socket, socket_id);
+			ret = -ENOMEM;
+			goto error;
+		}
+
+		physaddr = rte_mem_virt2phy(page);
+		if (physaddr == RTE_BAD_PHYS_ADDR) {
+			ret = -EFAULT;
+			goto error;
+		}
+
+		if (ms != NULL &&
+				ms->phys_addr + ms->len == physaddr) {
+			ms->len += hugepage_sz;
+			continue;
+		}
+
+		if (nb_segs == max_segs) {
+			ret = -E2BIG;
+			goto error;
+		}
+		ms = dynmem_get_memseg(mcfg);
+		if (ms == NULL) {
+			RTE_LOG(ERR, EAL, "Cannot grow memory, increase %s=%d\n",
+				RTE_STR(CONFIG_RTE_MAX_MEMSEG), RTE_MAX_MEMSEG);
+			ret = -ENOSPC;
+			goto error;
+		}
+		ms->phys_addr = physaddr;
+		ms->addr = page;
+		ms->hugepage_sz = hugepage_sz;
+		ms->socket_id = socket_id;
+		ms->nchannel = mcfg->nchannel;
+		ms->nrank = mcfg->nrank;
+		/* a slot with a null length is free, set it last */
+		rte_wmb();
+		ms->len = hugepage_sz;
+		segs[nb_segs++] = ms;
+	}
+
+	for (i = 0; i < nb_segs; i++)
+		rte_eal_mem_event_notify(RTE_MEM_EVENT_ALLOC, segs[i]);
+
+	rte_spinlock_unlock(&dynmem_cfg->lock);
+
+	RTE_LOG(DEBUG, EAL, "Memory grown by %u pages of %"PRIu64" MB on "
+		"socket %d, %u segments\n", nb, hugepage_sz / 0x100000,
+		socket_id, nb_segs);
+
+	return nb_segs;
+
+error:
+	for (i = 0; i < nb_segs; i++)
+		segs[i]->len = 0;
+	dynmem_punch(first, nb);
+	rte_spinlock_unlock(&dynmem_cfg->lock);
+	return ret;
+}
+
+void
+rte_eal_dynmem_release(struct rte_memseg *ms)
+{
+	uint64_t hugepage_sz;
+	uint32_t first;
+
+	if (dynmem_cfg == NULL || !rte_eal_dynmem_contains(ms->addr))
+		return;
+
+	hugepage_sz = dynmem_cfg->hugepage_sz;
+	first = RTE_PTR_DIFF(ms->addr,
+		(void *)(uintptr_t)dynmem_cfg->base_addr) / hugepage_sz;
+
+	rte_spinlock_lock(&dynmem_cfg->lock);
+
+	rte_eal_mem_event_notify(RTE_MEM_EVENT_FREE, ms);
+
+	RTE_LOG(DEBUG, EAL, "Releasing %zu MB at %p\n", ms->len / 0x100000,
+		ms->addr);
+
+	dynmem_punch(first, ms->len / hugepage_sz);
+	/* the address is kept: memseg tables end at the first NULL one */
+	ms->len = 0;
+	ms->phys_addr = 0;
+
+	rte_spinlock_unlock(&dynmem_cfg->lock);
+}
+
+static int
+dynmem_init_primary(void)
+{
+	const struct hugepage_info *hpi = NULL;
+	struct dynmem_config *cfg;
+	uint64_t hugepage_sz, len;
+	uint32_t nb_pages;
+	size_t cfg_size;
+	void *area, *addr;
+	unsigned i;
+	int fd;
+
+	/* remove the config of a previous primary process */
+	unlink(eal_dynmem_config_path());
+
+	if (internal_config.dyn_mem == 0)
+		return 0;
+
+	/* use the smallest page size, to grow and shrink finely */
+	for (i = 0; i < internal_config.num_hugepage_sizes; i++)
+		if (internal_config.hugepage_info[i].hugedir != NULL)
+			hpi = &internal_config.hugepage_info[i];
+	if (hpi == NULL) {
+		RTE_LOG(ERR, EAL, "No hugetlbfs mount to grow memory from\n");
+		return -1;
+	}
+
+	hugepage_sz = hpi->hugepage_sz;
+	len = RTE_ALIGN_CEIL(internal_config.dyn_mem, hugepage_sz);
+	nb_pages = len / hugepage_sz;
+	cfg_size = dynmem_config_size(nb_pages);
+
+	fd = open(eal_dynmem_config_path(), O_CREAT | O_RDWR, 0666);
+	if (fd < 0 || ftruncate(fd, cfg_size) < 0) {
+		RTE_LOG(ERR, EAL, "Cannot create %s: %s\n",
+			eal_dynmem_config_path(), strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return -1;
+	}
+	cfg = mmap(NULL, cfg_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (cfg == MAP_FAILED) {
+		RTE_LOG(ERR, EAL, "Cannot map %s\n", eal_dynmem_config_path());
+		return -1;
+	}
+	memset(cfg, 0, cfg_size);
+
+	eal_get_dyn_hugefile_path(cfg->filepath, sizeof(cfg->filepath),
+			hpi->hugedir);
+	fd = open(cfg->filepath, O_CREAT | O_RDWR, 0755);
+	if (fd < 0) {
+		RTE_LOG(ERR, EAL, "Cannot create %s: %s\n", cfg->filepath,
+			strerror(errno));
+		goto error;
+	}
+	/* drop the pages of a previous run, keep the file from being
+	 * removed by another primary process */
+	if (ftruncate(fd, 0) < 0 || flock(fd, LOCK_SH | LOCK_NB) < 0) {
+		RTE_LOG(ERR, EAL, "Cannot reset %s: %s\n", cfg->filepath,
+			strerror(errno));
+		goto error;
+	}
+
+	/* reserve an area aligned on the page size, then map the file in */
+	area = mmap(NULL, len + hugepage_sz, PROT_NONE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (area == MAP_FAILED) {
+		RTE_LOG(ERR, EAL, "Cannot reserve %"PRIu64" MB of virtual "
+			"memory: %s\n", len / 0x100000, strerror(errno));
+		goto error;
+	}
+	addr = RTE_PTR_ALIGN_CEIL(area, hugepage_sz);
+	/* pages are allocated when growing, not when mapping */
+	if (mmap(addr, len, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_NORESERVE | MAP_FIXED,
+			fd, 0) == MAP_FAILED) {
+		RTE_LOG(ERR, EAL, "Cannot map %s: %s\n", cfg->filepath,
+			strerror(errno));
+		munmap(area, len + hugepage_sz);
+		goto error;
+	}
+	if (addr != area)
+		munmap(area, RTE_PTR_DIFF(addr, area));
+	munmap(RTE_PTR_ADD(addr, len),
+		RTE_PTR_DIFF(RTE_PTR_ADD(area, hugepage_sz), addr));
+
+	if (internal_config.hugepage_unlink)
+		unlink(cfg->filepath);
+
+	rte_spinlock_init(&cfg->lock);
+	cfg->base_addr = (uintptr_t)addr;
+	cfg->len = len;
+	cfg->hugepage_sz = hugepage_sz;
+	cfg->nb_pages = nb_pages;
+	rte_wmb();
+	cfg->magic = DYNMEM_MAGIC;
+
+	dynmem_cfg = cfg;
+	dynmem_fd = fd;
+	dynmem_start = (uintptr_t)addr;
+	dynmem_end = dynmem_start + len;
+
+	RTE_LOG(INFO, EAL, "Heaps may grow by %"PRIu64" MB in %"PRIu64
+		" MB pages\n", len / 0x100000, hugepage_sz / 0x100000);
+
+	return 0;
+
+error:
+	if (fd >= 0)
+		close(fd);
+	munmap(cfg, cfg_size);
+	unlink(eal_dynmem_config_path());
+	return -1;
+}
+
+static int
+dynmem_init_secondary(void)
+{
+	struct dynmem_config *cfg;
+	struct stat st;
+	void *addr;
+	int fd;
+
+	fd = open(eal_dynmem_config_path(), O_RDWR);
+	if (fd < 0) {
+		/* the primary process does not grow its memory */
+		if (errno == ENOENT)
+			return 0;
+		RTE_LOG(ERR, EAL, "Cannot open %s: %s\n",
+			eal_dynmem_config_path(), strerror(errno));
+		return -1;
+	}
+	if (fstat(fd, &st) < 0 ||
+			(size_t)st.st_size < sizeof(struct dynmem_config)) {
+		close(fd);
+		RTE_LOG(ERR, EAL, "Invalid %s\n", eal_dynmem_config_path());
+		return -1;
+	}
+	cfg = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			fd, 0);
+	close(fd);
+	if (cfg == MAP_FAILED) {
+		RTE_LOG(ERR, EAL, "Cannot map %s\n", eal_dynmem_config_path());
+		return -1;
+	}
+	if (cfg->magic != DYNMEM_MAGIC ||
+			(size_t)st.st_size < dynmem_config_size(cfg->nb_pages)) {
+		RTE_LOG(ERR, EAL, "Invalid %s\n", eal_dynmem_config_path());
+		goto error;
+	}
+
+	fd = open(cfg->filepath, O_RDWR);
+	if (fd < 0) {
+		RTE_LOG(ERR, EAL, "Cannot open %s: %s\n", cfg->filepath,
+			strerror(errno));
+		goto error;
+	}
+
+	/* get the same addresses as the primary process */
+	addr = mmap((void *)(uintptr_t)cfg->base_addr, cfg->len,
+			PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE,
+			fd, 0);
+	if (addr == MAP_FAILED ||
+			addr != (void *)(uintptr_t)cfg->base_addr) {
+		RTE_LOG(ERR, EAL, "Cannot map %s at [%p]\n", cfg->filepath,
+			(void *)(uintptr_t)cfg->base_addr);
+		if (addr != MAP_FAILED)
+			munmap(addr, cfg->len);
+		close(fd);
+		goto error;
+	}
+
+	dynmem_cfg = cfg;
+	dynmem_fd = fd;
+	dynmem_start = (uintptr_t)addr;
+	dynmem_end = dynmem_start + cfg->len;
+
+	return 0;
+
+error:
+	munmap(cfg, st.st_size);
+	return -1;
+}
+
+int
+rte_eal_dynmem_init(void)
+{
+	if (rte_eal_process_type() == RTE_PROC_PRIMARY)
+		return dynmem_init_primary();
+	return dynmem_init_secondary();
+}
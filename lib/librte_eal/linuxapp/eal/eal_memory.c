@@ -82,6 +82,9 @@
 #include <sys/time.h>
 #include <signal.h>
 #include <setjmp.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
 
 #include <rte_log.h>
 #include <rte_memory.h>
@@ -166,6 +169,10 @@ rte_mem_virt2phy(const void *virtaddr)
 	int page_size;
 	off_t offset;
 
+	/* with --iova-va, IO addresses are the virtual addresses */
+	if (internal_config.iova_va)
+		return (phys_addr_t)(uintptr_t)virtaddr;
+
 	/* when using dom0, /proc/self/pagemap always returns 0, check in
 	 * dpdk memory by browsing the memsegs */
 	if (rte_xen_dom0_supported()) {
@@ -229,6 +236,9 @@ rte_mem_virt2phy(const void *virtaddr)
 	 * the pfn (page frame number) are bits 0-54 (see
 	 * pagemap.txt in linux Documentation)
 	 */
+	if ((page & 0x7fffffffffffffULL) == 0)
+		return RTE_BAD_PHYS_ADDR;
+
 	physaddr = ((page & 0x7fffffffffffffULL) * page_size)
 		+ ((unsigned long)virtaddr % page_size);
 
@@ -237,20 +247,55 @@ rte_mem_virt2phy(const void *virtaddr)
 
 /*
  * For each hugepage in hugepg_tbl, fill the physaddr value. We find
- * it by browsing the /proc/self/pagemap special file.
+ * it by browsing the /proc/self/pagemap special file, which is opened
+ * only once for the whole table.
  */
 static int
 find_physaddrs(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
 {
 	unsigned i;
-	phys_addr_t addr;
+	int fd, page_size;
+	ssize_t retval;
+	uint64_t page;
+	off_t offset;
 
+	/* IO addresses are virtual addresses, no need for the pagemap */
+	if (internal_config.iova_va) {
+		for (i = 0; i < hpi->num_pages[0]; i++)
+			hugepg_tbl[i].physaddr =
+				(phys_addr_t)(uintptr_t)hugepg_tbl[i].orig_va;
+		return 0;
+	}
+
+	if (!proc_pagemap_readable)
+		return -1;
+
+	fd = open("/proc/self/pagemap", O_RDONLY);
+	if (fd < 0) {
+		RTE_LOG(ERR, EAL, "%s(): cannot open /proc/self/pagemap: %s\n",
+			__func__, strerror(errno));
+		return -1;
+	}
+
+	page_size = getpagesize();
 	for (i = 0; i < hpi->num_pages[0]; i++) {
-		addr = rte_mem_virt2phy(hugepg_tbl[i].orig_va);
-		if (addr == RTE_BAD_PHYS_ADDR)
+		offset = sizeof(uint64_t) *
+			((unsigned long)hugepg_tbl[i].orig_va / page_size);
+		retval = pread(fd, &page, PFN_MASK_SIZE, offset);
+		if (retval != PFN_MASK_SIZE) {
+			RTE_LOG(ERR, EAL, "%s(): cannot read /proc/self/pagemap: %s\n",
+				__func__, retval < 0 ? strerror(errno) :
+				"short read");
+			close(fd);
 			return -1;
-		hugepg_tbl[i].physaddr = addr;
+		}
+
+		/* hugepages are page aligned, the offset in page is 0 */
+		hugepg_tbl[i].physaddr =
+			(page & 0x7fffffffffffffULL) * page_size;
 	}
+
+	close(fd);
 	return 0;
 }
 
@@ -343,7 +388,8 @@ get_virtual_area(size_t *size, size_t hugepage_sz)
 	return addr;
 }
 
-static sigjmp_buf huge_jmpenv;
+/* per thread, hugepages may be faulted from several threads at once */
+static __thread sigjmp_buf huge_jmpenv;
 
 static void huge_sigbus_handler(int signo __rte_unused)
 {
@@ -681,6 +727,206 @@ unmap_all_hugepages_orig(struct hugepage_file *hugepg_tbl, struct hugepage_info
         }
         return 0;
 }
+
+/*
+ * Fast hugepage init, used with --fast-huge-init and/or --iova-va.
+ *
+ * The hugepages are mapped without MAP_POPULATE, then faulted (and
+ * zeroed by the kernel) from up to RTE_EAL_HUGEPAGE_INIT_THREADS
+ * threads. With --iova-va the physical layout does not matter, so the
+ * pages are directly mapped in their final, virtually contiguous
+ * location and the remapping pass is skipped.
+ */
+
+/* work given to one hugepage fault thread */
+struct huge_fault_job {
+	struct hugepage_file *hugepg_tbl;
+	uint64_t hugepage_sz;
+	unsigned start;          /**< first page of the slice */
+	unsigned end;            /**< last page of the slice, excluded */
+	volatile unsigned cur;   /**< page being faulted, survives SIGBUS */
+	unsigned nb_failed;      /**< pages released on SIGBUS */
+};
+
+static unsigned
+huge_init_threads(unsigned num_pages)
+{
+	cpu_set_t cpuset;
+	unsigned n = RTE_EAL_HUGEPAGE_INIT_THREADS;
+
+	if (!internal_config.fast_huge_init)
+		return 1;
+
+	if (pthread_getaffinity_np(pthread_self(), sizeof(cpuset),
+			&cpuset) == 0)
+		n = RTE_MIN(n, (unsigned)CPU_COUNT(&cpuset));
+
+	n = RTE_MIN(n, num_pages);
+	return RTE_MAX(n, 1U);
+}
+
+/*
+ * Mmap all hugepages of hugepage table without populating them. The
+ * virtual address is stored in hugepg_tbl[i].orig_va. With --iova-va,
+ * the pages are placed in a contiguous virtual area.
+ */
+static unsigned
+map_all_hugepages_fast(struct hugepage_file *hugepg_tbl,
+		struct hugepage_info *hpi)
+{
+	int fd;
+	unsigned i;
+	void *virtaddr;
+	void *vma_addr = NULL;
+	size_t vma_len = 0;
+	uint64_t hugepage_sz = hpi->hugepage_sz;
+
+	for (i = 0; i < hpi->num_pages[0]; i++) {
+		hugepg_tbl[i].file_id = i;
+		hugepg_tbl[i].size = hugepage_sz;
+		eal_get_hugefile_path(hugepg_tbl[i].filepath,
+				sizeof(hugepg_tbl[i].filepath), hpi->hugedir,
+				hugepg_tbl[i].file_id);
+		hugepg_tbl[i].filepath[sizeof(hugepg_tbl[i].filepath) - 1] = '\0';
+
+		if (internal_config.iova_va && vma_len == 0) {
+			/* get the biggest virtual area for remaining pages */
+			vma_len = (hpi->num_pages[0] - i) * hugepage_sz;
+			vma_addr = get_virtual_area(&vma_len, hugepage_sz);
+			if (vma_addr == NULL)
+				vma_len = hugepage_sz;
+		}
+
+		fd = open(hugepg_tbl[i].filepath, O_CREAT | O_RDWR, 0755);
+		if (fd < 0) {
+			RTE_LOG(DEBUG, EAL, "%s(): open failed: %s\n", __func__,
+					strerror(errno));
+			return i;
+		}
+
+		/* page tables are populated later, by the fault threads */
+		virtaddr = mmap(vma_addr, hugepage_sz, PROT_READ | PROT_WRITE,
+				MAP_SHARED, fd, 0);
+		if (virtaddr == MAP_FAILED) {
+			RTE_LOG(DEBUG, EAL, "%s(): mmap failed: %s\n", __func__,
+					strerror(errno));
+			close(fd);
+			return i;
+		}
+		hugepg_tbl[i].orig_va = virtaddr;
+
+		/* set shared flock on the file. */
+		if (flock(fd, LOCK_SH | LOCK_NB) == -1) {
+			RTE_LOG(DEBUG, EAL, "%s(): Locking file failed:%s \n",
+				__func__, strerror(errno));
+			munmap(virtaddr, hugepage_sz);
+			hugepg_tbl[i].orig_va = NULL;
+			close(fd);
+			return i;
+		}
+
+		close(fd);
+
+		if (vma_len != 0) {
+			vma_addr = (char *)vma_addr + hugepage_sz;
+			vma_len -= hugepage_sz;
+		}
+	}
+
+	return i;
+}
+
+/*
+ * Fault one slice of the hugepage table. In linux, hugetlb limitations
+ * like cgroup are enforced at fault time and reported with SIGBUS: the
+ * page is then released and the next one is tried.
+ */
+static void *
+huge_fault_pages(void *arg)
+{
+	struct huge_fault_job *job = arg;
+	struct hugepage_file *hp;
+
+	for (job->cur = job->start; job->cur < job->end; job->cur++) {
+		if (huge_wrap_sigsetjmp()) {
+			hp = &job->hugepg_tbl[job->cur];
+			munmap(hp->orig_va, job->hugepage_sz);
+			unlink(hp->filepath);
+			hp->orig_va = NULL;
+			job->nb_failed++;
+			continue;
+		}
+		hp = &job->hugepg_tbl[job->cur];
+		*(volatile int *)hp->orig_va = 0;
+	}
+
+	return NULL;
+}
+
+/*
+ * Fault the num_pages first hugepages of the table in parallel, then
+ * compact the table so that the pages refused by the kernel are removed.
+ * Returns the number of usable pages.
+ */
+static unsigned
+fault_all_hugepages(struct hugepage_file *hugepg_tbl,
+		struct hugepage_info *hpi, unsigned num_pages)
+{
+	struct huge_fault_job job[RTE_EAL_HUGEPAGE_INIT_THREADS];
+	pthread_t tid[RTE_EAL_HUGEPAGE_INIT_THREADS];
+	int started[RTE_EAL_HUGEPAGE_INIT_THREADS];
+	unsigned nb_threads, chunk, i, n, nb_failed = 0;
+
+	if (num_pages == 0)
+		return 0;
+
+	nb_threads = huge_init_threads(num_pages);
+	chunk = (num_pages + nb_threads - 1) / nb_threads;
+
+	for (i = 0; i < nb_threads; i++) {
+		job[i].hugepg_tbl = hugepg_tbl;
+		job[i].hugepage_sz = hpi->hugepage_sz;
+		job[i].start = RTE_MIN(i * chunk, num_pages);
+		job[i].end = RTE_MIN(job[i].start + chunk, num_pages);
+		job[i].cur = job[i].start;
+		job[i].nb_failed = 0;
+		started[i] = 0;
+	}
+
+	/* the calling thread handles the first slice itself */
+	for (i = 1; i < nb_threads; i++)
+		started[i] = pthread_create(&tid[i], NULL, huge_fault_pages,
+				&job[i]) == 0;
+
+	huge_fault_pages(&job[0]);
+
+	for (i = 1; i < nb_threads; i++) {
+		if (started[i])
+			pthread_join(tid[i], NULL);
+		else
+			huge_fault_pages(&job[i]);
+	}
+
+	for (i = 0; i < nb_threads; i++)
+		nb_failed += job[i].nb_failed;
+
+	if (nb_failed == 0)
+		return num_pages;
+
+	RTE_LOG(DEBUG, EAL, "SIGBUS: Cannot fault %u hugepages of size %u MB\n",
+		nb_failed, (unsigned)(hpi->hugepage_sz / 0x100000));
+
+	for (i = 0, n = 0; i < num_pages; i++) {
+		if (hugepg_tbl[i].orig_va == NULL)
+			continue;
+		if (n != i)
+			hugepg_tbl[n] = hugepg_tbl[i];
+		n++;
+	}
+	memset(&hugepg_tbl[n], 0, (num_pages - n) * sizeof(*hugepg_tbl));
+
+	return n;
+}
 #endif /* RTE_EAL_SINGLE_FILE_SEGMENTS */
 
 /*
@@ -784,6 +1030,24 @@ cmp_physaddr(const void *a, const void *b)
 		return 0;
 }
 
+#ifndef RTE_EAL_SINGLE_FILE_SEGMENTS
+/*
+ * With --iova-va, pages are sorted by socket first so that each socket
+ * gets virtually contiguous memsegs, then by (virtual) address.
+ */
+static int
+cmp_socket_physaddr(const void *a, const void *b)
+{
+	const struct hugepage_file *p1 = (const struct hugepage_file *)a;
+	const struct hugepage_file *p2 = (const struct hugepage_file *)b;
+
+	if (p1->socket_id != p2->socket_id)
+		return p1->socket_id < p2->socket_id ? -1 : 1;
+
+	return cmp_physaddr(a, b);
+}
+#endif
+
 /*
  * Uses mmap to create a shared memory area for storage of data
  * Used in this file to store the hugepage file map on disk
@@ -1126,6 +1390,69 @@ eal_get_hugepage_mem_size(void)
 	return (size < SIZE_MAX) ? (size_t)(size) : SIZE_MAX;
 }
 
+/* hugepage init phases, for the timing breakdown */
+enum huge_init_phase {
+	HUGE_PHASE_MAP,
+	HUGE_PHASE_FAULT,
+	HUGE_PHASE_PHYSADDR,
+	HUGE_PHASE_NUMA,
+	HUGE_PHASE_SORT,
+	HUGE_PHASE_REMAP,
+	HUGE_PHASE_MAX
+};
+
+static const char * const huge_phase_names[HUGE_PHASE_MAX] = {
+	[HUGE_PHASE_MAP] = "map",
+	[HUGE_PHASE_FAULT] = "fault",
+	[HUGE_PHASE_PHYSADDR] = "physaddr",
+	[HUGE_PHASE_NUMA] = "numa",
+	[HUGE_PHASE_SORT] = "sort",
+	[HUGE_PHASE_REMAP] = "remap",
+};
+
+static uint64_t
+huge_time_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* account the time elapsed since *t to phase, and restart *t */
+static void
+huge_phase_done(uint64_t *phase_us, enum huge_init_phase phase, uint64_t *t)
+{
+	uint64_t now = huge_time_us();
+
+	phase_us[phase] += now - *t;
+	*t = now;
+}
+
+/* log the timing breakdown, at INFO level if fast init was asked */
+static void
+huge_phase_dump(const struct hugepage_info *hpi, unsigned num_pages,
+		const uint64_t *phase_us)
+{
+	char buf[256];
+	uint64_t total = 0;
+	int i, len = 0;
+
+	for (i = 0; i < HUGE_PHASE_MAX; i++) {
+		total += phase_us[i];
+		len += snprintf(buf + len, sizeof(buf) - len, " %s %"PRIu64"ms",
+				huge_phase_names[i], phase_us[i] / 1000);
+		if (len >= (int)sizeof(buf))
+			break;
+	}
+
+	rte_log(internal_config.fast_huge_init ? RTE_LOG_INFO : RTE_LOG_DEBUG,
+		RTE_LOGTYPE_EAL,
+		"EAL: %u hugepages of size %u MB initialized in %"PRIu64"ms:%s\n",
+		num_pages, (unsigned)(hpi->hugepage_sz / 0x100000),
+		total / 1000, buf);
+}
+
 static struct sigaction huge_action_old;
 static int huge_need_recover;
 
@@ -1163,6 +1490,10 @@ huge_recover_sigbus(void)
  *  5. remap these N huge pages in the correct order
  *  6. unmap the first mapping
  *  7. fill memsegs in configuration with contiguous zones
+ *
+ * With --fast-huge-init, the pages are faulted from several threads in
+ * step 1. With --iova-va, step 1 maps the pages in their final place,
+ * step 2 does not read the pagemap and steps 5 and 6 are skipped.
  */
 int
 rte_eal_hugepage_init(void)
@@ -1245,6 +1576,8 @@ rte_eal_hugepage_init(void)
 	for (i = 0; i < (int)internal_config.num_hugepage_sizes; i ++){
 		unsigned pages_old, pages_new;
 		struct hugepage_info *hpi;
+		uint64_t phase_us[HUGE_PHASE_MAX];
+		uint64_t t;
 
 		/*
 		 * we don't yet mark hugepages as used at this stage, so
@@ -1256,9 +1589,26 @@ rte_eal_hugepage_init(void)
 		if (hpi->num_pages[0] == 0)
 			continue;
 
+		memset(phase_us, 0, sizeof(phase_us));
+		t = huge_time_us();
+
 		/* map all hugepages available */
 		pages_old = hpi->num_pages[0];
-		pages_new = map_all_hugepages(&tmp_hp[hp_offset], hpi, 1);
+#ifndef RTE_EAL_SINGLE_FILE_SEGMENTS
+		if (internal_config.fast_huge_init || internal_config.iova_va) {
+			pages_new = map_all_hugepages_fast(&tmp_hp[hp_offset],
+					hpi);
+			huge_phase_done(phase_us, HUGE_PHASE_MAP, &t);
+			pages_new = fault_all_hugepages(&tmp_hp[hp_offset],
+					hpi, pages_new);
+			huge_phase_done(phase_us, HUGE_PHASE_FAULT, &t);
+		} else
+#endif
+		{
+			pages_new = map_all_hugepages(&tmp_hp[hp_offset],
+					hpi, 1);
+			huge_phase_done(phase_us, HUGE_PHASE_MAP, &t);
+		}
 		if (pages_new < pages_old) {
 #ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
 			RTE_LOG(ERR, EAL,
@@ -1287,15 +1637,24 @@ rte_eal_hugepage_init(void)
 					(unsigned)(hpi->hugepage_sz / 0x100000));
 			goto fail;
 		}
+		huge_phase_done(phase_us, HUGE_PHASE_PHYSADDR, &t);
 
 		if (find_numasocket(&tmp_hp[hp_offset], hpi) < 0){
 			RTE_LOG(DEBUG, EAL, "Failed to find NUMA socket for %u MB pages\n",
 					(unsigned)(hpi->hugepage_sz / 0x100000));
 			goto fail;
 		}
+		huge_phase_done(phase_us, HUGE_PHASE_NUMA, &t);
 
+#ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
 		qsort(&tmp_hp[hp_offset], hpi->num_pages[0],
 		      sizeof(struct hugepage_file), cmp_physaddr);
+#else
+		qsort(&tmp_hp[hp_offset], hpi->num_pages[0],
+		      sizeof(struct hugepage_file), internal_config.iova_va ?
+		      cmp_socket_physaddr : cmp_physaddr);
+#endif
+		huge_phase_done(phase_us, HUGE_PHASE_SORT, &t);
 
 #ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
 		/* remap all hugepages into single file segments */
@@ -1306,20 +1665,34 @@ rte_eal_hugepage_init(void)
 			goto fail;
 		}
 
+		huge_phase_done(phase_us, HUGE_PHASE_REMAP, &t);
+		huge_phase_dump(hpi, new_pages_count[i], phase_us);
+
 		/* we have processed a num of hugepages of this size, so inc offset */
 		hp_offset += new_pages_count[i];
 #else
-		/* remap all hugepages */
-		if (map_all_hugepages(&tmp_hp[hp_offset], hpi, 0) !=
-		    hpi->num_pages[0]) {
-			RTE_LOG(ERR, EAL, "Failed to remap %u MB pages\n",
-					(unsigned)(hpi->hugepage_sz / 0x100000));
-			goto fail;
-		}
+		if (internal_config.iova_va) {
+			/* pages are already mapped in their final place */
+			for (j = 0; j < (int)hpi->num_pages[0]; j++) {
+				tmp_hp[hp_offset + j].final_va =
+					tmp_hp[hp_offset + j].orig_va;
+				tmp_hp[hp_offset + j].orig_va = NULL;
+			}
+		} else {
+			/* remap all hugepages */
+			if (map_all_hugepages(&tmp_hp[hp_offset], hpi, 0) !=
+			    hpi->num_pages[0]) {
+				RTE_LOG(ERR, EAL, "Failed to remap %u MB pages\n",
+						(unsigned)(hpi->hugepage_sz / 0x100000));
+				goto fail;
+			}
 
-		/* unmap original mappings */
-		if (unmap_all_hugepages_orig(&tmp_hp[hp_offset], hpi) < 0)
-			goto fail;
+			/* unmap original mappings */
+			if (unmap_all_hugepages_orig(&tmp_hp[hp_offset], hpi) < 0)
+				goto fail;
+		}
+		huge_phase_done(phase_us, HUGE_PHASE_REMAP, &t);
+		huge_phase_dump(hpi, hpi->num_pages[0], phase_us);
 
 		/* we have processed a num of hugepages of this size, so inc offset */
 		hp_offset += hpi->num_pages[0];
@@ -1597,6 +1970,10 @@ rte_eal_hugepage_attach(void)
 		if (mcfg->memseg[s].len == 0)
 			break;
 
+		/* segments added at runtime are already mapped */
+		if (rte_eal_dynmem_contains(mcfg->memseg[s].addr))
+			continue;
+
 #ifdef RTE_LIBRTE_IVSHMEM
 		/*
 		 * if segment has ioremap address set, it's an IVSHMEM segment and
@@ -1644,6 +2021,12 @@ rte_eal_hugepage_attach(void)
 		void *addr, *base_addr;
 		uintptr_t offset = 0;
 		size_t mapping_size;
+
+		/* segments added at runtime are already mapped */
+		if (rte_eal_dynmem_contains(mcfg->memseg[s].addr)) {
+			s++;
+			continue;
+		}
 #ifdef RTE_LIBRTE_IVSHMEM
 		/*
 		 * if segment has ioremap address set, it's an IVSHMEM segment and
@@ -1703,7 +2086,8 @@ rte_eal_hugepage_attach(void)
 error:
 	s = 0;
 	while (s < RTE_MAX_MEMSEG && mcfg->memseg[s].len > 0) {
-		munmap(mcfg->memseg[s].addr, mcfg->memseg[s].len);
+		if (!rte_eal_dynmem_contains(mcfg->memseg[s].addr))
+			munmap(mcfg->memseg[s].addr, mcfg->memseg[s].len);
 		s++;
 	}
 	if (hp != NULL && hp != MAP_FAILED)
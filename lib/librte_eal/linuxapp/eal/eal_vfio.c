@@ -51,6 +51,8 @@ static struct vfio_config vfio_cfg;
 
 static int vfio_type1_dma_map(int);
 static int vfio_noiommu_dma_map(int);
+static void vfio_type1_mem_event(enum rte_mem_event, const struct rte_memseg *,
+		void *);
 
 /* IOMMU types we support */
 static const struct vfio_iommu_type iommu_types[] = {
@@ -269,6 +271,13 @@ int vfio_setup_device(const char *sysfs_base, const char *dev_addr,
 		vfio_cfg.vfio_container_has_dma = 1;
 	}
 
+	/* a secondary process maps the segments it adds at runtime in the
+	 * container set up by the primary process */
+	if (internal_config.process_type == RTE_PROC_SECONDARY &&
+			ioctl(vfio_cfg.vfio_container_fd, VFIO_CHECK_EXTENSION,
+				VFIO_TYPE1_IOMMU) > 0)
+		rte_mem_event_callback_register(vfio_type1_mem_event, NULL);
+
 	/* get a file descriptor for the device */
 	*vfio_dev_fd = ioctl(vfio_group_fd, VFIO_GROUP_GET_DEVICE_FD, dev_addr);
 	if (*vfio_dev_fd < 0) {
@@ -520,6 +529,10 @@ vfio_type1_dma_map(int vfio_container_fd)
 		if (ms[i].addr == NULL)
 			break;
 
+		/* segment released at runtime */
+		if (ms[i].len == 0)
+			continue;
+
 		memset(&dma_map, 0, sizeof(dma_map));
 		dma_map.argsz = sizeof(struct vfio_iommu_type1_dma_map);
 		dma_map.vaddr = ms[i].addr_64;
@@ -536,9 +549,49 @@ vfio_type1_dma_map(int vfio_container_fd)
 		}
 	}
 
+	/* follow the segments added or removed at runtime */
+	rte_mem_event_callback_register(vfio_type1_mem_event, NULL);
+
 	return 0;
 }
 
+static void
+vfio_type1_mem_event(enum rte_mem_event event, const struct rte_memseg *ms,
+		void *arg __rte_unused)
+{
+	int ret;
+
+	if (event == RTE_MEM_EVENT_ALLOC) {
+		struct vfio_iommu_type1_dma_map dma_map;
+
+		memset(&dma_map, 0, sizeof(dma_map));
+		dma_map.argsz = sizeof(struct vfio_iommu_type1_dma_map);
+		dma_map.vaddr = ms->addr_64;
+		dma_map.size = ms->len;
+		dma_map.iova = ms->phys_addr;
+		dma_map.flags = VFIO_DMA_MAP_FLAG_READ | VFIO_DMA_MAP_FLAG_WRITE;
+
+		ret = ioctl(vfio_cfg.vfio_container_fd, VFIO_IOMMU_MAP_DMA,
+				&dma_map);
+	} else {
+		struct vfio_iommu_type1_dma_unmap dma_unmap;
+
+		memset(&dma_unmap, 0, sizeof(dma_unmap));
+		dma_unmap.argsz = sizeof(struct vfio_iommu_type1_dma_unmap);
+		dma_unmap.size = ms->len;
+		dma_unmap.iova = ms->phys_addr;
+
+		ret = ioctl(vfio_cfg.vfio_container_fd, VFIO_IOMMU_UNMAP_DMA,
+				&dma_unmap);
+	}
+
+	if (ret)
+		RTE_LOG(ERR, EAL, "  cannot %s DMA remapping of %p, "
+				"error %i (%s)\n",
+				event == RTE_MEM_EVENT_ALLOC ? "set up" : "remove",
+				ms->addr, errno, strerror(errno));
+}
+
 static int
 vfio_noiommu_dma_map(int __rte_unused vfio_container_fd)
 {
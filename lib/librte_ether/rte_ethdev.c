@@ -215,6 +215,8 @@ rte_eth_dev_allocate(const char *name, enum rte_eth_dev_type type)
 	snprintf(eth_dev->data->name, sizeof(eth_dev->data->name), "%s", name);
 	eth_dev->data->port_id = port_id;
 	eth_dev->attached = DEV_ATTACHED;
+	/* a PMD without TX prepare function may reuse the port */
+	eth_dev->tx_pkt_prepare = NULL;
 	eth_dev->dev_type = type;
 	nb_ports++;
 	return eth_dev;
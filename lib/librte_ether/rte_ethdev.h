@@ -178,6 +178,7 @@ extern "C" {
 #define RTE_ETHDEV_HAS_LRO_SUPPORT
 
 #include <rte_log.h>
+#include <rte_errno.h>
 #include <rte_interrupts.h>
 #include <rte_pci.h>
 #include <rte_dev.h>
@@ -185,6 +186,9 @@ extern "C" {
 #include "rte_ether.h"
 #include "rte_eth_ctrl.h"
 #include "rte_dev_info.h"
+#ifdef RTE_JOBSTATS_LCORE_BUSY
+#include <rte_jobstats_lcore.h>
+#endif
 
 struct rte_mbuf;
 
@@ -696,6 +700,19 @@ struct rte_eth_desc_lim {
 	uint16_t nb_max;   /**< Max allowed number of descriptors. */
 	uint16_t nb_min;   /**< Min allowed number of descriptors. */
 	uint16_t nb_align; /**< Number of descriptors should be aligned to. */
+
+	/**
+	 * Max number of segments per whole packet, for TSO packets; 0 when
+	 * not reported by the PMD.
+	 */
+	uint16_t nb_seg_max;
+
+	/**
+	 * Max number of segments per one MTU, i.e. per non-TSO packet or
+	 * per segment sent on the wire for TSO packets; 0 when not reported
+	 * by the PMD.
+	 */
+	uint16_t nb_mtu_seg_max;
 };
 
 /**
@@ -864,6 +881,7 @@ struct rte_eth_conf {
 #define DEV_TX_OFFLOAD_UDP_TSO     0x00000040
 #define DEV_TX_OFFLOAD_OUTER_IPV4_CKSUM 0x00000080 /**< Used for tunneling packet. */
 #define DEV_TX_OFFLOAD_QINQ_INSERT 0x00000100
+#define DEV_TX_OFFLOAD_VXLAN_TNL_TSO 0x00000200 /**< Used for tunneling packet. */
 
 /**
  * Ethernet device information
@@ -1181,6 +1199,11 @@ typedef uint16_t (*eth_tx_burst_t)(void *txq,
 				   uint16_t nb_pkts);
 /**< @internal Send output packets on a transmit queue of an Ethernet device. */
 
+typedef uint16_t (*eth_tx_prep_t)(void *txq,
+				   struct rte_mbuf **tx_pkts,
+				   uint16_t nb_pkts);
+/**< @internal Prepare output packets for a transmit queue of an Ethernet device. */
+
 typedef int (*flow_ctrl_get_t)(struct rte_eth_dev *dev,
 			       struct rte_eth_fc_conf *fc_conf);
 /**< @internal Get current flow control parameter on an Ethernet device */
@@ -1626,6 +1649,7 @@ enum rte_eth_dev_type {
 struct rte_eth_dev {
 	eth_rx_burst_t rx_pkt_burst; /**< Pointer to PMD receive function. */
 	eth_tx_burst_t tx_pkt_burst; /**< Pointer to PMD transmit function. */
+	eth_tx_prep_t tx_pkt_prepare; /**< Pointer to PMD transmit prepare function. */
 	struct rte_eth_dev_data *data;  /**< Pointer to device data */
 	const struct eth_driver *driver;/**< Driver for this device */
 	const struct eth_dev_ops *dev_ops; /**< Functions exported by PMD */
@@ -2694,6 +2718,10 @@ rte_eth_rx_burst(uint8_t port_id, uint16_t queue_id,
 	}
 #endif
 
+#ifdef RTE_JOBSTATS_LCORE_BUSY
+	rte_jobstats_lcore_poll(nb_rx);
+#endif
+
 	return nb_rx;
 }
 
@@ -2830,7 +2858,74 @@ rte_eth_tx_burst(uint8_t port_id, uint16_t queue_id,
 	}
 #endif
 
+#ifdef RTE_JOBSTATS_LCORE_BUSY
+	nb_pkts = (*dev->tx_pkt_burst)(dev->data->tx_queues[queue_id],
+			tx_pkts, nb_pkts);
+	rte_jobstats_lcore_work(nb_pkts);
+	return nb_pkts;
+#else
 	return (*dev->tx_pkt_burst)(dev->data->tx_queues[queue_id], tx_pkts, nb_pkts);
+#endif
+}
+
+/**
+ * Prepare a burst of output packets for transmission on a transmit queue
+ * of an Ethernet device.
+ *
+ * The rte_eth_tx_prepare() function checks, in one pass over the burst,
+ * that the offloads requested by the packets are supported by the queue
+ * and consistent (offload flags, number of segments, MSS limits...), and
+ * fills the packet fields the device expects to be set by software for
+ * these offloads, such as the IP checksum and the pseudo-header checksum
+ * of the L4 checksum and TSO offloads. The transmit function of the
+ * device can then send the packets without per-packet fixups.
+ *
+ * The packets are modified in place: their headers must be writable, and
+ * they must not be modified again before rte_eth_tx_burst(). Devices
+ * which need no preparation return *nb_pkts* without reading the packets.
+ *
+ * The function stops at the first invalid packet: the application may
+ * drop it, or fix it and prepare the remaining packets again.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param queue_id
+ *   The index of the transmit queue the packets will be sent on.
+ * @param tx_pkts
+ *   The address of an array of *nb_pkts* pointers to *rte_mbuf* structures
+ *   which contain the output packets.
+ * @param nb_pkts
+ *   The number of packets to prepare.
+ * @return
+ *   The number of packets correct and ready to be sent. If it is less
+ *   than *nb_pkts*, tx_pkts[return value] is invalid and rte_errno is set:
+ *   - EINVAL: offload flags or fields are not valid for the device
+ *   - ENOTSUP: an offload is not supported by the device
+ */
+static inline uint16_t
+rte_eth_tx_prepare(uint8_t port_id, uint16_t queue_id,
+		struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+{
+	struct rte_eth_dev *dev = &rte_eth_devices[port_id];
+
+#ifdef RTE_LIBRTE_ETHDEV_DEBUG
+	if (!rte_eth_dev_is_valid_port(port_id)) {
+		RTE_PMD_DEBUG_TRACE("Invalid TX port_id=%d\n", port_id);
+		rte_errno = EINVAL;
+		return 0;
+	}
+	if (queue_id >= dev->data->nb_tx_queues) {
+		RTE_PMD_DEBUG_TRACE("Invalid TX queue_id=%d\n", queue_id);
+		rte_errno = EINVAL;
+		return 0;
+	}
+#endif
+
+	if (dev->tx_pkt_prepare == NULL)
+		return nb_pkts;
+
+	return (*dev->tx_pkt_prepare)(dev->data->tx_queues[queue_id],
+			tx_pkts, nb_pkts);
 }
 
 typedef void (*buffer_tx_error_fn)(struct rte_mbuf **unsent, uint16_t count,
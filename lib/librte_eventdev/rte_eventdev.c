@@ -0,0 +1,926 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <rte_log.h>
+#include <rte_debug.h>
+#include <rte_dev.h>
+#include <rte_memory.h>
+#include <rte_memzone.h>
+#include <rte_eal.h>
+#include <rte_common.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
+
+#include "rte_eventdev.h"
+#include "rte_eventdev_pmd.h"
+
+struct rte_eventdev rte_event_devices[RTE_EVENT_MAX_DEVS];
+
+struct rte_eventdev *rte_eventdevs = &rte_event_devices[0];
+
+static uint8_t nb_eventdevs;
+
+#define RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, retval) do { \
+	if (!rte_event_pmd_is_valid_dev(dev_id)) { \
+		RTE_EDEV_LOG_ERR("Invalid dev_id=%d", dev_id); \
+		return retval; \
+	} \
+} while (0)
+
+#define RTE_EVENTDEV_VALID_DEVID_OR_ERRNO_RET(dev_id, errno_val, retval) do { \
+	if (!rte_event_pmd_is_valid_dev(dev_id)) { \
+		RTE_EDEV_LOG_ERR("Invalid dev_id=%d", dev_id); \
+		rte_errno = errno_val; \
+		return retval; \
+	} \
+} while (0)
+
+static inline int
+rte_event_pmd_is_valid_dev(uint8_t dev_id)
+{
+	return dev_id < RTE_EVENT_MAX_DEVS &&
+		rte_event_devices[dev_id].attached;
+}
+
+uint8_t
+rte_event_dev_count(void)
+{
+	return nb_eventdevs;
+}
+
+int
+rte_event_dev_get_dev_id(const char *name)
+{
+	int i;
+
+	if (name == NULL)
+		return -EINVAL;
+
+	for (i = 0; i < RTE_EVENT_MAX_DEVS; i++)
+		if (rte_event_devices[i].attached &&
+				strcmp(rte_event_devices[i].data->name,
+					name) == 0)
+			return i;
+	return -ENODEV;
+}
+
+int
+rte_event_dev_socket_id(uint8_t dev_id)
+{
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+
+	return rte_event_devices[dev_id].data->socket_id;
+}
+
+int
+rte_event_dev_info_get(uint8_t dev_id, struct rte_event_dev_info *dev_info)
+{
+	struct rte_eventdev *dev;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	dev = &rte_event_devices[dev_id];
+
+	if (dev_info == NULL)
+		return -EINVAL;
+
+	memset(dev_info, 0, sizeof(struct rte_event_dev_info));
+
+	RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->dev_infos_get, -ENOTSUP);
+	(*dev->dev_ops->dev_infos_get)(dev, dev_info);
+
+	dev_info->dequeue_timeout_ns = dev->data->dev_conf.dequeue_timeout_ns;
+
+	return 0;
+}
+
+/* Release the queues and ports of a previous configuration, then size the
+ * per queue and per port arrays for the new one.
+ */
+static int
+rte_event_dev_arrays_config(struct rte_eventdev *dev, uint8_t nb_queues,
+		uint8_t nb_ports)
+{
+	struct rte_eventdev_data *data = dev->data;
+	unsigned int i;
+
+	for (i = 0; i < data->nb_ports; i++)
+		if (data->ports != NULL && data->ports[i] != NULL &&
+				dev->dev_ops->port_release != NULL)
+			(*dev->dev_ops->port_release)(data->ports[i]);
+	for (i = 0; i < data->nb_queues; i++)
+		if (dev->dev_ops->queue_release != NULL)
+			(*dev->dev_ops->queue_release)(dev, i);
+
+	rte_free(data->ports);
+	rte_free(data->ports_dequeue_depth);
+	rte_free(data->ports_enqueue_depth);
+	rte_free(data->links_map);
+	rte_free(data->queues_prio);
+	data->ports = NULL;
+	data->ports_dequeue_depth = NULL;
+	data->ports_enqueue_depth = NULL;
+	data->links_map = NULL;
+	data->queues_prio = NULL;
+	data->nb_ports = 0;
+	data->nb_queues = 0;
+
+	if (nb_queues == 0 && nb_ports == 0)
+		return 0;
+
+	data->ports = rte_zmalloc_socket("eventdev->data->ports",
+			sizeof(data->ports[0]) * nb_ports,
+			RTE_CACHE_LINE_SIZE, data->socket_id);
+	data->ports_dequeue_depth = rte_zmalloc_socket(
+			"eventdev->ports_dequeue_depth",
+			sizeof(data->ports_dequeue_depth[0]) * nb_ports,
+			RTE_CACHE_LINE_SIZE, data->socket_id);
+	data->ports_enqueue_depth = rte_zmalloc_socket(
+			"eventdev->ports_enqueue_depth",
+			sizeof(data->ports_enqueue_depth[0]) * nb_ports,
+			RTE_CACHE_LINE_SIZE, data->socket_id);
+	data->links_map = rte_malloc_socket("eventdev->links_map",
+			sizeof(data->links_map[0]) * nb_ports *
+			RTE_EVENT_MAX_QUEUES_PER_DEV,
+			RTE_CACHE_LINE_SIZE, data->socket_id);
+	data->queues_prio = rte_zmalloc_socket("eventdev->queues_prio",
+			sizeof(data->queues_prio[0]) * nb_queues,
+			RTE_CACHE_LINE_SIZE, data->socket_id);
+	if (data->ports == NULL || data->ports_dequeue_depth == NULL ||
+			data->ports_enqueue_depth == NULL ||
+			data->links_map == NULL || data->queues_prio == NULL) {
+		rte_free(data->ports);
+		rte_free(data->ports_dequeue_depth);
+		rte_free(data->ports_enqueue_depth);
+		rte_free(data->links_map);
+		rte_free(data->queues_prio);
+		data->ports = NULL;
+		data->ports_dequeue_depth = NULL;
+		data->ports_enqueue_depth = NULL;
+		data->links_map = NULL;
+		data->queues_prio = NULL;
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < (unsigned int)nb_ports *
+			RTE_EVENT_MAX_QUEUES_PER_DEV; i++)
+		data->links_map[i] = RTE_EVENT_QUEUE_LINK_INVALID;
+
+	data->nb_queues = nb_queues;
+	data->nb_ports = nb_ports;
+	return 0;
+}
+
+int
+rte_event_dev_configure(uint8_t dev_id,
+		const struct rte_event_dev_config *dev_conf)
+{
+	struct rte_eventdev *dev;
+	struct rte_event_dev_info info;
+	int diag;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	dev = &rte_event_devices[dev_id];
+
+	RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->dev_infos_get, -ENOTSUP);
+	RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->dev_configure, -ENOTSUP);
+
+	if (dev->data->dev_started) {
+		RTE_EDEV_LOG_ERR("device %d must be stopped to allow "
+				"configuration", dev_id);
+		return -EBUSY;
+	}
+
+	if (dev_conf == NULL)
+		return -EINVAL;
+
+	(*dev->dev_ops->dev_infos_get)(dev, &info);
+
+	if (!(dev_conf->event_dev_cfg &
+			RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT) &&
+			dev_conf->dequeue_timeout_ns != 0 &&
+			(dev_conf->dequeue_timeout_ns <
+				info.min_dequeue_timeout_ns ||
+			 dev_conf->dequeue_timeout_ns >
+				info.max_dequeue_timeout_ns)) {
+		RTE_EDEV_LOG_ERR("dev%d invalid dequeue_timeout_ns=%u "
+				"(min=%u max=%u)", dev_id,
+				dev_conf->dequeue_timeout_ns,
+				info.min_dequeue_timeout_ns,
+				info.max_dequeue_timeout_ns);
+		return -EINVAL;
+	}
+	if (dev_conf->nb_events_limit <= 0 ||
+			dev_conf->nb_events_limit > info.max_num_events) {
+		RTE_EDEV_LOG_ERR("dev%d invalid nb_events_limit=%d (max=%d)",
+				dev_id, dev_conf->nb_events_limit,
+				info.max_num_events);
+		return -EINVAL;
+	}
+	if (dev_conf->nb_event_queues == 0 ||
+			dev_conf->nb_event_queues > info.max_event_queues ||
+			dev_conf->nb_event_queues >
+				RTE_EVENT_MAX_QUEUES_PER_DEV) {
+		RTE_EDEV_LOG_ERR("dev%d invalid nb_event_queues=%d (max=%d)",
+				dev_id, dev_conf->nb_event_queues,
+				info.max_event_queues);
+		return -EINVAL;
+	}
+	if (dev_conf->nb_event_ports == 0 ||
+			dev_conf->nb_event_ports > info.max_event_ports) {
+		RTE_EDEV_LOG_ERR("dev%d invalid nb_event_ports=%d (max=%d)",
+				dev_id, dev_conf->nb_event_ports,
+				info.max_event_ports);
+		return -EINVAL;
+	}
+	if (dev_conf->nb_event_queue_flows == 0 ||
+			dev_conf->nb_event_queue_flows >
+				info.max_event_queue_flows) {
+		RTE_EDEV_LOG_ERR("dev%d invalid nb_event_queue_flows=%u "
+				"(max=%u)", dev_id,
+				dev_conf->nb_event_queue_flows,
+				info.max_event_queue_flows);
+		return -EINVAL;
+	}
+	if (dev_conf->nb_event_port_dequeue_depth == 0 ||
+			dev_conf->nb_event_port_dequeue_depth >
+				info.max_event_port_dequeue_depth) {
+		RTE_EDEV_LOG_ERR("dev%d invalid nb_event_port_dequeue_depth=%u"
+				" (max=%u)", dev_id,
+				dev_conf->nb_event_port_dequeue_depth,
+				info.max_event_port_dequeue_depth);
+		return -EINVAL;
+	}
+	if (dev_conf->nb_event_port_enqueue_depth == 0 ||
+			dev_conf->nb_event_port_enqueue_depth >
+				info.max_event_port_enqueue_depth) {
+		RTE_EDEV_LOG_ERR("dev%d invalid nb_event_port_enqueue_depth=%u"
+				" (max=%u)", dev_id,
+				dev_conf->nb_event_port_enqueue_depth,
+				info.max_event_port_enqueue_depth);
+		return -EINVAL;
+	}
+
+	diag = rte_event_dev_arrays_config(dev, dev_conf->nb_event_queues,
+			dev_conf->nb_event_ports);
+	if (diag != 0) {
+		RTE_EDEV_LOG_ERR("dev%d cannot allocate queues and ports",
+				dev_id);
+		return diag;
+	}
+
+	memcpy(&dev->data->dev_conf, dev_conf, sizeof(dev->data->dev_conf));
+	if (dev->data->dev_conf.dequeue_timeout_ns == 0)
+		dev->data->dev_conf.dequeue_timeout_ns =
+			info.dequeue_timeout_ns;
+
+	diag = (*dev->dev_ops->dev_configure)(dev);
+	if (diag != 0) {
+		RTE_EDEV_LOG_ERR("dev%d dev_configure = %d", dev_id, diag);
+		rte_event_dev_arrays_config(dev, 0, 0);
+		return diag;
+	}
+
+	return 0;
+}
+
+int
+rte_event_queue_default_conf_get(uint8_t dev_id, uint8_t queue_id,
+		struct rte_event_queue_conf *queue_conf)
+{
+	struct rte_eventdev *dev;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	dev = &rte_event_devices[dev_id];
+
+	if (queue_conf == NULL)
+		return -EINVAL;
+
+	if (queue_id >= dev->data->nb_queues) {
+		RTE_EDEV_LOG_ERR("Invalid queue_id=%" PRIu8, queue_id);
+		return -EINVAL;
+	}
+
+	RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->queue_def_conf, -ENOTSUP);
+	memset(queue_conf, 0, sizeof(struct rte_event_queue_conf));
+	(*dev->dev_ops->queue_def_conf)(dev, queue_id, queue_conf);
+	return 0;
+}
+
+int
+rte_event_queue_setup(uint8_t dev_id, uint8_t queue_id,
+		const struct rte_event_queue_conf *queue_conf)
+{
+	struct rte_eventdev *dev;
+	struct rte_event_queue_conf def_conf;
+	uint32_t type, max_flows;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	dev = &rte_event_devices[dev_id];
+
+	if (queue_id >= dev->data->nb_queues) {
+		RTE_EDEV_LOG_ERR("Invalid queue_id=%" PRIu8, queue_id);
+		return -EINVAL;
+	}
+
+	if (queue_conf != NULL) {
+		max_flows = dev->data->dev_conf.nb_event_queue_flows;
+		type = queue_conf->event_queue_cfg &
+			RTE_EVENT_QUEUE_CFG_TYPE_MASK;
+		if ((type == RTE_EVENT_QUEUE_CFG_ALL_TYPES ||
+				type == RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY) &&
+				queue_conf->nb_atomic_flows > max_flows) {
+			RTE_EDEV_LOG_ERR("dev%d queue%d invalid "
+					"nb_atomic_flows=%u (max=%u)",
+					dev_id, queue_id,
+					queue_conf->nb_atomic_flows, max_flows);
+			return -EINVAL;
+		}
+		if ((type == RTE_EVENT_QUEUE_CFG_ALL_TYPES ||
+				type == RTE_EVENT_QUEUE_CFG_ORDERED_ONLY) &&
+				queue_conf->nb_atomic_order_sequences >
+				max_flows) {
+			RTE_EDEV_LOG_ERR("dev%d queue%d invalid "
+					"nb_atomic_order_sequences=%u (max=%u)",
+					dev_id, queue_id,
+					queue_conf->nb_atomic_order_sequences,
+					max_flows);
+			return -EINVAL;
+		}
+	}
+
+	if (dev->data->dev_started) {
+		RTE_EDEV_LOG_ERR("device %d must be stopped to allow queue "
+				"setup", dev_id);
+		return -EBUSY;
+	}
+
+	RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->queue_setup, -ENOTSUP);
+
+	if (queue_conf == NULL) {
+		RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->queue_def_conf,
+				-ENOTSUP);
+		(*dev->dev_ops->queue_def_conf)(dev, queue_id, &def_conf);
+		queue_conf = &def_conf;
+	}
+
+	dev->data->queues_prio[queue_id] = queue_conf->priority;
+	return (*dev->dev_ops->queue_setup)(dev, queue_id, queue_conf);
+}
+
+uint8_t
+rte_event_queue_count(uint8_t dev_id)
+{
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, 0);
+
+	return rte_event_devices[dev_id].data->nb_queues;
+}
+
+int
+rte_event_port_default_conf_get(uint8_t dev_id, uint8_t port_id,
+		struct rte_event_port_conf *port_conf)
+{
+	struct rte_eventdev *dev;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	dev = &rte_event_devices[dev_id];
+
+	if (port_conf == NULL)
+		return -EINVAL;
+
+	if (port_id >= dev->data->nb_ports) {
+		RTE_EDEV_LOG_ERR("Invalid port_id=%" PRIu8, port_id);
+		return -EINVAL;
+	}
+
+	RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->port_def_conf, -ENOTSUP);
+	memset(port_conf, 0, sizeof(struct rte_event_port_conf));
+	(*dev->dev_ops->port_def_conf)(dev, port_id, port_conf);
+	return 0;
+}
+
+int
+rte_event_port_setup(uint8_t dev_id, uint8_t port_id,
+		const struct rte_event_port_conf *port_conf)
+{
+	struct rte_eventdev *dev;
+	struct rte_event_port_conf def_conf;
+	int diag;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	dev = &rte_event_devices[dev_id];
+
+	if (port_id >= dev->data->nb_ports) {
+		RTE_EDEV_LOG_ERR("Invalid port_id=%" PRIu8, port_id);
+		return -EINVAL;
+	}
+
+	if (port_conf != NULL) {
+		if (port_conf->new_event_threshold <= 0 ||
+				port_conf->new_event_threshold >
+				dev->data->dev_conf.nb_events_limit) {
+			RTE_EDEV_LOG_ERR("dev%d port%d invalid "
+					"new_event_threshold=%d (max=%d)",
+					dev_id, port_id,
+					port_conf->new_event_threshold,
+					dev->data->dev_conf.nb_events_limit);
+			return -EINVAL;
+		}
+		if (port_conf->dequeue_depth == 0 ||
+				port_conf->dequeue_depth >
+			dev->data->dev_conf.nb_event_port_dequeue_depth) {
+			RTE_EDEV_LOG_ERR("dev%d port%d invalid dequeue_depth=%u"
+					" (max=%u)", dev_id, port_id,
+					port_conf->dequeue_depth,
+			dev->data->dev_conf.nb_event_port_dequeue_depth);
+			return -EINVAL;
+		}
+		if (port_conf->enqueue_depth == 0 ||
+				port_conf->enqueue_depth >
+			dev->data->dev_conf.nb_event_port_enqueue_depth) {
+			RTE_EDEV_LOG_ERR("dev%d port%d invalid enqueue_depth=%u"
+					" (max=%u)", dev_id, port_id,
+					port_conf->enqueue_depth,
+			dev->data->dev_conf.nb_event_port_enqueue_depth);
+			return -EINVAL;
+		}
+	}
+
+	if (dev->data->dev_started) {
+		RTE_EDEV_LOG_ERR("device %d must be stopped to allow port "
+				"setup", dev_id);
+		return -EBUSY;
+	}
+
+	RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->port_setup, -ENOTSUP);
+
+	if (port_conf == NULL) {
+		RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->port_def_conf,
+				-ENOTSUP);
+		(*dev->dev_ops->port_def_conf)(dev, port_id, &def_conf);
+		port_conf = &def_conf;
+	}
+
+	if (dev->data->ports[port_id] != NULL &&
+			dev->dev_ops->port_release != NULL) {
+		(*dev->dev_ops->port_release)(dev->data->ports[port_id]);
+		dev->data->ports[port_id] = NULL;
+	}
+
+	diag = (*dev->dev_ops->port_setup)(dev, port_id, port_conf);
+	if (diag < 0)
+		return diag;
+
+	dev->data->ports_dequeue_depth[port_id] = port_conf->dequeue_depth;
+	dev->data->ports_enqueue_depth[port_id] = port_conf->enqueue_depth;
+
+	/* A new port starts unlinked. */
+	rte_event_port_unlink(dev_id, port_id, NULL, 0);
+	return 0;
+}
+
+uint8_t
+rte_event_port_count(uint8_t dev_id)
+{
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, 0);
+
+	return rte_event_devices[dev_id].data->nb_ports;
+}
+
+int
+rte_event_port_link(uint8_t dev_id, uint8_t port_id,
+		const uint8_t queues[], const uint8_t priorities[],
+		uint16_t nb_links)
+{
+	struct rte_eventdev *dev;
+	uint8_t queues_list[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	uint8_t priorities_list[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	uint16_t *links_map;
+	int i, diag;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERRNO_RET(dev_id, EINVAL, 0);
+	dev = &rte_event_devices[dev_id];
+	RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->port_link, 0);
+
+	if (port_id >= dev->data->nb_ports ||
+			dev->data->ports[port_id] == NULL) {
+		RTE_EDEV_LOG_ERR("Invalid port_id=%" PRIu8, port_id);
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	if (queues == NULL) {
+		for (i = 0; i < dev->data->nb_queues; i++)
+			queues_list[i] = i;
+		queues = queues_list;
+		nb_links = dev->data->nb_queues;
+	}
+
+	if (priorities == NULL) {
+		for (i = 0; i < nb_links && i < RTE_EVENT_MAX_QUEUES_PER_DEV;
+				i++)
+			priorities_list[i] = RTE_EVENT_DEV_PRIORITY_NORMAL;
+		priorities = priorities_list;
+	}
+
+	for (i = 0; i < nb_links; i++)
+		if (queues[i] >= dev->data->nb_queues) {
+			rte_errno = EINVAL;
+			return 0;
+		}
+
+	diag = (*dev->dev_ops->port_link)(dev, dev->data->ports[port_id],
+			queues, priorities, nb_links);
+	if (diag < 0)
+		return diag;
+
+	links_map = dev->data->links_map +
+		port_id * RTE_EVENT_MAX_QUEUES_PER_DEV;
+	for (i = 0; i < diag; i++)
+		links_map[queues[i]] = (uint8_t)priorities[i];
+
+	return diag;
+}
+
+int
+rte_event_port_unlink(uint8_t dev_id, uint8_t port_id,
+		uint8_t queues[], uint16_t nb_unlinks)
+{
+	struct rte_eventdev *dev;
+	uint8_t all_queues[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	uint16_t *links_map;
+	int i, diag;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERRNO_RET(dev_id, EINVAL, 0);
+	dev = &rte_event_devices[dev_id];
+	RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->port_unlink, 0);
+
+	if (port_id >= dev->data->nb_ports ||
+			dev->data->ports[port_id] == NULL) {
+		RTE_EDEV_LOG_ERR("Invalid port_id=%" PRIu8, port_id);
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	if (queues == NULL) {
+		for (i = 0; i < dev->data->nb_queues; i++)
+			all_queues[i] = i;
+		queues = all_queues;
+		nb_unlinks = dev->data->nb_queues;
+	}
+
+	for (i = 0; i < nb_unlinks; i++)
+		if (queues[i] >= dev->data->nb_queues) {
+			rte_errno = EINVAL;
+			return 0;
+		}
+
+	diag = (*dev->dev_ops->port_unlink)(dev, dev->data->ports[port_id],
+			queues, nb_unlinks);
+	if (diag < 0)
+		return diag;
+
+	links_map = dev->data->links_map +
+		port_id * RTE_EVENT_MAX_QUEUES_PER_DEV;
+	for (i = 0; i < diag; i++)
+		links_map[queues[i]] = RTE_EVENT_QUEUE_LINK_INVALID;
+
+	return diag;
+}
+
+int
+rte_event_port_links_get(uint8_t dev_id, uint8_t port_id,
+		uint8_t queues[], uint8_t priorities[])
+{
+	struct rte_eventdev *dev;
+	uint16_t *links_map;
+	int i, count = 0;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	dev = &rte_event_devices[dev_id];
+
+	if (port_id >= dev->data->nb_ports) {
+		RTE_EDEV_LOG_ERR("Invalid port_id=%" PRIu8, port_id);
+		return -EINVAL;
+	}
+
+	links_map = dev->data->links_map +
+		port_id * RTE_EVENT_MAX_QUEUES_PER_DEV;
+	for (i = 0; i < dev->data->nb_queues; i++) {
+		if (links_map[i] != RTE_EVENT_QUEUE_LINK_INVALID) {
+			queues[count] = i;
+			priorities[count] = (uint8_t)links_map[i];
+			++count;
+		}
+	}
+	return count;
+}
+
+int
+rte_event_dequeue_timeout_ticks(uint8_t dev_id, uint64_t ns,
+		uint64_t *timeout_ticks)
+{
+	struct rte_eventdev *dev;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	dev = &rte_event_devices[dev_id];
+	RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->timeout_ticks, -ENOTSUP);
+
+	if (timeout_ticks == NULL)
+		return -EINVAL;
+
+	return (*dev->dev_ops->timeout_ticks)(dev, ns, timeout_ticks);
+}
+
+int
+rte_event_dev_dump(uint8_t dev_id, FILE *f)
+{
+	struct rte_eventdev *dev;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	dev = &rte_event_devices[dev_id];
+	RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->dump, -ENOTSUP);
+
+	(*dev->dev_ops->dump)(dev, f);
+	return 0;
+}
+
+int
+rte_event_dev_start(uint8_t dev_id)
+{
+	struct rte_eventdev *dev;
+	int diag;
+	unsigned int i;
+
+	RTE_EDEV_LOG_DEBUG("Start dev_id=%" PRIu8, dev_id);
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	dev = &rte_event_devices[dev_id];
+	RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->dev_start, -ENOTSUP);
+
+	if (dev->data->dev_started != 0) {
+		RTE_EDEV_LOG_ERR("Device with dev_id=%" PRIu8 " already "
+				"started", dev_id);
+		return 0;
+	}
+
+	if (dev->data->nb_ports == 0) {
+		RTE_EDEV_LOG_ERR("Device with dev_id=%" PRIu8 " not "
+				"configured", dev_id);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < dev->data->nb_ports; i++)
+		if (dev->data->ports[i] == NULL) {
+			RTE_EDEV_LOG_ERR("dev%d port%u not set up",
+					dev_id, i);
+			return -EINVAL;
+		}
+
+	diag = (*dev->dev_ops->dev_start)(dev);
+	if (diag == 0)
+		dev->data->dev_started = 1;
+	else
+		return diag;
+
+	return 0;
+}
+
+void
+rte_event_dev_stop(uint8_t dev_id)
+{
+	struct rte_eventdev *dev;
+
+	RTE_EDEV_LOG_DEBUG("Stop dev_id=%" PRIu8, dev_id);
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, );
+	dev = &rte_event_devices[dev_id];
+	RTE_FUNC_PTR_OR_RET(*dev->dev_ops->dev_stop);
+
+	if (dev->data->dev_started == 0) {
+		RTE_EDEV_LOG_ERR("Device with dev_id=%" PRIu8 " already "
+				"stopped", dev_id);
+		return;
+	}
+
+	dev->data->dev_started = 0;
+	(*dev->dev_ops->dev_stop)(dev);
+}
+
+int
+rte_event_dev_close(uint8_t dev_id)
+{
+	struct rte_eventdev *dev;
+	int diag;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	dev = &rte_event_devices[dev_id];
+	RTE_FUNC_PTR_OR_ERR_RET(*dev->dev_ops->dev_close, -ENOTSUP);
+
+	if (dev->data->dev_started) {
+		RTE_EDEV_LOG_ERR("Device %u must be stopped before closing",
+				dev_id);
+		return -EBUSY;
+	}
+
+	rte_event_dev_arrays_config(dev, 0, 0);
+
+	diag = (*dev->dev_ops->dev_close)(dev);
+	if (diag < 0)
+		return diag;
+
+	return 0;
+}
+
+static int
+rte_event_pmd_data_alloc(uint8_t dev_id, struct rte_eventdev_data **data,
+		int socket_id)
+{
+	char mz_name[RTE_EVENTDEV_NAME_MAX_LEN];
+	const struct rte_memzone *mz;
+	int n;
+
+	/* generate memzone name */
+	n = snprintf(mz_name, sizeof(mz_name), "rte_eventdev_data_%u", dev_id);
+	if (n >= (int)sizeof(mz_name))
+		return -EINVAL;
+
+	if (rte_eal_process_type() == RTE_PROC_PRIMARY)
+		mz = rte_memzone_reserve(mz_name,
+				sizeof(struct rte_eventdev_data),
+				socket_id, 0);
+	else
+		mz = rte_memzone_lookup(mz_name);
+
+	if (mz == NULL)
+		return -ENOMEM;
+
+	*data = mz->addr;
+	if (rte_eal_process_type() == RTE_PROC_PRIMARY)
+		memset(*data, 0, sizeof(struct rte_eventdev_data));
+
+	return 0;
+}
+
+static uint8_t
+rte_event_pmd_find_free_device_index(void)
+{
+	uint8_t dev_id;
+
+	for (dev_id = 0; dev_id < RTE_EVENT_MAX_DEVS; dev_id++)
+		if (!rte_event_devices[dev_id].attached)
+			return dev_id;
+	return RTE_EVENT_MAX_DEVS;
+}
+
+struct rte_eventdev *
+rte_event_pmd_get_named_dev(const char *name)
+{
+	int dev_id = rte_event_dev_get_dev_id(name);
+
+	if (dev_id < 0)
+		return NULL;
+	return &rte_event_devices[dev_id];
+}
+
+struct rte_eventdev *
+rte_event_pmd_allocate(const char *name, int socket_id)
+{
+	struct rte_eventdev *eventdev;
+	uint8_t dev_id;
+
+	if (rte_event_pmd_get_named_dev(name) != NULL) {
+		RTE_EDEV_LOG_ERR("Event device with name %s already "
+				"allocated!", name);
+		return NULL;
+	}
+
+	dev_id = rte_event_pmd_find_free_device_index();
+	if (dev_id == RTE_EVENT_MAX_DEVS) {
+		RTE_EDEV_LOG_ERR("Reached maximum number of event devices");
+		return NULL;
+	}
+
+	eventdev = &rte_event_devices[dev_id];
+
+	if (eventdev->data == NULL) {
+		struct rte_eventdev_data *eventdev_data = NULL;
+		int retval = rte_event_pmd_data_alloc(dev_id, &eventdev_data,
+				socket_id);
+
+		if (retval < 0 || eventdev_data == NULL)
+			return NULL;
+
+		eventdev->data = eventdev_data;
+	}
+
+	snprintf(eventdev->data->name, RTE_EVENTDEV_NAME_MAX_LEN, "%s", name);
+	eventdev->data->dev_id = dev_id;
+	eventdev->data->socket_id = socket_id;
+	eventdev->data->dev_started = 0;
+	eventdev->attached = 1;
+	nb_eventdevs++;
+
+	return eventdev;
+}
+
+int
+rte_event_pmd_release(struct rte_eventdev *eventdev)
+{
+	if (eventdev == NULL)
+		return -EINVAL;
+
+	eventdev->attached = 0;
+	nb_eventdevs--;
+	return 0;
+}
+
+struct rte_eventdev *
+rte_event_pmd_vdev_init(const char *name, size_t dev_private_size,
+		int socket_id)
+{
+	struct rte_eventdev *eventdev;
+
+	/* allocate device structure */
+	eventdev = rte_event_pmd_allocate(name, socket_id);
+	if (eventdev == NULL)
+		return NULL;
+
+	/* allocate private device structure */
+	if (rte_eal_process_type() == RTE_PROC_PRIMARY) {
+		eventdev->data->dev_private =
+				rte_zmalloc_socket("eventdev device private",
+						dev_private_size,
+						RTE_CACHE_LINE_SIZE,
+						socket_id);
+
+		if (eventdev->data->dev_private == NULL) {
+			RTE_EDEV_LOG_ERR("Cannot allocate private data of "
+					"event device %s", name);
+			rte_event_pmd_release(eventdev);
+			return NULL;
+		}
+	}
+
+	return eventdev;
+}
+
+int
+rte_event_pmd_vdev_uninit(const char *name)
+{
+	struct rte_eventdev *eventdev;
+
+	if (name == NULL)
+		return -EINVAL;
+
+	eventdev = rte_event_pmd_get_named_dev(name);
+	if (eventdev == NULL)
+		return -ENODEV;
+
+	if (eventdev->data->dev_started) {
+		RTE_EDEV_LOG_ERR("Event device %s must be stopped before "
+				"uninit", name);
+		return -EBUSY;
+	}
+
+	if (rte_eal_process_type() == RTE_PROC_PRIMARY) {
+		rte_free(eventdev->data->dev_private);
+		eventdev->data->dev_private = NULL;
+	}
+
+	return rte_event_pmd_release(eventdev);
+}
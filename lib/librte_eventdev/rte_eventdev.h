@@ -0,0 +1,714 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_EVENTDEV_H_
+#define _RTE_EVENTDEV_H_
+
+/**
+ * @file
+ * RTE event device
+ *
+ * An event device schedules events, each carrying a flow ID, a destination
+ * event queue and a schedule type, to the event ports polled by the worker
+ * lcores, balancing the load dynamically among them:
+ *
+ * - RTE_SCHED_TYPE_ATOMIC: the events of a flow are processed by one port
+ *   at a time, in order, which removes the need for locks on flow state;
+ * - RTE_SCHED_TYPE_ORDERED: the events of a flow are processed in parallel
+ *   by several ports, and the device restores their original order when
+ *   they are forwarded to the next queue;
+ * - RTE_SCHED_TYPE_PARALLEL: the events are processed in parallel, without
+ *   ordering.
+ *
+ * A pipeline is built by linking each port to the queues it serves. A worker
+ * dequeues events from its port, processes them, then forwards them to the
+ * queue of the next stage (RTE_EVENT_OP_FORWARD) or releases them
+ * (RTE_EVENT_OP_RELEASE). The events not forwarded nor released are
+ * released implicitly by the next dequeue from the same port. Events enter
+ * the device with RTE_EVENT_OP_NEW.
+ *
+ * Devices which schedule in hardware advertise
+ * RTE_EVENT_DEV_CAP_DISTRIBUTED_SCHED. The others, such as the software
+ * scheduler, need rte_event_schedule() to be called repeatedly by a
+ * dedicated lcore.
+ *
+ * The application uses the device as follows:
+ *
+ * - rte_event_dev_configure()
+ * - rte_event_queue_setup() for each queue
+ * - rte_event_port_setup() for each port
+ * - rte_event_port_link() for each port
+ * - rte_event_dev_start()
+ * - rte_event_enqueue_burst() and rte_event_dequeue_burst() on the worker
+ *   lcores, each port being used by a single lcore
+ * - rte_event_dev_stop() and rte_event_dev_close()
+ *
+ * The enqueue and dequeue functions are not thread safe for a given port.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_errno.h>
+
+struct rte_mbuf;
+
+/* Event device capabilities */
+#define RTE_EVENT_DEV_CAP_QUEUE_QOS         (1ULL << 0)
+/**< Event queue priorities are honoured by the scheduler. */
+#define RTE_EVENT_DEV_CAP_EVENT_QOS         (1ULL << 1)
+/**< Event priorities are honoured by the scheduler within a queue. */
+#define RTE_EVENT_DEV_CAP_DISTRIBUTED_SCHED (1ULL << 2)
+/**< Scheduling is done in hardware or by the enqueue and dequeue calls,
+ * rte_event_schedule() is not needed.
+ */
+
+/* Event priority levels */
+#define RTE_EVENT_DEV_PRIORITY_HIGHEST   0
+/**< Highest priority of an event queue or an event. */
+#define RTE_EVENT_DEV_PRIORITY_NORMAL    128
+/**< Normal priority of an event queue or an event. */
+#define RTE_EVENT_DEV_PRIORITY_LOWEST    255
+/**< Lowest priority of an event queue or an event. */
+
+/**
+ * Get the total number of event devices.
+ *
+ * @return
+ *   The number of event devices.
+ */
+uint8_t
+rte_event_dev_count(void);
+
+/**
+ * Get the device identifier of a named event device.
+ *
+ * @param name
+ *   Event device name.
+ *
+ * @return
+ *   The device identifier on success, -ENODEV if no device has this name.
+ */
+int
+rte_event_dev_get_dev_id(const char *name);
+
+/**
+ * Get the NUMA socket of an event device.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ *
+ * @return
+ *   The NUMA socket, SOCKET_ID_ANY if unknown, -EINVAL on invalid device.
+ */
+int
+rte_event_dev_socket_id(uint8_t dev_id);
+
+/** Event device information. */
+struct rte_event_dev_info {
+	const char *driver_name;        /**< Event driver name. */
+	uint32_t min_dequeue_timeout_ns;
+	/**< Minimum supported dequeue timeout, in ns. */
+	uint32_t max_dequeue_timeout_ns;
+	/**< Maximum supported dequeue timeout, in ns. */
+	uint32_t dequeue_timeout_ns;
+	/**< Default dequeue timeout, in ns. */
+	uint8_t max_event_queues;       /**< Maximum number of event queues. */
+	uint32_t max_event_queue_flows;
+	/**< Maximum number of flows of an event queue. */
+	uint8_t max_event_queue_priority_levels;
+	/**< Number of event queue priority levels, with QUEUE_QOS. */
+	uint8_t max_event_priority_levels;
+	/**< Number of event priority levels, with EVENT_QOS. */
+	uint8_t max_event_ports;        /**< Maximum number of event ports. */
+	uint32_t max_event_port_dequeue_depth;
+	/**< Maximum dequeue depth of an event port. */
+	uint32_t max_event_port_enqueue_depth;
+	/**< Maximum enqueue depth of an event port. */
+	int32_t max_num_events;
+	/**< Maximum number of events in flight in the device. */
+	uint32_t event_dev_cap;         /**< RTE_EVENT_DEV_CAP_ flags. */
+};
+
+/**
+ * Retrieve the information of an event device.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ * @param[out] dev_info
+ *   Where to store the information.
+ *
+ * @return
+ *   0 on success, a negative value on error.
+ */
+int
+rte_event_dev_info_get(uint8_t dev_id, struct rte_event_dev_info *dev_info);
+
+/* Event device configuration flags */
+#define RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT (1ULL << 0)
+/**< The timeout of each rte_event_dequeue_burst() call is given by its
+ * timeout_ticks argument, instead of dequeue_timeout_ns.
+ */
+
+/** Event device configuration. */
+struct rte_event_dev_config {
+	uint32_t dequeue_timeout_ns;
+	/**< Dequeue timeout of all ports, in ns, 0 for the default of the
+	 * device. Ignored with RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT.
+	 */
+	int32_t nb_events_limit;
+	/**< Maximum number of events in flight in the device, at most
+	 * max_num_events. It bounds the new events accepted.
+	 */
+	uint8_t nb_event_queues;        /**< Number of event queues. */
+	uint8_t nb_event_ports;         /**< Number of event ports. */
+	uint32_t nb_event_queue_flows;  /**< Number of flows per queue. */
+	uint32_t nb_event_port_dequeue_depth;
+	/**< Maximum dequeue depth of the ports. */
+	uint32_t nb_event_port_enqueue_depth;
+	/**< Maximum enqueue depth of the ports. */
+	uint32_t event_dev_cfg;         /**< RTE_EVENT_DEV_CFG_ flags. */
+};
+
+/**
+ * Configure an event device. It must be stopped. Queues and ports must be
+ * set up again afterwards.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ * @param dev_conf
+ *   Configuration.
+ *
+ * @return
+ *   0 on success, -EINVAL on invalid configuration, -EBUSY if the device is
+ *   started, or another negative value on driver error.
+ */
+int
+rte_event_dev_configure(uint8_t dev_id,
+		const struct rte_event_dev_config *dev_conf);
+
+/* Event queue configuration flags */
+#define RTE_EVENT_QUEUE_CFG_TYPE_MASK      (3 << 0)
+/**< Mask of the schedule types accepted by the queue. */
+#define RTE_EVENT_QUEUE_CFG_ALL_TYPES      (0 << 0)
+/**< The queue schedules each event according to its sched_type. */
+#define RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY    (1 << 0)
+/**< The queue only schedules atomic events. */
+#define RTE_EVENT_QUEUE_CFG_ORDERED_ONLY   (2 << 0)
+/**< The queue only schedules ordered events. */
+#define RTE_EVENT_QUEUE_CFG_PARALLEL_ONLY  (3 << 0)
+/**< The queue only schedules parallel events. */
+#define RTE_EVENT_QUEUE_CFG_SINGLE_LINK    (1 << 2)
+/**< The queue is linked to a single port, e.g. to feed a TX lcore. */
+
+/** Event queue configuration. */
+struct rte_event_queue_conf {
+	uint32_t nb_atomic_flows;
+	/**< Number of atomic flows, at most nb_event_queue_flows. */
+	uint32_t nb_atomic_order_sequences;
+	/**< Number of ordered events of the queue in flight at once. */
+	uint32_t event_queue_cfg;       /**< RTE_EVENT_QUEUE_CFG_ flags. */
+	uint8_t priority;
+	/**< Priority of the queue, from RTE_EVENT_DEV_PRIORITY_HIGHEST to
+	 * RTE_EVENT_DEV_PRIORITY_LOWEST, with QUEUE_QOS.
+	 */
+};
+
+/**
+ * Retrieve the default configuration of an event queue.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ * @param queue_id
+ *   Event queue identifier.
+ * @param[out] queue_conf
+ *   Where to store the configuration.
+ *
+ * @return
+ *   0 on success, a negative value on error.
+ */
+int
+rte_event_queue_default_conf_get(uint8_t dev_id, uint8_t queue_id,
+		struct rte_event_queue_conf *queue_conf);
+
+/**
+ * Set up an event queue of a configured and stopped device.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ * @param queue_id
+ *   Event queue identifier, below nb_event_queues.
+ * @param queue_conf
+ *   Configuration, or NULL for the default one.
+ *
+ * @return
+ *   0 on success, a negative value on error.
+ */
+int
+rte_event_queue_setup(uint8_t dev_id, uint8_t queue_id,
+		const struct rte_event_queue_conf *queue_conf);
+
+/**
+ * Get the number of event queues of a device.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ *
+ * @return
+ *   The number of configured event queues.
+ */
+uint8_t
+rte_event_queue_count(uint8_t dev_id);
+
+/** Event port configuration. */
+struct rte_event_port_conf {
+	int32_t new_event_threshold;
+	/**< Number of events in flight in the device above which the new
+	 * events enqueued through this port are refused, at most
+	 * nb_events_limit.
+	 */
+	uint16_t dequeue_depth;
+	/**< Number of events which can be scheduled to the port at once. */
+	uint16_t enqueue_depth;
+	/**< Number of events which can be enqueued to the port at once. */
+};
+
+/**
+ * Retrieve the default configuration of an event port.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ * @param port_id
+ *   Event port identifier.
+ * @param[out] port_conf
+ *   Where to store the configuration.
+ *
+ * @return
+ *   0 on success, a negative value on error.
+ */
+int
+rte_event_port_default_conf_get(uint8_t dev_id, uint8_t port_id,
+		struct rte_event_port_conf *port_conf);
+
+/**
+ * Set up an event port of a configured and stopped device.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ * @param port_id
+ *   Event port identifier, below nb_event_ports.
+ * @param port_conf
+ *   Configuration, or NULL for the default one.
+ *
+ * @return
+ *   0 on success, a negative value on error.
+ */
+int
+rte_event_port_setup(uint8_t dev_id, uint8_t port_id,
+		const struct rte_event_port_conf *port_conf);
+
+/**
+ * Get the number of event ports of a device.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ *
+ * @return
+ *   The number of configured event ports.
+ */
+uint8_t
+rte_event_port_count(uint8_t dev_id);
+
+/**
+ * Start an event device. All queues and ports must be set up.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ *
+ * @return
+ *   0 on success, a negative value on error.
+ */
+int
+rte_event_dev_start(uint8_t dev_id);
+
+/**
+ * Stop an event device. The events in flight are dropped when it is
+ * started again.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ */
+void
+rte_event_dev_stop(uint8_t dev_id);
+
+/**
+ * Close a stopped event device and free its resources.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ *
+ * @return
+ *   0 on success, -EBUSY if the device is started, another negative value
+ *   on error.
+ */
+int
+rte_event_dev_close(uint8_t dev_id);
+
+/* Event types */
+#define RTE_EVENT_TYPE_ETHDEV           0x0
+/**< The event was generated from an ethdev, e.g. a received packet. */
+#define RTE_EVENT_TYPE_CRYPTODEV        0x1
+/**< The event was generated from a cryptodev. */
+#define RTE_EVENT_TYPE_TIMERDEV         0x2
+/**< The event was generated from a timer. */
+#define RTE_EVENT_TYPE_CPU              0x3
+/**< The event was generated by an lcore, e.g. a pipeline stage. */
+#define RTE_EVENT_TYPE_MAX              0x10
+/**< Maximum number of event types. */
+
+/* Schedule types */
+#define RTE_SCHED_TYPE_ORDERED          0
+/**< Ordered scheduling, see the file description. */
+#define RTE_SCHED_TYPE_ATOMIC           1
+/**< Atomic scheduling, see the file description. */
+#define RTE_SCHED_TYPE_PARALLEL         2
+/**< Parallel scheduling, see the file description. */
+
+/* Enqueue operations */
+#define RTE_EVENT_OP_NEW                0
+/**< A new event enters the device, within the new_event_threshold of the
+ * port.
+ */
+#define RTE_EVENT_OP_FORWARD            1
+/**< The oldest event dequeued from the port and not yet forwarded nor
+ * released is forwarded to another queue, keeping its order.
+ */
+#define RTE_EVENT_OP_RELEASE            2
+/**< The oldest event dequeued from the port and not yet forwarded nor
+ * released leaves the device, releasing its atomic or ordered context.
+ * Only the op field of the event is used.
+ */
+
+/** Event, 16 bytes. */
+struct rte_event {
+	/** WORD0 */
+	union {
+		uint64_t event;
+		/** Event attributes for dequeue or enqueue operation */
+		struct {
+			uint32_t flow_id:20;
+			/**< Flow ID, for atomic and ordered scheduling. */
+			uint32_t sub_event_type:8;
+			/**< Application defined sub type. */
+			uint32_t event_type:4;
+			/**< RTE_EVENT_TYPE_ of the event source. */
+			uint8_t op:2;
+			/**< RTE_EVENT_OP_ on enqueue. */
+			uint8_t rsvd:4;
+			/**< Reserved, must be 0. */
+			uint8_t sched_type:2;
+			/**< RTE_SCHED_TYPE_ in the destination queue. */
+			uint8_t queue_id;
+			/**< Destination event queue on enqueue, source queue
+			 * on dequeue.
+			 */
+			uint8_t priority;
+			/**< Event priority, with EVENT_QOS. */
+			uint8_t impl_opaque;
+			/**< Reserved for the driver, not preserved. */
+		};
+	};
+	/** WORD1 */
+	union {
+		uint64_t u64;          /**< Opaque 64-bit value. */
+		void *event_ptr;       /**< Opaque pointer. */
+		struct rte_mbuf *mbuf; /**< Packet carried by the event. */
+	};
+};
+
+struct rte_eventdev;
+
+/** @internal Schedules events, for devices without DISTRIBUTED_SCHED. */
+typedef void (*event_schedule_t)(struct rte_eventdev *dev);
+
+/** @internal Enqueues a burst of events on a port. */
+typedef uint16_t (*event_enqueue_burst_t)(void *port,
+		const struct rte_event ev[], uint16_t nb_events);
+
+/** @internal Dequeues a burst of events from a port. */
+typedef uint16_t (*event_dequeue_burst_t)(void *port, struct rte_event ev[],
+		uint16_t nb_events, uint64_t timeout_ticks);
+
+#define RTE_EVENTDEV_NAME_MAX_LEN 64
+/**< Maximum length of an event device name. */
+
+#define RTE_EVENT_QUEUE_LINK_INVALID 0xdead
+/**< @internal Value of the links map for an unlinked queue. */
+
+/**
+ * @internal
+ * Data of an event device, shared by the library and the driver.
+ */
+struct rte_eventdev_data {
+	int socket_id;                  /**< Socket of the device memory. */
+	uint8_t dev_id;                 /**< Device identifier. */
+	uint8_t nb_queues;              /**< Number of configured queues. */
+	uint8_t nb_ports;               /**< Number of configured ports. */
+	void **ports;                   /**< Driver port of each port. */
+	uint16_t *ports_dequeue_depth;  /**< Dequeue depth of each port. */
+	uint16_t *ports_enqueue_depth;  /**< Enqueue depth of each port. */
+	uint8_t *queues_prio;           /**< Priority of each queue. */
+	uint16_t *links_map;
+	/**< Priority of the link of each port to each queue, or
+	 * RTE_EVENT_QUEUE_LINK_INVALID, indexed by
+	 * port * RTE_EVENT_MAX_QUEUES_PER_DEV + queue.
+	 */
+	void *dev_private;              /**< Driver private data. */
+	uint32_t event_dev_cap;         /**< RTE_EVENT_DEV_CAP_ flags. */
+	struct rte_event_dev_config dev_conf; /**< Configuration. */
+	uint8_t dev_started : 1;        /**< Device started. */
+	char name[RTE_EVENTDEV_NAME_MAX_LEN]; /**< Device name. */
+} __rte_cache_aligned;
+
+/** @internal Event device, with the fast path functions first. */
+struct rte_eventdev {
+	event_schedule_t schedule;      /**< Scheduling function. */
+	event_enqueue_burst_t enqueue_burst; /**< Enqueue function. */
+	event_dequeue_burst_t dequeue_burst; /**< Dequeue function. */
+	struct rte_eventdev_data *data; /**< Device data. */
+	const struct rte_eventdev_ops *dev_ops; /**< Driver operations. */
+	uint8_t attached : 1;           /**< Device allocated. */
+} __rte_cache_aligned;
+
+/** @internal Table of event devices. */
+extern struct rte_eventdev *rte_eventdevs;
+
+/**
+ * Schedule events on a device which does not advertise
+ * RTE_EVENT_DEV_CAP_DISTRIBUTED_SCHED. It must be called repeatedly, by a
+ * single lcore at a time, while the device is started.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ */
+static inline void
+rte_event_schedule(uint8_t dev_id)
+{
+	struct rte_eventdev *dev = &rte_eventdevs[dev_id];
+
+	if (dev->schedule != NULL)
+		(*dev->schedule)(dev);
+}
+
+/**
+ * Enqueue a burst of events on a port.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ * @param port_id
+ *   Event port identifier, used by the calling lcore only.
+ * @param ev
+ *   Events to enqueue, with their op field set.
+ * @param nb_events
+ *   Number of events.
+ *
+ * @return
+ *   The number of events enqueued, the first ones of the table. Fewer
+ *   events are enqueued when the port is full or when a new event exceeds
+ *   the new_event_threshold of the port; rte_errno is then set to ENOSPC.
+ */
+static inline uint16_t
+rte_event_enqueue_burst(uint8_t dev_id, uint8_t port_id,
+		const struct rte_event ev[], uint16_t nb_events)
+{
+	const struct rte_eventdev *dev = &rte_eventdevs[dev_id];
+
+#ifdef RTE_LIBRTE_EVENTDEV_DEBUG
+	if (dev_id >= RTE_EVENT_MAX_DEVS || !dev->attached ||
+			port_id >= dev->data->nb_ports) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+#endif
+	return (*dev->enqueue_burst)(dev->data->ports[port_id], ev,
+			nb_events);
+}
+
+/**
+ * Dequeue a burst of events from a port.
+ *
+ * The events previously dequeued from the port and not yet forwarded nor
+ * released are released first.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ * @param port_id
+ *   Event port identifier, used by the calling lcore only.
+ * @param[out] ev
+ *   Where to store the events.
+ * @param nb_events
+ *   Maximum number of events, at most the dequeue depth of the port.
+ * @param timeout_ticks
+ *   With RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT, maximum wait for an event,
+ *   as returned by rte_event_dequeue_timeout_ticks(), 0 to return at once.
+ *   Ignored otherwise.
+ *
+ * @return
+ *   The number of events dequeued.
+ */
+static inline uint16_t
+rte_event_dequeue_burst(uint8_t dev_id, uint8_t port_id,
+		struct rte_event ev[], uint16_t nb_events,
+		uint64_t timeout_ticks)
+{
+	struct rte_eventdev *dev = &rte_eventdevs[dev_id];
+
+#ifdef RTE_LIBRTE_EVENTDEV_DEBUG
+	if (dev_id >= RTE_EVENT_MAX_DEVS || !dev->attached ||
+			port_id >= dev->data->nb_ports) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+#endif
+	return (*dev->dequeue_burst)(dev->data->ports[port_id], ev,
+			nb_events, timeout_ticks);
+}
+
+/**
+ * Convert a dequeue timeout to the unit of the timeout_ticks argument of
+ * rte_event_dequeue_burst().
+ *
+ * @param dev_id
+ *   Event device identifier.
+ * @param ns
+ *   Timeout in ns.
+ * @param[out] timeout_ticks
+ *   Where to store the timeout.
+ *
+ * @return
+ *   0 on success, -ENOTSUP if the device does not support timeouts,
+ *   another negative value on error.
+ */
+int
+rte_event_dequeue_timeout_ticks(uint8_t dev_id, uint64_t ns,
+		uint64_t *timeout_ticks);
+
+/**
+ * Link event queues to a port, so that their events are scheduled to it.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ * @param port_id
+ *   Event port identifier.
+ * @param queues
+ *   Queues to link, or NULL to link all queues.
+ * @param priorities
+ *   Priority of each link, or NULL for RTE_EVENT_DEV_PRIORITY_NORMAL.
+ *   Drivers without QUEUE_QOS ignore them.
+ * @param nb_links
+ *   Number of queues, ignored when queues is NULL.
+ *
+ * @return
+ *   The number of queues linked, the first ones of the table. On error,
+ *   rte_errno is set to EINVAL for invalid arguments, or to EDQUOT when a
+ *   single link queue is already linked to another port.
+ */
+int
+rte_event_port_link(uint8_t dev_id, uint8_t port_id,
+		const uint8_t queues[], const uint8_t priorities[],
+		uint16_t nb_links);
+
+/**
+ * Unlink event queues from a port.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ * @param port_id
+ *   Event port identifier.
+ * @param queues
+ *   Queues to unlink, or NULL to unlink all queues.
+ * @param nb_unlinks
+ *   Number of queues, ignored when queues is NULL.
+ *
+ * @return
+ *   The number of queues unlinked, the first ones of the table. On error,
+ *   rte_errno is set to EINVAL.
+ */
+int
+rte_event_port_unlink(uint8_t dev_id, uint8_t port_id,
+		uint8_t queues[], uint16_t nb_unlinks);
+
+/**
+ * Retrieve the queues linked to a port.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ * @param port_id
+ *   Event port identifier.
+ * @param[out] queues
+ *   Where to store the queues, RTE_EVENT_MAX_QUEUES_PER_DEV entries.
+ * @param[out] priorities
+ *   Where to store the link priorities, RTE_EVENT_MAX_QUEUES_PER_DEV
+ *   entries.
+ *
+ * @return
+ *   The number of linked queues, or a negative value on error.
+ */
+int
+rte_event_port_links_get(uint8_t dev_id, uint8_t port_id,
+		uint8_t queues[], uint8_t priorities[]);
+
+/**
+ * Dump the state of an event device.
+ *
+ * @param dev_id
+ *   Event device identifier.
+ * @param f
+ *   Output stream.
+ *
+ * @return
+ *   0 on success, a negative value on error.
+ */
+int
+rte_event_dev_dump(uint8_t dev_id, FILE *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_EVENTDEV_H_ */
@@ -0,0 +1,237 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_EVENTDEV_PMD_H_
+#define _RTE_EVENTDEV_PMD_H_
+
+/**
+ * @file
+ * RTE event device driver interface
+ *
+ * Operations implemented by the event device drivers, and the functions the
+ * drivers use to register their devices. Not to be used by applications.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h>
+
+#include <rte_dev.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+
+#include "rte_eventdev.h"
+
+#ifdef RTE_LIBRTE_EVENTDEV_DEBUG
+#define RTE_PMD_DEBUG_TRACE(...) \
+	rte_pmd_debug_trace(__func__, __VA_ARGS__)
+#else
+#define RTE_PMD_DEBUG_TRACE(...)
+#endif
+
+#define RTE_EDEV_LOG_ERR(fmt, args...)					\
+	RTE_LOG(ERR, EVENTDEV, "%s() line %u: " fmt "\n",		\
+			__func__, __LINE__, ## args)
+
+#ifdef RTE_LIBRTE_EVENTDEV_DEBUG
+#define RTE_EDEV_LOG_DEBUG(fmt, args...)				\
+	RTE_LOG(DEBUG, EVENTDEV, "%s() line %u: " fmt "\n",		\
+			__func__, __LINE__, ## args)
+#else
+#define RTE_EDEV_LOG_DEBUG(fmt, args...) do { } while (0)
+#endif
+
+/** Retrieve the information of a device. */
+typedef void (*eventdev_info_get_t)(struct rte_eventdev *dev,
+		struct rte_event_dev_info *dev_info);
+
+/** Apply the configuration stored in dev->data->dev_conf. */
+typedef int (*eventdev_configure_t)(const struct rte_eventdev *dev);
+
+/** Start a device. */
+typedef int (*eventdev_start_t)(struct rte_eventdev *dev);
+
+/** Stop a device. */
+typedef void (*eventdev_stop_t)(struct rte_eventdev *dev);
+
+/** Free the resources of a stopped device. */
+typedef int (*eventdev_close_t)(struct rte_eventdev *dev);
+
+/** Retrieve the default configuration of a queue. */
+typedef void (*eventdev_queue_default_conf_get_t)(struct rte_eventdev *dev,
+		uint8_t queue_id, struct rte_event_queue_conf *queue_conf);
+
+/** Set up a queue. */
+typedef int (*eventdev_queue_setup_t)(struct rte_eventdev *dev,
+		uint8_t queue_id,
+		const struct rte_event_queue_conf *queue_conf);
+
+/** Free the resources of a queue. */
+typedef void (*eventdev_queue_release_t)(struct rte_eventdev *dev,
+		uint8_t queue_id);
+
+/** Retrieve the default configuration of a port. */
+typedef void (*eventdev_port_default_conf_get_t)(struct rte_eventdev *dev,
+		uint8_t port_id, struct rte_event_port_conf *port_conf);
+
+/** Set up a port and store it in dev->data->ports[port_id]. */
+typedef int (*eventdev_port_setup_t)(struct rte_eventdev *dev,
+		uint8_t port_id, const struct rte_event_port_conf *port_conf);
+
+/** Free the resources of a port. */
+typedef void (*eventdev_port_release_t)(void *port);
+
+/**
+ * Link queues to a port.
+ *
+ * @return
+ *   The number of queues linked.
+ */
+typedef int (*eventdev_port_link_t)(struct rte_eventdev *dev, void *port,
+		const uint8_t queues[], const uint8_t priorities[],
+		uint16_t nb_links);
+
+/**
+ * Unlink queues from a port.
+ *
+ * @return
+ *   The number of queues unlinked.
+ */
+typedef int (*eventdev_port_unlink_t)(struct rte_eventdev *dev, void *port,
+		uint8_t queues[], uint16_t nb_unlinks);
+
+/** Convert a dequeue timeout from ns to ticks. */
+typedef int (*eventdev_dequeue_timeout_ticks_t)(struct rte_eventdev *dev,
+		uint64_t ns, uint64_t *timeout_ticks);
+
+/** Dump the state of a device. */
+typedef void (*eventdev_dump_t)(struct rte_eventdev *dev, FILE *f);
+
+/** Event device operations. */
+struct rte_eventdev_ops {
+	eventdev_info_get_t dev_infos_get;      /**< Get device info. */
+	eventdev_configure_t dev_configure;     /**< Configure device. */
+	eventdev_start_t dev_start;             /**< Start device. */
+	eventdev_stop_t dev_stop;               /**< Stop device. */
+	eventdev_close_t dev_close;             /**< Close device. */
+
+	eventdev_queue_default_conf_get_t queue_def_conf;
+	/**< Get default queue configuration. */
+	eventdev_queue_setup_t queue_setup;     /**< Set up a queue. */
+	eventdev_queue_release_t queue_release; /**< Release a queue. */
+
+	eventdev_port_default_conf_get_t port_def_conf;
+	/**< Get default port configuration. */
+	eventdev_port_setup_t port_setup;       /**< Set up a port. */
+	eventdev_port_release_t port_release;   /**< Release a port. */
+
+	eventdev_port_link_t port_link;         /**< Link queues to a port. */
+	eventdev_port_unlink_t port_unlink;     /**< Unlink queues. */
+	eventdev_dequeue_timeout_ticks_t timeout_ticks;
+	/**< Convert a dequeue timeout. */
+	eventdev_dump_t dump;                   /**< Dump device state. */
+};
+
+/**
+ * Get an event device by name.
+ *
+ * @param name
+ *   Device name.
+ *
+ * @return
+ *   The device, or NULL if none has this name.
+ */
+struct rte_eventdev *
+rte_event_pmd_get_named_dev(const char *name);
+
+/**
+ * Allocate an event device and its data.
+ *
+ * @param name
+ *   Unique device name.
+ * @param socket_id
+ *   Socket to allocate the device data on.
+ *
+ * @return
+ *   The device, or NULL on error.
+ */
+struct rte_eventdev *
+rte_event_pmd_allocate(const char *name, int socket_id);
+
+/**
+ * Release an event device allocated by rte_event_pmd_allocate().
+ *
+ * @param eventdev
+ *   The device.
+ *
+ * @return
+ *   0 on success, a negative value on error.
+ */
+int
+rte_event_pmd_release(struct rte_eventdev *eventdev);
+
+/**
+ * Allocate a virtual event device and its private data.
+ *
+ * @param name
+ *   Unique device name.
+ * @param dev_private_size
+ *   Size of the private data of the driver.
+ * @param socket_id
+ *   Socket to allocate the data on.
+ *
+ * @return
+ *   The device, or NULL on error.
+ */
+struct rte_eventdev *
+rte_event_pmd_vdev_init(const char *name, size_t dev_private_size,
+		int socket_id);
+
+/**
+ * Release a virtual event device and its private data.
+ *
+ * @param name
+ *   Device name.
+ *
+ * @return
+ *   0 on success, a negative value on error.
+ */
+int
+rte_event_pmd_vdev_uninit(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_EVENTDEV_PMD_H_ */
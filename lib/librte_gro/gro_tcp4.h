@@ -0,0 +1,284 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GRO_TCP4_H_
+#define _GRO_TCP4_H_
+
+#include <string.h>
+
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+
+#define INVALID_ARRAY_INDEX 0xffffffffUL
+#define GRO_TCP4_TBL_MAX_ITEM_NUM (1024UL * 1024UL)
+
+/* Max length of an IPv4 packet, headers included */
+#define MAX_IPV4_PKT_LENGTH UINT16_MAX
+
+#define GRO_TCP_ACK_FLAG 0x10
+
+/* Header fields identifying a TCP/IPv4 flow */
+struct tcp4_flow_key {
+	struct ether_addr eth_saddr;
+	struct ether_addr eth_daddr;
+	uint16_t vlan_tci;
+	uint8_t tos;
+	uint8_t ttl;
+	uint32_t ip_src_addr;
+	uint32_t ip_dst_addr;
+	uint32_t recv_ack;
+	uint16_t src_port;
+	uint16_t dst_port;
+};
+
+struct gro_tcp4_flow {
+	struct tcp4_flow_key key;
+	/* index of the first packet of the flow, INVALID_ARRAY_INDEX if free */
+	uint32_t start_index;
+};
+
+struct gro_tcp4_item {
+	/* first segment of the packet, NULL if the item is free */
+	struct rte_mbuf *firstseg;
+	/* last segment of the packet */
+	struct rte_mbuf *lastseg;
+	/* TSC at which the item was created */
+	uint64_t start_time;
+	/* index of the next packet of the same flow */
+	uint32_t next_pkt_idx;
+	/* TCP sequence number of the first payload byte */
+	uint32_t sent_seq;
+	/* IPv4 ID of the first merged packet */
+	uint16_t ip_id;
+	/* number of merged packets */
+	uint16_t nb_merged;
+	/* one's complement sum of the TCP payload */
+	uint16_t l4_sum;
+	/* DF bit set: the IPv4 ID is not checked */
+	uint8_t is_atomic;
+};
+
+/* TCP/IPv4 reassembly table */
+struct gro_tcp4_tbl {
+	struct gro_tcp4_item *items;
+	struct gro_tcp4_flow *flows;
+	uint32_t item_num;
+	uint32_t max_item_num;
+	uint32_t flow_num;
+	uint32_t max_flow_num;
+};
+
+void *gro_tcp4_tbl_create(uint16_t socket_id, uint16_t max_flow_num,
+		uint16_t max_item_per_flow);
+
+void gro_tcp4_tbl_destroy(void *tbl);
+
+/*
+ * Merge a TCP/IPv4 packet, whose l2_len, l3_len and l4_len are set, with
+ * the packets of the table. Returns 1 if merged, 0 if stored as a new
+ * item, -1 if not processed.
+ */
+int32_t gro_tcp4_reassemble(struct rte_mbuf *pkt, struct gro_tcp4_tbl *tbl,
+		uint64_t start_time);
+
+/*
+ * Flush the packets held since flush_timestamp or before, updating the
+ * headers of merged packets.
+ */
+uint16_t gro_tcp4_tbl_timeout_flush(struct gro_tcp4_tbl *tbl,
+		uint64_t flush_timestamp, struct rte_mbuf **out, uint16_t nb_out);
+
+uint32_t gro_tcp4_tbl_pkt_count(void *tbl);
+
+/*
+ * One's complement sum of the TCP payload of a packet, derived from the
+ * pseudo-header, the TCP header and its checksum without reading the
+ * payload.
+ */
+static inline uint16_t
+gro_tcp4_payload_sum(const struct ipv4_hdr *iph, const struct tcp_hdr *tcph,
+		uint16_t tcp_hl)
+{
+	uint32_t sum;
+
+	sum = rte_ipv4_phdr_cksum(iph, 0);
+	sum = __rte_raw_cksum(tcph, tcp_hl, sum);
+	return (uint16_t)~__rte_raw_cksum_reduce(sum);
+}
+
+/* One's complement sum of two concatenated buffers */
+static inline uint16_t
+gro_cksum_concat(uint16_t sum1, uint32_t len1, uint16_t sum2)
+{
+	/* the second buffer starts on an odd offset: swap its bytes */
+	if (len1 & 1)
+		sum2 = (uint16_t)((sum2 << 8) | (sum2 >> 8));
+	return __rte_raw_cksum_reduce((uint32_t)sum1 + sum2);
+}
+
+/* Update the IPv4 and TCP headers of a merged packet */
+static inline void
+gro_tcp4_update_header(struct ipv4_hdr *iph, struct tcp_hdr *tcph,
+		uint16_t ip_len, uint16_t tcp_hl, uint16_t l4_sum)
+{
+	uint32_t sum;
+
+	iph->total_length = rte_cpu_to_be_16(ip_len);
+	iph->hdr_checksum = 0;
+	iph->hdr_checksum = rte_ipv4_cksum(iph);
+
+	tcph->cksum = 0;
+	sum = rte_ipv4_phdr_cksum(iph, 0);
+	sum = __rte_raw_cksum(tcph, tcp_hl, sum);
+	sum += l4_sum;
+	tcph->cksum = (uint16_t)~__rte_raw_cksum_reduce(sum);
+}
+
+static inline int
+is_same_tcp4_flow(const struct tcp4_flow_key *k1,
+		const struct tcp4_flow_key *k2)
+{
+	return is_same_ether_addr(&k1->eth_saddr, &k2->eth_saddr) &&
+		is_same_ether_addr(&k1->eth_daddr, &k2->eth_daddr) &&
+		k1->vlan_tci == k2->vlan_tci &&
+		k1->tos == k2->tos && k1->ttl == k2->ttl &&
+		k1->ip_src_addr == k2->ip_src_addr &&
+		k1->ip_dst_addr == k2->ip_dst_addr &&
+		k1->recv_ack == k2->recv_ack &&
+		k1->src_port == k2->src_port &&
+		k1->dst_port == k2->dst_port;
+}
+
+/*
+ * Check if a packet is the neighbor of a held packet. l2_offset is the
+ * length of the outer headers, 0 for non-tunneled packets. Returns 1 if
+ * the packet goes after the held packet, -1 if it goes before, 0 if they
+ * are not neighbors.
+ */
+static inline int
+check_seq_option(const struct gro_tcp4_item *item,
+		const struct tcp_hdr *tcph, uint32_t sent_seq, uint16_t ip_id,
+		uint16_t tcp_hl, uint16_t tcp_dl, uint16_t l2_offset,
+		uint8_t is_atomic)
+{
+	const struct rte_mbuf *pkt_orig = item->firstseg;
+	const struct tcp_hdr *tcph_orig;
+	uint32_t len;
+
+	tcph_orig = rte_pktmbuf_mtod_offset(pkt_orig, const struct tcp_hdr *,
+		l2_offset + pkt_orig->l2_len + pkt_orig->l3_len);
+
+	/* TCP options must be the same */
+	if (tcp_hl != pkt_orig->l4_len || memcmp(tcph + 1, tcph_orig + 1,
+			tcp_hl - sizeof(struct tcp_hdr)) != 0)
+		return 0;
+
+	/* the DF bits must be the same */
+	if (item->is_atomic != is_atomic)
+		return 0;
+
+	len = pkt_orig->pkt_len - l2_offset - pkt_orig->l2_len -
+		pkt_orig->l3_len - tcp_hl;
+	if (sent_seq == item->sent_seq + len && (is_atomic ||
+			ip_id == (uint16_t)(item->ip_id + item->nb_merged)))
+		return 1;
+	if (sent_seq + tcp_dl == item->sent_seq && (is_atomic ||
+			(uint16_t)(ip_id + 1) == item->ip_id))
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Chain a packet before (cmp < 0) or after (cmp > 0) a held packet,
+ * removing the headers of the second one. Returns 1 if merged, 0 if the
+ * merged packet would be too large.
+ */
+static inline int
+merge_two_tcp4_packets(struct gro_tcp4_item *item, struct rte_mbuf *pkt,
+		int cmp, uint32_t sent_seq, uint16_t ip_id, uint16_t l4_sum,
+		uint16_t l2_offset)
+{
+	struct rte_mbuf *pkt_head, *pkt_tail;
+	uint16_t head_hdr_len, tail_hdr_len, l2_len;
+
+	if (cmp > 0) {
+		pkt_head = item->firstseg;
+		pkt_tail = pkt;
+	} else {
+		pkt_head = pkt;
+		pkt_tail = item->firstseg;
+	}
+
+	head_hdr_len = l2_offset + pkt_head->l2_len + pkt_head->l3_len +
+		pkt_head->l4_len;
+	tail_hdr_len = l2_offset + pkt_tail->l2_len + pkt_tail->l3_len +
+		pkt_tail->l4_len;
+	l2_len = l2_offset > 0 ? pkt_head->outer_l2_len : pkt_head->l2_len;
+
+	/* the outermost IPv4 packet must not exceed the max length */
+	if (unlikely(pkt_head->pkt_len - l2_len + pkt_tail->pkt_len -
+			tail_hdr_len > MAX_IPV4_PKT_LENGTH))
+		return 0;
+	if (unlikely(pkt_head->nb_segs + pkt_tail->nb_segs > UINT8_MAX))
+		return 0;
+
+	/* sum of the payloads, in order */
+	if (cmp > 0)
+		item->l4_sum = gro_cksum_concat(item->l4_sum,
+			pkt_head->pkt_len - head_hdr_len, l4_sum);
+	else
+		item->l4_sum = gro_cksum_concat(l4_sum,
+			pkt_head->pkt_len - head_hdr_len, item->l4_sum);
+
+	/* remove the headers of the tail packet */
+	rte_pktmbuf_adj(pkt_tail, tail_hdr_len);
+
+	if (cmp > 0) {
+		item->lastseg->next = pkt;
+		item->lastseg = rte_pktmbuf_lastseg(pkt);
+	} else {
+		rte_pktmbuf_lastseg(pkt)->next = item->firstseg;
+		item->firstseg = pkt;
+		item->sent_seq = sent_seq;
+		item->ip_id = ip_id;
+	}
+	item->nb_merged++;
+
+	pkt_head->nb_segs += pkt_tail->nb_segs;
+	pkt_head->pkt_len += pkt_tail->pkt_len;
+
+	return 1;
+}
+
+#endif /* _GRO_TCP4_H_ */
@@ -0,0 +1,504 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_udp.h>
+
+#include "gro_vxlan_tcp4.h"
+
+void *
+gro_vxlan_tcp4_tbl_create(uint16_t socket_id,
+		uint16_t max_flow_num,
+		uint16_t max_item_per_flow)
+{
+	struct gro_vxlan_tcp4_tbl *tbl;
+	size_t size;
+	uint32_t entries_num, i;
+
+	entries_num = max_flow_num * max_item_per_flow;
+	entries_num = RTE_MIN(entries_num, GRO_TCP4_TBL_MAX_ITEM_NUM);
+
+	if (entries_num == 0)
+		return NULL;
+
+	tbl = rte_zmalloc_socket(__func__,
+			sizeof(struct gro_vxlan_tcp4_tbl),
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (tbl == NULL)
+		return NULL;
+
+	size = sizeof(struct gro_vxlan_tcp4_item) * entries_num;
+	tbl->items = rte_zmalloc_socket(__func__,
+			size,
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (tbl->items == NULL) {
+		rte_free(tbl);
+		return NULL;
+	}
+	tbl->max_item_num = entries_num;
+
+	size = sizeof(struct gro_vxlan_tcp4_flow) * max_flow_num;
+	tbl->flows = rte_zmalloc_socket(__func__,
+			size,
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (tbl->flows == NULL) {
+		rte_free(tbl->items);
+		rte_free(tbl);
+		return NULL;
+	}
+	/* INVALID_ARRAY_INDEX indicates an empty flow */
+	for (i = 0; i < max_flow_num; i++)
+		tbl->flows[i].start_index = INVALID_ARRAY_INDEX;
+	tbl->max_flow_num = max_flow_num;
+
+	return tbl;
+}
+
+void
+gro_vxlan_tcp4_tbl_destroy(void *tbl)
+{
+	struct gro_vxlan_tcp4_tbl *vxlan_tbl = tbl;
+	uint32_t i;
+
+	if (vxlan_tbl) {
+		for (i = 0; i < vxlan_tbl->max_item_num; i++)
+			rte_pktmbuf_free(
+				vxlan_tbl->items[i].inner_item.firstseg);
+		rte_free(vxlan_tbl->items);
+		rte_free(vxlan_tbl->flows);
+	}
+	rte_free(vxlan_tbl);
+}
+
+static inline uint32_t
+find_an_empty_item(struct gro_vxlan_tcp4_tbl *tbl)
+{
+	uint32_t i;
+	uint32_t max_item_num = tbl->max_item_num;
+
+	for (i = 0; i < max_item_num; i++)
+		if (tbl->items[i].inner_item.firstseg == NULL)
+			return i;
+	return INVALID_ARRAY_INDEX;
+}
+
+static inline uint32_t
+find_an_empty_flow(struct gro_vxlan_tcp4_tbl *tbl)
+{
+	uint32_t i;
+	uint32_t max_flow_num = tbl->max_flow_num;
+
+	for (i = 0; i < max_flow_num; i++)
+		if (tbl->flows[i].start_index == INVALID_ARRAY_INDEX)
+			return i;
+	return INVALID_ARRAY_INDEX;
+}
+
+static inline uint32_t
+insert_new_item(struct gro_vxlan_tcp4_tbl *tbl,
+		struct rte_mbuf *pkt,
+		uint64_t start_time,
+		uint32_t prev_idx,
+		uint32_t sent_seq,
+		uint16_t outer_ip_id,
+		uint16_t ip_id,
+		uint16_t l4_sum,
+		uint8_t outer_is_atomic,
+		uint8_t is_atomic)
+{
+	struct gro_vxlan_tcp4_item *item;
+	uint32_t item_idx;
+
+	item_idx = find_an_empty_item(tbl);
+	if (item_idx == INVALID_ARRAY_INDEX)
+		return INVALID_ARRAY_INDEX;
+
+	item = &tbl->items[item_idx];
+	item->inner_item.firstseg = pkt;
+	item->inner_item.lastseg = rte_pktmbuf_lastseg(pkt);
+	item->inner_item.start_time = start_time;
+	item->inner_item.next_pkt_idx = INVALID_ARRAY_INDEX;
+	item->inner_item.sent_seq = sent_seq;
+	item->inner_item.ip_id = ip_id;
+	item->inner_item.nb_merged = 1;
+	item->inner_item.l4_sum = l4_sum;
+	item->inner_item.is_atomic = is_atomic;
+	item->outer_ip_id = outer_ip_id;
+	item->outer_is_atomic = outer_is_atomic;
+	tbl->item_num++;
+
+	/* if the previous packet exists, chain the new one with it */
+	if (prev_idx != INVALID_ARRAY_INDEX)
+		tbl->items[prev_idx].inner_item.next_pkt_idx = item_idx;
+
+	return item_idx;
+}
+
+static inline uint32_t
+delete_item(struct gro_vxlan_tcp4_tbl *tbl,
+		uint32_t item_idx,
+		uint32_t prev_item_idx)
+{
+	uint32_t next_idx = tbl->items[item_idx].inner_item.next_pkt_idx;
+
+	/* NULL indicates an empty item */
+	tbl->items[item_idx].inner_item.firstseg = NULL;
+	tbl->item_num--;
+	if (prev_item_idx != INVALID_ARRAY_INDEX)
+		tbl->items[prev_item_idx].inner_item.next_pkt_idx = next_idx;
+
+	return next_idx;
+}
+
+static inline uint32_t
+insert_new_flow(struct gro_vxlan_tcp4_tbl *tbl,
+		const struct vxlan_tcp4_flow_key *src,
+		uint32_t item_idx)
+{
+	uint32_t flow_idx;
+
+	flow_idx = find_an_empty_flow(tbl);
+	if (unlikely(flow_idx == INVALID_ARRAY_INDEX))
+		return INVALID_ARRAY_INDEX;
+
+	tbl->flows[flow_idx].key = *src;
+	tbl->flows[flow_idx].start_index = item_idx;
+	tbl->flow_num++;
+
+	return flow_idx;
+}
+
+static inline int
+is_same_vxlan_tcp4_flow(const struct vxlan_tcp4_flow_key *k1,
+		const struct vxlan_tcp4_flow_key *k2)
+{
+	return is_same_tcp4_flow(&k1->inner_key, &k2->inner_key) &&
+		k1->vxlan_hdr.vx_flags == k2->vxlan_hdr.vx_flags &&
+		k1->vxlan_hdr.vx_vni == k2->vxlan_hdr.vx_vni &&
+		is_same_ether_addr(&k1->outer_eth_saddr,
+			&k2->outer_eth_saddr) &&
+		is_same_ether_addr(&k1->outer_eth_daddr,
+			&k2->outer_eth_daddr) &&
+		k1->outer_ip_src_addr == k2->outer_ip_src_addr &&
+		k1->outer_ip_dst_addr == k2->outer_ip_dst_addr &&
+		k1->outer_src_port == k2->outer_src_port &&
+		k1->outer_dst_port == k2->outer_dst_port &&
+		k1->outer_vlan_tci == k2->outer_vlan_tci;
+}
+
+static inline int
+check_vxlan_seq_option(const struct gro_vxlan_tcp4_item *item,
+		const struct tcp_hdr *tcp_hdr,
+		uint32_t sent_seq,
+		uint16_t outer_ip_id,
+		uint16_t ip_id,
+		uint16_t tcp_hl,
+		uint16_t tcp_dl,
+		uint16_t l2_offset,
+		uint8_t outer_is_atomic,
+		uint8_t is_atomic)
+{
+	const struct rte_mbuf *pkt = item->inner_item.firstseg;
+	int cmp;
+
+	/* the outer headers and DF bits must match */
+	if (l2_offset != pkt->outer_l2_len + pkt->outer_l3_len ||
+			item->outer_is_atomic != outer_is_atomic)
+		return 0;
+
+	cmp = check_seq_option(&item->inner_item, tcp_hdr, sent_seq, ip_id,
+			tcp_hl, tcp_dl, l2_offset, is_atomic);
+	if (cmp > 0 && (outer_is_atomic || outer_ip_id ==
+			(uint16_t)(item->outer_ip_id +
+				item->inner_item.nb_merged)))
+		return 1;
+	if (cmp < 0 && (outer_is_atomic ||
+			(uint16_t)(outer_ip_id + 1) == item->outer_ip_id))
+		return -1;
+
+	return 0;
+}
+
+/* update the outer and inner headers of a merged packet */
+static inline void
+update_header(struct gro_vxlan_tcp4_item *item)
+{
+	struct rte_mbuf *pkt = item->inner_item.firstseg;
+	struct ipv4_hdr *outer_ipv4_hdr, *ipv4_hdr;
+	struct udp_hdr *udp_hdr;
+	struct tcp_hdr *tcp_hdr;
+	uint16_t len;
+
+	outer_ipv4_hdr = rte_pktmbuf_mtod_offset(pkt, struct ipv4_hdr *,
+		pkt->outer_l2_len);
+	len = pkt->pkt_len - pkt->outer_l2_len;
+	outer_ipv4_hdr->total_length = rte_cpu_to_be_16(len);
+	outer_ipv4_hdr->hdr_checksum = 0;
+	outer_ipv4_hdr->hdr_checksum = rte_ipv4_cksum(outer_ipv4_hdr);
+
+	udp_hdr = (struct udp_hdr *)((char *)outer_ipv4_hdr +
+		pkt->outer_l3_len);
+	len -= pkt->outer_l3_len;
+	udp_hdr->dgram_len = rte_cpu_to_be_16(len);
+
+	ipv4_hdr = (struct ipv4_hdr *)((char *)udp_hdr + pkt->l2_len);
+	tcp_hdr = (struct tcp_hdr *)((char *)ipv4_hdr + pkt->l3_len);
+	len -= pkt->l2_len;
+	gro_tcp4_update_header(ipv4_hdr, tcp_hdr, len, pkt->l4_len,
+		item->inner_item.l4_sum);
+}
+
+int32_t
+gro_vxlan_tcp4_reassemble(struct rte_mbuf *pkt,
+		struct gro_vxlan_tcp4_tbl *tbl,
+		uint64_t start_time)
+{
+	struct ether_hdr *outer_eth_hdr, *eth_hdr;
+	struct ipv4_hdr *outer_ipv4_hdr, *ipv4_hdr;
+	struct udp_hdr *udp_hdr;
+	struct vxlan_hdr *vxlan_hdr;
+	struct tcp_hdr *tcp_hdr;
+	struct vxlan_tcp4_flow_key key;
+	uint32_t cur_idx, prev_idx, item_idx;
+	uint32_t i, max_flow_num, remaining_flow_num;
+	uint32_t sent_seq;
+	int32_t tcp_dl;
+	uint16_t l2_offset, outer_ip_len, ip_len;
+	uint16_t outer_ip_id, ip_id, frag_off, l4_sum;
+	uint8_t outer_is_atomic, is_atomic;
+	uint8_t find;
+	int cmp;
+
+	l2_offset = pkt->outer_l2_len + pkt->outer_l3_len;
+	outer_eth_hdr = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
+	outer_ipv4_hdr = (struct ipv4_hdr *)((char *)outer_eth_hdr +
+			pkt->outer_l2_len);
+	udp_hdr = (struct udp_hdr *)((char *)outer_ipv4_hdr +
+			pkt->outer_l3_len);
+	vxlan_hdr = (struct vxlan_hdr *)(udp_hdr + 1);
+	eth_hdr = (struct ether_hdr *)(vxlan_hdr + 1);
+	ipv4_hdr = (struct ipv4_hdr *)((char *)udp_hdr + pkt->l2_len);
+	tcp_hdr = (struct tcp_hdr *)((char *)ipv4_hdr + pkt->l3_len);
+
+	/* only merge packets carrying data with the ACK flag alone */
+	if (tcp_hdr->tcp_flags != GRO_TCP_ACK_FLAG)
+		return -1;
+
+	/* the outer UDP checksum is not updated */
+	if (udp_hdr->dgram_cksum != 0)
+		return -1;
+
+	/* remove the Ethernet padding */
+	outer_ip_len = rte_be_to_cpu_16(outer_ipv4_hdr->total_length);
+	if (pkt->pkt_len < (uint32_t)pkt->outer_l2_len + outer_ip_len)
+		return -1;
+	if (pkt->pkt_len > (uint32_t)pkt->outer_l2_len + outer_ip_len &&
+			rte_pktmbuf_trim(pkt, pkt->pkt_len -
+				pkt->outer_l2_len - outer_ip_len) != 0)
+		return -1;
+
+	/* the outer and inner lengths must be consistent */
+	ip_len = rte_be_to_cpu_16(ipv4_hdr->total_length);
+	if ((uint32_t)pkt->outer_l3_len + pkt->l2_len + ip_len !=
+			outer_ip_len ||
+			rte_be_to_cpu_16(udp_hdr->dgram_len) !=
+			outer_ip_len - pkt->outer_l3_len)
+		return -1;
+
+	tcp_dl = ip_len - pkt->l3_len - pkt->l4_len;
+	if (tcp_dl <= 0)
+		return -1;
+
+	/* the IPv4 IDs are not checked when DF is set, see RFC 6864 */
+	frag_off = rte_be_to_cpu_16(outer_ipv4_hdr->fragment_offset);
+	outer_is_atomic = (frag_off & IPV4_HDR_DF_FLAG) == IPV4_HDR_DF_FLAG;
+	outer_ip_id = outer_is_atomic ? 0 :
+		rte_be_to_cpu_16(outer_ipv4_hdr->packet_id);
+	frag_off = rte_be_to_cpu_16(ipv4_hdr->fragment_offset);
+	is_atomic = (frag_off & IPV4_HDR_DF_FLAG) == IPV4_HDR_DF_FLAG;
+	ip_id = is_atomic ? 0 : rte_be_to_cpu_16(ipv4_hdr->packet_id);
+	sent_seq = rte_be_to_cpu_32(tcp_hdr->sent_seq);
+	l4_sum = gro_tcp4_payload_sum(ipv4_hdr, tcp_hdr, pkt->l4_len);
+
+	ether_addr_copy(&eth_hdr->s_addr, &key.inner_key.eth_saddr);
+	ether_addr_copy(&eth_hdr->d_addr, &key.inner_key.eth_daddr);
+	key.inner_key.vlan_tci = 0;
+	if (pkt->l2_len > ETHER_VXLAN_HLEN + sizeof(struct ether_hdr))
+		key.inner_key.vlan_tci =
+			((struct vlan_hdr *)(eth_hdr + 1))->vlan_tci;
+	key.inner_key.tos = ipv4_hdr->type_of_service;
+	key.inner_key.ttl = ipv4_hdr->time_to_live;
+	key.inner_key.ip_src_addr = ipv4_hdr->src_addr;
+	key.inner_key.ip_dst_addr = ipv4_hdr->dst_addr;
+	key.inner_key.recv_ack = tcp_hdr->recv_ack;
+	key.inner_key.src_port = tcp_hdr->src_port;
+	key.inner_key.dst_port = tcp_hdr->dst_port;
+
+	key.vxlan_hdr.vx_flags = vxlan_hdr->vx_flags;
+	key.vxlan_hdr.vx_vni = vxlan_hdr->vx_vni;
+	ether_addr_copy(&outer_eth_hdr->s_addr, &key.outer_eth_saddr);
+	ether_addr_copy(&outer_eth_hdr->d_addr, &key.outer_eth_daddr);
+	key.outer_ip_src_addr = outer_ipv4_hdr->src_addr;
+	key.outer_ip_dst_addr = outer_ipv4_hdr->dst_addr;
+	key.outer_src_port = udp_hdr->src_port;
+	key.outer_dst_port = udp_hdr->dst_port;
+	key.outer_vlan_tci = 0;
+	if (pkt->outer_l2_len > sizeof(struct ether_hdr))
+		key.outer_vlan_tci =
+			((struct vlan_hdr *)(outer_eth_hdr + 1))->vlan_tci;
+	else if (pkt->ol_flags & PKT_RX_VLAN_PKT)
+		key.outer_vlan_tci = rte_cpu_to_be_16(pkt->vlan_tci);
+
+	/* search for a matched flow */
+	max_flow_num = tbl->max_flow_num;
+	remaining_flow_num = tbl->flow_num;
+	find = 0;
+	for (i = 0; i < max_flow_num && remaining_flow_num; i++) {
+		if (tbl->flows[i].start_index != INVALID_ARRAY_INDEX) {
+			if (is_same_vxlan_tcp4_flow(&tbl->flows[i].key,
+						&key)) {
+				find = 1;
+				break;
+			}
+			remaining_flow_num--;
+		}
+	}
+
+	/*
+	 * Fail to find a matched flow. Insert a new flow and store the
+	 * packet into the flow.
+	 */
+	if (find == 0) {
+		item_idx = insert_new_item(tbl, pkt, start_time,
+				INVALID_ARRAY_INDEX, sent_seq, outer_ip_id,
+				ip_id, l4_sum, outer_is_atomic, is_atomic);
+		if (item_idx == INVALID_ARRAY_INDEX)
+			return -1;
+		if (insert_new_flow(tbl, &key, item_idx) ==
+				INVALID_ARRAY_INDEX) {
+			/* Fail to insert a new flow */
+			delete_item(tbl, item_idx, INVALID_ARRAY_INDEX);
+			return -1;
+		}
+		return 0;
+	}
+
+	/*
+	 * Check all packets in the flow and try to find a neighbor for
+	 * the input packet.
+	 */
+	cur_idx = tbl->flows[i].start_index;
+	prev_idx = cur_idx;
+	do {
+		cmp = check_vxlan_seq_option(&tbl->items[cur_idx], tcp_hdr,
+				sent_seq, outer_ip_id, ip_id, pkt->l4_len,
+				tcp_dl, l2_offset, outer_is_atomic,
+				is_atomic);
+		/* a neighbor too large to be merged with is skipped */
+		if (cmp && merge_two_tcp4_packets(
+					&tbl->items[cur_idx].inner_item,
+					pkt, cmp, sent_seq, ip_id, l4_sum,
+					l2_offset)) {
+			if (cmp < 0)
+				tbl->items[cur_idx].outer_ip_id = outer_ip_id;
+			return 1;
+		}
+		prev_idx = cur_idx;
+		cur_idx = tbl->items[cur_idx].inner_item.next_pkt_idx;
+	} while (cur_idx != INVALID_ARRAY_INDEX);
+
+	/*
+	 * Fail to find a neighbor, so store the packet at the end of the
+	 * flow, keeping the packets of a flow in arrival order.
+	 */
+	if (insert_new_item(tbl, pkt, start_time, prev_idx, sent_seq,
+				outer_ip_id, ip_id, l4_sum, outer_is_atomic,
+				is_atomic) == INVALID_ARRAY_INDEX)
+		return -1;
+
+	return 0;
+}
+
+uint16_t
+gro_vxlan_tcp4_tbl_timeout_flush(struct gro_vxlan_tcp4_tbl *tbl,
+		uint64_t flush_timestamp,
+		struct rte_mbuf **out,
+		uint16_t nb_out)
+{
+	uint16_t k = 0;
+	uint32_t i, j;
+	uint32_t max_flow_num = tbl->max_flow_num;
+
+	for (i = 0; i < max_flow_num; i++) {
+		if (unlikely(tbl->flow_num == 0))
+			return k;
+
+		j = tbl->flows[i].start_index;
+		while (j != INVALID_ARRAY_INDEX) {
+			/* items are chained in arrival order */
+			if (tbl->items[j].inner_item.start_time >
+					flush_timestamp)
+				break;
+
+			out[k++] = tbl->items[j].inner_item.firstseg;
+			if (tbl->items[j].inner_item.nb_merged > 1)
+				update_header(&tbl->items[j]);
+			/*
+			 * Delete the packet and get the next
+			 * packet in the flow.
+			 */
+			j = delete_item(tbl, j, INVALID_ARRAY_INDEX);
+			tbl->flows[i].start_index = j;
+			if (j == INVALID_ARRAY_INDEX)
+				tbl->flow_num--;
+
+			if (unlikely(k == nb_out))
+				return k;
+		}
+	}
+	return k;
+}
+
+uint32_t
+gro_vxlan_tcp4_tbl_pkt_count(void *tbl)
+{
+	struct gro_vxlan_tcp4_tbl *gro_tbl = tbl;
+
+	if (gro_tbl)
+		return gro_tbl->item_num;
+
+	return 0;
+}
@@ -0,0 +1,500 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_udp.h>
+
+#include "rte_gro.h"
+#include "gro_tcp4.h"
+#include "gro_vxlan_tcp4.h"
+
+typedef void *(*gro_tbl_create_fn)(uint16_t socket_id,
+		uint16_t max_flow_num,
+		uint16_t max_item_per_flow);
+typedef void (*gro_tbl_destroy_fn)(void *tbl);
+typedef uint32_t (*gro_tbl_pkt_count_fn)(void *tbl);
+
+static gro_tbl_create_fn tbl_create_fn[RTE_GRO_TYPE_MAX_NUM] = {
+		gro_tcp4_tbl_create, gro_vxlan_tcp4_tbl_create, NULL};
+static gro_tbl_destroy_fn tbl_destroy_fn[RTE_GRO_TYPE_MAX_NUM] = {
+		gro_tcp4_tbl_destroy, gro_vxlan_tcp4_tbl_destroy, NULL};
+static gro_tbl_pkt_count_fn tbl_pkt_count_fn[RTE_GRO_TYPE_MAX_NUM] = {
+		gro_tcp4_tbl_pkt_count, gro_vxlan_tcp4_tbl_pkt_count, NULL};
+
+#define GRO_SUPPORTED_TYPES (RTE_GRO_TCP_IPV4 | RTE_GRO_IPV4_VXLAN_TCP_IPV4)
+
+/* GRO context holding packets across bursts */
+struct gro_ctx {
+	/* parameters, gro_types restricted to the supported types */
+	struct rte_gro_param param;
+	/* reassembly tables, indexed by GRO type */
+	void *tbls[RTE_GRO_TYPE_MAX_NUM];
+};
+
+/*
+ * Get the length of an Ethernet header, with an optional VLAN tag, at
+ * offset off of the first segment. Returns 0 if it is truncated.
+ */
+static inline uint16_t
+gro_parse_l2(const struct rte_mbuf *pkt, uint16_t off, uint16_t *ether_type)
+{
+	const struct ether_hdr *eth_hdr;
+	const struct vlan_hdr *vlan_hdr;
+	uint16_t len = sizeof(struct ether_hdr);
+
+	if (rte_pktmbuf_data_len(pkt) < off + len)
+		return 0;
+	eth_hdr = rte_pktmbuf_mtod_offset(pkt, const struct ether_hdr *, off);
+	*ether_type = eth_hdr->ether_type;
+	if (*ether_type == rte_cpu_to_be_16(ETHER_TYPE_VLAN)) {
+		if (rte_pktmbuf_data_len(pkt) < off + len + sizeof(*vlan_hdr))
+			return 0;
+		vlan_hdr = (const struct vlan_hdr *)(eth_hdr + 1);
+		*ether_type = vlan_hdr->eth_proto;
+		len += sizeof(*vlan_hdr);
+	}
+	return len;
+}
+
+/*
+ * Check that an IPv4 header at offset off of the first segment has no
+ * options and belongs to a non-fragmented packet.
+ */
+static inline const struct ipv4_hdr *
+gro_parse_ipv4(const struct rte_mbuf *pkt, uint16_t off)
+{
+	const struct ipv4_hdr *ipv4_hdr;
+
+	if (rte_pktmbuf_data_len(pkt) < off + sizeof(struct ipv4_hdr))
+		return NULL;
+	ipv4_hdr = rte_pktmbuf_mtod_offset(pkt, const struct ipv4_hdr *, off);
+	if (ipv4_hdr->version_ihl != 0x45 ||
+			(rte_be_to_cpu_16(ipv4_hdr->fragment_offset) &
+			 (IPV4_HDR_MF_FLAG | IPV4_HDR_OFFSET_MASK)) != 0)
+		return NULL;
+	return ipv4_hdr;
+}
+
+/*
+ * Get the length of a TCP header at offset off of the first segment.
+ * Returns 0 if it is invalid or truncated.
+ */
+static inline uint16_t
+gro_parse_tcp(const struct rte_mbuf *pkt, uint16_t off)
+{
+	const struct tcp_hdr *tcp_hdr;
+	uint16_t tcp_hl;
+
+	if (rte_pktmbuf_data_len(pkt) < off + sizeof(struct tcp_hdr))
+		return 0;
+	tcp_hdr = rte_pktmbuf_mtod_offset(pkt, const struct tcp_hdr *, off);
+	tcp_hl = (tcp_hdr->data_off & 0xf0) >> 2;
+	if (tcp_hl < sizeof(struct tcp_hdr) ||
+			rte_pktmbuf_data_len(pkt) < off + tcp_hl)
+		return 0;
+	return tcp_hl;
+}
+
+/*
+ * Set the header lengths of a packet GRO may merge, with all its headers
+ * in the first segment. Returns the GRO type index of the packet, or -1.
+ */
+static int
+gro_parse_pkt(struct rte_mbuf *pkt, uint64_t gro_types)
+{
+	const struct ipv4_hdr *ipv4_hdr;
+	const struct udp_hdr *udp_hdr;
+	const struct vxlan_hdr *vxlan_hdr;
+	uint16_t outer_l2_len, l2_len, tcp_hl, off;
+	uint16_t ether_type;
+
+	if (pkt->ol_flags & (PKT_RX_IP_CKSUM_BAD | PKT_RX_L4_CKSUM_BAD))
+		return -1;
+
+	l2_len = gro_parse_l2(pkt, 0, &ether_type);
+	if (l2_len == 0 || ether_type != rte_cpu_to_be_16(ETHER_TYPE_IPv4))
+		return -1;
+	ipv4_hdr = gro_parse_ipv4(pkt, l2_len);
+	if (ipv4_hdr == NULL)
+		return -1;
+	off = l2_len + sizeof(struct ipv4_hdr);
+
+	if (ipv4_hdr->next_proto_id == IPPROTO_TCP) {
+		if ((gro_types & RTE_GRO_TCP_IPV4) == 0)
+			return -1;
+		tcp_hl = gro_parse_tcp(pkt, off);
+		if (tcp_hl == 0)
+			return -1;
+		pkt->l2_len = l2_len;
+		pkt->l3_len = sizeof(struct ipv4_hdr);
+		pkt->l4_len = tcp_hl;
+		return RTE_GRO_TCP_IPV4_INDEX;
+	}
+
+	if (ipv4_hdr->next_proto_id != IPPROTO_UDP ||
+			(gro_types & RTE_GRO_IPV4_VXLAN_TCP_IPV4) == 0 ||
+			rte_pktmbuf_data_len(pkt) < off + ETHER_VXLAN_HLEN)
+		return -1;
+	udp_hdr = rte_pktmbuf_mtod_offset(pkt, const struct udp_hdr *, off);
+	vxlan_hdr = (const struct vxlan_hdr *)(udp_hdr + 1);
+	if (udp_hdr->dst_port != rte_cpu_to_be_16(GRO_VXLAN_UDP_PORT) ||
+			(vxlan_hdr->vx_flags &
+			 rte_cpu_to_be_32(GRO_VXLAN_FLAG_VNI)) == 0)
+		return -1;
+
+	outer_l2_len = l2_len;
+	off += ETHER_VXLAN_HLEN;
+	l2_len = gro_parse_l2(pkt, off, &ether_type);
+	if (l2_len == 0 || ether_type != rte_cpu_to_be_16(ETHER_TYPE_IPv4))
+		return -1;
+	off += l2_len;
+	ipv4_hdr = gro_parse_ipv4(pkt, off);
+	if (ipv4_hdr == NULL || ipv4_hdr->next_proto_id != IPPROTO_TCP)
+		return -1;
+	tcp_hl = gro_parse_tcp(pkt, off + sizeof(struct ipv4_hdr));
+	if (tcp_hl == 0)
+		return -1;
+	pkt->outer_l2_len = outer_l2_len;
+	pkt->outer_l3_len = sizeof(struct ipv4_hdr);
+	pkt->l2_len = ETHER_VXLAN_HLEN + l2_len;
+	pkt->l3_len = sizeof(struct ipv4_hdr);
+	pkt->l4_len = tcp_hl;
+	return RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX;
+}
+
+void *
+rte_gro_ctx_create(const struct rte_gro_param *param)
+{
+	struct gro_ctx *gro_ctx;
+	gro_tbl_create_fn create_tbl_fn;
+	uint64_t gro_type_flag = 0;
+	uint64_t gro_types = 0;
+	uint8_t i;
+
+	if (param == NULL ||
+			(param->gro_types & GRO_SUPPORTED_TYPES) == 0 ||
+			param->max_flow_num == 0 ||
+			param->max_item_per_flow == 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	gro_ctx = rte_zmalloc_socket(__func__,
+			sizeof(struct gro_ctx),
+			RTE_CACHE_LINE_SIZE,
+			param->socket_id);
+	if (gro_ctx == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	for (i = 0; i < RTE_GRO_TYPE_MAX_NUM; i++) {
+		gro_type_flag = 1ULL << i;
+		if ((param->gro_types & gro_type_flag) == 0)
+			continue;
+
+		create_tbl_fn = tbl_create_fn[i];
+		if (create_tbl_fn == NULL)
+			continue;
+
+		gro_ctx->tbls[i] = create_tbl_fn(param->socket_id,
+				param->max_flow_num,
+				param->max_item_per_flow);
+		if (gro_ctx->tbls[i] == NULL) {
+			/* destroy all created tables */
+			gro_ctx->param.gro_types = gro_types;
+			rte_gro_ctx_destroy(gro_ctx);
+			rte_errno = ENOMEM;
+			return NULL;
+		}
+		gro_types |= gro_type_flag;
+	}
+	gro_ctx->param = *param;
+	gro_ctx->param.gro_types = gro_types;
+
+	return gro_ctx;
+}
+
+void
+rte_gro_ctx_destroy(void *ctx)
+{
+	gro_tbl_destroy_fn destroy_tbl_fn;
+	struct gro_ctx *gro_ctx = ctx;
+	uint64_t gro_type_flag;
+	uint8_t i;
+
+	if (gro_ctx == NULL)
+		return;
+	for (i = 0; i < RTE_GRO_TYPE_MAX_NUM; i++) {
+		gro_type_flag = 1ULL << i;
+		if ((gro_ctx->param.gro_types & gro_type_flag) == 0)
+			continue;
+		destroy_tbl_fn = tbl_destroy_fn[i];
+		if (destroy_tbl_fn)
+			destroy_tbl_fn(gro_ctx->tbls[i]);
+	}
+	rte_free(gro_ctx);
+}
+
+uint16_t
+rte_gro_reassemble_burst(struct rte_mbuf **pkts,
+		uint16_t nb_pkts,
+		const struct rte_gro_param *param)
+{
+	/* allocate a reassembly table for TCP/IPv4 GRO */
+	struct gro_tcp4_tbl tcp_tbl;
+	struct gro_tcp4_flow tcp_flows[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_tcp4_item tcp_items[RTE_GRO_MAX_BURST_ITEM_NUM];
+
+	/* allocate a reassembly table for VXLAN GRO */
+	struct gro_vxlan_tcp4_tbl vxlan_tbl;
+	struct gro_vxlan_tcp4_flow vxlan_flows[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_vxlan_tcp4_item vxlan_items[RTE_GRO_MAX_BURST_ITEM_NUM];
+
+	struct rte_mbuf *unprocess_pkts[nb_pkts];
+	uint32_t item_num, flow_num, i;
+	int32_t ret;
+	uint16_t unprocess_num = 0, nb_after_gro = nb_pkts;
+	uint64_t gro_types = param->gro_types & GRO_SUPPORTED_TYPES;
+
+	if (unlikely(nb_pkts < 2 || gro_types == 0))
+		return nb_pkts;
+
+	/* get the max number of packets and flows held by the tables */
+	item_num = RTE_MIN(nb_pkts, RTE_GRO_MAX_BURST_ITEM_NUM);
+	item_num = RTE_MIN(item_num,
+			(uint32_t)param->max_flow_num *
+			param->max_item_per_flow);
+	flow_num = RTE_MIN(item_num, param->max_flow_num);
+	if (unlikely(item_num == 0))
+		return nb_pkts;
+
+	if (gro_types & RTE_GRO_TCP_IPV4) {
+		memset(tcp_items, 0, sizeof(tcp_items[0]) * item_num);
+		for (i = 0; i < flow_num; i++)
+			tcp_flows[i].start_index = INVALID_ARRAY_INDEX;
+
+		tcp_tbl.flows = tcp_flows;
+		tcp_tbl.items = tcp_items;
+		tcp_tbl.flow_num = 0;
+		tcp_tbl.item_num = 0;
+		tcp_tbl.max_flow_num = flow_num;
+		tcp_tbl.max_item_num = item_num;
+	}
+
+	if (gro_types & RTE_GRO_IPV4_VXLAN_TCP_IPV4) {
+		memset(vxlan_items, 0, sizeof(vxlan_items[0]) * item_num);
+		for (i = 0; i < flow_num; i++)
+			vxlan_flows[i].start_index = INVALID_ARRAY_INDEX;
+
+		vxlan_tbl.flows = vxlan_flows;
+		vxlan_tbl.items = vxlan_items;
+		vxlan_tbl.flow_num = 0;
+		vxlan_tbl.item_num = 0;
+		vxlan_tbl.max_flow_num = flow_num;
+		vxlan_tbl.max_item_num = item_num;
+	}
+
+	for (i = 0; i < nb_pkts; i++) {
+		switch (gro_parse_pkt(pkts[i], gro_types)) {
+		case RTE_GRO_TCP_IPV4_INDEX:
+			ret = gro_tcp4_reassemble(pkts[i], &tcp_tbl, 0);
+			break;
+		case RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX:
+			ret = gro_vxlan_tcp4_reassemble(pkts[i], &vxlan_tbl, 0);
+			break;
+		default:
+			ret = -1;
+			break;
+		}
+
+		if (ret > 0)
+			/* merge successfully */
+			nb_after_gro--;
+		else if (ret < 0)
+			unprocess_pkts[unprocess_num++] = pkts[i];
+	}
+
+	/* keep the burst as is if nothing was merged */
+	if (nb_after_gro < nb_pkts) {
+		i = 0;
+		/* flush all packets from the tables */
+		if (gro_types & RTE_GRO_IPV4_VXLAN_TCP_IPV4)
+			i = gro_vxlan_tcp4_tbl_timeout_flush(&vxlan_tbl, 0,
+					pkts, nb_pkts);
+		if (gro_types & RTE_GRO_TCP_IPV4)
+			i += gro_tcp4_tbl_timeout_flush(&tcp_tbl, 0,
+					&pkts[i], nb_pkts - i);
+		/* copy unprocessed packets */
+		if (unprocess_num > 0)
+			memcpy(&pkts[i], unprocess_pkts,
+					sizeof(struct rte_mbuf *) *
+					unprocess_num);
+	}
+
+	return nb_after_gro;
+}
+
+uint16_t
+rte_gro_reassemble(struct rte_mbuf **pkts,
+		uint16_t nb_pkts,
+		void *ctx)
+{
+	struct gro_ctx *gro_ctx = ctx;
+	struct gro_tcp4_tbl *tcp_tbl;
+	struct gro_vxlan_tcp4_tbl *vxlan_tbl;
+	uint64_t current_time;
+	uint16_t i, unprocess_num = 0;
+	int32_t ret;
+
+	tcp_tbl = gro_ctx->tbls[RTE_GRO_TCP_IPV4_INDEX];
+	vxlan_tbl = gro_ctx->tbls[RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX];
+
+	current_time = rte_rdtsc();
+
+	for (i = 0; i < nb_pkts; i++) {
+		switch (gro_parse_pkt(pkts[i], gro_ctx->param.gro_types)) {
+		case RTE_GRO_TCP_IPV4_INDEX:
+			ret = gro_tcp4_reassemble(pkts[i], tcp_tbl,
+					current_time);
+			break;
+		case RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX:
+			ret = gro_vxlan_tcp4_reassemble(pkts[i], vxlan_tbl,
+					current_time);
+			break;
+		default:
+			ret = -1;
+			break;
+		}
+
+		if (ret < 0)
+			pkts[unprocess_num++] = pkts[i];
+	}
+
+	return unprocess_num;
+}
+
+uint16_t
+rte_gro_timeout_flush(void *ctx,
+		uint64_t timeout_cycles,
+		uint64_t gro_types,
+		struct rte_mbuf **out,
+		uint16_t max_nb_out)
+{
+	struct gro_ctx *gro_ctx = ctx;
+	uint64_t flush_timestamp;
+	uint16_t num = 0;
+
+	gro_types = gro_types & gro_ctx->param.gro_types;
+	flush_timestamp = rte_rdtsc() - timeout_cycles;
+
+	if (gro_types & RTE_GRO_IPV4_VXLAN_TCP_IPV4)
+		num = gro_vxlan_tcp4_tbl_timeout_flush(
+				gro_ctx->tbls[RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX],
+				flush_timestamp, out, max_nb_out);
+
+	/* if no available space in 'out', stop flushing */
+	if ((gro_types & RTE_GRO_TCP_IPV4) && max_nb_out > num)
+		num += gro_tcp4_tbl_timeout_flush(
+				gro_ctx->tbls[RTE_GRO_TCP_IPV4_INDEX],
+				flush_timestamp,
+				&out[num], max_nb_out - num);
+
+	return num;
+}
+
+uint64_t
+rte_gro_get_pkt_count(void *ctx)
+{
+	struct gro_ctx *gro_ctx = ctx;
+	gro_tbl_pkt_count_fn pkt_count_fn;
+	uint64_t item_num = 0;
+	uint64_t gro_type_flag;
+	uint8_t i;
+
+	for (i = 0; i < RTE_GRO_TYPE_MAX_NUM; i++) {
+		gro_type_flag = 1ULL << i;
+		if ((gro_ctx->param.gro_types & gro_type_flag) == 0)
+			continue;
+
+		pkt_count_fn = tbl_pkt_count_fn[i];
+		if (pkt_count_fn)
+			item_num += pkt_count_fn(gro_ctx->tbls[i]);
+	}
+
+	return item_num;
+}
+
+uint16_t
+rte_gro_rx_callback(uint8_t port __rte_unused,
+		uint16_t queue __rte_unused,
+		struct rte_mbuf **pkts,
+		uint16_t nb_pkts,
+		uint16_t max_pkts,
+		void *user_param)
+{
+	struct gro_ctx *gro_ctx = user_param;
+	uint64_t timeout_cycles = gro_ctx->param.timeout_cycles;
+	uint64_t gro_types = gro_ctx->param.gro_types;
+	uint16_t nb_unprocess, nb_flush;
+
+	if (timeout_cycles == 0)
+		return rte_gro_reassemble_burst(pkts, nb_pkts,
+				&gro_ctx->param);
+
+	nb_unprocess = rte_gro_reassemble(pkts, nb_pkts, gro_ctx);
+	if (rte_gro_get_pkt_count(gro_ctx) == 0)
+		return nb_unprocess;
+
+	if (nb_unprocess == 0)
+		return rte_gro_timeout_flush(gro_ctx, timeout_cycles,
+				gro_types, pkts, max_pkts);
+
+	/* the held packets are older than the unprocessed ones */
+	{
+		struct rte_mbuf *unprocess_pkts[nb_unprocess];
+
+		memcpy(unprocess_pkts, pkts,
+				sizeof(struct rte_mbuf *) * nb_unprocess);
+		nb_flush = rte_gro_timeout_flush(gro_ctx, timeout_cycles,
+				gro_types, pkts, max_pkts - nb_unprocess);
+		memcpy(&pkts[nb_flush], unprocess_pkts,
+				sizeof(struct rte_mbuf *) * nb_unprocess);
+	}
+
+	return nb_flush + nb_unprocess;
+}
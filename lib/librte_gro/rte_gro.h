@@ -0,0 +1,231 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_GRO_H_
+#define _RTE_GRO_H_
+
+/**
+ * @file
+ * RTE Generic Receive Offload
+ *
+ * The GRO library merges received TCP segments of the same flow into
+ * larger multi-segment packets, so that the application processes one
+ * packet per group of segments. TCP/IPv4 and VXLAN encapsulated
+ * TCP/IPv4 packets are supported.
+ *
+ * Packets can be merged within a burst (rte_gro_reassemble_burst()) or
+ * across bursts, by keeping them in a GRO context until they are flushed
+ * after a timeout (rte_gro_reassemble() and rte_gro_timeout_flush()).
+ * rte_gro_rx_callback() wraps both modes in an RX callback for
+ * rte_eth_add_rx_callback().
+ */
+
+#include <stdint.h>
+#include <rte_mbuf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Max number of packets merged by one rte_gro_reassemble_burst() call. */
+#define RTE_GRO_MAX_BURST_ITEM_NUM 128U
+/** Max number of GRO types. */
+#define RTE_GRO_TYPE_MAX_NUM 64
+/** Number of GRO types supported by the library. */
+#define RTE_GRO_TYPE_SUPPORT_NUM 2
+
+/** TCP/IPv4 GRO index. */
+#define RTE_GRO_TCP_IPV4_INDEX 0
+/** TCP/IPv4 GRO flag. */
+#define RTE_GRO_TCP_IPV4 (1ULL << RTE_GRO_TCP_IPV4_INDEX)
+/** VXLAN (over UDP/IPv4) encapsulated TCP/IPv4 GRO index. */
+#define RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX 1
+/** VXLAN (over UDP/IPv4) encapsulated TCP/IPv4 GRO flag. */
+#define RTE_GRO_IPV4_VXLAN_TCP_IPV4 (1ULL << RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX)
+
+/**
+ * Parameters of a GRO context, or of one rte_gro_reassemble_burst() call.
+ */
+struct rte_gro_param {
+	uint64_t gro_types;
+	/**< OR of RTE_GRO_* flags: types of packets to merge. */
+	uint64_t timeout_cycles;
+	/**< Time in TSC cycles a packet may be held by rte_gro_rx_callback()
+	 * before being flushed. 0 merges packets within each burst only.
+	 */
+	uint16_t max_flow_num;
+	/**< Max number of flows held by each table. */
+	uint16_t max_item_per_flow;
+	/**< Max number of packets held per flow. */
+	uint16_t socket_id;
+	/**< Socket on which the GRO context is allocated. */
+};
+
+/**
+ * Merge the packets of a burst.
+ *
+ * The TCP/IPv4 packets (possibly VXLAN encapsulated) of the burst which
+ * belong to the same flow and are neighbors in sequence are merged in
+ * multi-segment packets: the headers of all but the first packet are
+ * removed, and the length, IP checksum and TCP checksum fields of the
+ * merged packet are updated. The TCP checksum of the merged packet is
+ * derived from the checksums of the merged packets, so it is wrong if one
+ * of them was.
+ *
+ * Only packets with an IPv4 header without options, that are not
+ * fragmented and carry data with the ACK flag alone are merged; the outer
+ * UDP checksum of VXLAN packets must be zero. Packets flagged with
+ * PKT_RX_IP_CKSUM_BAD or PKT_RX_L4_CKSUM_BAD are not merged.
+ * The l2_len, l3_len, l4_len (and outer_l2_len, outer_l3_len for VXLAN
+ * packets) fields of the packets considered for merging are set.
+ *
+ * When packets are merged, the merged packets come first in *pkts*,
+ * followed by the packets that could not be merged. Otherwise the array
+ * is not modified.
+ *
+ * @param pkts
+ *   The packets to merge. On return, the packets after GRO.
+ * @param nb_pkts
+ *   The number of packets. At most RTE_GRO_MAX_BURST_ITEM_NUM packets
+ *   are considered for merging.
+ * @param param
+ *   The GRO parameters; timeout_cycles and socket_id are unused.
+ * @return
+ *   The number of packets after GRO.
+ */
+uint16_t rte_gro_reassemble_burst(struct rte_mbuf **pkts, uint16_t nb_pkts,
+		const struct rte_gro_param *param);
+
+/**
+ * Create a GRO context, holding packets across bursts.
+ *
+ * A GRO context must be used by one thread at a time, typically an RX
+ * queue polled by one lcore.
+ *
+ * @param param
+ *   The GRO parameters.
+ * @return
+ *   A pointer to the new context, or NULL on error with rte_errno set:
+ *    - EINVAL: no supported GRO type or null table sizes
+ *    - ENOMEM: not enough memory
+ */
+void *rte_gro_ctx_create(const struct rte_gro_param *param);
+
+/**
+ * Destroy a GRO context, freeing the packets it holds.
+ *
+ * @param ctx
+ *   The GRO context, may be NULL.
+ */
+void rte_gro_ctx_destroy(void *ctx);
+
+/**
+ * Merge the packets of a burst with the packets held by a GRO context.
+ *
+ * The packets that can be merged are stored in the context, the others
+ * are returned at the beginning of *pkts*. The held packets are returned
+ * by rte_gro_timeout_flush().
+ *
+ * @param pkts
+ *   The packets to merge. On return, the packets not held by the context.
+ * @param nb_pkts
+ *   The number of packets.
+ * @param ctx
+ *   The GRO context.
+ * @return
+ *   The number of packets not held by the context.
+ */
+uint16_t rte_gro_reassemble(struct rte_mbuf **pkts, uint16_t nb_pkts,
+		void *ctx);
+
+/**
+ * Flush the packets held by a GRO context for longer than a timeout.
+ *
+ * @param ctx
+ *   The GRO context.
+ * @param timeout_cycles
+ *   The timeout in TSC cycles. 0 flushes all packets.
+ * @param gro_types
+ *   OR of RTE_GRO_* flags: types of packets to flush.
+ * @param out
+ *   The array receiving the flushed packets.
+ * @param max_nb_out
+ *   The size of the *out* array.
+ * @return
+ *   The number of flushed packets.
+ */
+uint16_t rte_gro_timeout_flush(void *ctx, uint64_t timeout_cycles,
+		uint64_t gro_types, struct rte_mbuf **out, uint16_t max_nb_out);
+
+/**
+ * Get the number of packets held by a GRO context.
+ *
+ * @param ctx
+ *   The GRO context.
+ * @return
+ *   The number of packets held.
+ */
+uint64_t rte_gro_get_pkt_count(void *ctx);
+
+/**
+ * RX callback merging received packets, see rte_eth_add_rx_callback().
+ *
+ * *user_param* is a GRO context created for the RX queue. If its
+ * timeout_cycles parameter is 0, the packets of each burst are merged with
+ * rte_gro_reassemble_burst(). Otherwise the packets are held in the
+ * context and returned once merged for timeout_cycles; the packets held
+ * for longer are returned first in the burst.
+ *
+ * @param port
+ *   The port of the burst, unused.
+ * @param queue
+ *   The RX queue of the burst, unused.
+ * @param pkts
+ *   The received packets.
+ * @param nb_pkts
+ *   The number of received packets.
+ * @param max_pkts
+ *   The size of the *pkts* array.
+ * @param user_param
+ *   The GRO context of the queue.
+ * @return
+ *   The number of packets returned to the application.
+ */
+uint16_t rte_gro_rx_callback(uint8_t port, uint16_t queue,
+		struct rte_mbuf **pkts, uint16_t nb_pkts, uint16_t max_pkts,
+		void *user_param);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_GRO_H_ */
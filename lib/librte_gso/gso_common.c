@@ -0,0 +1,125 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+
+#include <rte_memcpy.h>
+
+#include "gso_common.h"
+
+/* Initialize the header mbuf of a segment from the packet being split */
+static inline void
+gso_init_hdr_segment(struct rte_mbuf *hdr, const struct rte_mbuf *pkt,
+		uint16_t hdr_len)
+{
+	rte_memcpy(rte_pktmbuf_mtod(hdr, char *),
+		rte_pktmbuf_mtod(pkt, char *), hdr_len);
+	hdr->data_len = hdr_len;
+	hdr->pkt_len = hdr_len;
+	hdr->port = pkt->port;
+	hdr->vlan_tci = pkt->vlan_tci;
+	hdr->vlan_tci_outer = pkt->vlan_tci_outer;
+	hdr->tx_offload = pkt->tx_offload;
+	hdr->hash = pkt->hash;
+	hdr->packet_type = pkt->packet_type;
+	hdr->ol_flags = pkt->ol_flags & ~GSO_TX_SEG_FLAGS;
+	hdr->tso_segsz = 0;
+}
+
+int
+gso_do_segment(struct rte_mbuf *pkt, uint16_t hdr_len, uint16_t pyld_len,
+		struct rte_mempool *direct_pool,
+		struct rte_mempool *indirect_pool,
+		struct rte_mbuf **pkts_out, uint16_t nb_pkts_out)
+{
+	struct rte_mbuf *in, *hdr, *pyld, *prev;
+	uint16_t in_off, remain, len, nb_segs;
+
+	/* headers must be contiguous in the first segment */
+	if (unlikely(pkt->data_len < hdr_len || pyld_len == 0))
+		return -EINVAL;
+
+	in = pkt;
+	in_off = hdr_len;
+	nb_segs = 0;
+
+	for (;;) {
+		/* skip exhausted (or empty) input segments */
+		while (in != NULL && in_off >= in->data_len) {
+			in = in->next;
+			in_off = 0;
+		}
+		if (in == NULL)
+			break;
+
+		if (unlikely(nb_segs >= nb_pkts_out)) {
+			gso_free_segments(pkts_out, nb_segs);
+			return -ENOSPC;
+		}
+		hdr = rte_pktmbuf_alloc(direct_pool);
+		if (unlikely(hdr == NULL)) {
+			gso_free_segments(pkts_out, nb_segs);
+			return -ENOMEM;
+		}
+		gso_init_hdr_segment(hdr, pkt, hdr_len);
+		pkts_out[nb_segs++] = hdr;
+
+		prev = hdr;
+		remain = pyld_len;
+		while (remain > 0 && in != NULL) {
+			pyld = rte_pktmbuf_alloc(indirect_pool);
+			if (unlikely(pyld == NULL)) {
+				gso_free_segments(pkts_out, nb_segs);
+				return -ENOMEM;
+			}
+			rte_pktmbuf_attach(pyld, in);
+
+			len = RTE_MIN(remain, (uint16_t)(in->data_len - in_off));
+			pyld->data_off = in->data_off + in_off;
+			pyld->data_len = len;
+			pyld->pkt_len = len;
+			prev->next = pyld;
+			prev = pyld;
+
+			hdr->pkt_len += len;
+			hdr->nb_segs++;
+			remain -= len;
+			in_off += len;
+			while (in != NULL && in_off >= in->data_len) {
+				in = in->next;
+				in_off = 0;
+			}
+		}
+	}
+
+	return nb_segs;
+}
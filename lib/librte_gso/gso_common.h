@@ -0,0 +1,153 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GSO_COMMON_H_
+#define _GSO_COMMON_H_
+
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+
+#define GSO_TCP_FIN_FLAG 0x01
+#define GSO_TCP_PSH_FLAG 0x08
+#define GSO_TCP_CWR_FLAG 0x80
+
+/* TX flags requesting a software segmentation, removed from the segments */
+#define GSO_TX_SEG_FLAGS (PKT_TX_TCP_SEG | PKT_TX_UDP_SEG)
+
+/*
+ * Split the payload of pkt, which starts hdr_len bytes into the packet,
+ * in segments of pyld_len bytes (the last one may be shorter).
+ *
+ * Each segment is made of a direct mbuf from direct_pool holding a copy
+ * of the hdr_len bytes of headers, chained to indirect mbufs from
+ * indirect_pool attached to the data of pkt. The headers are not updated.
+ * pkt itself is not modified, but holds one more reference per attached
+ * indirect mbuf.
+ *
+ * Return the number of segments written to pkts_out, or a negative errno
+ * value on error (-ENOSPC when pkts_out is too small), in which case no
+ * segment is left allocated.
+ */
+int gso_do_segment(struct rte_mbuf *pkt, uint16_t hdr_len, uint16_t pyld_len,
+		struct rte_mempool *direct_pool,
+		struct rte_mempool *indirect_pool,
+		struct rte_mbuf **pkts_out, uint16_t nb_pkts_out);
+
+/* Free segments built by gso_do_segment() */
+static inline void
+gso_free_segments(struct rte_mbuf **segs, uint16_t nb_segs)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_segs; i++)
+		rte_pktmbuf_free(segs[i]);
+}
+
+/*
+ * Non-complemented one's complement sum of the data of a chain, from
+ * offset off of its first segment, added to sum.
+ */
+static inline uint16_t
+gso_mbuf_sum(const struct rte_mbuf *m, uint32_t off, uint32_t sum)
+{
+	uint32_t done = 0;
+	uint16_t len, s;
+
+	for (; m != NULL; m = m->next) {
+		if (off >= m->data_len) {
+			off -= m->data_len;
+			continue;
+		}
+		len = (uint16_t)(m->data_len - off);
+		s = rte_raw_cksum(rte_pktmbuf_mtod_offset(m, const void *, off),
+			len);
+		/* the buffer starts on an odd offset: swap its bytes */
+		if (done & 1)
+			s = (uint16_t)((s << 8) | (s >> 8));
+		sum += s;
+		done += len;
+		off = 0;
+	}
+	return __rte_raw_cksum_reduce(sum);
+}
+
+/* Update the length, id and checksum of the IPv4 header of a segment */
+static inline void
+gso_update_ipv4_header(struct ipv4_hdr *iph, uint16_t ip_len, uint16_t id,
+		uint64_t ol_flags)
+{
+	iph->total_length = rte_cpu_to_be_16(ip_len);
+	iph->packet_id = rte_cpu_to_be_16(id);
+	iph->hdr_checksum = 0;
+	if (!(ol_flags & PKT_TX_IP_CKSUM))
+		iph->hdr_checksum = rte_ipv4_cksum(iph);
+}
+
+/*
+ * Update the sequence number and flags of the TCP header of a segment:
+ * FIN and PSH are only kept in the last segment, CWR in the first one.
+ */
+static inline void
+gso_update_tcp_header(struct tcp_hdr *tcph, uint32_t sent_seq,
+		uint16_t seg_idx, uint16_t nb_segs)
+{
+	tcph->sent_seq = rte_cpu_to_be_32(sent_seq);
+	if (seg_idx != nb_segs - 1)
+		tcph->tcp_flags &= ~(GSO_TCP_FIN_FLAG | GSO_TCP_PSH_FLAG);
+	if (seg_idx != 0)
+		tcph->tcp_flags &= ~GSO_TCP_CWR_FLAG;
+}
+
+/*
+ * L4 checksum of a segment: the pseudo-header checksum l4_sum when the
+ * hardware computes it (PKT_TX_TCP_CKSUM or PKT_TX_UDP_CKSUM requested),
+ * the full checksum otherwise, computed with a null checksum field.
+ */
+static inline uint16_t
+gso_l4_cksum(const struct rte_mbuf *seg, uint32_t l4_off, uint16_t l4_sum,
+		int is_udp)
+{
+	uint16_t sum;
+
+	if (seg->ol_flags & PKT_TX_L4_MASK)
+		return l4_sum;
+	sum = (uint16_t)~gso_mbuf_sum(seg, l4_off, l4_sum);
+	if (is_udp && sum == 0)
+		sum = 0xffff;
+	return sum;
+}
+
+#endif /* _GSO_COMMON_H_ */
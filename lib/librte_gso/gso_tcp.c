@@ -0,0 +1,202 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+
+#include "gso_common.h"
+#include "gso_tcp.h"
+
+/* Offsets and initial header values of the packet being segmented */
+struct gso_tcp_info {
+	uint16_t outer_l3_off; /* 0 if not tunneled */
+	uint16_t l3_off;
+	uint16_t l4_off;
+	uint16_t outer_ip_id;
+	uint16_t ip_id;
+	uint16_t ipid_delta;
+	uint16_t mss;
+	uint32_t sent_seq;
+	uint8_t is_ipv4;
+	uint8_t outer_udp_cksum; /* outer UDP checksum to be computed */
+};
+
+/* Check the headers of pkt and fill the segmentation information */
+static int
+gso_tcp_parse(const struct rte_mbuf *pkt, struct gso_tcp_info *info)
+{
+	const struct ipv4_hdr *iph;
+	const struct ipv6_hdr *ip6h;
+	const struct udp_hdr *udph;
+	const struct tcp_hdr *tcph;
+	uint16_t hdr_len;
+
+	info->outer_l3_off = 0;
+	info->l3_off = pkt->l2_len;
+	if (pkt->ol_flags & PKT_TX_OUTER_IPV4) {
+		info->outer_l3_off = pkt->outer_l2_len;
+		info->l3_off += pkt->outer_l2_len + pkt->outer_l3_len;
+	}
+	info->l4_off = info->l3_off + pkt->l3_len;
+	hdr_len = info->l4_off + pkt->l4_len;
+	if (unlikely(pkt->data_len < hdr_len ||
+			pkt->l4_len < sizeof(struct tcp_hdr)))
+		return -EINVAL;
+
+	if (info->outer_l3_off != 0) {
+		iph = rte_pktmbuf_mtod_offset(pkt, const struct ipv4_hdr *,
+			info->outer_l3_off);
+		udph = rte_pktmbuf_mtod_offset(pkt, const struct udp_hdr *,
+			info->outer_l3_off + pkt->outer_l3_len);
+		if (unlikely(pkt->outer_l3_len != sizeof(struct ipv4_hdr) ||
+				iph->version_ihl != 0x45 ||
+				iph->next_proto_id != IPPROTO_UDP ||
+				pkt->l2_len < sizeof(struct udp_hdr)))
+			return -EINVAL;
+		info->outer_ip_id = rte_be_to_cpu_16(iph->packet_id);
+		info->outer_udp_cksum = udph->dgram_cksum != 0;
+	}
+
+	if (pkt->ol_flags & PKT_TX_IPV4) {
+		iph = rte_pktmbuf_mtod_offset(pkt, const struct ipv4_hdr *,
+			info->l3_off);
+		if (unlikely(pkt->l3_len != sizeof(struct ipv4_hdr) ||
+				iph->version_ihl != 0x45 ||
+				iph->next_proto_id != IPPROTO_TCP))
+			return -EINVAL;
+		info->ip_id = rte_be_to_cpu_16(iph->packet_id);
+		info->is_ipv4 = 1;
+	} else if (pkt->ol_flags & PKT_TX_IPV6) {
+		ip6h = rte_pktmbuf_mtod_offset(pkt, const struct ipv6_hdr *,
+			info->l3_off);
+		if (unlikely(pkt->l3_len != sizeof(struct ipv6_hdr) ||
+				ip6h->proto != IPPROTO_TCP))
+			return -EINVAL;
+		info->is_ipv4 = 0;
+	} else
+		return -EINVAL;
+
+	tcph = rte_pktmbuf_mtod_offset(pkt, const struct tcp_hdr *,
+		info->l4_off);
+	info->sent_seq = rte_be_to_cpu_32(tcph->sent_seq);
+	return 0;
+}
+
+/* Update the headers of the seg_idx-th of nb_segs segments */
+static void
+gso_tcp_update_segment(struct rte_mbuf *seg, uint16_t seg_idx,
+		uint16_t nb_segs, const struct gso_tcp_info *info)
+{
+	struct ipv4_hdr *iph;
+	struct ipv6_hdr *ip6h;
+	struct udp_hdr *udph;
+	struct tcp_hdr *tcph;
+	uint16_t l4_sum;
+
+	tcph = rte_pktmbuf_mtod_offset(seg, struct tcp_hdr *, info->l4_off);
+	gso_update_tcp_header(tcph, info->sent_seq + seg_idx * info->mss,
+		seg_idx, nb_segs);
+	tcph->cksum = 0;
+
+	if (info->is_ipv4) {
+		iph = rte_pktmbuf_mtod_offset(seg, struct ipv4_hdr *,
+			info->l3_off);
+		gso_update_ipv4_header(iph, seg->pkt_len - info->l3_off,
+			info->ip_id + seg_idx * info->ipid_delta,
+			seg->ol_flags);
+		l4_sum = rte_ipv4_phdr_cksum(iph, 0);
+	} else {
+		ip6h = rte_pktmbuf_mtod_offset(seg, struct ipv6_hdr *,
+			info->l3_off);
+		ip6h->payload_len = rte_cpu_to_be_16(seg->pkt_len -
+			info->l4_off);
+		l4_sum = rte_ipv6_phdr_cksum(ip6h, 0);
+	}
+	tcph->cksum = gso_l4_cksum(seg, info->l4_off, l4_sum, 0);
+
+	if (info->outer_l3_off == 0)
+		return;
+
+	/* the outer checksums cover the updated inner headers */
+	iph = rte_pktmbuf_mtod_offset(seg, struct ipv4_hdr *,
+		info->outer_l3_off);
+	udph = rte_pktmbuf_mtod_offset(seg, struct udp_hdr *,
+		info->outer_l3_off + seg->outer_l3_len);
+	iph->total_length = rte_cpu_to_be_16(seg->pkt_len - info->outer_l3_off);
+	udph->dgram_len = rte_cpu_to_be_16(seg->pkt_len - info->outer_l3_off -
+		seg->outer_l3_len);
+	if (info->outer_udp_cksum) {
+		udph->dgram_cksum = 0;
+		udph->dgram_cksum = ~gso_mbuf_sum(seg,
+			info->outer_l3_off + seg->outer_l3_len,
+			rte_ipv4_phdr_cksum(iph, 0));
+		if (udph->dgram_cksum == 0)
+			udph->dgram_cksum = 0xffff;
+	}
+	iph->packet_id = rte_cpu_to_be_16(info->outer_ip_id +
+		seg_idx * info->ipid_delta);
+	iph->hdr_checksum = 0;
+	if (!(seg->ol_flags & PKT_TX_OUTER_IP_CKSUM))
+		iph->hdr_checksum = rte_ipv4_cksum(iph);
+}
+
+int
+gso_tcp_segment(struct rte_mbuf *pkt, uint16_t mss, uint16_t ipid_delta,
+		struct rte_mempool *direct_pool,
+		struct rte_mempool *indirect_pool,
+		struct rte_mbuf **pkts_out, uint16_t nb_pkts_out)
+{
+	struct gso_tcp_info info;
+	uint16_t i;
+	int ret;
+
+	ret = gso_tcp_parse(pkt, &info);
+	if (unlikely(ret < 0))
+		return ret;
+	info.mss = mss;
+	info.ipid_delta = ipid_delta;
+
+	if (pkt->pkt_len - info.l4_off - pkt->l4_len <= mss) {
+		pkt->ol_flags &= ~GSO_TX_SEG_FLAGS;
+		gso_tcp_update_segment(pkt, 0, 1, &info);
+		pkts_out[0] = pkt;
+		return 1;
+	}
+
+	ret = gso_do_segment(pkt, info.l4_off + pkt->l4_len, mss,
+		direct_pool, indirect_pool, pkts_out, nb_pkts_out);
+	if (unlikely(ret < 0))
+		return ret;
+
+	for (i = 0; i < ret; i++)
+		gso_tcp_update_segment(pkts_out[i], i, ret, &info);
+	return ret;
+}
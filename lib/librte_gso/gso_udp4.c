@@ -0,0 +1,118 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+
+#include "gso_common.h"
+#include "gso_udp4.h"
+
+/* Update the IPv4 header of the frag_idx-th of nb_frags fragments */
+static void
+gso_udp4_update_fragment(struct rte_mbuf *frag, uint16_t frag_idx,
+		uint16_t nb_frags, uint16_t frag_size)
+{
+	struct ipv4_hdr *iph;
+	uint16_t frag_off;
+
+	iph = rte_pktmbuf_mtod_offset(frag, struct ipv4_hdr *, frag->l2_len);
+	frag_off = (uint16_t)(frag_idx * frag_size / IPV4_HDR_OFFSET_UNITS);
+	if (frag_idx != nb_frags - 1)
+		frag_off |= IPV4_HDR_MF_FLAG;
+	iph->fragment_offset = rte_cpu_to_be_16(frag_off);
+	gso_update_ipv4_header(iph, frag->pkt_len - frag->l2_len,
+		rte_be_to_cpu_16(iph->packet_id), frag->ol_flags);
+}
+
+/* Checksum the whole datagram before it is fragmented, if requested */
+static void
+gso_udp4_cksum(struct rte_mbuf *pkt, struct ipv4_hdr *iph, uint16_t hdr_len)
+{
+	struct udp_hdr *udph;
+
+	if ((pkt->ol_flags & PKT_TX_L4_MASK) != PKT_TX_UDP_CKSUM)
+		return;
+
+	udph = (struct udp_hdr *)(iph + 1);
+	udph->dgram_cksum = 0;
+	udph->dgram_cksum = ~gso_mbuf_sum(pkt, hdr_len,
+		rte_ipv4_phdr_cksum(iph, 0));
+	if (udph->dgram_cksum == 0)
+		udph->dgram_cksum = 0xffff;
+}
+
+int
+gso_udp4_segment(struct rte_mbuf *pkt, uint16_t frag_size,
+		struct rte_mempool *direct_pool,
+		struct rte_mempool *indirect_pool,
+		struct rte_mbuf **pkts_out, uint16_t nb_pkts_out)
+{
+	struct ipv4_hdr *iph;
+	uint16_t hdr_len, i;
+	int ret;
+
+	hdr_len = pkt->l2_len + pkt->l3_len;
+	frag_size &= ~(IPV4_HDR_OFFSET_UNITS - 1);
+	if (unlikely(frag_size == 0 || !(pkt->ol_flags & PKT_TX_IPV4) ||
+			pkt->l3_len != sizeof(struct ipv4_hdr) ||
+			pkt->data_len < hdr_len + sizeof(struct udp_hdr)))
+		return -EINVAL;
+
+	iph = rte_pktmbuf_mtod_offset(pkt, struct ipv4_hdr *, pkt->l2_len);
+	if (unlikely(iph->version_ihl != 0x45 ||
+			iph->next_proto_id != IPPROTO_UDP ||
+			(rte_be_to_cpu_16(iph->fragment_offset) &
+				(IPV4_HDR_MF_FLAG | IPV4_HDR_OFFSET_MASK))))
+		return -EINVAL;
+
+	if (pkt->pkt_len - hdr_len <= frag_size) {
+		gso_udp4_cksum(pkt, iph, hdr_len);
+		pkt->ol_flags &= ~(GSO_TX_SEG_FLAGS | PKT_TX_L4_MASK);
+		gso_udp4_update_fragment(pkt, 0, 1, frag_size);
+		pkts_out[0] = pkt;
+		return 1;
+	}
+
+	/* pkt is left untouched if it cannot be fragmented */
+	ret = gso_do_segment(pkt, hdr_len, frag_size, direct_pool,
+		indirect_pool, pkts_out, nb_pkts_out);
+	if (unlikely(ret < 0))
+		return ret;
+
+	/* the UDP header is in the data of pkt, shared by the first
+	 * fragment */
+	gso_udp4_cksum(pkt, iph, hdr_len);
+	for (i = 0; i < ret; i++) {
+		pkts_out[i]->ol_flags &= ~PKT_TX_L4_MASK;
+		gso_udp4_update_fragment(pkts_out[i], i, ret, frag_size);
+	}
+	return ret;
+}
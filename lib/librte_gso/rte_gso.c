@@ -0,0 +1,185 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+
+#include <rte_ethdev.h>
+
+#include "rte_gso.h"
+#include "gso_common.h"
+#include "gso_tcp.h"
+#include "gso_udp4.h"
+
+/* Segment pkt without freeing it */
+static int
+gso_segment(struct rte_mbuf *pkt, const struct rte_gso_ctx *ctx,
+		struct rte_mbuf **pkts_out, uint16_t nb_pkts_out)
+{
+	uint64_t ol_flags = pkt->ol_flags;
+	uint32_t gso_type;
+	uint16_t hdr_len, seg_size;
+
+	if (unlikely(nb_pkts_out == 0))
+		return -ENOSPC;
+
+	if (ol_flags & PKT_TX_TCP_SEG) {
+		gso_type = (ol_flags & PKT_TX_OUTER_IPV4) ?
+			DEV_TX_OFFLOAD_VXLAN_TNL_TSO : DEV_TX_OFFLOAD_TCP_TSO;
+		hdr_len = pkt->l2_len + pkt->l3_len + pkt->l4_len;
+		if (ol_flags & PKT_TX_OUTER_IPV4)
+			hdr_len += pkt->outer_l2_len + pkt->outer_l3_len;
+	} else if (ol_flags & PKT_TX_UDP_SEG) {
+		gso_type = DEV_TX_OFFLOAD_UDP_TSO;
+		hdr_len = pkt->l2_len + pkt->l3_len;
+	} else
+		gso_type = 0;
+
+	if (!(ctx->gso_types & gso_type)) {
+		pkts_out[0] = pkt;
+		return 1;
+	}
+
+	if (pkt->tso_segsz != 0)
+		seg_size = pkt->tso_segsz;
+	else if (ctx->gso_size > hdr_len)
+		seg_size = ctx->gso_size - hdr_len;
+	else
+		return -EINVAL;
+
+	if (gso_type == DEV_TX_OFFLOAD_UDP_TSO)
+		return gso_udp4_segment(pkt, seg_size, ctx->direct_pool,
+			ctx->indirect_pool, pkts_out, nb_pkts_out);
+	return gso_tcp_segment(pkt, seg_size,
+		(ctx->flag & RTE_GSO_FLAG_IPID_FIXED) ? 0 : 1,
+		ctx->direct_pool, ctx->indirect_pool, pkts_out, nb_pkts_out);
+}
+
+int
+rte_gso_segment(struct rte_mbuf *pkt, const struct rte_gso_ctx *ctx,
+		struct rte_mbuf **pkts_out, uint16_t nb_pkts_out)
+{
+	int ret;
+
+	if (pkt == NULL || ctx == NULL || pkts_out == NULL ||
+			ctx->direct_pool == NULL || ctx->indirect_pool == NULL)
+		return -EINVAL;
+
+	ret = gso_segment(pkt, ctx, pkts_out, nb_pkts_out);
+	/* the segments hold their own references to the data of pkt */
+	if (ret > 0 && pkts_out[0] != pkt)
+		rte_pktmbuf_free(pkt);
+	return ret;
+}
+
+/*
+ * Transmit the segments of a batch of packets; seg_end[i] is the index
+ * following the last segment of pkts[i]. Return the number of packets
+ * consumed.
+ */
+static uint16_t
+gso_tx_batch(uint8_t port_id, uint16_t queue_id, struct rte_mbuf **pkts,
+		uint16_t nb_pkts, struct rte_mbuf **segs,
+		const uint16_t *seg_end)
+{
+	uint16_t nb_sent, start, i;
+
+	nb_sent = rte_eth_tx_burst(port_id, queue_id, segs,
+		seg_end[nb_pkts - 1]);
+
+	start = 0;
+	for (i = 0; i < nb_pkts; i++) {
+		if (segs[start] != pkts[i]) {
+			if (nb_sent > start && nb_sent < seg_end[i])
+				gso_free_segments(&segs[nb_sent],
+					seg_end[i] - nb_sent);
+			else if (nb_sent <= start)
+				gso_free_segments(&segs[start],
+					seg_end[i] - start);
+			/* the input packet is consumed once partly sent */
+			if (nb_sent > start)
+				rte_pktmbuf_free(pkts[i]);
+		}
+		start = seg_end[i];
+	}
+
+	for (i = 0; i < nb_pkts; i++)
+		if (nb_sent < seg_end[i])
+			break;
+	/* count the partly sent packet */
+	if (i < nb_pkts && nb_sent > (i == 0 ? 0 : seg_end[i - 1]))
+		i++;
+	return i;
+}
+
+uint16_t
+rte_gso_tx_burst(uint8_t port_id, uint16_t queue_id,
+		struct rte_mbuf **tx_pkts, uint16_t nb_pkts,
+		const struct rte_gso_ctx *ctx)
+{
+	struct rte_mbuf *segs[RTE_GSO_TX_BURST_SEG_NUM];
+	uint16_t seg_end[RTE_GSO_TX_BURST_SEG_NUM];
+	uint16_t first, nb_batch, nb_segs, nb_done, i;
+	int ret;
+
+	if (ctx == NULL || ctx->direct_pool == NULL ||
+			ctx->indirect_pool == NULL)
+		return 0;
+
+	first = 0;
+	nb_batch = 0;
+	nb_segs = 0;
+	for (i = 0; i < nb_pkts; ) {
+		ret = gso_segment(tx_pkts[i], ctx, &segs[nb_segs],
+			RTE_GSO_TX_BURST_SEG_NUM - nb_segs);
+		if (ret > 0) {
+			nb_segs += ret;
+			seg_end[nb_batch++] = nb_segs;
+			i++;
+			continue;
+		}
+		/* out of room or failure: send what is segmented so far */
+		if (nb_batch == 0)
+			break;
+		nb_done = gso_tx_batch(port_id, queue_id, &tx_pkts[first],
+			nb_batch, segs, seg_end);
+		if (nb_done < nb_batch || ret != -ENOSPC)
+			return first + nb_done;
+		first = i;
+		nb_batch = 0;
+		nb_segs = 0;
+	}
+
+	if (nb_batch != 0)
+		first += gso_tx_batch(port_id, queue_id, &tx_pkts[first],
+			nb_batch, segs, seg_end);
+	return first;
+}
@@ -0,0 +1,171 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_GSO_H_
+#define _RTE_GSO_H_
+
+/**
+ * @file
+ * RTE Generic Segmentation Offload
+ *
+ * The GSO library segments, in software, the packets an application
+ * would hand to the TSO of a port which does not support it: large
+ * TCP/IPv4 and TCP/IPv6 packets, possibly encapsulated in VXLAN over
+ * IPv4, are split in MSS sized TCP segments, and large UDP/IPv4 datagrams
+ * in IPv4 fragments.
+ *
+ * The payload is not copied: each output packet is a direct mbuf holding
+ * a copy of the headers, chained to indirect mbufs attached to the
+ * payload of the input packet. The lengths, IPv4 ids, TCP sequence
+ * numbers, flags and checksums of the output packets are updated.
+ *
+ * rte_gso_segment() segments one packet; rte_gso_tx_burst() segments a
+ * burst and transmits it, in place of rte_eth_tx_burst().
+ */
+
+#include <stdint.h>
+#include <rte_mbuf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Keep the IPv4 id of the input packet in all its segments. */
+#define RTE_GSO_FLAG_IPID_FIXED (1ULL << 0)
+
+/** Number of segments that rte_gso_tx_burst() transmits at once. */
+#define RTE_GSO_TX_BURST_SEG_NUM 256
+
+/**
+ * Parameters of the segmentation.
+ */
+struct rte_gso_ctx {
+	struct rte_mempool *direct_pool;
+	/**< Pool of the mbufs holding the headers of the segments. */
+	struct rte_mempool *indirect_pool;
+	/**< Pool of the indirect mbufs attached to the payload; its mbufs
+	 * need no data room.
+	 */
+	uint64_t flag;
+	/**< OR of RTE_GSO_FLAG_* flags. */
+	uint32_t gso_types;
+	/**< Types of packets to segment, as an OR of the TX offload
+	 * capabilities the port lacks: DEV_TX_OFFLOAD_TCP_TSO,
+	 * DEV_TX_OFFLOAD_VXLAN_TNL_TSO and DEV_TX_OFFLOAD_UDP_TSO.
+	 */
+	uint16_t gso_size;
+	/**< Max length of the output packets, from the first byte of the
+	 * (outer) Ethernet header, when the tso_segsz field of the packet
+	 * is 0.
+	 */
+};
+
+/**
+ * Segment a packet.
+ *
+ * The packet is segmented when its ol_flags request it and the matching
+ * type is enabled in the context:
+ *  - PKT_TX_TCP_SEG with PKT_TX_IPV4 or PKT_TX_IPV6 (DEV_TX_OFFLOAD_TCP_TSO):
+ *    l2_len, l3_len and l4_len are set;
+ *  - PKT_TX_TCP_SEG with PKT_TX_OUTER_IPV4 (DEV_TX_OFFLOAD_VXLAN_TNL_TSO):
+ *    outer_l2_len and outer_l3_len are also set, and l2_len covers the
+ *    outer UDP, VXLAN and inner Ethernet headers;
+ *  - PKT_TX_UDP_SEG with PKT_TX_IPV4 (DEV_TX_OFFLOAD_UDP_TSO): the
+ *    datagram is fragmented, l2_len and l3_len are set.
+ * The headers must be in the first segment and the IP headers must not
+ * have options or extension headers. Each TCP segment carries tso_segsz
+ * bytes of payload, and each IPv4 fragment tso_segsz bytes of IP payload
+ * rounded down to 8, or as much as allows ctx->gso_size when tso_segsz
+ * is 0.
+ *
+ * The checksums are computed in software, except the ones the packet
+ * requests from the hardware with PKT_TX_IP_CKSUM, PKT_TX_OUTER_IP_CKSUM
+ * and PKT_TX_TCP_CKSUM; for the latter the pseudo-header checksum,
+ * including the length, is set as for non-TSO packets. A non-zero outer
+ * UDP checksum of VXLAN packets is recomputed.
+ *
+ * Other packets are returned as is in pkts_out[0]; so are packets whose
+ * payload fits in one segment, after their flags and headers are updated
+ * in place.
+ *
+ * @param pkt
+ *   The packet to segment.
+ * @param ctx
+ *   The segmentation parameters.
+ * @param pkts_out
+ *   Array receiving the output packets.
+ * @param nb_pkts_out
+ *   Size of pkts_out.
+ * @return
+ *   The number of output packets, in which case a segmented pkt is freed
+ *   (its data being still referenced by the segments), or a negative
+ *   errno value, in which case pkt is not freed:
+ *    - EINVAL: invalid parameters or unsupported headers
+ *    - ENOSPC: pkts_out is too small
+ *    - ENOMEM: not enough mbufs
+ */
+int rte_gso_segment(struct rte_mbuf *pkt, const struct rte_gso_ctx *ctx,
+		struct rte_mbuf **pkts_out, uint16_t nb_pkts_out);
+
+/**
+ * Segment a burst of packets with rte_gso_segment() and send the result
+ * with rte_eth_tx_burst().
+ *
+ * Like rte_eth_tx_burst(), the function returns the number of packets of
+ * tx_pkts that were consumed; the remaining ones are left untouched but
+ * for the in-place update of the packets needing no segmentation, and
+ * can be sent again. A packet of which only the first segments were
+ * accepted by the port is considered sent: its other segments are freed,
+ * the transport protocol seeing them as lost.
+ *
+ * @param port_id
+ *   The port to transmit on.
+ * @param queue_id
+ *   The TX queue to transmit on.
+ * @param tx_pkts
+ *   The packets to transmit.
+ * @param nb_pkts
+ *   The number of packets.
+ * @param ctx
+ *   The segmentation parameters.
+ * @return
+ *   The number of packets consumed from tx_pkts.
+ */
+uint16_t rte_gso_tx_burst(uint8_t port_id, uint16_t queue_id,
+		struct rte_mbuf **tx_pkts, uint16_t nb_pkts,
+		const struct rte_gso_ctx *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_GSO_H_ */
@@ -54,18 +54,49 @@
 #define IPv6_KEY_BYTES_FMT \
 	"%08" PRIx64 "%08" PRIx64 "%08" PRIx64 "%08" PRIx64
 
+/* buckets held by ip_frag_find() on a shared table */
+struct ip_frag_bkt_lock {
+	uint32_t bkt[2];  /* bucket indexes, in locking order */
+	uint32_t num;     /* number of locked buckets */
+};
+
 /* internal functions declarations */
-struct rte_mbuf * ip_frag_process(struct ip_frag_pkt *fp,
+struct rte_mbuf * ip_frag_process(struct rte_ip_frag_tbl *tbl,
+		struct ip_frag_pkt *fp,
 		struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb,
 		uint16_t ofs, uint16_t len, uint16_t more_frags);
 
 struct ip_frag_pkt * ip_frag_find(struct rte_ip_frag_tbl *tbl,
 		struct rte_ip_frag_death_row *dr,
-		const struct ip_frag_key *key, uint64_t tms);
+		const struct ip_frag_key *key, uint64_t tms,
+		struct ip_frag_bkt_lock *lk);
 
 struct ip_frag_pkt * ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
-	const struct ip_frag_key *key, uint64_t tms,
-	struct ip_frag_pkt **free, struct ip_frag_pkt **stale);
+	const struct ip_frag_key *key, uint32_t sig1, uint32_t sig2,
+	uint64_t tms, struct ip_frag_pkt **free, struct ip_frag_pkt **stale);
+
+void ip_frag_key_hash(const struct ip_frag_key *key,
+	uint32_t *sig1, uint32_t *sig2);
+
+uint32_t ip_frag_tbl_del_expired(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, uint64_t tms);
+
+/* per protocol part of the burst fragmentation */
+struct ip_frag_burst_ops {
+	uint16_t in_hdr_len;   /* L3 header length of the input packets */
+	uint16_t out_hdr_len;  /* L3 header length of the fragments */
+	/* check that the packet may be fragmented, 0 or -errno */
+	int (*check)(const struct rte_mbuf *m);
+	/* build fragment header, fragment payload is already attached */
+	void (*fill_hdr)(struct rte_mbuf *m, const void *in_hdr,
+		uint32_t ofs, uint32_t mf, uint32_t flags);
+};
+
+uint16_t ip_frag_burst(const struct ip_frag_burst_ops *ops,
+	struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+	struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out,
+	uint16_t mtu_size, struct rte_mempool *pool_direct,
+	struct rte_mempool *pool_indirect, uint32_t flags);
 
 /* these functions need to be declared here as ip_frag_process relies on them */
 struct rte_mbuf *ipv4_frag_reassemble(struct ip_frag_pkt *fp);
@@ -101,11 +132,12 @@ ip_frag_key_invalidate(struct ip_frag_key * key)
 static inline int
 ip_frag_key_cmp(const struct ip_frag_key * k1, const struct ip_frag_key * k2)
 {
-	uint32_t i, val;
+	uint32_t i;
+	uint64_t val;
 	val = k1->id ^ k2->id;
 	for (i = 0; i < k1->key_len; i++)
 		val |= k1->src_dst[i] ^ k2->src_dst[i];
-	return val;
+	return val != 0;
 }
 
 /*
@@ -130,13 +162,66 @@ ip_frag_free(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr)
 	dr->cnt = k;
 }
 
+/*
+ * misc frag table functions
+ */
+
+/* get table entry by its index */
+static inline struct ip_frag_pkt *
+ip_frag_tbl_entry(const struct rte_ip_frag_tbl *tbl, uint32_t idx)
+{
+	return (struct ip_frag_pkt *)((uintptr_t)tbl->pkt +
+		(uintptr_t)idx * tbl->entry_size);
+}
+
+/* get index of the bucket the entry belongs to */
+static inline uint32_t
+ip_frag_tbl_bucket(const struct rte_ip_frag_tbl *tbl,
+	const struct ip_frag_pkt *fp)
+{
+	return ((uintptr_t)fp - (uintptr_t)tbl->pkt) /
+		tbl->entry_size / tbl->bucket_entries;
+}
+
+static inline int
+ip_frag_tbl_shared(const struct rte_ip_frag_tbl *tbl)
+{
+	return (tbl->flags & RTE_IP_FRAG_TBL_F_SHARED) != 0;
+}
+
+static inline void
+ip_frag_lru_lock(struct rte_ip_frag_tbl *tbl)
+{
+	if (ip_frag_tbl_shared(tbl))
+		rte_spinlock_lock(&tbl->lru_lock);
+}
+
+static inline void
+ip_frag_lru_unlock(struct rte_ip_frag_tbl *tbl)
+{
+	if (ip_frag_tbl_shared(tbl))
+		rte_spinlock_unlock(&tbl->lru_lock);
+}
+
+/* release buckets locked by ip_frag_find() */
+static inline void
+ip_frag_unlock(struct rte_ip_frag_tbl *tbl, const struct ip_frag_bkt_lock *lk)
+{
+	uint32_t i;
+
+	for (i = lk->num; i != 0; i--)
+		rte_spinlock_unlock(&tbl->bucket_lock[lk->bkt[i - 1]]);
+}
+
 /* if key is empty, mark key as in use */
 static inline void
 ip_frag_inuse(struct rte_ip_frag_tbl *tbl, const struct  ip_frag_pkt *fp)
 {
 	if (ip_frag_key_is_empty(&fp->key)) {
+		ip_frag_lru_lock(tbl);
 		TAILQ_REMOVE(&tbl->lru, fp, lru);
 		tbl->use_entries--;
+		ip_frag_lru_unlock(tbl);
 	}
 }
 
@@ -32,8 +32,12 @@
  */
 
 #include <stddef.h>
+#include <errno.h>
 
+#include <rte_debug.h>
+#include <rte_errno.h>
 #include <rte_jhash.h>
+#include <rte_mbuf.h>
 #ifdef RTE_MACHINE_CPUFLAG_SSE4_2
 #include <rte_hash_crc.h>
 #endif /* RTE_MACHINE_CPUFLAG_SSE4_2 */
@@ -43,12 +47,17 @@
 #define	PRIME_VALUE	0xeaad8405
 
 #define	IP_FRAG_TBL_POS(tbl, sig)	\
-	((tbl)->pkt + ((sig) & (tbl)->entry_mask))
+	((sig) & (tbl)->entry_mask)
 
 #ifdef RTE_LIBRTE_IP_FRAG_TBL_STAT
-#define	IP_FRAG_TBL_STAT_UPDATE(s, f, v)	((s)->f += (v))
+#define	IP_FRAG_TBL_STAT_UPDATE(tbl, f, v)	do {              \
+	if (ip_frag_tbl_shared(tbl))                              \
+		__sync_fetch_and_add(&(tbl)->stat.f, (v));        \
+	else                                                      \
+		(tbl)->stat.f += (v);                             \
+} while (0)
 #else
-#define	IP_FRAG_TBL_STAT_UPDATE(s, f, v)	do {} while (0)
+#define	IP_FRAG_TBL_STAT_UPDATE(tbl, f, v)	do {} while (0)
 #endif /* IP_FRAG_TBL_STAT */
 
 /* local frag table helper functions */
@@ -58,9 +67,11 @@ ip_frag_tbl_del(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 {
 	ip_frag_free(fp, dr);
 	ip_frag_key_invalidate(&fp->key);
+	ip_frag_lru_lock(tbl);
 	TAILQ_REMOVE(&tbl->lru, fp, lru);
 	tbl->use_entries--;
-	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, del_num, 1);
+	ip_frag_lru_unlock(tbl);
+	IP_FRAG_TBL_STAT_UPDATE(tbl, del_num, 1);
 }
 
 static inline void
@@ -69,9 +80,11 @@ ip_frag_tbl_add(struct rte_ip_frag_tbl *tbl,  struct ip_frag_pkt *fp,
 {
 	fp->key = key[0];
 	ip_frag_reset(fp, tms);
+	ip_frag_lru_lock(tbl);
 	TAILQ_INSERT_TAIL(&tbl->lru, fp, lru);
 	tbl->use_entries++;
-	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, add_num, 1);
+	ip_frag_lru_unlock(tbl);
+	IP_FRAG_TBL_STAT_UPDATE(tbl, add_num, 1);
 }
 
 static inline void
@@ -80,12 +93,103 @@ ip_frag_tbl_reuse(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 {
 	ip_frag_free(fp, dr);
 	ip_frag_reset(fp, tms);
+	ip_frag_lru_lock(tbl);
 	TAILQ_REMOVE(&tbl->lru, fp, lru);
 	TAILQ_INSERT_TAIL(&tbl->lru, fp, lru);
-	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, reuse_num, 1);
+	ip_frag_lru_unlock(tbl);
+	IP_FRAG_TBL_STAT_UPDATE(tbl, reuse_num, 1);
+}
+
+/*
+ * Lock the two candidate buckets of a shared table,
+ * always in ascending order to avoid deadlocks.
+ */
+static inline void
+ip_frag_tbl_lock(struct rte_ip_frag_tbl *tbl, uint32_t sig1, uint32_t sig2,
+	struct ip_frag_bkt_lock *lk)
+{
+	uint32_t b1, b2;
+
+	b1 = IP_FRAG_TBL_POS(tbl, sig1) / tbl->bucket_entries;
+	b2 = IP_FRAG_TBL_POS(tbl, sig2) / tbl->bucket_entries;
+
+	lk->bkt[0] = RTE_MIN(b1, b2);
+	lk->bkt[1] = RTE_MAX(b1, b2);
+	lk->num = (b1 == b2) ? 1 : 2;
+
+	rte_spinlock_lock(&tbl->bucket_lock[lk->bkt[0]]);
+	if (lk->num == 2)
+		rte_spinlock_lock(&tbl->bucket_lock[lk->bkt[1]]);
+}
+
+/*
+ * Delete the oldest entry of a full table, if it is timed out.
+ * For a shared table the entry may belong to a bucket we don't hold,
+ * in that case only try to grab it, never wait.
+ */
+static inline int
+ip_frag_tbl_evict_lru(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, uint64_t tms,
+	const struct ip_frag_bkt_lock *lk)
+{
+	struct ip_frag_pkt *lru;
+	uint32_t bkt;
+	int held;
+
+	if (!ip_frag_tbl_shared(tbl)) {
+		lru = TAILQ_FIRST(&tbl->lru);
+		if (tbl->max_cycles + lru->start >= tms)
+			return 0;
+		ip_frag_tbl_del(tbl, dr, lru);
+		return 1;
+	}
+
+	rte_spinlock_lock(&tbl->lru_lock);
+	lru = TAILQ_FIRST(&tbl->lru);
+	if (lru == NULL || tbl->max_cycles + lru->start >= tms) {
+		rte_spinlock_unlock(&tbl->lru_lock);
+		return 0;
+	}
+
+	bkt = ip_frag_tbl_bucket(tbl, lru);
+	held = (bkt == lk->bkt[0] || (lk->num == 2 && bkt == lk->bkt[1]));
+	if (!held && rte_spinlock_trylock(&tbl->bucket_lock[bkt]) == 0) {
+		rte_spinlock_unlock(&tbl->lru_lock);
+		return 0;
+	}
+	rte_spinlock_unlock(&tbl->lru_lock);
+
+	ip_frag_tbl_del(tbl, dr, lru);
+
+	if (!held)
+		rte_spinlock_unlock(&tbl->bucket_lock[bkt]);
+	return 1;
 }
 
 
+/*
+ * Delete timed out entries, oldest first, as long as the death row
+ * has room for all fragments of one more entry.
+ */
+uint32_t
+ip_frag_tbl_del_expired(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, uint64_t tms)
+{
+	struct ip_frag_bkt_lock lk = {
+		.bkt = {UINT32_MAX, UINT32_MAX},
+		.num = 0,
+	};
+	uint32_t n;
+
+	n = 0;
+	while (tbl->use_entries != 0 &&
+			dr->cnt + tbl->max_frags <= RTE_DIM(dr->row) &&
+			ip_frag_tbl_evict_lru(tbl, dr, tms, &lk) != 0)
+		n++;
+
+	return n;
+}
+
 static inline void
 ipv4_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
 {
@@ -136,9 +240,20 @@ ipv6_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
 	*v2 = (v << 7) + (v >> 14);
 }
 
+void
+ip_frag_key_hash(const struct ip_frag_key *key, uint32_t *sig1, uint32_t *sig2)
+{
+	/* different hashing methods for IPv4 and IPv6 */
+	if (key->key_len == IPV4_KEYLEN)
+		ipv4_frag_hash(key, sig1, sig2);
+	else
+		ipv6_frag_hash(key, sig1, sig2);
+}
+
 struct rte_mbuf *
-ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
-	struct rte_mbuf *mb, uint16_t ofs, uint16_t len, uint16_t more_frags)
+ip_frag_process(struct rte_ip_frag_tbl *tbl, struct ip_frag_pkt *fp,
+	struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb,
+	uint16_t ofs, uint16_t len, uint16_t more_frags)
 {
 	uint32_t idx;
 
@@ -156,16 +271,17 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
 				IP_LAST_FRAG_IDX : UINT32_MAX;
 
 	/* this is the intermediate fragment. */
-	} else if ((idx = fp->last_idx) <
-		sizeof (fp->frags) / sizeof (fp->frags[0])) {
+	} else if ((idx = fp->last_idx) < tbl->max_frags) {
 		fp->last_idx++;
+	} else {
+		IP_FRAG_TBL_STAT_UPDATE(tbl, fail_nofrag, 1);
 	}
 
 	/*
 	 * errorneous packet: either exceeed max allowed number of fragments,
 	 * or duplicate first/last fragment encountered.
 	 */
-	if (idx >= sizeof (fp->frags) / sizeof (fp->frags[0])) {
+	if (idx >= tbl->max_frags) {
 
 		/* report an error. */
 		if (fp->key.key_len == IPV4_KEYLEN)
@@ -270,10 +386,11 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
  */
 struct ip_frag_pkt *
 ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
-	const struct ip_frag_key *key, uint64_t tms)
+	const struct ip_frag_key *key, uint64_t tms, struct ip_frag_bkt_lock *lk)
 {
-	struct ip_frag_pkt *pkt, *free, *stale, *lru;
+	struct ip_frag_pkt *pkt, *free, *stale;
 	uint64_t max_cycles;
+	uint32_t sig1, sig2;
 
 	/*
 	 * Actually the two line below are totally redundant.
@@ -282,10 +399,16 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 	free = NULL;
 	stale = NULL;
 	max_cycles = tbl->max_cycles;
+	lk->num = 0;
+
+	IP_FRAG_TBL_STAT_UPDATE(tbl, find_num, 1);
 
-	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, find_num, 1);
+	ip_frag_key_hash(key, &sig1, &sig2);
+	if (ip_frag_tbl_shared(tbl))
+		ip_frag_tbl_lock(tbl, sig1, sig2, lk);
 
-	if ((pkt = ip_frag_lookup(tbl, key, tms, &free, &stale)) == NULL) {
+	if ((pkt = ip_frag_lookup(tbl, key, sig1, sig2, tms,
+			&free, &stale)) == NULL) {
 
 		/*timed-out entry, free and invalidate it*/
 		if (stale != NULL) {
@@ -299,13 +422,9 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 		 */
 		} else if (free != NULL &&
 				tbl->max_entries <= tbl->use_entries) {
-			lru = TAILQ_FIRST(&tbl->lru);
-			if (max_cycles + lru->start < tms) {
-				ip_frag_tbl_del(tbl, dr, lru);
-			} else {
+			if (ip_frag_tbl_evict_lru(tbl, dr, tms, lk) == 0) {
 				free = NULL;
-				IP_FRAG_TBL_STAT_UPDATE(&tbl->stat,
-					fail_nospace, 1);
+				IP_FRAG_TBL_STAT_UPDATE(tbl, fail_nospace, 1);
 			}
 		}
 
@@ -324,21 +443,24 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 		ip_frag_tbl_reuse(tbl, dr, pkt, tms);
 	}
 
-	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, fail_total, (pkt == NULL));
+	IP_FRAG_TBL_STAT_UPDATE(tbl, fail_total, (pkt == NULL));
 
-	tbl->last = pkt;
+	if (pkt == NULL)
+		ip_frag_unlock(tbl, lk);
+	else if (!ip_frag_tbl_shared(tbl))
+		tbl->last = pkt;
 	return pkt;
 }
 
 struct ip_frag_pkt *
 ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
-	const struct ip_frag_key *key, uint64_t tms,
-	struct ip_frag_pkt **free, struct ip_frag_pkt **stale)
+	const struct ip_frag_key *key, uint32_t sig1, uint32_t sig2,
+	uint64_t tms, struct ip_frag_pkt **free, struct ip_frag_pkt **stale)
 {
 	struct ip_frag_pkt *p1, *p2;
 	struct ip_frag_pkt *empty, *old;
 	uint64_t max_cycles;
-	uint32_t i, assoc, sig1, sig2;
+	uint32_t i, assoc, pos1, pos2;
 
 	empty = NULL;
 	old = NULL;
@@ -346,19 +468,17 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 	max_cycles = tbl->max_cycles;
 	assoc = tbl->bucket_entries;
 
+	/* last used entry is only cached for lcore private tables */
 	if (tbl->last != NULL && ip_frag_key_cmp(key, &tbl->last->key) == 0)
 		return tbl->last;
 
-	/* different hashing methods for IPv4 and IPv6 */
-	if (key->key_len == IPV4_KEYLEN)
-		ipv4_frag_hash(key, &sig1, &sig2);
-	else
-		ipv6_frag_hash(key, &sig1, &sig2);
-
-	p1 = IP_FRAG_TBL_POS(tbl, sig1);
-	p2 = IP_FRAG_TBL_POS(tbl, sig2);
+	pos1 = IP_FRAG_TBL_POS(tbl, sig1);
+	pos2 = IP_FRAG_TBL_POS(tbl, sig2);
 
 	for (i = 0; i != assoc; i++) {
+		p1 = ip_frag_tbl_entry(tbl, pos1 + i);
+		p2 = ip_frag_tbl_entry(tbl, pos2 + i);
+
 		if (p1->key.key_len == IPV4_KEYLEN)
 			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
 					"tbl: %p, max_entries: %u, use_entries: %u\n"
@@ -367,7 +487,7 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 					__func__, __LINE__,
 					tbl, tbl->max_entries, tbl->use_entries,
 					p1, i, assoc,
-			p1[i].key.src_dst[0], p1[i].key.id, p1[i].start);
+			p1->key.src_dst[0], p1->key.id, p1->start);
 		else
 			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
 					"tbl: %p, max_entries: %u, use_entries: %u\n"
@@ -376,14 +496,14 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 					__func__, __LINE__,
 					tbl, tbl->max_entries, tbl->use_entries,
 					p1, i, assoc,
-			IPv6_KEY_BYTES(p1[i].key.src_dst), p1[i].key.id, p1[i].start);
+			IPv6_KEY_BYTES(p1->key.src_dst), p1->key.id, p1->start);
 
-		if (ip_frag_key_cmp(key, &p1[i].key) == 0)
-			return p1 + i;
-		else if (ip_frag_key_is_empty(&p1[i].key))
-			empty = (empty == NULL) ? (p1 + i) : empty;
-		else if (max_cycles + p1[i].start < tms)
-			old = (old == NULL) ? (p1 + i) : old;
+		if (ip_frag_key_cmp(key, &p1->key) == 0)
+			return p1;
+		else if (ip_frag_key_is_empty(&p1->key))
+			empty = (empty == NULL) ? p1 : empty;
+		else if (max_cycles + p1->start < tms)
+			old = (old == NULL) ? p1 : old;
 
 		if (p2->key.key_len == IPV4_KEYLEN)
 			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
@@ -393,7 +513,7 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 					__func__, __LINE__,
 					tbl, tbl->max_entries, tbl->use_entries,
 					p2, i, assoc,
-			p2[i].key.src_dst[0], p2[i].key.id, p2[i].start);
+			p2->key.src_dst[0], p2->key.id, p2->start);
 		else
 			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
 					"tbl: %p, max_entries: %u, use_entries: %u\n"
@@ -402,17 +522,239 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 					__func__, __LINE__,
 					tbl, tbl->max_entries, tbl->use_entries,
 					p2, i, assoc,
-			IPv6_KEY_BYTES(p2[i].key.src_dst), p2[i].key.id, p2[i].start);
-
-		if (ip_frag_key_cmp(key, &p2[i].key) == 0)
-			return p2 + i;
-		else if (ip_frag_key_is_empty(&p2[i].key))
-			empty = (empty == NULL) ?( p2 + i) : empty;
-		else if (max_cycles + p2[i].start < tms)
-			old = (old == NULL) ? (p2 + i) : old;
+			IPv6_KEY_BYTES(p2->key.src_dst), p2->key.id, p2->start);
+
+		if (ip_frag_key_cmp(key, &p2->key) == 0)
+			return p2;
+		else if (ip_frag_key_is_empty(&p2->key))
+			empty = (empty == NULL) ? p2 : empty;
+		else if (max_cycles + p2->start < tms)
+			old = (old == NULL) ? p2 : old;
 	}
 
 	*free = empty;
 	*stale = old;
 	return NULL;
 }
+
+/* max number of mbufs allocated at once by ip_frag_burst() */
+#define	IP_FRAG_BURST_MBUFS	512
+
+/* size of one fragment header slot in a shared header mbuf */
+#define	IP_FRAG_HDR_SLOT(hdr_len)	\
+	RTE_CACHE_LINE_ROUNDUP(RTE_IP_FRAG_SHARED_HDR_ROOM + (hdr_len))
+
+/*
+ * Count fragments and payload segments needed for one packet,
+ * one payload segment per (fragment, non empty input segment) overlap.
+ */
+static inline void
+ip_frag_burst_count(const struct rte_mbuf *m, uint32_t hdr_len,
+	uint32_t frag_size, uint32_t *nb_frags, uint32_t *nb_segs)
+{
+	uint32_t start, end, segs;
+
+	segs = 0;
+	start = 0;
+	end = m->data_len - hdr_len;
+
+	for (;;) {
+		if (end != start)
+			segs += (end - 1) / frag_size - start / frag_size + 1;
+		m = m->next;
+		if (m == NULL)
+			break;
+		start = end;
+		end += m->data_len;
+	}
+
+	*nb_frags = (end + frag_size - 1) / frag_size;
+	*nb_segs = segs;
+}
+
+/*
+ * Fragment a burst of packets.
+ * First pass finds how many input packets can be handled and how many
+ * mbufs they need, then all mbufs are taken from the pools at once,
+ * and the second pass builds the fragments.
+ */
+uint16_t
+ip_frag_burst(const struct ip_frag_burst_ops *ops,
+	struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+	struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out,
+	uint16_t mtu_size, struct rte_mempool *pool_direct,
+	struct rte_mempool *pool_indirect, uint32_t flags)
+{
+	struct rte_mbuf *dir[IP_FRAG_BURST_MBUFS];
+	struct rte_mbuf *ind[IP_FRAG_BURST_MBUFS];
+	struct rte_mbuf *m, *seg, *hdr, *head, *prev, *out_seg;
+	uint32_t i, j, n_in, n_out, n_dir, n_ind, nb_frags, nb_segs, room;
+	uint32_t frag_size, slot_size, hdr_per_mbuf, slot, seg_pos;
+	uint32_t ofs, remain, left, len, d, x, k;
+	int shared, ret;
+
+	shared = (flags & RTE_IP_FRAG_F_SHARED_HDR) != 0;
+	frag_size = (mtu_size - ops->out_hdr_len) & ~(IPV4_HDR_OFFSET_UNITS - 1);
+	slot_size = IP_FRAG_HDR_SLOT(ops->out_hdr_len);
+	hdr_per_mbuf = shared ?
+		rte_pktmbuf_data_room_size(pool_direct) / slot_size : 0;
+
+	if (mtu_size <= ops->out_hdr_len || frag_size == 0 ||
+			(shared && hdr_per_mbuf == 0)) {
+		rte_errno = EINVAL;
+		*nb_pkts_out = 0;
+		return 0;
+	}
+
+	/* first pass: how many packets fit, and what they need. */
+	room = *nb_pkts_out;
+	n_out = 0;
+	n_dir = 0;
+	n_ind = 0;
+	ret = 0;
+	for (n_in = 0; n_in != nb_pkts_in; n_in++) {
+		m = pkts_in[n_in];
+
+		if (m->pkt_len <= mtu_size) {
+			nb_frags = 1;
+			nb_segs = 0;
+		} else if (m->data_len < ops->in_hdr_len) {
+			ret = -EINVAL;
+			break;
+		} else if ((ret = ops->check(m)) != 0) {
+			break;
+		} else {
+			ip_frag_burst_count(m, ops->in_hdr_len, frag_size,
+				&nb_frags, &nb_segs);
+			nb_segs += shared ? nb_frags : 0;
+		}
+
+		if (n_out + nb_frags > room) {
+			ret = -ENOSPC;
+			break;
+		}
+
+		/* pass-through packets need no new mbuf */
+		if (nb_segs != 0) {
+			d = shared ? (nb_frags + hdr_per_mbuf - 1) /
+				hdr_per_mbuf : nb_frags;
+			if (n_dir + d > RTE_DIM(dir) ||
+					n_ind + nb_segs > RTE_DIM(ind)) {
+				ret = -ENOSPC;
+				break;
+			}
+			n_dir += d;
+			n_ind += nb_segs;
+		}
+		n_out += nb_frags;
+	}
+
+	if (n_in == 0) {
+		rte_errno = -ret;
+		*nb_pkts_out = 0;
+		return 0;
+	}
+
+	if (n_dir != 0 && rte_pktmbuf_alloc_bulk(pool_direct, dir, n_dir) != 0) {
+		rte_errno = ENOMEM;
+		*nb_pkts_out = 0;
+		return 0;
+	}
+	if (n_ind != 0 &&
+			rte_pktmbuf_alloc_bulk(pool_indirect, ind, n_ind) != 0) {
+		for (i = 0; i != n_dir; i++)
+			rte_pktmbuf_free(dir[i]);
+		rte_errno = ENOMEM;
+		*nb_pkts_out = 0;
+		return 0;
+	}
+
+	/* second pass: build the fragments. */
+	d = 0;
+	x = 0;
+	k = 0;
+	for (i = 0; i != n_in; i++) {
+		m = pkts_in[i];
+
+		if (m->pkt_len <= mtu_size) {
+			pkts_out[k++] = m;
+			continue;
+		}
+
+		seg = m;
+		seg_pos = ops->in_hdr_len;
+		while (seg != NULL && seg_pos == seg->data_len) {
+			seg = seg->next;
+			seg_pos = 0;
+		}
+
+		hdr = NULL;
+		slot = hdr_per_mbuf;
+		ofs = 0;
+		remain = m->pkt_len - ops->in_hdr_len;
+
+		for (j = 0; remain != 0; j++) {
+
+			/* fragment header, either direct or in a shared slot */
+			if (shared) {
+				if (slot == hdr_per_mbuf) {
+					if (hdr != NULL)
+						rte_pktmbuf_free(hdr);
+					hdr = dir[d++];
+					slot = 0;
+				}
+				head = ind[x++];
+				rte_pktmbuf_attach(head, hdr);
+				head->data_off = (uint16_t)(slot * slot_size +
+					RTE_IP_FRAG_SHARED_HDR_ROOM);
+				slot++;
+			} else {
+				head = dir[d++];
+			}
+			head->data_len = ops->out_hdr_len;
+			head->pkt_len = ops->out_hdr_len;
+			head->nb_segs = 1;
+
+			/* attach payload of the fragment */
+			left = RTE_MIN(frag_size, remain);
+			remain -= left;
+			prev = head;
+			while (left != 0) {
+				out_seg = ind[x++];
+				rte_pktmbuf_attach(out_seg, seg);
+				len = RTE_MIN(left, seg->data_len - seg_pos);
+				out_seg->data_off = (uint16_t)(seg->data_off +
+					seg_pos);
+				out_seg->data_len = (uint16_t)len;
+				prev->next = out_seg;
+				prev = out_seg;
+				head->pkt_len += len;
+				head->nb_segs++;
+				seg_pos += len;
+				left -= len;
+
+				while (seg != NULL && seg_pos == seg->data_len) {
+					seg = seg->next;
+					seg_pos = 0;
+				}
+			}
+
+			ops->fill_hdr(head, rte_pktmbuf_mtod(m, const void *),
+				ofs, remain != 0, flags);
+			ofs += head->pkt_len - ops->out_hdr_len;
+			pkts_out[k++] = head;
+		}
+
+		/* fragments hold their own references now. */
+		if (hdr != NULL)
+			rte_pktmbuf_free(hdr);
+		rte_pktmbuf_free(m);
+	}
+
+	RTE_ASSERT(d == n_dir && x == n_ind && k == n_out);
+
+	if (ret != 0)
+		rte_errno = -ret;
+	*nb_pkts_out = (uint16_t)k;
+	return (uint16_t)n_in;
+}
@@ -50,6 +50,7 @@ extern "C" {
 
 #include <rte_malloc.h>
 #include <rte_memory.h>
+#include <rte_spinlock.h>
 #include <rte_ip.h>
 #include <rte_byteorder.h>
 
@@ -110,8 +111,27 @@ struct ip_frag_tbl_stat {
 	uint64_t reuse_num;     /**< # of reuse (del/add) ops. */
 	uint64_t fail_total;    /**< total # of add failures. */
 	uint64_t fail_nospace;  /**< # of 'no space' add failures. */
+	uint64_t fail_nofrag;   /**< # of packets with too many fragments. */
 } __rte_cache_aligned;
 
+/**
+ * Fragmentation table can be shared by several lcores.
+ * Lookups lock the two candidate buckets only, LRU list updates
+ * are serialized by a separate lock.
+ */
+#define RTE_IP_FRAG_TBL_F_SHARED	0x1
+
+/** fragmentation table creation parameters */
+struct rte_ip_frag_tbl_params {
+	uint32_t bucket_num;      /**< number of buckets in the hash table. */
+	uint32_t bucket_entries;  /**< hash associativity, power of two. */
+	uint32_t max_entries;     /**< max entries allowed. */
+	uint32_t max_frags;       /**< max fragments per packet, 0 for default. */
+	uint64_t max_cycles;      /**< ttl for table entries. */
+	uint32_t flags;           /**< RTE_IP_FRAG_TBL_F_* flags. */
+	int socket_id;            /**< NUMA socket to allocate the table on. */
+};
+
 /** fragmentation table */
 struct rte_ip_frag_tbl {
 	uint64_t             max_cycles;      /**< ttl for table entries. */
@@ -121,12 +141,36 @@ struct rte_ip_frag_tbl {
 	uint32_t             bucket_entries;  /**< hash assocaitivity. */
 	uint32_t             nb_entries;      /**< total size of the table. */
 	uint32_t             nb_buckets;      /**< num of associativity lines. */
+	uint32_t             max_frags;       /**< max fragments per packet. */
+	uint32_t             entry_size;      /**< size of one table entry. */
+	uint32_t             flags;           /**< RTE_IP_FRAG_TBL_F_* flags. */
 	struct ip_frag_pkt *last;         /**< last used entry. */
 	struct ip_pkt_list lru;           /**< LRU list for table entries. */
+	rte_spinlock_t lru_lock;          /**< LRU list lock (shared table). */
+	rte_spinlock_t *bucket_lock;      /**< per bucket locks (shared table). */
 	struct ip_frag_tbl_stat stat;     /**< statistics counters. */
 	struct ip_frag_pkt pkt[0];        /**< hash table. */
 };
 
+/**
+ * Burst fragmentation: compute IPv4 header checksum of the fragments in
+ * software, instead of requesting it from the NIC with PKT_TX_IP_CKSUM.
+ */
+#define RTE_IP_FRAG_F_SW_CKSUM		0x1
+
+/**
+ * Burst fragmentation: write the headers of all fragments of a packet
+ * into one mbuf from the direct pool, each fragment starting with an
+ * indirect mbuf pointing at its own header slot.
+ */
+#define RTE_IP_FRAG_F_SHARED_HDR	0x2
+
+/**
+ * Headroom available in front of each fragment header when
+ * RTE_IP_FRAG_F_SHARED_HDR is used, to prepend the L2 header.
+ */
+#define RTE_IP_FRAG_SHARED_HDR_ROOM	64
+
 /** IPv6 fragment extension header */
 #define	RTE_IPV6_EHDR_MF_SHIFT			0
 #define	RTE_IPV6_EHDR_MF_MASK			1
@@ -174,6 +218,23 @@ struct rte_ip_frag_tbl * rte_ip_frag_table_create(uint32_t bucket_num,
 		uint32_t bucket_entries,  uint32_t max_entries,
 		uint64_t max_cycles, int socket_id);
 
+/**
+ * Create a new IP fragmentation table with extended parameters.
+ *
+ * Unlike rte_ip_frag_table_create(), the number of fragments each entry
+ * can hold is chosen per table (up to RTE_LIBRTE_IP_FRAG_MAX_FRAG), so that
+ * entry size follows the expected traffic. With RTE_IP_FRAG_TBL_F_SHARED
+ * set, the table may be used by several lcores at the same time, each one
+ * passing its own death row to the reassembly functions.
+ *
+ * @param params
+ *   Parameters of the table to create.
+ * @return
+ *   The pointer to the new allocated fragmentation table, on success. NULL on error.
+ */
+struct rte_ip_frag_tbl *
+rte_ip_frag_table_create_ext(const struct rte_ip_frag_tbl_params *params);
+
 /**
  * Free allocated IP fragmentation table.
  *
@@ -215,6 +276,39 @@ rte_ipv6_fragment_packet(struct rte_mbuf *pkt_in,
 		struct rte_mempool *pool_direct,
 		struct rte_mempool *pool_indirect);
 
+/**
+ * Fragment a burst of IPv6 packets.
+ *
+ * Same as rte_ipv4_fragment_burst(), for IPv6 packets without extension
+ * headers.
+ *
+ * @param pkts_in
+ *   The input packets, data starting at the IPv6 header.
+ * @param nb_pkts_in
+ *   Number of input packets.
+ * @param pkts_out
+ *   Array storing the output packets.
+ * @param nb_pkts_out
+ *   In: size of the pkts_out array. Out: number of output packets.
+ * @param mtu_size
+ *   Size in bytes of the Maximum Transfer Unit (MTU) for the outgoing IPv6
+ *   datagrams. This value includes the size of the IPv6 header.
+ * @param pool_direct
+ *   MBUF pool used for allocating fragment headers.
+ * @param pool_indirect
+ *   MBUF pool used for allocating indirect buffers.
+ * @param flags
+ *   RTE_IP_FRAG_F_SHARED_HDR or 0.
+ * @return
+ *   Number of input packets consumed. If lower than nb_pkts_in, rte_errno
+ *   tells why the next packet was not processed.
+ */
+uint16_t
+rte_ipv6_fragment_burst(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+		struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out,
+		uint16_t mtu_size, struct rte_mempool *pool_direct,
+		struct rte_mempool *pool_indirect, uint32_t flags);
+
 /**
  * This function implements reassembly of fragmented IPv6 packets.
  * Incoming mbuf should have its l2_len/l3_len fields setup correctly.
@@ -222,7 +316,7 @@ rte_ipv6_fragment_packet(struct rte_mbuf *pkt_in,
  * @param tbl
  *   Table where to lookup/add the fragmented packet.
  * @param dr
- *   Death row to free buffers to
+ *   Death row to free buffers to. Must not be shared between lcores.
  * @param mb
  *   Incoming mbuf with IPv6 fragment.
  * @param tms
@@ -291,6 +385,55 @@ int32_t rte_ipv4_fragment_packet(struct rte_mbuf *pkt_in,
 			struct rte_mempool *pool_direct,
 			struct rte_mempool *pool_indirect);
 
+/**
+ * Fragment a burst of IPv4 packets.
+ *
+ * Packets not larger than mtu_size are moved to pkts_out as they are,
+ * the other ones are replaced by their fragments. Mbufs needed for the
+ * whole burst are taken from the pools with one bulk allocation each.
+ * Payload is never copied: fragments reference it through indirect
+ * mbufs. Consumed input packets are owned by the function.
+ *
+ * Unless RTE_IP_FRAG_F_SW_CKSUM is set, fragment headers have a null
+ * checksum and PKT_TX_IPV4 | PKT_TX_IP_CKSUM in ol_flags, the caller
+ * still has to set l2_len once the L2 header is prepended.
+ *
+ * With RTE_IP_FRAG_F_SHARED_HDR, a single direct mbuf carries the
+ * headers of up to (data room / header slot) fragments of a packet,
+ * each fragment having RTE_IP_FRAG_SHARED_HDR_ROOM bytes of headroom.
+ *
+ * @param pkts_in
+ *   The input packets, data starting at the IPv4 header.
+ * @param nb_pkts_in
+ *   Number of input packets.
+ * @param pkts_out
+ *   Array storing the output packets.
+ * @param nb_pkts_out
+ *   In: size of the pkts_out array. Out: number of output packets.
+ * @param mtu_size
+ *   Size in bytes of the Maximum Transfer Unit (MTU) for the outgoing IPv4
+ *   datagrams. This value includes the size of the IPv4 header.
+ * @param pool_direct
+ *   MBUF pool used for allocating fragment headers.
+ * @param pool_indirect
+ *   MBUF pool used for allocating indirect buffers.
+ * @param flags
+ *   Combination of RTE_IP_FRAG_F_SW_CKSUM and RTE_IP_FRAG_F_SHARED_HDR.
+ * @return
+ *   Number of input packets consumed. If lower than nb_pkts_in, rte_errno
+ *   tells why the next packet was not processed:
+ *   - ENOTSUP: the packet is larger than the MTU and has the DF flag set.
+ *   - ENOSPC: not enough room left in pkts_out for its fragments, or
+ *     the mbufs the burst needs exceed what one call allocates at once.
+ *   - ENOMEM: mbuf allocation failed, no packet was consumed.
+ *   - EINVAL: invalid MTU or packet.
+ */
+uint16_t
+rte_ipv4_fragment_burst(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+		struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out,
+		uint16_t mtu_size, struct rte_mempool *pool_direct,
+		struct rte_mempool *pool_indirect, uint32_t flags);
+
 /**
  * This function implements reassembly of fragmented IPv4 packets.
  * Incoming mbufs should have its l2_len/l3_len fields setup correclty.
@@ -298,7 +441,7 @@ int32_t rte_ipv4_fragment_packet(struct rte_mbuf *pkt_in,
  * @param tbl
  *   Table where to lookup/add the fragmented packet.
  * @param dr
- *   Death row to free buffers to
+ *   Death row to free buffers to. Must not be shared between lcores.
  * @param mb
  *   Incoming mbuf with IPv4 fragment.
  * @param tms
@@ -333,6 +476,26 @@ rte_ipv4_frag_pkt_is_fragmented(const struct ipv4_hdr * hdr) {
 	return ip_flag != 0 || ip_ofs  != 0;
 }
 
+/**
+ * Delete the entries of a fragmentation table that have timed out,
+ * moving their fragments to the death row.
+ * Entries are deleted oldest first, until the death row cannot hold
+ * the fragments of one more entry.
+ * With a shared table, it also stops at an entry whose bucket is locked
+ * by another lcore.
+ *
+ * @param tbl
+ *   Fragmentation table.
+ * @param dr
+ *   Death row to put the fragments of the deleted entries on.
+ * @param tms
+ *   Current timestamp, entries older than tms - max_cycles are deleted.
+ * @return
+ *   Number of deleted entries.
+ */
+uint32_t rte_ip_frag_table_del_expired_entries(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, uint64_t tms);
+
 /**
  * Free mbufs on a given death row.
  *
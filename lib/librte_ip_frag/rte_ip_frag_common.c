@@ -67,48 +67,99 @@ rte_ip_frag_free_death_row(struct rte_ip_frag_death_row *dr,
 
 /* create fragmentation table */
 struct rte_ip_frag_tbl *
-rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
-	uint32_t max_entries, uint64_t max_cycles, int socket_id)
+rte_ip_frag_table_create_ext(const struct rte_ip_frag_tbl_params *params)
 {
 	struct rte_ip_frag_tbl *tbl;
-	size_t sz;
+	size_t sz, entry_sz, lock_ofs;
 	uint64_t nb_entries;
+	uint32_t i, max_frags, nb_locks;
+
+	if (params == NULL) {
+		RTE_LOG(ERR, USER1, "%s: invalid input parameter\n", __func__);
+		return NULL;
+	}
 
-	nb_entries = rte_align32pow2(bucket_num);
-	nb_entries *= bucket_entries;
+	nb_entries = rte_align32pow2(params->bucket_num);
+	nb_entries *= params->bucket_entries;
 	nb_entries *= IP_FRAG_HASH_FNUM;
 
+	max_frags = (params->max_frags == 0) ? IP_MAX_FRAG_NUM :
+		params->max_frags;
+
 	/* check input parameters. */
-	if (rte_is_power_of_2(bucket_entries) == 0 ||
+	if (rte_is_power_of_2(params->bucket_entries) == 0 ||
 			nb_entries > UINT32_MAX || nb_entries == 0 ||
-			nb_entries < max_entries) {
+			nb_entries < params->max_entries ||
+			max_frags < IP_MIN_FRAG_NUM ||
+			max_frags > IP_MAX_FRAG_NUM ||
+			(params->flags & ~RTE_IP_FRAG_TBL_F_SHARED) != 0) {
 		RTE_LOG(ERR, USER1, "%s: invalid input parameter\n", __func__);
 		return NULL;
 	}
 
-	sz = sizeof (*tbl) + nb_entries * sizeof (tbl->pkt[0]);
+	/* entries only hold as many fragment slots as the table needs. */
+	entry_sz = offsetof(struct ip_frag_pkt, frags) +
+		max_frags * sizeof(struct ip_frag);
+	entry_sz = RTE_ALIGN_CEIL(entry_sz, RTE_CACHE_LINE_SIZE);
+
+	sz = sizeof(*tbl) + nb_entries * entry_sz;
+	lock_ofs = sz;
+	nb_locks = 0;
+	if ((params->flags & RTE_IP_FRAG_TBL_F_SHARED) != 0) {
+		nb_locks = nb_entries / params->bucket_entries;
+		sz += nb_locks * sizeof(rte_spinlock_t);
+	}
+
 	if ((tbl = rte_zmalloc_socket(__func__, sz, RTE_CACHE_LINE_SIZE,
-			socket_id)) == NULL) {
+			params->socket_id)) == NULL) {
 		RTE_LOG(ERR, USER1,
 			"%s: allocation of %zu bytes at socket %d failed do\n",
-			__func__, sz, socket_id);
+			__func__, sz, params->socket_id);
 		return NULL;
 	}
 
 	RTE_LOG(INFO, USER1, "%s: allocated of %zu bytes at socket %d\n",
-		__func__, sz, socket_id);
+		__func__, sz, params->socket_id);
 
-	tbl->max_cycles = max_cycles;
-	tbl->max_entries = max_entries;
+	tbl->max_cycles = params->max_cycles;
+	tbl->max_entries = params->max_entries;
 	tbl->nb_entries = (uint32_t)nb_entries;
-	tbl->nb_buckets = bucket_num;
-	tbl->bucket_entries = bucket_entries;
+	tbl->nb_buckets = params->bucket_num;
+	tbl->bucket_entries = params->bucket_entries;
 	tbl->entry_mask = (tbl->nb_entries - 1) & ~(tbl->bucket_entries  - 1);
+	tbl->max_frags = max_frags;
+	tbl->entry_size = (uint32_t)entry_sz;
+	tbl->flags = params->flags;
 
 	TAILQ_INIT(&(tbl->lru));
+	rte_spinlock_init(&tbl->lru_lock);
+
+	if (nb_locks != 0) {
+		tbl->bucket_lock = (rte_spinlock_t *)((uintptr_t)tbl + lock_ofs);
+		for (i = 0; i != nb_locks; i++)
+			rte_spinlock_init(&tbl->bucket_lock[i]);
+	}
+
 	return tbl;
 }
 
+struct rte_ip_frag_tbl *
+rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
+	uint32_t max_entries, uint64_t max_cycles, int socket_id)
+{
+	struct rte_ip_frag_tbl_params params = {
+		.bucket_num = bucket_num,
+		.bucket_entries = bucket_entries,
+		.max_entries = max_entries,
+		.max_frags = IP_MAX_FRAG_NUM,
+		.max_cycles = max_cycles,
+		.flags = 0,
+		.socket_id = socket_id,
+	};
+
+	return rte_ip_frag_table_create_ext(&params);
+}
+
 /* dump frag table statistics to file */
 void
 rte_ip_frag_table_statistics_dump(FILE *f, const struct rte_ip_frag_tbl *tbl)
@@ -118,7 +169,9 @@ rte_ip_frag_table_statistics_dump(FILE *f, const struct rte_ip_frag_tbl *tbl)
 	fail_total = tbl->stat.fail_total;
 	fail_nospace = tbl->stat.fail_nospace;
 
-	fprintf(f, "max entries:\t%u;\n"
+	fprintf(f, "mode:\t%s;\n"
+		"max fragments per packet:\t%u;\n"
+		"max entries:\t%u;\n"
 		"entries in use:\t%u;\n"
 		"finds/inserts:\t%" PRIu64 ";\n"
 		"entries added:\t%" PRIu64 ";\n"
@@ -126,7 +179,10 @@ rte_ip_frag_table_statistics_dump(FILE *f, const struct rte_ip_frag_tbl *tbl)
 		"entries reused by timeout:\t%" PRIu64 ";\n"
 		"total add failures:\t%" PRIu64 ";\n"
 		"add no-space failures:\t%" PRIu64 ";\n"
-		"add hash-collisions failures:\t%" PRIu64 ";\n",
+		"add hash-collisions failures:\t%" PRIu64 ";\n"
+		"too many fragments failures:\t%" PRIu64 ";\n",
+		(tbl->flags & RTE_IP_FRAG_TBL_F_SHARED) ? "shared" : "private",
+		tbl->max_frags,
 		tbl->max_entries,
 		tbl->use_entries,
 		tbl->stat.find_num,
@@ -135,5 +191,14 @@ rte_ip_frag_table_statistics_dump(FILE *f, const struct rte_ip_frag_tbl *tbl)
 		tbl->stat.reuse_num,
 		fail_total,
 		fail_nospace,
-		fail_total - fail_nospace);
+		fail_total - fail_nospace,
+		tbl->stat.fail_nofrag);
+}
+
+/* delete expired fragments */
+uint32_t
+rte_ip_frag_table_del_expired_entries(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, uint64_t tms)
+{
+	return ip_frag_tbl_del_expired(tbl, dr, tms);
 }
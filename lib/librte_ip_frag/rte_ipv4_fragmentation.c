@@ -36,6 +36,7 @@
 
 #include <rte_memcpy.h>
 #include <rte_mempool.h>
+#include <rte_mbuf.h>
 #include <rte_debug.h>
 
 #include "ip_frag_common.h"
@@ -207,3 +208,51 @@ rte_ipv4_fragment_packet(struct rte_mbuf *pkt_in,
 
 	return out_pkt_pos;
 }
+
+static int
+ipv4_frag_burst_check(const struct rte_mbuf *m)
+{
+	const struct ipv4_hdr *hdr;
+
+	hdr = rte_pktmbuf_mtod(m, const struct ipv4_hdr *);
+	if (unlikely((rte_be_to_cpu_16(hdr->fragment_offset) &
+			IPV4_HDR_DF_MASK) != 0))
+		return -ENOTSUP;
+	return 0;
+}
+
+static void
+ipv4_frag_burst_fill_hdr(struct rte_mbuf *m, const void *in_hdr,
+	uint32_t ofs, uint32_t mf, uint32_t flags)
+{
+	const struct ipv4_hdr *src = in_hdr;
+	struct ipv4_hdr *dst;
+
+	dst = rte_pktmbuf_mtod(m, struct ipv4_hdr *);
+	__fill_ipv4hdr_frag(dst, src, (uint16_t)m->pkt_len,
+		rte_be_to_cpu_16(src->fragment_offset), (uint16_t)ofs, mf);
+
+	m->l3_len = sizeof(struct ipv4_hdr);
+	if (flags & RTE_IP_FRAG_F_SW_CKSUM)
+		dst->hdr_checksum = rte_ipv4_cksum(dst);
+	else
+		m->ol_flags |= PKT_TX_IPV4 | PKT_TX_IP_CKSUM;
+}
+
+static const struct ip_frag_burst_ops ipv4_frag_burst_ops = {
+	.in_hdr_len = sizeof(struct ipv4_hdr),
+	.out_hdr_len = sizeof(struct ipv4_hdr),
+	.check = ipv4_frag_burst_check,
+	.fill_hdr = ipv4_frag_burst_fill_hdr,
+};
+
+uint16_t
+rte_ipv4_fragment_burst(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+	struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out,
+	uint16_t mtu_size, struct rte_mempool *pool_direct,
+	struct rte_mempool *pool_indirect, uint32_t flags)
+{
+	return ip_frag_burst(&ipv4_frag_burst_ops, pkts_in, nb_pkts_in,
+		pkts_out, nb_pkts_out, mtu_size, pool_direct, pool_indirect,
+		flags);
+}
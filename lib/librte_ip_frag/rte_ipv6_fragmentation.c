@@ -35,6 +35,7 @@
 #include <errno.h>
 
 #include <rte_memcpy.h>
+#include <rte_mbuf.h>
 
 #include "ip_frag_common.h"
 
@@ -205,3 +206,44 @@ rte_ipv6_fragment_packet(struct rte_mbuf *pkt_in,
 
 	return out_pkt_pos;
 }
+
+static int
+ipv6_frag_burst_check(__rte_unused const struct rte_mbuf *m)
+{
+	return 0;
+}
+
+static void
+ipv6_frag_burst_fill_hdr(struct rte_mbuf *m, const void *in_hdr,
+	uint32_t ofs, uint32_t mf, __rte_unused uint32_t flags)
+{
+	struct ipv6_hdr *dst;
+
+	dst = rte_pktmbuf_mtod(m, struct ipv6_hdr *);
+	__fill_ipv6hdr_frag(dst, in_hdr,
+		(uint16_t)(m->pkt_len - sizeof(struct ipv6_hdr)),
+		(uint16_t)ofs, mf);
+
+	m->l3_len = sizeof(struct ipv6_hdr) +
+		sizeof(struct ipv6_extension_fragment);
+	m->ol_flags |= PKT_TX_IPV6;
+}
+
+static const struct ip_frag_burst_ops ipv6_frag_burst_ops = {
+	.in_hdr_len = sizeof(struct ipv6_hdr),
+	.out_hdr_len = sizeof(struct ipv6_hdr) +
+		sizeof(struct ipv6_extension_fragment),
+	.check = ipv6_frag_burst_check,
+	.fill_hdr = ipv6_frag_burst_fill_hdr,
+};
+
+uint16_t
+rte_ipv6_fragment_burst(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+	struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out,
+	uint16_t mtu_size, struct rte_mempool *pool_direct,
+	struct rte_mempool *pool_indirect, uint32_t flags)
+{
+	return ip_frag_burst(&ipv6_frag_burst_ops, pkts_in, nb_pkts_in,
+		pkts_out, nb_pkts_out, mtu_size, pool_direct, pool_indirect,
+		flags);
+}
@@ -167,6 +167,7 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 {
 	struct ip_frag_pkt *fp;
 	struct ip_frag_key key;
+	struct ip_frag_bkt_lock lk;
 	uint16_t ip_len, ip_ofs;
 
 	rte_memcpy(&key.src_dst[0], ip_hdr->src_addr, 16);
@@ -196,7 +197,7 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		tbl->use_entries);
 
 	/* try to find/add entry into the fragment's table. */
-	fp = ip_frag_find(tbl, dr, &key, tms);
+	fp = ip_frag_find(tbl, dr, &key, tms, &lk);
 	if (fp == NULL) {
 		IP_FRAG_MBUF2DR(dr, mb);
 		return NULL;
@@ -213,7 +214,7 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 
 	/* process the fragmented packet. */
-	mb = ip_frag_process(fp, dr, mb, ip_ofs, ip_len,
+	mb = ip_frag_process(tbl, fp, dr, mb, ip_ofs, ip_len,
 			MORE_FRAGS(frag_hdr->frag_data));
 	ip_frag_inuse(tbl, fp);
 
@@ -227,5 +228,6 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		fp, IPv6_KEY_BYTES(fp->key.src_dst), fp->key.id, fp->start,
 		fp->total_size, fp->frag_size, fp->last_idx);
 
+	ip_frag_unlock(tbl, &lk);
 	return mb;
 }
@@ -0,0 +1,125 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_memzone.h>
+#include <rte_cycles.h>
+
+#include "rte_jobstats_lcore.h"
+
+/* counters written by the lcores of this process, primary only */
+struct rte_jobstats_lcore *rte_jobstats_lcores;
+
+/* counters of the primary process, for the readers of any process */
+static const struct rte_jobstats_lcore *lcore_stats;
+
+int
+rte_jobstats_lcore_init(void)
+{
+	const struct rte_memzone *mz;
+	size_t len = sizeof(struct rte_jobstats_lcore) * RTE_MAX_LCORE;
+
+	if (lcore_stats != NULL)
+		return 0;
+
+	if (rte_eal_process_type() == RTE_PROC_PRIMARY) {
+		mz = rte_memzone_reserve(RTE_JOBSTATS_LCORE_MZ_NAME, len,
+				SOCKET_ID_ANY, 0);
+		if (mz == NULL)
+			return -ENOMEM;
+		memset(mz->addr, 0, len);
+		rte_jobstats_lcores = mz->addr;
+	} else {
+		mz = rte_memzone_lookup(RTE_JOBSTATS_LCORE_MZ_NAME);
+		if (mz == NULL)
+			return -ENOENT;
+	}
+	lcore_stats = mz->addr;
+
+	return 0;
+}
+
+int
+rte_jobstats_lcore_read(unsigned lcore_id, struct rte_jobstats_lcore *stats)
+{
+	const struct rte_jobstats_lcore *s;
+	uint32_t seq;
+	uint64_t now;
+
+	if (lcore_id >= RTE_MAX_LCORE || stats == NULL)
+		return -EINVAL;
+	if (lcore_stats == NULL)
+		return -ENOENT;
+
+	s = &lcore_stats[lcore_id];
+	do {
+		while ((seq = s->seq) & 1)
+			rte_pause();
+		rte_smp_rmb();
+		memcpy(stats, (const void *)s, sizeof(*stats));
+		now = rte_rdtsc();
+		rte_smp_rmb();
+	} while (seq != s->seq);
+
+	/* account the period in progress */
+	if (stats->state_time != 0 && now > stats->state_time) {
+		if (stats->busy)
+			stats->busy_cycles += now - stats->state_time;
+		else
+			stats->idle_cycles += now - stats->state_time;
+		stats->state_time = now;
+	}
+
+	return 0;
+}
+
+unsigned
+rte_jobstats_lcore_busy_percent(const struct rte_jobstats_lcore *prev,
+		const struct rte_jobstats_lcore *cur)
+{
+	uint64_t busy, total;
+
+	busy = cur->busy_cycles;
+	total = cur->busy_cycles + cur->idle_cycles;
+	if (prev != NULL) {
+		busy -= prev->busy_cycles;
+		total -= prev->busy_cycles + prev->idle_cycles;
+	}
+	if (total == 0)
+		return 0;
+
+	return (unsigned)(busy * 100 / total);
+}
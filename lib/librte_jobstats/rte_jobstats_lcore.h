@@ -0,0 +1,227 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_JOBSTATS_LCORE_H_
+#define _RTE_JOBSTATS_LCORE_H_
+
+/**
+ * @file
+ * RTE lcore cycle accounting
+ *
+ * Classifies the time of each polling lcore as busy or idle, and counts the
+ * amount of work returned by each poll. An lcore becomes busy when a poll
+ * returns work and idle again at the first poll which returns nothing, so
+ * the TSC is only read when the state changes.
+ *
+ * The counters of every lcore live in a memzone created by the primary
+ * process. Each lcore only writes its own entry, under a sequence counter,
+ * so that other processes can read consistent snapshots without locks.
+ *
+ * With CONFIG_RTE_JOBSTATS_LCORE_BUSY enabled, rte_eth_rx_burst(),
+ * rte_eth_tx_burst() and rte_cryptodev_dequeue_burst() account their
+ * bursts automatically; other poll loops may call rte_jobstats_lcore_poll()
+ * themselves.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Name of the memzone holding the per lcore counters. */
+#define RTE_JOBSTATS_LCORE_MZ_NAME "rte_jobstats_lcore"
+
+/**
+ * Number of buckets of the work per poll histogram. Bucket 0 counts empty
+ * polls, bucket i polls which returned [2^(i-1), 2^i) items and the last
+ * bucket everything above.
+ */
+#define RTE_JOBSTATS_LCORE_HIST_SIZE 10
+
+/** Cycle accounting counters of one lcore. */
+struct rte_jobstats_lcore {
+	volatile uint32_t seq;
+	/**< Incremented before and after each update, odd while updating. */
+	uint32_t busy;         /**< 1 while the lcore is in a busy period. */
+	uint64_t state_time;   /**< TSC at the start of the current period. */
+	uint64_t busy_cycles;  /**< Cycles of the finished busy periods. */
+	uint64_t idle_cycles;  /**< Cycles of the finished idle periods. */
+	uint64_t polls;        /**< Number of polls. */
+	uint64_t work;         /**< Items returned by all polls. */
+	uint64_t hist[RTE_JOBSTATS_LCORE_HIST_SIZE];
+	/**< Histogram of the items returned per poll. */
+} __rte_cache_aligned;
+
+/**
+ * @internal Counters of the lcores of this process, NULL until
+ * rte_jobstats_lcore_init() is called in the primary process.
+ */
+extern struct rte_jobstats_lcore *rte_jobstats_lcores;
+
+/**
+ * @internal Moves the lcore to the busy or idle state.
+ */
+static inline void
+__rte_jobstats_lcore_switch(struct rte_jobstats_lcore *s, uint32_t busy)
+{
+	uint64_t now = rte_rdtsc();
+
+	if (unlikely(s->state_time == 0))
+		s->state_time = now;
+	else if (s->busy)
+		s->busy_cycles += now - s->state_time;
+	else
+		s->idle_cycles += now - s->state_time;
+	s->state_time = now;
+	s->busy = busy;
+}
+
+/**
+ * Accounts one poll of the calling lcore.
+ *
+ * @param nb_work
+ *  Number of items (packets, operations...) returned by the poll. The lcore
+ *  is busy from the first poll returning work until the next empty poll.
+ */
+static inline void
+rte_jobstats_lcore_poll(uint32_t nb_work)
+{
+	struct rte_jobstats_lcore *s;
+	unsigned lcore_id = rte_lcore_id();
+	unsigned b;
+
+	if (rte_jobstats_lcores == NULL || lcore_id >= RTE_MAX_LCORE)
+		return;
+
+	s = &rte_jobstats_lcores[lcore_id];
+	s->seq++;
+	rte_smp_wmb();
+
+	if ((nb_work != 0) != s->busy)
+		__rte_jobstats_lcore_switch(s, nb_work != 0);
+	b = (nb_work == 0) ? 0 : 32 - __builtin_clz(nb_work);
+	s->hist[RTE_MIN(b, RTE_JOBSTATS_LCORE_HIST_SIZE - 1u)]++;
+	s->polls++;
+	s->work += nb_work;
+
+	rte_smp_wmb();
+	s->seq++;
+}
+
+/**
+ * Accounts work of the calling lcore which is not a poll, e.g. packets
+ * sent. It can only move the lcore to the busy state.
+ *
+ * @param nb_work
+ *  Number of items processed.
+ */
+static inline void
+rte_jobstats_lcore_work(uint32_t nb_work)
+{
+	struct rte_jobstats_lcore *s;
+	unsigned lcore_id = rte_lcore_id();
+
+	if (rte_jobstats_lcores == NULL || lcore_id >= RTE_MAX_LCORE ||
+			nb_work == 0)
+		return;
+
+	s = &rte_jobstats_lcores[lcore_id];
+	if (s->busy)
+		return;
+
+	s->seq++;
+	rte_smp_wmb();
+	__rte_jobstats_lcore_switch(s, 1);
+	rte_smp_wmb();
+	s->seq++;
+}
+
+/**
+ * Enables the cycle accounting.
+ *
+ * The primary process creates the shared counters and starts accounting
+ * the polls of its lcores. Secondary processes only attach to the counters
+ * to read them with rte_jobstats_lcore_read().
+ *
+ * @return
+ *  0 on success, -ENOENT if the primary process did not enable the
+ *  accounting, -ENOMEM if the counters cannot be allocated.
+ */
+int
+rte_jobstats_lcore_init(void);
+
+/**
+ * Reads a consistent snapshot of the counters of an lcore of the primary
+ * process. The busy or idle period in progress is included in the cycle
+ * counts. This function takes no lock and can be called from any process.
+ *
+ * @param lcore_id
+ *  Lcore to read.
+ * @param stats
+ *  Where to store the snapshot.
+ *
+ * @return
+ *  0 on success, -EINVAL on invalid arguments, -ENOENT if the accounting is
+ *  not enabled.
+ */
+int
+rte_jobstats_lcore_read(unsigned lcore_id, struct rte_jobstats_lcore *stats);
+
+/**
+ * Busy percentage between two snapshots of the same lcore.
+ *
+ * @param prev
+ *  Older snapshot, or NULL for the percentage since the lcore was first
+ *  accounted.
+ * @param cur
+ *  Newer snapshot.
+ *
+ * @return
+ *  Busy percentage, 0 to 100.
+ */
+unsigned
+rte_jobstats_lcore_busy_percent(const struct rte_jobstats_lcore *prev,
+		const struct rte_jobstats_lcore *cur);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_JOBSTATS_LCORE_H_ */
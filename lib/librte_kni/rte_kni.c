@@ -50,8 +50,6 @@
 #include <exec-env/rte_kni_common.h>
 #include "rte_kni_fifo.h"
 
-#define MAX_MBUF_BURST_NUM            32
-
 /* Maximum number of ring entries */
 #define KNI_FIFO_COUNT_MAX     1024
 #define KNI_FIFO_SIZE          (KNI_FIFO_COUNT_MAX * sizeof(void *) + \
@@ -75,6 +73,7 @@ struct rte_kni {
 	struct rte_kni_fifo *rx_q;          /**< RX queue */
 	struct rte_kni_fifo *alloc_q;       /**< Allocated mbufs queue */
 	struct rte_kni_fifo *free_q;        /**< To be freed mbufs queue */
+	struct rte_kni_fifo *recycle_q;     /**< Freed mbufs for alloc_q */
 
 	/* For request & response */
 	struct rte_kni_fifo *req_q;         /**< Request queue */
@@ -83,6 +82,10 @@ struct rte_kni {
 
 	struct rte_kni_ops ops;             /**< operations for request */
 	uint8_t in_use : 1;                 /**< kni in use */
+
+	uint16_t alloc_burst;               /**< alloc_q refill burst */
+	uint16_t free_burst;                /**< free_q drain burst */
+	struct rte_kni_fifo_stats stats;    /**< FIFO statistics */
 };
 
 enum kni_ops_status {
@@ -103,6 +106,7 @@ struct rte_kni_memzone_slot {
 	const struct rte_memzone *m_rx_q;      /**< RX queue */
 	const struct rte_memzone *m_alloc_q;   /**< Allocated mbufs queue */
 	const struct rte_memzone *m_free_q;    /**< To be freed mbufs queue */
+	const struct rte_memzone *m_recycle_q; /**< Freed mbufs for alloc_q */
 	const struct rte_memzone *m_req_q;     /**< Request queue */
 	const struct rte_memzone *m_resp_q;    /**< Response queue */
 	const struct rte_memzone *m_sync_addr;
@@ -276,6 +280,13 @@ rte_kni_init(unsigned int max_kni_ifaces)
 		KNI_MEM_CHECK(mz == NULL);
 		it->m_free_q = mz;
 
+		/* RECYCLE RING */
+		snprintf(obj_name, OBJNAMSIZ, "kni_recycle_%d", i);
+		mz = kni_memzone_reserve(obj_name, KNI_FIFO_SIZE,
+							SOCKET_ID_ANY, 0);
+		KNI_MEM_CHECK(mz == NULL);
+		it->m_recycle_q = mz;
+
 		/* Request RING */
 		snprintf(obj_name, OBJNAMSIZ, "kni_req_%d", i);
 		mz = kni_memzone_reserve(obj_name, KNI_FIFO_SIZE,
@@ -329,6 +340,13 @@ rte_kni_alloc(struct rte_mempool *pktmbuf_pool,
 	if (!pktmbuf_pool || !conf || !conf->name[0])
 		return NULL;
 
+	if (conf->alloc_burst > RTE_KNI_BURST_MAX ||
+	    conf->free_burst > RTE_KNI_BURST_MAX) {
+		RTE_LOG(ERR, KNI, "KNI burst size can't exceed %u\n",
+			RTE_KNI_BURST_MAX);
+		return NULL;
+	}
+
 	/* Check if KNI subsystem has been initialized */
 	if (kni_memzone_pool.initialized != 1) {
 		RTE_LOG(ERR, KNI, "KNI subsystem has not been initialized. Invoke rte_kni_init() first\n");
@@ -396,6 +414,10 @@ rte_kni_alloc(struct rte_mempool *pktmbuf_pool,
 	kni_fifo_init(ctx->free_q, KNI_FIFO_COUNT_MAX);
 	dev_info.free_phys = mz->phys_addr;
 
+	/* RECYCLE RING, not shared with the kernel */
+	ctx->recycle_q = slot->m_recycle_q->addr;
+	kni_fifo_init(ctx->recycle_q, KNI_FIFO_COUNT_MAX);
+
 	/* Request RING */
 	mz = slot->m_req_q;
 	ctx->req_q = mz->addr;
@@ -431,6 +453,10 @@ rte_kni_alloc(struct rte_mempool *pktmbuf_pool,
 	ctx->group_id = conf->group_id;
 	ctx->slot_id = slot->id;
 	ctx->mbuf_size = conf->mbuf_size;
+	ctx->alloc_burst = conf->alloc_burst ? conf->alloc_burst :
+					       RTE_KNI_BURST_DEFAULT;
+	ctx->free_burst = conf->free_burst ? conf->free_burst :
+					     RTE_KNI_BURST_DEFAULT;
 
 	ret = ioctl(kni_fd, RTE_KNI_IOCTL_CREATE, &dev_info);
 	KNI_MEM_CHECK(ret < 0);
@@ -439,6 +465,8 @@ rte_kni_alloc(struct rte_mempool *pktmbuf_pool,
 
 	/* Allocate mbufs and then put them into alloc_q */
 	kni_allocate_mbufs(ctx);
+	/* alloc_q being empty is expected on the first refill */
+	ctx->stats.alloc_q_empty = 0;
 
 	return ctx;
 
@@ -482,6 +510,7 @@ rte_kni_release(struct rte_kni *kni)
 	kni_free_fifo(kni->rx_q);
 	kni_free_fifo(kni->alloc_q);
 	kni_free_fifo(kni->free_q);
+	kni_free_fifo(kni->recycle_q);
 
 	slot_id = kni->slot_id;
 
@@ -549,7 +578,10 @@ rte_kni_tx_burst(struct rte_kni *kni, struct rte_mbuf **mbufs, unsigned num)
 {
 	unsigned ret = kni_fifo_put(kni->rx_q, (void **)mbufs, num);
 
-	/* Get mbufs from free_q and then free them */
+	if (unlikely(ret < num))
+		kni->stats.rx_q_full += num - ret;
+
+	/* Get mbufs from free_q and then recycle or free them */
 	kni_free_mbufs(kni);
 
 	return ret;
@@ -567,24 +599,58 @@ rte_kni_rx_burst(struct rte_kni *kni, struct rte_mbuf **mbufs, unsigned num)
 	return ret;
 }
 
+/*
+ * Drain free_q. The mbufs the kernel is done with that could as well
+ * have been allocated for alloc_q are kept in recycle_q, for the next
+ * refill of alloc_q to take them instead of going through the mempool;
+ * the others are freed. alloc_q itself is left to kni_allocate_mbufs(),
+ * which runs on the lcore calling rte_kni_rx_burst().
+ */
 static void
 kni_free_mbufs(struct rte_kni *kni)
 {
-	int i, ret;
-	struct rte_mbuf *pkts[MAX_MBUF_BURST_NUM];
+	struct rte_mbuf *pkts[RTE_KNI_BURST_MAX];
+	struct rte_mbuf *m;
+	unsigned i, ret, nb_recycle = 0, nb_put;
 
-	ret = kni_fifo_get(kni->free_q, (void **)pkts, MAX_MBUF_BURST_NUM);
-	if (likely(ret > 0)) {
-		for (i = 0; i < ret; i++)
-			rte_pktmbuf_free(pkts[i]);
+	if (unlikely(kni_fifo_free_count(kni->free_q) == 0))
+		kni->stats.free_q_full++;
+
+	ret = kni_fifo_get(kni->free_q, (void **)pkts, kni->free_burst);
+	if (ret == 0)
+		return;
+
+	for (i = 0; i < ret; i++) {
+		m = pkts[i];
+		if (likely(m->pool == kni->pktmbuf_pool && m->next == NULL &&
+			   RTE_MBUF_DIRECT(m) &&
+			   rte_mbuf_refcnt_read(m) == 1)) {
+			rte_pktmbuf_reset(m);
+			pkts[nb_recycle++] = m;
+		} else {
+			rte_pktmbuf_free(m);
+		}
+	}
+
+	if (nb_recycle == 0)
+		return;
+
+	nb_put = kni_fifo_put(kni->recycle_q, (void **)pkts, nb_recycle);
+
+	/* No room left in recycle_q, give the others back to the mempool */
+	if (nb_put < nb_recycle) {
+		for (i = nb_put; i < nb_recycle; i++)
+			rte_mbuf_refcnt_set(pkts[i], 0);
+		rte_mempool_put_bulk(kni->pktmbuf_pool, (void **)&pkts[nb_put],
+				     nb_recycle - nb_put);
 	}
 }
 
 static void
 kni_allocate_mbufs(struct rte_kni *kni)
 {
-	int i, ret;
-	struct rte_mbuf *pkts[MAX_MBUF_BURST_NUM];
+	struct rte_mbuf *pkts[RTE_KNI_BURST_MAX];
+	unsigned num, ret, nb_recycled, nb_alloc;
 
 	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, pool) !=
 			 offsetof(struct rte_kni_mbuf, pool));
@@ -607,30 +673,71 @@ kni_allocate_mbufs(struct rte_kni *kni)
 		return;
 	}
 
-	for (i = 0; i < MAX_MBUF_BURST_NUM; i++) {
-		pkts[i] = rte_pktmbuf_alloc(kni->pktmbuf_pool);
-		if (unlikely(pkts[i] == NULL)) {
-			/* Out of memory */
-			RTE_LOG(ERR, KNI, "Out of memory\n");
-			break;
-		}
-	}
-
-	/* No pkt mbuf alocated */
-	if (i <= 0)
+	/*
+	 * Only this function puts into alloc_q, always from the same lcore,
+	 * so what is free now can be filled in without having to free mbufs
+	 * that don't fit.
+	 */
+	num = kni_fifo_free_count(kni->alloc_q);
+	if (unlikely(num == 0)) {
+		kni->stats.alloc_q_full++;
 		return;
+	}
+	if (unlikely(kni_fifo_count(kni->alloc_q) == 0))
+		kni->stats.alloc_q_empty++;
+
+	num = RTE_MIN(num, (unsigned)kni->alloc_burst);
+
+	/* Mbufs returned by the kernel first */
+	nb_recycled = kni_fifo_get(kni->recycle_q, (void **)pkts, num);
+	kni->stats.recycled += nb_recycled;
+
+	/* The bulk get is all or nothing, retry smaller ones on failure */
+	nb_alloc = num - nb_recycled;
+	while (nb_alloc != 0 && rte_pktmbuf_alloc_bulk(kni->pktmbuf_pool,
+					&pkts[nb_recycled], nb_alloc) != 0)
+		nb_alloc /= 2;
+
+	if (unlikely(nb_alloc == 0 && nb_recycled < num)) {
+		/* Out of memory */
+		kni->stats.alloc_fail++;
+		RTE_LOG(ERR, KNI, "Out of memory\n");
+		if (nb_recycled == 0)
+			return;
+	}
+	num = nb_recycled + nb_alloc;
 
-	ret = kni_fifo_put(kni->alloc_q, (void **)pkts, i);
+	ret = kni_fifo_put(kni->alloc_q, (void **)pkts, num);
 
 	/* Check if any mbufs not put into alloc_q, and then free them */
-	if (ret >= 0 && ret < i && ret < MAX_MBUF_BURST_NUM) {
-		int j;
+	if (unlikely(ret < num)) {
+		unsigned i;
 
-		for (j = ret; j < i; j++)
-			rte_pktmbuf_free(pkts[j]);
+		for (i = ret; i < num; i++)
+			rte_pktmbuf_free(pkts[i]);
 	}
 }
 
+int
+rte_kni_fifo_stats_get(const struct rte_kni *kni,
+		       struct rte_kni_fifo_stats *stats)
+{
+	if (kni == NULL || stats == NULL)
+		return -1;
+
+	*stats = kni->stats;
+	return 0;
+}
+
+void
+rte_kni_fifo_stats_reset(struct rte_kni *kni)
+{
+	if (kni == NULL)
+		return;
+
+	memset(&kni->stats, 0, sizeof(kni->stats));
+}
+
 struct rte_kni *
 rte_kni_get(const char *name)
 {
@@ -89,6 +89,32 @@ struct rte_kni_conf {
 	struct rte_pci_id id;
 
 	uint8_t force_bind : 1; /* Flag to bind kernel thread */
+
+	/*
+	 * Max number of mbufs allocated to refill the alloc queue, and
+	 * taken from the free queue, at once. 0 selects the default of
+	 * RTE_KNI_BURST_DEFAULT, the max is RTE_KNI_BURST_MAX.
+	 */
+	uint16_t alloc_burst;
+	uint16_t free_burst;
+};
+
+/** Default mbuf alloc and free burst sizes of a KNI device. */
+#define RTE_KNI_BURST_DEFAULT 32
+/** Max mbuf alloc and free burst sizes of a KNI device. */
+#define RTE_KNI_BURST_MAX 512
+
+/**
+ * KNI FIFO statistics, counting the events of the mbuf exchanges with the
+ * kernel that point at a FIFO too small or not serviced often enough.
+ */
+struct rte_kni_fifo_stats {
+	uint64_t rx_q_full;     /**< Packets not sent, RX queue full. */
+	uint64_t alloc_q_empty; /**< Alloc queue found empty on refill. */
+	uint64_t alloc_q_full;  /**< Alloc queue found full on refill. */
+	uint64_t free_q_full;   /**< Free queue found full on drain. */
+	uint64_t alloc_fail;    /**< Refills failed, mempool exhausted. */
+	uint64_t recycled;      /**< Freed mbufs reused for alloc queue. */
 };
 
 /**
@@ -198,6 +224,29 @@ unsigned rte_kni_rx_burst(struct rte_kni *kni, struct rte_mbuf **mbufs,
 unsigned rte_kni_tx_burst(struct rte_kni *kni, struct rte_mbuf **mbufs,
 		unsigned num);
 
+/**
+ * Retrieve the FIFO statistics of a KNI interface.
+ *
+ * @param kni
+ *  The KNI interface context.
+ * @param stats
+ *  The structure to fill in.
+ *
+ * @return
+ *  On success: 0
+ *  On failure: -1
+ */
+int rte_kni_fifo_stats_get(const struct rte_kni *kni,
+		struct rte_kni_fifo_stats *stats);
+
+/**
+ * Reset the FIFO statistics of a KNI interface.
+ *
+ * @param kni
+ *  The KNI interface context.
+ */
+void rte_kni_fifo_stats_reset(struct rte_kni *kni);
+
 /**
  * Get the KNI context of its name.
  *
@@ -0,0 +1,338 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_errno.h>
+#include <rte_memzone.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_mbuf.h>
+#include <rte_ethdev.h>
+
+#include "rte_latencystats.h"
+
+/* fixed point shift of the cycles to ns multiplier */
+#define LATENCY_NS_SHIFT 20
+
+/* statistics of a TX queue, in ns */
+struct latency_queue_stats {
+	volatile uint32_t seq; /* odd while updating */
+	uint32_t reserved;
+	uint64_t samples;
+	uint64_t min;
+	uint64_t max;
+	uint64_t total;
+	uint64_t jitter;       /* scaled by 16, as in RFC 3550 */
+	uint64_t last;
+	uint64_t hist[RTE_LATENCYSTATS_HIST_SIZE];
+} __rte_cache_aligned;
+
+/* layout of the memzone */
+struct latency_shared {
+	struct latency_queue_stats
+		q[RTE_MAX_ETHPORTS][RTE_LATENCYSTATS_MAX_QUEUES];
+};
+
+/* sampling state of an RX queue */
+struct latency_rx_queue {
+	uint64_t next_sample;
+} __rte_cache_aligned;
+
+/* statistics of the primary process, for the readers of any process */
+static struct latency_shared *latency_shared;
+
+/* callbacks of the primary process */
+static struct latency_rx_queue
+	rx_queues[RTE_MAX_ETHPORTS][RTE_LATENCYSTATS_MAX_QUEUES];
+static struct rte_eth_rxtx_callback *
+	rx_cbs[RTE_MAX_ETHPORTS][RTE_LATENCYSTATS_MAX_QUEUES];
+static struct rte_eth_rxtx_callback *
+	tx_cbs[RTE_MAX_ETHPORTS][RTE_LATENCYSTATS_MAX_QUEUES];
+static int latency_enabled;
+static uint64_t samp_cycles;
+static uint64_t ns_mult;
+
+static uint16_t
+latency_rx_cb(uint8_t port __rte_unused, uint16_t queue __rte_unused,
+		struct rte_mbuf **pkts, uint16_t nb_pkts,
+		uint16_t max_pkts __rte_unused, void *arg)
+{
+	struct latency_rx_queue *rxq = arg;
+	uint64_t now;
+	uint16_t i;
+
+	if (nb_pkts == 0)
+		return 0;
+
+	now = rte_rdtsc();
+	if (now < rxq->next_sample)
+		return nb_pkts;
+	rxq->next_sample = now + samp_cycles;
+
+	for (i = 0; i < nb_pkts; i++) {
+		pkts[i]->timestamp = now;
+		pkts[i]->ol_flags |= PKT_RX_TIMESTAMP;
+	}
+
+	return nb_pkts;
+}
+
+static inline void
+latency_update(struct latency_queue_stats *s, uint64_t lat)
+{
+	uint64_t d;
+	unsigned b;
+
+	if (s->samples == 0 || lat < s->min)
+		s->min = lat;
+	if (lat > s->max)
+		s->max = lat;
+	if (s->samples != 0) {
+		d = (lat > s->last) ? lat - s->last : s->last - lat;
+		s->jitter += d - ((s->jitter + 8) >> 4);
+	}
+	s->last = lat;
+	s->total += lat;
+	s->samples++;
+
+	b = 63 - __builtin_clzll(lat | 1);
+	s->hist[RTE_MIN(b, RTE_LATENCYSTATS_HIST_SIZE - 1u)]++;
+}
+
+static uint16_t
+latency_tx_cb(uint8_t port __rte_unused, uint16_t queue __rte_unused,
+		struct rte_mbuf **pkts, uint16_t nb_pkts, void *arg)
+{
+	struct latency_queue_stats *s = arg;
+	uint64_t now = 0, cycles;
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++) {
+		if ((pkts[i]->ol_flags & PKT_RX_TIMESTAMP) == 0)
+			continue;
+
+		if (now == 0) {
+			now = rte_rdtsc();
+			s->seq++;
+			rte_smp_wmb();
+		}
+		/* the TSC of the RX lcore may be slightly ahead */
+		cycles = (now > pkts[i]->timestamp) ?
+			now - pkts[i]->timestamp : 0;
+		latency_update(s, (cycles * ns_mult) >> LATENCY_NS_SHIFT);
+		/* packets not accepted by the driver are sent again later */
+		pkts[i]->ol_flags &= ~PKT_RX_TIMESTAMP;
+	}
+
+	if (now != 0) {
+		rte_smp_wmb();
+		s->seq++;
+	}
+
+	return nb_pkts;
+}
+
+static void
+latency_remove_callbacks(void)
+{
+	uint8_t pid;
+	uint16_t qid;
+
+	for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++) {
+		for (qid = 0; qid < RTE_LATENCYSTATS_MAX_QUEUES; qid++) {
+			if (rx_cbs[pid][qid] != NULL)
+				rte_eth_remove_rx_callback(pid, qid,
+						rx_cbs[pid][qid]);
+			if (tx_cbs[pid][qid] != NULL)
+				rte_eth_remove_tx_callback(pid, qid,
+						tx_cbs[pid][qid]);
+			rx_cbs[pid][qid] = NULL;
+			tx_cbs[pid][qid] = NULL;
+		}
+	}
+}
+
+static int
+latency_add_callbacks(void)
+{
+	struct rte_eth_dev_info dev_info;
+	uint16_t nb_rxq, nb_txq, qid;
+	uint8_t pid;
+
+	for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++) {
+		if (!rte_eth_dev_is_valid_port(pid))
+			continue;
+
+		rte_eth_dev_info_get(pid, &dev_info);
+		nb_rxq = RTE_MIN(dev_info.nb_rx_queues,
+				RTE_LATENCYSTATS_MAX_QUEUES);
+		nb_txq = RTE_MIN(dev_info.nb_tx_queues,
+				RTE_LATENCYSTATS_MAX_QUEUES);
+
+		for (qid = 0; qid < nb_rxq; qid++) {
+			rx_queues[pid][qid].next_sample = 0;
+			rx_cbs[pid][qid] = rte_eth_add_rx_callback(pid, qid,
+					latency_rx_cb, &rx_queues[pid][qid]);
+			if (rx_cbs[pid][qid] == NULL)
+				return -rte_errno;
+		}
+		for (qid = 0; qid < nb_txq; qid++) {
+			tx_cbs[pid][qid] = rte_eth_add_tx_callback(pid, qid,
+					latency_tx_cb,
+					&latency_shared->q[pid][qid]);
+			if (tx_cbs[pid][qid] == NULL)
+				return -rte_errno;
+		}
+	}
+
+	return 0;
+}
+
+int
+rte_latencystats_init(uint64_t samp_intvl)
+{
+	const struct rte_memzone *mz;
+	int ret;
+
+	if (latency_enabled)
+		return -EEXIST;
+
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY) {
+		mz = rte_memzone_lookup(RTE_LATENCYSTATS_MZ_NAME);
+		if (mz == NULL)
+			return -ENOENT;
+		latency_shared = mz->addr;
+		return 0;
+	}
+
+	mz = rte_memzone_lookup(RTE_LATENCYSTATS_MZ_NAME);
+	if (mz == NULL)
+		mz = rte_memzone_reserve(RTE_LATENCYSTATS_MZ_NAME,
+				sizeof(struct latency_shared), SOCKET_ID_ANY, 0);
+	if (mz == NULL)
+		return -ENOMEM;
+	memset(mz->addr, 0, sizeof(struct latency_shared));
+	latency_shared = mz->addr;
+
+	ns_mult = ((uint64_t)NS_PER_S << LATENCY_NS_SHIFT) / rte_get_tsc_hz();
+	samp_cycles = samp_intvl / NS_PER_S * rte_get_tsc_hz() +
+		samp_intvl % NS_PER_S * rte_get_tsc_hz() / NS_PER_S;
+
+	ret = latency_add_callbacks();
+	if (ret < 0) {
+		latency_remove_callbacks();
+		return ret;
+	}
+	latency_enabled = 1;
+
+	return 0;
+}
+
+int
+rte_latencystats_uninit(void)
+{
+	if (!latency_enabled)
+		return -ENOENT;
+
+	latency_remove_callbacks();
+	latency_enabled = 0;
+
+	return 0;
+}
+
+static void
+latency_read(const struct latency_queue_stats *s,
+		struct latency_queue_stats *snap)
+{
+	uint32_t seq;
+
+	do {
+		while ((seq = s->seq) & 1)
+			rte_pause();
+		rte_smp_rmb();
+		memcpy(snap, (const void *)s, sizeof(*snap));
+		rte_smp_rmb();
+	} while (seq != s->seq);
+}
+
+int
+rte_latencystats_get(uint8_t port_id, uint16_t queue_id,
+		struct rte_latencystats *stats)
+{
+	struct latency_queue_stats snap;
+	uint64_t total = 0, jitter = 0;
+	uint16_t qid, first, last;
+	unsigned i;
+
+	if (port_id >= RTE_MAX_ETHPORTS || stats == NULL ||
+			(queue_id >= RTE_LATENCYSTATS_MAX_QUEUES &&
+			 queue_id != RTE_LATENCYSTATS_ALL_QUEUES))
+		return -EINVAL;
+	if (latency_shared == NULL)
+		return -ENOENT;
+
+	if (queue_id == RTE_LATENCYSTATS_ALL_QUEUES) {
+		first = 0;
+		last = RTE_LATENCYSTATS_MAX_QUEUES - 1;
+	} else {
+		first = queue_id;
+		last = queue_id;
+	}
+
+	memset(stats, 0, sizeof(*stats));
+	for (qid = first; qid <= last; qid++) {
+		latency_read(&latency_shared->q[port_id][qid], &snap);
+		if (snap.samples == 0)
+			continue;
+
+		if (stats->samples == 0 || snap.min < stats->min)
+			stats->min = snap.min;
+		if (snap.max > stats->max)
+			stats->max = snap.max;
+		stats->samples += snap.samples;
+		total += snap.total;
+		jitter += (snap.jitter >> 4) * snap.samples;
+		for (i = 0; i < RTE_LATENCYSTATS_HIST_SIZE; i++)
+			stats->hist[i] += snap.hist[i];
+	}
+
+	if (stats->samples != 0) {
+		stats->avg = total / stats->samples;
+		stats->jitter = jitter / stats->samples;
+	}
+
+	return 0;
+}
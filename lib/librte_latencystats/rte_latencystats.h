@@ -0,0 +1,156 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_LATENCYSTATS_H_
+#define _RTE_LATENCYSTATS_H_
+
+/**
+ * @file
+ * RTE latency statistics
+ *
+ * Measures the time spent by packets in the application, from their
+ * reception by rte_eth_rx_burst() to their transmission by
+ * rte_eth_tx_burst().
+ *
+ * An RX callback stores the TSC in the timestamp field of the mbufs and sets
+ * PKT_RX_TIMESTAMP, for one burst per sampling interval. A TX callback
+ * computes the latency of the timestamped packets and updates the
+ * statistics of the TX queue: minimum, average, maximum, interarrival jitter
+ * as defined by RFC 3550 and a log2 histogram. Packets are measured before
+ * being handed to the driver, so the time spent in the TX queue is not
+ * included. Since the driver may not accept all of them, the TX callback
+ * clears PKT_RX_TIMESTAMP so that the packets given again to
+ * rte_eth_tx_burst() are not measured twice: the latency of a packet is
+ * the time to its first transmission attempt.
+ *
+ * The statistics live in a memzone created by the primary process. Each TX
+ * queue is only updated by the lcore transmitting on it, under a sequence
+ * counter, so that other processes can read consistent snapshots without
+ * locks.
+ *
+ * The timestamp field must not be filled by the driver while the statistics
+ * are enabled, since its unit would not be TSC cycles.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Name of the memzone holding the statistics. */
+#define RTE_LATENCYSTATS_MZ_NAME "rte_latencystats"
+
+/** Number of queues per port measured, the queues above are ignored. */
+#define RTE_LATENCYSTATS_MAX_QUEUES 16
+
+/** Queue ID to read the statistics of all queues of a port. */
+#define RTE_LATENCYSTATS_ALL_QUEUES UINT16_MAX
+
+/**
+ * Number of buckets of the latency histogram. Bucket 0 counts latencies
+ * below 2 ns, bucket i latencies in [2^i, 2^(i+1)) ns and the last bucket
+ * everything above.
+ */
+#define RTE_LATENCYSTATS_HIST_SIZE 32
+
+/** Latency statistics of a TX queue or port, all latencies in ns. */
+struct rte_latencystats {
+	uint64_t samples; /**< Number of packets measured. */
+	uint64_t min;     /**< Minimum latency. */
+	uint64_t avg;     /**< Average latency. */
+	uint64_t max;     /**< Maximum latency. */
+	uint64_t jitter;  /**< Variation between consecutive latencies. */
+	uint64_t hist[RTE_LATENCYSTATS_HIST_SIZE];
+	/**< Histogram of the latencies. */
+};
+
+/**
+ * Enables the latency statistics.
+ *
+ * The primary process creates the shared statistics and adds the RX and TX
+ * callbacks to the queues of all ports. The queues must be set up before,
+ * the ports and queues added afterwards are not measured. Secondary
+ * processes only attach to the statistics to read them with
+ * rte_latencystats_get().
+ *
+ * @param samp_intvl
+ *  Minimum interval between two timestamped bursts of an RX queue, in ns.
+ *  With 0, all packets are timestamped.
+ *
+ * @return
+ *  0 on success, -EEXIST if already enabled, -ENOENT if the primary process
+ *  did not enable the statistics, -ENOMEM if the statistics cannot be
+ *  allocated, or the error returned when adding a callback.
+ */
+int
+rte_latencystats_init(uint64_t samp_intvl);
+
+/**
+ * Disables the latency statistics in the primary process by removing the
+ * callbacks. The statistics stay readable.
+ *
+ * The callbacks are not freed, since they may still be running on the
+ * forwarding lcores.
+ *
+ * @return
+ *  0 on success, -ENOENT if the statistics are not enabled.
+ */
+int
+rte_latencystats_uninit(void);
+
+/**
+ * Reads a consistent snapshot of the statistics of a TX queue. This
+ * function takes no lock and can be called from any process.
+ *
+ * @param port_id
+ *  Port to read.
+ * @param queue_id
+ *  TX queue to read, or RTE_LATENCYSTATS_ALL_QUEUES to merge the statistics
+ *  of all queues of the port. The jitter is then the average of the queues
+ *  weighted by their number of samples.
+ * @param stats
+ *  Where to store the snapshot.
+ *
+ * @return
+ *  0 on success, -EINVAL on invalid arguments, -ENOENT if the statistics
+ *  are not enabled.
+ */
+int
+rte_latencystats_get(uint8_t port_id, uint16_t queue_id,
+		struct rte_latencystats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_LATENCYSTATS_H_ */
@@ -60,6 +60,7 @@
 #include <rte_atomic.h>
 #include <rte_prefetch.h>
 #include <rte_branch_prediction.h>
+#include <rte_mbuf_dyn.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -124,10 +125,32 @@ extern "C" {
  */
 #define PKT_RX_QINQ_PKT      PKT_RX_QINQ_STRIPPED
 
+/**
+ * The timestamp field of the mbuf is valid.
+ */
+#define PKT_RX_TIMESTAMP     (1ULL << 16)
+
 /* add new RX flags here */
 
+/*
+ * The bits between the RX and TX flags are left for dynamic flags, see
+ * rte_mbuf_dynflag_register(). A new static flag must shrink this range.
+ */
+#define PKT_FIRST_FREE       (1ULL << 17) /**< First bit of dynamic flags. */
+#define PKT_LAST_FREE        (1ULL << 47) /**< Last bit of dynamic flags. */
+
 /* add new TX flags here */
 
+/**
+ * UDP fragmentation offload. To enable it for an IPv4 UDP datagram,
+ * in software with librte_gso:
+ *  - set the PKT_TX_UDP_SEG flag in mbuf->ol_flags
+ *  - set the flag PKT_TX_IPV4
+ *  - fill the mbuf offload information: l2_len, l3_len, and tso_segsz
+ *    with the max IP payload length of the fragments, or 0
+ */
+#define PKT_TX_UDP_SEG (1ULL << 48)
+
 /**
  * Second VLAN insertion (QinQ) flag.
  */
@@ -218,7 +241,25 @@ extern "C" {
  */
 #define PKT_TX_OUTER_IPV6    (1ULL << 60)
 
-#define __RESERVED           (1ULL << 61) /**< reserved for future mbuf use */
+/**
+ * Bitmask of the TX flags requesting an offload. The other TX flags only
+ * describe the packet.
+ */
+#define PKT_TX_OFFLOAD_MASK (    \
+		PKT_TX_IP_CKSUM |        \
+		PKT_TX_L4_MASK |         \
+		PKT_TX_OUTER_IP_CKSUM |  \
+		PKT_TX_TCP_SEG |         \
+		PKT_TX_UDP_SEG |         \
+		PKT_TX_IEEE1588_TMST |   \
+		PKT_TX_QINQ_PKT |        \
+		PKT_TX_VLAN_PKT)
+
+/**
+ * The mbuf is attached to an external buffer, described by its shinfo
+ * field, see rte_pktmbuf_attach_extbuf().
+ */
+#define EXT_ATTACHED_MBUF    (1ULL << 61)
 
 #define IND_ATTACHED_MBUF    (1ULL << 62) /**< Indirect attached mbuf */
 
@@ -310,6 +351,22 @@ extern "C" {
  * <'ether type'=0x894F>
  */
 #define RTE_PTYPE_L2_ETHER_NSH              0x00000005
+/**
+ * Ethernet packet type with a VLAN (Virtual Local Area Network) tag.
+ * It is used for outer packet for tunneling cases.
+ *
+ * Packet format:
+ * <'ether type'=0x8100>
+ */
+#define RTE_PTYPE_L2_ETHER_VLAN             0x00000006
+/**
+ * Ethernet packet type with QinQ (IEEE 802.1ad) tags.
+ * It is used for outer packet for tunneling cases.
+ *
+ * Packet format:
+ * <'ether type'=0x88A8, 'ether type'=0x8100>
+ */
+#define RTE_PTYPE_L2_ETHER_QINQ             0x00000007
 /**
  * Mask of layer 2 packet types.
  * It is used for outer packet for tunneling cases.
@@ -556,6 +613,13 @@ extern "C" {
  * <'ether type'=[0x800|0x86DD], vlan=[1-4095]>
  */
 #define RTE_PTYPE_INNER_L2_ETHER_VLAN       0x00020000
+/**
+ * Ethernet packet type with QinQ (IEEE 802.1ad) tags.
+ *
+ * Packet format (inner only):
+ * <'ether type'=0x88A8, 'ether type'=0x8100>
+ */
+#define RTE_PTYPE_INNER_L2_ETHER_QINQ       0x00030000
 /**
  * Mask of inner layer 2 packet types.
  */
@@ -843,11 +907,16 @@ struct rte_mbuf {
 		uint32_t usr;	  /**< User defined tags. See rte_distributor_process() */
 	} hash;                   /**< hash information */
 
-	uint32_t seqn; /**< Sequence number. See also rte_reorder_insert() */
-
 	/** Outer VLAN TCI (CPU order), valid if PKT_RX_QINQ_STRIPPED is set. */
 	uint16_t vlan_tci_outer;
 
+	/*
+	 * The pool is read when the mbuf is freed, so it stays in the first
+	 * cache line: a single segment packet is received, forwarded and
+	 * freed without touching the second one.
+	 */
+	struct rte_mempool *pool; /**< Pool from which mbuf was allocated. */
+
 	/* second cache line - fields only used in slow path or on TX */
 	MARKER cacheline1 __rte_cache_min_aligned;
 
@@ -856,8 +925,12 @@ struct rte_mbuf {
 		uint64_t udata64; /**< Allow 8-byte userdata on 32-bit */
 	};
 
-	struct rte_mempool *pool; /**< Pool from which mbuf was allocated. */
-	struct rte_mbuf *next;    /**< Next segment of scattered packet. */
+	/**
+	 * Next segment of scattered packet. It is NULL in the mbufs stored
+	 * in a pool, and it is only valid when the first segment has more
+	 * than one segment (nb_segs > 1).
+	 */
+	struct rte_mbuf *next;
 
 	/* fields to support TX offloads */
 	union {
@@ -882,8 +955,42 @@ struct rte_mbuf {
 
 	/** Timesync flags for use with IEEE1588. */
 	uint16_t timesync;
+
+	uint32_t seqn; /**< Sequence number. See also rte_reorder_insert() */
+
+	/** Timestamp of the packet, valid if PKT_RX_TIMESTAMP is set. The
+	 * unit and time reference are defined by whoever sets it, e.g. TSC
+	 * cycles at reception for librte_latencystats. */
+	uint64_t timestamp;
+
+	/** Shared data of the external buffer, if EXT_ATTACHED_MBUF is set. */
+	struct rte_mbuf_ext_shared_info *shinfo;
+
+	/** Reserved for dynamic fields, see rte_mbuf_dynfield_register(). */
+	uint8_t dynfield1[16];
 } __rte_cache_aligned;
 
+/**
+ * Function called to free an external buffer when its last mbuf is freed.
+ *
+ * @param addr
+ *   The address of the external buffer.
+ * @param opaque
+ *   The fcb_opaque argument given with the callback.
+ */
+typedef void (*rte_mbuf_extbuf_free_callback_t)(void *addr, void *opaque);
+
+/**
+ * Shared data of an external buffer, referenced by all the mbufs attached
+ * to it. It is usually stored at the end of the buffer itself, see
+ * rte_pktmbuf_ext_shinfo_init_helper().
+ */
+struct rte_mbuf_ext_shared_info {
+	rte_mbuf_extbuf_free_callback_t free_cb; /**< Free callback. */
+	void *fcb_opaque;                        /**< Free callback argument. */
+	rte_atomic16_t refcnt_atomic;            /**< Atomic refcnt. */
+};
+
 /**
  * Prefetch the first part of the mbuf
  *
@@ -992,9 +1099,18 @@ rte_mbuf_to_baddr(struct rte_mbuf *md)
 #define RTE_MBUF_INDIRECT(mb)   ((mb)->ol_flags & IND_ATTACHED_MBUF)
 
 /**
- * Returns TRUE if given mbuf is direct, or FALSE otherwise.
+ * Returns TRUE if given mbuf is attached to an external buffer, or FALSE
+ * otherwise.
  */
-#define RTE_MBUF_DIRECT(mb)     (!RTE_MBUF_INDIRECT(mb))
+#define RTE_MBUF_HAS_EXTBUF(mb) ((mb)->ol_flags & EXT_ATTACHED_MBUF)
+
+/**
+ * Returns TRUE if given mbuf is direct, or FALSE otherwise: its data is
+ * in its own buffer, it is neither indirect nor attached to an external
+ * buffer.
+ */
+#define RTE_MBUF_DIRECT(mb) \
+	(!((mb)->ol_flags & (IND_ATTACHED_MBUF | EXT_ATTACHED_MBUF)))
 
 /**
  * Private data in case of pktmbuf pool.
@@ -1106,6 +1222,60 @@ rte_mbuf_refcnt_set(struct rte_mbuf *m, uint16_t new_value)
 
 #endif /* RTE_MBUF_REFCNT_ATOMIC */
 
+/**
+ * Reads the refcnt of an external buffer.
+ *
+ * @param shinfo
+ *   Shared data of the external buffer.
+ * @return
+ *   Number of mbufs attached to the external buffer.
+ */
+static inline uint16_t
+rte_mbuf_ext_refcnt_read(const struct rte_mbuf_ext_shared_info *shinfo)
+{
+	return (uint16_t)(rte_atomic16_read(&shinfo->refcnt_atomic));
+}
+
+/**
+ * Sets the refcnt of an external buffer.
+ *
+ * @param shinfo
+ *   Shared data of the external buffer.
+ * @param new_value
+ *   Value set
+ */
+static inline void
+rte_mbuf_ext_refcnt_set(struct rte_mbuf_ext_shared_info *shinfo,
+	uint16_t new_value)
+{
+	rte_atomic16_set(&shinfo->refcnt_atomic, new_value);
+}
+
+/**
+ * Adds given value to the refcnt of an external buffer and returns its
+ * new value.
+ *
+ * @param shinfo
+ *   Shared data of the external buffer.
+ * @param value
+ *   Value to add/subtract
+ * @return
+ *   Updated value
+ */
+static inline uint16_t
+rte_mbuf_ext_refcnt_update(struct rte_mbuf_ext_shared_info *shinfo,
+	int16_t value)
+{
+	/* no atomic operation when the caller is the only user */
+	if (likely(rte_mbuf_ext_refcnt_read(shinfo) == 1)) {
+		rte_mbuf_ext_refcnt_set(shinfo, 1 + value);
+		return 1 + value;
+	}
+
+	return (uint16_t)rte_atomic16_add_return(&shinfo->refcnt_atomic,
+		value);
+}
+
 /** Mbuf prefetch */
 #define RTE_MBUF_PREFETCH_TO_FREE(m) do {       \
 	if ((m) != NULL)                        \
@@ -1136,6 +1306,11 @@ rte_mbuf_sanity_check(const struct rte_mbuf *m, int is_header);
  * initializing all the required fields. See rte_pktmbuf_reset().
  * For standard needs, prefer rte_pktmbuf_alloc().
  *
+ * The next field of the returned mbuf is always NULL, so a driver receiving
+ * single segment packets only has to initialize the first cache line. This
+ * holds as long as the mbufs are freed with rte_pktmbuf_free_seg(), or with
+ * __rte_pktmbuf_prefree_seg() before being put back into their pool.
+ *
  * @param mp
  *   The mempool from which mbuf is allocated.
  * @return
@@ -1487,12 +1662,115 @@ static inline int rte_pktmbuf_alloc_bulk(struct rte_mempool *pool,
 	return 0;
 }
 
+/**
+ * Initialize the shared data of an external buffer at the end of it.
+ *
+ * The shared data is stored in the last bytes of the buffer, so that the
+ * buffer and its refcnt are allocated and freed together. Its refcnt is
+ * set to 1, for the first mbuf to attach.
+ *
+ * @param buf_addr
+ *   The address of the external buffer.
+ * @param [in,out] buf_len
+ *   The length of the external buffer, updated to the length left for
+ *   data before the shared data.
+ * @param free_cb
+ *   The function called to free the buffer when the last mbuf attached
+ *   to it is freed.
+ * @param fcb_opaque
+ *   The argument of free_cb.
+ * @return
+ *   The shared data, or NULL if the buffer is too small.
+ */
+static inline struct rte_mbuf_ext_shared_info *
+rte_pktmbuf_ext_shinfo_init_helper(void *buf_addr, uint16_t *buf_len,
+	rte_mbuf_extbuf_free_callback_t free_cb, void *fcb_opaque)
+{
+	struct rte_mbuf_ext_shared_info *shinfo;
+	void *buf_end = RTE_PTR_ADD(buf_addr, *buf_len);
+
+	shinfo = RTE_PTR_ALIGN_FLOOR(RTE_PTR_SUB(buf_end, sizeof(*shinfo)),
+		sizeof(uintptr_t));
+	if ((void *)shinfo <= buf_addr)
+		return NULL;
+
+	shinfo->free_cb = free_cb;
+	shinfo->fcb_opaque = fcb_opaque;
+	rte_mbuf_ext_refcnt_set(shinfo, 1);
+
+	*buf_len = (uint16_t)RTE_PTR_DIFF(shinfo, buf_addr);
+	return shinfo;
+}
+
+/**
+ * Attach an external buffer to a packet mbuf.
+ *
+ * The data of the mbuf is then stored in a buffer which does not come
+ * from an mbuf pool, e.g. an object of an application cache or a buffer
+ * of guest memory, which is sent without being copied. The mbuf keeps
+ * its own buffer, which is restored when the mbuf is detached or freed.
+ *
+ * The external buffer is shared by all the mbufs attached to it, directly
+ * with this function or through rte_pktmbuf_attach() or
+ * rte_pktmbuf_clone(). The refcnt of its shared data counts them: it is
+ * incremented by rte_pktmbuf_attach(), but not by this function, so the
+ * caller attaching the same buffer to several mbufs must increment it
+ * with rte_mbuf_ext_refcnt_update() for each mbuf after the first one.
+ * When the last mbuf is freed, the free callback of the shared data is
+ * called.
+ *
+ * The data offset and length of the mbuf are reset to 0, the data must be
+ * placed with rte_pktmbuf_append() or by setting data_off, data_len and
+ * pkt_len. The mbuf can be a segment of a chained packet.
+ *
+ * Drivers transmitting the buffers of a hardware managed pool, which are
+ * freed by the hardware, copy the data of such mbufs instead.
+ *
+ * @param m
+ *   The packet mbuf, direct and not used by someone else.
+ * @param buf_addr
+ *   The address of the external buffer.
+ * @param buf_physaddr
+ *   The physical address of the external buffer.
+ * @param buf_len
+ *   The length of the external buffer, without its shared data.
+ * @param shinfo
+ *   The shared data of the external buffer, with its free callback.
+ */
+static inline void
+rte_pktmbuf_attach_extbuf(struct rte_mbuf *m, void *buf_addr,
+	phys_addr_t buf_physaddr, uint16_t buf_len,
+	struct rte_mbuf_ext_shared_info *shinfo)
+{
+	RTE_ASSERT(RTE_MBUF_DIRECT(m) && rte_mbuf_refcnt_read(m) == 1);
+	RTE_ASSERT(shinfo->free_cb != NULL);
+
+	m->buf_addr = buf_addr;
+	m->buf_physaddr = buf_physaddr;
+	m->buf_len = buf_len;
+
+	m->data_len = 0;
+	m->data_off = 0;
+
+	m->ol_flags |= EXT_ATTACHED_MBUF;
+	m->shinfo = shinfo;
+}
+
+/**
+ * Detach the external buffer attached to a packet mbuf, see
+ * rte_pktmbuf_detach().
+ */
+#define rte_pktmbuf_detach_extbuf(m) rte_pktmbuf_detach(m)
+
 /**
  * Attach packet mbuf to another packet mbuf.
  *
  * After attachment we refer the mbuf we attached as 'indirect',
  * while mbuf we attached to as 'direct'.
  * The direct mbuf's reference counter is incremented.
+ * If the mbuf we attach to is itself attached to an external buffer, the
+ * indirect mbuf is attached to the same external buffer, whose reference
+ * counter is incremented instead.
  *
  * Right now, not supported:
  *  - attachment for already indirect mbuf (e.g. - mi has to be direct).
@@ -1511,14 +1789,23 @@ static inline void rte_pktmbuf_attach(struct rte_mbuf *mi, struct rte_mbuf *m)
 	RTE_ASSERT(RTE_MBUF_DIRECT(mi) &&
 	    rte_mbuf_refcnt_read(mi) == 1);
 
-	/* if m is not direct, get the mbuf that embeds the data */
-	if (RTE_MBUF_DIRECT(m))
-		md = m;
-	else
-		md = rte_mbuf_from_indirect(m);
+	if (RTE_MBUF_HAS_EXTBUF(m)) {
+		/* share the external buffer of m */
+		rte_mbuf_ext_refcnt_update(m->shinfo, 1);
+		mi->ol_flags = m->ol_flags;
+		mi->shinfo = m->shinfo;
+	} else {
+		/* if m is not direct, get the mbuf that embeds the data */
+		if (RTE_MBUF_DIRECT(m))
+			md = m;
+		else
+			md = rte_mbuf_from_indirect(m);
+
+		rte_mbuf_refcnt_update(md, 1);
+		mi->priv_size = m->priv_size;
+		mi->ol_flags = m->ol_flags | IND_ATTACHED_MBUF;
+	}
 
-	rte_mbuf_refcnt_update(md, 1);
-	mi->priv_size = m->priv_size;
 	mi->buf_physaddr = m->buf_physaddr;
 	mi->buf_addr = m->buf_addr;
 	mi->buf_len = m->buf_len;
@@ -1531,24 +1818,52 @@ static inline void rte_pktmbuf_attach(struct rte_mbuf *mi, struct rte_mbuf *m)
 	mi->vlan_tci_outer = m->vlan_tci_outer;
 	mi->tx_offload = m->tx_offload;
 	mi->hash = m->hash;
+	mi->timestamp = m->timestamp;
 
 	mi->next = NULL;
 	mi->pkt_len = mi->data_len;
 	mi->nb_segs = 1;
-	mi->ol_flags = m->ol_flags | IND_ATTACHED_MBUF;
 	mi->packet_type = m->packet_type;
 
 	__rte_mbuf_sanity_check(mi, 1);
 	__rte_mbuf_sanity_check(m, 0);
 }
 
+/* drop the reference of an mbuf to its external buffer */
+static inline void
+__rte_pktmbuf_free_extbuf(struct rte_mbuf *m)
+{
+	RTE_ASSERT(RTE_MBUF_HAS_EXTBUF(m));
+	RTE_ASSERT(m->shinfo != NULL);
+
+	if (rte_mbuf_ext_refcnt_update(m->shinfo, -1) == 0)
+		m->shinfo->free_cb(m->buf_addr, m->shinfo->fcb_opaque);
+}
+
+/* drop the reference of an indirect mbuf to its direct mbuf */
+static inline void
+__rte_pktmbuf_free_direct(struct rte_mbuf *m)
+{
+	struct rte_mbuf *md = rte_mbuf_from_indirect(m);
+
+	if (rte_mbuf_refcnt_update(md, -1) == 0) {
+		md->next = NULL;
+		md->nb_segs = 1;
+		__rte_mbuf_raw_free(md);
+	}
+}
+
 /**
- * Detach an indirect packet mbuf.
+ * Detach an indirect packet mbuf, or a packet mbuf attached to an
+ * external buffer.
  *
  *  - restore original mbuf address and length values.
  *  - reset pktmbuf data and data_len to their default values.
  *  - decrement the direct mbuf's reference counter. When the
  *  reference counter becomes 0, the direct mbuf is freed.
+ *  - or decrement the external buffer's reference counter. When the
+ *  reference counter becomes 0, the free callback of the external
+ *  buffer is called.
  *
  * All other fields of the given packet mbuf will be left intact.
  *
@@ -1557,10 +1872,14 @@ static inline void rte_pktmbuf_attach(struct rte_mbuf *mi, struct rte_mbuf *m)
  */
 static inline void rte_pktmbuf_detach(struct rte_mbuf *m)
 {
-	struct rte_mbuf *md = rte_mbuf_from_indirect(m);
 	struct rte_mempool *mp = m->pool;
 	uint32_t mbuf_size, buf_len, priv_size;
 
+	if (RTE_MBUF_HAS_EXTBUF(m))
+		__rte_pktmbuf_free_extbuf(m);
+	else
+		__rte_pktmbuf_free_direct(m);
+
 	priv_size = rte_pktmbuf_priv_size(mp);
 	mbuf_size = sizeof(struct rte_mbuf) + priv_size;
 	buf_len = rte_pktmbuf_data_room_size(mp);
@@ -1572,20 +1891,34 @@ static inline void rte_pktmbuf_detach(struct rte_mbuf *m)
 	m->data_off = RTE_MIN(RTE_PKTMBUF_HEADROOM, (uint16_t)m->buf_len);
 	m->data_len = 0;
 	m->ol_flags = 0;
-
-	if (rte_mbuf_refcnt_update(md, -1) == 0)
-		__rte_mbuf_raw_free(md);
 }
 
+/**
+ * @internal Decrease the reference counter of a segment and prepare it to
+ * be put back into its mempool when it drops to 0: the segment is detached
+ * and unchained, so that the next field of the mbufs in the pool is NULL.
+ * Drivers freeing segments in bulk call it before rte_mempool_put_bulk().
+ *
+ * @param m
+ *   The packet mbuf segment to be freed.
+ * @return
+ *   The segment to put into its mempool, or NULL if it is still used.
+ */
 static inline struct rte_mbuf* __attribute__((always_inline))
 __rte_pktmbuf_prefree_seg(struct rte_mbuf *m)
 {
 	__rte_mbuf_sanity_check(m, 0);
 
 	if (likely(rte_mbuf_refcnt_update(m, -1) == 0)) {
-		/* if this is an indirect mbuf, it is detached. */
-		if (RTE_MBUF_INDIRECT(m))
+		/* if this is an indirect mbuf or an external buffer, it is
+		 * detached. */
+		if (!RTE_MBUF_DIRECT(m))
 			rte_pktmbuf_detach(m);
+		/* do not dirty the second cache line of single segment mbufs */
+		if (m->next != NULL) {
+			m->next = NULL;
+			m->nb_segs = 1;
+		}
 		return m;
 	}
 	return NULL;
@@ -1603,10 +1936,8 @@ __rte_pktmbuf_prefree_seg(struct rte_mbuf *m)
 static inline void __attribute__((always_inline))
 rte_pktmbuf_free_seg(struct rte_mbuf *m)
 {
-	if (likely(NULL != (m = __rte_pktmbuf_prefree_seg(m)))) {
-		m->next = NULL;
+	if (likely(NULL != (m = __rte_pktmbuf_prefree_seg(m))))
 		__rte_mbuf_raw_free(m);
-	}
 }
 
 /**
@@ -1995,6 +2326,57 @@ static inline int rte_pktmbuf_chain(struct rte_mbuf *head, struct rte_mbuf *tail
 	return 0;
 }
 
+/**
+ * Validate the TX offload requests of a packet.
+ *
+ * Check the requirements that all PMDs share: the offload fields cover
+ * headers held in the first segment, and the flags are consistent (IP
+ * type set for L4 offloads, IPv4 for the IP checksum, MSS for TSO...).
+ * PMDs call it from their TX prepare function when
+ * RTE_LIBRTE_ETHDEV_DEBUG is enabled.
+ *
+ * @param m
+ *   The packet to validate.
+ * @return
+ *   - 0 if the packet is valid, or requests no offload.
+ *   - -EINVAL if the offload flags or fields are inconsistent.
+ *   - -ENOTSUP if the headers are not in the first segment.
+ */
+static inline int
+rte_validate_tx_offload(const struct rte_mbuf *m)
+{
+	uint64_t ol_flags = m->ol_flags;
+	uint64_t inner_l3_offset = m->l2_len;
+
+	if (!(ol_flags & PKT_TX_OFFLOAD_MASK))
+		return 0;
+
+	if (ol_flags & (PKT_TX_OUTER_IPV4 | PKT_TX_OUTER_IPV6))
+		inner_l3_offset += m->outer_l2_len + m->outer_l3_len;
+
+	if (rte_pktmbuf_data_len(m) < inner_l3_offset + m->l3_len + m->l4_len)
+		return -ENOTSUP;
+
+	/* the IP checksum only exists in IPv4 */
+	if ((ol_flags & PKT_TX_IP_CKSUM) && (ol_flags & PKT_TX_IPV6))
+		return -EINVAL;
+
+	if ((ol_flags & (PKT_TX_L4_MASK | PKT_TX_TCP_SEG)) &&
+			!(ol_flags & (PKT_TX_IPV4 | PKT_TX_IPV6)))
+		return -EINVAL;
+
+	if ((ol_flags & PKT_TX_TCP_SEG) && (m->tso_segsz == 0 ||
+			m->l4_len == 0 || ((ol_flags & PKT_TX_IPV4) &&
+			!(ol_flags & PKT_TX_IP_CKSUM))))
+		return -EINVAL;
+
+	if ((ol_flags & PKT_TX_OUTER_IP_CKSUM) &&
+			!(ol_flags & PKT_TX_OUTER_IPV4))
+		return -EINVAL;
+
+	return 0;
+}
+
 /**
  * Dump an mbuf structure to the console.
  *
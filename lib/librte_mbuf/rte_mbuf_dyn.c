@@ -0,0 +1,408 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_eal_memconfig.h>
+#include <rte_errno.h>
+#include <rte_log.h>
+#include <rte_memory.h>
+#include <rte_memzone.h>
+#include <rte_rwlock.h>
+
+#include "rte_mbuf.h"
+#include "rte_mbuf_dyn.h"
+
+#define MBUF_DYN_MZ_NAME "rte_mbuf_dyn"
+
+/* bytes left for dynamic fields, at most one field per byte */
+#define MBUF_DYN_AREA_SIZE (sizeof(((struct rte_mbuf *)0)->dynfield1))
+#define MBUF_DYN_MAX_FIELDS MBUF_DYN_AREA_SIZE
+#define MBUF_DYN_MAX_FLAGS 64
+
+/* any offset or bit number */
+#define MBUF_DYN_ANY_OFFSET SIZE_MAX
+#define MBUF_DYN_ANY_BITNUM UINT32_MAX
+
+struct mbuf_dynfield_elt {
+	struct rte_mbuf_dynfield params;
+	size_t offset;
+};
+
+struct mbuf_dynflag_elt {
+	struct rte_mbuf_dynflag params;
+	unsigned int bitnum;
+};
+
+/*
+ * Registry shared by all the processes, in a memzone, protected by the EAL
+ * tailq lock which lives in shared memory too.
+ */
+struct mbuf_dyn_shm {
+	uint8_t free_space[sizeof(struct rte_mbuf)]; /* 1 for a free byte */
+	uint64_t free_flags;                         /* free ol_flags bits */
+	unsigned int nb_fields;
+	unsigned int nb_flags;
+	struct mbuf_dynfield_elt fields[MBUF_DYN_MAX_FIELDS];
+	struct mbuf_dynflag_elt flags[MBUF_DYN_MAX_FLAGS];
+};
+
+static struct mbuf_dyn_shm *shm;
+
+/* attach to the registry, creating it if asked, called with the lock held */
+static int
+mbuf_dyn_attach(int create)
+{
+	const struct rte_memzone *mz;
+	struct mbuf_dyn_shm *s;
+	uint64_t bit;
+
+	if (shm != NULL)
+		return 0;
+
+	mz = rte_memzone_lookup(MBUF_DYN_MZ_NAME);
+	if (mz == NULL) {
+		if (!create) {
+			rte_errno = ENOENT;
+			return -1;
+		}
+		mz = rte_memzone_reserve(MBUF_DYN_MZ_NAME, sizeof(*s),
+				SOCKET_ID_ANY, 0);
+		if (mz == NULL) {
+			rte_errno = ENOMEM;
+			return -1;
+		}
+		s = mz->addr;
+		memset(s, 0, sizeof(*s));
+		memset(&s->free_space[offsetof(struct rte_mbuf, dynfield1)], 1,
+			MBUF_DYN_AREA_SIZE);
+		for (bit = PKT_FIRST_FREE; bit <= PKT_LAST_FREE; bit <<= 1)
+			s->free_flags |= bit;
+	}
+	shm = mz->addr;
+
+	return 0;
+}
+
+static struct mbuf_dynfield_elt *
+mbuf_dynfield_find(const char *name)
+{
+	unsigned int i;
+
+	for (i = 0; i < shm->nb_fields; i++)
+		if (strcmp(shm->fields[i].params.name, name) == 0)
+			return &shm->fields[i];
+	return NULL;
+}
+
+static struct mbuf_dynflag_elt *
+mbuf_dynflag_find(const char *name)
+{
+	unsigned int i;
+
+	for (i = 0; i < shm->nb_flags; i++)
+		if (strcmp(shm->flags[i].params.name, name) == 0)
+			return &shm->flags[i];
+	return NULL;
+}
+
+static int
+mbuf_dyn_name_valid(const char *name)
+{
+	return name[0] != '\0' &&
+		strnlen(name, RTE_MBUF_DYN_NAMESIZE) < RTE_MBUF_DYN_NAMESIZE;
+}
+
+/* check that size bytes are free from offset */
+static int
+mbuf_dynfield_is_free(size_t offset, size_t size)
+{
+	size_t i;
+
+	if (offset > sizeof(struct rte_mbuf) - size)
+		return 0;
+	for (i = offset; i < offset + size; i++)
+		if (!shm->free_space[i])
+			return 0;
+	return 1;
+}
+
+static int
+mbuf_dynfield_register(const struct rte_mbuf_dynfield *params, size_t req)
+{
+	struct mbuf_dynfield_elt *elt;
+	size_t offset;
+
+	elt = mbuf_dynfield_find(params->name);
+	if (elt != NULL) {
+		if (elt->params.size != params->size ||
+				elt->params.align != params->align ||
+				elt->params.flags != params->flags ||
+				(req != MBUF_DYN_ANY_OFFSET &&
+				 req != elt->offset)) {
+			rte_errno = EEXIST;
+			return -1;
+		}
+		return elt->offset;
+	}
+
+	if (req != MBUF_DYN_ANY_OFFSET) {
+		if (req % params->align != 0) {
+			rte_errno = EINVAL;
+			return -1;
+		}
+		if (!mbuf_dynfield_is_free(req, params->size)) {
+			rte_errno = EBUSY;
+			return -1;
+		}
+		offset = req;
+	} else {
+		for (offset = 0; offset < sizeof(struct rte_mbuf);
+				offset += params->align)
+			if (mbuf_dynfield_is_free(offset, params->size))
+				break;
+		if (offset >= sizeof(struct rte_mbuf)) {
+			rte_errno = ENOMEM;
+			return -1;
+		}
+	}
+
+	/* a field takes at least one byte, the table cannot be full */
+	elt = &shm->fields[shm->nb_fields++];
+	elt->params = *params;
+	elt->offset = offset;
+	memset(&shm->free_space[offset], 0, params->size);
+
+	RTE_LOG(DEBUG, MBUF, "registered dynamic field %s (sz=%zu, al=%zu) "
+		"at offset %zu\n", params->name, params->size, params->align,
+		offset);
+
+	return offset;
+}
+
+int
+rte_mbuf_dynfield_register_offset(const struct rte_mbuf_dynfield *params,
+		size_t req)
+{
+	int ret;
+
+	if (params == NULL || !mbuf_dyn_name_valid(params->name) ||
+			params->size == 0 ||
+			params->size > MBUF_DYN_AREA_SIZE ||
+			params->align > RTE_CACHE_LINE_MIN_SIZE ||
+			!rte_is_power_of_2(params->align) ||
+			params->flags != 0) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+	ret = mbuf_dyn_attach(1);
+	if (ret == 0)
+		ret = mbuf_dynfield_register(params, req);
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	return ret;
+}
+
+int
+rte_mbuf_dynfield_register(const struct rte_mbuf_dynfield *params)
+{
+	return rte_mbuf_dynfield_register_offset(params, MBUF_DYN_ANY_OFFSET);
+}
+
+int
+rte_mbuf_dynfield_lookup(const char *name, struct rte_mbuf_dynfield *params)
+{
+	struct mbuf_dynfield_elt *elt = NULL;
+	int ret;
+
+	if (name == NULL) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+	ret = mbuf_dyn_attach(0);
+	if (ret == 0)
+		elt = mbuf_dynfield_find(name);
+	if (elt != NULL) {
+		if (params != NULL)
+			*params = elt->params;
+		ret = elt->offset;
+	} else {
+		rte_errno = ENOENT;
+		ret = -1;
+	}
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	return ret;
+}
+
+static int
+mbuf_dynflag_register(const struct rte_mbuf_dynflag *params,
+		unsigned int req)
+{
+	struct mbuf_dynflag_elt *elt;
+	unsigned int bitnum;
+
+	elt = mbuf_dynflag_find(params->name);
+	if (elt != NULL) {
+		if (elt->params.flags != params->flags ||
+				(req != MBUF_DYN_ANY_BITNUM &&
+				 req != elt->bitnum)) {
+			rte_errno = EEXIST;
+			return -1;
+		}
+		return elt->bitnum;
+	}
+
+	if (req != MBUF_DYN_ANY_BITNUM) {
+		if (!(shm->free_flags & (1ULL << req))) {
+			rte_errno = EBUSY;
+			return -1;
+		}
+		bitnum = req;
+	} else {
+		if (shm->free_flags == 0) {
+			rte_errno = ENOSPC;
+			return -1;
+		}
+		for (bitnum = 0; !(shm->free_flags & (1ULL << bitnum));
+				bitnum++)
+			;
+	}
+
+	elt = &shm->flags[shm->nb_flags++];
+	elt->params = *params;
+	elt->bitnum = bitnum;
+	shm->free_flags &= ~(1ULL << bitnum);
+
+	RTE_LOG(DEBUG, MBUF, "registered dynamic flag %s at bit %u\n",
+		params->name, bitnum);
+
+	return bitnum;
+}
+
+int
+rte_mbuf_dynflag_register_bitnum(const struct rte_mbuf_dynflag *params,
+		unsigned int req)
+{
+	int ret;
+
+	if (params == NULL || !mbuf_dyn_name_valid(params->name) ||
+			params->flags != 0 ||
+			(req != MBUF_DYN_ANY_BITNUM && (req >= 64 ||
+			 (1ULL << req) < PKT_FIRST_FREE ||
+			 (1ULL << req) > PKT_LAST_FREE))) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+	ret = mbuf_dyn_attach(1);
+	if (ret == 0)
+		ret = mbuf_dynflag_register(params, req);
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	return ret;
+}
+
+int
+rte_mbuf_dynflag_register(const struct rte_mbuf_dynflag *params)
+{
+	return rte_mbuf_dynflag_register_bitnum(params, MBUF_DYN_ANY_BITNUM);
+}
+
+int
+rte_mbuf_dynflag_lookup(const char *name, struct rte_mbuf_dynflag *params)
+{
+	struct mbuf_dynflag_elt *elt = NULL;
+	int ret;
+
+	if (name == NULL) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+	ret = mbuf_dyn_attach(0);
+	if (ret == 0)
+		elt = mbuf_dynflag_find(name);
+	if (elt != NULL) {
+		if (params != NULL)
+			*params = elt->params;
+		ret = elt->bitnum;
+	} else {
+		rte_errno = ENOENT;
+		ret = -1;
+	}
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	return ret;
+}
+
+void
+rte_mbuf_dyn_dump(FILE *out)
+{
+	unsigned int i, nb_free = 0;
+
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+	if (mbuf_dyn_attach(0) < 0) {
+		fprintf(out, "no dynamic field or flag registered\n");
+		rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+		return;
+	}
+
+	fprintf(out, "Reserved fields:\n");
+	for (i = 0; i < shm->nb_fields; i++)
+		fprintf(out, "  name=%s offset=%zu size=%zu align=%zu\n",
+			shm->fields[i].params.name, shm->fields[i].offset,
+			shm->fields[i].params.size,
+			shm->fields[i].params.align);
+	fprintf(out, "Reserved flags:\n");
+	for (i = 0; i < shm->nb_flags; i++)
+		fprintf(out, "  name=%s bitnum=%u\n",
+			shm->flags[i].params.name, shm->flags[i].bitnum);
+
+	for (i = 0; i < sizeof(struct rte_mbuf); i++)
+		nb_free += shm->free_space[i];
+	fprintf(out, "Free space: %u bytes, free flags: 0x%" PRIx64 "\n",
+		nb_free, shm->free_flags);
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+}
@@ -0,0 +1,218 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_MBUF_DYN_H_
+#define _RTE_MBUF_DYN_H_
+
+/**
+ * @file
+ * RTE Mbuf dynamic fields and flags
+ *
+ * Libraries and drivers often need to store a few bytes of per packet
+ * metadata, or a per packet flag, that does not deserve a static field of
+ * the mbuf. Instead of overloading userdata or a field of the mbuf, they
+ * register a named dynamic field, and get the offset of some bytes
+ * reserved for it in the mbuf structure, or a named dynamic flag, and get
+ * the number of a bit reserved for it in ol_flags.
+ *
+ * The dynamic fields are placed in the free bytes of the second cache line
+ * of the mbuf (dynfield1), so that the first cache line keeps all the
+ * fields of the receive and transmit fast path. The dynamic flags are
+ * placed between PKT_FIRST_FREE and PKT_LAST_FREE.
+ *
+ * The registration is done at initialization, before using the mbufs, by
+ * the primary or by a secondary process. The registered fields and flags
+ * are kept in the "rte_mbuf_dyn" memzone, shared by all the processes.
+ * Registering again a field or a flag with the same parameters returns the
+ * same offset or bit, so that the users of a field or flag do not need to
+ * know which of them registered it first.
+ *
+ * Example of use of a field:
+ *
+ * @code
+ * static const struct rte_mbuf_dynfield app_seq_desc = {
+ *	.name = "app_dynfield_seq",
+ *	.size = sizeof(uint32_t),
+ *	.align = __alignof__(uint32_t),
+ * };
+ * int app_seq_offset = rte_mbuf_dynfield_register(&app_seq_desc);
+ *
+ * *RTE_MBUF_DYNFIELD(m, app_seq_offset, uint32_t *) = seq;
+ * @endcode
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum length of the name of a dynamic field or flag, with the NUL. */
+#define RTE_MBUF_DYN_NAMESIZE 64
+
+/**
+ * Parameters of a dynamic field.
+ */
+struct rte_mbuf_dynfield {
+	char name[RTE_MBUF_DYN_NAMESIZE]; /**< Name of the field. */
+	size_t size;        /**< Size of the field in bytes. */
+	size_t align;       /**< Alignment of the field, a power of 2. */
+	unsigned int flags; /**< Reserved for future use, must be 0. */
+};
+
+/**
+ * Parameters of a dynamic flag.
+ */
+struct rte_mbuf_dynflag {
+	char name[RTE_MBUF_DYN_NAMESIZE]; /**< Name of the flag. */
+	unsigned int flags; /**< Reserved for future use, must be 0. */
+};
+
+/**
+ * Register a dynamic field in the mbuf structure.
+ *
+ * The field is placed at the lowest free offset matching its size and
+ * alignment.
+ *
+ * @param params
+ *   The parameters of the dynamic field.
+ * @return
+ *   The offset of the field in the mbuf structure, or -1 on error, with
+ *   rte_errno set to:
+ *    - EINVAL: invalid parameters (size, align, flags or name).
+ *    - EEXIST: the name is already registered with other parameters.
+ *    - ENOMEM: not enough room in the mbuf, or no memory for the registry.
+ */
+int rte_mbuf_dynfield_register(const struct rte_mbuf_dynfield *params);
+
+/**
+ * Register a dynamic field in the mbuf structure at a given offset.
+ *
+ * Same as rte_mbuf_dynfield_register(), for the users which need the same
+ * offset in several applications, e.g. to exchange mbufs with hardware
+ * which writes the field.
+ *
+ * @param params
+ *   The parameters of the dynamic field.
+ * @param req
+ *   The requested offset of the field in the mbuf structure.
+ * @return
+ *   The offset of the field, or -1 on error, with rte_errno set as for
+ *   rte_mbuf_dynfield_register(), and to EBUSY if the requested bytes are
+ *   not free.
+ */
+int rte_mbuf_dynfield_register_offset(const struct rte_mbuf_dynfield *params,
+		size_t req);
+
+/**
+ * Look up a registered dynamic field.
+ *
+ * @param name
+ *   The name of the dynamic field.
+ * @param params
+ *   If not NULL, filled with the parameters of the dynamic field.
+ * @return
+ *   The offset of the field in the mbuf structure, or -1 on error, with
+ *   rte_errno set to ENOENT if the field is not registered.
+ */
+int rte_mbuf_dynfield_lookup(const char *name,
+		struct rte_mbuf_dynfield *params);
+
+/**
+ * Register a dynamic flag in the ol_flags of the mbuf.
+ *
+ * @param params
+ *   The parameters of the dynamic flag.
+ * @return
+ *   The number of the bit of the flag in ol_flags, or -1 on error, with
+ *   rte_errno set as for rte_mbuf_dynfield_register(), ENOSPC meaning that
+ *   all the dynamic flags are in use.
+ */
+int rte_mbuf_dynflag_register(const struct rte_mbuf_dynflag *params);
+
+/**
+ * Register a dynamic flag in the ol_flags of the mbuf at a given bit.
+ *
+ * @param params
+ *   The parameters of the dynamic flag.
+ * @param req
+ *   The requested bit number, between the bits of PKT_FIRST_FREE and
+ *   PKT_LAST_FREE.
+ * @return
+ *   The number of the bit of the flag, or -1 on error, with rte_errno set
+ *   as for rte_mbuf_dynflag_register(), and to EBUSY if the requested bit
+ *   is not free.
+ */
+int rte_mbuf_dynflag_register_bitnum(const struct rte_mbuf_dynflag *params,
+		unsigned int req);
+
+/**
+ * Look up a registered dynamic flag.
+ *
+ * @param name
+ *   The name of the dynamic flag.
+ * @param params
+ *   If not NULL, filled with the parameters of the dynamic flag.
+ * @return
+ *   The number of the bit of the flag in ol_flags, or -1 on error, with
+ *   rte_errno set to ENOENT if the flag is not registered.
+ */
+int rte_mbuf_dynflag_lookup(const char *name,
+		struct rte_mbuf_dynflag *params);
+
+/**
+ * Dump the registered dynamic fields and flags, and the free space left.
+ *
+ * @param out
+ *   The stream where the dump is written.
+ */
+void rte_mbuf_dyn_dump(FILE *out);
+
+/**
+ * Get a pointer to a dynamic field of an mbuf.
+ *
+ * @param m
+ *   The pointer to the mbuf.
+ * @param offset
+ *   The offset of the field, as returned by rte_mbuf_dynfield_register().
+ * @param type
+ *   The type of the pointer to the field.
+ */
+#define RTE_MBUF_DYNFIELD(m, offset, type) \
+	((type)((uintptr_t)(m) + (offset)))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_MBUF_DYN_H_ */
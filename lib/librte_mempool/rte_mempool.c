@@ -73,6 +73,16 @@ EAL_REGISTER_TAILQ(rte_mempool_tailq)
 #define CALC_CACHE_FLUSHTHRESH(c)	\
 	((typeof(c))((c) * CACHE_FLUSHTHRESH_MULTIPLIER))
 
+/*
+ * Adaptive caches: bounds relative to the requested cache size, number of
+ * objects (in units of the upper bound) between two sizing decisions, and
+ * ratio above which the get/put traffic of a cache is considered one-sided.
+ */
+#define CACHE_ADAPT_MIN_DIV	8
+#define CACHE_ADAPT_MAX_MUL	4
+#define CACHE_ADAPT_WINDOW	8
+#define CACHE_ADAPT_IMBALANCE	8
+
 /*
  * return the greatest common divisor between a and b (fast algorithm)
  *
@@ -692,6 +702,51 @@ mempool_cache_init(struct rte_mempool_cache *cache, uint32_t size)
 	cache->len = 0;
 }
 
+/* resize an adaptive cache from its own lcore, see rte_mempool.h */
+void
+rte_mempool_cache_adapt(struct rte_mempool *mp,
+	struct rte_mempool_cache *cache)
+{
+	uint64_t gets, puts, events;
+	uint32_t size;
+
+	gets = cache->get_objs - cache->adapt_get_objs;
+	puts = cache->put_objs - cache->adapt_put_objs;
+	if (gets + puts < (uint64_t)cache->max_size * CACHE_ADAPT_WINDOW)
+		return;
+
+	events = cache->get_misses + cache->put_flushes - cache->adapt_events;
+	cache->adapt_get_objs = cache->get_objs;
+	cache->adapt_put_objs = cache->put_objs;
+	cache->adapt_events = cache->get_misses + cache->put_flushes;
+
+	size = cache->size;
+	if (gets * CACHE_ADAPT_IMBALANCE < puts ||
+	    puts * CACHE_ADAPT_IMBALANCE < gets) {
+		/*
+		 * One-sided traffic goes through the pool whatever the cache
+		 * size: keep few objects stranded in this cache.
+		 */
+		size = RTE_MAX(size / 2, cache->min_size);
+	} else if (events * size * 4 > gets + puts) {
+		/* more than a quarter of the traffic hits the pool */
+		size = RTE_MIN(size * 2, cache->max_size);
+	}
+
+	if (size == cache->size)
+		return;
+
+	cache->size = size;
+	cache->flushthresh = CALC_CACHE_FLUSHTHRESH(size);
+	cache->resizes++;
+
+	if (cache->len > cache->flushthresh) {
+		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[size],
+			cache->len - size);
+		cache->len = size;
+	}
+}
+
 /*
  * Create and initialize a cache for objects that are retrieved from and
  * returned to an underlying mempool. This structure is identical to the
@@ -846,6 +901,22 @@ rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
 					   cache_size);
 	}
 
+	/* Set the bounds of adaptive caches, the pool must be able to fill one */
+	if (cache_size != 0 && (flags & MEMPOOL_F_CACHE_ADAPTIVE)) {
+		uint32_t min_size, max_size;
+
+		min_size = RTE_MAX(cache_size / CACHE_ADAPT_MIN_DIV, 1U);
+		max_size = RTE_MIN(cache_size * CACHE_ADAPT_MAX_MUL,
+				   (unsigned)RTE_MEMPOOL_CACHE_MAX_SIZE);
+		while (CALC_CACHE_FLUSHTHRESH(max_size) > n)
+			max_size--;
+
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+			mp->local_cache[lcore_id].min_size = min_size;
+			mp->local_cache[lcore_id].max_size = max_size;
+		}
+	}
+
 	te->data = mp;
 
 	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
@@ -1020,6 +1091,11 @@ rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 	if (mp->cache_size == 0)
 		return count;
 
+	if (mp->local_cache[0].max_size != 0)
+		fprintf(f, "    cache_size_bounds=[%"PRIu32", %"PRIu32"]\n",
+			mp->local_cache[0].min_size,
+			mp->local_cache[0].max_size);
+
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
 		cache_count = mp->local_cache[lcore_id].len;
 		fprintf(f, "    cache_count[%u]=%"PRIu32"\n",
@@ -1027,6 +1103,23 @@ rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 		count += cache_count;
 	}
 	fprintf(f, "    total_cache_count=%u\n", count);
+
+	/* activity of the caches that have been used */
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		const struct rte_mempool_cache *cache;
+
+		cache = &mp->local_cache[lcore_id];
+		if (cache->get_objs == 0 && cache->put_objs == 0)
+			continue;
+		fprintf(f, "    cache_stats[%u]: size=%"PRIu32
+			" get_objs=%"PRIu64" get_misses=%"PRIu64
+			" put_objs=%"PRIu64" put_flushes=%"PRIu64
+			" resizes=%"PRIu32"\n",
+			lcore_id, cache->size,
+			cache->get_objs, cache->get_misses,
+			cache->put_objs, cache->put_flushes,
+			cache->resizes);
+	}
 	return count;
 }
 
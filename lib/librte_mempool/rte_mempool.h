@@ -106,6 +106,17 @@ struct rte_mempool_cache {
 	uint32_t size;	      /**< Size of the cache */
 	uint32_t flushthresh; /**< Threshold before we flush excess elements */
 	uint32_t len;	      /**< Current cache count */
+	uint32_t min_size;    /**< Lower bound of an adaptive cache size */
+	uint32_t max_size;    /**< Upper bound of an adaptive cache size, 0 if fixed */
+	uint32_t resizes;     /**< Number of adaptive size changes */
+	uint64_t get_objs;    /**< Objects requested through the cache */
+	uint64_t get_misses;  /**< Gets that could not be served by the cache */
+	uint64_t put_objs;    /**< Objects returned through the cache */
+	uint64_t put_flushes; /**< Puts that flushed objects to the pool */
+	/* Counter values at the last adaptive sizing decision */
+	uint64_t adapt_get_objs;
+	uint64_t adapt_put_objs;
+	uint64_t adapt_events;
 	/*
 	 * Cache is allocated to this size to allow it to overflow in certain
 	 * cases to avoid needless emptying of cache.
@@ -262,6 +273,7 @@ struct rte_mempool {
 #define MEMPOOL_F_SC_GET         0x0008 /**< Default get is "single-consumer".*/
 #define MEMPOOL_F_POOL_CREATED   0x0010 /**< Internal: pool is created. */
 #define MEMPOOL_F_NO_PHYS_CONTIG 0x0020 /**< Don't need physically contiguous objs. */
+#define MEMPOOL_F_CACHE_ADAPTIVE 0x0040 /**< Resize per-lcore caches at runtime. */
 
 /**
  * @internal When debug is enabled, store some statistics.
@@ -679,6 +691,10 @@ typedef void (rte_mempool_ctor_t)(struct rte_mempool *, void *);
  *     "single-consumer". Otherwise, it is "multi-consumers".
  *   - MEMPOOL_F_NO_PHYS_CONTIG: If set, allocated objects won't
  *     necessarilly be contiguous in physical memory.
+ *   - MEMPOOL_F_CACHE_ADAPTIVE: If set, the size of each per-lcore
+ *     cache is adjusted at runtime, between cache_size / 8 and
+ *     4 * cache_size, depending on the get/put balance and the miss rate
+ *     observed on that lcore. Ignored if cache_size is 0.
  * @return
  *   The pointer to the new allocated mempool, on success. NULL on error
  *   with rte_errno set appropriately. Possible rte_errno values include:
@@ -1041,6 +1057,24 @@ rte_mempool_default_cache(struct rte_mempool *mp, unsigned lcore_id)
 	return &mp->local_cache[lcore_id];
 }
 
+/**
+ * @internal Resize an adaptive mempool cache; used internally.
+ *
+ * Called on the slow path of a cache (miss or flush) when the cache was
+ * created with adaptive bounds. Once enough objects went through the
+ * cache since the last decision, the cache is shrunk if its traffic is
+ * mostly one-sided (gets or puts only) or grown if a large share of its
+ * traffic had to go to the pool. Excess objects are flushed to the pool.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param cache
+ *   A pointer to the mempool cache to resize, owned by the calling lcore.
+ */
+void
+rte_mempool_cache_adapt(struct rte_mempool *mp,
+	struct rte_mempool_cache *cache);
+
 /**
  * @internal Put several objects back in the mempool; used internally.
  * @param mp
@@ -1086,11 +1120,15 @@ __mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
 	rte_memcpy(&cache_objs[0], obj_table, sizeof(void *) * n);
 
 	cache->len += n;
+	cache->put_objs += n;
 
 	if (cache->len >= cache->flushthresh) {
 		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
 				cache->len - cache->size);
 		cache->len = cache->size;
+		cache->put_flushes++;
+		if (cache->max_size != 0)
+			rte_mempool_cache_adapt(mp, cache);
 	}
 
 	return;
@@ -1268,13 +1306,22 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 {
 	int ret;
 	uint32_t index, len;
+	uint32_t miss = 0;
 	void **cache_objs;
 
 	/* No cache provided or single consumer */
-	if (unlikely(cache == NULL || flags & MEMPOOL_F_SC_GET ||
-		     n >= cache->size))
+	if (unlikely(cache == NULL || flags & MEMPOOL_F_SC_GET))
 		goto ring_dequeue;
 
+	/* Request too big for the cache, account it as a miss */
+	if (unlikely(n >= cache->size)) {
+		cache->get_objs += n;
+		cache->get_misses++;
+		if (cache->max_size != 0)
+			rte_mempool_cache_adapt(mp, cache);
+		goto ring_dequeue;
+	}
+
 	cache_objs = cache->objs;
 
 	/* Can this be satisfied from the cache? */
@@ -1296,6 +1343,7 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 		}
 
 		cache->len += req;
+		miss = 1;
 	}
 
 	/* Now fill in the response ... */
@@ -1303,6 +1351,13 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 		*obj_table = cache_objs[len];
 
 	cache->len -= n;
+	cache->get_objs += n;
+
+	if (unlikely(miss)) {
+		cache->get_misses++;
+		if (cache->max_size != 0)
+			rte_mempool_cache_adapt(mp, cache);
+	}
 
 	__MEMPOOL_STAT_ADD(mp, get_success, n);
 
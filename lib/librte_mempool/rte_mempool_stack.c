@@ -34,6 +34,7 @@
 #include <stdio.h>
 #include <rte_mempool.h>
 #include <rte_malloc.h>
+#include <rte_atomic.h>
 
 struct rte_mempool_stack {
 	rte_spinlock_t sl;
@@ -118,7 +119,7 @@ stack_dequeue(struct rte_mempool *mp, void **obj_table,
 
 	s->len -= n;
 	rte_spinlock_unlock(&s->sl);
-	return n;
+	return 0;
 }
 
 static unsigned
@@ -146,3 +147,245 @@ static struct rte_mempool_ops ops_stack = {
 };
 
 MEMPOOL_REGISTER_OPS(ops_stack);
+
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_ARM64)
+
+/*
+ * Lock-free stack: the objects are stored in a linked list of elements,
+ * whose head is updated with a 128-bit compare and swap of its top
+ * element and of a modification counter, which avoids the ABA problem.
+ * The elements not holding an object are kept in a second such list.
+ * The elements are never freed while the pool exists, so a thread may
+ * always read the list from a stale head, its compare and swap fails.
+ */
+
+struct lf_stack_elem {
+	struct lf_stack_elem *next;
+	void *obj;
+};
+
+struct lf_stack_head {
+	struct lf_stack_elem *top;
+	uint64_t cnt;
+} __attribute__((aligned(16)));
+
+struct lf_stack_list {
+	struct lf_stack_head head;
+	/* number of elements, lower than or equal to the list length */
+	rte_atomic64_t len;
+};
+
+struct rte_mempool_lf_stack {
+	struct lf_stack_list used __rte_cache_aligned;
+	struct lf_stack_list free __rte_cache_aligned;
+	struct lf_stack_elem elems[] __rte_cache_aligned;
+};
+
+/*
+ * Replace the head by src if it is equal to exp. Otherwise, the current
+ * head is stored in exp. Returns non-zero on success.
+ */
+static inline int
+lf_stack_cas(struct lf_stack_head *dst, struct lf_stack_head *exp,
+		const struct lf_stack_head *src)
+{
+#if defined(RTE_ARCH_X86_64)
+	uint8_t res;
+
+	asm volatile (MPLOCKED
+			"cmpxchg16b %[dst];"
+			"sete %[res]"
+			: [dst] "+m" (*dst),
+			  [res] "=q" (res),
+			  "+a" (exp->top),
+			  "+d" (exp->cnt)
+			: "b" (src->top),
+			  "c" (src->cnt)
+			: "memory");
+	return res;
+#else
+	struct lf_stack_elem *top;
+	uint64_t cnt;
+	uint32_t fail;
+
+	/* exclusive pair load and store, no need for LSE atomics */
+	do {
+		asm volatile ("ldaxp %[top], %[cnt], %[dst]"
+				: [top] "=&r" (top),
+				  [cnt] "=&r" (cnt)
+				: [dst] "Q" (*dst)
+				: "memory");
+		if (top != exp->top || cnt != exp->cnt) {
+			asm volatile ("clrex" : : : "memory");
+			exp->top = top;
+			exp->cnt = cnt;
+			return 0;
+		}
+		asm volatile ("stlxp %w[fail], %[top], %[cnt], %[dst]"
+				: [fail] "=&r" (fail),
+				  [dst] "=Q" (*dst)
+				: [top] "r" (src->top),
+				  [cnt] "r" (src->cnt)
+				: "memory");
+	} while (fail);
+	return 1;
+#endif
+}
+
+/* push a chain of n linked elements, from first to last */
+static inline void
+lf_stack_push(struct lf_stack_list *list, struct lf_stack_elem *first,
+		struct lf_stack_elem *last, unsigned n)
+{
+	struct lf_stack_head old, new;
+
+	old = list->head;
+	do {
+		last->next = old.top;
+		new.top = first;
+		new.cnt = old.cnt + 1;
+	} while (!lf_stack_cas(&list->head, &old, &new));
+
+	rte_atomic64_add(&list->len, n);
+}
+
+/* pop a chain of n linked elements, returns the first one */
+static inline struct lf_stack_elem *
+lf_stack_pop(struct lf_stack_list *list, unsigned n)
+{
+	struct lf_stack_head old, new;
+	struct lf_stack_elem *elem;
+	uint64_t len;
+	unsigned i;
+
+	/* reserve n elements */
+	do {
+		len = rte_atomic64_read(&list->len);
+		if (unlikely(len < n))
+			return NULL;
+	} while (!rte_atomic64_cmpset((volatile uint64_t *)&list->len.cnt,
+			len, len - n));
+
+	old = list->head;
+	for (;;) {
+		rte_smp_rmb();
+
+		/* walk n elements, the list may be changing meanwhile */
+		elem = old.top;
+		for (i = 0; i < n && elem != NULL; i++)
+			elem = elem->next;
+		if (unlikely(i != n)) {
+			/* stale head, the elements are there */
+			old = list->head;
+			continue;
+		}
+
+		new.top = elem;
+		new.cnt = old.cnt + 1;
+		if (lf_stack_cas(&list->head, &old, &new))
+			return old.top;
+	}
+}
+
+static int
+lf_stack_alloc(struct rte_mempool *mp)
+{
+	struct rte_mempool_lf_stack *s;
+	unsigned n = mp->size;
+	size_t size = sizeof(*s) + n * sizeof(struct lf_stack_elem);
+	unsigned i;
+
+	/* elements are touched by all lcores, keep them on the pool socket */
+	s = rte_zmalloc_socket("mempool-lf-stack",
+			size,
+			RTE_CACHE_LINE_SIZE,
+			mp->socket_id);
+	if (s == NULL) {
+		RTE_LOG(ERR, MEMPOOL, "Cannot allocate lock-free stack!\n");
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < n; i++)
+		s->elems[i].next = i + 1 < n ? &s->elems[i + 1] : NULL;
+	s->free.head.top = n > 0 ? &s->elems[0] : NULL;
+	rte_atomic64_set(&s->free.len, n);
+
+	mp->pool_data = s;
+
+	return 0;
+}
+
+static int
+lf_stack_enqueue(struct rte_mempool *mp, void * const *obj_table,
+		unsigned n)
+{
+	struct rte_mempool_lf_stack *s = mp->pool_data;
+	struct lf_stack_elem *first, *last;
+	unsigned i;
+
+	if (unlikely(n == 0))
+		return 0;
+
+	first = lf_stack_pop(&s->free, n);
+	if (unlikely(first == NULL))
+		return -ENOBUFS;
+
+	/* the last object of the table goes on top */
+	for (i = n, last = first; ; last = last->next) {
+		last->obj = obj_table[--i];
+		if (i == 0)
+			break;
+	}
+
+	lf_stack_push(&s->used, first, last, n);
+
+	return 0;
+}
+
+static int
+lf_stack_dequeue(struct rte_mempool *mp, void **obj_table,
+		unsigned n)
+{
+	struct rte_mempool_lf_stack *s = mp->pool_data;
+	struct lf_stack_elem *first, *last;
+	unsigned i;
+
+	if (unlikely(n == 0))
+		return 0;
+
+	first = lf_stack_pop(&s->used, n);
+	if (unlikely(first == NULL))
+		return -ENOENT;
+
+	for (i = 0, last = first; ; last = last->next) {
+		obj_table[i] = last->obj;
+		if (++i == n)
+			break;
+	}
+
+	lf_stack_push(&s->free, first, last, n);
+
+	return 0;
+}
+
+static unsigned
+lf_stack_get_count(const struct rte_mempool *mp)
+{
+	struct rte_mempool_lf_stack *s = mp->pool_data;
+
+	return rte_atomic64_read(&s->used.len);
+}
+
+static struct rte_mempool_ops ops_lf_stack = {
+	.name = "lf_stack",
+	.alloc = lf_stack_alloc,
+	.free = stack_free,
+	.enqueue = lf_stack_enqueue,
+	.dequeue = lf_stack_dequeue,
+	.get_count = lf_stack_get_count,
+	.supported = NULL,
+};
+
+MEMPOOL_REGISTER_OPS(ops_lf_stack);
+
+#endif /* RTE_ARCH_X86_64 || RTE_ARCH_ARM64 */
@@ -0,0 +1,216 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_memzone.h>
+#include <rte_spinlock.h>
+
+#include "rte_metrics.h"
+
+/* metric names and values, values[RTE_MAX_ETHPORTS] being the global one */
+struct metrics_data {
+	rte_spinlock_t lock;
+	uint16_t cnt_metrics;
+	struct rte_metric_name names[RTE_METRICS_MAX_METRICS];
+	uint64_t values[RTE_MAX_ETHPORTS + 1][RTE_METRICS_MAX_METRICS];
+};
+
+static struct metrics_data *metrics;
+
+static inline int
+metrics_port_index(int port_id)
+{
+	if (port_id == RTE_METRICS_GLOBAL)
+		return RTE_MAX_ETHPORTS;
+	if (port_id < 0 || port_id >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+	return port_id;
+}
+
+int
+rte_metrics_init(int socket_id)
+{
+	const struct rte_memzone *mz;
+
+	if (metrics != NULL)
+		return 0;
+
+	if (rte_eal_process_type() == RTE_PROC_PRIMARY) {
+		mz = rte_memzone_reserve(RTE_METRICS_MZ_NAME,
+				sizeof(struct metrics_data), socket_id, 0);
+		if (mz == NULL)
+			return -ENOMEM;
+		memset(mz->addr, 0, sizeof(struct metrics_data));
+		rte_spinlock_init(&((struct metrics_data *)mz->addr)->lock);
+	} else {
+		mz = rte_memzone_lookup(RTE_METRICS_MZ_NAME);
+		if (mz == NULL)
+			return -ENOENT;
+	}
+	metrics = mz->addr;
+
+	return 0;
+}
+
+int
+rte_metrics_reg_name(const char *name)
+{
+	const char * const names[] = { name };
+
+	return rte_metrics_reg_names(names, 1);
+}
+
+/* looks for a name among the first nb_names, including the set being
+ * registered */
+static int
+metrics_name_exists(const char *name, uint16_t nb_names)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_names; i++)
+		if (strcmp(metrics->names[i].name, name) == 0)
+			return 1;
+	return 0;
+}
+
+int
+rte_metrics_reg_names(const char * const *names, uint16_t cnt_names)
+{
+	uint16_t first, i;
+	int ret;
+
+	if (metrics == NULL)
+		return -ENOENT;
+	if (names == NULL || cnt_names == 0)
+		return -EINVAL;
+	for (i = 0; i < cnt_names; i++)
+		if (names[i] == NULL || names[i][0] == '\0' ||
+				strlen(names[i]) >= RTE_METRICS_MAX_NAME_LEN)
+			return -EINVAL;
+
+	rte_spinlock_lock(&metrics->lock);
+
+	first = metrics->cnt_metrics;
+	if (cnt_names > RTE_METRICS_MAX_METRICS - first) {
+		ret = -ENOSPC;
+		goto out;
+	}
+	for (i = 0; i < cnt_names; i++) {
+		if (metrics_name_exists(names[i], first + i)) {
+			ret = -EEXIST;
+			goto out;
+		}
+		strcpy(metrics->names[first + i].name, names[i]);
+	}
+	metrics->cnt_metrics = first + cnt_names;
+	ret = first;
+
+out:
+	rte_spinlock_unlock(&metrics->lock);
+	return ret;
+}
+
+int
+rte_metrics_get_names(struct rte_metric_name *names, uint16_t capacity)
+{
+	uint16_t cnt;
+
+	if (metrics == NULL)
+		return -ENOENT;
+
+	rte_spinlock_lock(&metrics->lock);
+	cnt = metrics->cnt_metrics;
+	if (names != NULL && cnt <= capacity)
+		memcpy(names, metrics->names, sizeof(*names) * cnt);
+	rte_spinlock_unlock(&metrics->lock);
+
+	return cnt;
+}
+
+int
+rte_metrics_get_values(int port_id, struct rte_metric_value *values,
+		uint16_t capacity)
+{
+	uint16_t cnt, i;
+	int idx;
+
+	if (metrics == NULL)
+		return -ENOENT;
+	idx = metrics_port_index(port_id);
+	if (idx < 0)
+		return idx;
+
+	rte_spinlock_lock(&metrics->lock);
+	cnt = metrics->cnt_metrics;
+	if (values != NULL && cnt <= capacity) {
+		for (i = 0; i < cnt; i++) {
+			values[i].key = i;
+			values[i].value = metrics->values[idx][i];
+		}
+	}
+	rte_spinlock_unlock(&metrics->lock);
+
+	return cnt;
+}
+
+int
+rte_metrics_update_value(int port_id, uint16_t key, const uint64_t value)
+{
+	return rte_metrics_update_values(port_id, key, &value, 1);
+}
+
+int
+rte_metrics_update_values(int port_id, uint16_t key, const uint64_t *values,
+		uint32_t count)
+{
+	int idx, ret = 0;
+
+	if (metrics == NULL)
+		return -ENOENT;
+	idx = metrics_port_index(port_id);
+	if (idx < 0 || values == NULL || count == 0)
+		return -EINVAL;
+
+	rte_spinlock_lock(&metrics->lock);
+	if ((uint32_t)key + count > metrics->cnt_metrics)
+		ret = -EINVAL;
+	else
+		memcpy(&metrics->values[idx][key], values,
+				sizeof(*values) * count);
+	rte_spinlock_unlock(&metrics->lock);
+
+	return ret;
+}
@@ -0,0 +1,203 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_METRICS_H_
+#define _RTE_METRICS_H_
+
+/**
+ * @file
+ * RTE metrics registry
+ *
+ * Publishes named 64-bit metrics, global or per port, next to the port
+ * statistics, so that monitoring tools running as secondary processes can
+ * read them without touching the data path of the primary process.
+ *
+ * Metrics are registered by name, alone or in sets of consecutive keys,
+ * then updated by key. The names and values live in a memzone created by
+ * the primary process, protected by a spinlock, so that any process can
+ * register, update and read metrics. The registry is meant for slow path
+ * updates, e.g. once per second from a timer, not for per packet counters.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Name of the memzone holding the metrics. */
+#define RTE_METRICS_MZ_NAME "rte_metrics"
+
+/** Maximum length of a metric name, including the terminating NUL. */
+#define RTE_METRICS_MAX_NAME_LEN 64
+
+/** Maximum number of metrics. */
+#define RTE_METRICS_MAX_METRICS 256
+
+/** Port ID of the metrics which do not belong to a port. */
+#define RTE_METRICS_GLOBAL -1
+
+/** Name of a metric, its key being its index in the table. */
+struct rte_metric_name {
+	char name[RTE_METRICS_MAX_NAME_LEN]; /**< NUL terminated name. */
+};
+
+/** Value of a metric. */
+struct rte_metric_value {
+	uint16_t key;   /**< Key of the metric, index of its name. */
+	uint64_t value; /**< Value of the metric. */
+};
+
+/**
+ * Initializes the metrics registry.
+ *
+ * The primary process creates the registry, secondary processes attach to
+ * it. It must be called before any other function of this library.
+ *
+ * @param socket_id
+ *  Socket on which to allocate the registry, or SOCKET_ID_ANY.
+ *
+ * @return
+ *  0 on success, -ENOENT if the primary process did not create the
+ *  registry, -ENOMEM if the registry cannot be allocated.
+ */
+int
+rte_metrics_init(int socket_id);
+
+/**
+ * Registers a metric, whose values are initially 0.
+ *
+ * @param name
+ *  Name of the metric, unique and shorter than RTE_METRICS_MAX_NAME_LEN.
+ *
+ * @return
+ *  The key of the metric on success, -EINVAL on invalid name, -EEXIST if
+ *  the name is already registered, -ENOSPC if the registry is full,
+ *  -ENOENT if the registry is not initialized.
+ */
+int
+rte_metrics_reg_name(const char *name);
+
+/**
+ * Registers a set of metrics, whose keys are consecutive so that they can
+ * be updated at once with rte_metrics_update_values().
+ *
+ * @param names
+ *  Names of the metrics.
+ * @param cnt_names
+ *  Number of metrics.
+ *
+ * @return
+ *  The key of the first metric on success, or a negative value as for
+ *  rte_metrics_reg_name(), in which case no metric is registered.
+ */
+int
+rte_metrics_reg_names(const char * const *names, uint16_t cnt_names);
+
+/**
+ * Reads the names of the metrics.
+ *
+ * @param names
+ *  Table of names, indexed by key, or NULL to get the number of metrics.
+ * @param capacity
+ *  Size of the table.
+ *
+ * @return
+ *  The number of metrics, in which case the names are only copied when it
+ *  does not exceed the capacity, or -ENOENT if the registry is not
+ *  initialized.
+ */
+int
+rte_metrics_get_names(struct rte_metric_name *names, uint16_t capacity);
+
+/**
+ * Reads the values of all metrics for a port or the global values.
+ *
+ * @param port_id
+ *  Port ID, or RTE_METRICS_GLOBAL.
+ * @param values
+ *  Table of values, or NULL to get the number of metrics.
+ * @param capacity
+ *  Size of the table.
+ *
+ * @return
+ *  The number of metrics, in which case the values are only copied when it
+ *  does not exceed the capacity, -EINVAL on invalid port, or -ENOENT if the
+ *  registry is not initialized.
+ */
+int
+rte_metrics_get_values(int port_id, struct rte_metric_value *values,
+		uint16_t capacity);
+
+/**
+ * Updates a metric.
+ *
+ * @param port_id
+ *  Port ID, or RTE_METRICS_GLOBAL.
+ * @param key
+ *  Key of the metric.
+ * @param value
+ *  New value.
+ *
+ * @return
+ *  0 on success, -EINVAL on invalid port or key, or -ENOENT if the registry
+ *  is not initialized.
+ */
+int
+rte_metrics_update_value(int port_id, uint16_t key, const uint64_t value);
+
+/**
+ * Updates consecutive metrics at once, readers seeing either all old or all
+ * new values.
+ *
+ * @param port_id
+ *  Port ID, or RTE_METRICS_GLOBAL.
+ * @param key
+ *  Key of the first metric.
+ * @param values
+ *  New values.
+ * @param count
+ *  Number of values.
+ *
+ * @return
+ *  0 on success, -EINVAL on invalid port or keys, or -ENOENT if the
+ *  registry is not initialized.
+ */
+int
+rte_metrics_update_values(int port_id, uint16_t key, const uint64_t *values,
+		uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_METRICS_H_ */
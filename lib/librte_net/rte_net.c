@@ -0,0 +1,528 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdint.h>
+#include <string.h>
+#include <netinet/in.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_prefetch.h>
+#include <rte_vect.h>
+#include <rte_mbuf.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_sctp.h>
+
+#include "rte_net.h"
+
+/* maximum number of VLAN tags and IPv6 extension headers */
+#define NET_VLAN_MAX 2
+#define NET_IPV6_EXT_MAX 8
+
+/* GRE header, without the optional fields */
+struct net_gre_hdr {
+	uint16_t flags;
+	uint16_t proto;
+} __attribute__((__packed__));
+
+#define NET_GRE_C 0x8000 /* checksum present */
+#define NET_GRE_R 0x4000 /* routing present */
+#define NET_GRE_K 0x2000 /* key present */
+#define NET_GRE_S 0x1000 /* sequence number present */
+#define NET_GRE_VER 0x0007
+
+#define NET_VXLAN_I 0x08000000 /* valid VNI */
+
+/*
+ * The fast path matches bytes 12 to 27 of an Ethernet/IPv4 frame, which
+ * hold the EtherType, the version and IHL, the fragment flags and offset
+ * (without DF) and the protocol.
+ */
+#define NET_FAST_OFF 12
+#define NET_FAST_LEN \
+	(sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr))
+
+static const uint8_t net_fast_mask[16] __rte_aligned(16) = {
+	0xff, 0xff, 0xff, 0, 0, 0, 0, 0, 0x3f, 0xff, 0, 0xff, 0, 0, 0, 0,
+};
+static const uint8_t net_fast_tcp[16] __rte_aligned(16) = {
+	0x08, 0x00, 0x45, 0, 0, 0, 0, 0, 0, 0, 0, IPPROTO_TCP, 0, 0, 0, 0,
+};
+static const uint8_t net_fast_udp[16] __rte_aligned(16) = {
+	0x08, 0x00, 0x45, 0, 0, 0, 0, 0, 0, 0, 0, IPPROTO_UDP, 0, 0, 0, 0,
+};
+
+/* Return IPPROTO_TCP or IPPROTO_UDP for a plain TCP or UDP/IPv4 frame. */
+static inline uint8_t
+net_fast_l4_proto(const uint8_t *p)
+{
+#if defined(RTE_ARCH_X86)
+	__m128i v, mask;
+
+	v = _mm_loadu_si128((const __m128i *)p);
+	mask = _mm_load_si128((const __m128i *)net_fast_mask);
+	v = _mm_and_si128(v, mask);
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(v,
+			_mm_load_si128((const __m128i *)net_fast_tcp))) ==
+			0xffff)
+		return IPPROTO_TCP;
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(v,
+			_mm_load_si128((const __m128i *)net_fast_udp))) ==
+			0xffff)
+		return IPPROTO_UDP;
+#elif defined(RTE_ARCH_ARM64)
+	uint8x16_t v;
+	uint64x2_t eq;
+
+	v = vandq_u8(vld1q_u8(p), vld1q_u8(net_fast_mask));
+	eq = vreinterpretq_u64_u8(vceqq_u8(v, vld1q_u8(net_fast_tcp)));
+	if ((vgetq_lane_u64(eq, 0) & vgetq_lane_u64(eq, 1)) == UINT64_MAX)
+		return IPPROTO_TCP;
+	eq = vreinterpretq_u64_u8(vceqq_u8(v, vld1q_u8(net_fast_udp)));
+	if ((vgetq_lane_u64(eq, 0) & vgetq_lane_u64(eq, 1)) == UINT64_MAX)
+		return IPPROTO_UDP;
+#else
+	uint64_t v[2], mask[2], tmpl[2];
+
+	memcpy(v, p, sizeof(v));
+	memcpy(mask, net_fast_mask, sizeof(mask));
+	v[0] &= mask[0];
+	v[1] &= mask[1];
+	memcpy(tmpl, net_fast_tcp, sizeof(tmpl));
+	if (v[0] == tmpl[0] && v[1] == tmpl[1])
+		return IPPROTO_TCP;
+	memcpy(tmpl, net_fast_udp, sizeof(tmpl));
+	if (v[0] == tmpl[0] && v[1] == tmpl[1])
+		return IPPROTO_UDP;
+#endif
+	return 0;
+}
+
+/*
+ * Fill the fields of an Ethernet/IPv4/TCP or Ethernet/IPv4/UDP packet
+ * without IP options, return 0 if the packet is something else.
+ */
+static inline int
+net_parse_ptype_fast(struct rte_mbuf *m)
+{
+	const uint8_t *p = rte_pktmbuf_mtod(m, const uint8_t *);
+	const struct tcp_hdr *th;
+	const struct udp_hdr *uh;
+	uint16_t len = rte_pktmbuf_data_len(m);
+
+	if (len < NET_FAST_LEN + sizeof(struct udp_hdr))
+		return 0;
+
+	switch (net_fast_l4_proto(p + NET_FAST_OFF)) {
+	case IPPROTO_TCP:
+		if (len < NET_FAST_LEN + sizeof(struct tcp_hdr))
+			return 0;
+		th = (const struct tcp_hdr *)(p + NET_FAST_LEN);
+		m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			RTE_PTYPE_L4_TCP;
+		m->l4_len = (th->data_off & 0xf0) >> 2;
+		break;
+	case IPPROTO_UDP:
+		uh = (const struct udp_hdr *)(p + NET_FAST_LEN);
+		if (uh->dst_port == rte_cpu_to_be_16(RTE_NET_VXLAN_PORT))
+			return 0;
+		m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			RTE_PTYPE_L4_UDP;
+		m->l4_len = sizeof(struct udp_hdr);
+		break;
+	default:
+		return 0;
+	}
+	m->l2_len = sizeof(struct ether_hdr);
+	m->l3_len = sizeof(struct ipv4_hdr);
+	m->outer_l2_len = 0;
+	m->outer_l3_len = 0;
+	return 1;
+}
+
+/* Return a header of the first segment, or NULL if it does not fit. */
+static inline const void *
+net_hdr(const struct rte_mbuf *m, uint32_t off, uint32_t len)
+{
+	if (off + len > rte_pktmbuf_data_len(m))
+		return NULL;
+	return rte_pktmbuf_mtod_offset(m, const void *, off);
+}
+
+/*
+ * Parse an Ethernet header and its VLAN tags at *off, return the L2 type
+ * and the next EtherType in *proto, in big endian.
+ */
+static uint32_t
+net_parse_l2(const struct rte_mbuf *m, uint32_t *off, uint16_t *proto)
+{
+	const struct ether_hdr *eh;
+	const struct vlan_hdr *vh;
+	uint32_t ptype = RTE_PTYPE_L2_ETHER;
+	unsigned int i;
+
+	eh = net_hdr(m, *off, sizeof(*eh));
+	if (eh == NULL)
+		return RTE_PTYPE_UNKNOWN;
+	*off += sizeof(*eh);
+	*proto = eh->ether_type;
+
+	for (i = 0; i < NET_VLAN_MAX; i++) {
+		if (*proto != rte_cpu_to_be_16(ETHER_TYPE_VLAN) &&
+		    *proto != rte_cpu_to_be_16(ETHER_TYPE_QINQ))
+			break;
+		vh = net_hdr(m, *off, sizeof(*vh));
+		if (vh == NULL)
+			return ptype;
+		/* two tags are QinQ, whatever the outer TPID */
+		ptype = i > 0 ||
+			*proto == rte_cpu_to_be_16(ETHER_TYPE_QINQ) ?
+			RTE_PTYPE_L2_ETHER_QINQ : RTE_PTYPE_L2_ETHER_VLAN;
+		*off += sizeof(*vh);
+		*proto = vh->eth_proto;
+	}
+
+	if (ptype != RTE_PTYPE_L2_ETHER)
+		return ptype;
+	switch (rte_be_to_cpu_16(*proto)) {
+	case ETHER_TYPE_ARP:
+		return RTE_PTYPE_L2_ETHER_ARP;
+	case ETHER_TYPE_LLDP:
+		return RTE_PTYPE_L2_ETHER_LLDP;
+	case ETHER_TYPE_1588:
+		return RTE_PTYPE_L2_ETHER_TIMESYNC;
+	default:
+		return ptype;
+	}
+}
+
+/*
+ * Parse an IPv4 or IPv6 header and its options or extensions at *off,
+ * return the L3 type, RTE_PTYPE_L4_FRAG for a fragment, and the next
+ * protocol in *l4_proto.
+ */
+static uint32_t
+net_parse_l3(const struct rte_mbuf *m, uint16_t proto, uint32_t *off,
+	     uint8_t *l4_proto)
+{
+	const struct ipv4_hdr *ip4;
+	const struct ipv6_hdr *ip6;
+	const uint8_t *ext;
+	uint32_t ptype;
+	unsigned int i;
+	uint8_t ihl;
+
+	if (proto == rte_cpu_to_be_16(ETHER_TYPE_IPv4)) {
+		ip4 = net_hdr(m, *off, sizeof(*ip4));
+		if (ip4 == NULL || (ip4->version_ihl >> 4) != 4)
+			return RTE_PTYPE_UNKNOWN;
+		ihl = (ip4->version_ihl & IPV4_HDR_IHL_MASK) *
+			IPV4_IHL_MULTIPLIER;
+		if (ihl < sizeof(*ip4))
+			return RTE_PTYPE_UNKNOWN;
+		ptype = ihl == sizeof(*ip4) ?
+			RTE_PTYPE_L3_IPV4 : RTE_PTYPE_L3_IPV4_EXT;
+		*off += ihl;
+		*l4_proto = ip4->next_proto_id;
+		if (ip4->fragment_offset & rte_cpu_to_be_16(
+				IPV4_HDR_MF_FLAG | IPV4_HDR_OFFSET_MASK))
+			ptype |= RTE_PTYPE_L4_FRAG;
+		return ptype;
+	}
+
+	if (proto != rte_cpu_to_be_16(ETHER_TYPE_IPv6))
+		return RTE_PTYPE_UNKNOWN;
+	ip6 = net_hdr(m, *off, sizeof(*ip6));
+	if (ip6 == NULL ||
+	    (rte_be_to_cpu_32(ip6->vtc_flow) >> 28) != 6)
+		return RTE_PTYPE_UNKNOWN;
+	ptype = RTE_PTYPE_L3_IPV6;
+	*off += sizeof(*ip6);
+	*l4_proto = ip6->proto;
+	for (i = 0; i < NET_IPV6_EXT_MAX; i++) {
+		switch (*l4_proto) {
+		case IPPROTO_HOPOPTS:
+		case IPPROTO_ROUTING:
+		case IPPROTO_DSTOPTS:
+			/* next header and length in 8-byte units */
+			ext = net_hdr(m, *off, 2);
+			if (ext == NULL)
+				return RTE_PTYPE_L3_IPV6_EXT_UNKNOWN;
+			*l4_proto = ext[0];
+			*off += (ext[1] + 1) * 8;
+			ptype = RTE_PTYPE_L3_IPV6_EXT;
+			break;
+		case IPPROTO_FRAGMENT:
+			ext = net_hdr(m, *off, 8);
+			if (ext == NULL)
+				return RTE_PTYPE_L3_IPV6_EXT_UNKNOWN;
+			*l4_proto = ext[0];
+			*off += 8;
+			return RTE_PTYPE_L3_IPV6_EXT | RTE_PTYPE_L4_FRAG;
+		default:
+			return ptype;
+		}
+	}
+	return RTE_PTYPE_L3_IPV6_EXT_UNKNOWN;
+}
+
+/* Parse a TCP, UDP or SCTP header at off, return the L4 type. */
+static uint32_t
+net_parse_l4(const struct rte_mbuf *m, uint8_t l4_proto, uint32_t off,
+	     uint8_t *l4_len)
+{
+	const struct tcp_hdr *th;
+
+	switch (l4_proto) {
+	case IPPROTO_TCP:
+		th = net_hdr(m, off, sizeof(*th));
+		if (th != NULL)
+			*l4_len = (th->data_off & 0xf0) >> 2;
+		return RTE_PTYPE_L4_TCP;
+	case IPPROTO_UDP:
+		if (net_hdr(m, off, sizeof(struct udp_hdr)) != NULL)
+			*l4_len = sizeof(struct udp_hdr);
+		return RTE_PTYPE_L4_UDP;
+	case IPPROTO_SCTP:
+		if (net_hdr(m, off, sizeof(struct sctp_hdr)) != NULL)
+			*l4_len = sizeof(struct sctp_hdr);
+		return RTE_PTYPE_L4_SCTP;
+	case IPPROTO_ICMP:
+	case IPPROTO_ICMPV6:
+		return RTE_PTYPE_L4_ICMP;
+	default:
+		return RTE_PTYPE_L4_NONFRAG;
+	}
+}
+
+/*
+ * Recognize a tunnel after the outer L3 header, return its type, the
+ * length of the outer UDP and tunnel headers, and the EtherType of the
+ * inner packet.
+ */
+static uint32_t
+net_parse_tunnel(const struct rte_mbuf *m, uint8_t l4_proto, uint32_t off,
+		 uint8_t *tunnel_len, uint16_t *proto)
+{
+	const struct net_gre_hdr *gh;
+	const struct udp_hdr *uh;
+	const struct vxlan_hdr *vh;
+	uint16_t flags;
+
+	switch (l4_proto) {
+	case IPPROTO_IPIP:
+		*proto = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+		return RTE_PTYPE_TUNNEL_IP;
+	case IPPROTO_IPV6:
+		*proto = rte_cpu_to_be_16(ETHER_TYPE_IPv6);
+		return RTE_PTYPE_TUNNEL_IP;
+	case IPPROTO_GRE:
+		gh = net_hdr(m, off, sizeof(*gh));
+		if (gh == NULL)
+			return RTE_PTYPE_UNKNOWN;
+		flags = rte_be_to_cpu_16(gh->flags);
+		if (flags & (NET_GRE_R | NET_GRE_VER))
+			return RTE_PTYPE_UNKNOWN;
+		*tunnel_len = sizeof(*gh);
+		if (flags & NET_GRE_C)
+			*tunnel_len += 4;
+		if (flags & NET_GRE_K)
+			*tunnel_len += 4;
+		if (flags & NET_GRE_S)
+			*tunnel_len += 4;
+		*proto = gh->proto;
+		if (gh->proto == rte_cpu_to_be_16(ETHER_TYPE_TEB) &&
+		    (flags & NET_GRE_K))
+			return RTE_PTYPE_TUNNEL_NVGRE;
+		return RTE_PTYPE_TUNNEL_GRE;
+	case IPPROTO_UDP:
+		uh = net_hdr(m, off, sizeof(*uh) + sizeof(*vh));
+		if (uh == NULL ||
+		    uh->dst_port != rte_cpu_to_be_16(RTE_NET_VXLAN_PORT))
+			return RTE_PTYPE_UNKNOWN;
+		vh = (const struct vxlan_hdr *)(uh + 1);
+		if (!(vh->vx_flags & rte_cpu_to_be_32(NET_VXLAN_I)))
+			return RTE_PTYPE_UNKNOWN;
+		*tunnel_len = sizeof(*uh) + sizeof(*vh);
+		*proto = rte_cpu_to_be_16(ETHER_TYPE_TEB);
+		return RTE_PTYPE_TUNNEL_VXLAN;
+	default:
+		return RTE_PTYPE_UNKNOWN;
+	}
+}
+
+/* Convert the types of the headers of an inner packet. */
+static uint32_t
+net_ptype_inner(uint32_t ptype)
+{
+	uint32_t inner = 0;
+
+	switch (ptype & RTE_PTYPE_L2_MASK) {
+	case RTE_PTYPE_UNKNOWN:
+		break;
+	case RTE_PTYPE_L2_ETHER_VLAN:
+		inner |= RTE_PTYPE_INNER_L2_ETHER_VLAN;
+		break;
+	case RTE_PTYPE_L2_ETHER_QINQ:
+		inner |= RTE_PTYPE_INNER_L2_ETHER_QINQ;
+		break;
+	default:
+		inner |= RTE_PTYPE_INNER_L2_ETHER;
+		break;
+	}
+	switch (ptype & RTE_PTYPE_L3_MASK) {
+	case RTE_PTYPE_L3_IPV4:
+		inner |= RTE_PTYPE_INNER_L3_IPV4;
+		break;
+	case RTE_PTYPE_L3_IPV4_EXT:
+		inner |= RTE_PTYPE_INNER_L3_IPV4_EXT;
+		break;
+	case RTE_PTYPE_L3_IPV6:
+		inner |= RTE_PTYPE_INNER_L3_IPV6;
+		break;
+	case RTE_PTYPE_L3_IPV6_EXT:
+		inner |= RTE_PTYPE_INNER_L3_IPV6_EXT;
+		break;
+	case RTE_PTYPE_L3_IPV6_EXT_UNKNOWN:
+		inner |= RTE_PTYPE_INNER_L3_IPV6_EXT_UNKNOWN;
+		break;
+	}
+	/* the inner L4 types are the outer ones shifted */
+	return inner | (ptype & RTE_PTYPE_L4_MASK) << 16;
+}
+
+uint32_t
+rte_net_get_ptype(const struct rte_mbuf *m,
+		  struct rte_net_hdr_lens *hdr_lens)
+{
+	struct rte_net_hdr_lens lens;
+	uint32_t ptype, inner, tunnel;
+	uint32_t off = 0;
+	uint16_t proto;
+	uint8_t l4_proto;
+
+	memset(&lens, 0, sizeof(lens));
+
+	ptype = net_parse_l2(m, &off, &proto);
+	if (ptype == RTE_PTYPE_UNKNOWN)
+		goto out;
+	lens.l2_len = off;
+
+	ptype |= net_parse_l3(m, proto, &off, &l4_proto);
+	if (!(ptype & RTE_PTYPE_L3_MASK))
+		goto out;
+	lens.l3_len = off - lens.l2_len;
+	if ((ptype & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_FRAG)
+		goto out;
+
+	tunnel = net_parse_tunnel(m, l4_proto, off, &lens.tunnel_len,
+				  &proto);
+	if (tunnel == RTE_PTYPE_UNKNOWN) {
+		ptype |= net_parse_l4(m, l4_proto, off, &lens.l4_len);
+		goto out;
+	}
+	ptype |= tunnel;
+	off += lens.tunnel_len;
+
+	/* the inner packet starts with Ethernet or directly with IP */
+	inner = 0;
+	if (proto == rte_cpu_to_be_16(ETHER_TYPE_TEB)) {
+		inner = net_parse_l2(m, &off, &proto);
+		if (inner == RTE_PTYPE_UNKNOWN)
+			goto out;
+		lens.inner_l2_len = off - lens.l2_len - lens.l3_len -
+			lens.tunnel_len;
+	}
+	inner |= net_parse_l3(m, proto, &off, &l4_proto);
+	if (inner & RTE_PTYPE_L3_MASK) {
+		lens.inner_l3_len = off - lens.l2_len - lens.l3_len -
+			lens.tunnel_len - lens.inner_l2_len;
+		if ((inner & RTE_PTYPE_L4_MASK) != RTE_PTYPE_L4_FRAG)
+			inner |= net_parse_l4(m, l4_proto, off,
+					      &lens.inner_l4_len);
+	}
+	ptype |= net_ptype_inner(inner);
+
+out:
+	if (hdr_lens != NULL)
+		*hdr_lens = lens;
+	return ptype;
+}
+
+/* Parse a packet which is not handled by the fast path. */
+static void
+net_parse_ptype_slow(struct rte_mbuf *m)
+{
+	struct rte_net_hdr_lens lens;
+
+	m->packet_type = rte_net_get_ptype(m, &lens);
+	if (m->packet_type & RTE_PTYPE_TUNNEL_MASK) {
+		m->outer_l2_len = lens.l2_len;
+		m->outer_l3_len = lens.l3_len;
+		m->l2_len = lens.tunnel_len + lens.inner_l2_len;
+		m->l3_len = lens.inner_l3_len;
+		m->l4_len = lens.inner_l4_len;
+	} else {
+		m->outer_l2_len = 0;
+		m->outer_l3_len = 0;
+		m->l2_len = lens.l2_len;
+		m->l3_len = lens.l3_len;
+		m->l4_len = lens.l4_len;
+	}
+}
+
+void
+rte_net_parse_ptype_burst(struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (i + 1 < nb_pkts)
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[i + 1], void *));
+		if (!net_parse_ptype_fast(pkts[i]))
+			net_parse_ptype_slow(pkts[i]);
+	}
+}
+
+uint16_t
+rte_net_ptype_rx_callback(uint8_t port __rte_unused,
+		uint16_t queue __rte_unused, struct rte_mbuf **pkts,
+		uint16_t nb_pkts, uint16_t max_pkts __rte_unused,
+		void *user_param __rte_unused)
+{
+	rte_net_parse_ptype_burst(pkts, nb_pkts);
+	return nb_pkts;
+}
@@ -0,0 +1,205 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_NET_H_
+#define _RTE_NET_H_
+
+/**
+ * @file
+ *
+ * Network helpers operating on packets
+ *
+ * A software packet type parser fills the packet_type and header length
+ * fields of the mbufs received from ports which do not report them, see
+ * rte_eth_dev_get_supported_ptypes(). It recognizes:
+ *  - Ethernet, with up to two VLAN tags (802.1Q or QinQ), ARP, LLDP and
+ *    IEEE 1588 frames;
+ *  - IPv4, with options, and IPv6, with hop-by-hop, routing, destination
+ *    and fragment extension headers;
+ *  - TCP, UDP, SCTP and ICMP, and IP fragments;
+ *  - IP in IP, GRE and NVGRE tunnels, and VXLAN on UDP port 4789, with
+ *    their inner headers.
+ * The headers must be in the first segment of the packet.
+ */
+
+#include <errno.h>
+
+#include <rte_mbuf.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** UDP destination port of VXLAN, as assigned by IANA. */
+#define RTE_NET_VXLAN_PORT 4789
+
+/**
+ * Lengths of the headers of a packet, in bytes.
+ */
+struct rte_net_hdr_lens {
+	uint8_t l2_len;        /**< Ethernet header, with VLAN tags. */
+	uint16_t l3_len;       /**< IP header, with options or extensions. */
+	uint8_t l4_len;        /**< TCP, UDP or SCTP header. */
+	uint8_t tunnel_len;    /**< Outer UDP and tunnel headers. */
+	uint8_t inner_l2_len;  /**< Inner Ethernet header, if any. */
+	uint16_t inner_l3_len; /**< Inner IP header. */
+	uint8_t inner_l4_len;  /**< Inner TCP, UDP or SCTP header. */
+};
+
+/**
+ * Parse the headers of a packet.
+ *
+ * For a tunnel, the outer L4 type is not reported: the tunnel type and the
+ * inner types are, and l4_len is 0.
+ *
+ * @param m
+ *   The packet to parse; it is not modified.
+ * @param hdr_lens
+ *   Filled with the lengths of the recognized headers, the others are 0.
+ *   May be NULL.
+ * @return
+ *   The packet type, an OR of RTE_PTYPE_* values, RTE_PTYPE_UNKNOWN if the
+ *   packet is not Ethernet.
+ */
+uint32_t rte_net_get_ptype(const struct rte_mbuf *m,
+		struct rte_net_hdr_lens *hdr_lens);
+
+/**
+ * Parse the headers of a burst of packets and fill their packet_type,
+ * l2_len, l3_len and l4_len fields.
+ *
+ * The header lengths follow the layout of the TX offloads: for a tunnel,
+ * outer_l2_len and outer_l3_len give the outer headers, l2_len covers the
+ * outer UDP header, the tunnel header and the inner Ethernet header, and
+ * l3_len and l4_len give the inner headers. outer_l2_len and outer_l3_len
+ * are set to 0 otherwise.
+ *
+ * Ethernet/IPv4/TCP and Ethernet/IPv4/UDP packets without IP options are
+ * classified with vector instructions.
+ *
+ * @param pkts
+ *   The packets to parse.
+ * @param nb_pkts
+ *   The number of packets in pkts.
+ */
+void rte_net_parse_ptype_burst(struct rte_mbuf **pkts, uint16_t nb_pkts);
+
+/**
+ * RX callback calling rte_net_parse_ptype_burst(), to be installed with
+ * rte_eth_add_rx_callback() on a port which does not report packet types.
+ * user_param is not used.
+ *
+ * @return
+ *   nb_pkts, no packet is dropped.
+ */
+uint16_t rte_net_ptype_rx_callback(uint8_t port, uint16_t queue,
+		struct rte_mbuf **pkts, uint16_t nb_pkts, uint16_t max_pkts,
+		void *user_param);
+
+/**
+ * Prepare the checksum fields of a packet for the TX checksum offloads,
+ * as documented with the PKT_TX_* flags and expected by most PMDs:
+ *  - the IPv4 checksum is set to 0 with PKT_TX_IP_CKSUM;
+ *  - the L4 checksum is set to the pseudo-header checksum with
+ *    PKT_TX_TCP_CKSUM or PKT_TX_UDP_CKSUM, and to the pseudo-header
+ *    checksum without the length with PKT_TX_TCP_SEG.
+ * For tunneled packets, the inner headers are prepared.
+ *
+ * The IPv4 header must not have options.
+ *
+ * @param m
+ *   The packet to prepare; its headers must be writable.
+ * @return
+ *   - 0 on success.
+ *   - -ENOTSUP if the headers are not in the first segment.
+ */
+static inline int
+rte_net_intel_cksum_prepare(struct rte_mbuf *m)
+{
+	struct ipv4_hdr *ipv4_hdr = NULL;
+	struct ipv6_hdr *ipv6_hdr = NULL;
+	struct tcp_hdr *tcp_hdr;
+	struct udp_hdr *udp_hdr;
+	uint64_t ol_flags = m->ol_flags;
+	uint64_t l4_req = ol_flags & PKT_TX_L4_MASK;
+	uint32_t l3_off = m->l2_len;
+	uint16_t l4_sum;
+
+	if (!(ol_flags & (PKT_TX_IP_CKSUM | PKT_TX_L4_MASK | PKT_TX_TCP_SEG)))
+		return 0;
+
+	if (ol_flags & (PKT_TX_OUTER_IPV4 | PKT_TX_OUTER_IPV6))
+		l3_off += m->outer_l2_len + m->outer_l3_len;
+	if (unlikely(rte_pktmbuf_data_len(m) < l3_off + m->l3_len + m->l4_len))
+		return -ENOTSUP;
+
+	if (ol_flags & PKT_TX_IPV4) {
+		ipv4_hdr = rte_pktmbuf_mtod_offset(m, struct ipv4_hdr *,
+			l3_off);
+		if (ol_flags & PKT_TX_IP_CKSUM)
+			ipv4_hdr->hdr_checksum = 0;
+	} else if (ol_flags & PKT_TX_IPV6)
+		ipv6_hdr = rte_pktmbuf_mtod_offset(m, struct ipv6_hdr *,
+			l3_off);
+	else
+		return 0;
+
+	if (!(ol_flags & PKT_TX_TCP_SEG) && l4_req != PKT_TX_TCP_CKSUM &&
+			l4_req != PKT_TX_UDP_CKSUM)
+		return 0;
+
+	if (ipv4_hdr != NULL)
+		l4_sum = rte_ipv4_phdr_cksum(ipv4_hdr, ol_flags);
+	else
+		l4_sum = rte_ipv6_phdr_cksum(ipv6_hdr, ol_flags);
+
+	if (l4_req == PKT_TX_UDP_CKSUM) {
+		udp_hdr = rte_pktmbuf_mtod_offset(m, struct udp_hdr *,
+			l3_off + m->l3_len);
+		udp_hdr->dgram_cksum = l4_sum;
+	} else {
+		tcp_hdr = rte_pktmbuf_mtod_offset(m, struct tcp_hdr *,
+			l3_off + m->l3_len);
+		tcp_hdr->cksum = l4_sum;
+	}
+
+	return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_NET_H_ */
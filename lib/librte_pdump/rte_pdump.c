@@ -43,6 +43,10 @@
 #include <rte_memcpy.h>
 #include <rte_mbuf.h>
 #include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
 #include <rte_lcore.h>
 #include <rte_log.h>
 #include <rte_errno.h>
@@ -84,7 +88,7 @@ struct pdump_request {
 			uint16_t queue;
 			struct rte_ring *ring;
 			struct rte_mempool *mp;
-			void *filter;
+			struct rte_pdump_filter filter;
 		} en_v1;
 		struct disable_v1 {
 			char device[DEVICE_ID_SIZE];
@@ -102,18 +106,171 @@ struct pdump_response {
 	int32_t err_value;
 };
 
+/* match rules of a capture, in packet byte order */
+struct pdump_filter {
+	uint32_t match;
+	uint16_t ether_type;
+	uint16_t src_port;
+	uint16_t dst_port;
+	uint8_t proto;
+	uint8_t ip_version;
+	uint8_t src_addr[16];
+	uint8_t src_mask[16];
+	uint8_t dst_addr[16];
+	uint8_t dst_mask[16];
+};
+
 static struct pdump_rxtx_cbs {
 	struct rte_ring *ring;
 	struct rte_mempool *mp;
 	struct rte_eth_rxtx_callback *cb;
-	void *filter;
+	struct rte_pdump_stats *stats;
+	uint16_t queue;
+	uint32_t snaplen;
+	uint32_t sample_rate;
+	uint32_t sample_cnt;
+	struct pdump_filter filter;
 } rx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT],
 tx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
 
+static void
+pdump_filter_setup(struct pdump_filter *pf, const struct rte_pdump_filter *f)
+{
+	unsigned i, len;
+
+	memset(pf, 0, sizeof(*pf));
+	pf->match = f->match;
+	pf->ether_type = rte_cpu_to_be_16(f->ether_type);
+	pf->src_port = rte_cpu_to_be_16(f->src_port);
+	pf->dst_port = rte_cpu_to_be_16(f->dst_port);
+	pf->proto = f->proto;
+	pf->ip_version = f->ip_version;
+
+	len = (f->ip_version == 4) ? sizeof(f->src_addr.ipv4) :
+		sizeof(f->src_addr.ipv6);
+	for (i = 0; i < len; i++) {
+		if (f->src_depth > i * 8)
+			pf->src_mask[i] = (uint8_t)(0xff00 >>
+				RTE_MIN(f->src_depth - i * 8, 8u));
+		if (f->dst_depth > i * 8)
+			pf->dst_mask[i] = (uint8_t)(0xff00 >>
+				RTE_MIN(f->dst_depth - i * 8, 8u));
+		pf->src_addr[i] = f->src_addr.ipv6[i] & pf->src_mask[i];
+		pf->dst_addr[i] = f->dst_addr.ipv6[i] & pf->dst_mask[i];
+	}
+}
+
 static inline int
-pdump_pktmbuf_copy_data(struct rte_mbuf *seg, const struct rte_mbuf *m)
+pdump_addr_match(const uint8_t *a, const uint8_t *addr, const uint8_t *mask,
+		unsigned len)
 {
-	if (rte_pktmbuf_tailroom(seg) < m->data_len) {
+	unsigned i;
+
+	for (i = 0; i < len; i++)
+		if ((a[i] & mask[i]) != addr[i])
+			return 0;
+	return 1;
+}
+
+/* returns 1 if the packet matches the rules of the capture, 0 otherwise */
+static inline int
+pdump_filter_match(const struct pdump_filter *pf, const struct rte_mbuf *m)
+{
+	const struct ether_hdr *eth;
+	const struct vlan_hdr *vh;
+	const struct ipv4_hdr *ip4;
+	const struct ipv6_hdr *ip6;
+	const uint16_t *ports;
+	const uint8_t *src, *dst;
+	uint32_t off, alen;
+	uint16_t type;
+	uint8_t proto;
+	int l4;
+
+	if (m->data_len < sizeof(*eth))
+		return 0;
+	eth = rte_pktmbuf_mtod(m, const struct ether_hdr *);
+	type = eth->ether_type;
+	off = sizeof(*eth);
+	if (type == rte_cpu_to_be_16(ETHER_TYPE_VLAN)) {
+		if (m->data_len < off + sizeof(*vh))
+			return 0;
+		vh = rte_pktmbuf_mtod_offset(m, const struct vlan_hdr *, off);
+		type = vh->eth_proto;
+		off += sizeof(*vh);
+	}
+
+	if ((pf->match & RTE_PDUMP_MATCH_ETHER_TYPE) &&
+			type != pf->ether_type)
+		return 0;
+	if ((pf->match & ~RTE_PDUMP_MATCH_ETHER_TYPE) == 0)
+		return 1;
+
+	if (type == rte_cpu_to_be_16(ETHER_TYPE_IPv4)) {
+		if (m->data_len < off + sizeof(*ip4))
+			return 0;
+		ip4 = rte_pktmbuf_mtod_offset(m, const struct ipv4_hdr *, off);
+		src = (const uint8_t *)&ip4->src_addr;
+		dst = (const uint8_t *)&ip4->dst_addr;
+		alen = sizeof(ip4->src_addr);
+		proto = ip4->next_proto_id;
+		off += (ip4->version_ihl & IPV4_HDR_IHL_MASK) *
+			IPV4_IHL_MULTIPLIER;
+		/* only the first fragment carries the L4 header */
+		l4 = (ip4->fragment_offset &
+			rte_cpu_to_be_16(IPV4_HDR_OFFSET_MASK)) == 0;
+		if (pf->ip_version != 4 && (pf->match &
+				(RTE_PDUMP_MATCH_SRC_ADDR |
+				RTE_PDUMP_MATCH_DST_ADDR)))
+			return 0;
+	} else if (type == rte_cpu_to_be_16(ETHER_TYPE_IPv6)) {
+		if (m->data_len < off + sizeof(*ip6))
+			return 0;
+		ip6 = rte_pktmbuf_mtod_offset(m, const struct ipv6_hdr *, off);
+		src = ip6->src_addr;
+		dst = ip6->dst_addr;
+		alen = sizeof(ip6->src_addr);
+		proto = ip6->proto;
+		off += sizeof(*ip6);
+		l4 = 1;
+		if (pf->ip_version != 6 && (pf->match &
+				(RTE_PDUMP_MATCH_SRC_ADDR |
+				RTE_PDUMP_MATCH_DST_ADDR)))
+			return 0;
+	} else
+		return 0;
+
+	if ((pf->match & RTE_PDUMP_MATCH_PROTO) && proto != pf->proto)
+		return 0;
+	if ((pf->match & RTE_PDUMP_MATCH_SRC_ADDR) &&
+			!pdump_addr_match(src, pf->src_addr, pf->src_mask, alen))
+		return 0;
+	if ((pf->match & RTE_PDUMP_MATCH_DST_ADDR) &&
+			!pdump_addr_match(dst, pf->dst_addr, pf->dst_mask, alen))
+		return 0;
+	if ((pf->match & (RTE_PDUMP_MATCH_SRC_PORT |
+			RTE_PDUMP_MATCH_DST_PORT)) == 0)
+		return 1;
+
+	if (!l4 || (proto != IPPROTO_TCP && proto != IPPROTO_UDP &&
+			proto != IPPROTO_SCTP))
+		return 0;
+	if (m->data_len < off + 2 * sizeof(uint16_t))
+		return 0;
+	ports = rte_pktmbuf_mtod_offset(m, const uint16_t *, off);
+	if ((pf->match & RTE_PDUMP_MATCH_SRC_PORT) && ports[0] != pf->src_port)
+		return 0;
+	if ((pf->match & RTE_PDUMP_MATCH_DST_PORT) && ports[1] != pf->dst_port)
+		return 0;
+
+	return 1;
+}
+
+static inline int
+pdump_pktmbuf_copy_data(struct rte_mbuf *seg, const struct rte_mbuf *m,
+			uint16_t len)
+{
+	if (rte_pktmbuf_tailroom(seg) < len) {
 		RTE_LOG(ERR, PDUMP,
 			"User mempool: insufficient data_len of mbuf\n");
 		return -EINVAL;
@@ -126,7 +283,7 @@ pdump_pktmbuf_copy_data(struct rte_mbuf *seg, const struct rte_mbuf *m)
 	seg->ol_flags = m->ol_flags;
 	seg->packet_type = m->packet_type;
 	seg->vlan_tci_outer = m->vlan_tci_outer;
-	seg->data_len = m->data_len;
+	seg->data_len = len;
 	seg->pkt_len = seg->data_len;
 	rte_memcpy(rte_pktmbuf_mtod(seg, void *),
 			rte_pktmbuf_mtod(m, void *),
@@ -135,11 +292,16 @@ pdump_pktmbuf_copy_data(struct rte_mbuf *seg, const struct rte_mbuf *m)
 	return 0;
 }
 
+/*
+ * Copies the first snaplen bytes of the packet (all of it if snaplen is 0)
+ * and records the original length in the copy.
+ */
 static inline struct rte_mbuf *
-pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp)
+pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp,
+		uint32_t snaplen)
 {
 	struct rte_mbuf *m_dup, *seg, **prev;
-	uint32_t pktlen;
+	uint32_t pktlen, caplen, left;
 	uint8_t nseg;
 
 	m_dup = rte_pktmbuf_alloc(mp);
@@ -149,22 +311,27 @@ pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp)
 	seg = m_dup;
 	prev = &seg->next;
 	pktlen = m->pkt_len;
+	caplen = (snaplen != 0 && snaplen < pktlen) ? snaplen : pktlen;
+	left = caplen;
 	nseg = 0;
 
 	do {
 		nseg++;
-		if (pdump_pktmbuf_copy_data(seg, m) < 0) {
+		if (pdump_pktmbuf_copy_data(seg, m,
+				RTE_MIN(left, (uint32_t)m->data_len)) < 0) {
 			rte_pktmbuf_free(m_dup);
 			return NULL;
 		}
+		left -= seg->data_len;
 		*prev = seg;
 		prev = &seg->next;
-	} while ((m = m->next) != NULL &&
+	} while (left != 0 && (m = m->next) != NULL &&
 			(seg = rte_pktmbuf_alloc(mp)) != NULL);
 
 	*prev = NULL;
 	m_dup->nb_segs = nseg;
-	m_dup->pkt_len = pktlen;
+	m_dup->pkt_len = caplen;
+	RTE_PDUMP_MBUF_ORIG_LEN(m_dup) = pktlen;
 
 	/* Allocation of new indirect segment failed */
 	if (unlikely(seg == NULL)) {
@@ -177,27 +344,53 @@ pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp)
 }
 
 static inline void
-pdump_copy(struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
+pdump_copy(uint8_t port, struct rte_mbuf **pkts, uint16_t nb_pkts,
+	void *user_params)
 {
 	unsigned i;
 	int ring_enq;
-	uint16_t d_pkts = 0;
+	uint16_t d_pkts = 0, s_pkts = 0;
 	struct rte_mbuf *dup_bufs[nb_pkts];
 	struct pdump_rxtx_cbs *cbs;
 	struct rte_ring *ring;
 	struct rte_mempool *mp;
 	struct rte_mbuf *p;
+	uint64_t tsc;
 
 	cbs  = user_params;
 	ring = cbs->ring;
 	mp = cbs->mp;
+	tsc = rte_rdtsc();
 	for (i = 0; i < nb_pkts; i++) {
-		p = pdump_pktmbuf_copy(pkts[i], mp);
-		if (p)
+		/* drop unwanted packets before touching the capture pool */
+		if (cbs->filter.match != 0 &&
+				!pdump_filter_match(&cbs->filter, pkts[i]))
+			continue;
+		if (cbs->sample_rate > 1) {
+			if (++cbs->sample_cnt < cbs->sample_rate)
+				continue;
+			cbs->sample_cnt = 0;
+		}
+		s_pkts++;
+		p = pdump_pktmbuf_copy(pkts[i], mp, cbs->snaplen);
+		if (p) {
+			p->port = port;
+			RTE_PDUMP_MBUF_QUEUE(p) = cbs->queue;
+			RTE_PDUMP_MBUF_TSC(p) = tsc;
 			dup_bufs[d_pkts++] = p;
+		}
 	}
 
-	ring_enq = rte_ring_enqueue_burst(ring, (void *)dup_bufs, d_pkts);
+	ring_enq = 0;
+	if (d_pkts != 0)
+		ring_enq = rte_ring_enqueue_burst(ring, (void *)dup_bufs,
+						d_pkts);
+	if (cbs->stats != NULL) {
+		cbs->stats->accepted += ring_enq;
+		cbs->stats->filtered += nb_pkts - s_pkts;
+		cbs->stats->nombuf += s_pkts - d_pkts;
+		cbs->stats->ringfull += d_pkts - ring_enq;
+	}
 	if (unlikely(ring_enq < d_pkts)) {
 		RTE_LOG(DEBUG, PDUMP,
 			"only %d of packets enqueued to ring\n", ring_enq);
@@ -208,20 +401,20 @@ pdump_copy(struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
 }
 
 static uint16_t
-pdump_rx(uint8_t port __rte_unused, uint16_t qidx __rte_unused,
+pdump_rx(uint8_t port, uint16_t qidx __rte_unused,
 	struct rte_mbuf **pkts, uint16_t nb_pkts,
 	uint16_t max_pkts __rte_unused,
 	void *user_params)
 {
-	pdump_copy(pkts, nb_pkts, user_params);
+	pdump_copy(port, pkts, nb_pkts, user_params);
 	return nb_pkts;
 }
 
 static uint16_t
-pdump_tx(uint8_t port __rte_unused, uint16_t qidx __rte_unused,
+pdump_tx(uint8_t port, uint16_t qidx __rte_unused,
 		struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
 {
-	pdump_copy(pkts, nb_pkts, user_params);
+	pdump_copy(port, pkts, nb_pkts, user_params);
 	return nb_pkts;
 }
 
@@ -251,6 +444,7 @@ pdump_get_dombdf(char *device_id, char *domBDF, size_t len)
 static int
 pdump_regitser_rx_callbacks(uint16_t end_q, uint8_t port, uint16_t queue,
 				struct rte_ring *ring, struct rte_mempool *mp,
+				const struct rte_pdump_filter *filter,
 				uint16_t operation)
 {
 	uint16_t qid;
@@ -269,6 +463,16 @@ pdump_regitser_rx_callbacks(uint16_t end_q, uint8_t port, uint16_t queue,
 			}
 			cbs->ring = ring;
 			cbs->mp = mp;
+			cbs->queue = qid;
+			cbs->stats = NULL;
+			if (filter->stats != NULL)
+				cbs->stats = filter->stats +
+					((queue == RTE_PDUMP_ALL_QUEUES) ?
+					qid : 0);
+			cbs->snaplen = filter->snaplen;
+			cbs->sample_rate = filter->sample_rate;
+			cbs->sample_cnt = 0;
+			pdump_filter_setup(&cbs->filter, filter);
 			cbs->cb = rte_eth_add_first_rx_callback(port, qid,
 								pdump_rx, cbs);
 			if (cbs->cb == NULL) {
@@ -305,6 +509,7 @@ pdump_regitser_rx_callbacks(uint16_t end_q, uint8_t port, uint16_t queue,
 static int
 pdump_regitser_tx_callbacks(uint16_t end_q, uint8_t port, uint16_t queue,
 				struct rte_ring *ring, struct rte_mempool *mp,
+				const struct rte_pdump_filter *filter,
 				uint16_t operation)
 {
 
@@ -324,6 +529,16 @@ pdump_regitser_tx_callbacks(uint16_t end_q, uint8_t port, uint16_t queue,
 			}
 			cbs->ring = ring;
 			cbs->mp = mp;
+			cbs->queue = qid;
+			cbs->stats = NULL;
+			if (filter->stats != NULL)
+				cbs->stats = filter->stats +
+					((queue == RTE_PDUMP_ALL_QUEUES) ?
+					qid : 0);
+			cbs->snaplen = filter->snaplen;
+			cbs->sample_rate = filter->sample_rate;
+			cbs->sample_cnt = 0;
+			pdump_filter_setup(&cbs->filter, filter);
 			cbs->cb = rte_eth_add_tx_callback(port, qid, pdump_tx,
 								cbs);
 			if (cbs->cb == NULL) {
@@ -367,6 +582,7 @@ set_pdump_rxtx_cbs(struct pdump_request *p)
 	uint16_t operation;
 	struct rte_ring *ring;
 	struct rte_mempool *mp;
+	struct rte_pdump_filter *filter;
 
 	flags = p->flags;
 	operation = p->op;
@@ -382,6 +598,7 @@ set_pdump_rxtx_cbs(struct pdump_request *p)
 		queue = p->data.en_v1.queue;
 		ring = p->data.en_v1.ring;
 		mp = p->data.en_v1.mp;
+		filter = &p->data.en_v1.filter;
 	} else {
 		ret = rte_eth_dev_get_port_by_name(p->data.dis_v1.device,
 				&port);
@@ -394,6 +611,7 @@ set_pdump_rxtx_cbs(struct pdump_request *p)
 		queue = p->data.dis_v1.queue;
 		ring = p->data.dis_v1.ring;
 		mp = p->data.dis_v1.mp;
+		filter = NULL;
 	}
 
 	/* validation if packet capture is for all queues */
@@ -425,7 +643,7 @@ set_pdump_rxtx_cbs(struct pdump_request *p)
 	if (flags & RTE_PDUMP_FLAG_RX) {
 		end_q = (queue == RTE_PDUMP_ALL_QUEUES) ? nb_rx_q : queue + 1;
 		ret = pdump_regitser_rx_callbacks(end_q, port, queue, ring, mp,
-							operation);
+							filter, operation);
 		if (ret < 0)
 			return ret;
 	}
@@ -434,7 +652,7 @@ set_pdump_rxtx_cbs(struct pdump_request *p)
 	if (flags & RTE_PDUMP_FLAG_TX) {
 		end_q = (queue == RTE_PDUMP_ALL_QUEUES) ? nb_tx_q : queue + 1;
 		ret = pdump_regitser_tx_callbacks(end_q, port, queue, ring, mp,
-							operation);
+							filter, operation);
 		if (ret < 0)
 			return ret;
 	}
@@ -773,6 +991,38 @@ pdump_validate_ring_mp(struct rte_ring *ring, struct rte_mempool *mp)
 	return 0;
 }
 
+static int
+pdump_validate_filter(const struct rte_pdump_filter *f)
+{
+	uint8_t max_depth;
+
+	if (f == NULL)
+		return 0;
+	if (f->match & ~RTE_PDUMP_MATCH_ALL) {
+		RTE_LOG(ERR, PDUMP, "invalid filter match flags 0x%x\n",
+			f->match);
+		rte_errno = EINVAL;
+		return -1;
+	}
+	if (f->match & (RTE_PDUMP_MATCH_SRC_ADDR | RTE_PDUMP_MATCH_DST_ADDR)) {
+		if (f->ip_version != 4 && f->ip_version != 6) {
+			RTE_LOG(ERR, PDUMP,
+				"filter on addresses needs ip version 4 or 6\n");
+			rte_errno = EINVAL;
+			return -1;
+		}
+		max_depth = (f->ip_version == 4) ? 32 : 128;
+		if (f->src_depth > max_depth || f->dst_depth > max_depth) {
+			RTE_LOG(ERR, PDUMP,
+				"filter prefix length exceeds %u\n", max_depth);
+			rte_errno = EINVAL;
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 static int
 pdump_validate_flags(uint32_t flags)
 {
@@ -817,7 +1067,7 @@ pdump_prepare_client_request(char *device, uint16_t queue,
 				uint16_t operation,
 				struct rte_ring *ring,
 				struct rte_mempool *mp,
-				void *filter)
+				const struct rte_pdump_filter *filter)
 {
 	int ret;
 	struct pdump_request req = {.ver = 1,};
@@ -830,7 +1080,8 @@ pdump_prepare_client_request(char *device, uint16_t queue,
 		req.data.en_v1.queue = queue;
 		req.data.en_v1.ring = ring;
 		req.data.en_v1.mp = mp;
-		req.data.en_v1.filter = filter;
+		if (filter != NULL)
+			req.data.en_v1.filter = *filter;
 	} else {
 		snprintf(req.data.dis_v1.device, sizeof(req.data.dis_v1.device),
 				"%s", device);
@@ -868,6 +1119,9 @@ rte_pdump_enable(uint8_t port, uint16_t queue, uint32_t flags,
 	if (ret < 0)
 		return ret;
 	ret = pdump_validate_flags(flags);
+	if (ret < 0)
+		return ret;
+	ret = pdump_validate_filter(filter);
 	if (ret < 0)
 		return ret;
 
@@ -891,6 +1145,9 @@ rte_pdump_enable_by_deviceid(char *device_id, uint16_t queue,
 	if (ret < 0)
 		return ret;
 	ret = pdump_validate_flags(flags);
+	if (ret < 0)
+		return ret;
+	ret = pdump_validate_filter(filter);
 	if (ret < 0)
 		return ret;
 
@@ -41,6 +41,8 @@
  * packet dump library to provide packet capturing support on dpdk.
  */
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -59,6 +61,76 @@ enum rte_pdump_socktype {
 	RTE_PDUMP_SOCKET_CLIENT = 2
 };
 
+/* Fields of struct rte_pdump_filter compared against captured packets. */
+#define RTE_PDUMP_MATCH_ETHER_TYPE 0x01 /**< match ether_type */
+#define RTE_PDUMP_MATCH_PROTO      0x02 /**< match IP next protocol */
+#define RTE_PDUMP_MATCH_SRC_ADDR   0x04 /**< match IP source prefix */
+#define RTE_PDUMP_MATCH_DST_ADDR   0x08 /**< match IP destination prefix */
+#define RTE_PDUMP_MATCH_SRC_PORT   0x10 /**< match TCP/UDP/SCTP source port */
+#define RTE_PDUMP_MATCH_DST_PORT   0x20 /**< match TCP/UDP/SCTP dest port */
+#define RTE_PDUMP_MATCH_ALL        0x3f
+
+/*
+ * Capture metadata of the copies enqueued to the user ring. The port
+ * field of a copy holds the port it was captured on.
+ */
+/** Length of the original packet. */
+#define RTE_PDUMP_MBUF_ORIG_LEN(m) ((m)->seqn)
+/** Queue the packet was captured on. */
+#define RTE_PDUMP_MBUF_QUEUE(m)    ((m)->hash.usr)
+/** TSC value read by the RX/TX callback when the packet was captured. */
+#define RTE_PDUMP_MBUF_TSC(m)      ((m)->udata64)
+
+/**
+ * Capture counters of one queue, updated by the RX/TX callback of that
+ * queue only.
+ */
+struct rte_pdump_stats {
+	uint64_t accepted; /**< Packets copied and enqueued to the ring. */
+	uint64_t filtered; /**< Packets skipped by the filter or sampling. */
+	uint64_t nombuf;   /**< Packets dropped for lack of capture mbufs. */
+	uint64_t ringfull; /**< Packets dropped because the ring was full. */
+};
+
+/**
+ * Capture options passed as the filter argument of rte_pdump_enable()
+ * and rte_pdump_enable_by_deviceid().
+ *
+ * The options are copied into the enable request, so the structure may be
+ * released once the call returns. They are evaluated on the core that polls
+ * the port, before any packet data is copied: packets that do not match
+ * or are not sampled cost no allocation and no memcpy.
+ *
+ * Only the fields selected in ``match`` are compared. Headers are looked up
+ * in the first segment of the packet, after at most one VLAN tag; IPv6
+ * extension headers are not walked and non-first IPv4 fragments never
+ * match a port. A zeroed structure captures every packet in full.
+ */
+struct rte_pdump_filter {
+	uint32_t snaplen;
+	/**< Bytes copied from each packet, 0 to copy the whole packet. */
+	uint32_t sample_rate;
+	/**< Capture one of every N matching packets, 0 or 1 for all. */
+	uint32_t match;       /**< RTE_PDUMP_MATCH_* fields to compare. */
+	uint16_t ether_type;  /**< Ethernet type, host byte order. */
+	uint8_t proto;        /**< IP next protocol. */
+	uint8_t ip_version;   /**< 4 or 6, required to match addresses. */
+	uint8_t src_depth;    /**< Source prefix length in bits. */
+	uint8_t dst_depth;    /**< Destination prefix length in bits. */
+	uint16_t src_port;    /**< L4 source port, host byte order. */
+	uint16_t dst_port;    /**< L4 destination port, host byte order. */
+	union {
+		uint32_t ipv4;    /**< IPv4 address, network byte order. */
+		uint8_t ipv6[16]; /**< IPv6 address. */
+	} src_addr, dst_addr;
+	struct rte_pdump_stats *stats;
+	/**< Optional counters, in memory shared with the primary process
+	 * (e.g. from rte_zmalloc()). When capturing on RTE_PDUMP_ALL_QUEUES
+	 * it must hold one entry per queue, indexed by queue id, otherwise a
+	 * single entry. NULL if not needed.
+	 */
+};
+
 /**
  * Initialize packet capturing handling
  *
@@ -101,8 +173,11 @@ rte_pdump_uninit(void);
  *  ring on which captured packets will be enqueued for user.
  * @param mp
  *  mempool on to which original packets will be mirrored or duplicated.
+ *  Each copy holds at most snaplen bytes of the packet and carries the
+ *  RTE_PDUMP_MBUF_* capture metadata.
  * @param filter
- *  place holder for packet filtering.
+ *  pointer to a struct rte_pdump_filter with the snap length, sampling
+ *  rate and match rules of the capture, or NULL to copy every packet.
  *
  * @return
  *    0 on success, -1 on error, rte_errno is set accordingly.
@@ -151,8 +226,11 @@ rte_pdump_disable(uint8_t port, uint16_t queue, uint32_t flags);
  *  ring on which captured packets will be enqueued for user.
  * @param mp
  *  mempool on to which original packets will be mirrored or duplicated.
+ *  Each copy holds at most snaplen bytes of the packet and carries the
+ *  RTE_PDUMP_MBUF_* capture metadata.
  * @param filter
- *  place holder for packet filtering.
+ *  pointer to a struct rte_pdump_filter with the snap length, sampling
+ *  rate and match rules of the capture, or NULL to copy every packet.
  *
  * @return
  *    0 on success, -1 on error, rte_errno is set accordingly.
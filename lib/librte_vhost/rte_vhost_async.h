@@ -0,0 +1,274 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_VHOST_ASYNC_H_
+#define _RTE_VHOST_ASYNC_H_
+
+/**
+ * @file
+ * Asynchronous copy offload for the vhost data path.
+ *
+ * Instead of copying packet data between mbufs and guest buffers on the
+ * calling lcore, the copies of a virtqueue can be handed to a copy engine
+ * registered for it. Packets are then submitted with
+ * rte_vhost_submit_enqueue_burst() or rte_vhost_submit_dequeue_burst(),
+ * and handed back, in submission order, by
+ * rte_vhost_poll_enqueue_completed() or rte_vhost_poll_dequeue_completed()
+ * once the engine is done with them. Only then are the guest descriptors
+ * returned to the guest.
+ *
+ * Copies smaller than the threshold given at registration, such as those
+ * of small packets, are still done by the calling lcore, and so are the
+ * copies the engine can't accept.
+ *
+ * A software engine running the copies on helper lcores is provided;
+ * hardware (DMA) engines implement struct rte_vhost_async_engine_ops.
+ */
+
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** One memory copy of a job. */
+struct rte_vhost_async_seg {
+	void *dst;		/**< Destination address. */
+	const void *src;	/**< Source address. */
+	uint32_t len;		/**< Number of bytes to copy. */
+};
+
+/**
+ * A copy job: the copies of one packet. The segments remain valid until
+ * the job is reported completed.
+ */
+struct rte_vhost_async_job {
+	struct rte_vhost_async_seg *segs;	/**< Copies to perform. */
+	uint16_t nb_segs;			/**< Number of copies. */
+};
+
+/** Operations of a copy engine. */
+struct rte_vhost_async_engine_ops {
+	/**
+	 * Start the copy jobs. Returns the number of jobs accepted, the
+	 * first ones of the array; vhost copies the others itself.
+	 */
+	int (*submit)(void *priv, int vid, uint16_t queue_id,
+		      struct rte_vhost_async_job *jobs, uint16_t nb_jobs);
+	/**
+	 * Returns the number of jobs completed since the last call, at most
+	 * max_jobs. Jobs must be reported in the order they were submitted.
+	 */
+	int (*poll)(void *priv, int vid, uint16_t queue_id, uint16_t max_jobs);
+};
+
+/**
+ * Register a copy engine for a virtqueue. It should be called once the
+ * device is ready, typically from the new_device() callback. The sync
+ * rte_vhost_enqueue_burst() and rte_vhost_dequeue_burst() are disabled on
+ * the virtqueue until the engine is unregistered.
+ *
+ * @param vid
+ *  virtio-net device ID
+ * @param queue_id
+ *  virtio queue index
+ * @param ops
+ *  copy engine operations
+ * @param priv
+ *  engine private data passed to the operations
+ * @param threshold
+ *  copies of fewer bytes are done synchronously
+ * @return
+ *  0 on success, -1 on failure
+ */
+int rte_vhost_async_channel_register(int vid, uint16_t queue_id,
+		const struct rte_vhost_async_engine_ops *ops, void *priv,
+		uint32_t threshold);
+
+/**
+ * Unregister the copy engine of a virtqueue. It fails as long as packets
+ * are in flight: they must first be retrieved with the poll functions.
+ * When the device is destroyed, its vrings stopped or its guest memory
+ * remapped, vhost waits for the engine to complete the packets still in
+ * flight and frees them.
+ *
+ * @param vid
+ *  virtio-net device ID
+ * @param queue_id
+ *  virtio queue index
+ * @return
+ *  0 on success, -1 on failure
+ */
+int rte_vhost_async_channel_unregister(int vid, uint16_t queue_id);
+
+/**
+ * Start copying packets to the guest RX virtqueue. The mbufs accepted
+ * belong to vhost until returned by rte_vhost_poll_enqueue_completed().
+ *
+ * @param vid
+ *  virtio-net device ID
+ * @param queue_id
+ *  virtio queue index in mq case
+ * @param pkts
+ *  array of packets to be enqueued
+ * @param count
+ *  packets num to be enqueued
+ * @return
+ *  num of packets accepted
+ */
+uint16_t rte_vhost_submit_enqueue_burst(int vid, uint16_t queue_id,
+		struct rte_mbuf **pkts, uint16_t count);
+
+/**
+ * Complete the enqueue of packets whose copies are done, and return
+ * their mbufs, which are then to be freed by the caller.
+ *
+ * @param vid
+ *  virtio-net device ID
+ * @param queue_id
+ *  virtio queue index in mq case
+ * @param pkts
+ *  array to contain the completed packets
+ * @param count
+ *  size of the array
+ * @return
+ *  num of packets completed
+ */
+uint16_t rte_vhost_poll_enqueue_completed(int vid, uint16_t queue_id,
+		struct rte_mbuf **pkts, uint16_t count);
+
+/**
+ * Start copying packets from the guest TX virtqueue into mbufs allocated
+ * from mbuf_pool. They are retrieved with
+ * rte_vhost_poll_dequeue_completed().
+ *
+ * @param vid
+ *  virtio-net device ID
+ * @param queue_id
+ *  virtio queue index in mq case
+ * @param mbuf_pool
+ *  mbuf_pool where host mbuf is allocated.
+ * @param count
+ *  packets num to be dequeued
+ * @return
+ *  num of packets submitted
+ */
+uint16_t rte_vhost_submit_dequeue_burst(int vid, uint16_t queue_id,
+		struct rte_mempool *mbuf_pool, uint16_t count);
+
+/**
+ * Retrieve the dequeued packets whose copies are done.
+ *
+ * @param vid
+ *  virtio-net device ID
+ * @param queue_id
+ *  virtio queue index in mq case
+ * @param pkts
+ *  array to contain the dequeued packets
+ * @param count
+ *  size of the array
+ * @return
+ *  num of packets dequeued
+ */
+uint16_t rte_vhost_poll_dequeue_completed(int vid, uint16_t queue_id,
+		struct rte_mbuf **pkts, uint16_t count);
+
+/** Software copy engine, running the copies on helper lcores. */
+struct rte_vhost_async_sw;
+
+/** Software engine operations, see rte_vhost_async_sw_channel_create(). */
+extern const struct rte_vhost_async_engine_ops rte_vhost_async_sw_ops;
+
+/**
+ * Create a software copy engine.
+ *
+ * @param name
+ *  name of the engine, used for its job ring
+ * @param nb_jobs
+ *  size of the ring of jobs waiting for a helper lcore, power of 2
+ * @param socket_id
+ *  socket to allocate memory on
+ * @return
+ *  the engine, NULL on failure with rte_errno set
+ */
+struct rte_vhost_async_sw *rte_vhost_async_sw_create(const char *name,
+		unsigned int nb_jobs, int socket_id);
+
+/**
+ * Free a software copy engine, once its helper lcores have returned and
+ * its channels are freed.
+ */
+void rte_vhost_async_sw_free(struct rte_vhost_async_sw *sw);
+
+/**
+ * Main loop of a helper lcore, to be launched with
+ * rte_eal_remote_launch() on as many lcores as needed. It runs the copy
+ * jobs of the engine until rte_vhost_async_sw_stop() is called.
+ *
+ * @param arg
+ *  the engine, a struct rte_vhost_async_sw pointer
+ * @return
+ *  0
+ */
+int rte_vhost_async_sw_worker(void *arg);
+
+/** Make the helper lcores of an engine return. */
+void rte_vhost_async_sw_stop(struct rte_vhost_async_sw *sw);
+
+/**
+ * Create a channel of a software engine, to be given as priv to
+ * rte_vhost_async_channel_register() along with rte_vhost_async_sw_ops.
+ * A channel serves a single virtqueue.
+ *
+ * @param sw
+ *  the engine
+ * @param depth
+ *  max number of jobs in flight on the channel, power of 2
+ * @param socket_id
+ *  socket to allocate memory on
+ * @return
+ *  the channel, NULL on failure
+ */
+void *rte_vhost_async_sw_channel_create(struct rte_vhost_async_sw *sw,
+		unsigned int depth, int socket_id);
+
+/** Free a channel of a software engine, once it is unregistered. */
+void rte_vhost_async_sw_channel_free(void *chan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_VHOST_ASYNC_H_ */
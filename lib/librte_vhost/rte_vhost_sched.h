@@ -0,0 +1,178 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_VHOST_SCHED_H_
+#define _RTE_VHOST_SCHED_H_
+
+/**
+ * @file
+ * Vhost virtqueue scheduler.
+ *
+ * Spreads the virtqueues of many vhost devices over a pool of lcores.
+ * Each virtqueue is homed on one lcore of the pool, which runs an
+ * application handler for it whenever it has pending work: the guest
+ * posted packets since the last run (checked by comparing the avail
+ * index with the last one consumed), async copies are in flight, or
+ * zero copy mbufs are waiting to be given back. Idle virtqueues cost a
+ * single read of their avail index per round.
+ *
+ * An lcore that finds no work on its own virtqueues steals pending ones
+ * from the others. A virtqueue is only ever run by one lcore at a time,
+ * so the handler needs no locking. The first lcore of the pool also
+ * periodically moves virtqueues from the most to the least loaded lcore,
+ * load being the number of packets handled.
+ *
+ * Guest kicks are suppressed on the virtqueues scheduled, and the guest
+ * interrupts they raise while the handler runs are merged into one.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Virtqueue handler, typically dequeuing packets from a guest TX
+ * virtqueue and forwarding them.
+ *
+ * @param vid
+ *  virtio-net device ID
+ * @param queue_id
+ *  virtio queue index
+ * @param arg
+ *  argument given to rte_vhost_sched_queue_add()
+ * @return
+ *  number of packets handled, accounted as the load of the virtqueue
+ */
+typedef uint32_t (*rte_vhost_sched_handler_t)(int vid, uint16_t queue_id,
+					       void *arg);
+
+/** Scheduler configuration. */
+struct rte_vhost_sched_conf {
+	rte_vhost_sched_handler_t handler; /**< Virtqueue handler. */
+	uint16_t nb_lcores;	/**< Number of lcores of the pool. */
+	uint16_t max_queues;	/**< Max number of virtqueues scheduled. */
+	uint32_t rebalance_ms;	/**< Rebalancing period, 0 to disable. */
+	int socket_id;		/**< Socket to allocate memory on. */
+};
+
+struct rte_vhost_sched;
+
+/**
+ * Create a scheduler.
+ *
+ * @param conf
+ *  scheduler configuration
+ * @return
+ *  the scheduler, NULL on failure
+ */
+struct rte_vhost_sched *
+rte_vhost_sched_create(const struct rte_vhost_sched_conf *conf);
+
+/**
+ * Free a scheduler, once its lcores have returned.
+ */
+void rte_vhost_sched_free(struct rte_vhost_sched *sched);
+
+/**
+ * Schedule a virtqueue. It should be called once the device is ready,
+ * typically from the new_device() callback. The virtqueue is homed on
+ * the lcore of the pool with the fewest virtqueues.
+ *
+ * Only the guest TX virtqueues (odd indexes) have their avail index
+ * watched; a guest RX virtqueue only needs to be scheduled to retrieve
+ * its async copy completions.
+ *
+ * @param sched
+ *  the scheduler
+ * @param vid
+ *  virtio-net device ID
+ * @param queue_id
+ *  virtio queue index
+ * @param arg
+ *  argument passed to the handler
+ * @return
+ *  0 on success, -1 on failure
+ */
+int rte_vhost_sched_queue_add(struct rte_vhost_sched *sched, int vid,
+			      uint16_t queue_id, void *arg);
+
+/**
+ * Stop scheduling a virtqueue. It waits for the handler to return if it
+ * is running, and must be called before the device is destroyed, that is
+ * from the destroy_device() callback at the latest. Guest notifications,
+ * disabled while the virtqueue was polled, are enabled again.
+ *
+ * @param sched
+ *  the scheduler
+ * @param vid
+ *  virtio-net device ID
+ * @param queue_id
+ *  virtio queue index
+ * @return
+ *  0 on success, -1 if the virtqueue isn't scheduled
+ */
+int rte_vhost_sched_queue_del(struct rte_vhost_sched *sched, int vid,
+			      uint16_t queue_id);
+
+/**
+ * Main loop of an lcore of the pool, to be launched with
+ * rte_eal_remote_launch() on conf->nb_lcores lcores. It runs until
+ * rte_vhost_sched_stop() is called.
+ *
+ * @param arg
+ *  the scheduler, a struct rte_vhost_sched pointer
+ * @return
+ *  0, or -1 if the pool is already complete
+ */
+int rte_vhost_sched_run(void *arg);
+
+/** Make the lcores of a scheduler return. */
+void rte_vhost_sched_stop(struct rte_vhost_sched *sched);
+
+/**
+ * Dump the per lcore and per virtqueue statistics of a scheduler.
+ *
+ * @param f
+ *  output stream
+ * @param sched
+ *  the scheduler
+ */
+void rte_vhost_sched_dump(FILE *f, struct rte_vhost_sched *sched);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_VHOST_SCHED_H_ */
@@ -53,6 +53,12 @@
 
 #define RTE_VHOST_USER_CLIENT		(1ULL << 0)
 #define RTE_VHOST_USER_NO_RECONNECT	(1ULL << 1)
+/**
+ * Dequeue without copying: the returned mbufs reference guest memory
+ * directly, and the guest descriptors are handed back only once the
+ * application has freed (or transmitted) the mbufs.
+ */
+#define RTE_VHOST_USER_DEQUEUE_ZERO_COPY	(1ULL << 2)
 
 /* Enum for virtqueue management. */
 enum {VIRTIO_RXQ, VIRTIO_TXQ, VIRTIO_QNUM};
@@ -178,6 +184,13 @@ uint16_t rte_vhost_enqueue_burst(int vid, uint16_t queue_id,
  * This function gets guest buffers from the virtio device TX virtqueue,
  * construct host mbufs, copies guest buffer content to host mbufs and
  * store them in pkts to be processed.
+ *
+ * When the socket was registered with RTE_VHOST_USER_DEQUEUE_ZERO_COPY,
+ * the mbufs point at guest memory instead and the guest descriptors are
+ * returned to the used ring by a later call, once the mbufs have been
+ * freed. At most RTE_LIBRTE_VHOST_ZCOPY_MAX_INFLIGHT descriptors per
+ * queue are held that way; further packets are copied. The application
+ * must not free such mbufs with refcount-less fast paths.
  * @param vid
  *  virtio-net device
  * @param queue_id
@@ -37,11 +37,15 @@
 #include <stdio.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <sys/queue.h>
 #include <linux/vhost.h>
 
+#include <rte_atomic.h>
 #include <rte_log.h>
+#include <rte_mbuf.h>
 
 #include "rte_virtio_net.h"
+#include "rte_vhost_async.h"
 
 /* Used to indicate that the device is running on a data core */
 #define VIRTIO_DEV_RUNNING 1
@@ -61,6 +65,50 @@ struct buf_vector {
 	uint32_t desc_idx;
 };
 
+/*
+ * Dirty log bytes touched during a burst; they are merged and written to
+ * the shared log once per burst instead of once per guest write.
+ */
+#define VHOST_LOG_CACHE_NR 32
+
+struct log_cache_entry {
+	uint32_t offset;
+	uint8_t val;
+};
+
+/*
+ * A mbuf handed out by zero copy dequeue, referencing guest memory;
+ * desc_idx goes back to the used ring once the mbuf is consumed.
+ */
+struct zcopy_mbuf {
+	struct rte_mbuf *mbuf;
+	uint32_t desc_idx;
+	uint16_t in_use;
+
+	TAILQ_ENTRY(zcopy_mbuf) next;
+};
+TAILQ_HEAD(zcopy_mbuf_list, zcopy_mbuf);
+
+/* Max number of copies of a packet left to an async copy engine. */
+#define VHOST_ASYNC_SEGS_PER_PKT 16
+
+/*
+ * A packet in flight on a virtqueue with an async copy engine. segs and
+ * seg_gpa point at the slot's own storage, allocated at registration.
+ */
+struct async_pkt {
+	struct rte_mbuf *mbuf;
+	/* dequeue: guest header whose offload flags are applied at the end */
+	struct virtio_net_hdr *hdr;
+	/* number of avail entries held */
+	uint16_t nr_used;
+	/* number of copies submitted to the engine, 0 if none */
+	uint16_t nr_segs;
+	struct rte_vhost_async_seg *segs;
+	/* enqueue: guest address of each copy, for dirty logging */
+	uint64_t *seg_gpa;
+};
+
 /**
  * Structure contains variables relevant to RX/TX virtqueues.
  */
@@ -85,8 +133,78 @@ struct vhost_virtqueue {
 
 	/* Physical address of used ring, for logging */
 	uint64_t		log_guest_addr;
+
+	/*
+	 * Dequeue zero copy: next avail entry to consume, which runs
+	 * ahead of last_used_idx by the number of in-flight mbufs.
+	 */
+	uint16_t		last_avail_idx;
+	uint16_t		nr_zmbuf;
+	uint16_t		zmbuf_size;
+	uint16_t		last_zmbuf_idx;
+	struct zcopy_mbuf	*zmbufs;
+	struct zcopy_mbuf_list	zmbuf_list;
+
+	uint16_t		log_cache_nb_elem;
+	struct log_cache_entry	log_cache[VHOST_LOG_CACHE_NR];
+
+	/*
+	 * Async copy engine. The packets in flight use the async_pkts
+	 * slots before async_pkts_idx; their avail entries lie between
+	 * last_used_idx and last_avail_idx.
+	 */
+	const struct rte_vhost_async_engine_ops *async_ops;
+	void			*async_priv;
+	uint32_t		async_threshold;
+	uint16_t		async_pkts_idx;
+	uint16_t		async_pkts_inflight;
+	/* engine completions not yet matched with a packet */
+	uint32_t		async_credits;
+	struct async_pkt	*async_pkts;
+	struct rte_vhost_async_seg *async_segs;
+	uint64_t		*async_seg_gpa;
+
+	/*
+	 * Set while the virtqueue is run by a vhost scheduler, which then
+	 * sends the guest a single interrupt per run of its handler.
+	 * call_pending is also set by the handlers of other virtqueues
+	 * enqueuing to this one, possibly from other lcores.
+	 */
+	uint8_t			call_batched;
+	rte_atomic16_t		call_pending;
 } __rte_cache_aligned;
 
+/* Send the guest an interrupt, unless it doesn't want any. */
+static inline void __attribute__((always_inline))
+vhost_vring_call_now(struct vhost_virtqueue *vq)
+{
+	if (!(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT)
+			&& (vq->callfd >= 0))
+		eventfd_write(vq->callfd, (eventfd_t)1);
+}
+
+/* Notify the guest of new used entries, once used->idx is updated. */
+static inline void __attribute__((always_inline))
+vhost_vring_call(struct vhost_virtqueue *vq)
+{
+	if (unlikely(vq->call_batched)) {
+		rte_atomic16_set(&vq->call_pending, 1);
+		return;
+	}
+
+	vhost_vring_call_now(vq);
+}
+
+/* Send the interrupt held back by vhost_vring_call(), if any. */
+static inline void __attribute__((always_inline))
+vhost_vring_call_flush(struct vhost_virtqueue *vq)
+{
+	if (rte_atomic16_read(&vq->call_pending) &&
+	    rte_atomic16_cmpset((volatile uint16_t *)&vq->call_pending.cnt,
+				1, 0))
+		vhost_vring_call_now(vq);
+}
+
 /* Old kernels have no such macro defined */
 #ifndef VIRTIO_NET_F_GUEST_ANNOUNCE
  #define VIRTIO_NET_F_GUEST_ANNOUNCE 21
@@ -114,6 +232,16 @@ struct vhost_virtqueue {
  #define VIRTIO_F_VERSION_1 32
 #endif
 
+/*
+ * A guest memory chunk that is contiguous in host physical memory,
+ * used to translate guest addresses for zero copy dequeue.
+ */
+struct guest_page {
+	uint64_t guest_phys_addr;
+	uint64_t host_phys_addr;
+	uint64_t size;
+};
+
 /**
  * Device structure contains all configuration information relating
  * to the device.
@@ -137,6 +265,10 @@ struct virtio_net {
 	uint64_t		log_addr;
 	struct ether_addr	mac;
 
+	int			dequeue_zero_copy;
+	uint32_t		nr_guest_pages;
+	uint32_t		max_guest_pages;
+	struct guest_page	*guest_pages;
 } __rte_cache_aligned;
 
 /**
@@ -218,6 +350,59 @@ gpa_to_vva(struct virtio_net *dev, uint64_t guest_pa)
 	return vhost_va;
 }
 
+/* Translate a guest physical range to a host physical address, or 0. */
+static inline uint64_t __attribute__((always_inline))
+gpa_to_hpa(struct virtio_net *dev, uint64_t gpa, uint64_t size)
+{
+	uint32_t i;
+	struct guest_page *page;
+
+	for (i = 0; i < dev->nr_guest_pages; i++) {
+		page = &dev->guest_pages[i];
+
+		if (gpa >= page->guest_phys_addr &&
+		    gpa + size <= page->guest_phys_addr + page->size) {
+			return gpa - page->guest_phys_addr +
+			       page->host_phys_addr;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * A zero copy mbuf is consumed once the application dropped its
+ * references, leaving only the one held by vhost on every segment.
+ */
+static inline int
+mbuf_is_consumed(struct rte_mbuf *m)
+{
+	while (m) {
+		if (rte_mbuf_refcnt_read(m) > 1)
+			return 0;
+		m = m->next;
+	}
+
+	return 1;
+}
+
+/* Point the segments of a zero copy mbuf back at their own buffers. */
+static inline void
+restore_mbuf(struct rte_mbuf *m)
+{
+	uint32_t mbuf_size, priv_size;
+
+	while (m) {
+		priv_size = rte_pktmbuf_priv_size(m->pool);
+		mbuf_size = sizeof(struct rte_mbuf) + priv_size;
+
+		m->buf_addr = (char *)m + mbuf_size;
+		m->buf_physaddr = rte_mempool_virt2phy(m->pool, m) + mbuf_size;
+		m->buf_len = rte_pktmbuf_data_room_size(m->pool);
+		m = m->next;
+	}
+}
+
 struct virtio_net_device_ops const *notify_ops;
 struct virtio_net *get_device(int vid);
 
@@ -225,6 +410,7 @@ int vhost_new_device(void);
 void vhost_destroy_device(int);
 
 void vhost_set_ifname(int, const char *if_name, unsigned int if_len);
+void vhost_enable_dequeue_zero_copy(int vid);
 
 int vhost_get_features(int, uint64_t *);
 int vhost_set_features(int, uint64_t *);
@@ -242,6 +428,12 @@ int vhost_set_backend(int, struct vhost_vring_file *);
 int vhost_set_owner(int);
 int vhost_reset_owner(int);
 
+/*
+ * Wait for the async copies in flight on all the vrings of a device, and
+ * drop their packets, before its guest memory is unmapped.
+ */
+void vhost_drain_async(struct virtio_net *dev);
+
 /*
  * Backend-specific cleanup. Defined by vhost-cuse and vhost-user.
  */
@@ -0,0 +1,217 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_memcpy.h>
+#include <rte_ring.h>
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+
+#include "rte_vhost_async.h"
+
+/* Max number of jobs submitted, or taken by a helper lcore, at once. */
+#define ASYNC_SW_BURST 32
+
+struct rte_vhost_async_sw {
+	struct rte_ring *ring;	/* jobs waiting for a helper lcore */
+	volatile int stop;
+};
+
+struct async_sw_job {
+	struct rte_vhost_async_seg *segs;
+	uint16_t nb_segs;
+	volatile uint16_t done;
+} __rte_cache_aligned;
+
+/*
+ * A channel serves one virtqueue: jobs are submitted at tail and, as the
+ * helper lcores may finish them out of order, reported completed from
+ * head on as long as they are done.
+ */
+struct async_sw_channel {
+	struct rte_vhost_async_sw *sw;
+	uint32_t mask;
+	uint32_t head;
+	uint32_t tail;
+	struct async_sw_job jobs[0];
+};
+
+static int
+async_sw_submit(void *priv, int vid __rte_unused,
+		uint16_t queue_id __rte_unused,
+		struct rte_vhost_async_job *jobs, uint16_t nb_jobs)
+{
+	struct async_sw_channel *chan = priv;
+	void *ptrs[ASYNC_SW_BURST];
+	struct async_sw_job *job;
+	uint32_t free_jobs;
+	uint16_t i;
+
+	free_jobs = chan->mask + 1 - (chan->tail - chan->head);
+	nb_jobs = RTE_MIN(nb_jobs, free_jobs);
+	nb_jobs = RTE_MIN(nb_jobs, ASYNC_SW_BURST);
+
+	for (i = 0; i < nb_jobs; i++) {
+		job = &chan->jobs[(chan->tail + i) & chan->mask];
+		job->segs = jobs[i].segs;
+		job->nb_segs = jobs[i].nb_segs;
+		job->done = 0;
+		ptrs[i] = job;
+	}
+
+	nb_jobs = rte_ring_mp_enqueue_burst(chan->sw->ring, ptrs, nb_jobs);
+	chan->tail += nb_jobs;
+
+	return nb_jobs;
+}
+
+static int
+async_sw_poll(void *priv, int vid __rte_unused,
+	      uint16_t queue_id __rte_unused, uint16_t max_jobs)
+{
+	struct async_sw_channel *chan = priv;
+	uint16_t nb_jobs = 0;
+
+	while (chan->head != chan->tail && nb_jobs < max_jobs &&
+	       chan->jobs[chan->head & chan->mask].done) {
+		chan->head++;
+		nb_jobs++;
+	}
+
+	/* Don't let the caller read the copied data ahead of done. */
+	rte_smp_rmb();
+
+	return nb_jobs;
+}
+
+const struct rte_vhost_async_engine_ops rte_vhost_async_sw_ops = {
+	.submit = async_sw_submit,
+	.poll = async_sw_poll,
+};
+
+struct rte_vhost_async_sw *
+rte_vhost_async_sw_create(const char *name, unsigned int nb_jobs,
+			  int socket_id)
+{
+	struct rte_vhost_async_sw *sw;
+	char ring_name[RTE_RING_NAMESIZE];
+
+	sw = rte_zmalloc_socket(NULL, sizeof(*sw), RTE_CACHE_LINE_SIZE,
+				socket_id);
+	if (sw == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	snprintf(ring_name, sizeof(ring_name), "vhost_async_%s", name);
+	sw->ring = rte_ring_create(ring_name, nb_jobs, socket_id, 0);
+	if (sw->ring == NULL) {
+		rte_free(sw);
+		return NULL;
+	}
+
+	return sw;
+}
+
+void
+rte_vhost_async_sw_free(struct rte_vhost_async_sw *sw)
+{
+	if (sw == NULL)
+		return;
+
+	rte_ring_free(sw->ring);
+	rte_free(sw);
+}
+
+int
+rte_vhost_async_sw_worker(void *arg)
+{
+	struct rte_vhost_async_sw *sw = arg;
+	struct async_sw_job *jobs[ASYNC_SW_BURST];
+	unsigned int nb_jobs, i;
+	uint16_t j;
+
+	while (!sw->stop) {
+		nb_jobs = rte_ring_mc_dequeue_burst(sw->ring, (void **)jobs,
+						    ASYNC_SW_BURST);
+		for (i = 0; i < nb_jobs; i++) {
+			for (j = 0; j < jobs[i]->nb_segs; j++)
+				rte_memcpy(jobs[i]->segs[j].dst,
+					   jobs[i]->segs[j].src,
+					   jobs[i]->segs[j].len);
+
+			rte_smp_wmb();
+			jobs[i]->done = 1;
+		}
+	}
+
+	return 0;
+}
+
+void
+rte_vhost_async_sw_stop(struct rte_vhost_async_sw *sw)
+{
+	sw->stop = 1;
+}
+
+void *
+rte_vhost_async_sw_channel_create(struct rte_vhost_async_sw *sw,
+				  unsigned int depth, int socket_id)
+{
+	struct async_sw_channel *chan;
+
+	if (sw == NULL || depth == 0 || !rte_is_power_of_2(depth))
+		return NULL;
+
+	chan = rte_zmalloc_socket(NULL, sizeof(*chan) +
+				  depth * sizeof(struct async_sw_job),
+				  RTE_CACHE_LINE_SIZE, socket_id);
+	if (chan == NULL)
+		return NULL;
+
+	chan->sw = sw;
+	chan->mask = depth - 1;
+
+	return chan;
+}
+
+void
+rte_vhost_async_sw_channel_free(void *chan)
+{
+	rte_free(chan);
+}
@@ -85,6 +85,82 @@ vhost_log_used_vring(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	vhost_log_write(dev, vq->log_guest_addr + offset, len);
 }
 
+static inline void __attribute__((always_inline))
+vhost_log_cache_page(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		     uint64_t page)
+{
+	uint32_t offset = page / 8;
+	uint8_t bit = 1 << (page % 8);
+	uint16_t i;
+
+	for (i = 0; i < vq->log_cache_nb_elem; i++) {
+		if (vq->log_cache[i].offset == offset) {
+			vq->log_cache[i].val |= bit;
+			return;
+		}
+	}
+
+	if (unlikely(i == VHOST_LOG_CACHE_NR)) {
+		/* No room left in the cache, log the page right away */
+		rte_smp_wmb();
+		vhost_log_page((uint8_t *)(uintptr_t)dev->log_base, page);
+		return;
+	}
+
+	vq->log_cache[i].offset = offset;
+	vq->log_cache[i].val = bit;
+	vq->log_cache_nb_elem++;
+}
+
+/*
+ * Same as vhost_log_write(), except that the pages are only recorded in
+ * the virtqueue log cache until vhost_log_cache_sync() is called.
+ */
+static inline void __attribute__((always_inline))
+vhost_log_cache_write(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		      uint64_t addr, uint64_t len)
+{
+	uint64_t page;
+
+	if (likely(((dev->features & (1ULL << VHOST_F_LOG_ALL)) == 0) ||
+		   !dev->log_base || !len))
+		return;
+
+	if (unlikely(dev->log_size <= ((addr + len - 1) / VHOST_LOG_PAGE / 8)))
+		return;
+
+	page = addr / VHOST_LOG_PAGE;
+	while (page * VHOST_LOG_PAGE < addr + len) {
+		vhost_log_cache_page(dev, vq, page);
+		page += 1;
+	}
+}
+
+static inline void __attribute__((always_inline))
+vhost_log_cache_used_vring(struct virtio_net *dev, struct vhost_virtqueue *vq,
+			   uint64_t offset, uint64_t len)
+{
+	vhost_log_cache_write(dev, vq, vq->log_guest_addr + offset, len);
+}
+
+static inline void __attribute__((always_inline))
+vhost_log_cache_sync(struct virtio_net *dev, struct vhost_virtqueue *vq)
+{
+	uint8_t *log_base = (uint8_t *)(uintptr_t)dev->log_base;
+	uint16_t i;
+
+	if (likely(vq->log_cache_nb_elem == 0))
+		return;
+
+	/* To make sure guest memory updates are committed before logging */
+	rte_smp_wmb();
+
+	for (i = 0; i < vq->log_cache_nb_elem; i++)
+		log_base[vq->log_cache[i].offset] |= vq->log_cache[i].val;
+
+	vq->log_cache_nb_elem = 0;
+}
+
 static bool
 is_valid_virt_queue_idx(uint32_t idx, int is_tx, uint32_t qp_nb)
 {
@@ -125,6 +201,28 @@ virtio_enqueue_offload(struct rte_mbuf *m_buf, struct virtio_net_hdr *net_hdr)
 	}
 }
 
+/*
+ * Leave a copy to the async copy engine if there is one, the copy is
+ * large enough and the packet has room for it. Returns 0 if the copy is
+ * to be done right away instead.
+ */
+static inline int __attribute__((always_inline))
+async_copy_add(struct vhost_virtqueue *vq, struct async_pkt *apkt,
+	       void *dst, const void *src, uint32_t len, uint64_t gpa)
+{
+	if (apkt == NULL || len < vq->async_threshold ||
+	    apkt->nr_segs == VHOST_ASYNC_SEGS_PER_PKT)
+		return 0;
+
+	apkt->segs[apkt->nr_segs].dst = dst;
+	apkt->segs[apkt->nr_segs].src = src;
+	apkt->segs[apkt->nr_segs].len = len;
+	apkt->seg_gpa[apkt->nr_segs] = gpa;
+	apkt->nr_segs++;
+
+	return 1;
+}
+
 static inline void
 copy_virtio_net_hdr(struct virtio_net *dev, uint64_t desc_addr,
 		    struct virtio_net_hdr_mrg_rxbuf hdr)
@@ -137,7 +235,7 @@ copy_virtio_net_hdr(struct virtio_net *dev, uint64_t desc_addr,
 
 static inline int __attribute__((always_inline))
 copy_mbuf_to_desc(struct virtio_net *dev, struct vhost_virtqueue *vq,
-		  struct rte_mbuf *m, uint16_t desc_idx)
+		  struct rte_mbuf *m, uint16_t desc_idx, struct async_pkt *apkt)
 {
 	uint32_t desc_avail, desc_offset;
 	uint32_t mbuf_avail, mbuf_offset;
@@ -160,7 +258,7 @@ copy_mbuf_to_desc(struct virtio_net *dev, struct vhost_virtqueue *vq,
 
 	virtio_enqueue_offload(m, &virtio_hdr.hdr);
 	copy_virtio_net_hdr(dev, desc_addr, virtio_hdr);
-	vhost_log_write(dev, desc->addr, dev->vhost_hlen);
+	vhost_log_cache_write(dev, vq, desc->addr, dev->vhost_hlen);
 	PRINT_PACKET(dev, (uintptr_t)desc_addr, dev->vhost_hlen, 0);
 
 	desc_offset = dev->vhost_hlen;
@@ -196,10 +294,16 @@ copy_mbuf_to_desc(struct virtio_net *dev, struct vhost_virtqueue *vq,
 		}
 
 		cpy_len = RTE_MIN(desc_avail, mbuf_avail);
-		rte_memcpy((void *)((uintptr_t)(desc_addr + desc_offset)),
+		if (!async_copy_add(vq, apkt,
+			(void *)((uintptr_t)(desc_addr + desc_offset)),
 			rte_pktmbuf_mtod_offset(m, void *, mbuf_offset),
-			cpy_len);
-		vhost_log_write(dev, desc->addr + desc_offset, cpy_len);
+			cpy_len, desc->addr + desc_offset)) {
+			rte_memcpy((void *)((uintptr_t)(desc_addr + desc_offset)),
+				rte_pktmbuf_mtod_offset(m, void *, mbuf_offset),
+				cpy_len);
+			vhost_log_cache_write(dev, vq, desc->addr + desc_offset,
+					      cpy_len);
+		}
 		PRINT_PACKET(dev, (uintptr_t)(desc_addr + desc_offset),
 			     cpy_len, 0);
 
@@ -212,6 +316,72 @@ copy_mbuf_to_desc(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	return 0;
 }
 
+/*
+ * Write used ring entries from used_idx on, as at most two contiguous
+ * (hence cache line sized) copies.
+ */
+static inline void __attribute__((always_inline))
+write_used_ring(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		uint16_t used_idx, struct vring_used_elem *used_elems,
+		uint32_t count)
+{
+	uint32_t size;
+
+	used_idx &= vq->size - 1;
+	size = RTE_MIN(count, (uint32_t)(vq->size - used_idx));
+
+	rte_memcpy(&vq->used->ring[used_idx], used_elems,
+		   size * sizeof(struct vring_used_elem));
+	vhost_log_cache_used_vring(dev, vq,
+		offsetof(struct vring_used, ring[used_idx]),
+		size * sizeof(struct vring_used_elem));
+
+	if (size < count) {
+		rte_memcpy(&vq->used->ring[0], &used_elems[size],
+			   (count - size) * sizeof(struct vring_used_elem));
+		vhost_log_cache_used_vring(dev, vq,
+			offsetof(struct vring_used, ring[0]),
+			(count - size) * sizeof(struct vring_used_elem));
+	}
+}
+
+/*
+ * Hand the next count used ring entries to the guest with a single
+ * used->idx update, then sync the dirty log.
+ */
+static inline void __attribute__((always_inline))
+publish_used_ring(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		  uint32_t count)
+{
+	rte_smp_wmb();
+
+	*(volatile uint16_t *)&vq->used->idx += count;
+	vq->last_used_idx += count;
+	vhost_log_cache_used_vring(dev, vq,
+		offsetof(struct vring_used, idx),
+		sizeof(vq->used->idx));
+
+	vhost_log_cache_sync(dev, vq);
+}
+
+/* Write and publish the used ring entries gathered during a burst. */
+static inline void __attribute__((always_inline))
+flush_used_ring(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		struct vring_used_elem *used_elems, uint32_t count)
+{
+	write_used_ring(dev, vq, vq->last_used_idx, used_elems, count);
+	publish_used_ring(dev, vq, count);
+}
+
+static inline void __attribute__((always_inline))
+prefetch_guest_buf(struct virtio_net *dev, uint64_t guest_pa)
+{
+	uint64_t addr = gpa_to_vva(dev, guest_pa);
+
+	if (likely(addr))
+		rte_prefetch0((void *)(uintptr_t)addr);
+}
+
 /**
  * This function adds buffers to the virtio devices RX virtqueue. Buffers can
  * be received from the physical port or from another virtio device. A packet
@@ -226,6 +396,7 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 	struct vhost_virtqueue *vq;
 	uint16_t avail_idx, free_entries, start_idx;
 	uint16_t desc_indexes[MAX_PKT_BURST];
+	struct vring_used_elem used_elems[MAX_PKT_BURST];
 	uint16_t used_idx;
 	uint32_t i;
 
@@ -237,7 +408,7 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 	}
 
 	vq = dev->virtqueue[queue_id];
-	if (unlikely(vq->enabled == 0))
+	if (unlikely(vq->enabled == 0 || vq->async_ops != NULL))
 		return 0;
 
 	avail_idx = *((volatile uint16_t *)&vq->avail->idx);
@@ -251,52 +422,50 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 	LOG_DEBUG(VHOST_DATA, "(%d) start_idx %d | end_idx %d\n",
 		dev->vid, start_idx, start_idx + count);
 
-	/* Retrieve all of the desc indexes first to avoid caching issues. */
+	/*
+	 * First pass: retrieve all of the desc indexes to avoid caching
+	 * issues, and get the descs and packet data on their way to the
+	 * cache. The used entries are only written to the ring at the end.
+	 */
 	rte_prefetch0(&vq->avail->ring[start_idx & (vq->size - 1)]);
 	for (i = 0; i < count; i++) {
 		used_idx = (start_idx + i) & (vq->size - 1);
 		desc_indexes[i] = vq->avail->ring[used_idx];
-		vq->used->ring[used_idx].id = desc_indexes[i];
-		vq->used->ring[used_idx].len = pkts[i]->pkt_len +
-					       dev->vhost_hlen;
-		vhost_log_used_vring(dev, vq,
-			offsetof(struct vring_used, ring[used_idx]),
-			sizeof(vq->used->ring[used_idx]));
+		used_elems[i].id = desc_indexes[i];
+		used_elems[i].len = pkts[i]->pkt_len + dev->vhost_hlen;
+
+		if (likely(desc_indexes[i] < vq->size))
+			rte_prefetch0(&vq->desc[desc_indexes[i]]);
+		rte_prefetch0(rte_pktmbuf_mtod(pkts[i], void *));
 	}
 
-	rte_prefetch0(&vq->desc[desc_indexes[0]]);
+	/* Second pass: copy, with the next guest buffer being prefetched. */
+	if (likely(desc_indexes[0] < vq->size))
+		prefetch_guest_buf(dev, vq->desc[desc_indexes[0]].addr);
 	for (i = 0; i < count; i++) {
 		uint16_t desc_idx = desc_indexes[i];
 		int err;
 
-		err = copy_mbuf_to_desc(dev, vq, pkts[i], desc_idx);
-		if (unlikely(err)) {
-			used_idx = (start_idx + i) & (vq->size - 1);
-			vq->used->ring[used_idx].len = dev->vhost_hlen;
-			vhost_log_used_vring(dev, vq,
-				offsetof(struct vring_used, ring[used_idx]),
-				sizeof(vq->used->ring[used_idx]));
-		}
+		if (i + 1 < count && likely(desc_indexes[i + 1] < vq->size))
+			prefetch_guest_buf(dev,
+					   vq->desc[desc_indexes[i + 1]].addr);
 
-		if (i + 1 < count)
-			rte_prefetch0(&vq->desc[desc_indexes[i+1]]);
+		if (unlikely(desc_idx >= vq->size))
+			err = -1;
+		else
+			err = copy_mbuf_to_desc(dev, vq, pkts[i], desc_idx,
+						NULL);
+		if (unlikely(err))
+			used_elems[i].len = dev->vhost_hlen;
 	}
 
-	rte_smp_wmb();
-
-	*(volatile uint16_t *)&vq->used->idx += count;
-	vq->last_used_idx += count;
-	vhost_log_used_vring(dev, vq,
-		offsetof(struct vring_used, idx),
-		sizeof(vq->used->idx));
+	flush_used_ring(dev, vq, used_elems, count);
 
 	/* flush used->idx update before we read avail->flags. */
 	rte_mb();
 
 	/* Kick the guest if necessary. */
-	if (!(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT)
-			&& (vq->callfd >= 0))
-		eventfd_write(vq->callfd, (eventfd_t)1);
+	vhost_vring_call(vq);
 	return count;
 }
 
@@ -332,27 +501,29 @@ fill_vec_buf(struct vhost_virtqueue *vq, uint32_t avail_idx,
 }
 
 /*
+ * Reserve the avail entries from cur_idx on needed to hold size bytes,
+ * appending their descs to buf_vec from *vec_idx on. *end and *vec_idx
+ * are only updated on success.
+ *
  * Returns -1 on fail, 0 on success
  */
 static inline int
-reserve_avail_buf_mergeable(struct vhost_virtqueue *vq, uint32_t size,
-			    uint16_t *end, struct buf_vector *buf_vec)
+reserve_avail_buf_mergeable(struct vhost_virtqueue *vq, uint16_t cur_idx,
+			    uint32_t size, uint16_t *end,
+			    struct buf_vector *buf_vec, uint32_t *vec_idx)
 {
-	uint16_t cur_idx;
 	uint16_t avail_idx;
 	uint32_t allocated = 0;
-	uint32_t vec_idx = 0;
+	uint32_t vec_id = *vec_idx;
 	uint16_t tries = 0;
 
-	cur_idx  = vq->last_used_idx;
-
 	while (1) {
 		avail_idx = *((volatile uint16_t *)&vq->avail->idx);
 		if (unlikely(cur_idx == avail_idx))
 			return -1;
 
 		if (unlikely(fill_vec_buf(vq, cur_idx, &allocated,
-					  &vec_idx, buf_vec) < 0))
+					  &vec_id, buf_vec) < 0))
 			return -1;
 
 		cur_idx++;
@@ -371,29 +542,38 @@ reserve_avail_buf_mergeable(struct vhost_virtqueue *vq, uint32_t size,
 	}
 
 	*end = cur_idx;
+	*vec_idx = vec_id;
 	return 0;
 }
 
+/*
+ * Copy one packet into the buffers reserved for it, from avail entry
+ * start_idx to end_idx, and fill in one used ring entry per avail entry
+ * in used_elems.
+ *
+ * Returns the number of used entries filled in, or 0 on fail.
+ */
 static inline uint32_t __attribute__((always_inline))
 copy_mbuf_to_desc_mergeable(struct virtio_net *dev, struct vhost_virtqueue *vq,
-			    uint16_t end_idx, struct rte_mbuf *m,
-			    struct buf_vector *buf_vec)
+			    uint16_t start_idx, uint16_t end_idx,
+			    struct rte_mbuf *m, struct buf_vector *buf_vec,
+			    struct vring_used_elem *used_elems,
+			    struct async_pkt *apkt)
 {
 	struct virtio_net_hdr_mrg_rxbuf virtio_hdr = {{0, 0, 0, 0, 0, 0}, 0};
 	uint32_t vec_idx = 0;
-	uint16_t start_idx = vq->last_used_idx;
-	uint16_t cur_idx = start_idx;
+	uint32_t nr_used = 0;
 	uint64_t desc_addr;
 	uint32_t mbuf_offset, mbuf_avail;
 	uint32_t desc_offset, desc_avail;
 	uint32_t cpy_len;
-	uint16_t desc_idx, used_idx;
+	uint16_t desc_idx;
 
 	if (unlikely(m == NULL))
 		return 0;
 
 	LOG_DEBUG(VHOST_DATA, "(%d) current index %d | end index %d\n",
-		dev->vid, cur_idx, end_idx);
+		dev->vid, start_idx, end_idx);
 
 	desc_addr = gpa_to_vva(dev, buf_vec[vec_idx].buf_addr);
 	if (buf_vec[vec_idx].buf_len < dev->vhost_hlen || !desc_addr)
@@ -407,7 +587,8 @@ copy_mbuf_to_desc_mergeable(struct virtio_net *dev, struct vhost_virtqueue *vq,
 
 	virtio_enqueue_offload(m, &virtio_hdr.hdr);
 	copy_virtio_net_hdr(dev, desc_addr, virtio_hdr);
-	vhost_log_write(dev, buf_vec[vec_idx].buf_addr, dev->vhost_hlen);
+	vhost_log_cache_write(dev, vq, buf_vec[vec_idx].buf_addr,
+			      dev->vhost_hlen);
 	PRINT_PACKET(dev, (uintptr_t)desc_addr, dev->vhost_hlen, 0);
 
 	desc_avail  = buf_vec[vec_idx].buf_len - dev->vhost_hlen;
@@ -422,13 +603,9 @@ copy_mbuf_to_desc_mergeable(struct virtio_net *dev, struct vhost_virtqueue *vq,
 
 			if (!(vq->desc[desc_idx].flags & VRING_DESC_F_NEXT)) {
 				/* Update used ring with desc information */
-				used_idx = cur_idx++ & (vq->size - 1);
-				vq->used->ring[used_idx].id  = desc_idx;
-				vq->used->ring[used_idx].len = desc_offset;
-				vhost_log_used_vring(dev, vq,
-					offsetof(struct vring_used,
-						 ring[used_idx]),
-					sizeof(vq->used->ring[used_idx]));
+				used_elems[nr_used].id  = desc_idx;
+				used_elems[nr_used].len = desc_offset;
+				nr_used++;
 			}
 
 			vec_idx++;
@@ -451,11 +628,17 @@ copy_mbuf_to_desc_mergeable(struct virtio_net *dev, struct vhost_virtqueue *vq,
 		}
 
 		cpy_len = RTE_MIN(desc_avail, mbuf_avail);
-		rte_memcpy((void *)((uintptr_t)(desc_addr + desc_offset)),
+		if (!async_copy_add(vq, apkt,
+			(void *)((uintptr_t)(desc_addr + desc_offset)),
 			rte_pktmbuf_mtod_offset(m, void *, mbuf_offset),
-			cpy_len);
-		vhost_log_write(dev, buf_vec[vec_idx].buf_addr + desc_offset,
-			cpy_len);
+			cpy_len, buf_vec[vec_idx].buf_addr + desc_offset)) {
+			rte_memcpy((void *)((uintptr_t)(desc_addr + desc_offset)),
+				rte_pktmbuf_mtod_offset(m, void *, mbuf_offset),
+				cpy_len);
+			vhost_log_cache_write(dev, vq,
+				buf_vec[vec_idx].buf_addr + desc_offset,
+				cpy_len);
+		}
 		PRINT_PACKET(dev, (uintptr_t)(desc_addr + desc_offset),
 			cpy_len, 0);
 
@@ -465,14 +648,11 @@ copy_mbuf_to_desc_mergeable(struct virtio_net *dev, struct vhost_virtqueue *vq,
 		desc_offset += cpy_len;
 	}
 
-	used_idx = cur_idx & (vq->size - 1);
-	vq->used->ring[used_idx].id = buf_vec[vec_idx].desc_idx;
-	vq->used->ring[used_idx].len = desc_offset;
-	vhost_log_used_vring(dev, vq,
-		offsetof(struct vring_used, ring[used_idx]),
-		sizeof(vq->used->ring[used_idx]));
+	used_elems[nr_used].id = buf_vec[vec_idx].desc_idx;
+	used_elems[nr_used].len = desc_offset;
+	nr_used++;
 
-	return end_idx - start_idx;
+	return nr_used;
 }
 
 static inline uint32_t __attribute__((always_inline))
@@ -480,9 +660,14 @@ virtio_dev_merge_rx(struct virtio_net *dev, uint16_t queue_id,
 	struct rte_mbuf **pkts, uint32_t count)
 {
 	struct vhost_virtqueue *vq;
-	uint32_t pkt_idx = 0, nr_used = 0;
-	uint16_t end;
+	uint32_t pkt_idx = 0, nr_used, nr_elems;
+	uint32_t first, last, i;
+	uint32_t vec_idx;
+	uint16_t cur_idx;
+	uint16_t pkt_end[MAX_PKT_BURST];
+	uint16_t pkt_vec[MAX_PKT_BURST];
 	struct buf_vector buf_vec[BUF_VECTOR_MAX];
+	struct vring_used_elem used_elems[BUF_VECTOR_MAX];
 
 	LOG_DEBUG(VHOST_DATA, "(%d) %s\n", dev->vid, __func__);
 	if (unlikely(!is_valid_virt_queue_idx(queue_id, 0, dev->virt_qp_nb))) {
@@ -492,32 +677,78 @@ virtio_dev_merge_rx(struct virtio_net *dev, uint16_t queue_id,
 	}
 
 	vq = dev->virtqueue[queue_id];
-	if (unlikely(vq->enabled == 0))
+	if (unlikely(vq->enabled == 0 || vq->async_ops != NULL))
 		return 0;
 
 	count = RTE_MIN((uint32_t)MAX_PKT_BURST, count);
 	if (count == 0)
 		return 0;
 
-	for (pkt_idx = 0; pkt_idx < count; pkt_idx++) {
-		uint32_t pkt_len = pkts[pkt_idx]->pkt_len + dev->vhost_hlen;
+	/*
+	 * Packets are handled in rounds, as many per round as buf_vec can
+	 * describe; that is the whole burst unless the packets are large.
+	 * Each used entry covers at least one buf_vec entry, so used_elems
+	 * can't overflow either.
+	 */
+	while (pkt_idx < count) {
+		/*
+		 * First pass: reserve the guest buffers of the packets,
+		 * reading their descs, and prefetch the packet data.
+		 */
+		first = pkt_idx;
+		cur_idx = vq->last_used_idx;
+		vec_idx = 0;
+		for (last = first; last < count; last++) {
+			uint32_t pkt_len = pkts[last]->pkt_len +
+					   dev->vhost_hlen;
+
+			pkt_vec[last] = vec_idx;
+			if (unlikely(reserve_avail_buf_mergeable(vq, cur_idx,
+					pkt_len, &pkt_end[last],
+					buf_vec, &vec_idx) < 0))
+				break;
 
-		if (unlikely(reserve_avail_buf_mergeable(vq, pkt_len,
-							 &end, buf_vec) < 0)) {
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[last], void *));
+			cur_idx = pkt_end[last];
+		}
+
+		if (unlikely(last == first)) {
 			LOG_DEBUG(VHOST_DATA,
 				"(%d) failed to get enough desc from vring\n",
 				dev->vid);
 			break;
 		}
 
-		nr_used = copy_mbuf_to_desc_mergeable(dev, vq, end,
-						      pkts[pkt_idx], buf_vec);
-		rte_smp_wmb();
+		/*
+		 * Second pass: copy, prefetching the first guest buffer
+		 * of the next packet while the current one is copied.
+		 */
+		prefetch_guest_buf(dev, buf_vec[pkt_vec[first]].buf_addr);
+		cur_idx = vq->last_used_idx;
+		nr_elems = 0;
+		for (i = first; i < last; i++) {
+			if (i + 1 < last)
+				prefetch_guest_buf(dev,
+					buf_vec[pkt_vec[i + 1]].buf_addr);
+
+			nr_used = copy_mbuf_to_desc_mergeable(dev, vq,
+					cur_idx, pkt_end[i], pkts[i],
+					&buf_vec[pkt_vec[i]],
+					&used_elems[nr_elems], NULL);
+			if (unlikely(nr_used != (uint16_t)(pkt_end[i] -
+							   cur_idx)))
+				break;
 
-		*(volatile uint16_t *)&vq->used->idx += nr_used;
-		vhost_log_used_vring(dev, vq, offsetof(struct vring_used, idx),
-			sizeof(vq->used->idx));
-		vq->last_used_idx += nr_used;
+			nr_elems += nr_used;
+			cur_idx = pkt_end[i];
+		}
+
+		if (nr_elems)
+			flush_used_ring(dev, vq, used_elems, nr_elems);
+
+		pkt_idx = i;
+		if (unlikely(i < last))
+			break;
 	}
 
 	if (likely(pkt_idx)) {
@@ -525,9 +756,7 @@ virtio_dev_merge_rx(struct virtio_net *dev, uint16_t queue_id,
 		rte_mb();
 
 		/* Kick the guest if necessary. */
-		if (!(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT)
-				&& (vq->callfd >= 0))
-			eventfd_write(vq->callfd, (eventfd_t)1);
+		vhost_vring_call(vq);
 	}
 
 	return pkt_idx;
@@ -678,10 +907,15 @@ make_rarp_packet(struct rte_mbuf *rarp_mbuf, const struct ether_addr *mac)
 	return 0;
 }
 
+/*
+ * Returns -1 on fail, otherwise the number of segments attached to guest
+ * memory, which is always 0 unless zcopy is set.
+ */
 static inline int __attribute__((always_inline))
 copy_desc_to_mbuf(struct virtio_net *dev, struct vhost_virtqueue *vq,
 		  struct rte_mbuf *m, uint16_t desc_idx,
-		  struct rte_mempool *mbuf_pool)
+		  struct rte_mempool *mbuf_pool, int zcopy,
+		  struct async_pkt *apkt)
 {
 	struct vring_desc *desc;
 	uint64_t desc_addr;
@@ -692,6 +926,8 @@ copy_desc_to_mbuf(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	struct virtio_net_hdr *hdr;
 	/* A counter to avoid desc dead loop chain */
 	uint32_t nr_desc = 1;
+	int nr_attached = 0;
+	uint64_t hpa;
 
 	desc = &vq->desc[desc_idx];
 	if (unlikely(desc->len < dev->vhost_hlen))
@@ -732,10 +968,35 @@ copy_desc_to_mbuf(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	mbuf_offset = 0;
 	mbuf_avail  = m->buf_len - RTE_PKTMBUF_HEADROOM;
 	while (1) {
-		cpy_len = RTE_MIN(desc_avail, mbuf_avail);
-		rte_memcpy(rte_pktmbuf_mtod_offset(cur, void *, mbuf_offset),
-			(void *)((uintptr_t)(desc_addr + desc_offset)),
-			cpy_len);
+		/*
+		 * In zero copy mode, an empty mbuf is attached to the rest
+		 * of the desc buffer as long as that is host physically
+		 * contiguous; otherwise the data is copied as usual.
+		 */
+		if (zcopy && mbuf_offset == 0 && desc_avail <= UINT16_MAX &&
+		    (hpa = gpa_to_hpa(dev, desc->addr + desc_offset,
+				      desc_avail)) != 0) {
+			cpy_len = desc_avail;
+			cur->buf_addr = (void *)(uintptr_t)
+					(desc_addr + desc_offset);
+			cur->buf_physaddr = hpa;
+			cur->buf_len = cpy_len;
+			cur->data_off = 0;
+			mbuf_avail = cpy_len;
+			nr_attached++;
+		} else {
+			cpy_len = RTE_MIN(desc_avail, mbuf_avail);
+			if (!async_copy_add(vq, apkt,
+				rte_pktmbuf_mtod_offset(cur, void *,
+							mbuf_offset),
+				(void *)((uintptr_t)(desc_addr + desc_offset)),
+				cpy_len, 0))
+				rte_memcpy(rte_pktmbuf_mtod_offset(cur, void *,
+								   mbuf_offset),
+					(void *)((uintptr_t)(desc_addr +
+							     desc_offset)),
+					cpy_len);
+		}
 
 		mbuf_avail  -= cpy_len;
 		mbuf_offset += cpy_len;
@@ -790,10 +1051,108 @@ copy_desc_to_mbuf(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	prev->data_len = mbuf_offset;
 	m->pkt_len    += mbuf_offset;
 
-	if (hdr->flags != 0 || hdr->gso_type != VIRTIO_NET_HDR_GSO_NONE)
-		vhost_dequeue_offload(hdr, m);
+	if (hdr->flags != 0 || hdr->gso_type != VIRTIO_NET_HDR_GSO_NONE) {
+		/* The headers can only be parsed once the data is copied */
+		if (apkt != NULL && apkt->nr_segs)
+			apkt->hdr = hdr;
+		else
+			vhost_dequeue_offload(hdr, m);
+	}
+
+	return nr_attached;
+}
 
-	return 0;
+static inline void __attribute__((always_inline))
+update_used_ring(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		 uint32_t used_idx, uint32_t desc_idx)
+{
+	vq->used->ring[used_idx].id  = desc_idx;
+	vq->used->ring[used_idx].len = 0;
+	vhost_log_used_vring(dev, vq,
+			offsetof(struct vring_used, ring[used_idx]),
+			sizeof(vq->used->ring[used_idx]));
+}
+
+static inline void __attribute__((always_inline))
+update_used_idx(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		uint32_t count)
+{
+	if (unlikely(count == 0))
+		return;
+
+	rte_smp_wmb();
+	rte_smp_rmb();
+
+	vq->used->idx += count;
+	vhost_log_used_vring(dev, vq, offsetof(struct vring_used, idx),
+			sizeof(vq->used->idx));
+
+	/* Kick guest if required. */
+	vhost_vring_call(vq);
+}
+
+static inline struct zcopy_mbuf *__attribute__((always_inline))
+get_zmbuf(struct vhost_virtqueue *vq)
+{
+	uint16_t i;
+	uint16_t last;
+	int tries = 0;
+
+	/* search [last_zmbuf_idx, zmbuf_size) */
+	i = vq->last_zmbuf_idx;
+	last = vq->zmbuf_size;
+
+again:
+	for (; i < last; i++) {
+		if (vq->zmbufs[i].in_use == 0) {
+			vq->last_zmbuf_idx = i + 1;
+			vq->zmbufs[i].in_use = 1;
+			return &vq->zmbufs[i];
+		}
+	}
+
+	tries++;
+	if (tries == 1) {
+		/* search [0, last_zmbuf_idx) */
+		i = 0;
+		last = vq->last_zmbuf_idx;
+		goto again;
+	}
+
+	return NULL;
+}
+
+/*
+ * Hand the descriptors of consumed zero copy mbufs back to the guest,
+ * and the mbufs themselves back to their pool. Returns the number of
+ * used ring entries written.
+ */
+static inline uint32_t __attribute__((always_inline))
+reclaim_zmbufs(struct virtio_net *dev, struct vhost_virtqueue *vq)
+{
+	struct zcopy_mbuf *zmbuf, *next;
+	uint32_t used_idx;
+	uint32_t nr_updated = 0;
+
+	for (zmbuf = TAILQ_FIRST(&vq->zmbuf_list);
+	     zmbuf != NULL; zmbuf = next) {
+		next = TAILQ_NEXT(zmbuf, next);
+
+		if (!mbuf_is_consumed(zmbuf->mbuf))
+			continue;
+
+		used_idx = vq->last_used_idx++ & (vq->size - 1);
+		update_used_ring(dev, vq, used_idx, zmbuf->desc_idx);
+		nr_updated += 1;
+
+		TAILQ_REMOVE(&vq->zmbuf_list, zmbuf, next);
+		restore_mbuf(zmbuf->mbuf);
+		rte_pktmbuf_free(zmbuf->mbuf);
+		zmbuf->in_use = 0;
+		vq->nr_zmbuf -= 1;
+	}
+
+	return nr_updated;
 }
 
 uint16_t
@@ -806,6 +1165,7 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 	uint32_t desc_indexes[MAX_PKT_BURST];
 	uint32_t used_idx;
 	uint32_t i = 0;
+	uint32_t nr_updated = 0;
 	uint16_t free_entries;
 	uint16_t avail_idx;
 
@@ -820,9 +1180,12 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 	}
 
 	vq = dev->virtqueue[queue_id];
-	if (unlikely(vq->enabled == 0))
+	if (unlikely(vq->enabled == 0 || vq->async_ops != NULL))
 		return 0;
 
+	if (unlikely(dev->dequeue_zero_copy))
+		nr_updated = reclaim_zmbufs(dev, vq);
+
 	/*
 	 * Construct a RARP broadcast packet, and inject it to the "pkts"
 	 * array, to looks like that guest actually send such packet.
@@ -835,7 +1198,7 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 		if (rarp_mbuf == NULL) {
 			RTE_LOG(ERR, VHOST_DATA,
 				"Failed to allocate memory for mbuf.\n");
-			return 0;
+			goto flush;
 		}
 
 		if (make_rarp_packet(rarp_mbuf, &dev->mac)) {
@@ -847,14 +1210,14 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 	}
 
 	avail_idx =  *((volatile uint16_t *)&vq->avail->idx);
-	free_entries = avail_idx - vq->last_used_idx;
+	free_entries = avail_idx - vq->last_avail_idx;
 	if (free_entries == 0)
-		goto out;
+		goto flush;
 
 	LOG_DEBUG(VHOST_DATA, "(%d) %s\n", dev->vid, __func__);
 
 	/* Prefetch available ring to retrieve head indexes. */
-	used_idx = vq->last_used_idx & (vq->size - 1);
+	used_idx = vq->last_avail_idx & (vq->size - 1);
 	rte_prefetch0(&vq->avail->ring[used_idx]);
 	rte_prefetch0(&vq->used->ring[used_idx]);
 
@@ -863,21 +1226,24 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 	LOG_DEBUG(VHOST_DATA, "(%d) about to dequeue %u buffers\n",
 			dev->vid, count);
 
-	/* Retrieve all of the head indexes first to avoid caching issues. */
+	/*
+	 * Retrieve all of the head indexes first to avoid caching issues.
+	 * Without zero copy, last_avail_idx equals last_used_idx and the
+	 * used ring is filled in right away.
+	 */
 	for (i = 0; i < count; i++) {
-		used_idx = (vq->last_used_idx + i) & (vq->size - 1);
+		used_idx = (vq->last_avail_idx + i) & (vq->size - 1);
 		desc_indexes[i] = vq->avail->ring[used_idx];
 
-		vq->used->ring[used_idx].id  = desc_indexes[i];
-		vq->used->ring[used_idx].len = 0;
-		vhost_log_used_vring(dev, vq,
-				offsetof(struct vring_used, ring[used_idx]),
-				sizeof(vq->used->ring[used_idx]));
+		if (likely(dev->dequeue_zero_copy == 0))
+			update_used_ring(dev, vq, used_idx, desc_indexes[i]);
 	}
 
 	/* Prefetch descriptor index. */
 	rte_prefetch0(&vq->desc[desc_indexes[0]]);
 	for (i = 0; i < count; i++) {
+		struct zcopy_mbuf *zmbuf = NULL;
+		struct rte_mbuf *seg;
 		int err;
 
 		if (likely(i + 1 < count))
@@ -889,27 +1255,58 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 				"Failed to allocate memory for mbuf.\n");
 			break;
 		}
+
+		/* Once the in-flight limit is hit, fall back to copying. */
+		if (unlikely(dev->dequeue_zero_copy) &&
+		    vq->nr_zmbuf < vq->zmbuf_size)
+			zmbuf = get_zmbuf(vq);
+
 		err = copy_desc_to_mbuf(dev, vq, pkts[i], desc_indexes[i],
-					mbuf_pool);
-		if (unlikely(err)) {
+					mbuf_pool, zmbuf != NULL, NULL);
+		if (unlikely(err < 0)) {
+			if (zmbuf != NULL) {
+				zmbuf->in_use = 0;
+				restore_mbuf(pkts[i]);
+			}
 			rte_pktmbuf_free(pkts[i]);
 			break;
 		}
+
+		if (likely(dev->dequeue_zero_copy == 0))
+			continue;
+
+		if (err == 0) {
+			/* Nothing references guest memory, return it now. */
+			if (zmbuf != NULL)
+				zmbuf->in_use = 0;
+			used_idx = vq->last_used_idx++ & (vq->size - 1);
+			update_used_ring(dev, vq, used_idx, desc_indexes[i]);
+			nr_updated += 1;
+			continue;
+		}
+
+		/*
+		 * Hold an extra reference on every segment; the mbuf is
+		 * consumed once the application has dropped its own.
+		 */
+		for (seg = pkts[i]; seg != NULL; seg = seg->next)
+			rte_mbuf_refcnt_update(seg, 1);
+
+		zmbuf->mbuf = pkts[i];
+		zmbuf->desc_idx = desc_indexes[i];
+		vq->nr_zmbuf += 1;
+		TAILQ_INSERT_TAIL(&vq->zmbuf_list, zmbuf, next);
 	}
 
-	rte_smp_wmb();
-	rte_smp_rmb();
-	vq->used->idx += i;
-	vq->last_used_idx += i;
-	vhost_log_used_vring(dev, vq, offsetof(struct vring_used, idx),
-			sizeof(vq->used->idx));
+	vq->last_avail_idx += i;
+	if (likely(dev->dequeue_zero_copy == 0)) {
+		vq->last_used_idx += i;
+		nr_updated = i;
+	}
 
-	/* Kick guest if required. */
-	if (!(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT)
-			&& (vq->callfd >= 0))
-		eventfd_write(vq->callfd, (eventfd_t)1);
+flush:
+	update_used_idx(dev, vq, nr_updated);
 
-out:
 	if (unlikely(rarp_mbuf != NULL)) {
 		/*
 		 * Inject it to the head of "pkts" array, so that switch's mac
@@ -922,3 +1319,363 @@ out:
 
 	return i;
 }
+
+static inline struct vhost_virtqueue *__attribute__((always_inline))
+get_async_vq(struct virtio_net *dev, uint16_t queue_id, int is_tx)
+{
+	struct vhost_virtqueue *vq;
+
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, is_tx,
+					      dev->virt_qp_nb))) {
+		RTE_LOG(ERR, VHOST_DATA, "(%d) %s: invalid virtqueue idx %d.\n",
+			dev->vid, __func__, queue_id);
+		return NULL;
+	}
+
+	vq = dev->virtqueue[queue_id];
+	if (unlikely(vq->enabled == 0 || vq->async_ops == NULL))
+		return NULL;
+
+	return vq;
+}
+
+static inline struct async_pkt *__attribute__((always_inline))
+get_async_pkt(struct vhost_virtqueue *vq, uint16_t i)
+{
+	struct async_pkt *apkt;
+
+	apkt = &vq->async_pkts[(uint16_t)(vq->async_pkts_idx + i) &
+			       (vq->size - 1)];
+	apkt->hdr = NULL;
+	apkt->nr_segs = 0;
+
+	return apkt;
+}
+
+/*
+ * Hand the copies of the count packets following async_pkts_idx to the
+ * engine. The copies of the jobs it doesn't take are done right away.
+ */
+static inline void __attribute__((always_inline))
+async_submit_jobs(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		  uint16_t queue_id, uint32_t count, int is_tx)
+{
+	struct rte_vhost_async_job jobs[MAX_PKT_BURST];
+	struct async_pkt *pkts[MAX_PKT_BURST];
+	struct async_pkt *apkt;
+	uint32_t nb_jobs = 0;
+	uint32_t i, j;
+	int ret;
+
+	for (i = 0; i < count; i++) {
+		apkt = &vq->async_pkts[(uint16_t)(vq->async_pkts_idx + i) &
+				       (vq->size - 1)];
+		if (apkt->nr_segs == 0)
+			continue;
+
+		jobs[nb_jobs].segs = apkt->segs;
+		jobs[nb_jobs].nb_segs = apkt->nr_segs;
+		pkts[nb_jobs++] = apkt;
+	}
+
+	if (nb_jobs == 0)
+		return;
+
+	ret = vq->async_ops->submit(vq->async_priv, dev->vid, queue_id,
+				    jobs, nb_jobs);
+	if (unlikely(ret < 0))
+		ret = 0;
+
+	for (i = ret; i < nb_jobs; i++) {
+		apkt = pkts[i];
+		for (j = 0; j < apkt->nr_segs; j++) {
+			rte_memcpy(apkt->segs[j].dst, apkt->segs[j].src,
+				   apkt->segs[j].len);
+			if (!is_tx)
+				vhost_log_cache_write(dev, vq,
+						      apkt->seg_gpa[j],
+						      apkt->segs[j].len);
+		}
+		apkt->nr_segs = 0;
+	}
+}
+
+/*
+ * Retrieve the oldest in-flight packets of a virtqueue whose copies are
+ * done, and give their descriptors back to the guest.
+ */
+static inline uint16_t __attribute__((always_inline))
+async_poll_completed(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		     uint16_t queue_id, struct rte_mbuf **pkts,
+		     uint16_t count, int is_tx)
+{
+	struct async_pkt *apkt;
+	uint32_t nr_used = 0;
+	uint16_t start;
+	uint16_t i, j;
+	int ret;
+
+	if (vq->async_pkts_inflight == 0)
+		return 0;
+
+	ret = vq->async_ops->poll(vq->async_priv, dev->vid, queue_id,
+				  vq->async_pkts_inflight - vq->async_credits);
+	if (likely(ret > 0))
+		vq->async_credits += ret;
+
+	count = RTE_MIN(count, vq->async_pkts_inflight);
+	start = vq->async_pkts_idx - vq->async_pkts_inflight;
+	for (i = 0; i < count; i++) {
+		apkt = &vq->async_pkts[(uint16_t)(start + i) & (vq->size - 1)];
+		if (apkt->nr_segs) {
+			/* Jobs complete in order */
+			if (vq->async_credits == 0)
+				break;
+			vq->async_credits--;
+
+			if (!is_tx) {
+				for (j = 0; j < apkt->nr_segs; j++)
+					vhost_log_cache_write(dev, vq,
+						apkt->seg_gpa[j],
+						apkt->segs[j].len);
+			}
+		}
+
+		if (is_tx && apkt->hdr != NULL)
+			vhost_dequeue_offload(apkt->hdr, apkt->mbuf);
+
+		pkts[i] = apkt->mbuf;
+		nr_used += apkt->nr_used;
+	}
+
+	vq->async_pkts_inflight -= i;
+
+	if (nr_used) {
+		publish_used_ring(dev, vq, nr_used);
+
+		/* flush used->idx update before we read avail->flags. */
+		rte_mb();
+
+		/* Kick the guest if necessary. */
+		vhost_vring_call(vq);
+	} else {
+		vhost_log_cache_sync(dev, vq);
+	}
+
+	return i;
+}
+
+uint16_t
+rte_vhost_submit_enqueue_burst(int vid, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint16_t count)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+	struct vring_used_elem used_elems[BUF_VECTOR_MAX];
+	struct buf_vector buf_vec[BUF_VECTOR_MAX];
+	struct async_pkt *apkt;
+	uint32_t nr_elems = 0;
+	uint32_t vec_idx, nr_used;
+	uint16_t avail_idx, cur_idx, end_idx, desc_idx;
+	uint32_t i;
+
+	if (!dev)
+		return 0;
+
+	vq = get_async_vq(dev, queue_id, 0);
+	if (unlikely(vq == NULL))
+		return 0;
+
+	count = RTE_MIN(count, MAX_PKT_BURST);
+	count = RTE_MIN(count, vq->size - vq->async_pkts_inflight);
+
+	avail_idx = *((volatile uint16_t *)&vq->avail->idx);
+	cur_idx = vq->last_avail_idx;
+
+	/*
+	 * The used entries are written right away, past used->idx where
+	 * the guest doesn't look yet; they are only handed to it once the
+	 * copies are done.
+	 */
+	for (i = 0; i < count; i++) {
+		apkt = get_async_pkt(vq, i);
+
+		if (dev->features & (1 << VIRTIO_NET_F_MRG_RXBUF)) {
+			vec_idx = 0;
+			if (unlikely(reserve_avail_buf_mergeable(vq, cur_idx,
+					pkts[i]->pkt_len + dev->vhost_hlen,
+					&end_idx, buf_vec, &vec_idx) < 0))
+				break;
+			/* Bounded by the BUF_VECTOR_MAX descs reserved */
+			if (nr_elems + (uint16_t)(end_idx - cur_idx) >
+			    BUF_VECTOR_MAX)
+				break;
+
+			nr_used = copy_mbuf_to_desc_mergeable(dev, vq,
+					cur_idx, end_idx, pkts[i], buf_vec,
+					&used_elems[nr_elems], apkt);
+			if (unlikely(nr_used != (uint16_t)(end_idx -
+							   cur_idx)))
+				break;
+		} else {
+			if (cur_idx == avail_idx || nr_elems == BUF_VECTOR_MAX)
+				break;
+
+			end_idx = cur_idx + 1;
+			nr_used = 1;
+			desc_idx = vq->avail->ring[cur_idx & (vq->size - 1)];
+			used_elems[nr_elems].id = desc_idx;
+			used_elems[nr_elems].len = pkts[i]->pkt_len +
+						   dev->vhost_hlen;
+			if (unlikely(desc_idx >= vq->size ||
+				     copy_mbuf_to_desc(dev, vq, pkts[i],
+						       desc_idx, apkt))) {
+				used_elems[nr_elems].len = dev->vhost_hlen;
+				apkt->nr_segs = 0;
+			}
+		}
+
+		apkt->mbuf = pkts[i];
+		apkt->nr_used = nr_used;
+		nr_elems += nr_used;
+		cur_idx = end_idx;
+	}
+
+	if (i == 0)
+		return 0;
+
+	write_used_ring(dev, vq, vq->last_avail_idx, used_elems, nr_elems);
+	async_submit_jobs(dev, vq, queue_id, i, 0);
+
+	vq->last_avail_idx = cur_idx;
+	vq->async_pkts_idx += i;
+	vq->async_pkts_inflight += i;
+	vhost_log_cache_sync(dev, vq);
+
+	return i;
+}
+
+uint16_t
+rte_vhost_poll_enqueue_completed(int vid, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint16_t count)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+
+	if (!dev)
+		return 0;
+
+	vq = get_async_vq(dev, queue_id, 0);
+	if (unlikely(vq == NULL))
+		return 0;
+
+	return async_poll_completed(dev, vq, queue_id, pkts, count, 0);
+}
+
+uint16_t
+rte_vhost_submit_dequeue_burst(int vid, uint16_t queue_id,
+	struct rte_mempool *mbuf_pool, uint16_t count)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+	struct vring_used_elem used_elems[MAX_PKT_BURST];
+	struct rte_mbuf *rarp_mbuf = NULL;
+	struct async_pkt *apkt;
+	uint16_t free_entries, avail_idx, desc_idx;
+	uint32_t nr_pkts = 0;
+	uint32_t i;
+
+	if (!dev)
+		return 0;
+
+	vq = get_async_vq(dev, queue_id, 1);
+	if (unlikely(vq == NULL))
+		return 0;
+
+	count = RTE_MIN(count, MAX_PKT_BURST);
+	count = RTE_MIN(count, vq->size - vq->async_pkts_inflight);
+	if (count == 0)
+		return 0;
+
+	/*
+	 * Same as rte_vhost_dequeue_burst(): the RARP packet, which uses no
+	 * descriptor, goes first.
+	 */
+	if (unlikely(rte_atomic16_cmpset((volatile uint16_t *)
+					 &dev->broadcast_rarp.cnt, 1, 0))) {
+		rarp_mbuf = rte_pktmbuf_alloc(mbuf_pool);
+		if (rarp_mbuf == NULL) {
+			RTE_LOG(ERR, VHOST_DATA,
+				"Failed to allocate memory for mbuf.\n");
+		} else if (make_rarp_packet(rarp_mbuf, &dev->mac)) {
+			rte_pktmbuf_free(rarp_mbuf);
+		} else {
+			apkt = get_async_pkt(vq, 0);
+			apkt->mbuf = rarp_mbuf;
+			apkt->nr_used = 0;
+			nr_pkts = 1;
+		}
+	}
+
+	avail_idx = *((volatile uint16_t *)&vq->avail->idx);
+	free_entries = avail_idx - vq->last_avail_idx;
+	count = RTE_MIN(count - nr_pkts, free_entries);
+
+	rte_prefetch0(&vq->avail->ring[vq->last_avail_idx & (vq->size - 1)]);
+	for (i = 0; i < count; i++) {
+		desc_idx = vq->avail->ring[(vq->last_avail_idx + i) &
+					   (vq->size - 1)];
+		if (unlikely(desc_idx >= vq->size))
+			break;
+
+		apkt = get_async_pkt(vq, nr_pkts);
+		apkt->mbuf = rte_pktmbuf_alloc(mbuf_pool);
+		if (unlikely(apkt->mbuf == NULL)) {
+			RTE_LOG(ERR, VHOST_DATA,
+				"Failed to allocate memory for mbuf.\n");
+			break;
+		}
+
+		if (unlikely(copy_desc_to_mbuf(dev, vq, apkt->mbuf, desc_idx,
+					       mbuf_pool, 0, apkt) < 0)) {
+			rte_pktmbuf_free(apkt->mbuf);
+			break;
+		}
+
+		apkt->nr_used = 1;
+		used_elems[i].id = desc_idx;
+		used_elems[i].len = 0;
+		nr_pkts++;
+	}
+
+	if (nr_pkts == 0)
+		return 0;
+
+	if (i)
+		write_used_ring(dev, vq, vq->last_avail_idx, used_elems, i);
+	async_submit_jobs(dev, vq, queue_id, nr_pkts, 1);
+
+	vq->last_avail_idx += i;
+	vq->async_pkts_idx += nr_pkts;
+	vq->async_pkts_inflight += nr_pkts;
+	vhost_log_cache_sync(dev, vq);
+
+	return nr_pkts;
+}
+
+uint16_t
+rte_vhost_poll_dequeue_completed(int vid, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint16_t count)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+
+	if (!dev)
+		return 0;
+
+	vq = get_async_vq(dev, queue_id, 1);
+	if (unlikely(vq == NULL))
+		return 0;
+
+	return async_poll_completed(dev, vq, queue_id, pkts, count, 1);
+}
@@ -0,0 +1,462 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_atomic.h>
+#include <rte_spinlock.h>
+#include <rte_cycles.h>
+#include <rte_branch_prediction.h>
+
+#include "rte_vhost_sched.h"
+#include "vhost-net.h"
+
+/*
+ * Moving a virtqueue is only worth it if the load difference between
+ * the two lcores is over 1/VHOST_SCHED_IMBALANCE of the busiest one's.
+ */
+#define VHOST_SCHED_IMBALANCE 8
+
+struct sched_queue {
+	/* claimed by the lcore running the handler, or by a deletion */
+	volatile uint32_t busy;
+	volatile uint32_t active;
+	/* pool index of the lcore it is homed on */
+	volatile uint16_t home;
+	uint16_t queue_id;
+	int vid;
+	void *arg;
+	/* packets handled, and how many at the last rebalancing */
+	uint64_t pkts;
+	uint64_t pkts_prev;
+} __rte_cache_aligned;
+
+struct sched_lcore_stats {
+	uint64_t rounds;
+	uint64_t idle_rounds;
+	uint64_t runs;
+	uint64_t steals;
+} __rte_cache_aligned;
+
+struct rte_vhost_sched {
+	struct rte_vhost_sched_conf conf;
+	rte_atomic16_t nb_running;
+	volatile int stop;
+	/* serializes queue add and del */
+	rte_spinlock_t lock;
+	/* slots in use are below nb_slots */
+	volatile uint16_t nb_slots;
+	uint64_t rebalance_cycles;
+	uint64_t nb_moves;
+	uint64_t *lcore_load;
+	struct sched_lcore_stats *stats;
+	struct sched_queue queues[0];
+};
+
+struct rte_vhost_sched *
+rte_vhost_sched_create(const struct rte_vhost_sched_conf *conf)
+{
+	struct rte_vhost_sched *sched;
+
+	if (conf == NULL || conf->handler == NULL || conf->nb_lcores == 0 ||
+	    conf->max_queues == 0)
+		return NULL;
+
+	sched = rte_zmalloc_socket(NULL, sizeof(*sched) +
+			conf->max_queues * sizeof(struct sched_queue),
+			RTE_CACHE_LINE_SIZE, conf->socket_id);
+	if (sched == NULL)
+		return NULL;
+
+	sched->stats = rte_zmalloc_socket(NULL,
+			conf->nb_lcores * sizeof(struct sched_lcore_stats),
+			RTE_CACHE_LINE_SIZE, conf->socket_id);
+	sched->lcore_load = rte_zmalloc_socket(NULL,
+			conf->nb_lcores * sizeof(uint64_t), 0,
+			conf->socket_id);
+	if (sched->stats == NULL || sched->lcore_load == NULL) {
+		rte_vhost_sched_free(sched);
+		return NULL;
+	}
+
+	sched->conf = *conf;
+	rte_atomic16_init(&sched->nb_running);
+	rte_spinlock_init(&sched->lock);
+	sched->rebalance_cycles = rte_get_timer_hz() * conf->rebalance_ms /
+				  1000;
+
+	return sched;
+}
+
+void
+rte_vhost_sched_free(struct rte_vhost_sched *sched)
+{
+	if (sched == NULL)
+		return;
+
+	rte_free(sched->stats);
+	rte_free(sched->lcore_load);
+	rte_free(sched);
+}
+
+static struct sched_queue *
+sched_queue_lookup(struct rte_vhost_sched *sched, int vid, uint16_t queue_id)
+{
+	struct sched_queue *q;
+	uint16_t i;
+
+	for (i = 0; i < sched->nb_slots; i++) {
+		q = &sched->queues[i];
+		if (q->active && q->vid == vid && q->queue_id == queue_id)
+			return q;
+	}
+
+	return NULL;
+}
+
+int
+rte_vhost_sched_queue_add(struct rte_vhost_sched *sched, int vid,
+			  uint16_t queue_id, void *arg)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct sched_queue *q = NULL;
+	uint16_t nb_queues[sched->conf.nb_lcores];
+	uint16_t i, home = 0;
+
+	if (dev == NULL)
+		return -1;
+
+	if (queue_id >= dev->virt_qp_nb * VIRTIO_QNUM) {
+		RTE_LOG(ERR, VHOST_CONFIG, "(%d) %s: invalid virtqueue idx %d.\n",
+			vid, __func__, queue_id);
+		return -1;
+	}
+
+	rte_spinlock_lock(&sched->lock);
+
+	if (sched_queue_lookup(sched, vid, queue_id) != NULL) {
+		rte_spinlock_unlock(&sched->lock);
+		return -1;
+	}
+
+	memset(nb_queues, 0, sizeof(nb_queues));
+	for (i = 0; i < sched->nb_slots; i++) {
+		if (sched->queues[i].active)
+			nb_queues[sched->queues[i].home]++;
+		else if (q == NULL)
+			q = &sched->queues[i];
+	}
+
+	if (q == NULL) {
+		if (sched->nb_slots == sched->conf.max_queues) {
+			rte_spinlock_unlock(&sched->lock);
+			RTE_LOG(ERR, VHOST_CONFIG,
+				"(%d) no room left to schedule vring %u\n",
+				vid, queue_id);
+			return -1;
+		}
+		q = &sched->queues[sched->nb_slots];
+	}
+
+	for (i = 1; i < sched->conf.nb_lcores; i++) {
+		if (nb_queues[i] < nb_queues[home])
+			home = i;
+	}
+
+	/* The scheduler polls, the guest doesn't need to kick. */
+	rte_vhost_enable_guest_notification(vid, queue_id, 0);
+	dev->virtqueue[queue_id]->call_batched = 1;
+
+	q->vid = vid;
+	q->queue_id = queue_id;
+	q->arg = arg;
+	q->home = home;
+	q->pkts = 0;
+	q->pkts_prev = 0;
+	q->busy = 0;
+	rte_smp_wmb();
+	q->active = 1;
+	if (q == &sched->queues[sched->nb_slots])
+		sched->nb_slots++;
+
+	rte_spinlock_unlock(&sched->lock);
+
+	RTE_LOG(INFO, VHOST_CONFIG, "(%d) vring %u scheduled on lcore %u\n",
+		vid, queue_id, home);
+
+	return 0;
+}
+
+int
+rte_vhost_sched_queue_del(struct rte_vhost_sched *sched, int vid,
+			  uint16_t queue_id)
+{
+	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
+	struct sched_queue *q;
+
+	rte_spinlock_lock(&sched->lock);
+
+	q = sched_queue_lookup(sched, vid, queue_id);
+	if (q == NULL) {
+		rte_spinlock_unlock(&sched->lock);
+		return -1;
+	}
+
+	/*
+	 * Wait for the handler to return. The slot then stays claimed until
+	 * reused, so an lcore that saw it active can't run it any more.
+	 */
+	q->active = 0;
+	rte_mb();
+	while (!rte_atomic32_cmpset(&q->busy, 0, 1))
+		rte_pause();
+
+	dev = get_device(vid);
+	if (dev != NULL) {
+		vq = dev->virtqueue[queue_id];
+		vq->call_batched = 0;
+		vhost_vring_call_flush(vq);
+		/* Nobody polls it any more, let the guest kick again. */
+		rte_vhost_enable_guest_notification(vid, queue_id, 1);
+	}
+
+	rte_spinlock_unlock(&sched->lock);
+
+	return 0;
+}
+
+/* Whether a virtqueue has work for its handler. */
+static inline int __attribute__((always_inline))
+sched_queue_pending(struct sched_queue *q, struct vhost_virtqueue *vq)
+{
+	if (unlikely(vq->enabled == 0))
+		return 0;
+
+	if (vq->async_pkts_inflight || vq->nr_zmbuf)
+		return 1;
+
+	if ((q->queue_id & 1) == 0)
+		return 0;
+
+	return *((volatile uint16_t *)&vq->avail->idx) != vq->last_avail_idx;
+}
+
+/*
+ * Run the handler of the pending virtqueues homed on lcore id or, when
+ * stealing, of those homed elsewhere. Returns the number of runs.
+ */
+static uint32_t
+sched_round(struct rte_vhost_sched *sched, uint16_t id, int steal)
+{
+	struct sched_queue *q;
+	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
+	uint32_t runs = 0;
+	uint16_t i;
+
+	for (i = 0; i < sched->nb_slots; i++) {
+		q = &sched->queues[i];
+		if (!q->active || (q->home == id) == steal)
+			continue;
+
+		dev = get_device(q->vid);
+		if (unlikely(dev == NULL))
+			continue;
+		vq = dev->virtqueue[q->queue_id];
+
+		/* Interrupts held back by handlers of other virtqueues */
+		if (!steal)
+			vhost_vring_call_flush(vq);
+
+		if (!sched_queue_pending(q, vq) ||
+		    !rte_atomic32_cmpset(&q->busy, 0, 1))
+			continue;
+
+		/* Deleted in between */
+		if (unlikely(!q->active)) {
+			q->busy = 0;
+			continue;
+		}
+
+		q->pkts += sched->conf.handler(q->vid, q->queue_id, q->arg);
+		vhost_vring_call_flush(vq);
+
+		rte_smp_wmb();
+		q->busy = 0;
+		runs++;
+	}
+
+	return runs;
+}
+
+/*
+ * Move one virtqueue from the most to the least loaded lcore, if that
+ * reduces the imbalance between them.
+ */
+static void
+sched_rebalance(struct rte_vhost_sched *sched)
+{
+	uint64_t *load = sched->lcore_load;
+	struct sched_queue *q, *best = NULL;
+	uint64_t pkts, diff, best_load = 0;
+	uint16_t i, max = 0, min = 0;
+
+	memset(load, 0, sched->conf.nb_lcores * sizeof(*load));
+	for (i = 0; i < sched->nb_slots; i++) {
+		q = &sched->queues[i];
+		if (!q->active)
+			continue;
+
+		pkts = q->pkts;
+		load[q->home] += pkts - q->pkts_prev;
+	}
+
+	for (i = 1; i < sched->conf.nb_lcores; i++) {
+		if (load[i] > load[max])
+			max = i;
+		if (load[i] < load[min])
+			min = i;
+	}
+
+	diff = load[max] - load[min];
+	if (diff <= load[max] / VHOST_SCHED_IMBALANCE)
+		goto out;
+
+	/* The largest load below diff shrinks the gap the most. */
+	for (i = 0; i < sched->nb_slots; i++) {
+		q = &sched->queues[i];
+		if (!q->active || q->home != max)
+			continue;
+
+		pkts = q->pkts - q->pkts_prev;
+		if (pkts > best_load && pkts < diff) {
+			best = q;
+			best_load = pkts;
+		}
+	}
+
+	if (best != NULL) {
+		best->home = min;
+		sched->nb_moves++;
+		RTE_LOG(DEBUG, VHOST_CONFIG,
+			"(%d) vring %u moved from lcore %u to lcore %u\n",
+			best->vid, best->queue_id, max, min);
+	}
+
+out:
+	for (i = 0; i < sched->nb_slots; i++)
+		sched->queues[i].pkts_prev = sched->queues[i].pkts;
+}
+
+int
+rte_vhost_sched_run(void *arg)
+{
+	struct rte_vhost_sched *sched = arg;
+	struct sched_lcore_stats *stats;
+	uint64_t next_rebalance = 0;
+	uint32_t runs;
+	uint16_t id;
+
+	id = rte_atomic16_add_return(&sched->nb_running, 1) - 1;
+	if (id >= sched->conf.nb_lcores) {
+		rte_atomic16_dec(&sched->nb_running);
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"vhost scheduler already has %u lcores\n",
+			sched->conf.nb_lcores);
+		return -1;
+	}
+
+	stats = &sched->stats[id];
+	if (id == 0 && sched->rebalance_cycles)
+		next_rebalance = rte_get_timer_cycles() +
+				 sched->rebalance_cycles;
+
+	while (!sched->stop) {
+		stats->rounds++;
+		runs = sched_round(sched, id, 0);
+		if (runs == 0) {
+			stats->idle_rounds++;
+			runs = sched_round(sched, id, 1);
+			stats->steals += runs;
+			if (runs == 0)
+				rte_pause();
+		}
+		stats->runs += runs;
+
+		if (next_rebalance && rte_get_timer_cycles() >= next_rebalance) {
+			sched_rebalance(sched);
+			next_rebalance += sched->rebalance_cycles;
+		}
+	}
+
+	rte_atomic16_dec(&sched->nb_running);
+
+	return 0;
+}
+
+void
+rte_vhost_sched_stop(struct rte_vhost_sched *sched)
+{
+	sched->stop = 1;
+}
+
+void
+rte_vhost_sched_dump(FILE *f, struct rte_vhost_sched *sched)
+{
+	struct sched_lcore_stats *stats;
+	struct sched_queue *q;
+	uint16_t i;
+
+	fprintf(f, "vhost scheduler <%p>\n", sched);
+	fprintf(f, "  moves=%"PRIu64"\n", sched->nb_moves);
+	for (i = 0; i < sched->conf.nb_lcores; i++) {
+		stats = &sched->stats[i];
+		fprintf(f, "  lcore %u: rounds=%"PRIu64" idle_rounds=%"PRIu64
+			" runs=%"PRIu64" steals=%"PRIu64"\n", i,
+			stats->rounds, stats->idle_rounds, stats->runs,
+			stats->steals);
+	}
+	for (i = 0; i < sched->nb_slots; i++) {
+		q = &sched->queues[i];
+		if (!q->active)
+			continue;
+		fprintf(f, "  vid %d vring %u: lcore=%u pkts=%"PRIu64"\n",
+			q->vid, q->queue_id, q->home, q->pkts);
+	}
+}
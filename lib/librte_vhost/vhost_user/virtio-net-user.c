@@ -42,6 +42,7 @@
 
 #include <rte_common.h>
 #include <rte_log.h>
+#include <rte_memory.h>
 
 #include "virtio-net-user.h"
 #include "vhost-net-user.h"
@@ -88,10 +89,84 @@ free_mem_region(struct virtio_net *dev)
 	}
 }
 
+static int
+add_one_guest_page(struct virtio_net *dev, uint64_t guest_phys_addr,
+		   uint64_t host_phys_addr, uint64_t size)
+{
+	struct guest_page *page, *last_page;
+	void *pages;
+
+	if (dev->nr_guest_pages == dev->max_guest_pages) {
+		dev->max_guest_pages = RTE_MAX(8U, dev->max_guest_pages * 2);
+		pages = realloc(dev->guest_pages,
+				dev->max_guest_pages * sizeof(*page));
+		if (pages == NULL)
+			return -1;
+		dev->guest_pages = pages;
+	}
+
+	if (dev->nr_guest_pages > 0) {
+		last_page = &dev->guest_pages[dev->nr_guest_pages - 1];
+		/* merge if the two pages are continuous */
+		if (host_phys_addr == last_page->host_phys_addr +
+				      last_page->size &&
+		    guest_phys_addr == last_page->guest_phys_addr +
+				       last_page->size) {
+			last_page->size += size;
+			return 0;
+		}
+	}
+
+	page = &dev->guest_pages[dev->nr_guest_pages++];
+	page->guest_phys_addr = guest_phys_addr;
+	page->host_phys_addr  = host_phys_addr;
+	page->size = size;
+
+	return 0;
+}
+
+/*
+ * Record the host physical layout of a guest memory region, one backing
+ * page at a time. Pages whose address can't be resolved, e.g. not faulted
+ * in, are skipped, and dequeue falls back to copying for buffers in them.
+ */
+static void
+add_guest_pages(struct virtio_net *dev, struct virtio_memory_regions *reg,
+		uint64_t page_size)
+{
+	uint64_t reg_size = reg->memory_size;
+	uint64_t host_user_addr = reg->guest_phys_address +
+				  reg->address_offset;
+	uint64_t guest_phys_addr = reg->guest_phys_address;
+	uint64_t host_phys_addr;
+	uint64_t size;
+
+	while (reg_size > 0) {
+		size = RTE_MIN(reg_size, page_size -
+			       (host_user_addr & (page_size - 1)));
+		host_phys_addr = rte_mem_virt2phy((void *)(uintptr_t)
+						  host_user_addr);
+		if (host_phys_addr != RTE_BAD_PHYS_ADDR &&
+		    add_one_guest_page(dev, guest_phys_addr,
+				       host_phys_addr, size) < 0) {
+			RTE_LOG(ERR, VHOST_CONFIG,
+				"(%d) failed to allocate guest pages\n",
+				dev->vid);
+			return;
+		}
+
+		host_user_addr  += size;
+		guest_phys_addr += size;
+		reg_size -= size;
+	}
+}
+
 void
 vhost_backend_cleanup(struct virtio_net *dev)
 {
 	if (dev->mem) {
+		/* the copy engine may still be writing to the old regions */
+		vhost_drain_async(dev);
 		free_mem_region(dev);
 		free(dev->mem);
 		dev->mem = NULL;
@@ -100,6 +175,10 @@ vhost_backend_cleanup(struct virtio_net *dev)
 		munmap((void *)(uintptr_t)dev->log_addr, dev->log_size);
 		dev->log_addr = 0;
 	}
+	free(dev->guest_pages);
+	dev->guest_pages = NULL;
+	dev->nr_guest_pages = 0;
+	dev->max_guest_pages = 0;
 }
 
 int
@@ -141,6 +220,7 @@ user_set_mem_table(int vid, struct VhostUserMsg *pmsg)
 		return -1;
 	}
 	dev->mem->nregions = memory.nregions;
+	dev->nr_guest_pages = 0;
 
 	pregion_orig = orig_region(dev->mem, memory.nregions);
 	for (idx = 0; idx < memory.nregions; idx++) {
@@ -175,9 +255,11 @@ user_set_mem_table(int vid, struct VhostUserMsg *pmsg)
 		}
 		mapped_size = RTE_ALIGN_CEIL(mapped_size, alignment);
 
+		/* zero copy needs the physical address of every page */
 		mapped_address = (uint64_t)(uintptr_t)mmap(NULL,
 			mapped_size,
-			PROT_READ | PROT_WRITE, MAP_SHARED,
+			PROT_READ | PROT_WRITE, MAP_SHARED |
+			(dev->dequeue_zero_copy ? MAP_POPULATE : 0),
 			pmsg->fds[idx],
 			0);
 
@@ -204,6 +286,9 @@ user_set_mem_table(int vid, struct VhostUserMsg *pmsg)
 		pregion->address_offset = mapped_address -
 			pregion->guest_phys_address;
 
+		if (dev->dequeue_zero_copy)
+			add_guest_pages(dev, pregion, alignment);
+
 		if (memory.regions[idx].guest_phys_addr == 0) {
 			dev->mem->base_address =
 				memory.regions[idx].userspace_addr;
@@ -322,7 +407,10 @@ user_get_vring_base(int vid, struct vhost_vring_state *state)
 		notify_ops->destroy_device(vid);
 	}
 
-	/* Here we are safe to get the last used index */
+	/*
+	 * Here we are safe to get the last used index. The async copies
+	 * in flight on the vring are drained and their packets dropped.
+	 */
 	vhost_get_vring_base(vid, state->index, state);
 
 	RTE_LOG(INFO, VHOST_CONFIG,
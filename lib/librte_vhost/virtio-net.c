@@ -120,9 +120,129 @@ get_device(int vid)
 	return dev;
 }
 
+/*
+ * Give back the zero copy mbufs the application is done with. Those still
+ * referenced are left alone: they keep pointing at guest memory, so they
+ * can't be returned to their pool.
+ */
+static void
+free_zmbufs(struct vhost_virtqueue *vq)
+{
+	struct zcopy_mbuf *zmbuf, *next;
+	uint32_t leaked = 0;
+
+	if (vq->zmbufs == NULL)
+		return;
+
+	for (zmbuf = TAILQ_FIRST(&vq->zmbuf_list);
+	     zmbuf != NULL; zmbuf = next) {
+		next = TAILQ_NEXT(zmbuf, next);
+
+		if (mbuf_is_consumed(zmbuf->mbuf)) {
+			restore_mbuf(zmbuf->mbuf);
+			rte_pktmbuf_free(zmbuf->mbuf);
+		} else {
+			leaked++;
+		}
+		TAILQ_REMOVE(&vq->zmbuf_list, zmbuf, next);
+	}
+
+	if (leaked)
+		RTE_LOG(WARNING, VHOST_CONFIG,
+			"%u zero copy mbufs still in use, not reclaimed\n",
+			leaked);
+
+	rte_free(vq->zmbufs);
+	vq->zmbufs = NULL;
+	vq->zmbuf_size = 0;
+	vq->nr_zmbuf = 0;
+	vq->last_zmbuf_idx = 0;
+}
+
+/*
+ * Wait until the copy engine is done with the packets still in flight,
+ * so that it no longer reads or writes their buffers and guest memory,
+ * then drop them. Their descriptors are not given back to the guest,
+ * the vring is going away.
+ */
+static void
+drain_async(struct virtio_net *dev, uint32_t queue_id)
+{
+	struct vhost_virtqueue *vq = dev->virtqueue[queue_id];
+	struct async_pkt *apkt;
+	uint32_t i, nr_jobs;
+	uint16_t start;
+	int ret;
+
+	if (vq->async_pkts_inflight == 0)
+		return;
+
+	RTE_LOG(WARNING, VHOST_CONFIG,
+		"(%d) draining %u packets in flight on vring %u\n",
+		dev->vid, vq->async_pkts_inflight, queue_id);
+
+	start = vq->async_pkts_idx - vq->async_pkts_inflight;
+	nr_jobs = 0;
+	for (i = 0; i < vq->async_pkts_inflight; i++) {
+		apkt = &vq->async_pkts[(uint16_t)(start + i) & (vq->size - 1)];
+		if (apkt->nr_segs)
+			nr_jobs++;
+	}
+
+	while (vq->async_credits < nr_jobs) {
+		ret = vq->async_ops->poll(vq->async_priv, dev->vid, queue_id,
+					  nr_jobs - vq->async_credits);
+		if (ret > 0)
+			vq->async_credits += ret;
+		else
+			rte_pause();
+	}
+
+	for (i = 0; i < vq->async_pkts_inflight; i++) {
+		apkt = &vq->async_pkts[(uint16_t)(start + i) & (vq->size - 1)];
+		rte_pktmbuf_free(apkt->mbuf);
+	}
+	vq->async_pkts_inflight = 0;
+	vq->async_credits = 0;
+}
+
+void
+vhost_drain_async(struct virtio_net *dev)
+{
+	uint32_t i;
+
+	for (i = 0; i < dev->virt_qp_nb * VIRTIO_QNUM; i++)
+		if (dev->virtqueue[i] != NULL &&
+				dev->virtqueue[i]->async_ops != NULL)
+			drain_async(dev, i);
+}
+
+static void
+free_async(struct virtio_net *dev, uint32_t queue_id)
+{
+	struct vhost_virtqueue *vq = dev->virtqueue[queue_id];
+
+	if (vq->async_ops == NULL)
+		return;
+
+	drain_async(dev, queue_id);
+
+	rte_free(vq->async_pkts);
+	rte_free(vq->async_segs);
+	rte_free(vq->async_seg_gpa);
+	vq->async_pkts = NULL;
+	vq->async_segs = NULL;
+	vq->async_seg_gpa = NULL;
+	vq->async_pkts_inflight = 0;
+	vq->async_ops = NULL;
+	vq->async_priv = NULL;
+}
+
 static void
 cleanup_vq(struct vhost_virtqueue *vq, int destroy)
 {
+	free_zmbufs(vq);
+
 	if ((vq->callfd >= 0) && (destroy != 0))
 		close(vq->callfd);
 	if (vq->kickfd >= 0)
@@ -138,6 +258,10 @@ cleanup_device(struct virtio_net *dev, int destroy)
 {
 	uint32_t i;
 
+	/* the copy engine may still be writing to guest memory */
+	for (i = 0; i < dev->virt_qp_nb * VIRTIO_QNUM; i++)
+		free_async(dev, i);
+
 	vhost_backend_cleanup(dev);
 
 	for (i = 0; i < dev->virt_qp_nb; i++) {
@@ -164,6 +288,7 @@ static void
 init_vring_queue(struct vhost_virtqueue *vq, int qp_idx)
 {
 	memset(vq, 0, sizeof(struct vhost_virtqueue));
+	TAILQ_INIT(&vq->zmbuf_list);
 
 	vq->kickfd = VIRTIO_UNINITIALIZED_EVENTFD;
 	vq->callfd = VIRTIO_UNINITIALIZED_EVENTFD;
@@ -190,6 +315,7 @@ reset_vring_queue(struct vhost_virtqueue *vq, int qp_idx)
 {
 	int callfd;
 
+	free_zmbufs(vq);
 	callfd = vq->callfd;
 	init_vring_queue(vq, qp_idx);
 	vq->callfd = callfd;
@@ -304,6 +430,17 @@ vhost_destroy_device(int vid)
 	vhost_devices[vid] = NULL;
 }
 
+void
+vhost_enable_dequeue_zero_copy(int vid)
+{
+	struct virtio_net *dev = get_device(vid);
+
+	if (dev == NULL)
+		return;
+
+	dev->dequeue_zero_copy = 1;
+}
+
 void
 vhost_set_ifname(int vid, const char *if_name, unsigned int if_len)
 {
@@ -418,13 +555,30 @@ int
 vhost_set_vring_num(int vid, struct vhost_vring_state *state)
 {
 	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
 
 	dev = get_device(vid);
 	if (dev == NULL)
 		return -1;
 
 	/* State->index refers to the queue index. The txq is 1, rxq is 0. */
-	dev->virtqueue[state->index]->size = state->num;
+	vq = dev->virtqueue[state->index];
+	vq->size = state->num;
+
+	if (dev->dequeue_zero_copy && (state->index & 1) == VIRTIO_TXQ) {
+		free_zmbufs(vq);
+		vq->zmbuf_size = RTE_MIN(vq->size,
+				(uint32_t)RTE_LIBRTE_VHOST_ZCOPY_MAX_INFLIGHT);
+		vq->zmbufs = rte_zmalloc(NULL, vq->zmbuf_size *
+					 sizeof(struct zcopy_mbuf), 0);
+		if (vq->zmbufs == NULL) {
+			RTE_LOG(WARNING, VHOST_CONFIG,
+				"(%d) failed to allocate zero copy mbufs for "
+				"vring %u, dequeue will copy\n",
+				dev->vid, state->index);
+			vq->zmbuf_size = 0;
+		}
+	}
 
 	return 0;
 }
@@ -473,6 +627,9 @@ numa_realloc(struct virtio_net *dev, int index)
 
 		memcpy(vq, old_vq, sizeof(*vq) * VIRTIO_QNUM);
 		rte_free(old_vq);
+		/* The list heads point into the old copy, nothing is queued. */
+		TAILQ_INIT(&vq[VIRTIO_RXQ].zmbuf_list);
+		TAILQ_INIT(&vq[VIRTIO_TXQ].zmbuf_list);
 	}
 
 	/* check if we need to reallocate dev */
@@ -567,6 +724,7 @@ vhost_set_vring_addr(int vid, struct vhost_vring_addr *addr)
 			"some packets maybe resent for Tx and dropped for Rx\n",
 			vq->last_used_idx, vq->used->idx);
 		vq->last_used_idx     = vq->used->idx;
+		vq->last_avail_idx    = vq->used->idx;
 	}
 
 	vq->log_guest_addr = addr->log_guest_addr;
@@ -591,13 +749,23 @@ int
 vhost_set_vring_base(int vid, struct vhost_vring_state *state)
 {
 	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
 
 	dev = get_device(vid);
 	if (dev == NULL)
 		return -1;
 
 	/* State->index refers to the queue index. The txq is 1, rxq is 0. */
-	dev->virtqueue[state->index]->last_used_idx = state->num;
+	vq = dev->virtqueue[state->index];
+	vq->last_used_idx = state->num;
+	vq->last_avail_idx = state->num;
+
+	/* the async packets were dropped when the vring was stopped */
+	if (vq->async_ops != NULL)
+		drain_async(dev, state->index);
+	vq->async_pkts_idx = 0;
+	vq->async_pkts_inflight = 0;
+	vq->async_credits = 0;
 
 	return 0;
 }
@@ -611,6 +779,7 @@ vhost_get_vring_base(int vid, uint32_t index,
 	struct vhost_vring_state *state)
 {
 	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
 
 	dev = get_device(vid);
 	if (dev == NULL)
@@ -618,7 +787,22 @@ vhost_get_vring_base(int vid, uint32_t index,
 
 	state->index = index;
 	/* State->index refers to the queue index. The txq is 1, rxq is 0. */
-	state->num = dev->virtqueue[state->index]->last_used_idx;
+	vq = dev->virtqueue[state->index];
+
+	/*
+	 * With zero copy or an async copy engine, the descriptors between
+	 * last_used_idx and last_avail_idx are still in flight; the guest
+	 * resumes after them.
+	 */
+	if (vq->async_ops != NULL) {
+		state->num = vq->last_avail_idx;
+		drain_async(dev, index);
+	} else if (dev->dequeue_zero_copy && (index & 1) == VIRTIO_TXQ) {
+		state->num = vq->last_avail_idx;
+		free_zmbufs(vq);
+	} else {
+		state->num = vq->last_used_idx;
+	}
 
 	return 0;
 }
@@ -794,6 +978,11 @@ rte_vhost_avail_entries(int vid, uint16_t queue_id)
 	if (!vq->enabled)
 		return 0;
 
+	if (vq->async_ops != NULL ||
+	    (dev->dequeue_zero_copy && (queue_id & 1) == VIRTIO_TXQ))
+		return *(volatile uint16_t *)&vq->avail->idx -
+		       vq->last_avail_idx;
+
 	return *(volatile uint16_t *)&vq->avail->idx - vq->last_used_idx;
 }
 
@@ -845,3 +1034,96 @@ rte_vhost_driver_callback_register(struct virtio_net_device_ops const * const op
 
 	return 0;
 }
+
+int
+rte_vhost_async_channel_register(int vid, uint16_t queue_id,
+		const struct rte_vhost_async_engine_ops *ops, void *priv,
+		uint32_t threshold)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+	uint32_t i;
+
+	if (dev == NULL || ops == NULL || ops->submit == NULL ||
+	    ops->poll == NULL)
+		return -1;
+
+	if (queue_id >= dev->virt_qp_nb * VIRTIO_QNUM) {
+		RTE_LOG(ERR, VHOST_CONFIG, "(%d) %s: invalid virtqueue idx %d.\n",
+			dev->vid, __func__, queue_id);
+		return -1;
+	}
+
+	vq = dev->virtqueue[queue_id];
+	if (vq->async_ops != NULL || vq->size == 0)
+		return -1;
+
+	if (dev->dequeue_zero_copy && (queue_id & 1) == VIRTIO_TXQ) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) async copy not supported with dequeue zero copy\n",
+			dev->vid);
+		return -1;
+	}
+
+	vq->async_pkts = rte_zmalloc(NULL,
+			vq->size * sizeof(struct async_pkt), 0);
+	vq->async_segs = rte_malloc(NULL, vq->size *
+			VHOST_ASYNC_SEGS_PER_PKT *
+			sizeof(struct rte_vhost_async_seg), 0);
+	vq->async_seg_gpa = rte_malloc(NULL, vq->size *
+			VHOST_ASYNC_SEGS_PER_PKT * sizeof(uint64_t), 0);
+	if (vq->async_pkts == NULL || vq->async_segs == NULL ||
+	    vq->async_seg_gpa == NULL) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) failed to allocate async packets for vring %u\n",
+			dev->vid, queue_id);
+		rte_free(vq->async_pkts);
+		rte_free(vq->async_segs);
+		rte_free(vq->async_seg_gpa);
+		vq->async_pkts = NULL;
+		vq->async_segs = NULL;
+		vq->async_seg_gpa = NULL;
+		return -1;
+	}
+
+	for (i = 0; i < vq->size; i++) {
+		vq->async_pkts[i].segs =
+			&vq->async_segs[i * VHOST_ASYNC_SEGS_PER_PKT];
+		vq->async_pkts[i].seg_gpa =
+			&vq->async_seg_gpa[i * VHOST_ASYNC_SEGS_PER_PKT];
+	}
+
+	vq->async_pkts_idx = 0;
+	vq->async_pkts_inflight = 0;
+	vq->async_credits = 0;
+	vq->async_threshold = threshold;
+	vq->last_avail_idx = vq->last_used_idx;
+	vq->async_priv = priv;
+	vq->async_ops = ops;
+
+	return 0;
+}
+
+int
+rte_vhost_async_channel_unregister(int vid, uint16_t queue_id)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+
+	if (dev == NULL || queue_id >= dev->virt_qp_nb * VIRTIO_QNUM)
+		return -1;
+
+	vq = dev->virtqueue[queue_id];
+	if (vq->async_ops == NULL)
+		return -1;
+
+	if (vq->async_pkts_inflight) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) %u packets still in flight on vring %u\n",
+			dev->vid, vq->async_pkts_inflight, queue_id);
+		return -1;
+	}
+
+	free_async(dev, queue_id);
+	return 0;
+}